@@ -0,0 +1,84 @@
+// AnimationBenchmark.cpp : AnimateValue updates.
+//
+// Values of each type are given a queue of eight eased keys and updated at
+// 60hz until the queue empties, as AnimatedTransformQuad and the hud regions
+// update theirs every frame. Values with no keys are updated too, as most
+// regions on screen are sitting still
+//
+
+#include "Benchmark.h"
+
+#include <hogbox/AnimateValue.h>
+
+#include <sstream>
+
+using namespace hogbox;
+
+enum{
+	KEYS_PER_VALUE = 8
+};
+
+static const float s_keyDuration = 0.5f;
+static const float s_frameTime = 1.0f/60.0f;
+
+//
+//Update count values through every key, returns the number still animating
+//at the end
+//
+template <typename T>
+static unsigned int RunAnimateValueBenchmark(BenchmarkReport& report, const std::string& name, unsigned int count, const T& from, const T& to)
+{
+	typedef AnimateValue<T> AnimateType;
+	std::vector<osg::ref_ptr<AnimateType> > values(count);
+	for(unsigned int i=0; i<count; i++)
+	{
+		values[i] = new AnimateType(from);
+		for(unsigned int k=0; k<KEYS_PER_VALUE; k++){
+			values[i]->template AddKey<osgAnimation::InOutQuadMotion>(k % 2 == 0 ? to : from, s_keyDuration);
+		}
+	}
+
+	//a frame past the end of the last key
+	unsigned int numFrames = (unsigned int)(KEYS_PER_VALUE*s_keyDuration/s_frameTime) + 2;
+
+	std::ostringstream countName;
+	countName << count;
+	BenchmarkTimer timer;
+	for(unsigned int f=0; f<numFrames; f++){
+		for(unsigned int i=0; i<count; i++){
+			values[i]->Update(s_frameTime);
+		}
+	}
+	report.Add("anim/"+name+"/"+countName.str(), count*numFrames, timer.ElapsedMs());
+
+	unsigned int animating = 0;
+	for(unsigned int i=0; i<count; i++){
+		if(values[i]->GetNumKeys() > 0){animating++;}
+	}
+
+	//the same values sitting idle
+	unsigned int numIdleFrames = 60;
+	timer.Restart();
+	for(unsigned int f=0; f<numIdleFrames; f++){
+		for(unsigned int i=0; i<count; i++){
+			values[i]->Update(s_frameTime);
+		}
+	}
+	report.Add("anim/"+name+"_idle/"+countName.str(), count*numIdleFrames, timer.ElapsedMs());
+	return animating;
+}
+
+void RunAnimationBenchmarks(BenchmarkReport& report, bool quick)
+{
+	unsigned int count = quick ? 1000 : 10000;
+
+	unsigned int animating = 0;
+	animating += RunAnimateValueBenchmark<float>(report, "animate_float", count, 0.0f, 1.0f);
+	animating += RunAnimateValueBenchmark<osg::Vec2>(report, "animate_vec2", count, osg::Vec2(0,0), osg::Vec2(100,50));
+	animating += RunAnimateValueBenchmark<osg::Vec3>(report, "animate_vec3", count, osg::Vec3(0,0,0), osg::Vec3(100,50,25));
+	animating += RunAnimateValueBenchmark<osg::Vec4>(report, "animate_vec4", count, osg::Vec4(0,0,0,0), osg::Vec4(1,1,1,1));
+
+	if(animating > 0){
+		std::cout << "    WARNING: " << animating << " values still had keys after their last key should have ended" << std::endl;
+	}
+}
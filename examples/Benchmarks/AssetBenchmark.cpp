@@ -0,0 +1,181 @@
+// AssetBenchmark.cpp : AssetManager cache hits and misses, and the Quad cache.
+//
+// Small images and .osg models are written to the working directory, loaded
+// once through the AssetManager, missing its cache and reading the disk, then
+// loaded again from its cache. Textures are then made from the cached images.
+// The Quad cache is filled with quads of distinct sizes, timing the build and
+// search of each miss, then searched for random sizes it already holds
+//
+
+#include "Benchmark.h"
+
+#include <hogbox/AssetManager.h>
+#include <hogbox/Quad.h>
+#include <hogbox/Random.h>
+
+#include <osgDB/WriteFile>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+using namespace hogbox;
+
+static std::string AssetFileName(const char* type, unsigned int index, const char* extension){
+	std::ostringstream name;
+	name << "hogbox_benchmark_" << type << index << extension;
+	return name.str();
+}
+
+static void RemoveFiles(const std::vector<std::string>& files){
+	for(unsigned int i=0; i<files.size(); i++){
+		if(!files[i].empty()){remove(files[i].c_str());}
+	}
+}
+
+static void RunAssetCacheBenchmarks(BenchmarkReport& report, bool quick)
+{
+	unsigned int numAssets = quick ? 100 : 500;
+	unsigned int numHits = numAssets*100;
+	std::ostringstream countName;
+	countName << numAssets;
+	std::string count = countName.str();
+
+	std::vector<std::string> images(numAssets);
+	std::vector<std::string> models(numAssets);
+
+	osg::ref_ptr<osg::Image> image = new osg::Image();
+	image->allocateImage(64, 64, 1, GL_RGBA, GL_UNSIGNED_BYTE);
+	for(unsigned int i=0; i<image->getTotalSizeInBytes(); i++){image->data()[i] = (unsigned char)i;}
+
+	for(unsigned int i=0; i<numAssets; i++)
+	{
+		images[i] = AssetFileName("image", i, ".rgb");
+		models[i] = AssetFileName("model", i, ".osg");
+		std::ofstream model(models[i].c_str());
+		model << "Group {" << std::endl << "  name \"model" << i << "\"" << std::endl << "}" << std::endl;
+		if(!osgDB::writeImageFile(*image.get(), images[i]) || !model.is_open()){
+			std::cout << "    WARNING: Failed to write the benchmark assets, is the rgb plugin available?" << std::endl;
+			RemoveFiles(images);
+			RemoveFiles(models);
+			return;
+		}
+	}
+
+	AssetManager* assets = AssetManager::Inst();
+	unsigned int failed = 0;
+
+	BenchmarkTimer timer;
+	for(unsigned int i=0; i<numAssets; i++){
+		if(!assets->GetOrLoadImage(images[i]).valid()){failed++;}
+	}
+	report.Add("assets/image_miss/"+count, numAssets, timer.ElapsedMs());
+
+	timer.Restart();
+	for(unsigned int i=0; i<numHits; i++){
+		if(!assets->GetOrLoadImage(images[i % numAssets]).valid()){failed++;}
+	}
+	report.Add("assets/image_hit/"+count, numHits, timer.ElapsedMs());
+
+	//the images are cached, so this is the cost of making the textures
+	timer.Restart();
+	for(unsigned int i=0; i<numAssets; i++){
+		if(!assets->GetOrLoadTex2D(images[i]).valid()){failed++;}
+	}
+	report.Add("assets/tex2d_miss/"+count, numAssets, timer.ElapsedMs());
+
+	timer.Restart();
+	for(unsigned int i=0; i<numHits; i++){
+		if(!assets->GetOrLoadTex2D(images[i % numAssets]).valid()){failed++;}
+	}
+	report.Add("assets/tex2d_hit/"+count, numHits, timer.ElapsedMs());
+
+	//check the osg plugin is there before reading a few hundred models through it
+	if(assets->GetOrLoadNode(models[0]).valid())
+	{
+		timer.Restart();
+		for(unsigned int i=1; i<numAssets; i++){
+			if(!assets->GetOrLoadNode(models[i]).valid()){failed++;}
+		}
+		report.Add("assets/node_miss/"+count, numAssets-1, timer.ElapsedMs());
+
+		timer.Restart();
+		for(unsigned int i=0; i<numHits; i++){
+			if(!assets->GetOrLoadNode(models[i % numAssets]).valid()){failed++;}
+		}
+		report.Add("assets/node_hit/"+count, numHits, timer.ElapsedMs());
+	}else{
+		std::cout << "    WARNING: Failed to read '" << models[0] << "', skipping the model cache" << std::endl;
+	}
+
+	timer.Restart();
+	unsigned int released = assets->ReleaseUnusedAssets();
+	report.Add("assets/release_unused/"+count, 1, timer.ElapsedMs());
+	if(released < numAssets){failed++;}
+
+	RemoveFiles(images);
+	RemoveFiles(models);
+
+	if(failed > 0){
+		std::cout << "    WARNING: " << failed << " asset loads failed" << std::endl;
+	}
+}
+
+static void RunQuadCacheBenchmarks(BenchmarkReport& report, bool quick)
+{
+	static const unsigned int s_cacheSizes[3] = {16, 256, 1024};
+	unsigned int numCacheSizes = quick ? 2 : 3;
+	unsigned int numLookups = quick ? 10000 : 100000;
+
+	osg::ref_ptr<Quad::QuadArgs> args = new Quad::QuadArgs();
+	Random random(1);
+	unsigned int failed = 0;
+
+	for(unsigned int s=0; s<numCacheSizes; s++)
+	{
+		unsigned int cacheSize = s_cacheSizes[s];
+		std::ostringstream sizeName;
+		sizeName << cacheSize;
+
+		Quad::clearCache();
+		std::vector<Quad*> quads(cacheSize);
+
+		//each miss searches everything cached so far then builds
+		BenchmarkTimer timer;
+		for(unsigned int i=0; i<cacheSize; i++){
+			quads[i] = Quad::getOrCreateQuad(osg::Vec2((float)(i+1), 1.0f), args.get());
+		}
+		report.Add("quad/get_or_create_miss/"+sizeName.str(), cacheSize, timer.ElapsedMs());
+
+		timer.Restart();
+		for(unsigned int i=0; i<numLookups; i++){
+			unsigned int index = (unsigned int)random.NextInt(0, (int)cacheSize-1);
+			if(Quad::getOrCreateQuad(osg::Vec2((float)(index+1), 1.0f), args.get()) != quads[index]){failed++;}
+		}
+		report.Add("quad/get_or_create_hit/"+sizeName.str(), numLookups, timer.ElapsedMs());
+	}
+
+	//rounded corners build far more vertices
+	osg::ref_ptr<Quad::QuadArgs> roundedArgs = new Quad::QuadArgs();
+	roundedArgs->SetAllCornersRadius(8.0f, 8);
+	unsigned int numRounded = s_cacheSizes[numCacheSizes-1];
+	Quad::clearCache();
+	BenchmarkTimer roundedTimer;
+	for(unsigned int i=0; i<numRounded; i++){
+		Quad::getOrCreateQuad(osg::Vec2((float)(i+32), 32.0f), roundedArgs.get());
+	}
+	std::ostringstream roundedName;
+	roundedName << "quad/get_or_create_miss_rounded/" << numRounded;
+	report.Add(roundedName.str(), numRounded, roundedTimer.ElapsedMs());
+	Quad::clearCache();
+
+	if(failed > 0){
+		std::cout << "    WARNING: " << failed << " quad lookups returned the wrong quad" << std::endl;
+	}
+}
+
+void RunAssetBenchmarks(BenchmarkReport& report, bool quick)
+{
+	RunAssetCacheBenchmarks(report, quick);
+	RunQuadCacheBenchmarks(report, quick);
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <ostream>
+
+#include <osg/Timer>
+
+//
+//BenchmarkResult
+//One timed measurement
+//
+struct BenchmarkResult
+{
+	BenchmarkResult(const std::string& name="", unsigned int iterations=1, double totalMs=0.0)
+		: _name(name),
+		_iterations(iterations),
+		_totalMs(totalMs)
+	{
+	}
+
+	double GetPerIterationMs()const{
+		return _iterations > 0 ? _totalMs/(double)_iterations : 0.0;
+	}
+
+	std::string _name;
+	unsigned int _iterations;
+	double _totalMs;
+};
+
+//
+//BenchmarkReport
+//Collects the results of a run and prints them as a table, and writes them as
+//json to compare between runs
+//
+class BenchmarkReport
+{
+public:
+	BenchmarkReport(){}
+
+	void Add(const std::string& name, unsigned int iterations, double totalMs){
+		_results.push_back(BenchmarkResult(name, iterations, totalMs));
+		std::cout << std::left << std::setw(56) << name << std::right
+				<< std::setw(10) << iterations << " iters "
+				<< std::fixed << std::setprecision(4) << std::setw(14) << _results.back().GetPerIterationMs() << " ms/iter" << std::endl;
+	}
+
+	const std::vector<BenchmarkResult>& GetResults()const{return _results;}
+
+	void WriteJson(std::ostream& out, const std::string& version, bool quick)const{
+		out << "{" << std::endl;
+		out << "\t\"hogbox_version\": \"" << version << "\"," << std::endl;
+		out << "\t\"quick\": " << (quick ? "true" : "false") << "," << std::endl;
+		out << "\t\"results\": [" << std::endl;
+		out << std::fixed << std::setprecision(6);
+		for(unsigned int i=0; i<_results.size(); i++)
+		{
+			const BenchmarkResult& result = _results[i];
+			out << "\t\t{\"name\": \"";
+			for(unsigned int c=0; c<result._name.size(); c++){
+				if(result._name[c] == '"' || result._name[c] == '\\'){out << '\\';}
+				out << result._name[c];
+			}
+			out << "\", \"iterations\": " << result._iterations
+				<< ", \"total_ms\": " << result._totalMs
+				<< ", \"ms_per_iter\": " << result.GetPerIterationMs() << "}"
+				<< (i+1 < _results.size() ? "," : "") << std::endl;
+		}
+		out << "\t]" << std::endl << "}" << std::endl;
+	}
+
+protected:
+	std::vector<BenchmarkResult> _results;
+};
+
+//
+//BenchmarkTimer
+//Milliseconds since construction or the last Restart
+//
+class BenchmarkTimer
+{
+public:
+	BenchmarkTimer(){Restart();}
+
+	void Restart(){_start = osg::Timer::instance()->tick();}
+
+	double ElapsedMs()const{
+		return osg::Timer::instance()->delta_m(_start, osg::Timer::instance()->tick());
+	}
+
+protected:
+	osg::Timer_t _start;
+};
+
+//
+//Benchmark suites, each implemented in its own cpp. quick reduces the problem
+//sizes so a run finishes in a few seconds
+//
+void RunBroadPhaseBenchmarks(BenchmarkReport& report, bool quick);
+void RunPhysicsBenchmarks(BenchmarkReport& report, bool quick);
+void RunImageKernelsBenchmarks(BenchmarkReport& report, bool quick);
+void RunDatabaseBenchmarks(BenchmarkReport& report, bool quick);
+void RunNoiseBenchmarks(BenchmarkReport& report, bool quick);
+void RunAssetBenchmarks(BenchmarkReport& report, bool quick);
+void RunAnimationBenchmarks(BenchmarkReport& report, bool quick);
+void RunHudBenchmarks(BenchmarkReport& report, bool quick);
+void RunProfilerBenchmarks(BenchmarkReport& report, bool quick);
+void RunRenderBenchmarks(BenchmarkReport& report, bool quick);
@@ -0,0 +1,83 @@
+// Benchmarks.cpp : Runs the hogbox micro and macro benchmarks.
+//
+// usage: hogbox_benchmarks [--quick] [--json file] [--software-gl] [suite ...]
+// with no suites named every suite is run. --json also writes the results to
+// file, --software-gl asks Mesa for its software rasteriser before the render
+// suite creates its offscreen context
+//
+
+#include "Benchmark.h"
+
+#include <hogbox/Version.h>
+
+#include <cstring>
+#include <cstdlib>
+#include <fstream>
+
+typedef void (*BenchmarkSuiteFunc)(BenchmarkReport&, bool);
+
+struct BenchmarkSuite
+{
+	const char* _name;
+	BenchmarkSuiteFunc _func;
+};
+
+static const BenchmarkSuite s_suites[] = {
+	{"broadphase", RunBroadPhaseBenchmarks},
+	{"physics", RunPhysicsBenchmarks},
+	{"image", RunImageKernelsBenchmarks},
+	{"database", RunDatabaseBenchmarks},
+	{"noise", RunNoiseBenchmarks},
+	{"assets", RunAssetBenchmarks},
+	{"animation", RunAnimationBenchmarks},
+	{"hud", RunHudBenchmarks},
+	{"profiler", RunProfilerBenchmarks},
+	{"render", RunRenderBenchmarks},
+};
+static const unsigned int s_numSuites = sizeof(s_suites)/sizeof(s_suites[0]);
+
+int main(int argc, char** argv)
+{
+	bool quick = false;
+	std::string jsonFile;
+	std::vector<std::string> selected;
+	for(int i=1; i<argc; i++){
+		if(strcmp(argv[i], "--quick") == 0){
+			quick = true;
+		}else if(strcmp(argv[i], "--json") == 0 && i+1 < argc){
+			jsonFile = argv[++i];
+		}else if(strcmp(argv[i], "--software-gl") == 0){
+#ifdef WIN32
+			_putenv("LIBGL_ALWAYS_SOFTWARE=1");
+#else
+			setenv("LIBGL_ALWAYS_SOFTWARE", "1", 1);
+#endif
+		}else{
+			selected.push_back(argv[i]);
+		}
+	}
+
+	BenchmarkReport report;
+	for(unsigned int s=0; s<s_numSuites; s++)
+	{
+		bool run = selected.empty();
+		for(unsigned int i=0; i<selected.size(); i++){
+			if(selected[i] == s_suites[s]._name){run = true;}
+		}
+		if(!run){continue;}
+
+		std::cout << "== " << s_suites[s]._name << " ==" << std::endl;
+		s_suites[s]._func(report, quick);
+	}
+
+	if(!jsonFile.empty())
+	{
+		std::ofstream out(jsonFile.c_str());
+		if(!out.is_open()){
+			std::cout << "ERROR: Failed to open '" << jsonFile << "' for writing" << std::endl;
+			return 1;
+		}
+		report.WriteJson(out, hogboxGetVersion(), quick);
+	}
+	return 0;
+}
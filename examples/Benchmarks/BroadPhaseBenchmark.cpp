@@ -0,0 +1,163 @@
+// BroadPhaseBenchmark.cpp : Dynamic AABB tree vs uniform grid at 10k and 100k bodies.
+//
+// Bodies are unit boxes spread so the density stays the same at each count. Each frame
+// a small fraction of bodies move, which is the case the incremental pair update targets
+//
+
+#include "Benchmark.h"
+
+#include <hogboxStage/DynamicAABBTree.h>
+#include <hogboxStage/UniformGridBroadPhase.h>
+
+#include <cstdlib>
+#include <cmath>
+#include <sstream>
+
+using namespace hogboxStage;
+
+static float RandomFloat(){
+	return (float)rand()/(float)RAND_MAX;
+}
+
+static osg::BoundingBox BoxAt(const osg::Vec3& center){
+	osg::Vec3 halfSize(0.5f, 0.5f, 0.5f);
+	return osg::BoundingBox(center-halfSize, center+halfSize);
+}
+
+static std::string BenchName(const std::string& broadPhase, unsigned int numBodies, const std::string& test){
+	std::ostringstream name;
+	name << "broadphase/" << broadPhase << "/" << numBodies << "/" << test;
+	return name.str();
+}
+
+//
+//Run the full set of timings against one broad phase
+//
+static void RunBroadPhase(BenchmarkReport& report, BroadPhase* broadPhase, const std::string& typeName,
+						unsigned int numBodies, unsigned int numFrames, unsigned int numQueries)
+{
+	srand(1);
+	float worldSize = 2.5f*powf((float)numBodies, 1.0f/3.0f);
+
+	std::vector<osg::Vec3> positions(numBodies);
+	std::vector<int> proxies(numBodies);
+	for(unsigned int i=0; i<numBodies; i++){
+		positions[i] = osg::Vec3(RandomFloat(), RandomFloat(), RandomFloat())*worldSize;
+	}
+
+	BenchmarkTimer timer;
+	for(unsigned int i=0; i<numBodies; i++){
+		proxies[i] = broadPhase->CreateProxy(BoxAt(positions[i]), NULL);
+	}
+	report.Add(BenchName(typeName, numBodies, "build"), 1, timer.ElapsedMs());
+
+	//a bulk loaded tree is rebuilt rather than left as inserted
+	DynamicAABBTree* tree = dynamic_cast<DynamicAABBTree*>(broadPhase);
+	if(tree){
+		timer.Restart();
+		tree->Rebuild();
+		report.Add(BenchName(typeName, numBodies, "rebuild"), 1, timer.ElapsedMs());
+	}
+
+	timer.Restart();
+	unsigned int numPairs = broadPhase->UpdatePairs().size();
+	report.Add(BenchName(typeName, numBodies, "pairs_full"), 1, timer.ElapsedMs());
+
+	//move 5% of the bodies a short way each frame
+	unsigned int numMoving = numBodies/20;
+	timer.Restart();
+	for(unsigned int f=0; f<numFrames; f++)
+	{
+		for(unsigned int m=0; m<numMoving; m++){
+			unsigned int i = rand()%numBodies;
+			positions[i] += osg::Vec3(RandomFloat()-0.5f, RandomFloat()-0.5f, RandomFloat()-0.5f)*0.1f;
+			broadPhase->MoveProxy(proxies[i], BoxAt(positions[i]));
+		}
+		numPairs = broadPhase->UpdatePairs().size();
+	}
+	report.Add(BenchName(typeName, numBodies, "pairs_incremental_5pct"), numFrames, timer.ElapsedMs());
+
+	std::vector<int> results;
+	timer.Restart();
+	for(unsigned int q=0; q<numQueries; q++){
+		results.clear();
+		osg::Vec3 center = osg::Vec3(RandomFloat(), RandomFloat(), RandomFloat())*worldSize;
+		broadPhase->QueryBox(osg::BoundingBox(center-osg::Vec3(2,2,2), center+osg::Vec3(2,2,2)), results);
+	}
+	report.Add(BenchName(typeName, numBodies, "query_box"), numQueries, timer.ElapsedMs());
+
+	timer.Restart();
+	for(unsigned int q=0; q<numQueries; q++){
+		results.clear();
+		osg::Vec3 center = osg::Vec3(RandomFloat(), RandomFloat(), RandomFloat())*worldSize;
+		broadPhase->QuerySphere(center, 2.0f, results);
+	}
+	report.Add(BenchName(typeName, numBodies, "query_sphere"), numQueries, timer.ElapsedMs());
+
+	RayHitVector hits;
+	timer.Restart();
+	for(unsigned int q=0; q<numQueries; q++){
+		hits.clear();
+		osg::Vec3 origin = osg::Vec3(RandomFloat(), RandomFloat(), RandomFloat())*worldSize;
+		osg::Vec3 direction(RandomFloat()-0.5f, RandomFloat()-0.5f, RandomFloat()-0.5f);
+		direction.normalize();
+		broadPhase->QueryRay(origin, direction, worldSize*0.25f, hits);
+	}
+	report.Add(BenchName(typeName, numBodies, "query_ray"), numQueries, timer.ElapsedMs());
+
+	//everything moves, the worst case for the incremental update
+	timer.Restart();
+	for(unsigned int i=0; i<numBodies; i++){
+		positions[i] += osg::Vec3(RandomFloat()-0.5f, RandomFloat()-0.5f, RandomFloat()-0.5f)*0.1f;
+		broadPhase->MoveProxy(proxies[i], BoxAt(positions[i]));
+	}
+	numPairs = broadPhase->UpdatePairs().size();
+	report.Add(BenchName(typeName, numBodies, "pairs_all_moved"), 1, timer.ElapsedMs());
+
+	std::cout << "    " << numPairs << " pairs" << std::endl;
+}
+
+//
+//Brute force pair count, the O(n^2) baseline the broad phase replaces
+//
+static void RunBruteForce(BenchmarkReport& report, unsigned int numBodies)
+{
+	srand(1);
+	float worldSize = 2.5f*powf((float)numBodies, 1.0f/3.0f);
+	std::vector<osg::BoundingBox> boxes(numBodies);
+	for(unsigned int i=0; i<numBodies; i++){
+		boxes[i] = BoxAt(osg::Vec3(RandomFloat(), RandomFloat(), RandomFloat())*worldSize);
+	}
+
+	BenchmarkTimer timer;
+	unsigned int numPairs = 0;
+	for(unsigned int i=0; i<numBodies; i++){
+		for(unsigned int j=i+1; j<numBodies; j++){
+			if(BroadPhase::BoxesOverlap(boxes[i], boxes[j])){numPairs++;}
+		}
+	}
+	report.Add(BenchName("bruteforce", numBodies, "pairs_full"), 1, timer.ElapsedMs());
+	std::cout << "    " << numPairs << " pairs" << std::endl;
+}
+
+void RunBroadPhaseBenchmarks(BenchmarkReport& report, bool quick)
+{
+	std::vector<unsigned int> counts;
+	counts.push_back(10000);
+	if(!quick){counts.push_back(100000);}
+
+	unsigned int numFrames = quick ? 10 : 60;
+	unsigned int numQueries = quick ? 1000 : 10000;
+
+	for(unsigned int c=0; c<counts.size(); c++)
+	{
+		DynamicAABBTreePtr tree = new DynamicAABBTree(0.1f);
+		RunBroadPhase(report, tree.get(), "tree", counts[c], numFrames, numQueries);
+
+		UniformGridBroadPhasePtr grid = new UniformGridBroadPhase(1.0f, counts[c]);
+		RunBroadPhase(report, grid.get(), "grid", counts[c], numFrames, numQueries);
+	}
+
+	//100k brute force takes minutes, only the 10k baseline is run
+	RunBruteForce(report, 10000);
+}
@@ -0,0 +1,647 @@
+// DatabaseBenchmark.cpp : Loading hogbox xml databases of 1k, 10k and 100k objects.
+//
+// Eight xml class managers supporting three class types each are registered,
+// then for each size a database spreading the objects over all 24 types is
+// parsed, every object is read by uniqueID, read again through useID nodes and
+// released. Attribute strings are converted to values through asciiToType,
+// then objects with eight attributes are deserialized through per instance
+// bound attributes and through a shared XmlAttributeTable, and written as a
+// database through an XmlNode tree and through an XmlStreamWriter. The two
+// outputs are compared and the written file read back to check the values.
+// Finally a HogBoxObject is edited and reloaded in place, checking its model
+// nodes are replaced rather than added a second time
+//
+
+#include "Benchmark.h"
+
+#include <hogboxDB/HogBoxManager.h>
+#include <hogboxDB/XmlClassWrapper.h>
+#include <hogboxDB/XmlClassManagerWrapper.h>
+#include <hogboxDB/XmlUtils.h>
+#include <hogbox/HogBoxObject.h>
+
+#include <osg/Node>
+#include <osg/Vec3>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+using namespace hogboxDB;
+
+enum{
+	NUM_MANAGERS = 8,
+	TYPES_PER_MANAGER = 3
+};
+
+static std::string BenchTypeName(unsigned int type){
+	std::ostringstream name;
+	name << "BenchType" << type;
+	return name.str();
+}
+
+static std::string BenchObjectID(unsigned int index){
+	std::ostringstream id;
+	id << "object" << index;
+	return id.str();
+}
+
+//
+//Wraps a plain osg::Node, there are no attributes to read
+//
+class BenchmarkXmlWrapper : public XmlClassWrapper
+{
+public:
+	BenchmarkXmlWrapper(const std::string& classType)
+		: XmlClassWrapper(classType)
+	{
+	}
+
+	virtual osg::Object* allocateClassType(){return new osg::Node();}
+	virtual XmlClassWrapper* cloneType(){return new BenchmarkXmlWrapper(_classType);}
+
+protected:
+	virtual ~BenchmarkXmlWrapper(void){}
+};
+
+//
+//Object with a few attributes to deserialize
+//
+class BenchmarkMaterial : public osg::Object
+{
+public:
+	BenchmarkMaterial(void)
+		: osg::Object(),
+		_shine(0.0f),
+		_opacity(1.0f)
+	{
+	}
+
+	BenchmarkMaterial(const BenchmarkMaterial& material,const osg::CopyOp& copyop=osg::CopyOp::SHALLOW_COPY)
+		: osg::Object(material, copyop),
+		_ambient(material._ambient),
+		_diffuse(material._diffuse),
+		_specular(material._specular),
+		_emissive(material._emissive),
+		_shine(material._shine),
+		_opacity(material._opacity),
+		_texture(material._texture),
+		_shader(material._shader)
+	{
+	}
+
+	META_Object(benchmarks, BenchmarkMaterial);
+
+	const osg::Vec3& GetAmbient()const{return _ambient;}
+	void SetAmbient(const osg::Vec3& color){_ambient = color;}
+	const osg::Vec3& GetDiffuse()const{return _diffuse;}
+	void SetDiffuse(const osg::Vec3& color){_diffuse = color;}
+	const osg::Vec3& GetSpecular()const{return _specular;}
+	void SetSpecular(const osg::Vec3& color){_specular = color;}
+	const osg::Vec3& GetEmissive()const{return _emissive;}
+	void SetEmissive(const osg::Vec3& color){_emissive = color;}
+	const float& GetShine()const{return _shine;}
+	void SetShine(const float& shine){_shine = shine;}
+	const float& GetOpacity()const{return _opacity;}
+	void SetOpacity(const float& opacity){_opacity = opacity;}
+	const std::string& GetTexture()const{return _texture;}
+	void SetTexture(const std::string& file){_texture = file;}
+	const std::string& GetShader()const{return _shader;}
+	void SetShader(const std::string& file){_shader = file;}
+
+protected:
+	virtual ~BenchmarkMaterial(void){}
+
+	osg::Vec3 _ambient;
+	osg::Vec3 _diffuse;
+	osg::Vec3 _specular;
+	osg::Vec3 _emissive;
+	float _shine;
+	float _opacity;
+	std::string _texture;
+	std::string _shader;
+};
+
+//
+//Binds the BenchmarkMaterial attributes to each instance
+//
+class BenchmarkMaterialBoundXmlWrapper : public XmlClassWrapper
+{
+public:
+	BenchmarkMaterialBoundXmlWrapper(void)
+		: XmlClassWrapper("BenchmarkMaterial")
+	{
+	}
+
+	virtual osg::Object* allocateClassType(){return new BenchmarkMaterial();}
+	virtual XmlClassWrapper* cloneType(){return new BenchmarkMaterialBoundXmlWrapper();}
+
+protected:
+	virtual ~BenchmarkMaterialBoundXmlWrapper(void){}
+
+	virtual void bindXmlAttributes(){
+		BenchmarkMaterial* material = dynamic_cast<BenchmarkMaterial*>(p_wrappedObject.get());
+		_xmlAttributes["Ambient"] = new CallbackXmlAttribute<BenchmarkMaterial,osg::Vec3>("Ambient", material,
+		                                                                                  &BenchmarkMaterial::GetAmbient,
+		                                                                                  &BenchmarkMaterial::SetAmbient);
+		_xmlAttributes["Diffuse"] = new CallbackXmlAttribute<BenchmarkMaterial,osg::Vec3>("Diffuse", material,
+		                                                                                  &BenchmarkMaterial::GetDiffuse,
+		                                                                                  &BenchmarkMaterial::SetDiffuse);
+		_xmlAttributes["Specular"] = new CallbackXmlAttribute<BenchmarkMaterial,osg::Vec3>("Specular", material,
+		                                                                                   &BenchmarkMaterial::GetSpecular,
+		                                                                                   &BenchmarkMaterial::SetSpecular);
+		_xmlAttributes["Emissive"] = new CallbackXmlAttribute<BenchmarkMaterial,osg::Vec3>("Emissive", material,
+		                                                                                   &BenchmarkMaterial::GetEmissive,
+		                                                                                   &BenchmarkMaterial::SetEmissive);
+		_xmlAttributes["Shine"] = new CallbackXmlAttribute<BenchmarkMaterial,float>("Shine", material,
+		                                                                            &BenchmarkMaterial::GetShine,
+		                                                                            &BenchmarkMaterial::SetShine);
+		_xmlAttributes["Opacity"] = new CallbackXmlAttribute<BenchmarkMaterial,float>("Opacity", material,
+		                                                                              &BenchmarkMaterial::GetOpacity,
+		                                                                              &BenchmarkMaterial::SetOpacity);
+		_xmlAttributes["Texture"] = new CallbackXmlAttribute<BenchmarkMaterial,std::string>("Texture", material,
+		                                                                                    &BenchmarkMaterial::GetTexture,
+		                                                                                    &BenchmarkMaterial::SetTexture);
+		_xmlAttributes["Shader"] = new CallbackXmlAttribute<BenchmarkMaterial,std::string>("Shader", material,
+		                                                                                   &BenchmarkMaterial::GetShader,
+		                                                                                   &BenchmarkMaterial::SetShader);
+	}
+};
+
+//
+//Describes the same attributes once in an XmlAttributeTable
+//
+class BenchmarkMaterialTableXmlWrapper : public XmlClassWrapper
+{
+public:
+	BenchmarkMaterialTableXmlWrapper(void)
+		: XmlClassWrapper("BenchmarkMaterial")
+	{
+	}
+
+	virtual osg::Object* allocateClassType(){return new BenchmarkMaterial();}
+	virtual XmlClassWrapper* cloneType(){return new BenchmarkMaterialTableXmlWrapper();}
+
+protected:
+	virtual ~BenchmarkMaterialTableXmlWrapper(void){}
+
+	virtual const XmlAttributeTable* getXmlAttributeTable(){
+		static XmlAttributeTablePtr s_table;
+		OpenThreads::ScopedLock<OpenThreads::ReentrantMutex> lock(*XmlAttributeTable::getBuildMutex());
+		if(!s_table.valid()){
+			s_table = new XmlAttributeTable();
+			s_table->addProperty<BenchmarkMaterial,osg::Vec3>("Ambient", &BenchmarkMaterial::GetAmbient, &BenchmarkMaterial::SetAmbient);
+			s_table->addProperty<BenchmarkMaterial,osg::Vec3>("Diffuse", &BenchmarkMaterial::GetDiffuse, &BenchmarkMaterial::SetDiffuse);
+			s_table->addProperty<BenchmarkMaterial,osg::Vec3>("Specular", &BenchmarkMaterial::GetSpecular, &BenchmarkMaterial::SetSpecular);
+			s_table->addProperty<BenchmarkMaterial,osg::Vec3>("Emissive", &BenchmarkMaterial::GetEmissive, &BenchmarkMaterial::SetEmissive);
+			s_table->addProperty<BenchmarkMaterial,float>("Shine", &BenchmarkMaterial::GetShine, &BenchmarkMaterial::SetShine);
+			s_table->addProperty<BenchmarkMaterial,float>("Opacity", &BenchmarkMaterial::GetOpacity, &BenchmarkMaterial::SetOpacity);
+			s_table->addProperty<BenchmarkMaterial,std::string>("Texture", &BenchmarkMaterial::GetTexture, &BenchmarkMaterial::SetTexture);
+			s_table->addProperty<BenchmarkMaterial,std::string>("Shader", &BenchmarkMaterial::GetShader, &BenchmarkMaterial::SetShader);
+		}
+		return s_table.get();
+	}
+};
+
+static osgDB::XmlNode* AddChildNode(osgDB::XmlNode* parent, const std::string& name, const std::string& contents){
+	osgDB::XmlNode* child = new osgDB::XmlNode();
+	child->type = osgDB::XmlNode::ATOM;
+	child->name = name;
+	child->contents = contents;
+	parent->children.push_back(child);
+	return child;
+}
+
+//
+//Deserialize each node with a clone of prototype, returns the number that failed
+//or didn't read the expected values back
+//
+static unsigned int DeserializeMaterials(XmlClassWrapper* prototype, const std::vector<osgDB::XmlNodePtr>& nodes)
+{
+	unsigned int failed = 0;
+	for(unsigned int i=0; i<nodes.size(); i++)
+	{
+		osg::ref_ptr<XmlClassWrapper> wrapper = prototype->cloneType();
+		if(!wrapper->deserialize(nodes[i].get())){failed++; continue;}
+		BenchmarkMaterial* material = dynamic_cast<BenchmarkMaterial*>(wrapper->getWrappedObject());
+		if(!material || material->GetShine() != (float)(i % 128) || material->GetShader() != "Shaders/bench.vert"){failed++;}
+	}
+	return failed;
+}
+
+//
+//Convert each string to T, returns the number that failed
+//
+template <typename T>
+static unsigned int ConvertAttributes(BenchmarkReport& report, const std::string& name, const std::vector<std::string>& values)
+{
+	unsigned int failed = 0;
+	T result;
+	BenchmarkTimer timer;
+	for(unsigned int i=0; i<values.size(); i++){
+		if(!asciiToType(values[i], result)){failed++;}
+	}
+	report.Add(name, (unsigned int)values.size(), timer.ElapsedMs());
+	return failed;
+}
+
+static unsigned int RunAttributeBenchmarks(BenchmarkReport& report, unsigned int numObjects)
+{
+	std::ostringstream sizeName;
+	sizeName << numObjects/1000 << "k";
+
+	//the text of single attributes, as XmlAttribute reads them
+	std::vector<std::string> floats(numObjects);
+	std::vector<std::string> vec3s(numObjects);
+	std::vector<std::string> vec4s(numObjects);
+	std::vector<std::string> matrices(numObjects);
+	for(unsigned int i=0; i<numObjects; i++)
+	{
+		float value = (float)(i % 1000) * 0.125f;
+		std::ostringstream f, v3, v4, m;
+		f << value;
+		v3 << value << " " << value*0.5f << " " << -value;
+		v4 << value << " " << value*0.5f << " " << -value << " 1";
+		m << "1 0 0 0 0 1 0 0 0 0 1 0 " << value << " " << value*0.5f << " " << -value << " 1";
+		floats[i] = f.str();
+		vec3s[i] = v3.str();
+		vec4s[i] = v4.str();
+		matrices[i] = m.str();
+	}
+	unsigned int failed = 0;
+	failed += ConvertAttributes<float>(report, "db/ascii_to_type/float/" + sizeName.str(), floats);
+	failed += ConvertAttributes<osg::Vec3>(report, "db/ascii_to_type/vec3/" + sizeName.str(), vec3s);
+	failed += ConvertAttributes<osg::Vec4>(report, "db/ascii_to_type/vec4/" + sizeName.str(), vec4s);
+	failed += ConvertAttributes<osg::Matrix>(report, "db/ascii_to_type/matrix/" + sizeName.str(), matrices);
+
+	std::vector<osgDB::XmlNodePtr> nodes(numObjects);
+	for(unsigned int i=0; i<numObjects; i++)
+	{
+		std::ostringstream shine;
+		shine << (i % 128);
+		nodes[i] = new osgDB::XmlNode();
+		nodes[i]->type = osgDB::XmlNode::NODE;
+		nodes[i]->name = "BenchmarkMaterial";
+		nodes[i]->properties["uniqueID"] = "material" + BenchObjectID(i);
+		//reverse of the order they're bound, so neither gets a best case
+		AddChildNode(nodes[i].get(), "Shader", "Shaders/bench.vert");
+		AddChildNode(nodes[i].get(), "Texture", "Images/bench.png");
+		AddChildNode(nodes[i].get(), "Opacity", "0.5");
+		AddChildNode(nodes[i].get(), "Shine", shine.str());
+		AddChildNode(nodes[i].get(), "Emissive", "0.0 0.0 0.0");
+		AddChildNode(nodes[i].get(), "Specular", "1.0 1.0 1.0");
+		AddChildNode(nodes[i].get(), "Diffuse", "0.8 0.8 0.8");
+		AddChildNode(nodes[i].get(), "Ambient", "0.2 0.2 0.2");
+	}
+
+	osg::ref_ptr<XmlClassWrapper> bound = new BenchmarkMaterialBoundXmlWrapper();
+	BenchmarkTimer timer;
+	failed += DeserializeMaterials(bound.get(), nodes);
+	report.Add("db/deserialize_bound/" + sizeName.str(), numObjects, timer.ElapsedMs());
+
+	osg::ref_ptr<XmlClassWrapper> table = new BenchmarkMaterialTableXmlWrapper();
+	timer.Restart();
+	failed += DeserializeMaterials(table.get(), nodes);
+	report.Add("db/deserialize_table/" + sizeName.str(), numObjects, timer.ElapsedMs());
+	return failed;
+}
+
+//
+//Writes and reads BenchmarkMaterials through the database
+//
+class BenchmarkMaterialManager : public XmlClassManager
+{
+public:
+	BenchmarkMaterialManager(void) : XmlClassManager()
+	{
+		SupportsClassType("BenchmarkMaterial", new BenchmarkMaterialTableXmlWrapper());
+	}
+
+	BenchmarkMaterialManager(const BenchmarkMaterialManager& manager,const osg::CopyOp& copyop=osg::CopyOp::SHALLOW_COPY)
+		: XmlClassManager(manager, copyop)
+	{
+	}
+
+	META_Object(benchmarks, BenchmarkMaterialManager);
+
+protected:
+	virtual ~BenchmarkMaterialManager(void){}
+};
+
+static bool MaterialsMatch(const BenchmarkMaterial* a, const BenchmarkMaterial* b){
+	return a && b && a->getName() == b->getName() &&
+	       a->GetAmbient() == b->GetAmbient() && a->GetDiffuse() == b->GetDiffuse() &&
+	       a->GetSpecular() == b->GetSpecular() && a->GetEmissive() == b->GetEmissive() &&
+	       a->GetShine() == b->GetShine() && a->GetOpacity() == b->GetOpacity() &&
+	       a->GetTexture() == b->GetTexture() && a->GetShader() == b->GetShader();
+}
+
+//
+//Write numObjects materials as a database through an XmlNode tree and through
+//an XmlStreamWriter, then read the streamed file back. Returns the number of
+//mismatches
+//
+static unsigned int RunWriteBenchmarks(BenchmarkReport& report, unsigned int numObjects)
+{
+	std::ostringstream sizeName;
+	sizeName << numObjects/1000 << "k";
+
+	//values that print exactly, with characters that need escaping
+	std::vector<osg::ObjectPtr> materials(numObjects);
+	for(unsigned int i=0; i<numObjects; i++)
+	{
+		BenchmarkMaterial* material = new BenchmarkMaterial();
+		material->setName("material" + BenchObjectID(i));
+		material->SetAmbient(osg::Vec3(0.25f, 0.25f, 0.25f));
+		material->SetDiffuse(osg::Vec3((i % 8)*0.125f, 0.5f, 1.0f));
+		material->SetSpecular(osg::Vec3(1.0f, 1.0f, 1.0f));
+		material->SetEmissive(osg::Vec3(0.0f, 0.0f, -0.5f));
+		material->SetShine((float)(i % 128));
+		material->SetOpacity(0.5f);
+		material->SetTexture("Images/" + BenchObjectID(i) + "<'&'>.png");
+		material->SetShader("Shaders/bench.vert");
+		materials[i] = material;
+	}
+
+	HogBoxManager* manager = HogBoxManager::Inst();
+	std::string declaration = "xml version=\"1.0\" encoding=\"UTF-8\"";
+
+	BenchmarkTimer timer;
+	std::ostringstream treeOut;
+	{
+		osgDB::XmlNodePtr doc = new osgDB::XmlNode();
+		doc->type = osgDB::XmlNode::ROOT;
+		osgDB::XmlNode* info = AddChildNode(doc.get(), "", declaration);
+		info->type = osgDB::XmlNode::INFORMATION;
+		osgDB::XmlNode* root = AddChildNode(doc.get(), "HogBoxDatabase", "");
+		root->type = osgDB::XmlNode::GROUP;
+		for(unsigned int i=0; i<numObjects; i++){
+			osgDB::XmlNodePtr classNode = manager->WriteXmlNode(materials[i]);
+			if(classNode.valid()){root->children.push_back(classNode.get());}
+		}
+		doc->write(treeOut);
+	}
+	report.Add("db/write_tree/" + sizeName.str(), numObjects, timer.ElapsedMs());
+
+	timer.Restart();
+	std::ostringstream streamOut;
+	{
+		XmlStreamWriter out(streamOut);
+		out.writeInformation(declaration);
+		out.beginNode("HogBoxDatabase", true);
+		for(unsigned int i=0; i<numObjects; i++){
+			manager->WriteXmlStream(materials[i], out);
+		}
+		out.endNode();
+	}
+	report.Add("db/write_stream/" + sizeName.str(), numObjects, timer.ElapsedMs());
+
+	unsigned int failed = 0;
+	if(streamOut.str() != treeOut.str()){
+		std::cout << "    WARNING: XmlStreamWriter output differs from the XmlNode tree" << std::endl;
+		failed++;
+	}
+
+	//round trip through a file
+	std::string fileName = "hogbox_benchmark_write.xml";
+	if(!manager->WriteDataBaseFile(fileName, materials) || !manager->ReadDataBaseFile(fileName)){
+		remove(fileName.c_str());
+		return failed+1;
+	}
+	for(unsigned int i=0; i<numObjects; i++)
+	{
+		osg::ref_ptr<BenchmarkMaterial> read = manager->ReadNodeByIDTyped<BenchmarkMaterial>(materials[i]->getName());
+		if(!MaterialsMatch(read.get(), dynamic_cast<BenchmarkMaterial*>(materials[i].get()))){failed++;}
+		manager->ReleaseNodeByID(materials[i]->getName());
+	}
+	remove(fileName.c_str());
+	return failed;
+}
+
+//
+//A HogBoxObject database with one model node, at position
+//
+static bool WriteObjectDatabase(const std::string& fileName, const std::string& modelFile, const std::string& position)
+{
+	std::ofstream out(fileName.c_str());
+	if(!out.is_open()){return false;}
+	out << "<?xml version=\"1.0\" ?>" << std::endl << "<HogBoxDatabase>" << std::endl;
+	out << "\t<Node uniqueID=\"reloadModel\">" << std::endl;
+	out << "\t\t<File>" << modelFile << "</File>" << std::endl;
+	out << "\t</Node>" << std::endl;
+	out << "\t<HogBoxObject uniqueID=\"reloadObject\">" << std::endl;
+	out << "\t\t<Position>" << position << "</Position>" << std::endl;
+	out << "\t\t<ModelNodes>" << std::endl;
+	out << "\t\t\t<Node useID=\"reloadModel\"></Node>" << std::endl;
+	out << "\t\t</ModelNodes>" << std::endl;
+	out << "\t</HogBoxObject>" << std::endl;
+	out << "</HogBoxDatabase>" << std::endl;
+	return true;
+}
+
+//
+//Load a HogBoxObject, move it in the file and reload. The same instance
+//should come back at the new position still wrapping one node. Returns the
+//number of failed checks
+//
+static unsigned int RunReloadBenchmark(BenchmarkReport& report)
+{
+	std::string modelFile = "hogbox_benchmark_reload.osg";
+	std::string fileName = "hogbox_benchmark_reload.xml";
+	{
+		std::ofstream model(modelFile.c_str());
+		model << "Group {" << std::endl << "  name \"reloadModel\"" << std::endl << "}" << std::endl;
+	}
+
+	HogBoxManager* manager = HogBoxManager::Inst();
+	osg::ref_ptr<hogbox::HogBoxObject> object;
+	if(WriteObjectDatabase(fileName, modelFile, "0 0 0") && manager->ReadDataBaseFile(fileName)){
+		object = manager->ReadNodeByIDTyped<hogbox::HogBoxObject>("reloadObject");
+	}
+	if(!object.valid()){
+		std::cout << "    WARNING: Failed to read a HogBoxObject, is the hogbox xml plugin available? Skipping the reload check" << std::endl;
+		remove(fileName.c_str());
+		remove(modelFile.c_str());
+		return 0;
+	}
+
+	unsigned int failed = 0;
+	WriteObjectDatabase(fileName, modelFile, "1 2 3");
+	BenchmarkTimer timer;
+	if(!manager->ReloadDataBaseFile(fileName)){failed++;}
+	report.Add("db/reload_edited_object", 1, timer.ElapsedMs());
+
+	osg::ref_ptr<hogbox::HogBoxObject> reloaded = manager->ReadNodeByIDTyped<hogbox::HogBoxObject>("reloadObject");
+	if(reloaded != object){failed++;}
+	if(object->GetLocalTranslation() != osg::Vec3(1.0f, 2.0f, 3.0f)){failed++;}
+	if(object->GetWrappedNodes().size() != 1){
+		std::cout << "    WARNING: Reloaded HogBoxObject wraps " << object->GetWrappedNodes().size() << " nodes, expected 1" << std::endl;
+		failed++;
+	}
+
+	manager->ReleaseNodeByID("reloadObject");
+	manager->ReleaseNodeByID("reloadModel");
+	remove(fileName.c_str());
+	remove(modelFile.c_str());
+	return failed;
+}
+
+//
+//Each N is a separate manager class, as the registry tells them apart by className
+//
+static const char* s_managerNames[NUM_MANAGERS] = {
+	"BenchmarkManager0", "BenchmarkManager1", "BenchmarkManager2", "BenchmarkManager3",
+	"BenchmarkManager4", "BenchmarkManager5", "BenchmarkManager6", "BenchmarkManager7"
+};
+
+template <unsigned int N>
+class BenchmarkManager : public XmlClassManager
+{
+public:
+	BenchmarkManager(void) : XmlClassManager()
+	{
+		for(unsigned int t=0; t<TYPES_PER_MANAGER; t++){
+			std::string type = BenchTypeName(N*TYPES_PER_MANAGER + t);
+			SupportsClassType(type, new BenchmarkXmlWrapper(type));
+		}
+	}
+
+	BenchmarkManager(const BenchmarkManager& manager,const osg::CopyOp& copyop=osg::CopyOp::SHALLOW_COPY)
+		: XmlClassManager(manager, copyop)
+	{
+	}
+
+	virtual osg::Object* cloneType() const { return new BenchmarkManager(); }
+	virtual osg::Object* clone(const osg::CopyOp& copyop) const { return new BenchmarkManager(*this, copyop); }
+	virtual bool isSameKindAs(const osg::Object* obj) const { return dynamic_cast<const BenchmarkManager*>(obj)!=NULL; }
+	virtual const char* libraryName() const { return "benchmarks"; }
+	virtual const char* className() const { return s_managerNames[N]; }
+
+protected:
+	virtual ~BenchmarkManager(void){}
+};
+
+static void RegisterManager(XmlClassManager* manager){
+	HogBoxRegistry::Inst()->AddXmlNodeManagerToRegistry(new XmlClassManagerWrapper(manager));
+}
+
+static void RegisterManagers()
+{
+	RegisterManager(new BenchmarkManager<0>());
+	RegisterManager(new BenchmarkManager<1>());
+	RegisterManager(new BenchmarkManager<2>());
+	RegisterManager(new BenchmarkManager<3>());
+	RegisterManager(new BenchmarkManager<4>());
+	RegisterManager(new BenchmarkManager<5>());
+	RegisterManager(new BenchmarkManager<6>());
+	RegisterManager(new BenchmarkManager<7>());
+	RegisterManager(new BenchmarkMaterialManager());
+}
+
+//
+//numObjects spread over folders of 100, so lookups have a tree to search
+//
+static bool WriteDatabase(const std::string& fileName, unsigned int numObjects)
+{
+	std::ofstream out(fileName.c_str());
+	if(!out.is_open()){return false;}
+	out << "<?xml version=\"1.0\" ?>" << std::endl << "<HogBoxDatabase>" << std::endl;
+	for(unsigned int i=0; i<numObjects; i++)
+	{
+		if(i % 100 == 0){out << "\t<Folder>" << std::endl;}
+		std::string type = BenchTypeName(i % (NUM_MANAGERS*TYPES_PER_MANAGER));
+		out << "\t\t<" << type << " uniqueID=\"" << BenchObjectID(i) << "\"></" << type << ">" << std::endl;
+		if(i % 100 == 99 || i+1 == numObjects){out << "\t</Folder>" << std::endl;}
+	}
+	out << "</HogBoxDatabase>" << std::endl;
+	return true;
+}
+
+//
+//Parse a database of numObjects and read, reference and release every object,
+//returns the number of lookups that failed
+//
+static unsigned int RunLoadBenchmarks(BenchmarkReport& report, unsigned int numObjects)
+{
+	std::ostringstream sizeName;
+	sizeName << numObjects/1000 << "k";
+
+	std::string fileName = "hogbox_benchmark_db.xml";
+	if(!WriteDatabase(fileName, numObjects)){
+		std::cout << "    WARNING: Failed to write '" << fileName << "'" << std::endl;
+		return 1;
+	}
+
+	HogBoxManager* manager = HogBoxManager::Inst();
+	BenchmarkTimer timer;
+	bool loaded = manager->ReadDataBaseFile(fileName);
+	report.Add("db/parse/" + sizeName.str(), 1, timer.ElapsedMs());
+	remove(fileName.c_str());
+	if(!loaded){return 1;}
+
+	//read in a shuffled order so neighbouring ids aren't neighbouring nodes
+	std::vector<unsigned int> order(numObjects);
+	for(unsigned int i=0; i<numObjects; i++){order[i] = i;}
+	srand(1);
+	for(unsigned int i=numObjects-1; i>0; i--){std::swap(order[i], order[rand() % (i+1)]);}
+
+	std::vector<osg::ObjectPtr> objects(numObjects);
+	unsigned int failed = 0;
+	timer.Restart();
+	for(unsigned int i=0; i<numObjects; i++){
+		objects[order[i]] = manager->ReadNodeByID(BenchObjectID(order[i]));
+	}
+	report.Add("db/read_by_id/" + sizeName.str(), numObjects, timer.ElapsedMs());
+	for(unsigned int i=0; i<numObjects; i++){
+		if(!objects[i].valid()){failed++;}
+	}
+
+	//useID references, as found inside other objects
+	std::vector<osgDB::XmlNodePtr> references(numObjects);
+	for(unsigned int i=0; i<numObjects; i++){
+		references[i] = new osgDB::XmlNode();
+		references[i]->type = osgDB::XmlNode::NODE;
+		references[i]->name = BenchTypeName(order[i] % (NUM_MANAGERS*TYPES_PER_MANAGER));
+		references[i]->properties["useID"] = BenchObjectID(order[i]);
+	}
+	timer.Restart();
+	for(unsigned int i=0; i<numObjects; i++){
+		if(manager->ReadNode(references[i].get()) != objects[order[i]]){failed++;}
+	}
+	report.Add("db/use_id/" + sizeName.str(), numObjects, timer.ElapsedMs());
+
+	timer.Restart();
+	for(unsigned int i=0; i<numObjects; i++){
+		if(manager->GetNodeByID(BenchObjectID(order[i])) != objects[order[i]].get()){failed++;}
+	}
+	report.Add("db/get_loaded/" + sizeName.str(), numObjects, timer.ElapsedMs());
+
+	timer.Restart();
+	for(unsigned int i=0; i<numObjects; i++){
+		if(!manager->ReleaseNodeByID(BenchObjectID(order[i]))){failed++;}
+	}
+	report.Add("db/release/" + sizeName.str(), numObjects, timer.ElapsedMs());
+	return failed;
+}
+
+void RunDatabaseBenchmarks(BenchmarkReport& report, bool quick)
+{
+	RegisterManagers();
+
+	static const unsigned int s_loadSizes[3] = {1000, 10000, 100000};
+	unsigned int numLoadSizes = quick ? 2 : 3;
+	unsigned int failed = 0;
+	for(unsigned int i=0; i<numLoadSizes; i++){
+		failed += RunLoadBenchmarks(report, s_loadSizes[i]);
+	}
+
+	unsigned int numObjects = quick ? 2000 : 10000;
+	failed += RunAttributeBenchmarks(report, numObjects*2);
+	failed += RunWriteBenchmarks(report, numObjects);
+	failed += RunReloadBenchmark(report);
+
+	if(failed > 0){
+		std::cout << "    WARNING: " << failed << " database lookups returned the wrong object" << std::endl;
+	}
+}
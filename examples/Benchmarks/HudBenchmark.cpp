@@ -0,0 +1,154 @@
+// HudBenchmark.cpp : Hud event dispatch, picking and text updates.
+//
+// A grid of plain quad regions is added to a 1280x720 hud. Mouse moves are
+// dispatched to every region through Hud::HandleInputEvent, then picked
+// through HudInputHandler as the viewer would on each mouse move. Text
+// regions then have their text changed as a score or timer label would
+// every frame. Nothing is drawn, see RenderBenchmark.cpp for that
+//
+
+#include "Benchmark.h"
+
+#include <hogboxHUD/Hud.h>
+#include <hogboxHUD/HudInputHandler.h>
+#include <hogboxHUD/TextRegion.h>
+#include <hogbox/Random.h>
+
+#include <sstream>
+
+using namespace hogboxHUD;
+
+namespace {
+
+//
+//HudInputHandler doesn't use its action adapter
+//
+class NullActionAdapter : public osgGA::GUIActionAdapter
+{
+public:
+	virtual void requestRedraw(){}
+	virtual void requestContinuousUpdate(bool){}
+	virtual void requestWarpPointer(float, float){}
+};
+
+}
+
+static const osg::Vec2 s_hudSize(1280.0f, 720.0f);
+
+//
+//Fill the hud with a grid of numRegions quads, leaving a gap around each so
+//some picks miss
+//
+static void AddRegionGrid(unsigned int numRegions)
+{
+	unsigned int columns = 1;
+	while(columns*columns < numRegions){columns++;}
+	unsigned int rows = (numRegions+columns-1)/columns;
+	osg::Vec2 cell(s_hudSize.x()/columns, s_hudSize.y()/rows);
+
+	for(unsigned int i=0; i<numRegions; i++)
+	{
+		osg::Vec2 corner(cell.x()*(i%columns), cell.y()*(i/columns));
+		osg::ref_ptr<Region> region = new Region();
+		region->CreateWithAsset(corner, cell*0.8f, "Quad");
+		Hud::Inst()->AddRegion(region.get());
+	}
+}
+
+static void SetMouseMove(osgGA::GUIEventAdapter& ea, const osg::Vec2& pos, double time)
+{
+	ea.setEventType(osgGA::GUIEventAdapter::MOVE);
+	ea.setInputRange(0.0f, 0.0f, s_hudSize.x(), s_hudSize.y());
+	ea.setMouseYOrientation(osgGA::GUIEventAdapter::Y_INCREASING_UPWARDS);
+	ea.setX(pos.x());
+	ea.setY(pos.y());
+	ea.setTime(time);
+}
+
+static void RunHudInputBenchmarks(BenchmarkReport& report, unsigned int numRegions, unsigned int numEvents)
+{
+	Hud::Inst()->Create(s_hudSize);
+	AddRegionGrid(numRegions);
+
+	std::ostringstream countName;
+	countName << numRegions;
+
+	//the same random mouse path for both
+	hogbox::Random random(1);
+	std::vector<osg::Vec2> path(numEvents);
+	for(unsigned int i=0; i<numEvents; i++){
+		path[i] = osg::Vec2(random.NextFloat(0.0f, s_hudSize.x()), random.NextFloat(0.0f, s_hudSize.y()));
+	}
+
+	osg::ref_ptr<osgGA::GUIEventAdapter> ea = new osgGA::GUIEventAdapter();
+	osg::ref_ptr<HudInputEvent> hudEvent = new HudInputEvent();
+
+	BenchmarkTimer timer;
+	for(unsigned int i=0; i<numEvents; i++){
+		SetMouseMove(*ea.get(), path[i], i/60.0);
+		hudEvent->SetEvent(ON_MOUSE_MOVE, *ea.get(), s_hudSize);
+		Hud::Inst()->HandleInputEvent(*hudEvent.get());
+	}
+	report.Add("hud/dispatch/"+countName.str(), numEvents, timer.ElapsedMs());
+
+	osg::ref_ptr<HudInputHandler> input = new HudInputHandler(NULL, s_hudSize);
+	NullActionAdapter actionAdapter;
+
+	timer.Restart();
+	for(unsigned int i=0; i<numEvents; i++){
+		SetMouseMove(*ea.get(), path[i], i/60.0);
+		input->handle(*ea.get(), actionAdapter);
+	}
+	report.Add("hud/pick/"+countName.str(), numEvents, timer.ElapsedMs());
+
+	input = NULL;
+	Hud::Inst(true);
+}
+
+static void RunHudTextBenchmarks(BenchmarkReport& report, unsigned int numRegions, unsigned int numFrames)
+{
+	Hud::Inst()->Create(s_hudSize);
+
+	std::vector<osg::ref_ptr<TextRegion> > regions(numRegions);
+	for(unsigned int i=0; i<numRegions; i++)
+	{
+		regions[i] = new TextRegion();
+		regions[i]->CreateWithLabel(osg::Vec2(0.0f, (float)(i%20)*32.0f), osg::Vec2(200.0f, 32.0f), "Quad", "Score: 0");
+		Hud::Inst()->AddRegion(regions[i].get());
+	}
+
+	//build the strings outside the timer
+	std::vector<std::string> labels(numFrames);
+	for(unsigned int f=0; f<numFrames; f++){
+		std::ostringstream label;
+		label << "Score: " << f*125;
+		labels[f] = label.str();
+	}
+
+	std::ostringstream countName;
+	countName << numRegions;
+
+	BenchmarkTimer timer;
+	for(unsigned int f=0; f<numFrames; f++){
+		for(unsigned int i=0; i<numRegions; i++){
+			regions[i]->SetText(labels[f]);
+		}
+	}
+	report.Add("hud/text_set/"+countName.str(), numRegions*numFrames, timer.ElapsedMs());
+
+	regions.clear();
+	Hud::Inst(true);
+}
+
+void RunHudBenchmarks(BenchmarkReport& report, bool quick)
+{
+	static const unsigned int s_regionCounts[3] = {16, 128, 1024};
+	unsigned int numRegionCounts = quick ? 2 : 3;
+	unsigned int numEvents = quick ? 1000 : 10000;
+
+	for(unsigned int i=0; i<numRegionCounts; i++){
+		RunHudInputBenchmarks(report, s_regionCounts[i], numEvents);
+	}
+
+	RunHudTextBenchmarks(report, quick ? 16 : 64, quick ? 60 : 600);
+}
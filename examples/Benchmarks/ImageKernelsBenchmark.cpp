@@ -0,0 +1,153 @@
+// ImageKernelsBenchmark.cpp : Video frame kernels at 720p, 1080p and 4K.
+//
+// Each kernel is run with every instruction set the cpu supports, the output of
+// the vector paths is compared against the scalar reference. The remap kernels
+// undistort through a CameraCalibration table, whose build is timed on its own
+//
+
+#include "Benchmark.h"
+
+#include <hogboxVision/ImageKernels.h>
+#include <hogboxVision/CameraCalibration.h>
+
+#include <cstdlib>
+#include <sstream>
+
+using namespace hogboxVision;
+
+typedef std::vector<unsigned char> ByteVector;
+
+struct FrameSize
+{
+	const char* _name;
+	unsigned int _width;
+	unsigned int _height;
+};
+
+static std::string BenchName(const std::string& kernel, const FrameSize& size, ImageKernels::InstructionSet set){
+	std::ostringstream name;
+	name << "image/" << kernel << "/" << size._name << "/" << ImageKernels::GetInstructionSetName(set);
+	return name.str();
+}
+
+static void FillRandom(ByteVector& bytes){
+	srand(1);
+	for(unsigned int i=0; i<bytes.size(); i++){
+		bytes[i] = (unsigned char)(rand() & 0xFF);
+	}
+}
+
+//
+//Kernels to time, each works on the frame buffers in place or into dst
+//
+enum KernelType{
+	FLIP_HORIZONTAL_RGB,
+	FLIP_HORIZONTAL_RGBA,
+	FLIP_VERTICAL,
+	DEINTERLACE_BOB,
+	DEINTERLACE_BLEND,
+	SWAP_RED_BLUE,
+	YUY2_TO_RGBA,
+	NV12_TO_RGBA,
+	I420_TO_RGB,
+	DOWNSCALE_RGBA,
+	REMAP_GRAY,
+	REMAP_RGBA,
+	NUM_KERNELS
+};
+
+static const char* s_kernelNames[NUM_KERNELS] = {
+	"flip_h_rgb", "flip_h_rgba", "flip_v", "deinterlace_bob", "deinterlace_blend",
+	"swap_rb_rgba", "yuy2_to_rgba", "nv12_to_rgba", "i420_to_rgb", "downscale_rgba",
+	"remap_gray", "remap_rgba"
+};
+
+static void RunKernel(KernelType kernel, const FrameSize& size, const RemapTable& table, const ByteVector& yuv, ByteVector& frame, ByteVector& dst)
+{
+	unsigned int w = size._width;
+	unsigned int h = size._height;
+	switch(kernel)
+	{
+		case FLIP_HORIZONTAL_RGB: ImageKernels::FlipHorizontal(&frame[0], w, h, 3, w*3); break;
+		case FLIP_HORIZONTAL_RGBA: ImageKernels::FlipHorizontal(&frame[0], w, h, 4, w*4); break;
+		case FLIP_VERTICAL: ImageKernels::FlipVertical(&frame[0], w*4, h, w*4); break;
+		case DEINTERLACE_BOB: ImageKernels::Deinterlace(&frame[0], w*4, h, w*4, ImageKernels::BOB); break;
+		case DEINTERLACE_BLEND: ImageKernels::Deinterlace(&frame[0], w*4, h, w*4, ImageKernels::BLEND); break;
+		case SWAP_RED_BLUE: ImageKernels::SwapRedBlue(&frame[0], w, h, 4, w*4); break;
+		case YUY2_TO_RGBA: ImageKernels::ConvertYUVToRGB(ImageKernels::YUY2, &yuv[0], w, h, w*2, &dst[0], 4, w*4); break;
+		case NV12_TO_RGBA: ImageKernels::ConvertYUVToRGB(ImageKernels::NV12, &yuv[0], w, h, w, &dst[0], 4, w*4); break;
+		case I420_TO_RGB: ImageKernels::ConvertYUVToRGB(ImageKernels::I420, &yuv[0], w, h, w, &dst[0], 3, w*3); break;
+		case DOWNSCALE_RGBA: ImageKernels::Downscale2x(&frame[0], w, h, w*4, 4, &dst[0], (w/2)*4); break;
+		case REMAP_GRAY: ImageKernels::Remap(&frame[0], w, 1, table, &dst[0], w); break;
+		case REMAP_RGBA: ImageKernels::Remap(&frame[0], w*4, 4, table, &dst[0], w*4); break;
+		default: break;
+	}
+}
+
+void RunImageKernelsBenchmarks(BenchmarkReport& report, bool quick)
+{
+	FrameSize sizes[3] = {{"720p", 1280, 720}, {"1080p", 1920, 1080}, {"4k", 3840, 2160}};
+	unsigned int numSizes = quick ? 1 : 3;
+	unsigned int iterations = quick ? 5 : 20;
+
+	//the sets to compare, scalar first as the reference
+	std::vector<ImageKernels::InstructionSet> sets;
+	sets.push_back(ImageKernels::SCALAR);
+	ImageKernels::InstructionSet best = ImageKernels::GetBestInstructionSet();
+	if(best == ImageKernels::NEON){
+		sets.push_back(ImageKernels::NEON);
+	}else{
+		if(best >= ImageKernels::SSE2){sets.push_back(ImageKernels::SSE2);}
+		if(best >= ImageKernels::AVX2){sets.push_back(ImageKernels::AVX2);}
+	}
+
+	for(unsigned int s=0; s<numSizes; s++)
+	{
+		const FrameSize& size = sizes[s];
+		ByteVector source(size._width*size._height*4);
+		ByteVector yuv(size._width*size._height*2);
+		FillRandom(source);
+		FillRandom(yuv);
+
+		//a moderately barrel distorted lens with the default field of view
+		osg::ref_ptr<CameraCalibration> calibration = new CameraCalibration();
+		calibration->ChangeSize(size._width, size._height);
+		calibration->SetDistortion(-0.28, 0.09, 0.0005, -0.0003, -0.01);
+		BenchmarkTimer tableTimer;
+		RemapTablePtr table = calibration->GetUndistortTable(size._width, size._height);
+		std::ostringstream tableName;
+		tableName << "image/undistort_table/" << size._name;
+		report.Add(tableName.str(), 1, tableTimer.ElapsedMs());
+
+		for(unsigned int k=0; k<NUM_KERNELS; k++)
+		{
+			ByteVector reference;
+			for(unsigned int i=0; i<sets.size(); i++)
+			{
+				ImageKernels::SetInstructionSet(sets[i]);
+				ByteVector frame = source;
+				ByteVector dst(size._width*size._height*4);
+
+				//one untimed run to compare against the scalar output
+				RunKernel((KernelType)k, size, *table, yuv, frame, dst);
+				frame.insert(frame.end(), dst.begin(), dst.end());
+				if(i == 0){
+					reference.swap(frame);
+				}else if(frame != reference){
+					std::cout << "    WARNING: " << ImageKernels::GetInstructionSetName(sets[i])
+							<< " " << s_kernelNames[k] << " differs from scalar" << std::endl;
+				}
+
+				frame = source;
+				BenchmarkTimer timer;
+				for(unsigned int it=0; it<iterations; it++){
+					RunKernel((KernelType)k, size, *table, yuv, frame, dst);
+				}
+				report.Add(BenchName(s_kernelNames[k], size, sets[i]), iterations, timer.ElapsedMs());
+			}
+		}
+	}
+
+	//back to automatic selection
+	ImageKernels::SetInstructionSet(best);
+}
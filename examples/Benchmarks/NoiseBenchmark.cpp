@@ -0,0 +1,232 @@
+// NoiseBenchmark.cpp : Random numbers and procedural noise.
+//
+// The random helpers are timed against the rand() based versions Noise.h used
+// to have, on one thread and shared by the pool. Each noise type is sampled
+// point by point and a row at a time, the rows are compared against the points,
+// then noise images are filled serially and on the pool
+//
+
+#include "Benchmark.h"
+
+#include <hogbox/Noise.h>
+#include <hogbox/WorkStealingPool.h>
+
+#include <osg/ImageUtils>
+
+#include <cstdlib>
+#include <cmath>
+#include <sstream>
+
+using namespace hogbox;
+
+//
+//The helpers as they were, on the global rand() state
+//
+static inline float LegacyRandFloat(){
+	return rand()/(float(RAND_MAX)+1);
+}
+
+struct LegacyBinaryNoiseOperator
+{
+	inline float genNoise()const{return LegacyRandFloat() >= 0.5f ? 1.0f : 0.0f;}
+	inline void luminance(float& l) const {l = genNoise();}
+	inline void alpha(float& a) const {a = genNoise();}
+	inline void luminance_alpha(float& l,float& a) const {l = a = genNoise();}
+	inline void rgb(float& r,float& g,float& b) const {r = g = b = genNoise();}
+	inline void rgba(float& r,float& g,float& b,float& a) const {r = g = b = a = genNoise();}
+};
+
+//
+//Draws floats on a pool thread, with rand() or the threads own generator
+//
+class DrawTask : public PoolTask
+{
+public:
+	DrawTask(unsigned int count, bool legacy, float* sum)
+		: PoolTask(),
+		_count(count),
+		_legacy(legacy),
+		p_sum(sum)
+	{
+	}
+	virtual void Run(){
+		float sum = 0.0f;
+		if(_legacy){
+			for(unsigned int i=0; i<_count; i++){sum += LegacyRandFloat();}
+		}else{
+			Random& random = GetThreadRandom();
+			for(unsigned int i=0; i<_count; i++){sum += random.NextFloat();}
+		}
+		*p_sum = sum;
+	}
+protected:
+	virtual ~DrawTask(void){}
+protected:
+	unsigned int _count;
+	bool _legacy;
+	float* p_sum;
+};
+
+//
+//Keep the draws from being removed without printing them
+//
+static volatile float s_sink = 0.0f;
+
+static void RunRandomBenchmarks(BenchmarkReport& report, bool quick)
+{
+	unsigned int count = quick ? 1000000 : 10000000;
+	std::vector<float> values(count);
+	std::ostringstream countName;
+	countName << count/1000000 << "M/";
+	std::string drawn = countName.str();
+
+	//sum the draws so the loops aren't optimised away
+	float sum = 0.0f;
+
+	srand(1);
+	BenchmarkTimer legacyTimer;
+	for(unsigned int i=0; i<count; i++){sum += LegacyRandFloat();}
+	report.Add("noise/rand_float/"+drawn+"legacy_rand", 1, legacyTimer.ElapsedMs());
+
+	SetSeed(1);
+	BenchmarkTimer helperTimer;
+	for(unsigned int i=0; i<count; i++){sum += RandFloat();}
+	report.Add("noise/rand_float/"+drawn+"thread_random", 1, helperTimer.ElapsedMs());
+
+	Random random(1);
+	BenchmarkTimer nextTimer;
+	for(unsigned int i=0; i<count; i++){sum += random.NextFloat();}
+	report.Add("noise/rand_float/"+drawn+"random_next", 1, nextTimer.ElapsedMs());
+
+	BenchmarkTimer fillTimer;
+	random.Fill(&values[0], count);
+	report.Add("noise/rand_float/"+drawn+"random_fill", 1, fillTimer.ElapsedMs());
+
+	BenchmarkTimer intTimer;
+	for(unsigned int i=0; i<count; i++){sum += (float)random.NextInt(-100, 100);}
+	report.Add("noise/rand_int_range/"+drawn+"random_next", 1, intTimer.ElapsedMs());
+
+	//every pool thread drawing at once, rand() shares one state between them
+	WorkStealingPool* pool = WorkStealingPool::Inst();
+	unsigned int numTasks = (pool->GetNumThreads()+1)*4;
+	std::vector<float> sums(numTasks);
+	for(unsigned int legacy=0; legacy<2; legacy++)
+	{
+		osg::ref_ptr<TaskGroup> group = new TaskGroup();
+		BenchmarkTimer timer;
+		for(unsigned int i=0; i<numTasks; i++){
+			pool->Submit(new DrawTask(count/numTasks, legacy == 1, &sums[i]), group.get());
+		}
+		pool->Wait(group.get());
+		report.Add("noise/rand_float_pool/"+drawn+(legacy == 1 ? "legacy_rand" : "thread_random"), 1, timer.ElapsedMs());
+	}
+
+	for(unsigned int i=0; i<numTasks; i++){sum += sums[i];}
+	s_sink = sum;
+
+	//binary noise images through modifyImage
+	unsigned int size = quick ? 512 : 2048;
+	std::ostringstream legacyName, newName;
+	legacyName << "noise/binary_image/" << size << "/legacy_rand";
+	newName << "noise/binary_image/" << size << "/random";
+
+	osg::ref_ptr<osg::Image> image = new osg::Image();
+	image->allocateImage(size, size, 1, GL_LUMINANCE, GL_UNSIGNED_BYTE, 1);
+	BenchmarkTimer legacyImageTimer;
+	osg::modifyImage(image.get(), LegacyBinaryNoiseOperator());
+	report.Add(legacyName.str(), 1, legacyImageTimer.ElapsedMs());
+
+	BenchmarkTimer imageTimer;
+	FillGreyScaleBinaryNoiseImage2D(image.get(), 0.0f, 1.0f, 1);
+	report.Add(newName.str(), 1, imageTimer.ElapsedMs());
+}
+
+static const char* s_noiseTypeNames[3] = {"value", "perlin", "simplex"};
+
+static void RunNoiseSampleBenchmarks(BenchmarkReport& report, bool quick)
+{
+	unsigned int size = quick ? 256 : 1024;
+	std::vector<float> points(size);
+	std::vector<float> rows(size);
+
+	//a cell every 16 points, as a texture with a few octaves would see
+	float step = 1.0f/16.0f;
+
+	for(unsigned int type=0; type<3; type++)
+	{
+		NoiseGenerator noise((NoiseGenerator::NoiseType)type, 1);
+		for(unsigned int dims=2; dims<=3; dims++)
+		{
+			std::ostringstream name;
+			name << "noise/" << s_noiseTypeNames[type] << "_" << dims << "d/rows_of_" << size;
+
+			float sum = 0.0f;
+			float maxDifference = 0.0f;
+			BenchmarkTimer pointTimer;
+			for(unsigned int t=0; t<size; t++){
+				float y = (float)t*step;
+				for(unsigned int s=0; s<size; s++){
+					float x = -8.0f + (float)s*step;
+					points[s] = dims == 2 ? noise.Sample(x, y) : noise.Sample(x, y, 0.5f);
+				}
+				sum += points[size/2];
+			}
+			report.Add(name.str()+"/point", size, pointTimer.ElapsedMs());
+
+			BenchmarkTimer rowTimer;
+			for(unsigned int t=0; t<size; t++){
+				float y = (float)t*step;
+				if(dims == 2){
+					noise.SampleRow(&rows[0], size, -8.0f, step, y);
+				}else{
+					noise.SampleRow(&rows[0], size, -8.0f, step, y, 0.5f);
+				}
+				sum += rows[size/2];
+			}
+			report.Add(name.str()+"/row", size, rowTimer.ElapsedMs());
+
+			//compare the last row of each
+			for(unsigned int s=0; s<size; s++){
+				float difference = fabsf(points[s]-rows[s]);
+				if(difference > maxDifference){maxDifference = difference;}
+			}
+			if(maxDifference > 1e-4f){
+				std::cout << "    WARNING: " << name.str() << " row differs from points by " << maxDifference << std::endl;
+			}
+			if(sum < -1e30f){std::cout << sum << std::endl;}
+		}
+	}
+}
+
+static void RunNoiseImageBenchmarks(BenchmarkReport& report, bool quick)
+{
+	unsigned int size = quick ? 512 : 2048;
+	unsigned int volumeSize = quick ? 32 : 128;
+	NoiseGenerator noise(NoiseGenerator::PERLIN_NOISE, 1);
+	FractalSettings settings(8.0f, 4, 2.0f, 0.5f, 1.0f);
+
+	for(unsigned int parallel=0; parallel<2; parallel++)
+	{
+		WorkStealingPool* pool = parallel ? WorkStealingPool::Inst() : NULL;
+		const char* variant = parallel ? "/pool" : "/serial";
+
+		std::ostringstream name;
+		name << "noise/fbm_image_2d/" << size << variant;
+		BenchmarkTimer timer;
+		osg::ref_ptr<osg::Image> image = CreateNoiseImage2D(size, size, GL_RGBA, noise, settings, pool);
+		report.Add(name.str(), 1, timer.ElapsedMs());
+
+		std::ostringstream volumeName;
+		volumeName << "noise/fbm_image_3d/" << volumeSize << variant;
+		BenchmarkTimer volumeTimer;
+		osg::ref_ptr<osg::Image> volume = CreateNoiseImage3D(volumeSize, volumeSize, volumeSize, GL_LUMINANCE, noise, settings, pool);
+		report.Add(volumeName.str(), 1, volumeTimer.ElapsedMs());
+	}
+}
+
+void RunNoiseBenchmarks(BenchmarkReport& report, bool quick)
+{
+	RunRandomBenchmarks(report, quick);
+	RunNoiseSampleBenchmarks(report, quick);
+	RunNoiseImageBenchmarks(report, quick);
+}
@@ -0,0 +1,126 @@
+// PhysicsBenchmark.cpp : Particle system stepped per component vs the batched integrator.
+//
+// The baseline calls PhysicsComponent::OnUpdate once per particle, the batched runs step
+// the same particles from a PhysicsBodyArrays with each instruction set this build has
+//
+
+#include "Benchmark.h"
+
+#include <hogboxStage/PhysicsComponent.h>
+#include <hogboxStage/PhysicsIntegrator.h>
+
+#include <cstdlib>
+#include <cmath>
+#include <sstream>
+
+using namespace hogboxStage;
+
+static float RandomFloat(){
+	return (float)rand()/(float)RAND_MAX;
+}
+
+static std::string BenchName(const std::string& method, const std::string& path, unsigned int numParticles){
+	std::ostringstream name;
+	name << "physics/" << method << "/" << path << "/" << numParticles;
+	return name.str();
+}
+
+//
+//Fill the arrays with a fountain of particles
+//
+static void EmitParticles(PhysicsBodyArrays& bodies, unsigned int numParticles)
+{
+	srand(1);
+	bodies.Clear();
+	bodies.Reserve(numParticles);
+	for(unsigned int i=0; i<numParticles; i++){
+		osg::Vec3 velocity((RandomFloat()-0.5f)*2.0f, (RandomFloat()-0.5f)*2.0f, 5.0f+RandomFloat()*5.0f);
+		bodies.AddBody(osg::Vec3(0.0f,0.0f,0.0f), velocity, 0.5f+RandomFloat());
+	}
+}
+
+//
+//Per component baseline, one virtual OnUpdate per particle
+//
+static void RunComponentBaseline(BenchmarkReport& report, unsigned int numParticles, unsigned int numSteps, const float& timeStep)
+{
+	srand(1);
+	std::vector<PhysicsComponentPtr> particles(numParticles);
+	for(unsigned int i=0; i<numParticles; i++){
+		particles[i] = new PhysicsComponent();
+		particles[i]->SetMass(0.5f+RandomFloat());
+		particles[i]->SetVelocity(osg::Vec3((RandomFloat()-0.5f)*2.0f, (RandomFloat()-0.5f)*2.0f, 5.0f+RandomFloat()*5.0f));
+	}
+
+	ComponentEventPtr update = new ComponentUpdate(osg::FrameStamp(), timeStep);
+	osg::Vec3 gravity(0.0f, 0.0f, -9.81f);
+
+	BenchmarkTimer timer;
+	for(unsigned int s=0; s<numSteps; s++){
+		for(unsigned int i=0; i<numParticles; i++){
+			particles[i]->AddForce(gravity*particles[i]->GetMass());
+			particles[i]->OnUpdate(update);
+		}
+	}
+	report.Add(BenchName("euler", "component", numParticles), numSteps, timer.ElapsedMs());
+}
+
+//
+//Batched integrator with one instruction set, returns the final position of
+//the last particle so the paths can be compared
+//
+static osg::Vec3 RunBatched(BenchmarkReport& report, PhysicsIntegrator::Method method, PhysicsIntegrator::InstructionSet set,
+							unsigned int numParticles, unsigned int numSteps, const float& timeStep)
+{
+	PhysicsBodyArrays bodies;
+	EmitParticles(bodies, numParticles);
+
+	PhysicsIntegratorPtr integrator = new PhysicsIntegrator(method);
+	integrator->SetGravity(osg::Vec3(0.0f, 0.0f, -9.81f));
+	integrator->SetInstructionSet(set);
+
+	BenchmarkTimer timer;
+	for(unsigned int s=0; s<numSteps; s++){
+		integrator->Integrate(bodies, timeStep);
+	}
+	std::string methodName = method == PhysicsIntegrator::VERLET ? "verlet" : "euler";
+	report.Add(BenchName(methodName, PhysicsIntegrator::GetInstructionSetName(integrator->GetInstructionSet()), numParticles),
+				numSteps, timer.ElapsedMs());
+
+	//bulk copy out, i.e. into a particle vertex array
+	if(set == PhysicsIntegrator::SCALAR){
+		std::vector<osg::Vec3> positions(numParticles);
+		timer.Restart();
+		for(unsigned int s=0; s<numSteps; s++){
+			bodies.CopyPositions(&positions[0]);
+		}
+		report.Add(BenchName(methodName, "copy_positions", numParticles), numSteps, timer.ElapsedMs());
+	}
+
+	return bodies.GetPosition(numParticles-1);
+}
+
+void RunPhysicsBenchmarks(BenchmarkReport& report, bool quick)
+{
+	unsigned int numParticles = quick ? 10000 : 100000;
+	unsigned int numSteps = quick ? 20 : 100;
+	float timeStep = 1.0f/60.0f;
+
+	RunComponentBaseline(report, numParticles, numSteps, timeStep);
+
+	PhysicsIntegrator::Method methods[2] = {PhysicsIntegrator::SEMI_IMPLICIT_EULER, PhysicsIntegrator::VERLET};
+	for(unsigned int m=0; m<2; m++)
+	{
+		osg::Vec3 scalarResult;
+		for(int set=PhysicsIntegrator::SCALAR; set<=(int)PhysicsIntegrator::GetBestInstructionSet(); set++)
+		{
+			osg::Vec3 result = RunBatched(report, methods[m], (PhysicsIntegrator::InstructionSet)set, numParticles, numSteps, timeStep);
+			if(set == PhysicsIntegrator::SCALAR){
+				scalarResult = result;
+			}else if((result-scalarResult).length() > 1e-3f){
+				std::cout << "    WARNING: " << PhysicsIntegrator::GetInstructionSetName((PhysicsIntegrator::InstructionSet)set)
+						<< " result differs from scalar" << std::endl;
+			}
+		}
+	}
+}
@@ -0,0 +1,64 @@
+// ProfilerBenchmark.cpp : Cost of the profiler markers.
+//
+// The same empty scope is timed with the profiler disabled, which is what
+// shipping builds pay for every HOGBOX_PROFILE_SCOPE, and enabled. Counters
+// are timed enabled, then a full set of ring buffers is written as a trace
+//
+
+#include "Benchmark.h"
+
+#include <hogbox/Profiler.h>
+
+#include <sstream>
+
+using namespace hogbox;
+
+//
+//Keep the loop from being removed around an empty scope
+//
+static volatile unsigned int s_sink = 0;
+
+static void TimeScopes(BenchmarkReport& report, const std::string& name, unsigned int count)
+{
+	BenchmarkTimer timer;
+	for(unsigned int i=0; i<count; i++){
+		HOGBOX_PROFILE_SCOPE("ProfilerBenchmark::scope");
+		s_sink = s_sink + i;
+	}
+	report.Add(name, count, timer.ElapsedMs());
+}
+
+void RunProfilerBenchmarks(BenchmarkReport& report, bool quick)
+{
+#ifdef HOGBOX_NO_PROFILER
+	std::cout << "    WARNING: Built with HOGBOX_NO_PROFILER, the markers are compiled out" << std::endl;
+#endif
+
+	unsigned int count = quick ? 100000 : 1000000;
+	Profiler* profiler = Profiler::Inst();
+	bool wasEnabled = Profiler::IsEnabled();
+
+	Profiler::SetEnabled(false);
+	TimeScopes(report, "profiler/scope_disabled", count);
+
+	Profiler::SetEnabled(true);
+	profiler->Clear();
+	TimeScopes(report, "profiler/scope_enabled", count);
+
+	BenchmarkTimer timer;
+	for(unsigned int i=0; i<count; i++){
+		HOGBOX_PROFILE_COUNTER("ProfilerBenchmark::counter", (double)i);
+	}
+	report.Add("profiler/counter_enabled", count, timer.ElapsedMs());
+
+	//the buffer wrapped above, so this is a full buffer of events
+	std::ostringstream trace;
+	timer.Restart();
+	profiler->WriteChromeTrace(trace);
+	std::ostringstream traceName;
+	traceName << "profiler/write_chrome_trace/" << profiler->GetBufferSize();
+	report.Add(traceName.str(), 1, timer.ElapsedMs());
+
+	profiler->Clear();
+	Profiler::SetEnabled(wasEnabled);
+}
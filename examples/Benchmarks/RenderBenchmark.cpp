@@ -0,0 +1,256 @@
+// RenderBenchmark.cpp : Frames drawn into an offscreen pbuffer.
+//
+// A viewer is given a pbuffer context rather than a window, so the suite runs
+// without a desktop. Run with --software-gl to draw with mesa's software
+// renderer, on linux it still needs an x server, i.e. xvfb-run. Each case
+// draws a few frames to compile its shaders and upload its textures before
+// the timed frames, then waits for the gl to finish so the gpu work is counted
+//
+
+#include "Benchmark.h"
+
+#include <hogboxHUD/Hud.h>
+#include <hogboxHUD/TextRegion.h>
+#include <hogboxVision/RTTPass.h>
+
+#include <osg/GL>
+#include <osgViewer/Viewer>
+
+#include <sstream>
+
+using namespace hogboxHUD;
+
+#ifndef WIN32
+#define SHADER_COMPAT \
+"#ifndef GL_ES\n" \
+"#if (__VERSION__ <= 110)\n" \
+"#define lowp\n" \
+"#define mediump\n" \
+"#define highp\n" \
+"#endif\n" \
+"#endif\n"
+#else
+#define SHADER_COMPAT ""
+#endif
+
+static const char* blurVertSource = {
+	SHADER_COMPAT
+	"attribute vec4 osg_Vertex;\n"
+	"attribute vec4 osg_MultiTexCoord0;\n"
+	"uniform mat4 osg_ModelViewProjectionMatrix;\n"
+	"varying highp vec2 texCoord0;\n"
+	"void main(void) {\n"
+	"  gl_Position = osg_ModelViewProjectionMatrix * osg_Vertex;\n"
+	"  texCoord0 = osg_MultiTexCoord0.xy;\n"
+	"}\n"
+};
+
+//a 3x3 box blur, about the cost of the vision passes filters
+static const char* blurFragSource = {
+	SHADER_COMPAT
+	"uniform sampler2D inputTexture;\n"
+	"uniform highp vec2 texelSize;\n"
+	"varying highp vec2 texCoord0;\n"
+	"void main(void) {\n"
+	"  highp vec4 sum = vec4(0.0);\n"
+	"  for(int y=-1; y<=1; y++){\n"
+	"    for(int x=-1; x<=1; x++){\n"
+	"      sum += texture2D(inputTexture, texCoord0 + vec2(float(x), float(y))*texelSize);\n"
+	"    }\n"
+	"  }\n"
+	"  gl_FragColor = sum / 9.0;\n"
+	"}\n"
+};
+
+static const osg::Vec2 s_hudSize(1280.0f, 720.0f);
+
+enum{
+	WARM_UP_FRAMES = 5
+};
+
+//
+//Viewer drawing into a pbuffer the size of the hud, single threaded so the
+//frames are timed on this thread
+//
+static osgViewer::Viewer* CreatePbufferViewer()
+{
+	osg::ref_ptr<osg::GraphicsContext::Traits> traits = new osg::GraphicsContext::Traits;
+	traits->x = 0;
+	traits->y = 0;
+	traits->width = (int)s_hudSize.x();
+	traits->height = (int)s_hudSize.y();
+	traits->red = 8;
+	traits->green = 8;
+	traits->blue = 8;
+	traits->alpha = 8;
+	traits->depth = 24;
+	traits->windowDecoration = false;
+	traits->doubleBuffer = false;
+	traits->sharedContext = 0;
+	traits->pbuffer = true;
+	traits->vsync = false;
+
+	osg::ref_ptr<osg::GraphicsContext> gc = osg::GraphicsContext::createGraphicsContext(traits.get());
+	if(!gc.valid()){return NULL;}
+
+	//the hud and pass shaders use the osg_ attributes and uniforms
+	gc->getState()->setUseModelViewAndProjectionUniforms(true);
+	gc->getState()->setUseVertexAttributeAliasing(true);
+
+	osgViewer::Viewer* viewer = new osgViewer::Viewer();
+	viewer->setThreadingModel(osgViewer::Viewer::SingleThreaded);
+	//keep the context current to finish it after the timed frames
+	viewer->setReleaseContextAtEndOfFrameHint(false);
+	viewer->getCamera()->setGraphicsContext(gc.get());
+	viewer->getCamera()->setViewport(new osg::Viewport(0, 0, traits->width, traits->height));
+	viewer->getCamera()->setProjectionMatrixAsPerspective(45.0, s_hudSize.x()/s_hudSize.y(), 1.0, 1000.0);
+	viewer->getCamera()->setClearColor(osg::Vec4(0.0f, 0.0f, 0.0f, 1.0f));
+	return viewer;
+}
+
+//
+//Draw the warm up frames then time numFrames, calling update before each
+//
+template <typename U>
+static void TimeFrames(BenchmarkReport& report, const std::string& name, osgViewer::Viewer* viewer, unsigned int numFrames, U& update)
+{
+	for(unsigned int f=0; f<WARM_UP_FRAMES; f++){
+		update(f);
+		viewer->frame();
+	}
+	glFinish();
+
+	BenchmarkTimer timer;
+	for(unsigned int f=0; f<numFrames; f++){
+		update(f);
+		viewer->frame();
+	}
+	glFinish();
+	report.Add(name, numFrames, timer.ElapsedMs());
+}
+
+namespace {
+
+struct NoUpdate
+{
+	void operator()(unsigned int){}
+};
+
+//
+//Change every text regions label each frame
+//
+struct TextUpdate
+{
+	TextUpdate(std::vector<osg::ref_ptr<TextRegion> >& regions) : _regions(regions){}
+	void operator()(unsigned int frame){
+		std::ostringstream label;
+		label << "Score: " << frame*125;
+		for(unsigned int i=0; i<_regions.size(); i++){
+			_regions[i]->SetText(label.str());
+		}
+	}
+	std::vector<osg::ref_ptr<TextRegion> >& _regions;
+};
+
+}
+
+static void RunHudRenderBenchmarks(BenchmarkReport& report, osgViewer::Viewer* viewer, unsigned int numRegions, unsigned int numFrames)
+{
+	std::ostringstream countName;
+	countName << numRegions;
+
+	Hud::Inst()->Create(s_hudSize);
+	viewer->setSceneData(Hud::Inst()->GetHudNode());
+
+	unsigned int columns = 1;
+	while(columns*columns < numRegions){columns++;}
+	unsigned int rows = (numRegions+columns-1)/columns;
+	osg::Vec2 cell(s_hudSize.x()/columns, s_hudSize.y()/rows);
+
+	for(unsigned int i=0; i<numRegions; i++)
+	{
+		osg::ref_ptr<Region> region = new Region();
+		region->CreateWithAsset(osg::Vec2(cell.x()*(i%columns), cell.y()*(i/columns)), cell*0.8f, "Quad");
+		Hud::Inst()->AddRegion(region.get());
+	}
+	NoUpdate noUpdate;
+	TimeFrames(report, "render/hud_quads/"+countName.str(), viewer, numFrames, noUpdate);
+
+	viewer->setSceneData(NULL);
+	Hud::Inst(true);
+
+	Hud::Inst()->Create(s_hudSize);
+	viewer->setSceneData(Hud::Inst()->GetHudNode());
+
+	std::vector<osg::ref_ptr<TextRegion> > texts(numRegions);
+	for(unsigned int i=0; i<numRegions; i++)
+	{
+		texts[i] = new TextRegion();
+		texts[i]->CreateWithLabel(osg::Vec2(cell.x()*(i%columns), cell.y()*(i/columns)), cell*0.8f, "Quad", "Score: 0");
+		Hud::Inst()->AddRegion(texts[i].get());
+	}
+	TextUpdate textUpdate(texts);
+	TimeFrames(report, "render/hud_text/"+countName.str(), viewer, numFrames, textUpdate);
+
+	viewer->setSceneData(NULL);
+	texts.clear();
+	Hud::Inst(true);
+}
+
+static void RunRTTPassBenchmark(BenchmarkReport& report, osgViewer::Viewer* viewer, int size, unsigned int numFrames)
+{
+	osg::ref_ptr<osg::Image> image = new osg::Image();
+	image->allocateImage(size, size, 1, GL_RGBA, GL_UNSIGNED_BYTE);
+	for(unsigned int i=0; i<image->getTotalSizeInBytes(); i++){image->data()[i] = (unsigned char)(i*7);}
+	osg::ref_ptr<osg::Texture2D> input = new osg::Texture2D(image.get());
+
+	hogboxVision::RTTPass::RTTArgs args;
+	args.outWidth = size;
+	args.outHeight = size;
+	args.requiredInCount = 1;
+	args.inputTextures["inputTexture"] = input;
+	args.vertexShaderFile = blurVertSource;
+	args.fragmentShaderFile = blurFragSource;
+	args.shaderFileIsSource = true;
+
+	osg::ref_ptr<hogboxVision::RTTPass> pass = new hogboxVision::RTTPass();
+	pass->setName("RenderBenchmark blur");
+	if(!pass->Init(args)){
+		std::cout << "    WARNING: Failed to init the rtt pass" << std::endl;
+		return;
+	}
+	pass->getRoot()->getOrCreateStateSet()->addUniform(new osg::Uniform("texelSize", osg::Vec2(1.0f/size, 1.0f/size)));
+	viewer->setSceneData(pass->getRoot().get());
+
+	std::ostringstream name;
+	name << "render/rtt_pass/" << size << "x" << size;
+	NoUpdate noUpdate;
+	TimeFrames(report, name.str(), viewer, numFrames, noUpdate);
+
+	viewer->setSceneData(NULL);
+}
+
+void RunRenderBenchmarks(BenchmarkReport& report, bool quick)
+{
+	osg::ref_ptr<osgViewer::Viewer> viewer = CreatePbufferViewer();
+	if(!viewer.valid()){
+		std::cout << "    WARNING: Failed to create a pbuffer context, skipping the render suite. "
+				  << "Run with --software-gl, and under xvfb-run if there is no display" << std::endl;
+		return;
+	}
+	viewer->realize();
+	if(!viewer->isRealized()){
+		std::cout << "    WARNING: Failed to realize the pbuffer viewer, skipping the render suite" << std::endl;
+		return;
+	}
+
+	unsigned int numFrames = quick ? 30 : 300;
+
+	RunHudRenderBenchmarks(report, viewer.get(), quick ? 16 : 128, numFrames);
+
+	static const int s_passSizes[2] = {512, 1024};
+	unsigned int numPassSizes = quick ? 1 : 2;
+	for(unsigned int i=0; i<numPassSizes; i++){
+		RunRTTPassBenchmark(report, viewer.get(), s_passSizes[i], numFrames);
+	}
+}
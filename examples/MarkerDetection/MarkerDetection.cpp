@@ -0,0 +1,253 @@
+// MarkerDetection.cpp : Runs the PlanarMarkerTracker over synthetic frames.
+//
+// usage: hogbox_markerdetection [--frames n] [--seed n] [--serial] [--width w --height h] [--save frame.png]
+//
+// Each frame renders two markers at random poses in front of a camera with the
+// default intrinsics, with a lighting gradient, blur from supersampling and
+// noise. The tracker is run on each frame and the found corners and poses are
+// compared with the ones the markers were rendered at
+//
+
+#include <hogboxVision/PlanarMarkerTracker.h>
+
+#include <osg/Image>
+#include <osg/Timer>
+#include <osgDB/WriteFile>
+
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+
+using namespace hogboxVision;
+
+static double RandomUniform(){
+	return ((double)rand()+0.5)/((double)RAND_MAX+1.0);
+}
+
+static double RandomGaussian(){
+	return sqrt(-2.0*log(RandomUniform())) * cos(2.0*osg::PI*RandomUniform());
+}
+
+//
+//A marker to render, its pose in the camera frame (x right, y down, z forward)
+//as the columns of rotation and the translation
+//
+struct SyntheticMarker
+{
+	unsigned int _id;
+	double _width;
+	osg::ref_ptr<osg::Image> _image;
+	osg::Vec3d _axes[3];
+	osg::Vec3d _translation;
+	PlanarTrackedObject* p_object;
+};
+
+//
+//A pose facing the camera within maxTilt degrees, somewhere in view
+//
+static void RandomPose(SyntheticMarker& marker, double maxTilt, const osg::Vec3d& centre)
+{
+	osg::Vec3d axis(RandomGaussian(), RandomGaussian(), 0.0);
+	axis.normalize();
+	osg::Quat tilt(osg::DegreesToRadians(maxTilt * RandomUniform()), axis);
+	osg::Quat spin(2.0 * osg::PI * RandomUniform(), osg::Vec3d(0.0, 0.0, 1.0));
+	osg::Quat rotation = spin * tilt;
+	//marker x right, y up the image, z towards the camera
+	marker._axes[0] = rotation * osg::Vec3d(1.0, 0.0, 0.0);
+	marker._axes[1] = rotation * osg::Vec3d(0.0, -1.0, 0.0);
+	marker._axes[2] = rotation * osg::Vec3d(0.0, 0.0, -1.0);
+	marker._translation = centre;
+}
+
+static osg::Vec2d Project(const CameraCalibration* cc, const osg::Vec3d& point)
+{
+	return osg::Vec2d(cc->GetFocalLengthX() * point.x() / point.z() + cc->GetPrincipalPoint().x(),
+					cc->GetFocalLengthY() * point.y() / point.z() + cc->GetPrincipalPoint().y());
+}
+
+//
+//The marker image value seen through pixel (x,y), or -1 if it isn't hit
+//
+static double SampleMarker(const CameraCalibration* cc, const SyntheticMarker& marker, double x, double y)
+{
+	osg::Vec3d ray((x - cc->GetPrincipalPoint().x()) / cc->GetFocalLengthX(), (y - cc->GetPrincipalPoint().y()) / cc->GetFocalLengthY(), 1.0);
+	double facing = ray * marker._axes[2];
+	if(fabs(facing) < 1e-9){return -1.0;}
+	osg::Vec3d hit = ray * ((marker._translation * marker._axes[2]) / facing) - marker._translation;
+
+	//the marker image has a one cell margin, 8 cells over 6 of marker
+	double extent = marker._width * 0.5 * (PlanarMarkerTracker::MARKER_CELLS + 2) / PlanarMarkerTracker::MARKER_CELLS;
+	double u = ((hit * marker._axes[0]) / extent + 1.0) * 0.5;
+	double v = (1.0 - (hit * marker._axes[1]) / extent) * 0.5;
+	if(u < 0.0 || v < 0.0 || u >= 1.0 || v >= 1.0){return -1.0;}
+	const osg::Image* image = marker._image.get();
+	unsigned int size = image->s();
+	return image->data()[(unsigned int)(v * size) * size + (unsigned int)(u * size)];
+}
+
+//
+//Render the markers into image, 3x3 supersampled
+//
+static void RenderFrame(const CameraCalibration* cc, const std::vector<SyntheticMarker>& markers, double noise, osg::Image* image)
+{
+	unsigned int width = image->s();
+	unsigned int height = image->t();
+	for(unsigned int y=0; y<height; y++)
+	{
+		unsigned char* row = image->data(0, y);
+		for(unsigned int x=0; x<width; x++)
+		{
+			//uneven lighting
+			double light = 0.6 + 0.4 * (double)x / (double)width;
+			double sum = 0.0;
+			for(unsigned int sy=0; sy<3; sy++){
+				for(unsigned int sx=0; sx<3; sx++){
+					double px = x + (sx - 1.0) / 3.0;
+					double py = y + (sy - 1.0) / 3.0;
+					double value = 90.0 + 40.0 * sin(px * 0.02) * cos(py * 0.03);
+					for(unsigned int m=0; m<markers.size(); m++){
+						double sample = SampleMarker(cc, markers[m], px, py);
+						if(sample >= 0.0){value = 30.0 + sample * (200.0 / 255.0);}
+					}
+					sum += value;
+				}
+			}
+			double value = light * sum / 9.0 + noise * RandomGaussian();
+			unsigned char pixel = (unsigned char)(value < 0.0 ? 0.0 : (value > 255.0 ? 255.0 : value));
+			row[x*3] = pixel;
+			row[x*3+1] = pixel;
+			row[x*3+2] = pixel;
+		}
+	}
+	image->dirty();
+}
+
+//
+//Angle between the tracked pose and the rendered one, degrees
+//
+static double RotationError(const osg::Matrix& pose, const SyntheticMarker& marker)
+{
+	//rendered axes in osg's camera frame
+	double trace = 0.0;
+	for(unsigned int i=0; i<3; i++){
+		osg::Vec3d tracked(pose(i,0), pose(i,1), pose(i,2));
+		osg::Vec3d rendered(marker._axes[i].x(), -marker._axes[i].y(), -marker._axes[i].z());
+		trace += tracked * rendered;
+	}
+	double c = (trace - 1.0) * 0.5;
+	return osg::RadiansToDegrees(acos(c > 1.0 ? 1.0 : (c < -1.0 ? -1.0 : c)));
+}
+
+int main(int argc, char** argv)
+{
+	unsigned int numFrames = 50;
+	unsigned int seed = 1;
+	unsigned int width = 640;
+	unsigned int height = 480;
+	bool serial = false;
+	std::string saveFile;
+	for(int i=1; i<argc; i++){
+		if(strcmp(argv[i], "--frames") == 0 && i+1 < argc){
+			numFrames = (unsigned int)atoi(argv[++i]);
+		}else if(strcmp(argv[i], "--seed") == 0 && i+1 < argc){
+			seed = (unsigned int)atoi(argv[++i]);
+		}else if(strcmp(argv[i], "--width") == 0 && i+1 < argc){
+			width = (unsigned int)atoi(argv[++i]);
+		}else if(strcmp(argv[i], "--height") == 0 && i+1 < argc){
+			height = (unsigned int)atoi(argv[++i]);
+		}else if(strcmp(argv[i], "--serial") == 0){
+			serial = true;
+		}else if(strcmp(argv[i], "--save") == 0 && i+1 < argc){
+			saveFile = argv[++i];
+		}
+	}
+	srand(seed);
+
+	osg::ref_ptr<PlanarMarkerTracker> tracker = new PlanarMarkerTracker();
+	tracker->SetUseParallel(!serial);
+	if(!tracker->InitTracker(width, height, "")){return 1;}
+	const CameraCalibration* cc = tracker->GetCameraCalibration();
+
+	//two markers 100 units wide
+	std::vector<SyntheticMarker> markers(2);
+	const unsigned int ids[2] = {0x2B4D, 0x9E61};
+	for(unsigned int m=0; m<markers.size(); m++){
+		markers[m]._id = ids[m];
+		markers[m]._width = 100.0;
+		markers[m]._image = PlanarMarkerTracker::CreateMarkerImage(ids[m], 16, 1);
+		markers[m].p_object = tracker->AddMarker(ids[m], 100.0f);
+		if(!markers[m].p_object){return 1;}
+	}
+
+	osg::ref_ptr<osg::Image> frame = new osg::Image();
+	frame->allocateImage(width, height, 1, GL_RGB, GL_UNSIGNED_BYTE, 1);
+	frame->setOrigin(osg::Image::TOP_LEFT);
+
+	unsigned int numRendered = 0;
+	unsigned int numFound = 0;
+	unsigned int numWrongId = 0;
+	double cornerErrorSum = 0.0;
+	double positionErrorSum = 0.0;
+	double angleErrorSum = 0.0;
+	double trackingMs = 0.0;
+	for(unsigned int f=0; f<numFrames; f++)
+	{
+		//one on the left one on the right, 350 to 900 units away
+		for(unsigned int m=0; m<markers.size(); m++){
+			double depth = 350.0 + 550.0 * RandomUniform();
+			double side = (m == 0 ? -0.22 : 0.22) * depth;
+			RandomPose(markers[m], 55.0, osg::Vec3d(side, (RandomUniform() - 0.5) * 0.3 * depth, depth));
+		}
+		RenderFrame(cc, markers, 4.0, frame.get());
+		if(f == 0 && !saveFile.empty()){osgDB::writeImageFile(*frame, saveFile);}
+
+		osg::Timer_t start = osg::Timer::instance()->tick();
+		tracker->Update(frame);
+		trackingMs += osg::Timer::instance()->delta_m(start, osg::Timer::instance()->tick());
+
+		const std::vector<PlanarMarkerCandidate>& candidates = tracker->GetLastCandidates();
+		for(unsigned int c=0; c<candidates.size(); c++){
+			bool known = false;
+			for(unsigned int m=0; m<markers.size(); m++){known = known || candidates[c]._id == (int)markers[m]._id;}
+			if(!known){numWrongId++;}
+		}
+
+		for(unsigned int m=0; m<markers.size(); m++)
+		{
+			const SyntheticMarker& marker = markers[m];
+			numRendered++;
+			PlanarTrackedObject* object = marker.p_object;
+			if(!object->IsObjectDetected()){continue;}
+			numFound++;
+
+			//corners top left clockwise
+			std::vector<osg::Vec2> corners = object->GetCorners();
+			const double cornerSigns[4][2] = {{-1.0, 1.0}, {1.0, 1.0}, {1.0, -1.0}, {-1.0, -1.0}};
+			for(unsigned int c=0; c<4; c++){
+				osg::Vec3d point = marker._translation + marker._axes[0] * (cornerSigns[c][0] * marker._width * 0.5)
+															+ marker._axes[1] * (cornerSigns[c][1] * marker._width * 0.5);
+				osg::Vec2d expected = Project(cc, point);
+				cornerErrorSum += (osg::Vec2d(corners[c].x(), corners[c].y()) - expected).length2();
+			}
+
+			osg::Matrix pose = object->GetTransform();
+			osg::Vec3d expectedPosition(marker._translation.x(), -marker._translation.y(), -marker._translation.z());
+			positionErrorSum += (osg::Vec3d(pose.getTrans()) - expectedPosition).length2();
+			double angle = RotationError(pose, marker);
+			angleErrorSum += angle * angle;
+		}
+	}
+
+	std::cout << numFrames << " frames " << width << "x" << height << (serial ? " serial" : " parallel") << std::endl
+			<< std::fixed << std::setprecision(3)
+			<< "detected " << numFound << "/" << numRendered << " markers, " << numWrongId << " wrong ids" << std::endl;
+	if(numFound > 0){
+		std::cout << "rms corner error " << sqrt(cornerErrorSum / (numFound * 4)) << " px" << std::endl
+				<< "rms position error " << sqrt(positionErrorSum / numFound) << " units" << std::endl
+				<< "rms angle error " << sqrt(angleErrorSum / numFound) << " degrees" << std::endl;
+	}
+	std::cout << "tracking " << trackingMs / numFrames << " ms/frame" << std::endl;
+	return numFound > 0 ? 0 : 1;
+}
@@ -0,0 +1,263 @@
+// PoseReplay.cpp : Replays pose recordings through a tracker's pose filter.
+//
+// usage: hogbox_posereplay [--filter filter.xml] [--out filtered.txt] [--seed n] [recording.txt]
+//
+// Recordings are written by TrackedObject::StartRecording. With no recording a
+// synthetic sequence is generated (a marker circling, pausing and turning, with
+// noise, dropouts and outliers) and the filtered poses are also compared to the
+// ground truth. The poses go through a HogTracker so the filtering runs exactly
+// as it does live
+//
+
+#include <hogboxVision/HogTracker.h>
+#include <hogboxVision/PoseFilter.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+
+using namespace hogboxVision;
+
+//
+//ReplayTracker
+//Reports one recorded sample per update for its single object
+//
+class ReplayTracker : public HogTracker
+{
+public:
+	ReplayTracker()
+		: HogTracker(),
+		p_sample(NULL)
+	{
+	}
+
+	void Replay(const TrackedPoseSample& sample){
+		p_sample = &sample;
+		_frameTime = sample._time;
+		this->Update();
+	}
+
+	virtual void UpdateTracking(){
+		if(!p_sample || _trackedObjects.empty()){return;}
+		//recorded misses aren't reported, the tracked object works that out itself
+		if(!p_sample->_isDetected){return;}
+		_trackedObjects[0]->UpdateMarker(true, p_sample->_pose);
+	}
+
+protected:
+	virtual ~ReplayTracker(void){}
+
+	const TrackedPoseSample* p_sample;
+};
+
+static double RandomUniform(){
+	return ((double)rand()+0.5)/((double)RAND_MAX+1.0);
+}
+
+static double RandomGaussian(){
+	return sqrt(-2.0*log(RandomUniform())) * cos(2.0*osg::PI*RandomUniform());
+}
+
+static double AngleBetween(const osg::Quat& a, const osg::Quat& b){
+	double w = fabs((a.inverse()*b).w());
+	return 2.0 * acos(w > 1.0 ? 1.0 : w);
+}
+
+static TrackedPoseSample MakeSample(double time, const osg::Vec3d& position, const osg::Quat& rotation){
+	TrackedPoseSample sample;
+	sample._time = time;
+	sample._isDetected = true;
+	sample._confidence = 1.0f;
+	sample._position = position;
+	sample._rotation = rotation;
+	sample._pose = osg::Matrix::rotate(rotation) * osg::Matrix::translate(position);
+	return sample;
+}
+
+//
+//Ten seconds at 60hz of a marker 500 units away circling, pausing and turning.
+//Detections get 1 unit/0.5 degree noise, 5% are missed in bursts, 1% jump 200 units
+//
+static void GenerateSequence(std::vector<TrackedPoseSample>& recorded, std::vector<TrackedPoseSample>& truth)
+{
+	const double rate = 60.0;
+	const unsigned int numFrames = 600;
+	unsigned int dropout = 0;
+	for(unsigned int i=0; i<numFrames; i++)
+	{
+		double time = (double)i / rate;
+
+		//move for 2 seconds then hold still for 1
+		double phase = fmod(time, 3.0);
+		double moving = floor(time / 3.0) * 2.0 + (phase < 2.0 ? phase : 2.0);
+		osg::Vec3d position(100.0 * cos(moving), 100.0 * sin(moving), -500.0);
+		osg::Quat rotation(moving * 0.5, osg::Vec3d(0.0, 0.0, 1.0));
+		truth.push_back(MakeSample(time, position, rotation));
+
+		osg::Vec3d noisyPosition = position + osg::Vec3d(RandomGaussian(), RandomGaussian(), RandomGaussian());
+		osg::Vec3d axis(RandomGaussian(), RandomGaussian(), RandomGaussian());
+		axis.normalize();
+		osg::Quat noisyRotation = rotation * osg::Quat(osg::DegreesToRadians(0.5 * RandomGaussian()), axis);
+		TrackedPoseSample sample = MakeSample(time, noisyPosition, noisyRotation);
+
+		if(dropout == 0 && RandomUniform() < 0.01){dropout = 5;}
+		if(dropout > 0){
+			dropout--;
+			sample._isDetected = false;
+			sample._confidence = 0.0f;
+		}else if(RandomUniform() < 0.01){
+			sample = MakeSample(time, noisyPosition + osg::Vec3d(200.0, 0.0, 0.0), noisyRotation);
+		}
+		recorded.push_back(sample);
+	}
+}
+
+//
+//Stats of a pose sequence against the input and, if there is one, the truth
+//
+struct ReplayStats
+{
+	ReplayStats()
+		: _numDetected(0),
+		_numHeld(0),
+		_numRejected(0),
+		_jitterSum(0.0),
+		_jitterCount(0),
+		_positionErrorSum(0.0),
+		_angleErrorSum(0.0),
+		_errorCount(0)
+	{
+	}
+
+	void Print(const std::string& name)const{
+		std::cout << std::left << std::setw(10) << name << std::right << std::fixed << std::setprecision(4)
+				<< " detected " << std::setw(5) << _numDetected
+				<< " held " << std::setw(4) << _numHeld
+				<< " rejected " << std::setw(4) << _numRejected
+				<< " jitter " << std::setw(9) << (_jitterCount > 0 ? sqrt(_jitterSum/_jitterCount) : 0.0);
+		if(_errorCount > 0){
+			std::cout << " rms error " << std::setw(9) << sqrt(_positionErrorSum/_errorCount)
+					<< " rms angle " << std::setw(9) << osg::RadiansToDegrees(sqrt(_angleErrorSum/_errorCount));
+		}
+		std::cout << std::endl;
+	}
+
+	unsigned int _numDetected;
+	unsigned int _numHeld;
+	unsigned int _numRejected;
+
+	//rms second difference of the position between consecutive detections
+	double _jitterSum;
+	unsigned int _jitterCount;
+
+	double _positionErrorSum;
+	double _angleErrorSum;
+	unsigned int _errorCount;
+};
+
+static void Measure(const std::vector<TrackedPoseSample>& output, const std::vector<TrackedPoseSample>& input,
+					const std::vector<TrackedPoseSample>& truth, ReplayStats& stats)
+{
+	for(unsigned int i=0; i<output.size(); i++)
+	{
+		const TrackedPoseSample& sample = output[i];
+		if(!sample._isDetected){
+			if(input[i]._isDetected){stats._numRejected++;}
+			continue;
+		}
+		stats._numDetected++;
+		if(!input[i]._isDetected){stats._numHeld++;}
+
+		if(i >= 2 && output[i-1]._isDetected && output[i-2]._isDetected){
+			osg::Vec3d secondDifference = sample._pose.getTrans() - output[i-1]._pose.getTrans() * 2.0 + output[i-2]._pose.getTrans();
+			stats._jitterSum += secondDifference.length2();
+			stats._jitterCount++;
+		}
+
+		if(i < truth.size()){
+			stats._positionErrorSum += (sample._pose.getTrans() - truth[i]._position).length2();
+			double angle = AngleBetween(sample._pose.getRotate(), truth[i]._rotation);
+			stats._angleErrorSum += angle * angle;
+			stats._errorCount++;
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::string filterFile;
+	std::string outFile;
+	std::string recordingFile;
+	unsigned int seed = 1;
+	for(int i=1; i<argc; i++){
+		if(strcmp(argv[i], "--filter") == 0 && i+1 < argc){
+			filterFile = argv[++i];
+		}else if(strcmp(argv[i], "--out") == 0 && i+1 < argc){
+			outFile = argv[++i];
+		}else if(strcmp(argv[i], "--seed") == 0 && i+1 < argc){
+			seed = (unsigned int)atoi(argv[++i]);
+		}else{
+			recordingFile = argv[i];
+		}
+	}
+
+	std::vector<TrackedPoseSample> input;
+	std::vector<TrackedPoseSample> truth;
+	if(!recordingFile.empty()){
+		if(!ReadPoseRecording(recordingFile, input)){return 1;}
+	}else{
+		srand(seed);
+		GenerateSequence(input, truth);
+	}
+
+	//the filter from the xml, or outlier rejection, hold and one euro
+	osg::ref_ptr<PoseFilter> filter;
+	if(!filterFile.empty()){
+		filter = ReadPoseFilterFromXmlFile(filterFile);
+		if(!filter.valid()){return 1;}
+	}else{
+		PoseFilterChain* chain = new PoseFilterChain();
+		chain->AddFilter(new OutlierRejectionPoseFilter());
+		chain->AddFilter(new HoldPoseFilter());
+		chain->AddFilter(new OneEuroPoseFilter());
+		filter = chain;
+	}
+
+	TrackedObjectPtr object = new TrackedObject();
+	object->setName("replay");
+	osg::ref_ptr<ReplayTracker> tracker = new ReplayTracker();
+	tracker->AddTrackedObject(object);
+	tracker->SetPoseFilter(filter.get());
+
+	std::vector<TrackedPoseSample> output;
+	for(unsigned int i=0; i<input.size(); i++){
+		tracker->Replay(input[i]);
+		output.push_back(object->GetPoseSample());
+	}
+
+	//the input as published without a filter, for comparison
+	ReplayStats rawStats;
+	ReplayStats filteredStats;
+	Measure(input, input, truth, rawStats);
+	Measure(output, input, truth, filteredStats);
+	std::cout << input.size() << " samples" << (truth.empty() ? "" : " (synthetic)") << std::endl;
+	rawStats.Print("raw");
+	filteredStats.Print("filtered");
+
+	if(!outFile.empty())
+	{
+		std::ofstream out(outFile.c_str());
+		if(!out.is_open()){
+			std::cerr << "Failed to open '" << outFile << "' for writing." << std::endl;
+			return 1;
+		}
+		out << "# filtered\n# time detected confidence tx ty tz qx qy qz qw\n";
+		for(unsigned int i=0; i<output.size(); i++){
+			WritePoseSample(out, output[i]);
+		}
+	}
+	return 0;
+}
@@ -91,13 +91,9 @@ public:
     {}
     
     virtual osgDB::ReaderWriter::ReadResult readImage(const std::string& filename, const osgDB::ReaderWriter::Options* options){
-        OSG_FATAL << "READ IMAGE CALLBACK '" << filename << "', osgPath: '" << _osgPath << "'." <<std::endl;
-        //
-        osg::setNotifyLevel(osg::DEBUG_FP);
+        OSG_INFO << "READ IMAGE CALLBACK '" << filename << "', osgPath: '" << _osgPath << "'." <<std::endl;
         if(_archive.get()){
-            osgDB::ReaderWriter::ReadResult result = _archive->readImage(_osgPath+"/"+filename, options);
-            osg::setNotifyLevel(osg::FATAL);
-            return result;
+            return _archive->readImage(_osgPath+"/"+filename, options);
         }
         return osgDB::ReadFileCallback::readImage(filename, options);
     }
@@ -229,6 +225,10 @@ public:
     //does the loaded model require caching
     bool CacheModel(){return _cache;}
     
+    //
+    //file the model is loaded from
+    const std::string& GetFileName()const{return _filename;}
+    
     //
     //return the loaded model
     osg::Node* GetLoadedModel(){
@@ -290,6 +290,11 @@ public:
     //subsequent asset loads are loaded from the archive
     bool OpenAndMountArchive(const std::string& fileName);
     
+    //
+    //True if assets are being read from a mounted archive rather
+    //than the file system
+    bool HasArchive()const{return _archive.valid();}
+    
     //
     //Call once per frame if using paging (getOrLoad with a callback)
     void Sync();
@@ -343,6 +348,11 @@ public:
     //release all objects from the cache
     void ReleaseAssets();
     
+    //
+    //release the cached objects nothing else is using, i.e. to get back
+    //under the MemoryTracker budget. Returns the number released
+    unsigned int ReleaseUnusedAssets();
+    
     //directory helpers
     
     //
@@ -0,0 +1,11 @@
+/* -*-c++-*- */
+//
+//Build options set by cmake
+//
+#ifndef HOGBOX_CONFIG
+#define HOGBOX_CONFIG 1
+
+//compile out the HOGBOX_PROFILE_ markers
+/* #undef HOGBOX_NO_PROFILER */
+
+#endif
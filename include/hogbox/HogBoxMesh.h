@@ -23,6 +23,7 @@
 
 #include <hogbox/HogBoxBase.h>
 #include <hogbox/HogBoxMaterial.h>
+#include <hogbox/NodeNameIndex.h>
 
 namespace hogbox {
 
@@ -57,6 +58,11 @@ public:
 	//apply the visitor
     virtual void apply(osg::Node& node);
 
+	//
+	//Apply the mapping to the geodes in a prebuilt index rather than traversing
+	//the graph, returns true if any geode was mapped
+	bool ApplyToIndex(NodeNameIndex& index);
+
 
 	//
 	//check if the passed string matches any of our matTo names
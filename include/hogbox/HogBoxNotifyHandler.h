@@ -14,11 +14,17 @@
 #pragma once
 
 #include <hogbox/Export.h>
+#include <hogbox/LogSink.h>
+#include <hogbox/LogRingBuffer.h>
 #include <osg/Notify>
-#include <osg/Vec3>
+#include <osg/Timer>
 
-#include <map>
-#include <fstream>
+#include <OpenThreads/Thread>
+#include <OpenThreads/Mutex>
+#include <OpenThreads/Condition>
+#include <OpenThreads/Atomic>
+
+#include <vector>
 
 
 
@@ -31,43 +37,110 @@ namespace hogbox {
 #endif
 	
 //
-//Redirects notify stream to a html file adding html color formating etc
-//for each notify level. If we fail to create the _outputFile stream then
-//the StandardNotifyHandler handler is used
+//Redirects notify stream to a log file and the platforms standard output.
+//notify only copies the message into a LogRingBuffer, a writer thread then
+//passes the queued records to each LogSink, so logging never waits on file
+//or console output and takes no lock. If the buffer fills, messages are
+//dropped and a count of them written once the writer catches up.
+//
+//Messages are also rate limited per call site, taken to be the text before
+//the first ': ' as in "HogBoxManager::ReadNode: ERROR: ...", so a call in a
+//per frame path can't flood the log. Call sites share a small table so two
+//may share a limit.
+//
+//The file sink is chosen by the extension of outputFileName (see
+//CreateFileLogSink), html by default. If the file fails to open only the
+//standard output is used
 class HOGBOX_EXPORT HogBoxNotifyHandler : public PlatformNotifyHandler
 {
 public:
-	HogBoxNotifyHandler(const std::string& outputFileName="./Data/MessageLog.html");
+	HogBoxNotifyHandler(const std::string& outputFileName="./Data/MessageLog.html", unsigned int bufferSize = 1024);
 
     void notify(osg::NotifySeverity severity, const char *message);
 
-protected:
+	//
+	//Add another destination for the log, called from the writer thread
+	void AddSink(LogSink* sink);
 
-	~HogBoxNotifyHandler();
+	//
+	//Maximum messages per second from each call site, 0 for no limit. Default 50
+	void SetRateLimit(unsigned int messagesPerSecond){_rateLimit = messagesPerSecond;}
+	unsigned int GetRateLimit()const{return _rateLimit;}
 
-protected:
+	//
+	//Block until everything queued so far has been written to the sinks
+	void Flush();
 
-	//returns a html style string based on severity to be inserted into <p> tag
-	const std::string CreateHtmlStyleString(osg::NotifySeverity severity);
+	//
+	//Messages lost because the buffer was full, or to the rate limit
+	unsigned int GetNumDropped()const{return _buffer.GetNumDropped();}
+	unsigned int GetNumRateLimited()const{return _numRateLimited;}
 
 protected:
-	struct HtmlStyle{
-		osg::Vec3 fontColor;
-		std::string fontFamily;
-		int fontSize;
 
-		HtmlStyle(osg::Vec3 color=osg::Vec3(0.0,0.0,0.0), int size=15, std::string family="arial")
-		{fontColor=color; fontFamily=family; fontSize=size;}
-	};
+	~HogBoxNotifyHandler();
 
-	//map of notify levels to html styles
-	typedef std::map<osg::NotifySeverity, HtmlStyle> NotifySeverityToHtmlStyleMap;
-	typedef std::pair<osg::NotifySeverity, HtmlStyle> NotifySeverityToHtmlStylePair;
+	//
+	//Returns false if the call site of message has used its limit this second
+	bool AllowMessage(const char* message, double time);
+
+	//
+	//Write the queued records to the sinks, returns the number written
+	unsigned int WriteRecords();
+
+	//
+	//Loop of the writer thread
+	void RunWriter();
+
+	class WriterThread : public OpenThreads::Thread
+	{
+	public:
+		WriterThread(HogBoxNotifyHandler* handler)
+			: OpenThreads::Thread(),
+			p_handler(handler)
+		{
+		}
+		virtual void run(){p_handler->RunWriter();}
+	protected:
+		HogBoxNotifyHandler* p_handler;
+	};
+	friend class WriterThread;
+
+	//
+	//Messages logged from a call site in the current second
+	struct CallSite
+	{
+		OpenThreads::Atomic _second;
+		OpenThreads::Atomic _count;
+	};
 
-	NotifySeverityToHtmlStyleMap _levelToHtmlStyleList;
+protected:
 
-	//our file output stream
-	std::ofstream _outputFile;
+	LogRingBuffer _buffer;
+	osg::Timer_t _startTick;
+
+	//sinks, only used by the writer thread other than in AddSink
+	OpenThreads::Mutex _sinkMutex;
+	std::vector<LogSinkPtr> _sinks;
+	//the record being written, kept to save copying it on the stack each time
+	LogRecord _record;
+
+	//call sites by hash
+	enum{NUM_CALL_SITES = 256};
+	CallSite _callSites[NUM_CALL_SITES];
+	unsigned int _rateLimit;
+	OpenThreads::Atomic _numRateLimited;
+	//losses already reported to the sinks
+	unsigned int _reportedDropped;
+	unsigned int _reportedRateLimited;
+
+	WriterThread* _writerThread;
+	//wakes the writer early for Flush or shutdown
+	OpenThreads::Mutex _wakeMutex;
+	OpenThreads::Condition _wakeCondition;
+	OpenThreads::Condition _flushedCondition;
+	volatile bool _flushRequested;
+	volatile bool _done;
 };
 
-}; //end hogbox namespace
\ No newline at end of file
+}; //end hogbox namespace
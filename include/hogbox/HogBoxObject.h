@@ -41,6 +41,7 @@
 #include <list>
 
 #include <hogbox/HogBoxMesh.h>
+#include <hogbox/NodeNameIndex.h>
 #include <hogbox/HogBoxMaterial.h>
 
 namespace hogbox {
@@ -81,6 +82,14 @@ public:
 	void SetVisible(const bool& vis);
 	bool GetVisible() const;
 
+	//
+	//Name lookup table for the objects graph, built on first use and rebuilt
+	//after AddNodeToObject/SetWrappedNodes change the graph
+	NodeNameIndex& GetNodeNameIndex();
+	//
+	//Call if the graph under the root node is changed directly
+	void InvalidateNodeNameIndex(){_nodeNameIndex.Clear();}
+
 	//
 	//return the first node with the passed name
 	osg::Node* GetNodeByName(const std::string& name, const bool& subString);
@@ -166,6 +175,8 @@ public:
 	//get set the vector of nodes being wrapped by this object
 	NodePtrVector GetWrappedNodes() const;
 	void SetWrappedNodes(const NodePtrVector& nodes);
+	//detach every wrapped node, i.e. before the list is set again on reload
+	void ClearWrappedNodes();
 
 //MeshMappings
 	
@@ -176,6 +187,8 @@ public:
 	//get set the list of mesh mappings
 	std::vector<MeshMappingPtr> GetMeshMappings() const;
 	void SetMeshMappings(const std::vector<MeshMappingPtr>& mappings);
+	//forget the mappings, materials already applied stay on the meshes
+	void ClearMeshMappings();
 
 protected:
 
@@ -226,6 +239,9 @@ protected:
 	//the list of mesh mappings to apply to this object (and all attched model nodes)
 	std::vector<MeshMappingPtr> _meshMappings;
 
+	//name lookups for everything under _root, not copied with the object
+	NodeNameIndex _nodeNameIndex;
+
 	int _nodeMasks;//additional to visible/not
 
 };
@@ -38,6 +38,7 @@
 
 #include <osgGA/TrackballManipulator>
 #include <hogbox/SystemInfo.h>
+#include <hogbox/PresentationClock.h>
 
 
 namespace hogbox {
@@ -230,6 +231,15 @@ public:
 	void SetAASamples(const int& samples);
 	const int& GetAASamples()const;
 
+//presentation
+
+	//
+	//Drive clock from the viewers frame timing, the clock is switched to
+	//FRAME_TIME and latched at the start of each frame() so everything
+	//presenting to it (i.e. video streams) samples the same time in a frame
+	void AddPresentationClock(PresentationClock* clock);
+	void RemovePresentationClock(PresentationClock* clock);
+
 //view/camera
 
     osg::Camera* GetCamera();
@@ -375,6 +385,9 @@ protected:
 	//antialiasing samples
 	int _aaSamples;
 
+	//clocks latched with the frame time each frame
+	std::vector<PresentationClockPtr> _presentationClocks;
+
 //view/camera
 
 	//field of view of camera
@@ -0,0 +1,87 @@
+/* Written by Thomas Hogarth, (C) 2011
+ *
+ * This library is open source and may be redistributed and/or modified under
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+ */
+
+#pragma once
+
+#include <hogbox/Export.h>
+#include <hogbox/LogSink.h>
+
+#include <OpenThreads/Atomic>
+
+namespace hogbox {
+
+//
+//LogRingBuffer
+//Fixed size queue of LogRecords pushed from any number of threads and popped by
+//one. Pushing takes no lock, a producer claims the next slot with an atomic
+//increment, copies its record in and then publishes the slot through the slots
+//sequence number, which the consumer checks before reading it.
+//
+//When the consumer falls behind records are dropped rather than making the
+//producer wait. The last eighth of the slots is kept as headroom for producers
+//that pass the full check together, a producer only waits if more threads than
+//that push at once into a full buffer
+//
+class HOGBOX_EXPORT LogRingBuffer
+{
+public:
+
+	//
+	//size is rounded up to a power of two, of at least 16
+	LogRingBuffer(unsigned int size = 1024);
+	~LogRingBuffer(void);
+
+	//
+	//Queue a message from any thread, returns false if the buffer is full and
+	//the message was dropped
+	bool Push(osg::NotifySeverity severity, double time, int threadID, const char* message);
+
+	//
+	//Copy the oldest record out, returns false if there is none ready. Only
+	//one thread may pop
+	bool Pop(LogRecord& record);
+
+	unsigned int GetSize()const{return _mask+1;}
+
+	//
+	//Number of records dropped because the buffer was full
+	unsigned int GetNumDropped()const{return _numDropped;}
+
+protected:
+
+	struct Slot
+	{
+		//the index of the record the slot is free for, or that index plus one
+		//once the record has been written
+		OpenThreads::Atomic _sequence;
+		LogRecord _record;
+	};
+
+	Slot* _slots;
+	unsigned int _mask;
+	unsigned int _headroom;
+
+	//index of the next record to push
+	OpenThreads::Atomic _writeIndex;
+	//index of the next record to pop
+	OpenThreads::Atomic _readIndex;
+
+	OpenThreads::Atomic _numDropped;
+
+private:
+	//not copyable
+	LogRingBuffer(const LogRingBuffer&);
+	LogRingBuffer& operator=(const LogRingBuffer&);
+};
+
+}; //end hogbox namespace
@@ -0,0 +1,202 @@
+/* Written by Thomas Hogarth, (C) 2011
+ *
+ * This library is open source and may be redistributed and/or modified under
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+ */
+
+#pragma once
+
+#include <hogbox/Export.h>
+
+#include <osg/Referenced>
+#include <osg/ref_ptr>
+#include <osg/Notify>
+#include <osg/Vec3>
+
+#include <fstream>
+#include <string>
+
+namespace hogbox {
+
+//
+//LogRecord
+//One notify message as queued by HogBoxNotifyHandler. Messages are copied into
+//a fixed size buffer so queuing one allocates nothing, longer messages are cut
+//short
+//
+struct LogRecord
+{
+	enum{
+		MAX_MESSAGE_LENGTH = 480
+	};
+
+	LogRecord()
+		: _severity(osg::NOTICE),
+		_time(0.0),
+		_threadID(0),
+		_length(0)
+	{
+		_message[0] = '\0';
+	}
+
+	//
+	//Copy message, dropping its trailing line ends
+	void SetMessage(const char* message);
+
+	osg::NotifySeverity _severity;
+	//seconds since the handler was created
+	double _time;
+	//id of the OpenThreads thread that logged it, 0 for other threads
+	int _threadID;
+	//message without its line end, null terminated
+	unsigned int _length;
+	char _message[MAX_MESSAGE_LENGTH];
+};
+
+//
+//Returns the name of a notify level, e.g. "WARN"
+//
+extern HOGBOX_EXPORT const char* GetNotifySeverityName(osg::NotifySeverity severity);
+
+//
+//LogSink
+//Destination for the records written by HogBoxNotifyHandler. Sinks are only
+//called from the handlers writer thread
+//
+class HOGBOX_EXPORT LogSink : public osg::Referenced
+{
+public:
+	LogSink()
+		: osg::Referenced()
+	{
+	}
+
+	//
+	//Write one record
+	virtual void Write(const LogRecord& record) = 0;
+
+	//
+	//Called after each batch of records is written
+	virtual void Flush(){}
+
+protected:
+	virtual ~LogSink(void){}
+};
+typedef osg::ref_ptr<LogSink> LogSinkPtr;
+
+//
+//Base for sinks writing to a file
+//
+class HOGBOX_EXPORT FileLogSink : public LogSink
+{
+public:
+	FileLogSink(const std::string& fileName);
+
+	//
+	//False if the file failed to open
+	bool IsOpen()const{return _file.is_open();}
+
+	virtual void Flush(){_file.flush();}
+
+protected:
+	virtual ~FileLogSink(void);
+
+	std::ofstream _file;
+};
+
+//
+//Each record as a line of plain text, e.g.
+//[   12.345] WARN   (1) HogBoxManager::ReadNode: ERROR: ...
+//
+class HOGBOX_EXPORT TextLogSink : public FileLogSink
+{
+public:
+	TextLogSink(const std::string& fileName);
+
+	virtual void Write(const LogRecord& record);
+
+protected:
+	virtual ~TextLogSink(void){}
+};
+
+//
+//Each record as a line of json, e.g.
+//{"time":12.345,"severity":"WARN","thread":1,"message":"..."}
+//
+class HOGBOX_EXPORT JsonLogSink : public FileLogSink
+{
+public:
+	JsonLogSink(const std::string& fileName);
+
+	virtual void Write(const LogRecord& record);
+
+protected:
+	virtual ~JsonLogSink(void){}
+};
+
+//
+//Html page with a <PRE> per record colored by notify level, as HogBoxNotifyHandler
+//has always written
+//
+class HOGBOX_EXPORT HtmlLogSink : public FileLogSink
+{
+public:
+	HtmlLogSink(const std::string& fileName);
+
+	virtual void Write(const LogRecord& record);
+
+protected:
+	virtual ~HtmlLogSink(void);
+
+	//
+	//returns a html style string based on severity to be inserted into <PRE> tag
+	const std::string CreateHtmlStyleString(osg::NotifySeverity severity);
+
+protected:
+	struct HtmlStyle{
+		osg::Vec3 fontColor;
+		std::string fontFamily;
+		int fontSize;
+
+		HtmlStyle(osg::Vec3 color=osg::Vec3(0.0,0.0,0.0), int size=15, std::string family="arial")
+		{fontColor=color; fontFamily=family; fontSize=size;}
+	};
+
+	//style strings of each notify level, built once
+	std::string _levelStyles[osg::DEBUG_FP+1];
+};
+
+//
+//Passes records on to another osg::NotifyHandler, i.e. the platforms standard
+//output
+//
+class HOGBOX_EXPORT NotifyHandlerLogSink : public LogSink
+{
+public:
+	NotifyHandlerLogSink(osg::NotifyHandler* handler);
+
+	virtual void Write(const LogRecord& record);
+
+protected:
+	virtual ~NotifyHandlerLogSink(void){}
+
+	osg::ref_ptr<osg::NotifyHandler> _handler;
+	//record with its line end restored
+	std::string _line;
+};
+
+//
+//Allocate the sink for fileName by its extension, .html/.htm for HtmlLogSink,
+//.json/.jsonl for JsonLogSink, otherwise TextLogSink. NULL if the file can't
+//be created
+//
+extern HOGBOX_EXPORT LogSink* CreateFileLogSink(const std::string& fileName);
+
+}; //end hogbox namespace
@@ -0,0 +1,193 @@
+/* Written by Thomas Hogarth, (C) 2011
+ *
+ * This library is open source and may be redistributed and/or modified under
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+ */
+
+#pragma once
+
+#include <hogbox/Export.h>
+
+#include <osg/Referenced>
+#include <osg/ref_ptr>
+#include <osg/observer_ptr>
+#include <osg/Image>
+#include <osg/Texture>
+#include <osg/Node>
+#include <OpenThreads/Mutex>
+
+#include <map>
+#include <vector>
+#include <string>
+#include <ostream>
+
+namespace hogbox {
+
+//
+//MemoryUsage
+//Bytes held by a set of tracked objects
+//
+struct MemoryUsage
+{
+	MemoryUsage()
+		: _numObjects(0),
+		_cpuBytes(0),
+		_gpuBytes(0)
+	{
+	}
+
+	unsigned int _numObjects;
+	unsigned long long _cpuBytes;
+	unsigned long long _gpuBytes;
+};
+
+//
+//MemoryTracker
+//Estimates the memory held by images, textures, geometry buffers and render
+//targets as they are created through the AssetManager, HogBoxMaterial, the
+//xml database and RTTPass, and keeps it grouped by the file each was loaded
+//from and the uniqueID of the xml node that loaded it.
+//
+//The numbers are estimates from sizes and formats, not driver queries (see
+//SystemInfo::totalDedicatedGLMemory for those where they exist). An image
+//counts its pixel data as cpu memory, a texture counts its gpu copy including
+//mipmaps, geometry buffers count as both once in vertex buffers or display
+//lists. Objects are watched rather than held, a deleted object drops out of
+//the totals on the next query.
+//
+class HOGBOX_EXPORT MemoryTracker : public osg::Referenced
+{
+public:
+
+	enum Category{
+		IMAGE,
+		TEXTURE,
+		//vertex arrays and index buffers
+		GEOMETRY,
+		//textures rendered to by RTTPasses
+		RENDER_TARGET,
+		//fbo attachments that aren't textures, i.e. depth buffers
+		FRAME_BUFFER,
+		NUM_CATEGORIES
+	};
+
+	//
+	//MemoryRecord
+	//What's known about one tracked object
+	//
+	struct MemoryRecord
+	{
+		std::string _name;
+		Category _category;
+		//file it was loaded from
+		std::string _source;
+		//uniqueID of the xml node, or name of the pass/material, it belongs to
+		std::string _owner;
+		unsigned long long _cpuBytes;
+		unsigned long long _gpuBytes;
+	};
+	typedef std::vector<MemoryRecord> MemoryRecordVector;
+	typedef std::map<std::string, MemoryUsage> MemoryUsageMap;
+
+	static MemoryTracker* Inst(bool erase = false);
+
+	MemoryTracker();
+
+	//
+	//Track object or update its record if already tracked. An empty source or
+	//owner leaves the one already recorded, so the last to claim an object
+	//shared by several owners is the one it's counted against
+	void Track(osg::Object* object, Category category, unsigned long long cpuBytes, unsigned long long gpuBytes,
+				const std::string& source = "", const std::string& owner = "");
+
+	//
+	//Track with estimated sizes, without a source images are recorded against
+	//their file name. A textures images are tracked along with it, a node tracks
+	//the buffers of every geometry and the textures of every stateset below it
+	void TrackImage(osg::Image* image, const std::string& source = "", const std::string& owner = "");
+	void TrackTexture(osg::Texture* texture, const std::string& source = "", const std::string& owner = "");
+	void TrackNode(osg::Node* node, const std::string& source = "", const std::string& owner = "");
+
+	//
+	//Track an object of unknown type by whichever of the above fits, other
+	//types are ignored. Used by the xml database for every node it loads
+	void TrackObject(osg::Object* object, const std::string& source = "", const std::string& owner = "");
+
+	void Untrack(osg::Object* object);
+	bool IsTracked(osg::Object* object);
+
+	//
+	//Queries, each drops the records of deleted objects first
+	MemoryUsage GetTotal();
+	MemoryUsage GetTotal(Category category);
+	MemoryUsageMap GetUsageBySource();
+	MemoryUsageMap GetUsageByOwner();
+
+	//
+	//Every record, largest (cpu plus gpu) first
+	MemoryRecordVector GetRecords();
+
+	//
+	//Bytes the app aims to stay under, 0 for no limit
+	void SetBudget(unsigned long long cpuBytes, unsigned long long gpuBytes);
+	unsigned long long GetCPUBudget()const{return _cpuBudget;}
+	unsigned long long GetGPUBudget()const{return _gpuBudget;}
+	bool IsOverBudget();
+
+	//
+	//Write the totals per category, source and owner and the largest
+	//maxRecords objects as text
+	void WriteReport(std::ostream& out, unsigned int maxRecords = 20);
+	bool WriteReport(const std::string& fileName, unsigned int maxRecords = 20);
+
+	static const char* GetCategoryName(Category category);
+
+	//
+	//Size estimates
+
+	//gpu bytes per pixel of an uncompressed internal format, rgb formats
+	//are padded to four bytes as most drivers store them that way
+	static unsigned int EstimatePixelBytes(GLint internalFormat);
+	static unsigned long long EstimateImageBytes(const osg::Image* image);
+	static unsigned long long EstimateTextureBytes(const osg::Texture* texture);
+
+protected:
+
+	virtual ~MemoryTracker(void);
+
+	struct Entry
+	{
+		osg::observer_ptr<osg::Object> _object;
+		MemoryRecord _record;
+	};
+	typedef std::map<osg::Object*, Entry> EntryMap;
+
+	//track with the mutex held, returning the objects record
+	MemoryRecord& TrackLocked(osg::Object* object, Category category, unsigned long long cpuBytes, unsigned long long gpuBytes,
+							const std::string& source, const std::string& owner);
+	MemoryRecord& TrackImageLocked(osg::Image* image, const std::string& source, const std::string& owner);
+	MemoryRecord& TrackTextureLocked(osg::Texture* texture, const std::string& source, const std::string& owner);
+
+	//drop the entries of deleted objects, call with the mutex held
+	void Prune();
+
+protected:
+
+	OpenThreads::Mutex _mutex;
+
+	EntryMap _entries;
+
+	unsigned long long _cpuBudget;
+	unsigned long long _gpuBudget;
+};
+
+typedef osg::ref_ptr<MemoryTracker> MemoryTrackerPtr;
+
+}; //end hogbox namespace
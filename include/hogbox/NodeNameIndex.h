@@ -0,0 +1,110 @@
+/* Written by Thomas Hogarth, (C) 2011
+ *
+ * This library is open source and may be redistributed and/or modified under
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <osg/Node>
+#include <osg/Geode>
+
+#include <hogbox/Export.h>
+
+namespace hogbox {
+
+//
+//NodeNameIndex
+//Name to node lookup table for a graph, built with one traversal. Exact lookups are a
+//multimap search, prefix lookups walk the matching key range and sub string lookups
+//scan the unique names (not the graph) and are cached per search string. Results come
+//back in the order a full traversal would have found them. Geodes are also indexed by
+//the names of their drawables for MeshMappingVisitor. Node masks are ignored, hidden
+//nodes are indexed so hiding/showing parts of the graph does not invalidate it.
+//
+//The index holds raw node pointers, it must be rebuilt or cleared whenever the graph
+//it was built from changes
+//
+class HOGBOX_EXPORT NodeNameIndex
+{
+public:
+	NodeNameIndex();
+
+	//
+	//Index every node below and including root, replacing the current contents
+	void Build(osg::Node* root);
+
+	//
+	//Add the nodes of another subgraph to the index
+	void AddSubgraph(osg::Node* subgraph);
+
+	void Clear();
+
+	//
+	//Has Build been called since the last Clear
+	const bool& IsBuilt()const{return _built;}
+
+	//
+	//Nodes whose name equals name, or contains name in subString mode (matching
+	//the FindNodesByName visitor)
+	void FindNodes(const std::string& name, const bool& subString, std::vector<osg::Node*>& found);
+
+	//
+	//Nodes whose name starts with prefix
+	void FindNodesByPrefix(const std::string& prefix, std::vector<osg::Node*>& found)const;
+
+	//
+	//Geodes holding a drawable whose name equals name, or contains it in subString mode
+	void FindGeodesByDrawableName(const std::string& name, const bool& subString, std::vector<osg::Geode*>& found)const;
+
+	//
+	//Number of nodes visited by the traversal(s) that built the index
+	const unsigned int& GetNumNodes()const{return _numNodes;}
+
+protected:
+
+	//a node and its position in the traversal
+	struct IndexedNode
+	{
+		IndexedNode(osg::Node* node=NULL, unsigned int order=0)
+			: _node(node),
+			_order(order)
+		{
+		}
+		bool operator < (const IndexedNode& rhs)const{return _order < rhs._order;}
+		osg::Node* _node;
+		unsigned int _order;
+	};
+	typedef std::vector<IndexedNode> IndexedNodeVector;
+	typedef std::multimap<std::string, IndexedNode> NameMap;
+
+	class BuildVisitor;
+
+	//
+	//Collect the entries of every unique name containing name
+	static void CollectSubString(const NameMap& names, const std::string& name, IndexedNodeVector& matches);
+
+protected:
+
+	bool _built;
+	unsigned int _numNodes;
+
+	NameMap _nodeNames;
+	NameMap _drawableNames;
+
+	//results of previous sub string searches
+	std::map<std::string, std::vector<osg::Node*> > _subStringCache;
+};
+
+};//end hogbox namespace
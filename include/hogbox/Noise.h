@@ -13,123 +13,231 @@
 
 #pragma once
 
+#include <hogbox/Export.h>
+#include <hogbox/Random.h>
+
 #include <osg/Image>
 #include <time.h>
 
-#ifdef ANDROID
-#include <cstdlib>
-#endif
-
 namespace hogbox {
 	
-	static inline void SetSeed(const unsigned int& seed=-1)
+	class WorkStealingPool;
+
+	//
+	//Random helpers, these draw from the calling threads own generator (see
+	//GetThreadRandom) so are safe to call from any thread
+
+	//seed the generators, a negative seed seeds from the time
+	static inline void SetSeed(int seed=-1)
 	{
 		if(seed>=0)
 		{
-			srand(seed);
+			SetThreadRandomSeed((unsigned int)seed);
 		}else{
-			srand ( time(NULL) );
+			SetThreadRandomSeed((unsigned int)time(NULL));
 		}		
 	}
 	
 	//generates a psuedo-random int b
 	static inline int RandInt()
 	{
-		return rand();
+		return (int)(GetThreadRandom().NextUInt() >> 1);
 	} 
 	
-	//generates a psuedo-random float 
+	//generates a psuedo-random float in [0,1)
 	static inline float RandFloat()
 	{
-		return rand()/(float(RAND_MAX)+1);
+		return GetThreadRandom().NextFloat();
 	} 
 	
 	//generates a psuedo-random int between min and max
-	static inline float RandInt(int min, int max)
+	static inline int RandInt(int min, int max)
 	{
-		if (min>max)
-		{
-			return rand()%((min-max)+1)+max ; 
-		}
-		else
-		{
-			return rand()%((max-min)+1)+min;
-		}    
+		return GetThreadRandom().NextInt(min, max);
 	}
 	
 	//generates a psuedo-random float between min and max
 	static inline float RandFloat(float min, float max)
 	{
-		if (min>max)
-		{
-			return RandFloat()*(min-max)+max;    
-		}
-		else
-		{
-			return RandFloat()*(max-min)+min;
-		}    
+		return GetThreadRandom().NextFloat(min, max);
 	}
 	
 	static inline osg::Vec2 RandVec2(float min, float max)
 	{
-		float disX = hogbox::RandFloat(min, max);
-		float disY = hogbox::RandFloat(min, max);
-		
-		return osg::Vec2(disX,disY);
+		return GetThreadRandom().NextVec2(min, max);
 	}
 	
 	static inline osg::Vec3 RandNormalisedVec3()
 	{
-		float disX = hogbox::RandFloat(-1.0, 1.0);
-		float disY = hogbox::RandFloat(-1.0, 1.0);
-		float disZ = hogbox::RandFloat(-1.0, 1.0);
-		osg::Vec3 vec = osg::Vec3(disX,disY,disZ);
-		vec.normalize();
-		return vec;
+		return GetThreadRandom().NextUnitVec3();
 	}
 	
 	static inline osg::Vec3 RandVec3(float min, float max)
 	{
-		/* generate secret number: */
-		float disX = hogbox::RandFloat(min, max);
-		float disY = hogbox::RandFloat(min, max);
-		float disZ = hogbox::RandFloat(min, max);
-		
-		return osg::Vec3(disX,disY,disZ);
+		return GetThreadRandom().NextVec3(min, max);
 	}
 
 	static inline osg::Vec4 RandVec4(float min, float max)
 	{
-		/* generate secret number: */
-		float disX = hogbox::RandFloat(min, max);
-		float disY = hogbox::RandFloat(min, max);
-		float disZ = hogbox::RandFloat(min, max);
-		float disW = hogbox::RandFloat(min, max);
-		
-		return osg::Vec4(disX,disY,disZ,disW);
+		return GetThreadRandom().NextVec4(min, max);
 	}
 	
-	//binary noise funcs
-	extern osg::ref_ptr<osg::Image> CreateGreyScaleBinaryNoiseImage2D(const int& width, const int& height, 
+	//
+	//FractalSettings
+	//How octaves of noise are summed into fractal brownian motion (fBm). Each
+	//octave is sampled at lacunarity times the frequency of the last and adds
+	//gain times its weight, the sum is normalised back to -1 to 1.
+	//
+	//A tileSize above zero makes the noise repeat every tileSize units along
+	//each axis, by rounding each octaves frequency so a whole number of lattice
+	//cells fit the tile. Tiling isn't supported by simplex noise
+	//
+	struct FractalSettings
+	{
+		FractalSettings(float frequency=1.0f, unsigned int octaves=1, float lacunarity=2.0f, float gain=0.5f, float tileSize=0.0f)
+			: _frequency(frequency),
+			_octaves(octaves),
+			_lacunarity(lacunarity),
+			_gain(gain),
+			_tileSize(tileSize)
+		{
+		}
+
+		float _frequency;
+		unsigned int _octaves;
+		float _lacunarity;
+		float _gain;
+		float _tileSize;
+	};
+
+	//
+	//NoiseGenerator
+	//Coherent noise in one to three dimensions, each sample is roughly -1 to 1 and
+	//the lattice points are one unit apart. The permutation and value tables are
+	//built from the seed, so a generator can be shared between threads once
+	//set up.
+	//
+	//The row functions sample a line of points along x in one call. Points in the
+	//same lattice cell share their corner gradients so only the blend is done per
+	//point, four points at a time with sse2 where available. Simplex noise has no
+	//axis aligned cells and is sampled point by point
+	//
+	class HOGBOX_EXPORT NoiseGenerator
+	{
+	public:
+		enum NoiseType{
+			//smoothly blended random values at the lattice points
+			VALUE_NOISE,
+			//Ken Perlins improved gradient noise
+			PERLIN_NOISE,
+			//gradient noise over a simplex lattice, fewer artifacts along the axes
+			SIMPLEX_NOISE
+		};
+
+		NoiseGenerator(NoiseType type=PERLIN_NOISE, unsigned int seed=0);
+
+		void SetType(NoiseType type){_type = type;}
+		NoiseType GetType()const{return _type;}
+
+		//
+		//Rebuild the tables for seed
+		void SetSeed(unsigned int seed);
+		unsigned int GetSeed()const{return _seed;}
+
+		//
+		//One octave of noise
+		float Sample(float x)const;
+		float Sample(float x, float y)const;
+		float Sample(float x, float y, float z)const;
+
+		//
+		//Fractal noise of settings
+		float Fractal(float x, const FractalSettings& settings)const;
+		float Fractal(float x, float y, const FractalSettings& settings)const;
+		float Fractal(float x, float y, float z, const FractalSettings& settings)const;
+
+		//
+		//Sample count points along x from x stepping dx, dx must not be negative
+		void SampleRow(float* values, unsigned int count, float x, float dx, float y)const;
+		void SampleRow(float* values, unsigned int count, float x, float dx, float y, float z)const;
+
+		//
+		//Fractal noise of settings for count points along x from x stepping dx
+		void FractalRow(float* values, unsigned int count, float x, float dx, float y, const FractalSettings& settings)const;
+		void FractalRow(float* values, unsigned int count, float x, float dx, float y, float z, const FractalSettings& settings)const;
+
+	protected:
+
+		//
+		//Lattice cells repeat every period cells along each axis, a period of
+		//256 is the natural repeat of the permutation table
+		float Sample1D(float x, int period)const;
+		float Sample2D(float x, float y, int periodX, int periodY)const;
+		float Sample3D(float x, float y, float z, int periodX, int periodY, int periodZ)const;
+
+		void SampleRow2D(float* values, unsigned int count, float x, float dx, float y, int periodX, int periodY)const;
+		void SampleRow3D(float* values, unsigned int count, float x, float dx, float y, float z, int periodX, int periodY, int periodZ)const;
+
+		//
+		//Frequency and lattice period of each octave of settings
+		unsigned int GetOctaves(const FractalSettings& settings, float* frequencies, float* weights, int* periods)const;
+
+		float SimplexNoise1D(float x)const;
+		float SimplexNoise2D(float x, float y)const;
+		float SimplexNoise3D(float x, float y, float z)const;
+
+	protected:
+
+		NoiseType _type;
+		unsigned int _seed;
+
+		//shuffled 0-255 repeated twice so hashes can be chained without masking
+		unsigned char _perm[512];
+		//random value of each hash for value noise
+		float _values[256];
+	};
+
+	//
+	//Noise image helpers
+
+	//
+	//Fill an image with fractal noise mapped to 0-1, with the same value in every
+	//channel. Pixel (s,t,r) is sampled at (s/width, t/height, r/depth), so the
+	//frequency is the number of lattice cells across the image and a tileSize
+	//of 1 makes the image tile. Images with one slice use 2d noise.
+	//Rows are filled in parallel on pool when one is passed, otherwise on the
+	//calling thread. Supports GL_UNSIGNED_BYTE and GL_FLOAT data
+	extern HOGBOX_EXPORT bool FillNoiseImage(osg::Image* image, const NoiseGenerator& noise, const FractalSettings& settings,
+											WorkStealingPool* pool = NULL);
+
+	extern HOGBOX_EXPORT osg::ref_ptr<osg::Image> CreateNoiseImage2D(const int& width, const int& height, GLenum pixelFormat,
+																	const NoiseGenerator& noise, const FractalSettings& settings,
+																	WorkStealingPool* pool = NULL);
+	extern HOGBOX_EXPORT osg::ref_ptr<osg::Image> CreateNoiseImage3D(const int& width, const int& height, const int& depth, GLenum pixelFormat,
+																	const NoiseGenerator& noise, const FractalSettings& settings,
+																	WorkStealingPool* pool = NULL);
+
+	//binary noise funcs, a negative seed draws one from the calling threads generator
+	extern HOGBOX_EXPORT osg::ref_ptr<osg::Image> CreateGreyScaleBinaryNoiseImage2D(const int& width, const int& height,
 																	  const float& color1= 0.0f, const float& color2=1.0f,
-																	  const unsigned int& seed = -1);
-	extern osg::ref_ptr<osg::Image> CreateRGBBinaryNoiseImage2D(const int& width, const int& height, 
+																	  const int& seed = -1);
+	extern HOGBOX_EXPORT osg::ref_ptr<osg::Image> CreateRGBBinaryNoiseImage2D(const int& width, const int& height,
 																const osg::Vec3& color1 = osg::Vec3(0,0,0), const osg::Vec3& color2=osg::Vec3(1,1,1),
-																const unsigned int& seed = -1);
-	extern osg::ref_ptr<osg::Image> CreateRGBABinaryNoiseImage2D(const int& width, const int& height, 
+																const int& seed = -1);
+	extern HOGBOX_EXPORT osg::ref_ptr<osg::Image> CreateRGBABinaryNoiseImage2D(const int& width, const int& height,
 																const osg::Vec4& color1 = osg::Vec4(0,0,0,0), const osg::Vec4& color2=osg::Vec4(1,1,1,1),
-																const unsigned int& seed = -1);
+																const int& seed = -1);
 	
 	//binary noise funcs
 	//returns false if image is not gl_luminance
-	extern bool FillGreyScaleBinaryNoiseImage2D(osg::Image* image,
+	extern HOGBOX_EXPORT bool FillGreyScaleBinaryNoiseImage2D(osg::Image* image,
 												const float& color1= 0.0f, const float& color2=1.0f,
-												const unsigned int& seed = -1);
-	extern bool FillRGBBinaryNoiseImage2D(osg::Image* image, 
+												const int& seed = -1);
+	extern HOGBOX_EXPORT bool FillRGBBinaryNoiseImage2D(osg::Image* image,
 										const osg::Vec3& color1 = osg::Vec3(0,0,0), const osg::Vec3& color2=osg::Vec3(1,1,1),
-										const unsigned int& seed = -1);
-	extern bool FillRGBABinaryNoiseImage2D(osg::Image* image, 
+										const int& seed = -1);
+	extern HOGBOX_EXPORT bool FillRGBABinaryNoiseImage2D(osg::Image* image,
 											const osg::Vec4& color1 = osg::Vec4(0,0,0,0), const osg::Vec4& color2=osg::Vec4(1,1,1,1),
-											const unsigned int& seed = -1);
+											const int& seed = -1);
 
 };//end hogbox namespace
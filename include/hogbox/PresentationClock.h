@@ -0,0 +1,99 @@
+/* Written by Thomas Hogarth, (C) 2011
+ *
+ * This library is open source and may be redistributed and/or modified under
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+ */
+
+#pragma once
+
+#include <hogbox/Export.h>
+
+#include <osg/Referenced>
+#include <osg/ref_ptr>
+#include <osg/Timer>
+
+namespace hogbox {
+
+//
+//PresentationClock
+//
+//A pausable time base in seconds shared by everything that has to present in
+//step, i.e. a wall of video streams. The time either runs from an osg::Timer or
+//is latched once per frame by a driver (HogBoxViewer::AddPresentationClock), in
+//which case everything sampling the clock during a frame sees the same time.
+//The clock is meant to be used from the update thread
+//
+class HOGBOX_EXPORT PresentationClock : public osg::Referenced
+{
+public:
+
+	enum TimeSource{
+		//read the timer each time GetTime is called
+		TIMER_TIME,
+		//use the time passed to the last BeginFrame
+		FRAME_TIME
+	};
+
+	PresentationClock();
+
+	//
+	//Change where the time comes from, the presentation time carries on from
+	//its current value
+	void SetTimeSource(const TimeSource& source);
+	const TimeSource& GetTimeSource()const{return _source;}
+
+	//
+	//Latch the frame time (seconds on the drivers own time base) for FRAME_TIME
+	void BeginFrame(double frameTime);
+
+	//
+	//Presentation time in seconds, stops while paused
+	double GetTime()const;
+
+	//
+	//Jump to time
+	void SetTime(double time);
+
+	void Pause();
+	void Resume();
+	const bool& IsPaused()const{return _paused;}
+
+	//
+	//Number of BeginFrame calls and the time between the last two
+	const unsigned int& GetFrameNumber()const{return _frameNumber;}
+	const double& GetFrameInterval()const{return _frameInterval;}
+
+protected:
+
+	virtual ~PresentationClock();
+
+	//time on the current source, before pausing and offsets
+	double GetSourceTime()const;
+
+protected:
+
+	TimeSource _source;
+
+	osg::Timer_t _startTick;
+
+	double _frameTime;
+	double _frameInterval;
+	unsigned int _frameNumber;
+
+	//presentation time is source time minus offset
+	double _offset;
+
+	bool _paused;
+	double _pausedTime;
+};
+
+typedef osg::ref_ptr<PresentationClock> PresentationClockPtr;
+
+};//end hogbox namespace
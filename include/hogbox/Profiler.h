@@ -0,0 +1,282 @@
+/* Written by Thomas Hogarth, (C) 2011
+ *
+ * This library is open source and may be redistributed and/or modified under
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+ */
+
+#pragma once
+
+#include <hogbox/Export.h>
+
+#include <osg/Referenced>
+#include <osg/ref_ptr>
+#include <osg/Timer>
+#include <OpenThreads/Mutex>
+
+#include <set>
+#include <vector>
+#include <string>
+#include <ostream>
+
+namespace osg {
+class Camera;
+}
+
+namespace hogbox {
+
+//
+//ProfileEvent
+//One timed scope or counter sample in a threads ring buffer
+//
+struct ProfileEvent
+{
+	enum Type{
+		//time spent in a scope on the recording thread
+		CPU_SCOPE,
+		//time the gpu spent on the commands between two timer queries,
+		//recorded by the draw thread that issued them
+		GPU_SCOPE,
+		//a value at a point in time, _end is unused
+		COUNTER
+	};
+
+	//names are stored by pointer, use string literals or Profiler::InternName
+	const char* _name;
+	Type _type;
+	osg::Timer_t _start;
+	osg::Timer_t _end;
+	double _value;
+};
+
+//
+//ProfileThread
+//A copy of the events a thread has recorded
+//
+struct ProfileThread
+{
+	unsigned int _id;
+	std::string _name;
+	std::vector<ProfileEvent> _events;
+};
+typedef std::vector<ProfileThread> ProfileThreadVector;
+
+//
+//ProfileScopeStats
+//A named scope averaged over recent frames
+//
+struct ProfileScopeStats
+{
+	std::string _name;
+	bool _gpu;
+	//per frame
+	double _calls;
+	double _averageMs;
+	//longest single call
+	double _maxMs;
+};
+
+//
+//ProfileStats
+//Summary of the last few frames for overlays and logs
+//
+struct ProfileStats
+{
+	ProfileStats()
+		: _numFrames(0),
+		_averageFrameMs(0.0),
+		_maxFrameMs(0.0)
+	{
+	}
+
+	unsigned int _numFrames;
+	double _averageFrameMs;
+	double _maxFrameMs;
+	//most time per frame first
+	std::vector<ProfileScopeStats> _scopes;
+	//latest value of each counter
+	std::vector<std::pair<std::string, double> > _counters;
+};
+
+class ProfileThreadBuffer;
+class ProfileThreadRegistry;
+
+//
+//Profiler
+//Records named cpu scopes, gpu timer queries and counters into a fixed size
+//ring buffer per thread, so recording never locks or allocates once a thread
+//has its buffer and the newest events are always the ones kept.
+//
+//Recording is off until SetEnabled(true), while off a scope costs a single
+//test of a static flag. Build with HOGBOX_NO_PROFILER defined (the cmake
+//option of the same name) to compile the HOGBOX_PROFILE_ macros out entirely.
+//
+//The recorded events can be written as chrome trace event json, to open in
+//chrome://tracing or ui.perfetto.dev, or summarised per frame, see
+//hogboxHUD::ProfilerOverlay to show the summary on screen
+//
+class HOGBOX_EXPORT Profiler : public osg::Referenced
+{
+public:
+
+	static Profiler* Inst(bool erase = false);
+
+	Profiler();
+
+	//
+	//Global recording switch
+	static inline bool IsEnabled(){return s_enabled;}
+	static void SetEnabled(bool enabled);
+
+	//
+	//Events kept per thread, rounded up to a power of two. Applies to
+	//threads that record their first event after the call
+	void SetBufferSize(unsigned int numEvents);
+	unsigned int GetBufferSize()const{return _bufferSize;}
+
+	//
+	//Name the calling thread in traces, threads are otherwise named by the
+	//order they first recorded in. Its buffer isn't allocated until it records
+	void SetThreadName(const std::string& name);
+
+	//
+	//Copy of name that lives as long as the profiler, for event names built
+	//at runtime. Each distinct name is stored once
+	const char* InternName(const std::string& name);
+
+	//
+	//Record on the calling thread, these don't check IsEnabled
+	void AddScope(const char* name, osg::Timer_t start, osg::Timer_t end);
+	void AddGPUScope(const char* name, osg::Timer_t start, osg::Timer_t end);
+	void AddCounter(const char* name, double value);
+
+	//
+	//Mark the start of a frame, called by HogBoxViewer::frame. Each frame is
+	//also recorded as a "Frame" scope on the calling thread
+	void BeginFrame();
+	unsigned int GetFrameNumber();
+
+	//
+	//Ignore everything recorded so far
+	void Clear();
+
+	//
+	//Copy every threads events, oldest first
+	void GetThreads(ProfileThreadVector& threads);
+
+	//
+	//Average the scopes that started within the last numFrames complete frames
+	ProfileStats GetStats(unsigned int numFrames = 60);
+
+	//
+	//Write GetStats as a table of text
+	void WriteSummary(std::ostream& out, unsigned int numFrames = 60);
+
+	//
+	//Write every recorded event as chrome trace event json. Cpu scopes are
+	//listed under process 1 and gpu scopes under process 2, each with the id
+	//of the thread that recorded them
+	void WriteChromeTrace(std::ostream& out);
+	bool WriteChromeTrace(const std::string& fileName);
+
+	//
+	//Time camera's draw with a pair of pre/post draw callbacks, recording the
+	//draw threads cpu time and, where ARB_timer_query is supported, the gpu
+	//time as well. Gpu results are read back a few frames later so the draw
+	//thread never waits on them. Any pre and post draw callbacks the camera already
+	//has are kept and called from the timer's, outside the timed part
+	void AttachGPUTimer(osg::Camera* camera, const std::string& name);
+
+protected:
+
+	virtual ~Profiler(void);
+
+	//the calling threads buffer, allocated on its first event
+	ProfileThreadBuffer* GetThreadBuffer();
+
+	void Add(ProfileEvent::Type type, const char* name, osg::Timer_t start, osg::Timer_t end, double value);
+
+protected:
+
+	static bool s_enabled;
+
+	OpenThreads::Mutex _mutex;
+
+	ProfileThreadRegistry* p_registry;
+	unsigned int _bufferSize;
+
+	std::set<std::string> _names;
+
+	//start of the recent frames, oldest first
+	std::vector<osg::Timer_t> _frameStarts;
+	unsigned int _frameNumber;
+
+	//events before this are ignored
+	osg::Timer_t _clearTick;
+	//time zero of the trace
+	osg::Timer_t _startTick;
+};
+
+typedef osg::ref_ptr<Profiler> ProfilerPtr;
+
+//
+//ProfileScope
+//Records the time between its construction and destruction on the calling
+//thread, if the profiler was enabled at construction. Use through the
+//HOGBOX_PROFILE_SCOPE macro
+//
+class ProfileScope
+{
+public:
+	inline ProfileScope(const char* name)
+		: _name(Profiler::IsEnabled() ? name : NULL),
+		_start(0)
+	{
+		if(_name){_start = osg::Timer::instance()->tick();}
+	}
+
+	inline ~ProfileScope()
+	{
+		if(_name){Profiler::Inst()->AddScope(_name, _start, osg::Timer::instance()->tick());}
+	}
+
+protected:
+	const char* _name;
+	osg::Timer_t _start;
+};
+
+}; //end hogbox namespace
+
+#define HOGBOX_PROFILE_JOIN_IMPL(a, b) a##b
+#define HOGBOX_PROFILE_JOIN(a, b) HOGBOX_PROFILE_JOIN_IMPL(a, b)
+
+#ifndef HOGBOX_NO_PROFILER
+
+//time the rest of the enclosing block, name must outlive the profiler
+#define HOGBOX_PROFILE_SCOPE(name) hogbox::ProfileScope HOGBOX_PROFILE_JOIN(hogboxProfileScope, __LINE__)(name)
+
+//record a counter value, the value isn't evaluated while disabled
+#define HOGBOX_PROFILE_COUNTER(name, value) \
+	do{ if(hogbox::Profiler::IsEnabled()){hogbox::Profiler::Inst()->AddCounter(name, value);} }while(0)
+
+//time a cameras cpu draw and gpu work
+#define HOGBOX_PROFILE_GPU_TIMER(camera, name) hogbox::Profiler::Inst()->AttachGPUTimer(camera, name)
+
+//mark the start of a frame
+#define HOGBOX_PROFILE_FRAME() \
+	do{ if(hogbox::Profiler::IsEnabled()){hogbox::Profiler::Inst()->BeginFrame();} }while(0)
+
+#else
+
+#define HOGBOX_PROFILE_SCOPE(name)
+#define HOGBOX_PROFILE_COUNTER(name, value) do{}while(0)
+#define HOGBOX_PROFILE_GPU_TIMER(camera, name) do{}while(0)
+#define HOGBOX_PROFILE_FRAME() do{}while(0)
+
+#endif
@@ -0,0 +1,124 @@
+/* Written by Thomas Hogarth, (C) 2011
+ *
+ * This library is open source and may be redistributed and/or modified under
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+ */
+
+#pragma once
+
+#include <hogbox/Export.h>
+
+#include <osg/Vec2>
+#include <osg/Vec3>
+#include <osg/Vec4>
+
+namespace hogbox {
+
+//
+//Random
+//Small fast pseudo random number generator (xoshiro128**). Each instance has
+//its own 128 bits of state so it can be used without locking by whichever
+//thread owns it, and the same seed and stream always give the same sequence
+//on every platform, unlike rand().
+//
+//Generators with the same seed but different streams give unrelated
+//sequences, e.g. one per tile of an image filled in parallel
+//
+class HOGBOX_EXPORT Random
+{
+public:
+	Random(unsigned int seed = 0, unsigned int stream = 0);
+
+	//
+	//Restart the sequence
+	void Seed(unsigned int seed, unsigned int stream = 0);
+
+	//
+	//Next 32 random bits
+	inline unsigned int NextUInt(){
+		unsigned int result = Rotate(_state[1]*5, 7)*9;
+		unsigned int t = _state[1] << 9;
+		_state[2] ^= _state[0];
+		_state[3] ^= _state[1];
+		_state[1] ^= _state[2];
+		_state[0] ^= _state[3];
+		_state[2] ^= t;
+		_state[3] = Rotate(_state[3], 11);
+		return result;
+	}
+
+	//
+	//Float in [0,1)
+	inline float NextFloat(){
+		return (float)(NextUInt() >> 8) * (1.0f/16777216.0f);
+	}
+
+	//
+	//Double in [0,1)
+	double NextDouble();
+
+	//
+	//Float between min and max, either way round
+	inline float NextFloat(float min, float max){
+		return min + NextFloat()*(max-min);
+	}
+
+	//
+	//Int between min and max inclusive, either way round, without the bias of
+	//taking rand() modulo the range
+	int NextInt(int min, int max);
+
+	//
+	//Normally distributed with mean 0 and standard deviation 1
+	double NextGaussian();
+
+	osg::Vec2 NextVec2(float min, float max);
+	osg::Vec3 NextVec3(float min, float max);
+	osg::Vec4 NextVec4(float min, float max);
+
+	//
+	//Unit length vector evenly distributed over the sphere
+	osg::Vec3 NextUnitVec3();
+
+	//
+	//Fill an array, quicker than calling the above per value as the state
+	//stays in registers
+	void Fill(unsigned int* values, unsigned int count);
+	void Fill(float* values, unsigned int count, float min = 0.0f, float max = 1.0f);
+
+protected:
+
+	static inline unsigned int Rotate(unsigned int x, int k){
+		return (x << k) | (x >> (32-k));
+	}
+
+protected:
+
+	unsigned int _state[4];
+
+	//NextGaussian makes values in pairs
+	bool _hasGaussian;
+	double _gaussian;
+};
+
+//
+//The calling threads own generator. Each thread gets its generator the first
+//time it asks, seeded from the seed last passed to SetThreadRandomSeed and the
+//order the threads first asked in
+//
+extern HOGBOX_EXPORT Random& GetThreadRandom();
+
+//
+//Reseed every threads generator. The calling thread restarts the sequence of
+//Random(seed), other threads restart on their next call to GetThreadRandom
+//
+extern HOGBOX_EXPORT void SetThreadRandomSeed(unsigned int seed);
+
+}; //end hogbox namespace
@@ -0,0 +1,186 @@
+/* Written by Thomas Hogarth, (C) 2011
+ *
+ * This library is open source and may be redistributed and/or modified under
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+ */
+
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include <osg/Referenced>
+#include <osg/ref_ptr>
+
+#include <OpenThreads/Thread>
+#include <OpenThreads/Mutex>
+#include <OpenThreads/Condition>
+#include <OpenThreads/Atomic>
+
+#include <hogbox/Export.h>
+
+namespace hogbox {
+
+//
+//TaskGroup
+//Counts the tasks of one batch still to complete, so a caller waits on its
+//own work and not on whatever else has been submitted to the pool
+//
+class TaskGroup : public osg::Referenced
+{
+public:
+	TaskGroup()
+		: osg::Referenced(),
+		_numPending(0)
+	{
+	}
+
+	//
+	//True once every task submitted with the group has completed
+	bool IsDone()const{return _numPending == 0;}
+
+protected:
+	virtual ~TaskGroup(void){}
+
+	friend class WorkStealingPool;
+	OpenThreads::Atomic _numPending;
+};
+typedef osg::ref_ptr<TaskGroup> TaskGroupPtr;
+
+//
+//PoolTask
+//Base type for a unit of work run by the WorkStealingPool
+//
+class PoolTask : public osg::Referenced
+{
+public:
+	PoolTask()
+		: osg::Referenced()
+	{
+	}
+
+	//
+	//Do the work, called once on whichever thread picks the task up
+	virtual void Run() = 0;
+
+protected:
+	virtual ~PoolTask(void){}
+
+	friend class WorkStealingPool;
+	//group the task was submitted with
+	TaskGroupPtr _group;
+};
+typedef osg::ref_ptr<PoolTask> PoolTaskPtr;
+
+//
+//WorkStealingPool
+//Fixed set of worker threads each owning a task queue. Workers pop work from the
+//back of their own queue and steal from the front of other queues when they run dry.
+//The thread calling Wait helps run queued tasks and only sleeps once the rest of
+//its group is running on the workers, so a pool with no
+//workers still completes all work (serially), and a task may itself submit a
+//group and wait on it
+//
+class HOGBOX_EXPORT WorkStealingPool : public osg::Referenced
+{
+public:
+
+	//
+	//Shared pool sized to the number of processors
+	static WorkStealingPool* Inst(bool erase = false);
+
+	//
+	//numThreads of 0 uses the number of processors minus one (the caller of Wait makes up the difference)
+	WorkStealingPool(unsigned int numThreads = 0);
+
+	//
+	//Queue a task as part of group, tasks are distributed round robin across
+	//the worker queues
+	void Submit(PoolTask* task, TaskGroup* group);
+
+	//
+	//Block until every task submitted with group has completed, the calling
+	//thread executes queued tasks while it waits
+	void Wait(TaskGroup* group);
+
+	//
+	//Number of worker threads (excluding the thread calling Wait)
+	unsigned int GetNumThreads()const{return _workers.size();}
+
+	//
+	//Total number of tasks that have been stolen from another queue, for profiling
+	unsigned int GetNumSteals()const{return _numSteals;}
+
+protected:
+
+	virtual ~WorkStealingPool(void);
+
+	//
+	//Try to take a task, first from the queue at index then by stealing from the others,
+	//returns false if every queue is empty
+	bool TakeTask(unsigned int index, PoolTaskPtr& task);
+
+	//
+	//Run a task and mark it complete
+	void RunTask(PoolTask* task);
+
+	//
+	//Run or wait on tasks until pending reaches zero
+	void WaitForCount(OpenThreads::Atomic& pending);
+
+	//
+	//Sleep a worker until new work is submitted or the pool shuts down
+	void WaitForWork();
+
+	class WorkQueue
+	{
+	public:
+		OpenThreads::Mutex _mutex;
+		std::deque<PoolTaskPtr> _tasks;
+	};
+
+	class Worker : public OpenThreads::Thread
+	{
+	public:
+		Worker(WorkStealingPool* pool, unsigned int index)
+			: OpenThreads::Thread(),
+			p_pool(pool),
+			_index(index)
+		{
+		}
+		virtual void run();
+	protected:
+		WorkStealingPool* p_pool;
+		unsigned int _index;
+	};
+	friend class Worker;
+
+protected:
+
+	//one queue per worker plus a final queue owned by threads calling Wait
+	std::vector<WorkQueue*> _queues;
+	std::vector<Worker*> _workers;
+
+	//round robin index for Submit
+	OpenThreads::Atomic _nextQueue;
+	//tasks sitting in queues
+	OpenThreads::Atomic _numQueued;
+	//tasks submitted but not yet completed
+	OpenThreads::Atomic _numPending;
+	OpenThreads::Atomic _numSteals;
+
+	//used to park idle workers
+	OpenThreads::Mutex _wakeMutex;
+	OpenThreads::Condition _wakeCondition;
+	volatile bool _done;
+};
+typedef osg::ref_ptr<WorkStealingPool> WorkStealingPoolPtr;
+
+}; //end hogbox namespace
@@ -19,6 +19,8 @@
 
 #include <hogboxDB/XmlUtils.h>
 #include <hogboxDB/HogBoxRegistry.h>
+#include <hogboxDB/XmlDatabaseIndex.h>
+#include <hogboxDB/XmlStreamWriter.h>
 
 #include <osgDB/XmlParser>
 #include <osgDB/FileUtils>
@@ -44,9 +46,23 @@ public:
 	//node should be of type HogBoxDataBase. If no other database
 	//has been loaded this files rootnode is used as the database.
 	//If a database already exists then this files rootnode children
-	//are added to the databases list of children
+	//are added to the databases list of children.
+	//Files on disk are only indexed by an XmlDatabaseIndex, each node
+	//being parsed when it's first read. Files in a mounted archive, or
+	//that fail to index, are read into an XmlNode tree
 	bool ReadDataBaseFile(const std::string& fileName);
 
+	//
+	//Read a changed version of a database file and update the loaded objects
+	//to match it. Objects whose node changed (compared by a hash of its
+	//content) are reloaded into their existing instance, see
+	//XmlClassWrapper::reload. If a reload gives an object a new instance, or
+	//its class type changed, the loaded objects referencing it by useID or
+	//defining it inline are reloaded to pick it up. Unchanged objects are left as they are, and objects
+	//no longer in the file stay loaded. Returns false if the file fails to read,
+	//keeping the current database, or if any object fails to reload
+	bool ReloadDataBaseFile(const std::string& fileName);
+
 
 	//
 	//Reads an xml node into a hogbox::ObjectPtr object using
@@ -70,11 +86,12 @@ public:
 	template <typename T>
 	osg::ref_ptr<T> ReadNodeByIDTyped(const std::string& uniqueID)
 	{
-		//see if we can find a node with the uniqueID requested
-		osgDB::XmlNode* uniqueIDNode = FindNodeByUniqueIDProperty(uniqueID);
-		//if we find the node pass it to readnode and return the result
-		if(uniqueIDNode)
-		{return ReadNodeTyped<T>(uniqueIDNode);}
+		osg::ObjectPtr readResult = this->ReadNodeByID(uniqueID);
+		if(readResult)
+		{
+			osg::ref_ptr<T> castToTemplate = dynamic_cast<T*>(readResult.get());
+			return castToTemplate;
+		}
 		return NULL;
 	}
 
@@ -104,11 +121,28 @@ public:
     //Write an object to xmlnode, this function is recursive
     //as the object may store a class
     osgDB::XmlNodePtr WriteXmlNode(osg::ObjectPtr object);
+
+    //
+    //Write an object straight to out, giving the same xml as writing the node
+    //from WriteXmlNode without building it. Objects it points to are written
+    //inline in the same way
+    bool WriteXmlStream(osg::ObjectPtr object, XmlStreamWriter& out);
+
+    //
+    //Write objects to a new HogBoxDatabase xml file through an XmlStreamWriter,
+    //returns false if the file can't be written or any object fails to write
+    bool WriteDataBaseFile(const std::string& fileName, const std::vector<osg::ObjectPtr>& objects);
     
 	//
 	//Release a node from the database by name
 	bool ReleaseNodeByID(const std::string& uniqueID);
 
+	//
+	//Nodes are found by uniqueID through an index of the database built on the
+	//first lookup. Call this after adding or removing database nodes directly.
+	//Databases read through an XmlDatabaseIndex have no nodes to add to
+	void RebuildUniqueIDIndex();
+
 
 protected:
 	
@@ -116,17 +150,46 @@ protected:
 	virtual ~HogBoxManager(void);
 
 	virtual void destruct(){
+		_uniqueIDIndex.clear();
 		_databaseNode = NULL;
+		_databaseIndex = NULL;
 	}
 
+	//
+	//Make sure a database is available, loading Data/hogboxDB.xml if none
+	//has been read
+	bool HasDataBase();
+
 
 	//xml helpers
-	//find a node in the database with the uniqueID property
-	osgDB::XmlNode* FindNodeByUniqueIDProperty(const std::string& uniqueID, osgDB::XmlNode* xmlNode=NULL);
+	//find a node in the database with the uniqueID property, with no
+	//xmlNode the whole database is searched through the index. If the
+	//database is streamed the node is parsed from the file
+	osgDB::XmlNodePtr FindNodeByUniqueIDProperty(const std::string& uniqueID, osgDB::XmlNode* xmlNode=NULL);
+
+	//
+	//Return the class type (node name) of the database node with uniqueID,
+	//without parsing it if streamed. Empty if there's no such node
+	std::string FindClassTypeByUniqueID(const std::string& uniqueID);
+
+	//
+	//Add xmlNodes descendants to the uniqueID index, the first node found
+	//depth first keeps an id
+	void IndexUniqueIDs(osgDB::XmlNode* xmlNode);
 
 protected:
 
 	osg::ref_ptr<osgDB::XmlNode> _databaseNode;
+
+	//offsets of the nodes in a streamed database file, used instead of
+	//_databaseNode. Parsed nodes are held by the XmlClassManager that
+	//loaded them, so are freed as their objects are released
+	XmlDatabaseIndexPtr _databaseIndex;
+
+	//database nodes by uniqueID property
+	typedef std::map<std::string, osgDB::XmlNode*> UniqueIDNodeMap;
+	UniqueIDNodeMap _uniqueIDIndex;
+	bool _uniqueIDIndexBuilt;
 	
 
 };
@@ -31,7 +31,10 @@ namespace hogboxDB {
 //
 //HogBoxRegistry
 //Currently tracks all XmlNodeManger types registered for
-//reading from the hogbox xml database
+//reading from the hogbox xml database. Each class type a registered manager
+//supports is indexed so finding the manager for a node is a single lookup. As
+//when the managers were searched in turn, the first registered manager that
+//accepts a type (by name or with "*") handles it
 //
 class HOGBOXDB_EXPORT HogBoxRegistry : public osg::Referenced //, public hogbox::Singleton<HogBoxRegistry>
 {
@@ -62,6 +65,7 @@ public:
 
 	typedef std::vector< osg::ref_ptr<osgDB::DynamicLibrary> >		DynamicLibraryList;
 	typedef std::map< std::string, std::string>						ClassTypeAliasMap;
+	typedef std::map< std::string, XmlClassManager*>				ClassTypeManagerMap;
 
 	
 	//register a new xml node type manager
@@ -72,6 +76,18 @@ public:
 
 	XmlClassManager* GetXmlClassManagerForClassType(const std::string& classType);
 
+	//
+	//The registered managers in the order they were added
+	unsigned int GetNumXmlClassManagers()const{return _xmlNodeManagers.size();}
+	XmlClassManager* GetXmlClassManager(unsigned int index){return _xmlNodeManagers[index]->GetPrototype();}
+
+	//
+	//Called by XmlClassManager::SupportsClassType so types added to a manager
+	//after it's registered (i.e. by REGISTER_HOGBOXWRAPPER) are indexed. The
+	//first registered manager to support a type keeps it, whatever order the
+	//types are added in
+	void AddClassTypeManager(const std::string& classType, XmlClassManager* manager);
+
 
 	void AddClassTypeAlias(const std::string mapClassType, const std::string toLibraryName);
 
@@ -103,6 +119,14 @@ protected:
 	//to the database
 	std::vector<XmlClassManagerWrapperPtr> _xmlNodeManagers;
 
+	//the registered managers by class name, and by each class type they
+	//support. Managers accepting any type ("*") are kept in registration order
+	//and compared with the indexed manager by _managerOrder
+	std::map<std::string, XmlClassManager*> _xmlNodeManagersByName;
+	ClassTypeManagerMap _classTypeManagers;
+	std::vector<XmlClassManager*> _wildcardManagers;
+	std::map<XmlClassManager*, unsigned int> _managerOrder;
+
 	//list of loaded libraries
 	DynamicLibraryList _dlList;
 
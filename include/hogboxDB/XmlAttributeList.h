@@ -14,6 +14,7 @@
 #pragma once
 
 #include <hogboxDB/XmlAttribute.h>
+#include <hogboxDB/XmlStreamWriter.h>
 
 //
 //XmlAtrribute types for wrapping lists of basic types
@@ -33,6 +34,108 @@
 //
 namespace hogboxDB {
 
+	//
+	//Read list node in into list, in should contain a 'count' property describing
+	//how many space seperated values are contained in its contents.
+	//The contents is deserialised with stringStreamToType which will handle
+	//T types with multiple values. i.e. if you have a list of 2 vec3 values
+	//<VecList count='2'>
+	//	1.0 1.1 1.3
+	//	2.0 2.1 2.3
+	//</VecList>
+	//You have 9 space sperated values but as stringStreamToType has a vec3
+	//overload it will handle reading in three values at a time so we
+	//only need two reads
+	template <typename L, typename T>
+	bool readXmlValueList(osgDB::XmlNode* in, L& list)
+	{
+		//
+		if(!in){return false;}
+
+		//see if we can get the count property (otherwise it's not a valid list
+		unsigned int count = 0;
+		if(!hogboxDB::getXmlPropertyValue(in, "count", count))
+		{
+			osg::notify(osg::WARN) << "XML ERROR: Parsing list attribute '" << in->name << "'," << std::endl
+								   << "                      List nodes must contain a 'count' property. For example <" << in->name << " count='2'>" << std::endl;
+
+			return false;
+		}
+
+		//if count is 0 dont bother
+		if(count == 0)
+		{
+			osg::notify(osg::WARN) << "XML WARN: Parsing list node '" << in->name << "'," << std::endl
+								  << "                      The list attribute has a count of '0', are you sure this is not a mistake?" << std::endl;
+
+			return false;
+		}
+
+		//allocate the list
+		T empty;
+		list.assign(count, empty);
+
+		//now get the contents, deserialise individual values
+		//into our list
+		std::stringstream listStrStream(in->contents);
+		for(unsigned int i=0; i<count; i++)
+		{
+			//pass the listStrStream to have its next word converted
+			//to the item type.
+			T item;
+			if(hogboxDB::stringStreamToType(listStrStream, item))
+			{
+				list.at(i) = item;
+			}else{
+				//error occured, rest of list is invalid
+				osg::notify(osg::WARN) << "XML ERROR: Parsing list node '" << in->name << "'," << std::endl
+									   << "                      Failed while reading item '" << i << "' from list with size '" << count << "' the rest of the items will be skipped." << std::endl;
+
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//
+	//Write list to a node called name, with a 'count' property and the
+	//values as space seperated contents
+	template <typename L>
+	osgDB::XmlNodePtr writeXmlValueList(const std::string& name, const L& list)
+	{
+		//create the head node which will provide the count as a property
+		osgDB::XmlNodePtr listNode = new osgDB::XmlNode();
+		listNode->name = name;
+		listNode->type = osgDB::XmlNode::NODE;
+		
+		//set the count property
+		hogboxDB::setXmlPropertyValue(listNode.get(), "count", (unsigned int)list.size());
+		
+		//now loop each item of the list and write it to a stringstream
+		std::stringstream listss;
+		for(unsigned int i=0; i<list.size(); i++){
+			hogboxDB::typeToStringStream(list.at(i), listss);
+			if(i != list.size()-1){listss << " ";}
+		}
+		listNode->contents = listss.str();
+		return listNode;
+	}
+
+	//
+	//Write list straight to out, as the node above
+	template <typename L>
+	bool writeXmlValueList(const std::string& name, const L& list, XmlStreamWriter& out)
+	{
+		out.beginNode(name);
+		out.addProperty("count", (unsigned int)list.size());
+		for(unsigned int i=0; i<list.size(); i++){
+			if(i > 0){out.addContents(" ");}
+			out.addContents(list.at(i));
+		}
+		out.endNode();
+		return true;
+	}
+
 	//base interface for list types
 	class XmlAttributeList : public XmlAttribute {		
 	public:
@@ -93,87 +196,15 @@ namespace hogboxDB {
             
             //
             if(!_list){return NULL;}
-            
-			//create the head node which will provide the count as a property
-            osgDB::XmlNodePtr listNode = new osgDB::XmlNode();
-            listNode->name = this->getName();
-            listNode->type = osgDB::XmlNode::NODE;
-            
-            //set the count property
-            hogboxDB::setXmlPropertyValue(listNode.get(), "count", (unsigned int)_list->size());
-            
-            //now loop each item of the list and write it to a stringstream
-            std::stringstream listss;
-            for(unsigned int i=0; i<_list->size(); i++){
-                hogboxDB::typeToStringStream(this->get(i), listss);
-                if(i != _list->size()-1){listss << " ";}
-            }
-            listNode->contents = listss.str();
-            return listNode;
+            return writeXmlValueList(this->getName(), *_list);
 		}
 
 		//
-		//deserialize
-		//in node should contain a 'count' property describing
-		//how many space seperated values are contained in the in nodes
-		//contents.
-		//The contents is deserialised with stringStreamToType which will handle
-		//T types with multiple values. i.e. if you have a list of 2 vec3 values
-		//<VecList count='2'>
-		//	1.0 1.1 1.3
-		//	2.0 2.1 2.3
-		//</VecList>
-		//You have 9 space sperated values but as stringStreamToType has a vec3
-		//overload it will handle reading in three values at a time so we
-		//only need two reads
+		//deserialize, see readXmlValueList
 		virtual bool deserialize(osgDB::XmlNode* in) 
 		{
-			//
-			if(!in){return false;}
-
-			//see if we can get the count property (otherwise it's not a valid list
-			unsigned int count = 0;
-			if(!hogboxDB::getXmlPropertyValue(in, "count", count))
-			{
-				osg::notify(osg::WARN) << "XML ERROR: Parsing node '" << in->name << "'," << std::endl
-									   << "                      List nodes must contain a 'count' property. For example <" << in->name << " count='2>" << std::endl;
-				return false;
-			}
-
-			//if count is 0 dont bother
-			if(count <= 0)
-			{
-				osg::notify(osg::WARN) << "XML WARN: Parsing pointer list node '" << in->name << "'," << std::endl
-									  << "                      The list attribute hs a count of '0', are you sure this is not a mistake?" << std::endl;
-
-				return false;
-			}
-
-			//allocate the list
-			T empty;
-			_list->assign(count, empty);
-
-			//now get the contents, deserialise individual values
-			//and push_back onto our list
-			std::stringstream listStrStream(in->contents);
-			for(unsigned int i=0; i<count; i++)
-			{
-				T item;
-				//pass the listStrStream to have its next word converted
-				//to the item type.
-				if(hogboxDB::stringStreamToType(listStrStream, item))
-				{
-					//the word conveted to the type correctly so
-					//set the value of i in our list to item
-					this->set(i, item);
-				}else{
-					//error occured, rest of list is invalid
-					osg::notify(osg::WARN) << "XML ERROR: Parsing list node '" << in->name << "'," << std::endl
-										   << "                      Failed while reading item '" << i << "' from list with size '" << count << "' the rest of the items will be skipped." << std::endl;
-					return false;
-				}
-			}
-			return true;
+			if(!_list){return false;}
+			return readXmlValueList<L,T>(in, *_list);
 		}
 		
 		//void (TypedXmlAttribute<T>::*f_sethandler)(T&, const T&);				
@@ -234,27 +265,7 @@ namespace hogboxDB {
 		virtual osgDB::XmlNodePtr serialize() {
 
             if(!mp_object){return NULL;}
-            
-			//create the head node which will provide the count as a property
-            osgDB::XmlNodePtr listNode = new osgDB::XmlNode();
-            listNode->name = this->getName();
-            listNode->type = osgDB::XmlNode::NODE;
-
-            //get local ref to the objects list 
-            L list = this->get();
-            
-            //set the count property
-            hogboxDB::setXmlPropertyValue(listNode.get(), "count", (unsigned int)list.size());
-            OSG_FATAL << "Serialize XmlList" << std::endl;
-            //now loop each item of the list and write it to a stringstream
-            std::stringstream listss;
-            for(unsigned int i=0; i<list.size(); i++){
-                hogboxDB::typeToStringStream(list.at(i), listss);
-                if(i != list.size()-1){listss << " ";}
-                OSG_FATAL << "    Serialize list value '" << listss.str() << "'." <<  std::endl;
-            }
-            listNode->contents = listss.str();
-            return listNode;
+            return writeXmlValueList(this->getName(), this->get());
 		}
 
 		//
@@ -263,50 +274,9 @@ namespace hogboxDB {
 		//set method
 		virtual bool deserialize(osgDB::XmlNode* in) 
 		{
-			//
-			if(!in){return false;}
-
-			//see if we can get the count property (otherwise it's not a valid list
-			unsigned int count = 0;
-			if(!hogboxDB::getXmlPropertyValue(in, "count", count))
-			{
-				osg::notify(osg::WARN) << "XML ERROR: Parsing list attribute '" << in->name << "'," << std::endl
-									   << "                      List nodes must contain a 'count' property. For example <" << in->name << " count='2'>" << std::endl;
-
-				return false;
-			}
-
-			//if count is 0 dont bother
-			if(count == 0)
-			{
-				osg::notify(osg::WARN) << "XML WARN: Parsing pointer list node '" << in->name << "'," << std::endl
-									  << "                      The list attribute has a count of '0', are you sure this is not a mistake?" << std::endl;
-
-				return false;
-			}
-
-			//allocate the list space
 			//create a new list to fill with the node data
 			L list;
-			T empty;
-			list.assign(count, empty);
-
-			//now get the contents, deserialise individual values
-			//and push_back onto our list
-			std::stringstream listStrStream(in->contents);
-			for(unsigned int i=0; i<count; i++)
-			{
-				T item;
-				if(hogboxDB::stringStreamToType(listStrStream, item))
-				{
-					list.at(i) = item;
-				}else{
-					osg::notify(osg::WARN) << "XML ERROR: Parsing list node '" << in->name << "'," << std::endl
-										   << "                      Failed while reading item '" << i << "' from list with size '" << count << "' the rest of the items will be skipped." << std::endl;
-
-					return false;
-				}
-			}
+			if(!readXmlValueList<L,T>(in, list)){return false;}
 
 			//set the new list via the set callback
 			this->set(list);
@@ -32,6 +32,85 @@
 //
 namespace hogboxDB {
 
+	//
+	//Read pointer map node in, a 'count' property and count mapvalue nodes each with
+	//a 'key' property and a child class node of type T. The key value pairs read are
+	//added to values, on an error the pairs read before it are left in values
+	template <typename K, typename T>
+	bool readXmlClassPointerMap(osgDB::XmlNode* in, std::vector< std::pair<K, T*> >& values)
+	{	
+		//
+		if(!in){return false;}
+
+		//see if we can get the count property (otherwise it's not a valid list
+		unsigned int count = 0;
+		if(!hogboxDB::getXmlPropertyValue(in, "count", count))
+		{
+			OSG_WARN << "XML ERROR: Parsing pointer map node '" << in->name << "'," << std::endl
+								   << "                      Map nodes must contain a 'count' property. For example <" << in->name << " count='2>" << std::endl;
+			return false;
+		}
+
+		//if count is 0 dont bother
+		if(count == 0)
+		{
+			OSG_WARN << "XML WARN: Parsing pointer map node '" << in->name << "'," << std::endl
+								  << "                      The map attribute has a count of '0', are you sure this is not a mistake?" << std::endl;
+
+			return false;
+		}
+
+
+		//see if the count matches the number of children
+		if(in->children.size() != count)
+		{
+			//warn user
+			OSG_WARN << "XML ERROR: Parsing pointer map node '" << in->name << "'," << std::endl
+								   << "                      Nodes 'count' property (" << count << ") does not match the number of child nodes (" << in->children.size() << ")." << std::endl
+								   << "                      The list will not be passed." << std::endl;
+			return false;
+		}
+
+
+		//now loop over the children and read the map values
+		for(unsigned int i=0; i<count; i++)
+		{
+			//the mapvalue node
+			osgDB::XmlNode* mapNode = in->children[i];
+
+			//mapvalue nodes should contain a key property
+			K mapKey = 0;
+			if(!hogboxDB::getXmlPropertyValue(mapNode, "key", mapKey))
+			{
+				OSG_WARN << "XML ERROR: Parsing map value node '" << mapNode->name << "'," << std::endl
+									   << "                      Map value nodes must contain a 'key' property. For example <" << mapNode->name << " key='1>" << std::endl;
+				return false;
+			}
+
+			//we have our key into the map, now read the value node of the mapvalue
+			if(mapNode->children.size() == 0)
+			{
+				OSG_WARN << "XML ERROR: Parsing map value node '" << mapNode->name << "'," << std::endl
+									   << "                      Map value nodes must contain a child node representing the value" << std::endl;
+				return false;
+			}
+
+			//read the mapvalue pointer node from the database
+			osg::ObjectPtr ptr = hogboxDB::HogBoxManager::Inst()->ReadNode(mapNode->children[0]);
+			
+			//cast it to type and add to the values
+			T* typePtr = dynamic_cast<T*>(ptr.get()); 
+			if(typePtr){
+				values.push_back(std::pair<K, T*>(mapKey, typePtr));
+			}else{
+				//XML CASTING ERROR
+				return false;
+			}
+		}
+
+		return true;
+	}
+
 	//
 	//Used to wrap a map of basic types to class pointers
 	//a map list must start with a head node with a 'count' property followed by count
@@ -97,79 +176,14 @@ namespace hogboxDB {
 		//nodes, which are identifiyed by the 'key' property
 		virtual bool deserialize(osgDB::XmlNode* in) 
 		{	
-			//
-			if(!in){return false;}
+			std::vector< std::pair<K, T*> > values;
+			bool result = readXmlClassPointerMap(in, values);
 
-			//see if we can get the count property (otherwise it's not a valid list
-			unsigned int count = 0;
-			if(!hogboxDB::getXmlPropertyValue(in, "count", count))
-			{
-				OSG_WARN << "XML ERROR: Parsing pointer map node '" << in->name << "'," << std::endl
-									   << "                      Map nodes must contain a 'count' property. For example <" << in->name << " count='2>" << std::endl;
-				return false;
+			//call the set function using each mapKey as the key into the map
+			for(unsigned int i=0; i<values.size(); i++){
+				set(values[i].first, values[i].second);
 			}
-
-			//if count is 0 dont bother
-			if(count == 0)
-			{
-				OSG_WARN << "XML WARN: Parsing pointer map node '" << in->name << "'," << std::endl
-									  << "                      The map attribute has a count of '0', are you sure this is not a mistake?" << std::endl;
-
-				return false;
-			}
-
-
-			//see if the count matches the number of children
-			if(in->children.size() != count)
-			{
-				//warn user
-				OSG_WARN << "XML ERROR: Parsing pointer map node '" << in->name << "'," << std::endl
-									   << "                      Nodes 'count' property (" << count << ") does not match the number of child nodes (" << in->children.size() << ")." << std::endl
-									   << "                      The list will not be passed." << std::endl;
-				return false;
-			}
-
-
-			//now loop over the children and read the map values
-			for(unsigned int i=0; i<count; i++)
-			{
-				//the mapvalue node
-				osgDB::XmlNode* mapNode = in->children[i];
-
-				//mapvalue nodes should contain a key property
-				K mapKey = 0;
-				if(!hogboxDB::getXmlPropertyValue(mapNode, "key", mapKey))
-				{
-					OSG_WARN << "XML ERROR: Parsing map value node '" << mapNode->name << "'," << std::endl
-										   << "                      Map value nodes must contain a 'key' property. For example <" << mapNode->name << " key='1>" << std::endl;
-					return false;
-				}
-
-				//we have our key into the map, now read the value node of the mapvalue
-				if(mapNode->children.size() == 0)
-				{
-					OSG_WARN << "XML ERROR: Parsing map value node '" << mapNode->name << "'," << std::endl
-										   << "                      Map value nodes must contain a child node representing the value" << std::endl;
-					return false;
-				}
-
-				//read the mapvalue pointer node from the database
-				osg::ObjectPtr ptr = hogboxDB::HogBoxManager::Inst()->ReadNode(mapNode->children[0]);
-				
-				//cast it to type and pass to set
-				T* typePtr = dynamic_cast<T*>(ptr.get()); 
-				if(typePtr){
-					
-					//call the set function using the mapKey as the key into the map
-					set(mapKey, typePtr);
-
-				}else{
-					//XML CASTING ERROR
-					return false;
-				}
-			}
-
-			return true;
+			return result;
 		}
 		
 	protected:
@@ -39,6 +39,224 @@
 //
 namespace hogboxDB {
 
+	//
+	//The reading, writing and releasing of pointer attributes, shared by the
+	//XmlAttributes below and the XmlAttributeTable bindings
+	//
+
+	//
+	//Read the child class node of pointer attribute node in through the HogBoxManager
+	//and cast it to T, the child can be a full definition or a useID reference
+	template <typename T>
+	bool readXmlClassPointer(osgDB::XmlNode* in, T*& result)
+	{
+		result = NULL;
+		if(!in){return false;}
+
+		//check we have some children
+		if(in->children.size()==0)
+		{
+			OSG_WARN << "XML WARN: Parsing pointer attribute '" << in->name << "'," << std::endl
+								   << "                       Pointer attributes should contian a child node of the desired classtype. CLASSTYPE" << std::endl
+								   << "                       The child node can be a full definition of the classtype required or a useID reference. For example," << std::endl
+								   << "                       <" << in->name << ">" << std::endl
+								   << "						      <CLASSTYPE uniqueID='object1'>" << std::endl
+								   << "						          ..." << std::endl
+								   << "						      </CLASSTYPE>" << std::endl
+								   << "                       </" << in->name << ">" << std::endl
+								   << "                       Or" << std::endl
+								   << "                       <" << in->name << ">" << std::endl
+								   << "						      <CLASSTYPE useID='object1'>" << std::endl
+								   << "                       </" << in->name << ">" << std::endl;
+
+			return false;
+		}
+
+		//get the first (and should be the only) child
+		osgDB::XmlNode* pointerNode = in->children[0];
+
+		//try and read the pointer node from the database
+		osg::ObjectPtr ptr = hogboxDB::HogBoxManager::Inst()->ReadNode(pointerNode);
+		
+		//check result
+		if(!ptr)
+		{
+			//pointer was not found or failed to be read
+			OSG_WARN << "XML ERROR: Parsing pointer attribute '" << in->name << "'," << std::endl
+								   << "                        ReadNode did not return a valid object for child node '" << pointerNode->name << "'." << std::endl
+								   << "                        The attribute pointer will not be set." << std::endl;
+			return false;
+		}
+
+		//cast the result to type T
+		result = dynamic_cast<T*>(ptr.get()); 
+		if(!result)
+		{
+			//error casting to type
+			OSG_WARN << "XML ERROR: Parsing pointer attribute '" << in->name << "'," << std::endl
+								   << "                        Failed to cast the object returned from ReadNode to the corrent type." << std::endl
+								   << "                        Please ensure '" << in->name << "' is expecting a classnode of type '" << pointerNode->name << "'." << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	//
+	//Write pointer attribute name, a node wrapping the class node of object
+	template <typename T>
+	osgDB::XmlNodePtr writeXmlClassPointer(const std::string& name, T* object)
+	{
+		//create the head node which just wraps the xmlclass node
+		osgDB::XmlNodePtr attNode = new osgDB::XmlNode();
+		attNode->name = name;
+		attNode->type = osgDB::XmlNode::GROUP;
+		
+		osgDB::XmlNodePtr classNode = hogboxDB::HogBoxManager::Inst()->WriteXmlNode(object);
+		if(classNode.get()){
+			attNode->children.push_back(classNode.get());
+			return attNode;
+		}
+		return NULL;
+	}
+
+	//
+	//Write pointer attribute straight to out, as the node above. Nothing is
+	//written for a NULL object
+	template <typename T>
+	bool writeXmlClassPointer(const std::string& name, T* object, XmlStreamWriter& out)
+	{
+		if(!object){return false;}
+		out.beginNode(name, true);
+		bool result = hogboxDB::HogBoxManager::Inst()->WriteXmlStream(object, out);
+		out.endNode();
+		return result;
+	}
+
+	//
+	//Release the object pointed to from the database
+	template <typename T>
+	bool releaseXmlClassPointer(T* object)
+	{
+		if(object){
+			return hogboxDB::HogBoxManager::Inst()->ReleaseNodeByID(object->getName());
+		}
+		return false;
+	}
+
+	//
+	//Read pointer list node in, a 'count' property and count class nodes of type T
+	template <typename L, typename T>
+	bool readXmlClassPointerList(osgDB::XmlNode* in, L& list)
+	{
+		//
+		if(!in){return false;}
+
+		//see if we can get the count property (otherwise it's not a valid list
+		unsigned int count = 0;
+		if(!hogboxDB::getXmlPropertyValue(in, "count", count))
+		{
+			OSG_WARN << "XML ERROR: Parsing pointer list node '" << in->name << "'," << std::endl
+								   << "                      List nodes must contain a 'count' property. For example <" << in->name << " count='2'>" << std::endl;
+			return false;
+		}
+
+		//if count is 0 dont bother
+		if(count == 0)
+		{
+			OSG_WARN << "XML WARN: Parsing pointer list node '" << in->name << "'," << std::endl
+								  << "                      The list attribute has a count of '0', are you sure this is not a mistake?" << std::endl;
+
+			return false;
+		}
+
+
+		//see if the count matches the number of children
+		if(in->children.size() != count)
+		{
+			//warn user
+			OSG_WARN << "XML ERROR: Parsing pointer list attribute '" << in->name << "'," << std::endl
+								   << "                      Nodes 'count' property (" << count << ") does not match the number of child nodes (" << in->children.size() << ")." << std::endl
+								   << "                      The list will not be parsed." << std::endl;
+			return false;
+		}
+
+		//allocate the list space
+		list.assign(count, NULL);
+
+		for(unsigned int i=0; i<count; i++)
+		{
+
+			osgDB::XmlNode* pointerNode = in->children[i];
+
+			//read the pointer node from the database
+			osg::ObjectPtr ptr = hogboxDB::HogBoxManager::Inst()->ReadNode(pointerNode);
+			//cast it to type and pass to set
+			T* typePtr = dynamic_cast<T*>(ptr.get()); 
+			if(typePtr){
+				list.at(i) = typePtr;
+			}else{
+				//XML CASTING ERROR
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//
+	//Write pointer list name, a 'count' property and the class node of each item
+	template <typename L>
+	osgDB::XmlNodePtr writeXmlClassPointerList(const std::string& name, const L& list)
+	{
+		//create the head node which will provide the count as a property
+		osgDB::XmlNodePtr listNode = new osgDB::XmlNode();
+		listNode->name = name;
+		listNode->type = osgDB::XmlNode::GROUP;
+		
+		//set the count property
+		hogboxDB::setXmlPropertyValue(listNode.get(), "count", (unsigned int)list.size());
+		
+		//now loop each item of serialize to an xmlnode and add as child
+		for(unsigned int i=0; i<list.size(); i++){
+			osgDB::XmlNodePtr classNode = hogboxDB::HogBoxManager::Inst()->WriteXmlNode(list.at(i).get());
+			if(classNode.get()){
+				listNode->children.push_back(classNode.get());
+			}
+		}
+		return listNode;
+	}
+
+	//
+	//Write pointer list straight to out, as the node above
+	template <typename L>
+	bool writeXmlClassPointerList(const std::string& name, const L& list, XmlStreamWriter& out)
+	{
+		out.beginNode(name, true);
+		out.addProperty("count", (unsigned int)list.size());
+		bool result = true;
+		for(unsigned int i=0; i<list.size(); i++){
+			if(!hogboxDB::HogBoxManager::Inst()->WriteXmlStream(list.at(i).get(), out)){
+				result = false;
+			}
+		}
+		out.endNode();
+		return result;
+	}
+
+	//
+	//Release each object in list from the database
+	template <typename L>
+	bool releaseXmlClassPointerList(const L& list)
+	{
+		bool result = true;
+		typename L::const_iterator itr = list.begin();
+		for( ; itr != list.end(); itr++){
+			if((*itr) && !hogboxDB::HogBoxManager::Inst()->ReleaseNodeByID((*itr)->getName())){
+				result=false;
+			}
+		}
+		return result;
+	}
+
 	//
 	//used for attributes that are pointers to other classes
 	//C type of class containing the pointer
@@ -88,28 +306,12 @@ namespace hogboxDB {
 		//
 		//release the pointers object from the database
 		virtual bool releaseAttribute(){
-			//get the name of the object pointed to
-			T* pointerObject = this->get();
-			if(pointerObject){
-				std::string pointerObjectName = pointerObject->getName();
-				return hogboxDB::HogBoxManager::Inst()->ReleaseNodeByID(pointerObjectName);
-			}
-			return false;
+			return releaseXmlClassPointer(this->get());
 		}
 
 		//write to nodes contents
 		virtual osgDB::XmlNodePtr serialize() {
-			//create the head node which just wraps the xmlclass node
-            osgDB::XmlNodePtr attNode = new osgDB::XmlNode();
-            attNode->name = this->getName();
-            attNode->type = osgDB::XmlNode::GROUP;
-            
-            osgDB::XmlNodePtr classNode = hogboxDB::HogBoxManager::Inst()->WriteXmlNode(this->get());
-            if(classNode.get()){
-                attNode->children.push_back(classNode.get());
-                return attNode;
-            }
-            return NULL;
+			return writeXmlClassPointer(this->getName(), this->get());
 		}
 
 		//
@@ -118,54 +320,8 @@ namespace hogboxDB {
 		//its pointer which is then passed to set
 		virtual bool deserialize(osgDB::XmlNode* in) 
 		{
-			//
-			if(!in){return false;}
-
-			//check we have some children
-			if(in->children.size()==0)
-			{
-				OSG_WARN << "XML WARN: Parsing pointer attribute '" << in->name << "'," << std::endl
-									   << "                       Pointer attributes should contian a child node of the desired classtype. CLASSTYPE" << std::endl
-									   << "                       The child node can be a full definition of the classtype required or a useID reference. For example," << std::endl
-									   << "                       <" << in->name << ">" << std::endl
-									   << "						      <CLASSTYPE uniqueID='object1'>" << std::endl
-									   << "						          ..." << std::endl
-									   << "						      </CLASSTYPE>" << std::endl
-									   << "                       </" << in->name << ">" << std::endl
-									   << "                       Or" << std::endl
-									   << "                       <" << in->name << ">" << std::endl
-									   << "						      <CLASSTYPE useID='object1'>" << std::endl
-									   << "                       </" << in->name << ">" << std::endl;
-
-				return false;
-			}
-
-			//get the first (and should be the only) child
-			osgDB::XmlNode* pointerNode = in->children[0];
-
-			//try and read the pointer node from the database
-			osg::ObjectPtr ptr = hogboxDB::HogBoxManager::Inst()->ReadNode(pointerNode);
-			
-			//check result
-			if(!ptr)
-			{
-				//pointer was not found or failed to be read
-				OSG_WARN << "XML ERROR: Parsing pointer attribute '" << in->name << "'," << std::endl
-									   << "                        ReadNode did not return a valid object for child node '" << pointerNode->name << "'." << std::endl
-									   << "                        The attribute pointer will not be set." << std::endl;
-				return false;
-			}
-
-			//cast the result to type T
-			T* typePtr = dynamic_cast<T*>(ptr.get()); 
-			if(!typePtr)
-			{
-				//error casting to type
-				OSG_WARN << "XML ERROR: Parsing pointer attribute '" << in->name << "'," << std::endl
-									   << "                        Failed to cast the object returned from ReadNode to the corrent type." << std::endl
-									   << "                        Please ensure '" << in->name << "' is expecting a classnode of type '" << pointerNode->name << "'." << std::endl;
-				return false;
-			}
+			T* typePtr = NULL;
+			if(!readXmlClassPointer(in, typePtr)){return false;}
 			//pass the typed pointer to set
 			this->set(typePtr);
 			return true;
@@ -225,46 +381,14 @@ namespace hogboxDB {
 		//
 		//release the pointers object from the database
 		virtual bool releaseAttribute(){
-			bool result = true;
-			//get the name of the object pointed to
-			L pointerObjectList = this->get();
-			if(pointerObjectList.size() > 0){
-				typename L::iterator itr = pointerObjectList.begin();
-				for( ; itr != pointerObjectList.end(); itr++){
-					T* listObject = (*itr);
-					std::string listObjectName = listObject->getName();
-					if(!hogboxDB::HogBoxManager::Inst()->ReleaseNodeByID(listObjectName)){
-						result=false;
-					}
-				}
-			}
-			return result;
+			return releaseXmlClassPointerList(this->get());
 		}
 
 		//write to nodes contents
 		virtual osgDB::XmlNodePtr serialize() 
 		{
             if(!mp_object){return NULL;}
-            
-			//create the head node which will provide the count as a property
-            osgDB::XmlNodePtr listNode = new osgDB::XmlNode();
-            listNode->name = this->getName();
-            listNode->type = osgDB::XmlNode::GROUP;
-            
-            //get local ref to the objects list 
-            L list = this->get();
-            
-            //set the count property
-            hogboxDB::setXmlPropertyValue(listNode.get(), "count", (unsigned int)list.size());
-            
-            //now loop each item of serialize to an xmlnode and add as child
-            for(unsigned int i=0; i<list.size(); i++){
-                osgDB::XmlNodePtr classNode = hogboxDB::HogBoxManager::Inst()->WriteXmlNode(list.at(i).get());
-                if(classNode.get()){
-                    listNode->children.push_back(classNode.get());
-                }
-            }
-            return listNode;
+            return writeXmlClassPointerList(this->getName(), this->get());
 		}
 
 		//
@@ -272,66 +396,9 @@ namespace hogboxDB {
 		//Each child node should represent a class node of type T
 		virtual bool deserialize(osgDB::XmlNode* in) 
 		{	
-			//
-			if(!in){return false;}
-
-			//see if we can get the count property (otherwise it's not a valid list
-			unsigned int count = 0;
-			if(!hogboxDB::getXmlPropertyValue(in, "count", count))
-			{
-				OSG_WARN << "XML ERROR: Parsing pointer list node '" << in->name << "'," << std::endl
-									   << "                      List nodes must contain a 'count' property. For example <" << in->name << " count='2'>" << std::endl;
-				return false;
-			}
-
-			//if count is 0 dont bother
-			if(count == 0)
-			{
-				OSG_WARN << "XML WARN: Parsing pointer list node '" << in->name << "'," << std::endl
-									  << "                      The list attribute has a count of '0', are you sure this is not a mistake?" << std::endl;
-
-				return false;
-			}
-
-
-			//see if the count matches the number of children
-			if(in->children.size() != count)
-			{
-				//warn user
-				OSG_WARN << "XML ERROR: Parsing pointer list attribute '" << in->name << "'," << std::endl
-									   << "                      Nodes 'count' property (" << count << ") does not match the number of child nodes (" << in->children.size() << ")." << std::endl
-									   << "                      The list will not be parsed." << std::endl;
-                //for(unsigned int i=0;i<in->children.size(); i++){
-                //    OSG_FATAL << "CHILD '" << i << "' name: '" << in->children[i]->name << "'." << std::endl;
-                //}
-				return false;
-			}
-
-			//allocate the list space
 			//create a new list to fill with the node data
 			L list;
-			list.assign(count, NULL);
-
-
-			//now get the contents, deserialise individual values
-			//and push_back onto our list
-			std::stringstream listStr(in->contents);
-			for(unsigned int i=0; i<count; i++)
-			{
-
-				osgDB::XmlNode* pointerNode = in->children[i];
-
-				//read the pointer node from the database
-				osg::ObjectPtr ptr = hogboxDB::HogBoxManager::Inst()->ReadNode(pointerNode);
-				//cast it to type and pass to set
-				T* typePtr = dynamic_cast<T*>(ptr.get()); 
-				if(typePtr){
-					list.at(i) = typePtr;
-				}else{
-					//XML CASTING ERROR
-					return false;
-				}
-			}
+			if(!readXmlClassPointerList<L,T>(in, list)){return false;}
 
 			//set the new list via the set callbaxk
 			this->set(list);
@@ -0,0 +1,567 @@
+/* Written by Thomas Hogarth, (C) 2011
+ *
+ * This library is open source and may be redistributed and/or modified under
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+ */
+
+#pragma once
+
+#include <hogboxDB/Export.h>
+#include <hogboxDB/XmlAttributeList.h>
+#include <hogboxDB/XmlAttributePtr.h>
+#include <hogboxDB/XmlAttributeMap.h>
+
+#include <OpenThreads/ReentrantMutex>
+#include <OpenThreads/ScopedLock>
+
+#include <vector>
+
+//
+//XmlAttributeTable
+//Describes the xml attributes of a wrapped class once per class type, instead of
+//each wrapper binding new XmlAttributes to its own object in bindXmlAttributes.
+//Each XmlAttributeBinding holds the member pointer or get/set methods of one
+//attribute and is handed the wrapper and object to read or write, so wrapping
+//an object allocates nothing for its attributes.
+//
+//A wrapper returns its table from XmlClassWrapper::getXmlAttributeTable, building
+//it on first use e.g.
+//
+//virtual const hogboxDB::XmlAttributeTable* getXmlAttributeTable(){
+//    static hogboxDB::XmlAttributeTablePtr s_table;
+//    OpenThreads::ScopedLock<OpenThreads::ReentrantMutex> lock(*hogboxDB::XmlAttributeTable::getBuildMutex());
+//    if(!s_table.valid()){
+//        s_table = new hogboxDB::XmlAttributeTable();
+//        s_table->addProperty<MyClass,float>("Size", &MyClass::GetSize, &MyClass::SetSize);
+//        s_table->addWrapperMember("File", &MyClassXmlWrapper::_fileName);
+//    }
+//    return s_table.get();
+//}
+//
+//The build mutex is held while checking the table so two threads reading the same
+//class at once (i.e. while paging) can't both build it.
+//
+//Attributes of the wrapped object are found by dynamic_cast of the wrapped object
+//to C, wrapper members (helper values read before being applied to the object in
+//deserialize) by casting the wrapper to W. Inherited wrappers pass their base
+//classes table to the constructor to start from its attributes.
+//
+namespace hogboxDB {
+
+class XmlClassWrapper;
+
+//
+//XmlAttributeBinding
+//Reads and writes one attribute of any instance of a class
+//
+class XmlAttributeBinding : public osg::Referenced
+{
+public:
+	XmlAttributeBinding(const std::string& name)
+		: osg::Referenced(),
+		_name(name)
+	{
+	}
+
+	//
+	//name of the attribute node
+	const std::string& getName()const{return _name;}
+
+	//
+	//read in into the attribute of object, or of the wrapper for wrapper members
+	virtual bool deserialize(XmlClassWrapper* wrapper, osg::Object* object, osgDB::XmlNode* in)const = 0;
+
+	//
+	//write the attribute into a new node, NULL if there is nothing to write
+	virtual osgDB::XmlNodePtr serialize(XmlClassWrapper* wrapper, osg::Object* object)const = 0;
+
+	//
+	//write the attribute straight to out, false if there is nothing to write.
+	//By default the node from serialize is written
+	virtual bool serialize(XmlClassWrapper* wrapper, osg::Object* object, XmlStreamWriter& out)const{
+		osgDB::XmlNodePtr attNode = this->serialize(wrapper, object);
+		return attNode.valid() && out.writeNode(attNode.get());
+	}
+
+	//
+	//release any objects the attribute points to from the database
+	virtual bool releaseAttribute(osg::Object* /*object*/)const{return true;}
+
+protected:
+
+	virtual ~XmlAttributeBinding(){}
+
+	//name in xml of the attribute node
+	std::string _name;
+};
+
+typedef osg::ref_ptr<XmlAttributeBinding> XmlAttributeBindingPtr;
+
+//
+//Public member of the wrapped object, as TypedXmlAttribute
+//
+template <class C, typename T>
+class XmlMemberBinding : public XmlAttributeBinding
+{
+public:
+	XmlMemberBinding(const std::string& name, T C::* member)
+		: XmlAttributeBinding(name),
+		_member(member)
+	{
+	}
+
+	virtual bool deserialize(XmlClassWrapper*, osg::Object* object, osgDB::XmlNode* in)const{
+		C* c = dynamic_cast<C*>(object);
+		if(!c || !in){return false;}
+		T readValue;
+		if(!hogboxDB::getXmlContents(in, readValue)){return false;}
+		c->*_member = readValue;
+		return true;
+	}
+
+	virtual osgDB::XmlNodePtr serialize(XmlClassWrapper*, osg::Object* object)const{
+		C* c = dynamic_cast<C*>(object);
+		if(!c){return NULL;}
+		osgDB::XmlNodePtr attNode = new osgDB::XmlNode();
+		attNode->name = _name;
+		attNode->type = osgDB::XmlNode::NODE;
+		hogboxDB::setXmlContents(attNode.get(), c->*_member);
+		return attNode;
+	}
+
+	virtual bool serialize(XmlClassWrapper*, osg::Object* object, XmlStreamWriter& out)const{
+		C* c = dynamic_cast<C*>(object);
+		if(!c){return false;}
+		out.beginNode(_name);
+		out.addContents(c->*_member);
+		out.endNode();
+		return true;
+	}
+
+protected:
+	T C::* _member;
+};
+
+//
+//Member of the wrapper itself, as TypedXmlAttribute pointing at a wrapper member
+//
+template <class W, typename T>
+class XmlWrapperMemberBinding : public XmlAttributeBinding
+{
+public:
+	XmlWrapperMemberBinding(const std::string& name, T W::* member)
+		: XmlAttributeBinding(name),
+		_member(member)
+	{
+	}
+
+	virtual bool deserialize(XmlClassWrapper* wrapper, osg::Object*, osgDB::XmlNode* in)const{
+		if(!wrapper || !in){return false;}
+		T readValue;
+		if(!hogboxDB::getXmlContents(in, readValue)){return false;}
+		static_cast<W*>(wrapper)->*_member = readValue;
+		return true;
+	}
+
+	virtual osgDB::XmlNodePtr serialize(XmlClassWrapper* wrapper, osg::Object*)const{
+		if(!wrapper){return NULL;}
+		osgDB::XmlNodePtr attNode = new osgDB::XmlNode();
+		attNode->name = _name;
+		attNode->type = osgDB::XmlNode::NODE;
+		hogboxDB::setXmlContents(attNode.get(), static_cast<W*>(wrapper)->*_member);
+		return attNode;
+	}
+
+	virtual bool serialize(XmlClassWrapper* wrapper, osg::Object*, XmlStreamWriter& out)const{
+		if(!wrapper){return false;}
+		out.beginNode(_name);
+		out.addContents(static_cast<W*>(wrapper)->*_member);
+		out.endNode();
+		return true;
+	}
+
+protected:
+	T W::* _member;
+};
+
+//
+//Get/set methods of the wrapped object, as CallbackXmlAttribute
+//
+template <class C, typename T>
+class XmlPropertyBinding : public XmlAttributeBinding
+{
+public:
+	typedef const T& (C::* GetHandler)() const;
+	typedef void (C::* SetHandler)(const T&);
+
+	XmlPropertyBinding(const std::string& name, GetHandler ghandler, SetHandler shandler)
+		: XmlAttributeBinding(name),
+		f_gethandler(ghandler),
+		f_sethandler(shandler)
+	{
+	}
+
+	virtual bool deserialize(XmlClassWrapper*, osg::Object* object, osgDB::XmlNode* in)const{
+		C* c = dynamic_cast<C*>(object);
+		if(!c || !in){return false;}
+		T readValue;
+		if(!hogboxDB::getXmlContents(in, readValue)){return false;}
+		if(!f_sethandler){
+			OSG_WARN << "XML ERROR: No set method provided for XmlAttribute '" << _name << "'. Objects value will not be set." << std::endl;
+			return false;
+		}
+		(c->*f_sethandler)(readValue);
+		return true;
+	}
+
+	virtual osgDB::XmlNodePtr serialize(XmlClassWrapper*, osg::Object* object)const{
+		C* c = dynamic_cast<C*>(object);
+		if(!c || !f_gethandler){return NULL;}
+		osgDB::XmlNodePtr attNode = new osgDB::XmlNode();
+		attNode->name = _name;
+		attNode->type = osgDB::XmlNode::NODE;
+		hogboxDB::setXmlContents(attNode.get(), (c->*f_gethandler)());
+		return attNode;
+	}
+
+	virtual bool serialize(XmlClassWrapper*, osg::Object* object, XmlStreamWriter& out)const{
+		C* c = dynamic_cast<C*>(object);
+		if(!c || !f_gethandler){return false;}
+		out.beginNode(_name);
+		out.addContents((c->*f_gethandler)());
+		out.endNode();
+		return true;
+	}
+
+protected:
+	GetHandler f_gethandler;
+	SetHandler f_sethandler;
+};
+
+//
+//List member of the wrapper, as TypedXmlAttributeList pointing at a wrapper member
+//
+template <class W, typename L, typename T>
+class XmlWrapperListBinding : public XmlAttributeBinding
+{
+public:
+	XmlWrapperListBinding(const std::string& name, L W::* list)
+		: XmlAttributeBinding(name),
+		_list(list)
+	{
+	}
+
+	virtual bool deserialize(XmlClassWrapper* wrapper, osg::Object*, osgDB::XmlNode* in)const{
+		if(!wrapper){return false;}
+		return readXmlValueList<L,T>(in, static_cast<W*>(wrapper)->*_list);
+	}
+
+	virtual osgDB::XmlNodePtr serialize(XmlClassWrapper* wrapper, osg::Object*)const{
+		if(!wrapper){return NULL;}
+		return writeXmlValueList(_name, static_cast<W*>(wrapper)->*_list);
+	}
+
+	virtual bool serialize(XmlClassWrapper* wrapper, osg::Object*, XmlStreamWriter& out)const{
+		if(!wrapper){return false;}
+		return writeXmlValueList(_name, static_cast<W*>(wrapper)->*_list, out);
+	}
+
+protected:
+	L W::* _list;
+};
+
+//
+//List get/set methods of the wrapped object, as CallbackXmlAttributeList
+//
+template <class C, typename L, typename T>
+class XmlListPropertyBinding : public XmlAttributeBinding
+{
+public:
+	typedef const L& (C::* GetListHandler)() const;
+	typedef void (C::* SetListHandler)(const L&);
+
+	XmlListPropertyBinding(const std::string& name, GetListHandler ghandler, SetListHandler shandler)
+		: XmlAttributeBinding(name),
+		f_getlisthandler(ghandler),
+		f_setlisthandler(shandler)
+	{
+	}
+
+	virtual bool deserialize(XmlClassWrapper*, osg::Object* object, osgDB::XmlNode* in)const{
+		C* c = dynamic_cast<C*>(object);
+		if(!c || !f_setlisthandler){return false;}
+		L list;
+		if(!readXmlValueList<L,T>(in, list)){return false;}
+		(c->*f_setlisthandler)(list);
+		return true;
+	}
+
+	virtual osgDB::XmlNodePtr serialize(XmlClassWrapper*, osg::Object* object)const{
+		C* c = dynamic_cast<C*>(object);
+		if(!c || !f_getlisthandler){return NULL;}
+		return writeXmlValueList(_name, (c->*f_getlisthandler)());
+	}
+
+	virtual bool serialize(XmlClassWrapper*, osg::Object* object, XmlStreamWriter& out)const{
+		C* c = dynamic_cast<C*>(object);
+		if(!c || !f_getlisthandler){return false;}
+		return writeXmlValueList(_name, (c->*f_getlisthandler)(), out);
+	}
+
+protected:
+	GetListHandler f_getlisthandler;
+	SetListHandler f_setlisthandler;
+};
+
+//
+//Pointer to another xml class via get/set methods of the wrapped object,
+//as CallbackXmlClassPointer
+//
+template <class C, typename T>
+class XmlPointerBinding : public XmlAttributeBinding
+{
+public:
+	typedef T* (C::* GetPtrHandler)();
+	typedef void (C::* SetPtrHandler)(T*);
+
+	XmlPointerBinding(const std::string& name, GetPtrHandler ghandler, SetPtrHandler shandler)
+		: XmlAttributeBinding(name),
+		f_getptrhandler(ghandler),
+		f_setptrhandler(shandler)
+	{
+	}
+
+	virtual bool deserialize(XmlClassWrapper*, osg::Object* object, osgDB::XmlNode* in)const{
+		C* c = dynamic_cast<C*>(object);
+		if(!c){return false;}
+		T* typePtr = NULL;
+		if(!readXmlClassPointer(in, typePtr)){return false;}
+		if(!f_setptrhandler){
+			OSG_WARN << "XML ERROR: No set method provided for XmlClassPointer Attribute '" << _name << "'. The pointer will not be set." << std::endl;
+			return false;
+		}
+		(c->*f_setptrhandler)(typePtr);
+		return true;
+	}
+
+	virtual osgDB::XmlNodePtr serialize(XmlClassWrapper*, osg::Object* object)const{
+		C* c = dynamic_cast<C*>(object);
+		if(!c || !f_getptrhandler){return NULL;}
+		return writeXmlClassPointer(_name, (c->*f_getptrhandler)());
+	}
+
+	virtual bool serialize(XmlClassWrapper*, osg::Object* object, XmlStreamWriter& out)const{
+		C* c = dynamic_cast<C*>(object);
+		if(!c || !f_getptrhandler){return false;}
+		return writeXmlClassPointer(_name, (c->*f_getptrhandler)(), out);
+	}
+
+	virtual bool releaseAttribute(osg::Object* object)const{
+		C* c = dynamic_cast<C*>(object);
+		if(!c || !f_getptrhandler){return false;}
+		return releaseXmlClassPointer((c->*f_getptrhandler)());
+	}
+
+protected:
+	GetPtrHandler f_getptrhandler;
+	SetPtrHandler f_setptrhandler;
+};
+
+//
+//List of pointers to other xml classes via get/set methods of the wrapped
+//object, as CallbackXmlClassPointerList
+//
+template <class C, typename L, typename T>
+class XmlPointerListBinding : public XmlAttributeBinding
+{
+public:
+	typedef L (C::* GetPtrListHandler)() const;
+	typedef void (C::* SetPtrListHandler)(const L&);
+
+	XmlPointerListBinding(const std::string& name, GetPtrListHandler ghandler, SetPtrListHandler shandler)
+		: XmlAttributeBinding(name),
+		f_getptrlisthandler(ghandler),
+		f_setptrlisthandler(shandler)
+	{
+	}
+
+	virtual bool deserialize(XmlClassWrapper*, osg::Object* object, osgDB::XmlNode* in)const{
+		C* c = dynamic_cast<C*>(object);
+		if(!c){return false;}
+		L list;
+		if(!readXmlClassPointerList<L,T>(in, list)){return false;}
+		if(!f_setptrlisthandler){
+			OSG_WARN << "XML ERROR: No set method provided for XmlClassPointerList Attribute '" << _name << "'. The pointer list will not be set." << std::endl;
+			return false;
+		}
+		(c->*f_setptrlisthandler)(list);
+		return true;
+	}
+
+	virtual osgDB::XmlNodePtr serialize(XmlClassWrapper*, osg::Object* object)const{
+		C* c = dynamic_cast<C*>(object);
+		if(!c || !f_getptrlisthandler){return NULL;}
+		return writeXmlClassPointerList(_name, (c->*f_getptrlisthandler)());
+	}
+
+	virtual bool serialize(XmlClassWrapper*, osg::Object* object, XmlStreamWriter& out)const{
+		C* c = dynamic_cast<C*>(object);
+		if(!c || !f_getptrlisthandler){return false;}
+		return writeXmlClassPointerList(_name, (c->*f_getptrlisthandler)(), out);
+	}
+
+	virtual bool releaseAttribute(osg::Object* object)const{
+		C* c = dynamic_cast<C*>(object);
+		if(!c || !f_getptrlisthandler){return false;}
+		return releaseXmlClassPointerList((c->*f_getptrlisthandler)());
+	}
+
+protected:
+	GetPtrListHandler f_getptrlisthandler;
+	SetPtrListHandler f_setptrlisthandler;
+};
+
+//
+//Map of keys to pointers to other xml classes via get/set by key methods of
+//the wrapped object, as CallbackXmlClassPointerMap
+//
+template <class C, typename K, typename T>
+class XmlPointerMapBinding : public XmlAttributeBinding
+{
+public:
+	typedef T* (C::* GetValueByKeyHandler)(const K&);
+	typedef void (C::* SetValueByKeyHandler)(const K&, T*);
+
+	XmlPointerMapBinding(const std::string& name, GetValueByKeyHandler ghandler, SetValueByKeyHandler shandler)
+		: XmlAttributeBinding(name),
+		f_getvaluebykeyhandler(ghandler),
+		f_setvaluebykeyhandler(shandler)
+	{
+	}
+
+	virtual bool deserialize(XmlClassWrapper*, osg::Object* object, osgDB::XmlNode* in)const{
+		C* c = dynamic_cast<C*>(object);
+		if(!c || !f_setvaluebykeyhandler){return false;}
+		std::vector< std::pair<K, T*> > values;
+		bool result = readXmlClassPointerMap(in, values);
+		for(unsigned int i=0; i<values.size(); i++){
+			(c->*f_setvaluebykeyhandler)(values[i].first, values[i].second);
+		}
+		return result;
+	}
+
+	//maps aren't written, as CallbackXmlClassPointerMap
+	virtual osgDB::XmlNodePtr serialize(XmlClassWrapper*, osg::Object*)const{
+		return NULL;
+	}
+	virtual bool serialize(XmlClassWrapper*, osg::Object*, XmlStreamWriter&)const{
+		return false;
+	}
+
+protected:
+	GetValueByKeyHandler f_getvaluebykeyhandler;
+	SetValueByKeyHandler f_setvaluebykeyhandler;
+};
+
+//
+//XmlAttributeTable
+//
+class HOGBOXDB_EXPORT XmlAttributeTable : public osg::Referenced
+{
+public:
+	//
+	//start from the attributes of base, i.e. the table of an inherited wrappers base
+	XmlAttributeTable(const XmlAttributeTable* base = NULL);
+
+	//
+	//Add a binding, fails if an attribute of the same name exists
+	bool addBinding(XmlAttributeBinding* binding);
+
+	//
+	//Helpers adding the bindings above
+	template <class C, typename T>
+	bool addMember(const std::string& name, T C::* member){
+		return addBinding(new XmlMemberBinding<C,T>(name, member));
+	}
+	template <class W, typename T>
+	bool addWrapperMember(const std::string& name, T W::* member){
+		return addBinding(new XmlWrapperMemberBinding<W,T>(name, member));
+	}
+	template <class C, typename T>
+	bool addProperty(const std::string& name,
+					typename XmlPropertyBinding<C,T>::GetHandler ghandler,
+					typename XmlPropertyBinding<C,T>::SetHandler shandler){
+		return addBinding(new XmlPropertyBinding<C,T>(name, ghandler, shandler));
+	}
+	template <class W, typename L, typename T>
+	bool addWrapperList(const std::string& name, L W::* list){
+		return addBinding(new XmlWrapperListBinding<W,L,T>(name, list));
+	}
+	template <class C, typename L, typename T>
+	bool addListProperty(const std::string& name,
+						typename XmlListPropertyBinding<C,L,T>::GetListHandler ghandler,
+						typename XmlListPropertyBinding<C,L,T>::SetListHandler shandler){
+		return addBinding(new XmlListPropertyBinding<C,L,T>(name, ghandler, shandler));
+	}
+	template <class C, typename T>
+	bool addPointer(const std::string& name,
+					typename XmlPointerBinding<C,T>::GetPtrHandler ghandler,
+					typename XmlPointerBinding<C,T>::SetPtrHandler shandler){
+		return addBinding(new XmlPointerBinding<C,T>(name, ghandler, shandler));
+	}
+	template <class C, typename L, typename T>
+	bool addPointerList(const std::string& name,
+						typename XmlPointerListBinding<C,L,T>::GetPtrListHandler ghandler,
+						typename XmlPointerListBinding<C,L,T>::SetPtrListHandler shandler){
+		return addBinding(new XmlPointerListBinding<C,L,T>(name, ghandler, shandler));
+	}
+	template <class C, typename K, typename T>
+	bool addPointerMap(const std::string& name,
+						typename XmlPointerMapBinding<C,K,T>::GetValueByKeyHandler ghandler,
+						typename XmlPointerMapBinding<C,K,T>::SetValueByKeyHandler shandler){
+		return addBinding(new XmlPointerMapBinding<C,K,T>(name, ghandler, shandler));
+	}
+
+	//
+	//Return the binding for attribute name, or NULL
+	const XmlAttributeBinding* find(const std::string& name)const;
+
+	//
+	//bindings in the order they were added
+	unsigned int getNumBindings()const{return _bindings.size();}
+	const XmlAttributeBinding* getBinding(unsigned int index)const{return _bindings[index].get();}
+
+	//
+	//Held by getXmlAttributeTable while it checks and builds its static table.
+	//Reentrant as inherited wrappers build their base classes table inside their own
+	static OpenThreads::ReentrantMutex* getBuildMutex();
+
+protected:
+
+	virtual ~XmlAttributeTable(void);
+
+	//
+	//Find a seed for hashName that puts every binding in its own slot
+	void buildIndex();
+
+	static unsigned int hashName(const char* name, unsigned int length, unsigned int seed);
+
+protected:
+
+	std::vector<XmlAttributeBindingPtr> _bindings;
+
+	//perfect hash of the binding names, the index of the binding in each slot or -1
+	std::vector<int> _slots;
+	unsigned int _seed;
+};
+
+typedef osg::ref_ptr<XmlAttributeTable> XmlAttributeTablePtr;
+
+};//end hogboxDB namespace
@@ -18,6 +18,7 @@
 #include <hogbox/HogBoxBase.h>
 #include <hogboxDB/Export.h>
 #include <hogboxDB/XmlUtils.h>
+#include <hogboxDB/XmlStreamWriter.h>
 
 
 
@@ -45,6 +46,9 @@ typedef osg::ref_ptr<XmlClassWrapper> XmlClassWrapperPtr;
 //XmlClassWrapper types are registered with the Manager so automatic allocation
 //of the correct type can be done
 //
+//Loaded objects are indexed by the xml node they were read from and by their
+//uniqueID, so repeat reads and useID lookups don't walk the loaded objects
+//
 class HOGBOXDB_EXPORT XmlClassManager : public osg::Object
 {
 public:
@@ -70,17 +74,46 @@ public:
 	//Find the node if it's already been loaded
 	osg::ObjectPtr GetNodeObjectByID(const std::string& uniqueID);
 
+	//
+	//Find the object loaded from xmlNode, if it has been
+	osg::ObjectPtr GetNodeObject(osgDB::XmlNode* xmlNode);
+
+	//
+	//Number of objects currently loaded by the manager
+	unsigned int GetNumLoadedObjects()const{return _objectList.size();}
+
+	//
+	//Append the uniqueIDs of the loaded objects to ids
+	void GetLoadedUniqueIDs(std::vector<std::string>& ids)const;
+
+	//
+	//The xml node the object with uniqueID was loaded from, NULL if it isn't loaded
+	osgDB::XmlNode* GetXmlNodeByID(const std::string& uniqueID);
+
+	//
+	//Read a changed xmlNode into the loaded object with the same uniqueID (see
+	//XmlClassWrapper::reload), the object is then indexed by xmlNode. With
+	//deserialize false xmlNode just replaces the node the object was loaded from
+	bool ReloadNode(osg::ref_ptr<osgDB::XmlNode> xmlNode, bool deserialize = true);
+
     //
     //Write an object to an xmlnode using one of the xmlclasswrappers
     osgDB::XmlNodePtr WriteXmlNode(osg::ObjectPtr object);
+
+    //
+    //Write an object straight to out using one of the xmlclasswrappers
+    bool WriteXmlStream(osg::ObjectPtr object, XmlStreamWriter& out);
     
 	//
 	//Release the node object if it has already been loaded
 	bool ReleaseNodeByID(const std::string& uniqueID);
 	
     //
-    //register a new class wrapper with the name it supports
+    //register a new class wrapper with the name it supports, also indexed by
+    //the HogBoxRegistry if this manager is registered with it
     void SupportsClassType(const std::string& className, XmlClassWrapperPtr wrapper);
+
+	const ClassTypeWrapperMap& GetSupportedClassTypes()const{return _supportedClassTypes;}
     
     //
     //Allocate a new xml class wrapper for the passed type, returns null
@@ -110,6 +143,11 @@ protected:
     //Serialize the passed XmlClassWrapper into a new xml node and return
     virtual osgDB::XmlNodePtr writeObjectToXmlNode(XmlClassWrapperPtr xmlWrapper);
 
+    //
+    //will allocate the relevant xmlclasswrapper for the object
+    //then use it to write the object to out
+    virtual bool writeObjectToXmlStream(osg::ObjectPtr object, XmlStreamWriter& out);
+
 protected:
 
 	//Manger type uniquename
@@ -125,6 +163,10 @@ protected:
 
 	XmlNodeToObjectMap _objectList;
 
+	//entries of _objectList by the uniqueID they were loaded with
+	typedef std::map<std::string, XmlNodeToObjectMap::iterator> UniqueIDToObjectMap;
+	UniqueIDToObjectMap _objectsByID;
+
 };
 
 
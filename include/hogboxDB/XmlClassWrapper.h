@@ -18,6 +18,7 @@
 #include <hogboxDB/XmlAttributeEnum.h>
 #include <hogboxDB/XmlAttributePtr.h>
 #include <hogboxDB/XmlAttributeMap.h>
+#include <hogboxDB/XmlAttributeTable.h>
 
 #include <hogbox/AssetManager.h>
 #include <hogboxDB/XmlUtils.h>
@@ -35,6 +36,9 @@ namespace hogboxDB {
 //Each classtype being wrapped provides a set of xmlAtrributes which are stored in
 //the _xmlAttributes list. These provied the means of de/serialising the classes
 //member variables from an xmlnode
+//Rather than binding new attributes to each object in bindXmlAttributes, wrappers
+//should describe them once for the class in an XmlAttributeTable returned from
+//getXmlAttributeTable. Attributes in the table are checked before _xmlAttributes
 //The classtype being wrapped should be of type osg::Object so that the xmlnode name
 //can use the osg::Object::className (Usually just base class)
 //
@@ -112,10 +116,24 @@ public:
 	//
 	//Read the xmlNode into our wrapped object.
 	virtual bool deserialize(osgDB::XmlNode* in);
+
+	//
+	//Read a changed version of the node the object was loaded from, when the
+	//database is reloaded. By default in is deserialized into the existing
+	//object, so attributes no longer in the node keep their current values.
+	//Wrappers whose deserialize adds to the object rather than setting it
+	//should undo that first
+	virtual bool reload(osgDB::XmlNode* in){return this->deserialize(in);}
     
     //
     //Write the wrapped object into an xmlNode
     virtual osgDB::XmlNodePtr serialize();
+
+    //
+    //Write the wrapped object straight to out, producing the same xml as
+    //writing the node from serialize. Table attributes are streamed, those
+    //bound in bindXmlAttributes are serialized to a node and written
+    virtual bool serialize(XmlStreamWriter& out);
 	
 	//
 	//Return the attribute with the name provided, the attribute
@@ -123,6 +141,12 @@ public:
 	//or can be deserialised from an xmlnode
 	XmlAttribute* get(const std::string& name);
 
+	//
+	//The attributes of the wrapped class type shared by all its wrappers, see
+	//XmlAttributeTable. Default is NULL, using only the attributes bound in
+	//bindXmlAttributes
+	virtual const XmlAttributeTable* getXmlAttributeTable(){return NULL;}
+
 	//
 	//Some objects require special case name setting. the default set the objects name
 	//to that of the nodes uniqueID. 
@@ -139,6 +163,10 @@ protected:
     //
     //Bind the xml attributes for the wrapped object
     virtual void bindXmlAttributes(){}
+
+    //
+    //Pick up the attribute table and bind any per object attributes
+    void bindAttributes();
     
     //
     //Return the class name from an xml node, default is the nodes name,
@@ -158,6 +186,10 @@ protected:
 
 	//the map of attributes to xml attribute node names
 	XmlAttributeMap _xmlAttributes;
+
+	//the table from getXmlAttributeTable, kept so the destructor can release
+	//the attributes once the derived wrapper has gone
+	osg::ref_ptr<const XmlAttributeTable> _attributeTable;
     
     //we also store a map of derived types, to compre against a nodes
     //'type' property to allow us to allocate the correct type for p_wrappedObject
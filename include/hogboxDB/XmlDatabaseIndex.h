@@ -0,0 +1,102 @@
+/* Written by Thomas Hogarth, (C) 2011
+ *
+ * This library is open source and may be redistributed and/or modified under
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+ */
+
+#pragma once
+
+#include <hogboxDB/Export.h>
+
+#include <osg/Referenced>
+#include <osgDB/XmlParser>
+#include <OpenThreads/Mutex>
+
+#include <fstream>
+#include <map>
+
+namespace hogboxDB {
+
+//
+//XmlDatabaseIndex
+//Indexes a HogBoxDatabase xml file without building its XmlNode tree. The file
+//is scanned once, recording the class type and byte range of every element with
+//a uniqueID property inside the root node. ReadNode then parses just the range
+//of the requested element, so only the nodes of loaded objects are ever held in
+//memory. The file is kept open for the lifetime of the index.
+//
+class HOGBOXDB_EXPORT XmlDatabaseIndex : public osg::Referenced
+{
+public:
+
+	//where an element is in the file
+	struct Entry
+	{
+		Entry()
+			: _begin(0),
+			_end(0)
+		{
+		}
+
+		//node name of the element
+		std::string _classType;
+		//offset of its '<' and one past its closing '>'
+		std::streamoff _begin;
+		std::streamoff _end;
+	};
+
+	XmlDatabaseIndex(void);
+
+	//
+	//Scan fileName, which must contain a rootName node, and index the elements
+	//inside it by uniqueID. Where ids are repeated the first element found
+	//depth first keeps the id, as with the XmlNode tree
+	bool Open(const std::string& fileName, const std::string& rootName = "HogBoxDatabase");
+
+	//
+	//Close the file and clear the index
+	void Close();
+
+	bool IsOpen()const{return !_fileName.empty();}
+	const std::string& GetFileName()const{return _fileName;}
+	unsigned int GetNumEntries()const{return _entries.size();}
+
+	//
+	//Return the entry for uniqueID, or NULL
+	const Entry* Find(const std::string& uniqueID)const;
+
+	//
+	//Parse the element with uniqueID from the file, it and its children are
+	//returned detached from the rest of the database. NULL if it's not indexed
+	//or fails to parse
+	osgDB::XmlNodePtr ReadNode(const std::string& uniqueID);
+
+protected:
+
+	virtual ~XmlDatabaseIndex(void);
+
+	//
+	//Scan the elements of _file into _entries
+	bool IndexElements(const std::string& rootName);
+
+protected:
+
+	std::string _fileName;
+	std::ifstream _file;
+	//ReadNode seeks the shared stream
+	OpenThreads::Mutex _fileMutex;
+
+	typedef std::map<std::string, Entry> UniqueIDEntryMap;
+	UniqueIDEntryMap _entries;
+};
+
+typedef osg::ref_ptr<XmlDatabaseIndex> XmlDatabaseIndexPtr;
+
+}; //end hogboxDB namespace
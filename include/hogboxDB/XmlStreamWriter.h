@@ -0,0 +1,148 @@
+/* Written by Thomas Hogarth, (C) 2011
+ *
+ * This library is open source and may be redistributed and/or modified under
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+ */
+
+#pragma once
+
+#include <hogboxDB/Export.h>
+
+#include <osgDB/XmlParser>
+#include <osg/Vec2>
+#include <osg/Vec3>
+#include <osg/Vec4>
+#include <osg/Quat>
+#include <osg/Matrix>
+
+#include <ostream>
+#include <vector>
+
+namespace hogboxDB {
+
+//
+//XmlStreamWriter
+//Writes xml straight to a stream as the nodes are visited, rather than building
+//an osgDB::XmlNode tree to write once complete. Output goes through a fixed
+//buffer and values are formatted into it without a stringstream, so writing
+//allocates nothing once the buffer is full size. The text written is the same
+//as osgDB::XmlNode::write would give for the equivalent tree, e.g.
+//
+//writer.beginNode("Material", true);
+//writer.addProperty("uniqueID", "myMaterial");
+//    writer.beginNode("Diffuse");
+//    writer.addContents(osg::Vec3(0.8f,0.8f,0.8f));
+//    writer.endNode();
+//writer.endNode();
+//
+//Only group nodes hold child nodes, other nodes hold contents. Properties are
+//written in the order they're added, the tree writes them sorted by name
+//
+class HOGBOXDB_EXPORT XmlStreamWriter
+{
+public:
+	XmlStreamWriter(std::ostream& out);
+
+	//
+	//Flushes anything still buffered, open nodes are left open
+	~XmlStreamWriter(void);
+
+	//
+	//Open a node inside the current group node
+	void beginNode(const std::string& name, bool group = false);
+
+	//
+	//Add a property to the node just opened, before its contents or children
+	void addProperty(const std::string& name, const std::string& value);
+	void addProperty(const std::string& name, unsigned int value);
+
+	//
+	//Append to the contents of the current node, multi component values are
+	//space separated as with typeToStringStream
+	void addContents(const std::string& value);
+	void addContents(const char* value);
+	void addContents(bool value);
+	void addContents(int value);
+	void addContents(unsigned int value);
+	void addContents(float value);
+	void addContents(double value);
+	void addContents(const osg::Vec2& value);
+	void addContents(const osg::Vec3& value);
+	void addContents(const osg::Vec4& value);
+	void addContents(const osg::Quat& value);
+	void addContents(const osg::Matrix& value);
+
+	//
+	//Close the current node
+	void endNode();
+
+	//
+	//Write an existing node and its children inside the current group node
+	bool writeNode(const osgDB::XmlNode* xmlNode);
+
+	//
+	//Write an information node, e.g. "xml version='1.0'" for the declaration
+	void writeInformation(const std::string& contents);
+
+	//
+	//Number of nodes open
+	unsigned int getDepth()const{return _depth;}
+
+	//
+	//Write the buffer to the stream, returns false if the stream has failed
+	bool flush();
+
+protected:
+
+	//
+	//Finish the opening tag of the current node if still open
+	void closeTag();
+
+	void writeIndent(unsigned int depth);
+
+	void write(char c){
+		if(_size == _buffer.size()){this->flush();}
+		_buffer[_size++] = c;
+	}
+	void write(const char* str, unsigned int length);
+	void write(const std::string& str){this->write(str.data(), str.size());}
+
+	//
+	//Write str replacing the characters osgDB::XmlNode escapes
+	void writeEscaped(const char* str, unsigned int length);
+
+	void writeValue(unsigned int value);
+	void writeValue(int value);
+	void writeValue(double value);
+
+	//
+	//A node that hasn't been closed. Entries are reused as nodes open and
+	//close, so their names keep their storage
+	struct OpenNode
+	{
+		std::string _name;
+		bool _group;
+	};
+
+protected:
+
+	std::ostream& _out;
+
+	std::vector<char> _buffer;
+	unsigned int _size;
+
+	std::vector<OpenNode> _open;
+	unsigned int _depth;
+
+	//the opening tag of the current node is missing its '>'
+	bool _tagOpen;
+};
+
+}; //end hogboxDB namespace
@@ -15,6 +15,7 @@
 
 #include <osg/Camera>
 #include <hogboxHUD/Region.h>
+#include <hogbox/Profiler.h>
 
 namespace hogboxHUD {
 
@@ -128,6 +129,9 @@ public:
     //Update operator
     virtual void operator()(osg::Node* node, osg::NodeVisitor* nv)
     {
+        //covers the update of every region below the hud
+        HOGBOX_PROFILE_SCOPE("HudUpdateCallback");
+
         if (nv->getVisitorType()==osg::NodeVisitor::UPDATE_VISITOR && 
             nv->getFrameStamp())
         {
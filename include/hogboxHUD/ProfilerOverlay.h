@@ -0,0 +1,77 @@
+/* Written by Thomas Hogarth, (C) 2011
+ *
+ * This library is open source and may be redistributed and/or modified under  
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or 
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the 
+ * OpenSceneGraph Public License for more details.
+ */
+
+#pragma once
+
+#include <hogboxHUD/TextRegion.h>
+
+#include <osg/Timer>
+
+namespace hogboxHUD {
+
+//
+//ProfilerOverlay
+//Text region showing hogbox::Profiler's summary of the last few frames, the
+//average and longest time of each scope, gpu timers and the latest counter
+//values. Refreshed a few times a second rather than every frame so it can be
+//read, and so building the summary doesn't swamp what's being measured.
+//Shows a note while the profiler is disabled
+//
+class HOGBOXHUD_EXPORT ProfilerOverlay : public TextRegion
+{
+public:
+    
+    //
+    ProfilerOverlay(TextRegionStyle* style = new TextRegionStyle());
+    
+    /** Copy constructor using CopyOp to manage deep vs shallow copy.*/
+    ProfilerOverlay(const ProfilerOverlay& region,const osg::CopyOp& copyop=osg::CopyOp::SHALLOW_COPY);
+    
+    META_Object(hogboxHUD,ProfilerOverlay);
+    
+    //
+    //Create left aligned text and start refreshing
+    virtual bool Create(osg::Vec2 corner, osg::Vec2 size, RegionStyle* style = new TextRegionStyle());
+    
+    //
+    //Frames averaged over, default 60
+    void SetNumFrames(const unsigned int& numFrames);
+    const unsigned int& GetNumFrames()const;
+    
+    //
+    //Seconds between refreshes, default 0.5
+    void SetRefreshInterval(const float& seconds);
+    const float& GetRefreshInterval()const;
+    
+    //
+    //Rebuild the text now
+    void Refresh();
+    
+protected:
+    
+    virtual ~ProfilerOverlay(void);
+    
+    class RefreshCallback;
+    
+protected:
+    
+    unsigned int _numFrames;
+    float _refreshInterval;
+    
+    //tick of the last refresh
+    osg::Timer_t _lastRefresh;
+};
+
+typedef osg::ref_ptr<ProfilerOverlay> ProfilerOverlayPtr;
+
+};
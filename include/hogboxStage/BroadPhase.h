@@ -0,0 +1,152 @@
+#pragma once
+
+#include <vector>
+
+#include <osg/Referenced>
+#include <osg/ref_ptr>
+#include <osg/BoundingBox>
+
+#include <hogboxStage/Export.h>
+
+namespace hogboxStage
+{
+
+//
+//ProxyPair
+//Two overlapping broad phase proxies, _a is always the lower id
+//
+struct ProxyPair
+{
+	ProxyPair(int a=-1, int b=-1)
+		: _a(a < b ? a : b),
+		_b(a < b ? b : a)
+	{
+	}
+	bool operator < (const ProxyPair& rhs)const{
+		return _a < rhs._a || (_a == rhs._a && _b < rhs._b);
+	}
+	bool operator == (const ProxyPair& rhs)const{
+		return _a == rhs._a && _b == rhs._b;
+	}
+	int _a;
+	int _b;
+};
+typedef std::vector<ProxyPair> ProxyPairVector;
+
+//
+//RayHit
+//Proxy hit by a ray and the distance along the ray to the hit
+//
+struct RayHit
+{
+	RayHit(int proxyID=-1, float distance=0.0f)
+		: _proxyID(proxyID),
+		_distance(distance)
+	{
+	}
+	bool operator < (const RayHit& rhs)const{return _distance < rhs._distance;}
+	int _proxyID;
+	float _distance;
+};
+typedef std::vector<RayHit> RayHitVector;
+
+//
+//BroadPhase
+//Base type for broad phase collision structures. A proxy is an axis aligned box with
+//a user data pointer, proxies are identified by an int id.
+//
+//The base maintains a persistent list of overlapping pairs. Only proxies that have been
+//moved (or created/destroyed) since the last UpdatePairs are requeried, pairs between
+//proxies that haven't moved are kept from the previous update
+//
+class HOGBOXSTAGE_EXPORT BroadPhase : public osg::Referenced
+{
+public:
+
+	BroadPhase();
+
+	//
+	//Create a proxy, returns its id
+	virtual int CreateProxy(const osg::BoundingBox& box, void* userData) = 0;
+
+	//
+	//Destroy a proxy, the id may be reused by later proxies
+	virtual void DestroyProxy(int proxyID) = 0;
+
+	//
+	//Set a proxies box, flags it for requery in UpdatePairs
+	virtual void MoveProxy(int proxyID, const osg::BoundingBox& box) = 0;
+
+	//
+	//Returns true if the id refers to a live proxy
+	virtual bool IsValidProxy(int proxyID)const = 0;
+
+	//
+	//The box the proxy was last created/moved with
+	virtual const osg::BoundingBox& GetProxyBox(int proxyID)const = 0;
+	virtual void* GetProxyUserData(int proxyID)const = 0;
+
+	virtual unsigned int GetNumProxies()const = 0;
+
+	//
+	//Append the ids of all proxies whose box overlaps box to results
+	virtual void QueryBox(const osg::BoundingBox& box, std::vector<int>& results) = 0;
+
+	//
+	//Append all proxies hit by the ray to hits, sorted nearest first. direction
+	//must be normalised
+	virtual void QueryRay(const osg::Vec3& origin, const osg::Vec3& direction, const float& maxDistance, RayHitVector& hits) = 0;
+
+	//
+	//Append the ids of all proxies whose box overlaps the sphere
+	void QuerySphere(const osg::Vec3& center, const float& radius, std::vector<int>& results);
+
+	//
+	//Bring the overlapping pair list up to date and return it
+	const ProxyPairVector& UpdatePairs();
+
+	//
+	//The pair list from the last UpdatePairs
+	const ProxyPairVector& GetPairs()const{return _pairs;}
+
+	//
+	//Number of proxies requeried by the last UpdatePairs
+	const unsigned int& GetLastNumMoved()const{return _lastNumMoved;}
+
+	//
+	//Slab test of a ray against a box, returns true on a hit within maxDistance
+	//passing the entry distance back through distance
+	static bool RayIntersectsBox(const osg::Vec3& origin, const osg::Vec3& invDirection,
+								const osg::BoundingBox& box, const float& maxDistance, float& distance);
+
+	static bool BoxesOverlap(const osg::BoundingBox& a, const osg::BoundingBox& b){
+		return a.xMin() <= b.xMax() && a.xMax() >= b.xMin() &&
+				a.yMin() <= b.yMax() && a.yMax() >= b.yMin() &&
+				a.zMin() <= b.zMax() && a.zMax() >= b.zMin();
+	}
+
+protected:
+
+	virtual ~BroadPhase(void);
+
+	//
+	//Flag a proxy to be requeried by the next UpdatePairs, called by
+	//derived types from Create/Destroy/MoveProxy
+	void BufferMove(int proxyID);
+
+protected:
+
+	ProxyPairVector _pairs;
+
+	//proxies to requery and a per id flag so each is only buffered once
+	std::vector<int> _moveBuffer;
+	std::vector<unsigned char> _movedFlags;
+
+	unsigned int _lastNumMoved;
+
+	//scratch query list
+	std::vector<int> _queryResults;
+};
+typedef osg::ref_ptr<BroadPhase> BroadPhasePtr;
+
+};
@@ -1,125 +1,146 @@
 #pragma once
 
-#include <hogboxStage/Entity.h>
+#include <osg/BoundingBox>
 
-namespace hogboxStage 
+#include <hogboxStage/Component.h>
+#include <hogboxStage/WorldTransformComponent.h>
+
+namespace hogboxStage
 {
 
+class CollisionSystem;
+class CollidableComponent;
+
+typedef std::vector<CollidableComponent*> CollidableComponentVector;
+
 //
-//CollidableEntity
+//CollideEvent
+//The update type passed to OnCollide receivers, the contacts
+//themselves can be read from the sending CollidableComponent
 //
-class HOGBOXSTAGE_EXPORT CollidableEntity : public osg::Object
+class CollideEvent : public ComponentEvent
 {
 public:
-	CollidableEntity(bool isProcedural=false)
-		: osg::Object(),
-		m_isProcedural(isProcedural)
+	CollideEvent(unsigned int numContacts=0)
+		: ComponentEvent(),
+		_numContacts(numContacts)
 	{
-		//add the on desturct message
-		AddCallbackEventType("OnDestruct");
-		AddCallbackEventType("OnUpdate");
 	}
 
 	/** Copy constructor using CopyOp to manage deep vs shallow copy.*/
-	Entity(const Entity& ent,const osg::CopyOp& copyop=osg::CopyOp::SHALLOW_COPY)
-		: osg::Object(ent, copyop)
+	CollideEvent(const CollideEvent& ent,const osg::CopyOp& copyop=osg::CopyOp::SHALLOW_COPY)
+		: ComponentEvent(ent, copyop),
+		_numContacts(ent._numContacts)
 	{
-		//add the on desturct message
-		AddCallbackEventType("OnDestruct");
-		AddCallbackEventType("OnUpdate");
 	}
 
-	META_Object(hogboxStage, Entity);
+	META_Object(hogboxStage, CollideEvent);
 
-	//
-	//register a callback to one of our events, returns false if the event does not exist
-	bool RegisterCallbackForEvent(EntityEventCallback* callback, const std::string& eventName){
-		if(!callback){return false;}
-		int eventIndex = GetCallbackEventIndex(eventName);
-		if(eventIndex == -1){return false;}
-
-		if(!_callbackEvents[eventIndex]->AddCallbackReceiver(callback)){
-			return false;
-		}
-		return true;
+	virtual void SetData(const ComponentEventData& data){
+		_numContacts = (unsigned int)data._values[0];
+	}
+	virtual void GetData(ComponentEventData& data)const{
+		data._values[0] = (double)_numContacts;
 	}
 
-	//
-	//Handle an event by name, signaling all callback receivers if the event is used by this entity
-	//returns false if event name does not exist
-	bool HandleEvent(const std::string& eventName, EntityEvent* entityEvent)
-	{	
-		//see if anyone can handle the event
-		if(TryToHandleEvent(eventName, entityEvent))
-		{
-			//if we use it then trigger any callback associated
-			TriggerEventCallback(eventName, entityEvent);
-			return true;
-		}
-		return false;
+protected:
+	virtual ~CollideEvent(){
 	}
 
+public:
+
+	unsigned int _numContacts;
+};
+
+//
+//CollidableComponent
+//Gives an entity a bounding box in the CollisionSystems broad phase. The local
+//bounds are transformed by the entities WorldTransformComponent, only components
+//that receive OnMoved are updated in the broad phase. OnCollide is posted every
+//step the component overlaps others
+//
+class HOGBOXSTAGE_EXPORT CollidableComponent : public Component
+{
+public:
+	CollidableComponent();
+
+	/** Copy constructor using CopyOp to manage deep vs shallow copy.*/
+	CollidableComponent(const CollidableComponent& ent,const osg::CopyOp& copyop=osg::CopyOp::SHALLOW_COPY);
+
+	META_Object(hogboxStage, CollidableComponent);
+
 	//
-	//returns the index of the callback if it exists else -1
-	int GetCallbackEventIndex(const std::string& eventName){
-		for(unsigned int i=0; i<_callbackEvents.size(); i++){
-			if(_callbackEvents[i]->GetEventName() == eventName){
-				return (int)i;
-			}
-		}
-		return -1;
+	//Interned id of the OnCollide event
+	static const ComponentEventID& OnCollideEventID(){
+		static const ComponentEventID s_onCollideID = GetComponentEventID("OnCollide");
+		return s_onCollideID;
 	}
 
-protected:
+	//
+	//pure virtual get type name to be implemented by concrete types
+	virtual const std::string GetTypeName(){return "CollidableComponent";}
 
-	virtual ~Entity(void) {
-		//inform callback receivers of destuct (TEST)
-		TriggerEventCallback("OnDestruct");
-	}
+	//
+	//When a new component is attached to our parent component all components are checked
+	//for un resolved dependancies. If this component depends on the newly added component type
+	//then it is passed to this components HandleComponentDependency function
+	virtual bool HandleComponentDependency(Component* component);
 
 	//
-	//Our main update function 
-	virtual bool OnUpdate(EventUpdate* update){return true;}
-
-	virtual bool TryToHandleEvent(const std::string& eventName, EntityEvent* entityEvent){
-		//cast entity event to known types
-		EventUpdate* update = dynamic_cast<EventUpdate*>(entityEvent);
-		if(update){
-			OnUpdate(update);
-			return true;
-		}
-		return false;
-	}
+	//Bounds in the entities local space
+	void SetLocalBounds(const osg::BoundingBox& bounds);
+	const osg::BoundingBox& GetLocalBounds()const{return _localBounds;}
 
 	//
-	//Adds a new EntityCallbackEvent to our list ensuring the name is unique, this should be used
-	//during a types constuctor to register any new event types, returns false if name already used
-	bool AddCallbackEventType(const std::string& eventName){
-		int existingIndex = GetCallbackEventIndex(eventName);
-		if(existingIndex == -1){return false;}
-		_callbackEvents.push_back(new EntityCallbackEvent(this, eventName));
-		return true;
-	}
+	//Transform applied to the local bounds, normally set from OnMoved
+	void SetTransform(const osg::Matrix& trans);
+	const osg::Matrix& GetTransform()const{return _transform;}
 
 	//
-	//Trigger an event callback
-	bool TriggerEventCallback(const std::string& eventName, EntityEvent* entityEvent){
-		int eventIndex = GetCallbackEventIndex(eventName);
-		if(eventIndex == -1){return false;}
-		_callbackEvents[eventIndex]->TriggerCallback(entityEvent);
-		return true;
-	}
+	//The local bounds transformed into world space
+	osg::BoundingBox ComputeWorldBounds()const;
+
+	//
+	//Components overlapping this one as of the last CollisionSystem update
+	const CollidableComponentVector& GetContacts()const{return _contacts;}
+
+	//
+	//The system we are registered with, NULL if none
+	CollisionSystem* GetCollisionSystem()const{return p_collisionSystem;}
+
+public:
+
+	//
+	//Callback triggered when an entities WorldTransformComponent is changed/moved
+	void OnEntityMovedCallback(Component* sender, ComponentEventPtr moveEvent);
+
+protected:
+
+	virtual ~CollidableComponent(void);
+
+	//
+	//Tell the collision system our bounds need updating
+	void MarkMoved();
+
+	//
+	//Post OnCollide with the current contact count
+	void PostCollide();
+
+	friend class CollisionSystem;
 
 protected:
 
-	//has the entity been generated by code (ture) or loaded
-	//from xml (false)
-	bool m_isProcedural;
+	osg::BoundingBox _localBounds;
+	osg::Matrix _transform;
 
-	//the list of callback events this etity has registered
-	std::vector<EntityCallbackEventPtr> _callbackEvents;
+	//owned by the CollisionSystem
+	CollisionSystem* p_collisionSystem;
+	int _proxyID;
+	//already in the systems moved list
+	bool _movedQueued;
 
+	CollidableComponentVector _contacts;
 };
-typedef osg::ref_ptr<Entity> EntityPtr;
+typedef osg::ref_ptr<CollidableComponent> CollidableComponentPtr;
 
-};
\ No newline at end of file
+};
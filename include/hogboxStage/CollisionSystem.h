@@ -0,0 +1,91 @@
+#pragma once
+
+#include <OpenThreads/Mutex>
+
+#include <hogboxStage/ComponentSystem.h>
+#include <hogboxStage/CollidableComponent.h>
+#include <hogboxStage/BroadPhase.h>
+
+namespace hogboxStage
+{
+
+//
+//CollidableHit
+//Component hit by a ray query and the distance along the ray
+//
+struct CollidableHit
+{
+	CollidableHit(CollidableComponent* component=NULL, float distance=0.0f)
+		: _component(component),
+		_distance(distance)
+	{
+	}
+	CollidableComponent* _component;
+	float _distance;
+};
+typedef std::vector<CollidableHit> CollidableHitVector;
+
+//
+//CollisionSystem
+//ComponentSystem for CollidableComponents. Each registered component gets a proxy in
+//a BroadPhase (a DynamicAABBTree unless one is passed). Each step only components that
+//moved since the last step are updated, the overlapping pairs are turned into per
+//component contact lists and OnCollide is posted to every component with contacts
+//
+class HOGBOXSTAGE_EXPORT CollisionSystem : public ComponentSystem
+{
+public:
+
+	CollisionSystem(BroadPhase* broadPhase = NULL);
+
+	//
+	//Creates/destroys the components broad phase proxy
+	virtual bool AddComponent(Component* component);
+	virtual bool RemoveComponent(Component* component);
+
+	//
+	//Flag a component to have its proxy updated next step, safe to
+	//call from any thread
+	void MarkMoved(CollidableComponent* component);
+
+	//
+	//Update moved proxies, rebuild contacts and post OnCollide
+	virtual void Update(ComponentUpdate* update);
+
+	BroadPhase* GetBroadPhase(){return _broadPhase.get();}
+
+	//
+	//Number of overlapping pairs found by the last update
+	unsigned int GetNumPairs()const{return _broadPhase->GetPairs().size();}
+
+	//
+	//Spatial queries, results are appended
+	void QueryRay(const osg::Vec3& origin, const osg::Vec3& direction, const float& maxDistance, CollidableHitVector& hits);
+	void QuerySphere(const osg::Vec3& center, const float& radius, CollidableComponentVector& results);
+	void QueryBox(const osg::BoundingBox& box, CollidableComponentVector& results);
+
+protected:
+
+	virtual ~CollisionSystem(void);
+
+	void AppendComponents(const std::vector<int>& proxyIDs, CollidableComponentVector& results);
+
+protected:
+
+	BroadPhasePtr _broadPhase;
+
+	//components flagged by MarkMoved
+	OpenThreads::Mutex _movedMutex;
+	CollidableComponentVector _moved;
+	CollidableComponentVector _moving;
+
+	//components given contacts by the last update
+	CollidableComponentVector _touching;
+
+	//scratch lists for queries
+	std::vector<int> _proxyResults;
+	RayHitVector _rayHits;
+};
+typedef osg::ref_ptr<CollisionSystem> CollisionSystemPtr;
+
+};
@@ -4,11 +4,14 @@
 #include <hogbox/HogBoxBase.h>
 #include <hogboxStage/ComponentEventCallback.h>
 
+#include <set>
+
 namespace hogboxStage 
 {
 
 //forward declare entity
 class Entity;
+class ComponentEventQueue;
 
 //
 //Component
@@ -51,15 +54,26 @@ public:
 	//
 	//register a callback to one of our events, returns false if the event does not exist
 	bool RegisterCallbackForEvent(ComponentEventCallback* callback, const std::string& eventName);
+	bool RegisterCallbackForEvent(ComponentEventCallback* callback, const ComponentEventID& eventID);
 
 	//
 	//returns the index of the callback if it exists else -1
 	int GetCallbackEventIndex(const std::string& eventName);
+	int GetCallbackEventIndex(const ComponentEventID& eventID);
 
 	//
 	//Returns true if this component depends on the passed type
 	bool DependsOnType(const std::string& typeName);
 
+	//
+	//Get the map of component types this component depends on, used by
+	//ComponentSystems to build the sets of types a system reads and writes
+	const ComponentDependencyMap& GetComponentDependencies()const{return _dependComponents;}
+
+	//
+	//Returns true if the dependency was added read only, see AddComponentDependency
+	bool IsReadOnlyDependency(const std::string& typeName)const;
+
 	//
 	//When a new component is attached to our parent component all components are checked
 	//for un resolved dependancies. If this component depends on the newly added component type
@@ -68,26 +82,47 @@ public:
 		return true;
 	}
 
+	//
+	//The queue PostEvent posts to, set by the StageScheduler the component's entity
+	//is added to. NULL (the default) posts to ComponentEventQueue::Inst. Events still
+	//queued on the previous queue are cancelled
+	void SetEventQueue(ComponentEventQueue* queue);
+	ComponentEventQueue* GetEventQueue();
+
 protected:
 
 	virtual ~Component(void);
 	//
 	//Adds a new ComponentCallbackEvent to our list ensuring the name is unique, this should be used
-	//during a types constuctor to register any new event types, returns false if name already used
-	bool AddCallbackEventType(const std::string& eventName);
+	//during a types constuctor to register any new event types, returns false if name already used.
+	//Events that will be posted with PostEvent need a prototype event to deliver the payload in
+	bool AddCallbackEventType(const std::string& eventName, ComponentEvent* prototype=NULL);
 
 	//
 	//Trigger an event callback
 	bool TriggerEventCallback(const std::string& eventName, ComponentEventPtr entityEvent);
+	bool TriggerEventCallback(const ComponentEventID& eventID, ComponentEventPtr entityEvent);
 
-	//add a dependency on a component type
-	void AddComponentDependency(const std::string& typeName);
+	//
+	//Post an event payload to the ComponentEventQueue, if the queue is deferring the event
+	//is delivered at the next dispatch, coalesced with any other posts of the same event.
+	//Does nothing if the event has no receivers, returns false if the event does not exist
+	bool PostEvent(const ComponentEventID& eventID, const ComponentEventData& eventData);
+
+	//
+	//Add a dependency on a component type. Dependencies are assumed to be written
+	//(e.g. PhysicsComponent moving its WorldTransformComponent), pass readOnly if
+	//the component only ever reads it so its system can run alongside others reading it
+	void AddComponentDependency(const std::string& typeName, bool readOnly=false);
 
 protected:
 
 	//pointer to the parent/owning entity
 	Entity* p_entity;
 
+	//queue of the scheduler we're added to, it resets this before it's destroyed
+	ComponentEventQueue* p_eventQueue;
+
 	//the list of callback events this etity has registered
 	std::vector<ComponentCallbackEventPtr> _callbackEvents;
 
@@ -96,6 +131,8 @@ protected:
 	bool _dependsResolved;
 	//map of component type name to a bool indicating if the dependency has been handled
 	ComponentDependencyMap _dependComponents;
+	//dependencies added read only
+	std::set<std::string> _readOnlyDependComponents;
 
 };
 typedef osg::ref_ptr<Component> ComponentPtr;
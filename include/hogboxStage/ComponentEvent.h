@@ -2,9 +2,58 @@
 
 #include <osg/Object>
 #include <osg/FrameStamp>
+#include <osg/Matrix>
 #include <hogbox/HogBoxBase.h>
+#include <hogboxStage/Export.h>
 
 namespace hogboxStage {
+
+//
+//ComponentEventID
+//Interned event name, events are looked up and triggered by id so no string
+//compares are needed per event
+//
+typedef unsigned int ComponentEventID;
+
+//
+//Returns the id for an event name, the same name always returns the same id.
+//Interning takes a lock so types should cache the ids they use (see WorldTransformComponent)
+extern HOGBOXSTAGE_EXPORT ComponentEventID GetComponentEventID(const std::string& eventName);
+
+//
+//Returns the name an id was interned from, or an empty string for an unknown id
+extern HOGBOXSTAGE_EXPORT const std::string& GetComponentEventName(const ComponentEventID& eventID);
+
+//
+//ComponentEventData
+//Plain data payload for posted events. It is copied by value into the ComponentEventQueue
+//so posting an event never allocates, it is large enough to hold a matrix
+//
+struct ComponentEventData
+{
+	double _values[16];
+
+	void SetMatrix(const osg::Matrix& matrix){
+		for(unsigned int r=0; r<4; r++){
+			for(unsigned int c=0; c<4; c++){
+				_values[r*4+c] = matrix(r,c);
+			}
+		}
+	}
+	osg::Matrix GetMatrix()const{
+		return osg::Matrix(_values[0], _values[1], _values[2], _values[3],
+						   _values[4], _values[5], _values[6], _values[7],
+						   _values[8], _values[9], _values[10], _values[11],
+						   _values[12], _values[13], _values[14], _values[15]);
+	}
+
+	void SetVec3(const osg::Vec3& vec, unsigned int offset=0){
+		_values[offset] = vec.x(); _values[offset+1] = vec.y(); _values[offset+2] = vec.z();
+	}
+	osg::Vec3 GetVec3(unsigned int offset=0)const{
+		return osg::Vec3(_values[offset], _values[offset+1], _values[offset+2]);
+	}
+};
 	
 //
 //The base container type for entity event params
@@ -24,6 +73,12 @@ public:
 	}
 
 	META_Object(hogboxStage, ComponentEvent);
+
+	//
+	//Fill the event from a posted payload, event types that can be posted
+	//through a ComponentEventQueue implement this and GetData
+	virtual void SetData(const ComponentEventData& data){}
+	virtual void GetData(ComponentEventData& data)const{}
 	
 protected:	
 	
@@ -42,25 +97,44 @@ class ComponentUpdate : public ComponentEvent
 public:
 	ComponentUpdate()
 		: ComponentEvent(),
-		_frameStamp()
+		_frameStamp(),
+		_timeStep(0.0),
+		_simulationTime(0.0)
 	{
 	}
 
-	ComponentUpdate(osg::FrameStamp frameStamp)
+	ComponentUpdate(osg::FrameStamp frameStamp, double timeStep=0.0, double simulationTime=0.0)
 		: ComponentEvent(),
-		_frameStamp(frameStamp)
+		_frameStamp(frameStamp),
+		_timeStep(timeStep),
+		_simulationTime(simulationTime)
 	{
 	}
 
 	/** Copy constructor using CopyOp to manage deep vs shallow copy.*/
 	ComponentUpdate(const ComponentUpdate& ent,const osg::CopyOp& copyop=osg::CopyOp::SHALLOW_COPY)
 		: ComponentEvent(ent, copyop),
-		_frameStamp(ent._frameStamp)
+		_frameStamp(ent._frameStamp),
+		_timeStep(ent._timeStep),
+		_simulationTime(ent._simulationTime)
 	{
 	}
 
 	META_Object(hogboxStage, ComponentUpdate);
 
+	//
+	//The viewer frame stamp for the frame this update was run in
+	const osg::FrameStamp& GetFrameStamp()const{return _frameStamp;}
+
+	//
+	//Seconds of simulation this update should advance by, the StageScheduler
+	//always passes its fixed time step
+	const double& GetTimeStep()const{return _timeStep;}
+
+	//
+	//Total simulated time at the start of this update
+	const double& GetSimulationTime()const{return _simulationTime;}
+
 protected:
 	virtual ~ComponentUpdate(){
 	}
@@ -69,7 +143,12 @@ protected:
 
 	//the current frame stamp from the viewer
 	osg::FrameStamp _frameStamp;
+
+	//fixed step in seconds and simulated time at the start of the step
+	double _timeStep;
+	double _simulationTime;
 };
+typedef osg::ref_ptr<ComponentUpdate> ComponentUpdatePtr;
 
 };//end hogboxStage namespace
  
\ No newline at end of file
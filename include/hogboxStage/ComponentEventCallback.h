@@ -94,20 +94,38 @@ namespace hogboxStage {
 	
 	//
 	//ComponentCallbackEvent allows a hud region to register a new type of event for which external objects can register
-	//ComponentEventCallbacks to be called when the event type is triggered
+	//ComponentEventCallbacks to be called when the event type is triggered.
+	//An optional prototype event is refilled and passed to receivers when the event is posted
+	//with a ComponentEventData payload, so posted events don't allocate
 	//
 	class ComponentCallbackEvent : public osg::Referenced 
 	{
 	public:
-		ComponentCallbackEvent(Component* sender, const std::string& eventName)
+		ComponentCallbackEvent(Component* sender, const std::string& eventName, ComponentEvent* prototype=NULL)
 			: osg::Referenced(),
 			p_eventSender(sender),
-			m_eventName(eventName)
+			m_eventName(eventName),
+			m_eventID(GetComponentEventID(eventName)),
+			m_prototype(prototype),
+			m_queuedIndex(-1)
 		{
 			
 		}
 		
 		const std::string& GetEventName(){return m_eventName;}
+		const ComponentEventID& GetEventID()const{return m_eventID;}
+
+		Component* GetSender(){return p_eventSender;}
+
+		//
+		//Returns true if anyone has registered for this event, posting is skipped if not
+		bool HasCallbackReceivers()const{return !m_callbacks.empty();}
+
+		//
+		//Index of this event in the ComponentEventQueue it is currently queued in, -1 if not queued.
+		//Used by the queue to coalesce multiple posts in one frame into one delivery
+		const int& GetQueuedIndex()const{return m_queuedIndex;}
+		void SetQueuedIndex(const int& index){m_queuedIndex = index;}
 		
 		//Register a new Callback receiver for this event
 		bool AddCallbackReceiver(ComponentEventCallback* callback)
@@ -127,6 +145,17 @@ namespace hogboxStage {
 				m_callbacks[i]->TriggerCallback(entityEvent);
 			}
 		}
+
+		//
+		//Trigger with a data payload, the prototype event is refilled and passed to all
+		//receivers. Receivers must copy anything they want to keep from the event
+		void TriggerCallback(const ComponentEventData& eventData)
+		{
+			if(m_prototype.get()){
+				m_prototype->SetData(eventData);
+			}
+			TriggerCallback(m_prototype);
+		}
 		
 	protected:
 		virtual ~ComponentCallbackEvent(void){}
@@ -138,6 +167,14 @@ namespace hogboxStage {
 		
 		//event has a name which can be used by user as a simple reference (e.g OnMouseDown)
 		std::string m_eventName; 
+		//interned id of the name
+		ComponentEventID m_eventID;
+
+		//event passed to receivers when triggered from a data payload
+		ComponentEventPtr m_prototype;
+
+		//slot in the ComponentEventQueue, -1 when not queued
+		int m_queuedIndex;
 		
 		//the list of callbacks registered to receive this event when triggered
 		std::vector<ComponentEventCallbackPtr> m_callbacks;
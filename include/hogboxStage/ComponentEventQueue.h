@@ -0,0 +1,103 @@
+#pragma once
+
+#include <OpenThreads/Mutex>
+
+#include <hogboxStage/Export.h>
+#include <hogboxStage/ComponentEventCallback.h>
+
+#include <hogbox/WorkStealingPool.h>
+
+namespace hogboxStage
+{
+
+//
+//ComponentEventQueue
+//Per frame queue of posted component events. Components post a plain data payload
+//which is copied into a reused array, so posting never allocates once the queue has
+//grown to its working size. Posting the same event of the same component more than
+//once before the next Dispatch overwrites the queued payload, so e.g. several moves
+//of one entity in a frame are delivered as a single OnMoved.
+//
+//When deferring is disabled (the default) posted events are triggered straight away.
+//The StageScheduler enables deferring and calls Dispatch once per step.
+//
+class HOGBOXSTAGE_EXPORT ComponentEventQueue : public osg::Referenced
+{
+public:
+
+	static ComponentEventQueue* Inst(bool erase = false);
+
+	ComponentEventQueue();
+
+	//
+	//Post an event payload, returns false if the event is NULL
+	bool Post(ComponentCallbackEvent* event, const ComponentEventData& data);
+
+	//
+	//Remove a queued event without delivering it, used when the sender is destroyed
+	void Cancel(ComponentCallbackEvent* event);
+
+	//
+	//Deliver all queued events. Events posted by receivers during dispatch are queued
+	//for the next Dispatch. If a pool is passed and parallel dispatch is enabled the
+	//events are delivered in batches across the pool
+	void Dispatch(hogbox::WorkStealingPool* pool = NULL);
+
+	//
+	//Queue posted events until Dispatch rather than triggering them straight away
+	void SetDeferred(const bool& defer);
+	const bool& IsDeferred()const{return _deferred;}
+
+	//
+	//Allow Dispatch to run batches of events on a pool, only safe if receivers
+	//don't touch state shared between entities (default false)
+	void SetParallelDispatch(const bool& parallel){_parallelDispatch = parallel;}
+	const bool& GetParallelDispatch()const{return _parallelDispatch;}
+
+	//
+	//Number of events currently waiting for Dispatch
+	unsigned int GetNumQueued();
+
+	//
+	//Counts since the last ResetStats
+	const unsigned int& GetNumPosted()const{return _numPosted;}
+	const unsigned int& GetNumCoalesced()const{return _numCoalesced;}
+	const unsigned int& GetNumDispatched()const{return _numDispatched;}
+	void ResetStats();
+
+protected:
+
+	virtual ~ComponentEventQueue(void);
+
+	struct QueuedEvent
+	{
+		ComponentCallbackEventPtr _event;
+		ComponentEventData _data;
+	};
+	typedef std::vector<QueuedEvent> QueuedEventVector;
+
+	class DispatchTask;
+
+	//
+	//Trigger a range of a dispatch list
+	static void DispatchRange(QueuedEventVector& events, unsigned int start, unsigned int end);
+
+protected:
+
+	OpenThreads::Mutex _mutex;
+
+	//events posted since the last Dispatch, swapped with the dispatch list each
+	//Dispatch so both keep their capacity
+	QueuedEventVector _queued;
+	QueuedEventVector _dispatching;
+
+	bool _deferred;
+	bool _parallelDispatch;
+
+	unsigned int _numPosted;
+	unsigned int _numCoalesced;
+	unsigned int _numDispatched;
+};
+typedef osg::ref_ptr<ComponentEventQueue> ComponentEventQueuePtr;
+
+};
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <set>
+
+#include <hogboxStage/Export.h>
+#include <hogboxStage/Component.h>
+
+namespace hogboxStage
+{
+
+//
+//SystemTiming
+//Per system timing info gathered by the StageScheduler, all times in milliseconds
+//
+struct SystemTiming
+{
+	SystemTiming()
+		: _lastMs(0.0),
+		_averageMs(0.0),
+		_maxMs(0.0),
+		_totalMs(0.0),
+		_numRuns(0)
+	{
+	}
+
+	void Record(const double& ms){
+		_lastMs = ms;
+		_totalMs += ms;
+		_numRuns++;
+		_averageMs = _totalMs/(double)_numRuns;
+		if(ms > _maxMs){_maxMs = ms;}
+	}
+
+	void Reset(){
+		*this = SystemTiming();
+	}
+
+	double _lastMs;
+	double _averageMs;
+	double _maxMs;
+	double _totalMs;
+	unsigned int _numRuns;
+};
+
+//
+//ComponentSystem
+//Updates every registered component of one type once per fixed step. A system declares
+//the component types it reads and writes so the StageScheduler can run systems that
+//don't touch the same types in parallel. The write set defaults to the updated type.
+//Each registered components AddComponentDependency types are added to the write set,
+//as components may change what they depend on, unless the dependency was added read
+//only in which case it goes in the read set
+//
+class HOGBOXSTAGE_EXPORT ComponentSystem : public osg::Referenced
+{
+public:
+
+	typedef std::set<std::string> ComponentTypeSet;
+
+	ComponentSystem(const std::string& name, const std::string& componentType);
+
+	const std::string& GetName()const{return _name;}
+
+	//
+	//The type name (Component::GetTypeName) of components this system updates
+	const std::string& GetComponentType()const{return _componentType;}
+
+	//
+	//Declare additional types this system reads or writes during Update
+	void AddReadType(const std::string& typeName);
+	void AddWriteType(const std::string& typeName);
+	const ComponentTypeSet& GetReadTypes()const{return _readTypes;}
+	const ComponentTypeSet& GetWriteTypes()const{return _writeTypes;}
+
+	//
+	//Returns true if the two systems can not safely run at the same time, i.e. one
+	//writes a type the other reads or writes
+	bool ConflictsWith(const ComponentSystem* system)const;
+
+	//
+	//Add a component to be updated, returns false if it isn't of our component type
+	//or is already registered
+	virtual bool AddComponent(Component* component);
+
+	//
+	//Remove a component, returns false if it wasn't registered
+	virtual bool RemoveComponent(Component* component);
+
+	unsigned int GetNumComponents()const{return _components.size();}
+	const ComponentPtrVector& GetComponents()const{return _components;}
+
+	//
+	//Run one step over all components, the default calls OnUpdate on each component
+	//with the shared update event
+	virtual void Update(ComponentUpdate* update);
+
+	//
+	//Timing for this system, recorded by the scheduler around each Update
+	const SystemTiming& GetTiming()const{return _timing;}
+	void RecordTiming(const double& ms){_timing.Record(ms);}
+	void ResetTiming(){_timing.Reset();}
+
+	//
+	//Used by the scheduler to know when the read/write sets have changed
+	//and the execution stages need rebuilding
+	const unsigned int& GetModifiedCount()const{return _modifiedCount;}
+
+protected:
+
+	virtual ~ComponentSystem(void);
+
+protected:
+
+	std::string _name;
+	std::string _componentType;
+
+	ComponentTypeSet _readTypes;
+	ComponentTypeSet _writeTypes;
+
+	ComponentPtrVector _components;
+
+	SystemTiming _timing;
+
+	unsigned int _modifiedCount;
+};
+typedef osg::ref_ptr<ComponentSystem> ComponentSystemPtr;
+typedef std::vector<ComponentSystemPtr> ComponentSystemPtrVector;
+
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <hogboxStage/BroadPhase.h>
+
+namespace hogboxStage
+{
+
+//
+//DynamicAABBTree
+//Broad phase built on a balanced binary tree of bounding boxes. Leaves store a 'fat'
+//box grown by a margin so small movements don't need the tree restructuring, a moved
+//proxy is only reinserted once it leaves its fat box. Queries descend the fat boxes
+//and test leaves against the exact proxy box
+//
+class HOGBOXSTAGE_EXPORT DynamicAABBTree : public BroadPhase
+{
+public:
+
+	//
+	//margin is added to each side of a proxies box to form its fat box
+	DynamicAABBTree(const float& margin = 0.1f);
+
+	virtual int CreateProxy(const osg::BoundingBox& box, void* userData);
+	virtual void DestroyProxy(int proxyID);
+	virtual void MoveProxy(int proxyID, const osg::BoundingBox& box);
+	virtual bool IsValidProxy(int proxyID)const;
+
+	virtual const osg::BoundingBox& GetProxyBox(int proxyID)const{return _nodes[proxyID]._box;}
+	virtual void* GetProxyUserData(int proxyID)const{return _nodes[proxyID]._userData;}
+
+	virtual unsigned int GetNumProxies()const{return _numProxies;}
+
+	virtual void QueryBox(const osg::BoundingBox& box, std::vector<int>& results);
+	virtual void QueryRay(const osg::Vec3& origin, const osg::Vec3& direction, const float& maxDistance, RayHitVector& hits);
+
+	//
+	//Rebuild the tree top down by median splits. Proxies inserted one at a time in
+	//random order give looser trees than a full build, call this after adding a large
+	//number of proxies at once. Proxy ids are unchanged
+	void Rebuild();
+
+	//
+	//Height of the tree, 0 for a single leaf, -1 when empty
+	int GetHeight()const;
+
+	void SetMargin(const float& margin){_margin = margin;}
+	const float& GetMargin()const{return _margin;}
+
+protected:
+
+	virtual ~DynamicAABBTree(void);
+
+	struct TreeNode
+	{
+		bool IsLeaf()const{return _child1 == -1;}
+
+		//fat box used by the tree
+		osg::BoundingBox _fatBox;
+		//exact box of a leaf
+		osg::BoundingBox _box;
+		void* _userData;
+		//parent, or next free node when on the free list
+		int _parent;
+		int _child1;
+		int _child2;
+		//leaf = 0, free node = -1
+		int _height;
+	};
+
+	//orders leaves by box center along an axis, used by Rebuild
+	struct LeafCenterLess;
+
+	int AllocateNode();
+	void FreeNode(int nodeID);
+
+	void InsertLeaf(int leaf);
+	void RemoveLeaf(int leaf);
+
+	//
+	//Perform a left or right rotation if node A is imbalanced, returns the new root of the subtree
+	int Balance(int iA);
+
+	//
+	//Build a subtree over leaves [start,end), returns its root
+	int BuildSubtree(std::vector<int>& leaves, unsigned int start, unsigned int end);
+
+	static float SurfaceArea(const osg::BoundingBox& box);
+	static osg::BoundingBox Combine(const osg::BoundingBox& a, const osg::BoundingBox& b);
+	static bool Contains(const osg::BoundingBox& outer, const osg::BoundingBox& inner);
+
+protected:
+
+	std::vector<TreeNode> _nodes;
+	int _root;
+	int _freeList;
+	unsigned int _numProxies;
+
+	float _margin;
+
+	//traversal stack reused between queries
+	std::vector<int> _stack;
+};
+typedef osg::ref_ptr<DynamicAABBTree> DynamicAABBTreePtr;
+
+};
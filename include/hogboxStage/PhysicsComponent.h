@@ -7,16 +7,22 @@
 namespace hogboxStage 
 {
 
+class PhysicsSystem;
+
 //
 //PhysicsComponent
 //Does basic particle physics and then sets the WorldTransformComponents
-//Position to reflect the particles
+//Position to reflect the particles. When registered with a PhysicsSystem the
+//body lives in the systems arrays and is stepped with all the others in one batch
 //
 class HOGBOXSTAGE_EXPORT PhysicsComponent : public Component
 {
 public:
 	PhysicsComponent()
-		: Component()
+		: Component(),
+		_mass(1.0f),
+		p_physicsSystem(NULL),
+		_bodyIndex(-1)
 	{
 		//add callback to indicate a change to the transform
 		//AddCallbackEventType("OnMoved");
@@ -30,9 +36,11 @@ public:
 	/** Copy constructor using CopyOp to manage deep vs shallow copy.*/
 	PhysicsComponent(const PhysicsComponent& ent,const osg::CopyOp& copyop=osg::CopyOp::SHALLOW_COPY)
 		: Component(ent, copyop),
-		_position(ent._position),
-		_mass(ent._mass),
-		_velocity(ent._velocity)
+		_position(ent.GetPosition()),
+		_mass(ent.GetMass()),
+		_velocity(ent.GetVelocity()),
+		p_physicsSystem(NULL),
+		_bodyIndex(-1)
 	{
 		//add callback to indicate a change to the transform
 		//AddCallbackEventType("OnMoved");
@@ -47,47 +55,38 @@ public:
 	virtual const std::string GetTypeName(){return "PhysicsComponent";}
 
 	//
-	//Our main update function 
-	virtual bool OnUpdate(ComponentEventPtr eventData){
-		 //integrate physics
-		//linear
-		float timeStep = 0.033f;
-		osg::Vec3 acceleration = _forces / _mass;
-		_velocity += acceleration * timeStep;
-		_position += _velocity * timeStep;
-		_forces = osg::Vec3(0.0f,0.0f,0.0f); //clear forces
-
-		return true;
-	}
-
+	//Our main update function, integrates this body on its own when it
+	//isn't part of a PhysicsSystem
+	virtual bool OnUpdate(ComponentEventPtr eventData);
 
 	//
 	//Get position
-	const osg::Vec3& GetPosition()const{ 
-		return _position;
-	}
+	osg::Vec3 GetPosition()const;
 	//
 	//Set position
-	void SetPosition(const osg::Vec3& pos){
-		_position = pos;
-	}
+	void SetPosition(const osg::Vec3& pos);
 
 	//
 	//Get mass
-	const float& GetMass()const{
-		return _mass;
-	}
+	float GetMass()const;
 	//
-	//Set mass
-	void SetMass(const float& mass){
-		_mass = mass;
-	}
+	//Set mass, zero makes the body kinematic
+	void SetMass(const float& mass);
 
 	//
 	//Get current Velocity
-	const osg::Vec3& GetVelocity(){
-		return _velocity;
-	}
+	osg::Vec3 GetVelocity()const;
+	//
+	//Set velocity
+	void SetVelocity(const osg::Vec3& velocity);
+
+	//
+	//Accumulate a force to be applied by the next step
+	void AddForce(const osg::Vec3& force);
+
+	//
+	//The system stepping this body, NULL if we integrate ourselves
+	PhysicsSystem* GetPhysicsSystem()const{return p_physicsSystem;}
 
 	//
 	//
@@ -116,9 +115,12 @@ protected:
 
 	}
 
+	friend class PhysicsSystem;
+
 protected:
 
-	//we use these only so we can use them as xml attributes
+	//we use these only so we can use them as xml attributes, while in a
+	//PhysicsSystem the systems arrays hold the live values
 	osg::Vec3 _position;
 	float     _mass;
 
@@ -129,6 +131,10 @@ protected:
 	//store a pointer to the worldtranscomp that this will move
 	WorldTransformComponentPtr p_worldTrans;
 
+	//the system and index of our body in its arrays
+	PhysicsSystem* p_physicsSystem;
+	int _bodyIndex;
+
 };
 typedef osg::ref_ptr<PhysicsComponent> PhysicsComponentPtr;
 
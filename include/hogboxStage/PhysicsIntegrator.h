@@ -0,0 +1,151 @@
+#pragma once
+
+#include <vector>
+
+#include <osg/Referenced>
+#include <osg/ref_ptr>
+#include <osg/Vec3>
+
+#include <hogboxStage/Export.h>
+
+namespace hogboxStage
+{
+
+//
+//PhysicsBodyArrays
+//Structure of arrays storage for a batch of particle bodies. Each component of the
+//position, velocity and force is kept in its own contiguous array so the integrator
+//can step several bodies per instruction. A mass of zero makes a body kinematic, it
+//keeps its velocity but ignores forces and gravity
+//
+class HOGBOXSTAGE_EXPORT PhysicsBodyArrays
+{
+public:
+	PhysicsBodyArrays();
+
+	//
+	//Add a body, returns its index
+	unsigned int AddBody(const osg::Vec3& position, const osg::Vec3& velocity, const float& mass);
+
+	//
+	//Remove a body by moving the last body into its slot, returns the old index
+	//of the body that was moved or -1 if index was the last body
+	int RemoveBody(unsigned int index);
+
+	void Clear();
+	void Reserve(unsigned int numBodies);
+
+	unsigned int GetNumBodies()const{return _invMass.size();}
+
+	osg::Vec3 GetPosition(unsigned int index)const{
+		return osg::Vec3(_posX[index], _posY[index], _posZ[index]);
+	}
+	//
+	//Teleport a body, its velocity is kept
+	void SetPosition(unsigned int index, const osg::Vec3& position);
+
+	osg::Vec3 GetVelocity(unsigned int index)const{
+		return osg::Vec3(_velX[index], _velY[index], _velZ[index]);
+	}
+	void SetVelocity(unsigned int index, const osg::Vec3& velocity);
+
+	float GetMass(unsigned int index)const{
+		return _invMass[index] > 0.0f ? 1.0f/_invMass[index] : 0.0f;
+	}
+	void SetMass(unsigned int index, const float& mass){
+		_invMass[index] = mass > 0.0f ? 1.0f/mass : 0.0f;
+	}
+
+	//
+	//Accumulate a force, forces are cleared by each integration step
+	void AddForce(unsigned int index, const osg::Vec3& force){
+		_forceX[index] += force.x();
+		_forceY[index] += force.y();
+		_forceZ[index] += force.z();
+	}
+	void ClearForces();
+
+	//
+	//Copy every position out in one pass, dest must hold GetNumBodies entries
+	void CopyPositions(osg::Vec3* dest)const;
+
+	//
+	//The step used by the last integration, Verlet derives velocity from the
+	//previous positions and this step
+	const float& GetLastTimeStep()const{return _lastTimeStep;}
+	void SetLastTimeStep(const float& timeStep){_lastTimeStep = timeStep;}
+
+public:
+
+	std::vector<float> _posX, _posY, _posZ;
+	//positions before the last step, used by Verlet
+	std::vector<float> _prevX, _prevY, _prevZ;
+	std::vector<float> _velX, _velY, _velZ;
+	std::vector<float> _forceX, _forceY, _forceZ;
+	std::vector<float> _invMass;
+
+protected:
+
+	float _lastTimeStep;
+};
+
+//
+//PhysicsIntegrator
+//Steps every body in a PhysicsBodyArrays at once. The inner loops use AVX when the cpu
+//supports it (detected with cpuid), SSE when the compiler targets it and fall back to
+//plain scalar code otherwise
+//
+class HOGBOXSTAGE_EXPORT PhysicsIntegrator : public osg::Referenced
+{
+public:
+
+	enum Method{
+		SEMI_IMPLICIT_EULER,
+		VERLET
+	};
+
+	enum InstructionSet{
+		SCALAR,
+		SSE,
+		AVX
+	};
+
+	PhysicsIntegrator(Method method = SEMI_IMPLICIT_EULER);
+
+	//
+	//Step all bodies by timeStep seconds and clear their forces. timeStep may
+	//change between calls, Verlet scales the previous displacement to match
+	void Integrate(PhysicsBodyArrays& bodies, const float& timeStep);
+
+	void SetMethod(const Method& method){_method = method;}
+	const Method& GetMethod()const{return _method;}
+
+	//
+	//Acceleration applied to every body with mass
+	void SetGravity(const osg::Vec3& gravity){_gravity = gravity;}
+	const osg::Vec3& GetGravity()const{return _gravity;}
+
+	//
+	//Force a narrower instruction set, i.e. to compare paths. Requests for
+	//sets that weren't compiled in use the best available
+	void SetInstructionSet(const InstructionSet& set);
+	const InstructionSet& GetInstructionSet()const{return _instructionSet;}
+
+	//
+	//The widest instruction set this build and cpu support
+	static InstructionSet GetBestInstructionSet();
+	static const char* GetInstructionSetName(const InstructionSet& set);
+
+protected:
+
+	virtual ~PhysicsIntegrator(void);
+
+protected:
+
+	Method _method;
+	osg::Vec3 _gravity;
+	InstructionSet _instructionSet;
+};
+typedef osg::ref_ptr<PhysicsIntegrator> PhysicsIntegratorPtr;
+
+};
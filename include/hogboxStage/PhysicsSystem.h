@@ -0,0 +1,61 @@
+#pragma once
+
+#include <hogboxStage/ComponentSystem.h>
+#include <hogboxStage/PhysicsComponent.h>
+#include <hogboxStage/PhysicsIntegrator.h>
+
+namespace hogboxStage
+{
+
+//
+//PhysicsSystem
+//ComponentSystem for PhysicsComponents. The bodies of all registered components are
+//held in one PhysicsBodyArrays and stepped together by a PhysicsIntegrator, the new
+//positions are then written to each entities WorldTransformComponent in a single pass
+//
+class HOGBOXSTAGE_EXPORT PhysicsSystem : public ComponentSystem
+{
+public:
+
+	PhysicsSystem(PhysicsIntegrator* integrator = NULL);
+
+	//
+	//Moves the components body into/out of our arrays
+	virtual bool AddComponent(Component* component);
+	virtual bool RemoveComponent(Component* component);
+
+	//
+	//Step by the updates fixed step, or by the time since the last frame
+	//stamp when the update has no fixed step
+	virtual void Update(ComponentUpdate* update);
+
+	//
+	//Step every body by timeStep seconds and write back the transforms
+	void Step(const float& timeStep);
+
+	PhysicsIntegrator* GetIntegrator(){return _integrator.get();}
+	PhysicsBodyArrays& GetBodies(){return _bodies;}
+	const PhysicsBodyArrays& GetBodies()const{return _bodies;}
+
+protected:
+
+	virtual ~PhysicsSystem(void);
+
+	//
+	//Copy each bodies position to its WorldTransformComponent
+	void WriteTransforms();
+
+protected:
+
+	PhysicsIntegratorPtr _integrator;
+
+	PhysicsBodyArrays _bodies;
+	//component owning each body, same order as the arrays
+	std::vector<PhysicsComponent*> _bodyComponents;
+
+	//reference time of the last variable step, -1 before the first
+	double _lastReferenceTime;
+};
+typedef osg::ref_ptr<PhysicsSystem> PhysicsSystemPtr;
+
+};
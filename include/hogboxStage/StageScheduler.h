@@ -0,0 +1,161 @@
+#pragma once
+
+#include <hogboxStage/Export.h>
+#include <hogboxStage/Entity.h>
+#include <hogboxStage/ComponentSystem.h>
+#include <hogboxStage/ComponentEventQueue.h>
+
+#include <hogbox/WorkStealingPool.h>
+
+namespace hogboxStage
+{
+
+//
+//StageScheduler
+//Decides when and in what order ComponentSystems update. Time from the viewer is fed
+//into a fixed timestep accumulator, each whole step runs every system once. The
+//remainder is exposed as an interpolation alpha so rendering can blend between the
+//previous and current simulation states.
+//
+//Systems are grouped into execution stages, a system is placed in the first stage after
+//any earlier registered system it conflicts with (see ComponentSystem::ConflictsWith).
+//Systems within a stage run in parallel on a WorkStealingPool.
+//
+//Component events posted during a step are deferred to the scheduler's ComponentEventQueue
+//and dispatched in one batch once all systems have run.
+//
+class HOGBOXSTAGE_EXPORT StageScheduler : public osg::Referenced
+{
+public:
+
+	typedef std::vector<ComponentSystem*> ExecutionStage;
+	typedef std::vector<ExecutionStage> ExecutionStageList;
+
+	//
+	//pool of NULL uses the shared hogbox::WorkStealingPool
+	StageScheduler(double fixedTimeStep = 1.0/60.0, hogbox::WorkStealingPool* pool = NULL);
+
+	//
+	//Add a system, returns false if one of the same name exists. Components
+	//of entities already added are registered with it
+	bool AddSystem(ComponentSystem* system);
+	bool RemoveSystem(ComponentSystem* system);
+	ComponentSystem* GetSystem(const std::string& name);
+	const ComponentSystemPtrVector& GetSystems()const{return _systems;}
+
+	//
+	//Register/unregister every component of the entity with the systems
+	//that update its type, and post their events to our queue. The components
+	//the entity has when added are the ones removed, components added to the
+	//entity afterwards need the entity removing and adding again
+	void AddEntity(Entity* entity);
+	void RemoveEntity(Entity* entity);
+
+	//
+	//Advance using the viewers frame stamp, the elapsed time is the difference
+	//in reference time since the last call. Returns the number of fixed steps run
+	unsigned int Frame(const osg::FrameStamp* frameStamp);
+
+	//
+	//Advance by elapsed seconds, running as many fixed steps as have accumulated
+	//(capped at GetMaxStepsPerFrame). Returns the number of fixed steps run
+	unsigned int Advance(const double& elapsed, const osg::FrameStamp* frameStamp = NULL);
+
+	//
+	//Run a single fixed step of all systems
+	void Step(const osg::FrameStamp* frameStamp = NULL);
+
+	//
+	//Fraction (0-1) of a step left in the accumulator, use to interpolate
+	//rendered transforms between the last two simulation states
+	double GetInterpolationAlpha()const;
+
+	void SetFixedTimeStep(const double& timeStep);
+	const double& GetFixedTimeStep()const{return _fixedTimeStep;}
+
+	//
+	//Cap on steps per Advance so a long frame can't cause a spiral of ever longer
+	//frames, extra time is dropped
+	void SetMaxStepsPerFrame(const unsigned int& steps){_maxStepsPerFrame = steps;}
+	const unsigned int& GetMaxStepsPerFrame()const{return _maxStepsPerFrame;}
+
+	//
+	//Run independent systems in parallel (default true)
+	void SetUseParallel(const bool& parallel){_useParallel = parallel;}
+	const bool& GetUseParallel()const{return _useParallel;}
+
+	//
+	//Total simulated time
+	const double& GetSimulationTime()const{return _simulationTime;}
+
+	//
+	//The current system grouping, rebuilt lazily when systems change
+	const ExecutionStageList& GetExecutionStages();
+
+	//
+	//The queue events are deferred to during a step, defaults to ComponentEventQueue::Inst.
+	//The scheduler switches the queue to deferred mode and the components of added
+	//entities to posting to it. The previous queue has its waiting events dispatched
+	//and is put back in the mode it was in, as is the last queue on destruction
+	void SetEventQueue(ComponentEventQueue* queue);
+	ComponentEventQueue* GetEventQueue(){return _eventQueue.get();}
+
+	//
+	//Time of the last full Step in milliseconds
+	const double& GetLastStepMs()const{return _lastStepMs;}
+
+	//
+	//Time spent dispatching events in the last Step in milliseconds
+	const double& GetLastDispatchMs()const{return _lastDispatchMs;}
+
+	//
+	//Print per system timings to the notify stream
+	void ReportTimings(std::ostream& out);
+
+protected:
+
+	virtual ~StageScheduler(void);
+
+	//
+	//Group systems into stages of non conflicting systems
+	void BuildExecutionStages();
+	bool ExecutionStagesDirty();
+
+	//
+	//Run a system and record its timing
+	static void RunSystem(ComponentSystem* system, ComponentUpdate* update);
+
+	class SystemTask;
+
+protected:
+
+	ComponentSystemPtrVector _systems;
+
+	//components of each added entity as they were when added, every one posts
+	//to our queue whether or not a system takes it
+	typedef std::map<Entity*, ComponentPtrVector> EntityComponentMap;
+	EntityComponentMap _entityComponents;
+
+	ExecutionStageList _stages;
+	//sum of system modified counts at last build, -1 forces a build
+	int _stagesModifiedCount;
+
+	hogbox::WorkStealingPoolPtr _pool;
+	bool _useParallel;
+
+	ComponentEventQueuePtr _eventQueue;
+	//mode of _eventQueue before we deferred it
+	bool _eventQueueWasDeferred;
+
+	double _fixedTimeStep;
+	unsigned int _maxStepsPerFrame;
+	double _accumulator;
+	double _simulationTime;
+	double _lastReferenceTime;
+
+	double _lastStepMs;
+	double _lastDispatchMs;
+};
+typedef osg::ref_ptr<StageScheduler> StageSchedulerPtr;
+
+};
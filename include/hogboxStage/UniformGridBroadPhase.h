@@ -0,0 +1,96 @@
+#pragma once
+
+#include <hogboxStage/BroadPhase.h>
+
+namespace hogboxStage
+{
+
+//
+//UniformGridBroadPhase
+//Broad phase that hashes proxies into uniform cells. Suits large numbers of similar
+//sized bodies where the cell size is around the size of a body. Each proxy remembers
+//the cell range it was inserted with so moves within the same cells cost nothing
+//
+class HOGBOXSTAGE_EXPORT UniformGridBroadPhase : public BroadPhase
+{
+public:
+
+	//
+	//cellSize is the edge length of a grid cell, numBuckets is rounded
+	//up to a power of two
+	UniformGridBroadPhase(const float& cellSize = 1.0f, unsigned int numBuckets = 4096);
+
+	virtual int CreateProxy(const osg::BoundingBox& box, void* userData);
+	virtual void DestroyProxy(int proxyID);
+	virtual void MoveProxy(int proxyID, const osg::BoundingBox& box);
+	virtual bool IsValidProxy(int proxyID)const;
+
+	virtual const osg::BoundingBox& GetProxyBox(int proxyID)const{return _proxies[proxyID]._box;}
+	virtual void* GetProxyUserData(int proxyID)const{return _proxies[proxyID]._userData;}
+
+	virtual unsigned int GetNumProxies()const{return _numProxies;}
+
+	virtual void QueryBox(const osg::BoundingBox& box, std::vector<int>& results);
+	virtual void QueryRay(const osg::Vec3& origin, const osg::Vec3& direction, const float& maxDistance, RayHitVector& hits);
+
+	const float& GetCellSize()const{return _cellSize;}
+	unsigned int GetNumBuckets()const{return _buckets.size();}
+
+protected:
+
+	virtual ~UniformGridBroadPhase(void);
+
+	struct CellRange
+	{
+		bool operator == (const CellRange& rhs)const{
+			return _min[0] == rhs._min[0] && _min[1] == rhs._min[1] && _min[2] == rhs._min[2] &&
+					_max[0] == rhs._max[0] && _max[1] == rhs._max[1] && _max[2] == rhs._max[2];
+		}
+		int _min[3];
+		int _max[3];
+	};
+
+	struct GridProxy
+	{
+		osg::BoundingBox _box;
+		void* _userData;
+		CellRange _cells;
+		//query stamp so a proxy spanning several cells is only reported once
+		unsigned int _stamp;
+		bool _alive;
+	};
+
+	CellRange ComputeCellRange(const osg::BoundingBox& box)const;
+	int ComputeCell(const float& value)const;
+	unsigned int HashCell(int x, int y, int z)const;
+
+	void InsertIntoCells(int proxyID);
+	void RemoveFromCells(int proxyID);
+
+	//
+	//Test every proxy in a cell against the box, used by QueryBox
+	void QueryCell(int x, int y, int z, const osg::BoundingBox& box, std::vector<int>& results);
+
+	//
+	//Start a new query, returns the stamp to mark visited proxies with
+	unsigned int NextStamp();
+
+protected:
+
+	float _cellSize;
+	float _invCellSize;
+
+	std::vector< std::vector<int> > _buckets;
+
+	std::vector<GridProxy> _proxies;
+	std::vector<int> _freeProxies;
+	unsigned int _numProxies;
+
+	//box around everything ever inserted, used to clip rays
+	osg::BoundingBox _bounds;
+
+	unsigned int _stamp;
+};
+typedef osg::ref_ptr<UniformGridBroadPhase> UniformGridBroadPhasePtr;
+
+};
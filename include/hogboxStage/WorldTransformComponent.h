@@ -27,6 +27,13 @@ public:
 
 	META_Object(hogboxStage, MovedEvent);
 
+	virtual void SetData(const ComponentEventData& data){
+		_transform = data.GetMatrix();
+	}
+	virtual void GetData(ComponentEventData& data)const{
+		data.SetMatrix(_transform);
+	}
+
 protected:
 	virtual ~MovedEvent(){
 	}
@@ -49,7 +56,7 @@ public:
 		: Component()
 	{
 		//add callback to indicate a change to the transform
-		AddCallbackEventType("OnMoved");
+		AddCallbackEventType("OnMoved", new MovedEvent());
 	}
 
 	/** Copy constructor using CopyOp to manage deep vs shallow copy.*/
@@ -58,11 +65,18 @@ public:
 		_transform(ent._transform)
 	{
 		//add callback to indicate a change to the transform
-		AddCallbackEventType("OnMoved");
+		AddCallbackEventType("OnMoved", new MovedEvent());
 	}
 
 	META_Box(hogboxStage, WorldTransformComponent);
 
+	//
+	//Interned id of the OnMoved event
+	static const ComponentEventID& OnMovedEventID(){
+		static const ComponentEventID s_onMovedID = GetComponentEventID("OnMoved");
+		return s_onMovedID;
+	}
+
 	//
 	//pure virtual get type name to be implemented by concrete types
 	virtual const std::string GetTypeName(){return "WorldTransformComponent";}
@@ -80,7 +94,7 @@ public:
 	void SetTransform(const osg::Matrix& trans){
 		if(trans != _transform){
 			_transform = trans;
-			this->TriggerEventCallback("OnMoved", new MovedEvent(_transform));
+			PostMoved();
 		}
 	}
 
@@ -95,7 +109,7 @@ public:
 		_translate = pos;
 		if(pos != _transform.getTrans()){
 			_transform.setTrans(pos);
-			this->TriggerEventCallback("OnMoved", new MovedEvent(_transform));
+			PostMoved();
 		}
 	}
 
@@ -125,7 +139,7 @@ public:
 	void SetRotation(const osg::Quat& rot){
 		if(rot != _transform.getRotate()){
 			_transform.setRotate(rot);
-			this->TriggerEventCallback("OnMoved", new MovedEvent(_transform));
+			PostMoved();
 		}
 	}
 
@@ -136,6 +150,15 @@ protected:
 
 	}
 
+	//
+	//Post OnMoved with the current transform, multiple moves in one
+	//frame are coalesced by the ComponentEventQueue
+	void PostMoved(){
+		ComponentEventData data;
+		data.SetMatrix(_transform);
+		this->PostEvent(OnMovedEventID(), data);
+	}
+
 protected:
 
 	osg::Matrix _transform;
@@ -16,8 +16,40 @@
 #include "hogtracker.h"
 #include "CameraCalibration.h"
 
+#include <OpenThreads/Mutex>
+#include <OpenThreads/Condition>
+
 namespace hogboxVision {
 
+//
+//TrackerStats
+//How long detection takes and how often it completes
+//
+struct TrackerStats
+{
+	TrackerStats()
+		: _latencyMs(0.0),
+		_averageLatencyMs(0.0),
+		_detectionMs(0.0),
+		_detectionRate(0.0),
+		_processedFrames(0),
+		_skippedFrames(0)
+	{
+	}
+
+	//frame capture (see CameraBasedTracker::Update) to poses published, last and running average
+	double _latencyMs;
+	double _averageLatencyMs;
+	//time spent in UpdateTracking for the last frame
+	double _detectionMs;
+	//completed detections per second
+	double _detectionRate;
+
+	unsigned int _processedFrames;
+	//frames replaced by a newer one before the tracker thread got to them
+	unsigned int _skippedFrames;
+};
+
 //
 //CameraBasedTracker 
 //Tracks objects in images using computer vision techniques
@@ -41,8 +73,24 @@ public:
 	bool InitTracker(int width=640, int height=480, const std::string& cameraCalibrationFile="");
 
 	//update the tracker then call base update which calls update tracker
-	//if the image modified count is different to ours
+	//if the image modified count is different to ours. When threaded the
+	//image is copied and handed to the tracker thread instead.
+	//The frame is stamped with VideoStream::GetFrameCaptureTime when image is a
+	//stream that records one, otherwise with the time Update is called, which
+	//adds the delay between capture and Update to the latency and pose times
 	virtual void Update(osg::ImagePtr image);
+
+	//
+	//Run UpdateTracking on a thread of its own against the latest image passed
+	//to Update, so a slow detector doesn't stall the caller. Tracked objects
+	//publish their poses as they're found, use TrackedObject::GetPredictedTransform
+	//to bring them up to display time. Trackers must stop the thread
+	//(SetThreaded(false)) in their destructor as it calls their UpdateTracking
+	void SetThreaded(bool threaded);
+	bool IsThreaded()const{return _thread.valid();}
+
+	TrackerStats GetTrackerStats();
+	void ResetTrackerStats();
 	
 	//should be pure virtual but it complains?
 	virtual void UpdateTracking(){}
@@ -55,6 +103,13 @@ protected:
 
 	virtual ~CameraBasedTracker(void);
 
+	//
+	//Track image captured at frameTime and record the stats
+	void TrackFrame(osg::Image* image, double frameTime);
+
+	class TrackerThread;
+	friend class TrackerThread;
+
 protected:
 
 	//dimensions of image being input
@@ -72,6 +127,20 @@ protected:
 	//their own implmentation of a CameraCalibration structure
 	CameraCalibrationPtr _cc;
 
+	//threaded tracking, the latest frame waits in _pendingImage
+	//until the thread swaps it with the one it's working on
+	osg::ref_ptr<TrackerThread> _thread;
+	OpenThreads::Mutex _frameMutex;
+	OpenThreads::Condition _frameCondition;
+	osg::ref_ptr<osg::Image> _pendingImage;
+	osg::ref_ptr<osg::Image> _workingImage;
+	bool _hasPendingFrame;
+	double _pendingFrameTime;
+
+	//guarded by _frameMutex
+	TrackerStats _stats;
+	double _lastDetectionEnd;
+
 };
 
 typedef osg::ref_ptr<CameraBasedTracker> CameraBasedTrackerPtr;
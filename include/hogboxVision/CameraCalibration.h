@@ -13,17 +13,25 @@
 
 #pragma once
 
+#include <hogboxVision/Export.h>
+#include <hogboxVision/ImageKernels.h>
 #include <hogbox/HogBoxBase.h>
 #include <string>
+#include <map>
+#include <osg/Vec2d>
+#include <osg/Texture2D>
+#include <OpenThreads/Mutex>
 
 namespace hogboxVision {
 
+class RTTPass;
+
 //CameraCalibration
 //base type for any type of camera calibration structure
 //i.e. opencv cam matrix, artk arparam structure
 //the intension is to allow access to any common variables
 //
-class CameraCalibration : public osg::Object
+class HOGBOXVIS_EXPORT CameraCalibration : public osg::Object
 {
 public:
 	CameraCalibration(void);
@@ -33,16 +41,79 @@ public:
 
 	META_Object(hogboxVision,CameraCalibration);
 
+	//resizing scales the intrinsics, or sets the defaults if there are none yet
 	virtual void ChangeSize(int width, int height);
 
 	//all camera calibrations should try to support
-	//a load from a single file
-	virtual bool LoadCalibrationFromFile(const std::string& fileName){return false;}
+	//a load from a single file. The base reads the pinhole intrinsics and any
+	//distortion from an xml node
+	//<CameraCalibration width="640" height="480" fx="" fy="" cx="" cy="" k1="" k2="" p1="" p2="" k3=""/>
+	virtual bool LoadCalibrationFromFile(const std::string& fileName);
+
+	//
+	//Pinhole intrinsics in pixels, principal point measured from the top left
+	//of the image. Without a calibration a 60 degree horizontal field of view
+	//centred on the image is assumed
+	void SetIntrinsics(double focalLengthX, double focalLengthY, double principalX, double principalY);
+	double GetFocalLengthX()const{return _focalLengthX;}
+	double GetFocalLengthY()const{return _focalLengthY;}
+	const osg::Vec2d& GetPrincipalPoint()const{return _principalPoint;}
+
+	int GetWidth()const{return _cameraWidth;}
+	int GetHeight()const{return _cameraHeight;}
+
+	//
+	//Lens distortion in the radial/tangential model OpenCV uses. With (x,y) the
+	//normalised point ((u-cx)/fx, (v-cy)/fy) and r^2 = x^2+y^2 it's distorted to
+	//x(1 + k1r^2 + k2r^4 + k3r^6) + 2p1xy + p2(r^2 + 2x^2),
+	//y(1 + k1r^2 + k2r^4 + k3r^6) + p1(r^2 + 2y^2) + 2p2xy
+	void SetDistortion(double k1, double k2, double p1, double p2, double k3 = 0.0);
+	//k1, k2, p1, p2, k3
+	const double* GetDistortion()const{return _distortion;}
+	bool HasDistortion()const;
+
+	//
+	//Move a pixel of the calibration sized image from its ideal position to
+	//where the lens puts it, and back (iteratively)
+	osg::Vec2d DistortPoint(const osg::Vec2d& pixel)const;
+	osg::Vec2d UndistortPoint(const osg::Vec2d& pixel)const;
+
+	//
+	//Table taking each pixel of an undistorted width x height image (the same
+	//intrinsics scaled to that size) to where it lies in the distorted frame, for
+	//ImageKernels::Remap. Built on first use for each size and kept until the
+	//calibration changes. bottomUp for images stored bottom row first. Hold on to
+	//the returned pointer while using the table, a calibration change on another
+	//thread drops it from the cache
+	RemapTablePtr GetUndistortTable(int width, int height, bool bottomUp = false);
+
+	//
+	//Undistort src into dst (reallocated to suit) with the table for its size
+	bool UndistortImage(const osg::Image* src, osg::Image* dst);
+
+	//
+	//The undistort table for the gpu, a NEAREST filtered GL_RGBA texture holding
+	//the source texture coordinate of each output texel in 16 bit fixed point,
+	//s in red/green and t in blue/alpha, high byte first
+	osg::Texture2D* CreateUndistortTexture(int width, int height, bool bottomUp = false);
+
+	//
+	//A width x height pass rendering inputTexture undistorted through
+	//CreateUndistortTexture
+	RTTPass* CreateUndistortPass(osg::Texture2D* inputTexture, int width, int height, bool bottomUp = false);
 
 protected:
 
 	virtual ~CameraCalibration(void);
 
+	//
+	//DistortPoint for an image of width x height
+	osg::Vec2d DistortPoint(const osg::Vec2d& pixel, int width, int height)const;
+
+	//
+	//Drop the cached tables after the calibration changes
+	void ClearUndistortTables();
+
 protected:
 
 	//common variables
@@ -51,7 +122,18 @@ protected:
 
 	double _focalLength;
 
-	//matrix, distortion (what format?)
+	//pinhole intrinsics in pixels
+	double _focalLengthX;
+	double _focalLengthY;
+	osg::Vec2d _principalPoint;
+
+	//k1, k2, p1, p2, k3
+	double _distortion[5];
+
+	//undistort tables by width, height and bottomUp
+	typedef std::pair<std::pair<int, int>, bool> TableKey;
+	std::map<TableKey, RemapTablePtr> _undistortTables;
+	OpenThreads::Mutex _tableMutex;
 };
 
 typedef osg::ref_ptr<CameraCalibration> CameraCalibrationPtr;
@@ -17,6 +17,7 @@
 #include <hogbox/HogBoxBase.h>
 #include <string>
 #include <vector>
+#include <OpenThreads/Mutex>
 
 #include "TrackedObject.h"
 
@@ -39,7 +40,8 @@ public:
 	//init the tracker 
 	virtual bool InitTracker();
 
-	//updates and then callus update tracking
+	//updates and then callus update tracking, poses published by
+	//the tracked objects are stamped with the frame time
 	virtual void Update();
 
 	//
@@ -49,6 +51,16 @@ public:
 	//Add a pre created object to the tracked objects  list
 	void AddTrackedObject(TrackedObjectPtr object);
 
+	//
+	//Filter applied to the poses of all the tracked objects each update, every
+	//object is given its own clone of filter. NULL to stop filtering
+	void SetPoseFilter(PoseFilter* filter);
+	PoseFilter* GetPoseFilter(){return _poseFilter.get();}
+
+	//
+	//Set the filter from a <PoseFilter> xml file (see ReadPoseFilterFromXml)
+	bool SetPoseFilterFromXmlFile(const std::string& fileName);
+
 protected:
 
 	virtual ~HogTracker(void);
@@ -57,6 +69,14 @@ protected:
 
 	//the list of objects being tracked by the tracker
 	std::vector<TrackedObjectPtr> _trackedObjects;
+	//held while tracking so objects can be added during threaded tracking
+	OpenThreads::Mutex _trackedObjectsMutex;
+
+	//capture time (osg::Timer time_s) of the frame being tracked, negative for now
+	double _frameTime;
+
+	//prototype cloned for each tracked object
+	osg::ref_ptr<PoseFilter> _poseFilter;
 
 };
 
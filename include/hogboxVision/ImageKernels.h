@@ -0,0 +1,189 @@
+/* Written by Thomas Hogarth, (C) 2011
+ *
+ * This library is open source and may be redistributed and/or modified under
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+ */
+
+#pragma once
+
+#include <hogboxVision/Export.h>
+
+#include <osg/Image>
+
+#include <vector>
+
+namespace hogboxVision {
+
+//
+//RemapTable
+//Per pixel source positions for ImageKernels::Remap. Each output pixel is the
+//bilinear blend of the 2x2 source block with its top left at _coords (x then y)
+//by _fractions (x then y, 0-128 in 1/128ths of a pixel), ~6 bytes a pixel.
+//Positions off the source take its nearest edge
+//
+class HOGBOXVIS_EXPORT RemapTable : public osg::Referenced
+{
+public:
+	RemapTable();
+
+	//
+	//Size for a width x height output sampled from a srcWidth x srcHeight source,
+	//which must be at least 2x2 and at most 65536 on a side
+	bool Allocate(unsigned int width, unsigned int height, unsigned int srcWidth, unsigned int srcHeight);
+
+	//
+	//Take output pixel (x,y) from source position (srcX,srcY), pixel centres at integers
+	void Set(unsigned int x, unsigned int y, double srcX, double srcY);
+
+	unsigned int _width;
+	unsigned int _height;
+	unsigned int _srcWidth;
+	unsigned int _srcHeight;
+	std::vector<unsigned short> _coords;
+	std::vector<unsigned char> _fractions;
+
+protected:
+
+	virtual ~RemapTable(void){}
+};
+
+typedef osg::ref_ptr<RemapTable> RemapTablePtr;
+
+//
+//ImageKernels
+//
+//Shared pixel kernels for video streams and capture backends, so each plugin
+//doesn't reimplement its own flipping, deinterlacing and colour conversion.
+//Every kernel has a scalar reference and SSE2/AVX2/NEON paths, the widest set
+//the cpu supports is picked at runtime (AVX2 is detected with cpuid, SSE2 and
+//NEON are assumed when the compiler targets them). The vector paths give
+//results identical to the scalar ones.
+//
+//The raw kernels take a row stride in bytes so padded rows can be processed,
+//the osg::Image overloads use the images own row size and dirty it afterwards
+//
+class HOGBOXVIS_EXPORT ImageKernels
+{
+public:
+
+	enum InstructionSet{
+		SCALAR,
+		SSE2,
+		AVX2,
+		NEON
+	};
+
+	enum DeinterlaceMode{
+		//rebuild the lines of the dropped field from the kept field above and below
+		BOB,
+		//average every line with the one below it
+		BLEND
+	};
+
+	enum YUVFormat{
+		//packed 4:2:2, Y0 U Y1 V
+		YUY2,
+		//packed 4:2:2, U Y0 V Y1
+		UYVY,
+		//4:2:0, Y plane followed by an interleaved UV plane
+		NV12,
+		//4:2:0, Y plane followed by U then V planes
+		I420
+	};
+
+	//
+	//The widest instruction set available on this cpu
+	static InstructionSet GetBestInstructionSet();
+
+	//
+	//Force a narrower instruction set for all kernels, i.e. to compare paths.
+	//Requests for unavailable sets use the best available
+	static void SetInstructionSet(const InstructionSet& set);
+	static InstructionSet GetInstructionSet();
+	static const char* GetInstructionSetName(const InstructionSet& set);
+
+	//
+	//Mirror the rows top to bottom
+	static void FlipVertical(unsigned char* data, unsigned int rowBytes, unsigned int height, unsigned int stride);
+	static void FlipVertical(osg::Image* image);
+
+	//
+	//Mirror each row left to right, pixelBytes can be 1 to 4
+	static void FlipHorizontal(unsigned char* data, unsigned int width, unsigned int height, unsigned int pixelBytes, unsigned int stride);
+	static void FlipHorizontal(osg::Image* image);
+
+	//
+	//Remove combing from an interlaced frame in place, keeping height. field is
+	//the field (0 even lines, 1 odd lines) BOB keeps
+	static void Deinterlace(unsigned char* data, unsigned int rowBytes, unsigned int height, unsigned int stride,
+							const DeinterlaceMode& mode, unsigned int field=0);
+	static void Deinterlace(osg::Image* image, const DeinterlaceMode& mode, unsigned int field=0);
+
+	//
+	//Copy one field to dst at half height, dst may equal src
+	static void ExtractField(const unsigned char* src, unsigned int rowBytes, unsigned int height, unsigned int srcStride,
+							unsigned int field, unsigned char* dst, unsigned int dstStride);
+
+	//
+	//Swap the first and third channels of 3 or 4 byte pixels, BGR(A)<->RGB(A).
+	//The osg::Image overload also swaps the images pixel format
+	static void SwapRedBlue(unsigned char* data, unsigned int width, unsigned int height, unsigned int pixelBytes, unsigned int stride);
+	static void SwapRedBlue(osg::Image* image);
+
+	//
+	//Convert a BT.601 (video range) YUV frame to RGB or RGBA (dstPixelBytes 3 or 4,
+	//alpha is set opaque). srcStride is the stride of the luma (or packed) rows,
+	//chroma planes are assumed tightly following with half the stride for I420
+	static void ConvertYUVToRGB(const YUVFormat& format, const unsigned char* src, unsigned int width, unsigned int height, unsigned int srcStride,
+								unsigned char* dst, unsigned int dstPixelBytes, unsigned int dstStride);
+	//
+	//Convert into image, reallocating it as GL_RGB/GL_RGBA if its size or format differ
+	static void ConvertYUVToRGB(const YUVFormat& format, const unsigned char* src, unsigned int width, unsigned int height, unsigned int srcStride,
+								osg::Image* image, bool alpha=false);
+
+	//
+	//Halve the width and height with a 2x2 box filter, dst may equal src
+	static void Downscale2x(const unsigned char* src, unsigned int width, unsigned int height, unsigned int srcStride, unsigned int pixelBytes,
+							unsigned char* dst, unsigned int dstStride);
+	//
+	//Return a new half size copy of image
+	static osg::Image* Downscale2x(const osg::Image* image);
+
+	//
+	//Weighted sum of the colour channels, (77R + 150G + 29B + 128) >> 8. pixelBytes
+	//can be 1 (copied), 3 or 4, bgr for BGR(A) channel order
+	static void ConvertToLuminance(const unsigned char* src, unsigned int width, unsigned int height, unsigned int srcStride,
+									unsigned int pixelBytes, bool bgr, unsigned char* dst, unsigned int dstStride);
+	//
+	//Return a new GL_LUMINANCE copy of an RGB(A)/BGR(A)/luminance image
+	static osg::Image* ConvertToLuminance(const osg::Image* image);
+
+	//
+	//Binarise a single channel image against the mean of the (2*radius+1)^2
+	//window round each pixel (clipped at the edges). dst is 255 where
+	//src + offset < mean, i.e. pixels darker than their surroundings, else 0
+	static void AdaptiveThreshold(const unsigned char* src, unsigned int width, unsigned int height, unsigned int srcStride,
+									unsigned int radius, unsigned char offset, unsigned char* dst, unsigned int dstStride);
+
+	//
+	//Resample src into dst through table, dst being the tables size and src its
+	//source size. pixelBytes can be 1 to 4, the vector paths cover 1 and 4
+	static void Remap(const unsigned char* src, unsigned int srcStride, unsigned int pixelBytes,
+						const RemapTable& table, unsigned char* dst, unsigned int dstStride);
+	//
+	//Remap into dst, reallocating it in srcs format if its size or format differ
+	static bool Remap(const osg::Image* src, const RemapTable& table, osg::Image* dst);
+
+	//
+	//Bytes between the rows of an osg::Image, including packing
+	static unsigned int GetRowStride(const osg::Image* image);
+};
+
+};
@@ -0,0 +1,224 @@
+/* Written by Thomas Hogarth, (C) 2011
+ *
+ * This library is open source and may be redistributed and/or modified under
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+ */
+
+#pragma once
+
+#include <hogboxVision/Export.h>
+#include <hogboxVision/CameraBasedTracker.h>
+#include <hogboxVision/PlanarTrackedObject.h>
+
+#include <hogbox/WorkStealingPool.h>
+#include <osg/Vec2d>
+
+#include <map>
+#include <vector>
+
+namespace hogboxVision {
+
+//
+//PlanarMarkerCandidate
+//A dark quad found in a frame and what it decoded to
+//
+struct PlanarMarkerCandidate
+{
+	PlanarMarkerCandidate()
+		: _id(-1),
+		_rotation(0),
+		_bitErrors(0),
+		_contrast(0.0f),
+		_area(0.0)
+	{
+		for(unsigned int i=0; i<4; i++){_codes[i] = 0;}
+	}
+
+	//corners in full resolution pixels from the top left of the image. Clockwise
+	//on screen, starting from the markers top left once decoded
+	osg::Vec2d _corners[4];
+
+	//the code read with each corner as the top left, -1 if the border didn't check out
+	int _codes[4];
+
+	//the matched marker, the quarter turns the corners were rotated by to put its
+	//top left first and the bits that didn't match. _id is -1 if nothing matched
+	int _id;
+	int _rotation;
+	unsigned int _bitErrors;
+
+	//difference between the border and the quiet zone round it, 0-1
+	float _contrast;
+	//in full resolution pixels
+	double _area;
+};
+
+//
+//PlanarMarkerTracker
+//
+//Built in fiducial tracker for square markers, a black border one cell wide round
+//a 4x4 grid of black/white cells encoding a 16 bit id (white is 1, read row by row
+//from the top left, most significant bit first). CreateMarkerImage renders them.
+//
+//Each frame is converted to luminance and halved down a pyramid until it's no wider
+//than the detection width. That level is binarised with ImageKernels::AdaptiveThreshold
+//and the outer contour of each dark blob is traced and fitted with a quad. Candidate
+//corners are then refined against the edges of the full resolution image and decoded,
+//and each tracked marker takes the largest candidate with its id, its pose coming
+//from the homography between the marker and the image. Candidates, then tracked
+//objects, are processed in parallel on a WorkStealingPool.
+//
+//Poses are in the osg camera frame (x right, y up, looking down -z) with the marker
+//centred on its origin, x to its right, y to its top and z out of its face, units
+//as the objects width (mm). The intrinsics come from the CameraCalibration, see
+//LoadCalibrationFromFile
+//
+class HOGBOXVIS_EXPORT PlanarMarkerTracker : public CameraBasedTracker
+{
+public:
+
+	enum{
+		//code cells along each side, and the total including the border
+		MARKER_BITS = 4,
+		MARKER_CELLS = MARKER_BITS+2
+	};
+
+	//pool of NULL uses the shared hogbox::WorkStealingPool
+	PlanarMarkerTracker(hogbox::WorkStealingPool* pool = NULL);
+
+	/** Copy constructor using CopyOp to manage deep vs shallow copy.*/
+	PlanarMarkerTracker(const PlanarMarkerTracker&,const osg::CopyOp& copyop=osg::CopyOp::SHALLOW_COPY);
+
+	META_Object(hogboxVision, PlanarMarkerTracker);
+
+	//
+	//Track marker id, width being the outside of the black border. Returns NULL if
+	//the id can't be told apart from itself rotated or from a marker already added
+	PlanarTrackedObject* AddMarker(unsigned int id, float width);
+	bool AddMarker(PlanarTrackedObject* object, unsigned int id);
+
+	//
+	//Find and decode the markers in image without updating any tracked objects.
+	//Undecodable quads are only returned if includeUnmatched is true
+	bool Detect(osg::Image* image, std::vector<PlanarMarkerCandidate>& candidates, bool includeUnmatched = false);
+
+	//
+	//Detect in p_image and update the tracked objects
+	virtual void UpdateTracking();
+
+	//
+	//Loads the intrinsics (see CameraCalibration::LoadCalibrationFromFile), an
+	//empty fileName uses the default field of view for the video size
+	virtual bool LoadCalibrationFromFile(const std::string& fileName);
+	CameraCalibration* GetCameraCalibration(){return _cc.get();}
+
+	//
+	//The candidates found in the last frame tracked, for debugging
+	const std::vector<PlanarMarkerCandidate>& GetLastCandidates()const{return _candidates;}
+
+	//
+	//Detection settings
+
+	//the pyramid level detected on is the first no wider than this, default 640
+	void SetMaxDetectionWidth(unsigned int width){_maxDetectionWidth = width;}
+	unsigned int GetMaxDetectionWidth()const{return _maxDetectionWidth;}
+
+	//threshold window radius in detection level pixels and how much darker than
+	//the window mean a pixel must be, defaults 7 and 7
+	void SetThreshold(unsigned int radius, unsigned char offset){_thresholdRadius = radius; _thresholdOffset = offset;}
+
+	//smallest marker side in detection level pixels, default 12
+	void SetMinMarkerSize(unsigned int size){_minMarkerSize = size;}
+
+	//minimum border contrast (0-1) and code bits allowed to be wrong, defaults 0.15 and 0
+	void SetMinContrast(float contrast){_minContrast = contrast;}
+	void SetMaxBitErrors(unsigned int errors){_maxBitErrors = errors;}
+
+	//run candidates and objects on the pool, default true
+	void SetUseParallel(bool parallel){_useParallel = parallel;}
+	bool GetUseParallel()const{return _useParallel;}
+
+	//
+	//Render marker id as a GL_LUMINANCE image, cellPixels per cell with marginCells
+	//of white quiet zone round it (at least 1 is needed for detection)
+	static osg::Image* CreateMarkerImage(unsigned int id, unsigned int cellPixels = 16, unsigned int marginCells = 1);
+
+	//
+	//id rotated a quarter turn clockwise
+	static unsigned int RotateCode(unsigned int code);
+
+protected:
+
+	virtual ~PlanarMarkerTracker(void);
+
+	class CandidateTask;
+	class ObjectTask;
+	friend class CandidateTask;
+	friend class ObjectTask;
+
+	//
+	//Luminance pyramid of image down to the detection level
+	bool BuildPyramid(osg::Image* image);
+
+	//
+	//Threshold the detection level and fit quads to the dark blobs
+	void FindQuads(std::vector<PlanarMarkerCandidate>& candidates);
+
+	//
+	//Refine the corners of candidate at full resolution and read its code
+	void DecodeCandidate(PlanarMarkerCandidate& candidate);
+
+	//
+	//Match a decoded candidate to the tracked ids, rotating its corners to suit
+	void MatchCandidate(PlanarMarkerCandidate& candidate);
+
+	//
+	//Pose of a marker of width from its corners
+	osg::Matrix ComputePose(const PlanarMarkerCandidate& candidate, float width);
+
+	//
+	//Update object from the candidates, called from the pool
+	void UpdateObject(PlanarTrackedObject* object, int id);
+
+protected:
+
+	hogbox::WorkStealingPoolPtr _pool;
+	bool _useParallel;
+
+	//tracked id of each object
+	std::map<const TrackedObject*, unsigned int> _markerIds;
+
+	unsigned int _maxDetectionWidth;
+	unsigned int _thresholdRadius;
+	unsigned char _thresholdOffset;
+	unsigned int _minMarkerSize;
+	float _minContrast;
+	unsigned int _maxBitErrors;
+
+	//luminance pyramid, level 0 is full resolution with the top row first
+	struct Level
+	{
+		unsigned int _width;
+		unsigned int _height;
+		std::vector<unsigned char> _pixels;
+	};
+	std::vector<Level> _levels;
+	unsigned int _detectionLevel;
+
+	//detection level buffers reused between frames
+	std::vector<unsigned char> _binary;
+	std::vector<int> _labels;
+
+	std::vector<PlanarMarkerCandidate> _candidates;
+};
+
+typedef osg::ref_ptr<PlanarMarkerTracker> PlanarMarkerTrackerPtr;
+
+};
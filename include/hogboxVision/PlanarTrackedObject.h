@@ -26,6 +26,9 @@ namespace hogboxVision {
 class HOGBOXVIS_EXPORT PlanarTrackedObject : public TrackedObject
 {
 public:
+
+	//the built in tracker sets the corners and direction
+	friend class PlanarMarkerTracker;
 	PlanarTrackedObject(TrackedDimensions dimensions=TRACKING_BOTH);
 
 	/** Copy constructor using CopyOp to manage deep vs shallow copy.*/
@@ -0,0 +1,257 @@
+/* Written by Thomas Hogarth, (C) 2011
+ *
+ * This library is open source and may be redistributed and/or modified under
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+ */
+
+#pragma once
+
+#include <hogboxVision/Export.h>
+#include <hogboxVision/TrackedObject.h>
+
+#include <iosfwd>
+#include <vector>
+
+namespace osgDB {
+class XmlNode;
+}
+
+namespace hogboxVision {
+
+//
+//PoseFilter
+//
+//A stage applied to the poses a tracker finds for a TrackedObject before they
+//are published. Each object needs its own instance as filters keep state, so
+//HogTracker::SetPoseFilter clones the one it's given for every object.
+//Filters work on the samples _position and _rotation, which are split from the
+//pose before the first stage and recombined after the last. A sample with
+//_isDetected false is a missed detection. The base filter passes samples through
+//
+class HOGBOXVIS_EXPORT PoseFilter : public osg::Object
+{
+public:
+	PoseFilter();
+
+	/** Copy constructor using CopyOp to manage deep vs shallow copy.*/
+	PoseFilter(const PoseFilter&,const osg::CopyOp& copyop=osg::CopyOp::SHALLOW_COPY);
+
+	META_Object(hogboxVision, PoseFilter);
+
+	//
+	//Filter sample in place
+	virtual void Apply(TrackedPoseSample& sample){}
+
+	//
+	//Forget any history, i.e. when the object is lost
+	virtual void Reset(){}
+
+protected:
+
+	virtual ~PoseFilter(void);
+};
+
+typedef osg::ref_ptr<PoseFilter> PoseFilterPtr;
+
+//
+//PoseFilterChain
+//Applies a list of filters in order, copies get their own copy of each filter
+//
+class HOGBOXVIS_EXPORT PoseFilterChain : public PoseFilter
+{
+public:
+	PoseFilterChain();
+
+	/** Copy constructor using CopyOp to manage deep vs shallow copy.*/
+	PoseFilterChain(const PoseFilterChain&,const osg::CopyOp& copyop=osg::CopyOp::SHALLOW_COPY);
+
+	META_Object(hogboxVision, PoseFilterChain);
+
+	virtual void Apply(TrackedPoseSample& sample);
+	virtual void Reset();
+
+	void AddFilter(PoseFilter* filter);
+	unsigned int GetNumFilters()const{return _filters.size();}
+	PoseFilter* GetFilter(unsigned int i){return _filters[i].get();}
+
+protected:
+
+	virtual ~PoseFilterChain(void);
+
+	std::vector<PoseFilterPtr> _filters;
+};
+
+//
+//OutlierRejectionPoseFilter
+//Turns detections that jump further than maxDistance or turn more than maxAngle
+//(degrees) from the last accepted pose into missed detections. After
+//maxRejections in a row the object is assumed to have really moved and the
+//pose is accepted
+//
+class HOGBOXVIS_EXPORT OutlierRejectionPoseFilter : public PoseFilter
+{
+public:
+	OutlierRejectionPoseFilter(double maxDistance = 50.0, double maxAngle = 30.0, unsigned int maxRejections = 3);
+
+	/** Copy constructor using CopyOp to manage deep vs shallow copy.*/
+	OutlierRejectionPoseFilter(const OutlierRejectionPoseFilter&,const osg::CopyOp& copyop=osg::CopyOp::SHALLOW_COPY);
+
+	META_Object(hogboxVision, OutlierRejectionPoseFilter);
+
+	virtual void Apply(TrackedPoseSample& sample);
+	virtual void Reset();
+
+	unsigned int GetNumRejected()const{return _numRejected;}
+
+	double _maxDistance;
+	double _maxAngle;
+	unsigned int _maxRejections;
+
+protected:
+
+	virtual ~OutlierRejectionPoseFilter(void){}
+
+	bool _hasLast;
+	osg::Vec3d _lastPosition;
+	osg::Quat _lastRotation;
+	unsigned int _rejectionsInARow;
+	unsigned int _numRejected;
+};
+
+//
+//HoldPoseFilter
+//Smooths the confidence and covers missed detections. While detected the
+//confidence rises towards the measured one over riseTime seconds. When a
+//detection is missed the last pose is held as detected with the confidence
+//halving every halfLife seconds, until it drops below minConfidence or the
+//pose has been held for maxHoldTime
+//
+class HOGBOXVIS_EXPORT HoldPoseFilter : public PoseFilter
+{
+public:
+	HoldPoseFilter(double maxHoldTime = 0.5, double halfLife = 0.15, double riseTime = 0.1, double minConfidence = 0.1);
+
+	/** Copy constructor using CopyOp to manage deep vs shallow copy.*/
+	HoldPoseFilter(const HoldPoseFilter&,const osg::CopyOp& copyop=osg::CopyOp::SHALLOW_COPY);
+
+	META_Object(hogboxVision, HoldPoseFilter);
+
+	virtual void Apply(TrackedPoseSample& sample);
+	virtual void Reset();
+
+	double _maxHoldTime;
+	double _halfLife;
+	double _riseTime;
+	double _minConfidence;
+
+protected:
+
+	virtual ~HoldPoseFilter(void){}
+
+	bool _hasLast;
+	TrackedPoseSample _last;
+	double _lastDetectedTime;
+	double _confidence;
+};
+
+//
+//ExponentialPoseFilter
+//Moves the position a fraction of the way to each new pose and slerps the
+//rotation likewise. The fractions come from time constants in seconds so the
+//smoothing doesn't depend on the detection rate, a time constant of 0 leaves
+//that part unfiltered (i.e. rotation only slerp smoothing)
+//
+class HOGBOXVIS_EXPORT ExponentialPoseFilter : public PoseFilter
+{
+public:
+	ExponentialPoseFilter(double positionTimeConstant = 0.05, double rotationTimeConstant = 0.05);
+
+	/** Copy constructor using CopyOp to manage deep vs shallow copy.*/
+	ExponentialPoseFilter(const ExponentialPoseFilter&,const osg::CopyOp& copyop=osg::CopyOp::SHALLOW_COPY);
+
+	META_Object(hogboxVision, ExponentialPoseFilter);
+
+	virtual void Apply(TrackedPoseSample& sample);
+	virtual void Reset();
+
+	double _positionTimeConstant;
+	double _rotationTimeConstant;
+
+protected:
+
+	virtual ~ExponentialPoseFilter(void){}
+
+	bool _hasLast;
+	TrackedPoseSample _last;
+};
+
+//
+//OneEuroPoseFilter
+//The 1 euro filter (Casiez et al. 2012), a low pass whose cutoff rises with the
+//speed, so slow movement is smoothed heavily to remove jitter and fast movement
+//lightly to keep lag down. Applied to each position axis and to the rotation
+//through its angular speed and slerp
+//
+class HOGBOXVIS_EXPORT OneEuroPoseFilter : public PoseFilter
+{
+public:
+	OneEuroPoseFilter(double minCutoff = 1.0, double beta = 0.007, double derivativeCutoff = 1.0);
+
+	/** Copy constructor using CopyOp to manage deep vs shallow copy.*/
+	OneEuroPoseFilter(const OneEuroPoseFilter&,const osg::CopyOp& copyop=osg::CopyOp::SHALLOW_COPY);
+
+	META_Object(hogboxVision, OneEuroPoseFilter);
+
+	virtual void Apply(TrackedPoseSample& sample);
+	virtual void Reset();
+
+	//minimum cutoff in hz, speed coefficient and cutoff for the speed estimate
+	double _minCutoff;
+	double _beta;
+	double _derivativeCutoff;
+
+	//rotation speed is scaled by this before the beta term, converting
+	//radians/s to roughly the units/s of the position
+	double _angularScale;
+
+protected:
+
+	virtual ~OneEuroPoseFilter(void){}
+
+	bool _hasLast;
+	TrackedPoseSample _last;
+	osg::Vec3d _positionSpeed;
+	double _angularSpeed;
+};
+
+//
+//Build a PoseFilterChain from a <PoseFilter> node, stages are applied in the
+//order listed:
+//
+//<PoseFilter>
+//	<OutlierRejection maxDistance="50" maxAngle="30" maxRejections="3"/>
+//	<HoldPose maxHoldTime="0.5" halfLife="0.15" riseTime="0.1" minConfidence="0.1"/>
+//	<OneEuro minCutoff="1.0" beta="0.007" derivativeCutoff="1.0" angularScale="100"/>
+//	<Exponential positionTimeConstant="0.05" rotationTimeConstant="0.05"/>
+//	<Slerp timeConstant="0.05"/>
+//</PoseFilter>
+//
+extern HOGBOXVIS_EXPORT PoseFilter* ReadPoseFilterFromXml(osgDB::XmlNode* filterNode);
+extern HOGBOXVIS_EXPORT PoseFilter* ReadPoseFilterFromXmlFile(const std::string& fileName);
+
+//
+//Pose recordings, one sample per line as
+//time detected confidence tx ty tz qx qy qz qw
+//lines starting with # are comments. Written by TrackedObject::StartRecording
+//
+extern HOGBOXVIS_EXPORT void WritePoseSample(std::ostream& out, const TrackedPoseSample& sample);
+extern HOGBOXVIS_EXPORT bool ReadPoseRecording(const std::string& fileName, std::vector<TrackedPoseSample>& samples);
+
+};
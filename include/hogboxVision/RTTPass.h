@@ -78,7 +78,9 @@ public:
 			startChannel(0),
 			rttScene(NULL),
             shaderFileIsSource(false),
-            depthRender(false)
+            depthRender(false),
+			outputInternalFormat(GL_RGBA),
+			samples(0)
 		{}
         
         osg::Vec4 clearColor;
@@ -109,6 +111,14 @@ public:
         
         //should we render a depth texture for output 0
         bool depthRender;
+
+		//textures to render into instead of allocating new ones, i.e. shared
+		//between passes by an RTTPassGraph. Used if it holds requiredOutCount textures
+		std::vector<TextureRef> outputTextures;
+
+		//format and multisample count of output textures taken from the RenderTargetPool
+		GLint outputInternalFormat;
+		unsigned int samples;
 	};
 
 	//
@@ -165,7 +175,7 @@ protected:
 	
 	//
 	//create/allocate the number of required textures for 
-	//the ouput textures
+	//the ouput textures, taken from the RenderTargetPool
 	void createOutputTextures();
 	
 	//
@@ -191,7 +201,8 @@ protected:
 	//scenegraph nodes to setup our fullscreen prerender pass
     osg::ref_ptr<osg::Group> _rootGroup;
     osg::ref_ptr<osg::Camera> _camera;
-	osg::ref_ptr<Ortho2DLayer> _videoQuad;
+	//holds the pools shared full screen quad and the pass state
+	osg::ref_ptr<osg::Geode> _videoQuad;
     
     //if its a model render flag this to render a depth texture
     bool _depthRender;
@@ -211,6 +222,8 @@ protected:
 	//the output dimensions
     int _outputWidth;
     int _outputHeight;
+	GLint _outputInternalFormat;
+	unsigned int _samples;
 
 	//gl state and shaders
     osg::ref_ptr<osg::Program> _shaderProgram;
@@ -0,0 +1,276 @@
+/* Written by Thomas Hogarth, (C) 2011
+ *
+ * This library is open source and may be redistributed and/or modified under
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+ */
+
+#pragma once
+
+#include <hogboxVision/Export.h>
+#include <hogboxVision/RTTPass.h>
+
+#include <osg/observer_ptr>
+#include <OpenThreads/Mutex>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace osgDB {
+class XmlNode;
+}
+
+namespace hogboxVision {
+
+//
+//RTTPassStats
+//Timing and skip counts for one pass of an RTTPassGraph
+//
+struct RTTPassStats
+{
+	RTTPassStats()
+		: _lastMs(0.0),
+		_averageMs(0.0),
+		_renderedFrames(0),
+		_skippedFrames(0)
+	{
+	}
+
+	//draw time of the last rendered frame and a running average
+	double _lastMs;
+	double _averageMs;
+
+	unsigned int _renderedFrames;
+	unsigned int _skippedFrames;
+};
+
+//
+//RTTPassGraph
+//
+//Declares a chain of full screen RTTPasses by name instead of wiring them up by
+//hand with setInputTexture. Each pass reads textures from other passes outputs
+//or from named external inputs (i.e. a video stream texture). Compile sorts the
+//passes so every pass renders after the passes it reads, then allocates the
+//output textures, reusing a texture for several outputs when their lifetimes in
+//the frame don't overlap. Each frame passes whose inputs, uniforms and output
+//textures haven't changed are skipped.
+//
+//A graph can be loaded from xml:
+//
+//<RTTPassGraph>
+//	<Pass name="gray" width="640" height="480" outputs="1">
+//		<FragmentShader>Shaders/gray.frag</FragmentShader>
+//		<Input sampler="inputTexture" source="video"/>
+//		<Uniform name="gain" type="float">1.5</Uniform>
+//	</Pass>
+//	<Pass name="edges" width="640" height="480">
+//		<FragmentShader>Shaders/sobel.frag</FragmentShader>
+//		<Input sampler="inputTexture" source="gray" output="0"/>
+//	</Pass>
+//	<Output name="result" source="edges" output="0"/>
+//</RTTPassGraph>
+//
+class HOGBOXVIS_EXPORT RTTPassGraph : public osg::Object
+{
+public:
+
+	//
+	//A pass texture input, source is another pass or an external input
+	struct PassInput
+	{
+		PassInput()
+			: _output(0)
+		{
+		}
+		PassInput(const std::string& sampler, const std::string& source, int output=0)
+			: _sampler(sampler),
+			_source(source),
+			_output(output)
+		{
+		}
+
+		std::string _sampler;
+		std::string _source;
+		//output index when source is a pass
+		int _output;
+	};
+
+	//
+	//Declaration of a pass
+	struct PassDesc
+	{
+		PassDesc()
+			: _width(256),
+			_height(256),
+			_outputCount(1),
+			_clearColor(osg::Vec4(0.0f,0.0f,0.0f,0.0f)),
+			_shaderFileIsSource(false),
+			_alwaysRender(false)
+		{
+		}
+
+		std::string _name;
+		int _width;
+		int _height;
+		int _outputCount;
+		osg::Vec4 _clearColor;
+
+		std::string _fragmentShader;
+		std::string _vertexShader;
+		bool _shaderFileIsSource;
+
+		std::vector<PassInput> _inputs;
+		std::vector<osg::ref_ptr<osg::Uniform> > _uniforms;
+
+		//never skip the pass, i.e. the shader uses time
+		bool _alwaysRender;
+	};
+
+	RTTPassGraph();
+
+	/** Copy constructor using CopyOp to manage deep vs shallow copy.*/
+	RTTPassGraph(const RTTPassGraph& graph,const osg::CopyOp& copyop=osg::CopyOp::SHALLOW_COPY);
+
+	META_Object(hogboxVision, RTTPassGraph);
+
+	//
+	//Declare a pass, returns false if the name is taken
+	bool AddPass(const PassDesc& pass);
+
+	//
+	//Name a pass output as an output of the graph, graph outputs are never
+	//reused for other passes
+	bool AddGraphOutput(const std::string& name, const std::string& pass, int output=0);
+
+	//
+	//Set the texture read by inputs with source name. Can be changed after compiling
+	void SetExternalInput(const std::string& name, RTTPass::TextureType* texture);
+
+	//
+	//Read the passes, outputs and settings from an <RTTPassGraph> node or xml file
+	bool ReadFromXml(osgDB::XmlNode* graphNode);
+	bool ReadFromXmlFile(const std::string& fileName);
+
+	//
+	//Share textures between outputs whose lifetimes don't overlap, on by default.
+	//Must be set before Compile
+	void SetTextureAliasing(bool alias){_aliasTextures = alias;}
+	bool GetTextureAliasing()const{return _aliasTextures;}
+
+	//
+	//Skip passes whose inputs haven't changed since they last rendered, on by default
+	void SetSkipUnchangedPasses(bool skip){_skipUnchanged = skip;}
+	bool GetSkipUnchangedPasses()const{return _skipUnchanged;}
+
+	//
+	//Force pass to render next frame, i.e. after changing its state by hand
+	void MarkPassDirty(const std::string& pass);
+
+	//
+	//Order the passes, allocate the textures and build the scene graph. Returns
+	//false for unknown sources, cycles or passes without inputs, in which case
+	//the graph is left empty
+	bool Compile();
+	bool IsCompiled()const{return _compiled;}
+
+	//
+	//Root holding the pass cameras in execution order, add it to the scene
+	osg::Group* GetRoot(){return _root.get();}
+
+	RTTPass* GetPass(const std::string& name);
+	RTTPass::TextureType* GetOutputTexture(const std::string& name);
+	const std::vector<std::string>& GetExecutionOrder()const{return _executionOrder;}
+
+	//
+	//Number of pass outputs and the number of textures actually allocated for them
+	unsigned int GetNumPassOutputs()const;
+	unsigned int GetNumAllocatedTextures()const{return _allocatedTextures.size();}
+
+	//
+	//Timing of each pass is measured on the draw thread around the pass camera.
+	//CPU_TIMING measures the cpu cost of issuing the pass, GPU_FINISH_TIMING
+	//calls glFinish either side of the pass to include the gpu time, which stalls
+	//the pipeline so is for profiling only
+	enum TimingMode{
+		NO_TIMING,
+		CPU_TIMING,
+		GPU_FINISH_TIMING
+	};
+	void SetTimingMode(const TimingMode& mode);
+	const TimingMode& GetTimingMode()const{return _timingMode;}
+
+	RTTPassStats GetPassStats(const std::string& pass);
+
+	//
+	//Decide which passes render this frame, called by an update callback on the root
+	void Update();
+
+protected:
+
+	virtual ~RTTPassGraph();
+
+	//
+	//Sort the passes into _executionOrder, false if there is a cycle
+	bool SortPasses();
+
+	//
+	//Assign a texture to every pass output
+	void AllocateTextures();
+
+	//
+	//Remove everything Compile built, handing the textures back to the pool
+	void ClearCompiled();
+
+	//pass index by name, -1 if none
+	int FindPass(const std::string& name)const;
+
+	//timing callbacks record into the pass stats
+	class PassTimingCallback;
+	friend class PassTimingCallback;
+	void RecordPassTime(unsigned int pass, double ms);
+
+protected:
+
+	std::vector<PassDesc> _passDescs;
+	std::map<std::string, RTTPass::TextureRef> _externalInputs;
+
+	//graph output name to pass index and output
+	std::map<std::string, std::pair<int, int> > _graphOutputs;
+
+	bool _aliasTextures;
+	bool _skipUnchanged;
+	bool _compiled;
+
+	//built by Compile, indexed like _passDescs
+	std::vector<RTTPassPtr> _passes;
+	std::vector<std::string> _executionOrder;
+	std::vector<unsigned int> _orderIndices;
+	//texture per pass output
+	std::vector<std::vector<RTTPass::TextureRef> > _passOutputs;
+	std::vector<RTTPass::TextureRef> _allocatedTextures;
+
+	osg::ref_ptr<osg::Group> _root;
+
+	//per frame change tracking
+	std::vector<bool> _dirty;
+	std::vector<bool> _renderedThisFrame;
+	std::vector<std::vector<unsigned int> > _uniformCounts;
+	std::map<std::string, unsigned int> _externalImageCounts;
+	//pass that last wrote each allocated texture
+	std::map<RTTPass::TextureType*, int> _lastWriter;
+
+	TimingMode _timingMode;
+	OpenThreads::Mutex _statsMutex;
+	std::vector<RTTPassStats> _stats;
+};
+
+typedef osg::ref_ptr<RTTPassGraph> RTTPassGraphPtr;
+
+};
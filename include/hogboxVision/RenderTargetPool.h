@@ -0,0 +1,155 @@
+/* Written by Thomas Hogarth, (C) 2011
+ *
+ * This library is open source and may be redistributed and/or modified under
+ * the terms of the OpenSceneGraph Public License (OSGPL) version 0.0 or
+ * (at your option) any later version.  The full license is in LICENSE file
+ * included with this distribution, and on the openscenegraph.org website.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * OpenSceneGraph Public License for more details.
+ */
+
+#pragma once
+
+#include <hogboxVision/Export.h>
+
+#include <osg/Referenced>
+#include <osg/ref_ptr>
+#include <osg/Geometry>
+#include <osg/Texture2D>
+#include <OpenThreads/Mutex>
+
+#include <map>
+#include <vector>
+#include <string>
+
+namespace hogboxVision {
+
+//
+//RenderTargetPoolStats
+//Usage of the pooled render targets
+//
+struct RenderTargetPoolStats
+{
+	RenderTargetPoolStats()
+		: _numTargets(0),
+		_numInUse(0),
+		_highWaterMark(0),
+		_numCreated(0),
+		_numReused(0),
+		_bytesAllocated(0),
+		_bytesHighWaterMark(0)
+	{
+	}
+
+	//targets owned by the pool and how many of them are held by someone
+	unsigned int _numTargets;
+	unsigned int _numInUse;
+	//most targets in use at once
+	unsigned int _highWaterMark;
+
+	//acquires that needed a new texture or reused a free one
+	unsigned int _numCreated;
+	unsigned int _numReused;
+
+	//estimated gpu memory of all targets (including msaa buffers)
+	unsigned long long _bytesAllocated;
+	unsigned long long _bytesHighWaterMark;
+};
+
+//
+//RenderTargetPool
+//
+//Hands out render target textures keyed by size, internal format and sample
+//count so passes being recreated (resolution changes, effects toggled) reuse
+//textures rather than allocating new ones. Only the textures are pooled, each
+//pass still creates its own fbo (camera) to attach them to. A target
+//is in use while anything other than the pool references it, so there is no
+//explicit release, dropping the last ref_ptr (i.e. deleting the RTTPass)
+//returns it to the pool. Also owns the full screen quad drawn by every RTTPass.
+//Meant to be used from the update thread
+//
+class HOGBOXVIS_EXPORT RenderTargetPool : public osg::Referenced
+{
+public:
+
+	typedef osg::Texture2D TextureType;
+	typedef osg::ref_ptr<TextureType> TextureRef;
+
+	static RenderTargetPool* Inst(bool erase = false);
+
+	RenderTargetPool();
+
+	//
+	//Get a free target matching the key or create one. Reused targets have
+	//their filtering reset to nearest. Targets are counted by the MemoryTracker
+	//against owner, or the pool when there's none. The target stays in use for
+	//as long as the returned ref_ptr, or a copy of it, is held
+	TextureRef Acquire(int width, int height, GLint internalFormat = GL_RGBA, unsigned int samples = 0,
+						const std::string& owner = "");
+
+	//
+	//Delete free targets, keeping up to maxFreePerKey of each key around.
+	//Returns the number deleted
+	unsigned int TrimFree(unsigned int maxFreePerKey = 0);
+
+	//
+	//Stats are recounted on each call
+	RenderTargetPoolStats GetStats();
+	void ResetHighWaterMarks();
+
+	//
+	//Unit quad (0,0)-(1,1) with matching texcoords shared by full screen passes,
+	//holds no state so each pass puts its own state on a parent geode
+	osg::Geometry* GetFullScreenQuad();
+
+protected:
+
+	virtual ~RenderTargetPool(void);
+
+	struct Key
+	{
+		Key(int width, int height, GLint internalFormat, unsigned int samples)
+			: _width(width),
+			_height(height),
+			_internalFormat(internalFormat),
+			_samples(samples)
+		{
+		}
+
+		bool operator < (const Key& rhs)const{
+			if(_width != rhs._width){return _width < rhs._width;}
+			if(_height != rhs._height){return _height < rhs._height;}
+			if(_internalFormat != rhs._internalFormat){return _internalFormat < rhs._internalFormat;}
+			return _samples < rhs._samples;
+		}
+
+		int _width;
+		int _height;
+		GLint _internalFormat;
+		unsigned int _samples;
+	};
+
+	//estimated bytes of a target with key
+	static unsigned long long GetTargetBytes(const Key& key);
+
+	//count the targets in use and update the high water marks, call with the mutex held
+	void UpdateUsage();
+
+protected:
+
+	OpenThreads::Mutex _mutex;
+
+	typedef std::map<Key, std::vector<TextureRef> > TargetMap;
+	TargetMap _targets;
+
+	RenderTargetPoolStats _stats;
+
+	osg::ref_ptr<osg::Geometry> _quad;
+};
+
+typedef osg::ref_ptr<RenderTargetPool> RenderTargetPoolPtr;
+
+};
@@ -19,13 +19,52 @@
 
 #include <string>
 #include <osg/Matrix>
+#include <osg/Quat>
+#include <OpenThreads/Mutex>
+
+#include <iosfwd>
 
 namespace hogboxVision {
 
 class HogTracker;
+class PoseFilter;
 class CARTKTracker;
 class COpenCVPlanarPoseTracker;
 
+//
+//TrackedPoseSample
+//A pose published by a tracker, with the motion estimated from the previous
+//sample so it can be extrapolated forward to when it's displayed
+//
+struct TrackedPoseSample
+{
+	TrackedPoseSample()
+		: _isDetected(false),
+		_confidence(0.0f),
+		_time(0.0),
+		_angularRate(0.0),
+		_hasMotion(false)
+	{
+	}
+
+	osg::Matrix _pose;
+	bool _isDetected;
+	float _confidence;
+
+	//time the frame the pose came from was captured, osg::Timer time_s
+	double _time;
+
+	//pose split into rotation and position
+	osg::Vec3d _position;
+	osg::Quat _rotation;
+
+	//motion per second, angular as an axis and rate in radians
+	osg::Vec3d _velocity;
+	osg::Vec3d _angularAxis;
+	double _angularRate;
+	bool _hasMotion;
+};
+
 //
 //Base class for any object tracked by a tracker
 //All tracked objects store 6 dof info, but have
@@ -46,6 +85,17 @@ public:
 		TRACKING_BOTH
 	};
 
+	//
+	//How GetPredictedTransform extrapolates the last pose
+	enum PredictionModel{
+		//use the last pose as is
+		NO_PREDICTION,
+		//carry on at the velocity between the last two poses
+		CONSTANT_VELOCITY,
+		//constant velocity kalman filter on the position, rotation as CONSTANT_VELOCITY
+		KALMAN
+	};
+
 	TrackedObject(TrackedDimensions dimensions = TRACKING_BOTH);
 
 	/** Copy constructor using CopyOp to manage deep vs shallow copy.*/
@@ -61,20 +111,63 @@ public:
 	TrackedDimensions GetTrackedDimensions(){return _trackingDimensions;}
 
 	//get pose
-	osg::Matrix GetTransform(){return _poseMatrix;}
+	osg::Matrix GetTransform();
+
+	//
+	//The last published pose and its motion, safe to call while a tracker
+	//thread is publishing
+	TrackedPoseSample GetPoseSample();
+
+	//
+	//Pose extrapolated to displayTime (osg::Timer time_s) using the prediction
+	//model. The no argument version predicts for now plus the prediction lead
+	osg::Matrix GetPredictedTransform(double displayTime);
+	osg::Matrix GetPredictedTransform();
+
+	void SetPredictionModel(const PredictionModel& model);
+	const PredictionModel& GetPredictionModel()const{return _predictionModel;}
+
+	//
+	//Expected time in seconds from now until a frame is displayed
+	void SetPredictionLead(const double& lead){_predictionLead = lead;}
+	const double& GetPredictionLead()const{return _predictionLead;}
+
+	//
+	//Don't extrapolate more than this many seconds past the last pose, default 0.1
+	void SetMaxPredictionTime(const double& maxTime){_maxPredictionTime = maxTime;}
+	const double& GetMaxPredictionTime()const{return _maxPredictionTime;}
+
+	//
+	//Kalman acceleration noise (units^2/s^3) and measurement noise (units^2)
+	void SetKalmanNoise(const double& processNoise, const double& measurementNoise);
+
+	//
+	//Filter applied to each pose before it's published (see PoseFilter.h),
+	//the object keeps the filter so it shouldn't be shared between objects.
+	//NULL to publish the poses as tracked
+	void SetPoseFilter(PoseFilter* filter);
+	PoseFilter* GetPoseFilter();
+
+	//
+	//Write the unfiltered poses from the tracker to fileName as they arrive,
+	//for replaying through filters with ReadPoseRecording
+	bool StartRecording(const std::string& fileName);
+	void StopRecording();
+	bool IsRecording();
 	
 	//our we tracking this object
 	void SetEnabled(const bool& enabled);
 	const bool& GetEnabled()const;
 
 	//is the object currently visible/being tracked
-	bool IsObjectDetected(){return _isDetected;}
+	bool IsObjectDetected();
 	
-	float GetConfidence(){return _confidence;}
+	float GetConfidence();
 	
 	//base update, called by a tracker
 	//isDetected, indicates if the object was detected by the tracker calling update
 	//pose, the pose matrix returned by the tracker if any
+	//the pose is published stamped with the sample time set by the tracker
 	virtual bool UpdateMarker(bool isDetected, osg::Matrix pose);
 
 protected:
@@ -86,6 +179,26 @@ protected:
 	//the dimensions being tracked
 	TrackedDimensions _trackingDimensions;
 
+	//
+	//Called by HogTracker around UpdateTracking. Between the two UpdateMarker
+	//only stores the measurement, End then filters and publishes it, or a
+	//missed detection if the tracker didn't report the object
+	void BeginTrackerUpdate(double time);
+	void EndTrackerUpdate();
+
+	//
+	//Run sample through the pose filter and publish it
+	void ProcessSample(TrackedPoseSample& sample);
+
+	//
+	//Estimate the motion of sample from the last one and publish it
+	void PublishSample(TrackedPoseSample& sample);
+
+	//
+	//Advance the kalman filter to sample and replace its position and velocity
+	//with the filtered ones
+	void FilterSample(TrackedPoseSample& sample);
+
 	//the 4x4 pose matrix for the marker, relative
 	//to the trackers camera
 	osg::Matrix _poseMatrix;
@@ -99,6 +212,43 @@ protected:
 	//the confidence of the tracked object i.e. are we getting a good signal/match, 0-1 1 being total confidence
 	float _confidence;
 
+	//capture time of the frame being tracked, set by the tracker before
+	//UpdateTracking, negative for now
+	double _sampleTime;
+
+	//measurement stored by UpdateMarker during a tracker update
+	bool _inTrackerUpdate;
+	bool _hasMeasurement;
+	TrackedPoseSample _measurement;
+
+	//set under the pose mutex, used by the tracker
+	osg::ref_ptr<PoseFilter> _poseFilter;
+
+	//unfiltered pose recording
+	std::ofstream* p_recordStream;
+	OpenThreads::Mutex _recordMutex;
+
+	//published poses, the tracker writes the back sample then swaps under the mutex
+	TrackedPoseSample _poseSamples[2];
+	int _frontSample;
+	OpenThreads::Mutex _poseMutex;
+
+	//last detected sample, written by the tracker only
+	TrackedPoseSample _lastDetected;
+
+	PredictionModel _predictionModel;
+	double _predictionLead;
+	double _maxPredictionTime;
+
+	//kalman state per axis, position/velocity and their covariance (p00, p01, p11)
+	bool _kalmanValid;
+	//set by the setters, the tracker restarts the filter on its next sample
+	bool _kalmanReset;
+	double _kalmanState[3][2];
+	double _kalmanCovariance[3][3];
+	double _processNoise;
+	double _measurementNoise;
+
 };
 
 typedef osg::ref_ptr<TrackedObject> TrackedObjectPtr;
@@ -15,20 +15,80 @@
 
 #include "VideoStream.h"
 
+#include <hogbox/PresentationClock.h>
+
+#include <vector>
+
 namespace hogboxVision {
 
+class VideoFileStream;
+
+//
+//VideoSyncStats
+//How closely a stream is presenting the frames its sync clock says are due.
+//Drift is the presented frame minus the due frame in seconds, so it's negative
+//when the stream is behind and a multiple of the frame period
+//
+struct VideoSyncStats
+{
+	VideoSyncStats(){Reset();}
+
+	void Reset(){
+		_drift = 0.0;
+		_meanAbsDrift = 0.0;
+		_maxAbsDrift = 0.0;
+		_presentedFrames = 0;
+		_droppedFrames = 0;
+		_repeatedFrames = 0;
+		_samples = 0;
+	}
+
+	//drift at the last update
+	double _drift;
+	double _meanAbsDrift;
+	double _maxAbsDrift;
+
+	//new frames shown
+	unsigned int _presentedFrames;
+	//frames skipped to catch up with the clock
+	unsigned int _droppedFrames;
+	//updates where a new frame was due but the last one stayed up
+	unsigned int _repeatedFrames;
+	//updates recorded
+	unsigned int _samples;
+};
+
+//
+//VideoFileSyncClock
+//The presentation clock streams play against. Streams sharing a clock derive
+//their frames from the same time, so they drop or repeat frames to stay with
+//the clock rather than drifting with their own timing. Drive the clock from a
+//HogBoxViewer to have every stream sample the same time in a frame.
+//Backends with their own clock interface (i.e. DShow IReferenceClock) can
+//subclass it to wrap theirs
 //
-//Temp wrapper,
-//We will need a way of passing around whatever interface allows us
-//to sync videos properly. DShow has the IReferenceClock interface
-//not sure what others will have so we will use this class to wrap them
-//for passing around without worrying about implementation specifics
-class VideoFileSyncClock : public osg::Referenced
+class HOGBOXVIS_EXPORT VideoFileSyncClock : public hogbox::PresentationClock
 {
 public:
-	VideoFileSyncClock(){}
+	VideoFileSyncClock();
+
+	//
+	//Streams presenting to the clock, maintained by VideoFileStream::SetSyncClock
+	void AttachStream(VideoFileStream* stream);
+	void DetachStream(VideoFileStream* stream);
+	unsigned int GetNumStreams()const{return _streams.size();}
+	VideoFileStream* GetStream(const unsigned int& index){return _streams[index];}
+
+	//
+	//Largest difference in drift between the attached streams in seconds, i.e.
+	//how far apart the streams are presenting
+	double GetMaxStreamSpread()const;
+
 protected:
-	virtual ~VideoFileSyncClock(){}
+	virtual ~VideoFileSyncClock();
+
+	//not ref counted, streams detach themselves on destruction
+	std::vector<VideoFileStream*> _streams;
 };
 
 //
@@ -38,7 +98,9 @@ class HOGBOXVIS_EXPORT VideoFileStream : public VideoStream
 public:
 	VideoFileStream() : VideoStream(),
 						_syncClock(NULL), 
-						_isSynced(false)
+						_isSynced(false),
+						_lastDueFrame(0),
+						_lastPresentedFrame(0)
 	{
 	}
 	
@@ -46,8 +108,11 @@ public:
 	VideoFileStream(const VideoFileStream& image,const osg::CopyOp& copyop=osg::CopyOp::SHALLOW_COPY)
 		: VideoStream(image, copyop),
 		_syncClock(image._syncClock),
-		_isSynced(image._isSynced)
+		_isSynced(image._isSynced),
+		_lastDueFrame(0),
+		_lastPresentedFrame(0)
 	{
+		if(_syncClock.valid()){_syncClock->AttachStream(this);}
 	}
 
 	META_Stream(hogboxVision, VideoFileStream);
@@ -65,28 +130,47 @@ public:
 	//Get sync clock, if it hasn't got a sync clock then one is allocated
 	//via CreateSyncClockImplementation
 	VideoFileSyncClock* GetSyncClock(){
-		if(!_syncClock){CreateSyncClockImplementation();}
+		if(!_syncClock){
+			CreateSyncClockImplementation();
+			if(_syncClock.valid()){_syncClock->AttachStream(this);}
+		}
 		return _syncClock;
 	}
 
 	//Set our clock pointer then call SetSyncClockImplementation
 	//to do implementation specific syncing stuff
 	void SetSyncClock(VideoFileSyncClock* clock){
+		if(_syncClock.valid()){_syncClock->DetachStream(this);}
 		_syncClock = clock;
+		if(_syncClock.valid()){_syncClock->AttachStream(this);}
+		_syncStats.Reset();
 		SetSyncClockImplementation(_syncClock);
 	}
 
+	//
+	//How closely the stream is following its sync clock
+	const VideoSyncStats& GetSyncStats()const{return _syncStats;}
+	void ResetSyncStats(){_syncStats.Reset();}
+
 protected:
 
 	virtual ~VideoFileStream(void){
+		if(_syncClock.valid()){_syncClock->DetachStream(this);}
 		_syncClock=NULL;
 	}
 
 	//Should be pure virtual but inheriting from osg::Object require cloneType
-	//which cause can't init abstract bullshit
-	virtual void CreateSyncClockImplementation(){}
+	//which cause can't init abstract bullshit. By default a plain
+	//VideoFileSyncClock is allocated
+	virtual void CreateSyncClockImplementation(){_syncClock = new VideoFileSyncClock();}
 	virtual void SetSyncClockImplementation(VideoFileSyncClock* clock){}
 
+	//
+	//Backends call this each update with the frame number (counted from the start
+	//of the file, continuing across loops) the clock says is due and the one being
+	//presented, to maintain the sync stats
+	void RecordSyncFrame(const unsigned int& dueFrame, const unsigned int& presentedFrame);
+
 protected:
 
 	//The syncing clock being used
@@ -94,6 +178,11 @@ protected:
 
 	//syncing 
 	bool _isSynced;
+
+	VideoSyncStats _syncStats;
+	//last frames passed to RecordSyncFrame
+	unsigned int _lastDueFrame;
+	unsigned int _lastPresentedFrame;
 };
 
 typedef osg::ref_ptr<VideoFileStream> VideoFileStreamPtr;
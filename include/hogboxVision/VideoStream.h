@@ -14,9 +14,11 @@
 #pragma once
 
 #include <hogboxVision/Export.h>
+#include <hogboxVision/ImageKernels.h>
 
 #include <osg/ImageStream>
 #include <osg/notify>
+#include <OpenThreads/Mutex>
 
 
 namespace hogboxVision {
@@ -106,6 +108,19 @@ public:
 	virtual void SetDeinterlace(bool deInter){_isInter=deInter;}
 	bool GetDeinterlace(){return _isInter;}
 
+	//
+	//How ApplyFrameModes removes the interlacing
+	void SetDeinterlaceMode(const ImageKernels::DeinterlaceMode& mode){_deinterMode = mode;}
+	const ImageKernels::DeinterlaceMode& GetDeinterlaceMode()const{return _deinterMode;}
+
+	//
+	//When the frame currently in the image was captured, on the osg::Timer clock
+	//(osg::Timer::instance()->time_s()). Backends call SetFrameCaptureTime as they
+	//write each new frame, from whichever thread delivers it. Negative if the
+	//backend doesn't record one
+	double GetFrameCaptureTime();
+	void SetFrameCaptureTime(double time);
+
 	//
 	//Hack for callback when the video reaches its end (yuck)
 	virtual bool HasVideoEnded(){ 
@@ -141,6 +156,13 @@ protected:
 	//child class to implement
 	virtual void QuitImplementation(){}
 
+	//
+	//Apply the horizontal flip and deinterlacing requested for the stream to the
+	//current frame in place using the shared ImageKernels. Backends writing frames
+	//into the image should call this after each new frame. The vertical flip is
+	//free as it only changes the image origin (see CreateStream)
+	void ApplyFrameModes();
+
 
 protected:
 
@@ -158,6 +180,12 @@ protected:
 	bool _vFlip;
 	//flip the stream horizontally
 	bool _hFlip;
+	//how to deinterlace when _isInter is set
+	ImageKernels::DeinterlaceMode _deinterMode;
+
+	//capture time of the current frame, -1 until a backend sets one
+	double _frameCaptureTime;
+	OpenThreads::Mutex _frameCaptureTimeMutex;
 
 };
 
@@ -18,6 +18,10 @@
 
 #include <osgDB/DynamicLibrary>
 #include <osgDB/Registry>
+#include <OpenThreads/ReadWriteMutex>
+#include <OpenThreads/ReentrantMutex>
+
+#include <set>
 
 #include <hogboxVision/VisionRegistryWrappers.h>
 
@@ -37,6 +41,13 @@ namespace hogboxVision {
 //Used to register implementations of VideoFileStream, WebCamStream, HogBoxTracker and 
 //various tracked object types
 //
+//Plugins are loaded on first use. A requested plugin name is resolved through the
+//class type aliases (which an optional manifest can fill, see LoadPluginManifest) to
+//the library that registers it, and only that library is loaded. The plugins folder
+//is only scanned when a default plugin is needed and none is registered or named.
+//Prototype lookups take a shared read lock so streams can be allocated and created
+//from several threads at once, only loading a library takes the plugin mutex
+//
 class HOGBOXVIS_EXPORT VisionRegistry : public osg::Referenced //, public hogbox::Singleton<VisionRegistry>
 {
 public:
@@ -61,6 +72,8 @@ public:
     
 	typedef std::vector< osg::ref_ptr<osgDB::DynamicLibrary> >		DynamicLibraryList;
 	typedef std::map< std::string, std::string>						ClassTypeAliasMap;
+	typedef std::map< std::string, VideoFileStreamWrapperPtr>		VideoFileStreamWrapperMap;
+	typedef std::map< std::string, WebCamStreamWrapperPtr>			WebCamStreamWrapperMap;
 
 	//videofiles
 	
@@ -93,17 +106,47 @@ public:
 
 
 	//
+	//Map a plugin name (case insensitive) to the base name of the library that
+	//registers it, i.e. AddClassTypeAlias("avi", "ffmpeg") loads hogboxvision_video_ffmpeg
+	//when plugin "avi" is asked for
 	void AddClassTypeAlias(const std::string mapClassType, const std::string toLibraryName);
 
+	//
+	//Plugin name to library base name after any aliases. Aliases are matched case
+	//insensitively, the result keeps the case it was given or aliased to so it
+	//can be used to build the library file name
+	std::string ResolvePluginName(const std::string& plugin);
+
+	//
+	//Plugins used when no name is given, before falling back to scanning the
+	//plugins folder
+	void SetDefaultVideoFileStreamPlugin(const std::string& plugin);
+	void SetDefaultWebCamStreamPlugin(const std::string& plugin);
+
+	//
+	//Read aliases and defaults from an xml manifest, so a show can name the plugins
+	//it uses without any being loaded until they're needed
+	//
+	//<VisionPlugins>
+	//	<Alias name="avi" library="ffmpeg"/>
+	//	<DefaultVideoFileStream name="ffmpeg"/>
+	//	<DefaultWebCamStream name="dshow"/>
+	//</VisionPlugins>
+	//
+	//visionplugins.xml in the plugins folder is read, if found, before the first
+	//plugin is resolved
+	bool LoadPluginManifest(const std::string& fileName);
+
 	//
 	//Loads a specific video plugin, unless no plugin name is given,
-	//in which case the first plugin found is loaded
-	//return 0 on success -1 on fail
+	//in which case the default or first plugin found is loaded.
+	//Returns true if the plugin is now available
 	int LoadVideoFileStreamPlugin(const std::string plugin="");
 
 	//
 	//return the path of the index file in the visPlugins folder
-	//that matches the video plugin library naming convention
+	//that matches the video plugin library naming convention.
+	//The folder is scanned once, on the first call
 	const std::string FindVideoFileLibraryName(int index);
 
 	//
@@ -113,8 +156,8 @@ public:
 	
 	//
 	//Loads a specific webcam plugin, unless no plugin name is given,
-	//in which case the first plugin found is loaded
-	//return 0 on success -1 on fail
+	//in which case the default or first plugin found is loaded.
+	//Returns true if the plugin is now available
 	int LoadWebCamStreamPlugin(const std::string plugin="");
 
 	//
@@ -128,7 +171,8 @@ public:
 	WebCamStreamWrapperPtr GetWebCamStreamPluginProto(const std::string& plugin);
 
 	//
-	//Load a library, which should register an plugin of some sort
+	//Load a library, which should register an plugin of some sort. Libraries
+	//that fail to load aren't tried again
 	osgDB::Registry::LoadStatus LoadLibrary(const std::string& fileName);
 
 	DynamicLibraryList::iterator GetLibraryItr(const std::string& fileName);
@@ -138,6 +182,24 @@ protected:
 	VisionRegistry(void);
 	virtual ~VisionRegistry(void);
 
+	//
+	//Load the library for a plugin name, or with an empty name the first in the
+	//folder. prepend is the library naming convention
+	bool LoadStreamPlugin(const std::string& plugin, const std::string& prepend,
+						const std::vector<std::string>& folderLibraries, const char* typeName);
+
+	//
+	//ResolvePluginName with _typesMutex already held
+	std::string ResolvePluginNameLocked(const std::string& plugin);
+
+	//
+	//Read the manifest from the plugins folder the first time a plugin is resolved
+	void LoadDefaultManifest();
+
+	//
+	//Fill the video and webcam library lists from the plugins folder
+	void ScanPluginsFolder();
+
 	//get the platform specific prepend for videoFileStream plugins i.e. 'hogboxVisionPlugins/hogboxVision_video_'
 	const std::string GetVideoFileStreamPluginPrepend();
 
@@ -147,28 +209,48 @@ protected:
 	const std::string GetPluginExtension();
 
 	virtual void destruct(){
+		OpenThreads::ScopedWriteLock lock(_typesMutex);
 		_videoFileStreamTypes.clear();
+		_videoFileStreamTypeMap.clear();
 	}
 
 protected:
 	
+	//guards the registered types, aliases and defaults, read locked for lookups
+	OpenThreads::ReadWriteMutex _typesMutex;
+
 	//Map class types to particular library names
 	ClassTypeAliasMap _classTypeAliasMap;
-
+	std::string _defaultVideoFileStreamPlugin;
+	std::string _defaultWebCamStreamPlugin;
+	bool _manifestLoaded;
 	
-	//List of registered videofilestream types
+	//List of registered videofilestream types, in the order registered
+	//and by lower case plugin name
 	std::vector<VideoFileStreamWrapperPtr> _videoFileStreamTypes;
+	VideoFileStreamWrapperMap _videoFileStreamTypeMap;
 
 	//List of registered webcamstream types
 	std::vector<WebCamStreamWrapperPtr> _webcamStreamTypes;
+	WebCamStreamWrapperMap _webcamStreamTypeMap;
 
 	//List of registered camerabased tracker types
 	std::vector<CameraBaseTrackerWrapperPtr> _cameraBaseTrackerTypes;
 
+	//guards loading libraries and the folder scan. Reentrant as a library's
+	//registration can resolve other plugins
+	OpenThreads::ReentrantMutex _pluginMutex;
 
 	//list of loaded libraries
 	DynamicLibraryList _dlList;
 
+	//libraries that failed to load
+	std::set<std::string> _failedLibraries;
+
+	//plugin libraries found in the folder, filled on first use
+	bool _pluginsFolderScanned;
+	std::vector<std::string> _videoFileLibraries;
+	std::vector<std::string> _webcamLibraries;
 };
 
 //
@@ -216,7 +298,6 @@ public:
 			//create the wrapper and add to the reg
 			proto->setName(name);
 			_wrapper = new WebCamStreamWrapper(std::string(name), proto);
-			OSG_FATAL << "Register webcam plugin" << std::endl;
 			VisionRegistry::Instance()->AddWebCamStreamTypeToRegistry(_wrapper);
 					
 		}
@@ -2,6 +2,8 @@
 
 #include <hogbox/SystemInfo.h>
 #include <hogbox/HogBoxUtils.h>
+#include <hogbox/MemoryTracker.h>
+#include <hogbox/Profiler.h>
 
 #ifdef TARGET_OS_IPHONE
 #import <Foundation/NSString.h>
@@ -114,12 +116,20 @@ bool AssetManager::OpenAndMountArchive(const std::string& fileName){
 //Call once per frame if using paging (getOrLoad with a callback)
 void AssetManager::Sync()
 {
+    HOGBOX_PROFILE_SCOPE("AssetManager::Sync");
+    HOGBOX_PROFILE_COUNTER("AssetManager paging operations", (double)_pagingOperations.size());
+
     std::vector<DatabasePagingOperationPtr>::iterator itr = _pagingOperations.begin();
     //for( ; itr!=_pagingOperations.end(); itr++){
     while(itr != _pagingOperations.end()){
         
         if((*itr)->Sync()){
              OSG_DEBUG_FP << "  Operation Complete" << std::endl;
+            //count the models memory now it's handed over
+            if((*itr)->ModelReady()){
+                MemoryTracker::Inst()->TrackNode((*itr)->GetLoadedModel(), (*itr)->GetFileName());
+            }
+            
             //it's done, does it require caching
             if((*itr)->CacheModel()){
                 
@@ -199,6 +209,8 @@ osg::NodePtr AssetManager::GetOrLoadNode(const std::string& fileName, ReadOption
         ApplyVBOVisitor vboVisitor;
         node->accept(vboVisitor);
         
+        MemoryTracker::Inst()->TrackNode(node.get(), fileName);
+        
         if(readOptions->cache){
             //apply the defaults visitor
             //ApplyIOSOptVisitor visitor;
@@ -264,6 +276,7 @@ osg::Tex2DPtr AssetManager::GetOrLoadTex2D(const std::string& fileName, ReadOpti
     }
     
     if(tex.get()){
+        MemoryTracker::Inst()->TrackTexture(tex.get(), fileName);
         _textureCache[fileName] = tex;
     }
     return tex;
@@ -292,6 +305,7 @@ osg::ImagePtr AssetManager::GetOrLoadImage(const std::string& fileName, ReadOpti
     }
     
     if(image.get()){
+        MemoryTracker::Inst()->TrackImage(image.get(), fileName);
         _imageCache[fileName] = image;
         OSG_INFO << "OsgModelCache::GetOrLoadImage: INFO: Loaded image file '" << deviceFileName << "'." << std::endl;
         
@@ -352,7 +366,7 @@ XmlInputObjectPtr AssetManager::GetOrLoadXmlObject(const std::string& fileName,
     }
     osg::ref_ptr<osg::Object> obj = NULL;
     if(_archive.valid()){
-        OSG_FATAL << "!!!Reading XmlFile from archive'" << fileName << "'." << std::endl;
+        OSG_INFO << "Reading XmlFile from archive'" << fileName << "'." << std::endl;
         osgDB::ReaderWriter::ReadResult result = _archive->readObject("/assets/"+fileName);
         obj = result.getObject();
     }else{
@@ -362,7 +376,7 @@ XmlInputObjectPtr AssetManager::GetOrLoadXmlObject(const std::string& fileName,
     if(obj.get()){
         XmlInputObjectPtr xmlObject = dynamic_cast<XmlInputObject*>(obj.get());
         if(xmlObject.get()){
-            OSG_FATAL << "ReadXml from archive '" << fileName << "'." << std::endl;
+            OSG_INFO << "ReadXml from archive '" << fileName << "'." << std::endl;
             //_xmlObjectCache[fileName] = xmlObject;//caching doesn't seem to work on xml input, think node read destroys it (maybe make xmlinputobject read it and cache an xml root node)
             return xmlObject;
         }
@@ -438,6 +452,42 @@ void AssetManager::ReleaseAssets()
     _programCache.clear();
 }
 
+//
+//erase the entries of cache only the cache references
+//
+template <class CacheMap>
+static unsigned int ReleaseUnusedCacheEntries(CacheMap& cache)
+{
+    unsigned int released = 0;
+    typename CacheMap::iterator itr = cache.begin();
+    while(itr != cache.end()){
+        if(!(*itr).second.valid() || (*itr).second->referenceCount() == 1){
+            cache.erase(itr++);
+            released++;
+        }else{
+            itr++;
+        }
+    }
+    return released;
+}
+
+//
+//release the cached objects nothing else is using, users before
+//what they use so a node releases its textures and a texture its image
+//
+unsigned int AssetManager::ReleaseUnusedAssets()
+{
+    unsigned int released = 0;
+    released += ReleaseUnusedCacheEntries(_fileCache);
+    released += ReleaseUnusedCacheEntries(_textureCache);
+    released += ReleaseUnusedCacheEntries(_imageCache);
+    released += ReleaseUnusedCacheEntries(_fontCache);
+    released += ReleaseUnusedCacheEntries(_programCache);
+    released += ReleaseUnusedCacheEntries(_shaderCache);
+    OSG_INFO << "AssetManager::ReleaseUnusedAssets: INFO: Released " << released << " unused assets." << std::endl;
+    return released;
+}
+
 //
 //return true is file exists, if archive is mounted
 //that is checked
@@ -5,6 +5,7 @@
 #include <osg/BlendEquation>
 #include <osg/BlendFunc>
 #include <hogbox/NPOTResizeCallback.h>
+#include <hogbox/MemoryTracker.h>
 
 using namespace hogbox;
 
@@ -368,6 +369,7 @@ void HogBoxMaterial::SetTexture(const int& channel, osg::Texture* tex)
 
 	//store texture
 	unit->texture = tex;
+	MemoryTracker::Inst()->TrackTexture(tex, "", this->getName());
 
 	//apply the texture to the materials stateset
 	_stateset->setTextureAttributeAndModes(channel, unit->texture, osg::StateAttribute::OVERRIDE | osg::StateAttribute::ON);
@@ -1,6 +1,8 @@
 #include <hogbox/HogBoxMesh.h>
 #include <hogbox/HogBoxHardwareRigTransform.h>
 
+#include <set>
+
 using namespace hogbox;
 
 
@@ -53,6 +55,43 @@ void MeshMappingVisitor::apply(osg::Node& node)
 	traverse(node);
 }
 
+//
+//Apply the mapping to the geodes in a prebuilt index, looking each
+//mapTo name up rather than comparing every node against the list
+//
+bool MeshMappingVisitor::ApplyToIndex(NodeNameIndex& index)
+{
+	std::vector<osg::Geode*> geodes;
+	for(unsigned int i=0; i<_mapToList.size(); i++)
+	{
+		//check for wildcard
+		std::string search = _mapToList[i];
+		bool subString = search.rfind(".*") == 0;
+		if(subString){search.erase(0, 2);}
+
+		std::vector<osg::Node*> nodes;
+		index.FindNodes(search, subString, nodes);
+		for(unsigned int n=0; n<nodes.size(); n++){
+			osg::Geode* geo = nodes[n]->asGeode();
+			if(geo){geodes.push_back(geo);}
+		}
+
+		if(_checkGeoms){
+			index.FindGeodesByDrawableName(search, subString, geodes);
+		}
+	}
+
+	//apply once per geode, in the order they were found
+	std::set<osg::Geode*> applied;
+	for(unsigned int i=0; i<geodes.size(); i++)
+	{
+		if(applied.insert(geodes[i]).second){
+			ApplyMappingParams(geodes[i]);
+		}
+	}
+	return !applied.empty();
+}
+
 	//
 	//check if the passed string matches any of our matTo names
 bool MeshMappingVisitor::compareWithMapToList( const std::string& name)
@@ -1,38 +1,38 @@
-
 #include <hogbox/HogBoxNotifyHandler.h>
-#include <sstream>
-#include <iomanip>
 
-using namespace hogbox;
+#include <OpenThreads/ScopedLock>
 
-HogBoxNotifyHandler::HogBoxNotifyHandler(const std::string& outputFileName)
-		: PlatformNotifyHandler()
-{
-	_outputFile.open(outputFileName.c_str());
-	if(_outputFile.is_open())
-	{
-		//create our html styles for each severity
-		HtmlStyle fatalStyle(osg::Vec3(0.9f,0.1f,0.1f));
-		_levelToHtmlStyleList[osg::FATAL] = fatalStyle;
+#include <sstream>
 
-		HtmlStyle warnStyle(osg::Vec3(0.1f,0.1f,0.9f));
-		_levelToHtmlStyleList[osg::WARN] = warnStyle;
+using namespace hogbox;
 
-		HtmlStyle noticeStyle(osg::Vec3(0.1f,0.9f,0.1f));
-		_levelToHtmlStyleList[osg::NOTICE] = noticeStyle;
+//how long the writer sleeps when there's nothing to write, in milliseconds
+static const unsigned long s_writerIntervalMs = 20;
 
-		HtmlStyle infoStyle(osg::Vec3(0.0f,0.0f,0.0f));
-		_levelToHtmlStyleList[osg::INFO] = infoStyle;
+HogBoxNotifyHandler::HogBoxNotifyHandler(const std::string& outputFileName, unsigned int bufferSize)
+		: PlatformNotifyHandler(),
+		_buffer(bufferSize),
+		_startTick(osg::Timer::instance()->tick()),
+		_rateLimit(50),
+		_numRateLimited(0),
+		_reportedDropped(0),
+		_reportedRateLimited(0),
+		_writerThread(NULL),
+		_flushRequested(false),
+		_done(false)
+{
+	LogSinkPtr fileSink = CreateFileLogSink(outputFileName);
+	if(fileSink.valid()){
+		_sinks.push_back(fileSink);
+	}
 
-		HtmlStyle debugStyle(osg::Vec3(0.3f,0.3f,0.3f));
-		_levelToHtmlStyleList[osg::DEBUG_INFO] = debugStyle;
+	//the standard output, always used
+	_sinks.push_back(new NotifyHandlerLogSink(new PlatformNotifyHandler()));
 
-		HtmlStyle debugFPStyle(osg::Vec3(0.6f,0.6f,0.6f));
-		_levelToHtmlStyleList[osg::DEBUG_FP] = debugFPStyle;
+	_writerThread = new WriterThread(this);
+	_writerThread->start();
 
-		//write our html header
-		_outputFile << "<html>" << std::endl << "<body>";
-	}else{
+	if(!fileSink.valid()){
 		osg::notify(osg::WARN) << "HogBoxNotifyHandler::HogBoxNotifyHandler: ERROR: Failed to create Message log file '" << outputFileName << "'. The standard log output will be used." << std::endl;
 	}
 }
@@ -40,52 +40,158 @@ HogBoxNotifyHandler::HogBoxNotifyHandler(const std::string& outputFileName)
 HogBoxNotifyHandler::~HogBoxNotifyHandler()
 {
 	OSG_NOTICE << "    Deallocating HogBoxNotifyHandler Instance." << std::endl;
-	//write our html closing tags
-	if(_outputFile.is_open())
+
+	//stop the writer, it writes anything still queued before finishing
 	{
-		//write our html closing tags
-		_outputFile << "</body>" << std::endl << "</html>" << std::endl;
-		_outputFile.close();
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_wakeMutex);
+		_done = true;
+		_wakeCondition.broadcast();
 	}
+	_writerThread->join();
+	delete _writerThread;
+	_writerThread = NULL;
+
+	//sinks write their closing tags and close their files as they're released
+	_sinks.clear();
 }
 
 //
-//Write the notify message into a html file
+//Queue the notify message for the writer thread
 //
 void HogBoxNotifyHandler::notify(osg::NotifySeverity severity, const char *message)
 {
-	//place the line into html paragraph
-	if(_outputFile.is_open())
-	{
-		_outputFile << "<PRE " << CreateHtmlStyleString(severity) << ">" << message << "</PRE>" << std::endl;
-	
-		//if file failed to open, then use the standard handler
-		PlatformNotifyHandler::notify(severity, message);
-	}else{
-		//if file failed to open, then use the standard handler
-		PlatformNotifyHandler::notify(severity, message);
+	double time = osg::Timer::instance()->delta_s(_startTick, osg::Timer::instance()->tick());
+	if(!this->AllowMessage(message, time)){return;}
+
+	OpenThreads::Thread* thread = OpenThreads::Thread::CurrentThread();
+	_buffer.Push(severity, time, thread ? thread->getThreadId() : 0, message);
+}
+
+//
+//Add another destination for the log
+//
+void HogBoxNotifyHandler::AddSink(LogSink* sink)
+{
+	if(!sink){return;}
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_sinkMutex);
+	_sinks.push_back(sink);
+}
+
+//
+//Block until everything queued so far has been written
+//
+void HogBoxNotifyHandler::Flush()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_wakeMutex);
+	_flushRequested = true;
+	_wakeCondition.signal();
+	while(_flushRequested && !_done){
+		_flushedCondition.wait(&_wakeMutex);
 	}
 }
 
 //
-//returns a html style string based on severity to be inserted into <p> tag
+//Count the message against its call site for the current second, the call site
+//being the text before the first ': '
 //
-const std::string HogBoxNotifyHandler::CreateHtmlStyleString(osg::NotifySeverity severity)
+bool HogBoxNotifyHandler::AllowMessage(const char* message, double time)
 {
-	//get style
-	if(_levelToHtmlStyleList.count(severity) > 0)
+	unsigned int limit = _rateLimit;
+	if(limit == 0 || !message){return true;}
+
+	//FNV-1a of the call site, or of the first 64 chars if there's no ': '
+	unsigned int hash = 2166136261u;
+	for(unsigned int i=0; i<64 && message[i] != '\0'; i++){
+		if(message[i] == ':' && message[i+1] == ' '){break;}
+		hash ^= (unsigned char)message[i];
+		hash *= 16777619u;
+	}
+	CallSite& site = _callSites[(hash ^ (hash >> 16)) & (NUM_CALL_SITES-1)];
+
+	//start a new count each second, racing threads may both reset it which
+	//only lets a few extra messages through
+	unsigned int second = (unsigned int)time + 1;
+	if((unsigned int)site._second != second){
+		site._second.exchange(second);
+		site._count.exchange(0);
+	}
+	if(++site._count > limit){
+		++_numRateLimited;
+		return false;
+	}
+	return true;
+}
+
+//
+//Write the queued records to the sinks, followed by a count of any lost since
+//the last call
+//
+unsigned int HogBoxNotifyHandler::WriteRecords()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_sinkMutex);
+
+	unsigned int numWritten = 0;
+	while(_buffer.Pop(_record))
+	{
+		for(unsigned int i=0; i<_sinks.size(); i++){
+			_sinks[i]->Write(_record);
+		}
+		numWritten++;
+	}
+
+	unsigned int dropped = _buffer.GetNumDropped();
+	unsigned int rateLimited = _numRateLimited;
+	if(dropped != _reportedDropped || rateLimited != _reportedRateLimited)
 	{
-		HtmlStyle htmlStyle = _levelToHtmlStyleList[severity];
-
-		//make our hex color string
-		std::ostringstream colorStr(std::ostringstream::out);
-		colorStr << "#" << std::setw( 2 ) << std::setfill( '0' ) << std::hex << std::uppercase << (int)(htmlStyle.fontColor.x()*255) 
-						<< std::setw( 2 ) << std::setfill( '0' ) << std::hex << std::uppercase << (int)(htmlStyle.fontColor.y()*255) 
-						<< std::setw( 2 ) << std::setfill( '0' ) << std::hex << std::uppercase << (int)(htmlStyle.fontColor.z()*255);
-		std::ostringstream styleStr(std::ostringstream::out);
-		styleStr << "style=\"font-family:" << htmlStyle.fontFamily << ";color:" << colorStr.str() << ";font-size:" << htmlStyle.fontSize << "px;\"";
-		return styleStr.str();
+		std::ostringstream lost;
+		lost << "HogBoxNotifyHandler: WARN: " << dropped-_reportedDropped << " messages dropped as the log buffer was full, "
+			 << rateLimited-_reportedRateLimited << " over the rate limit of " << _rateLimit << " per second from one call site.";
+		_reportedDropped = dropped;
+		_reportedRateLimited = rateLimited;
+
+		LogRecord record;
+		record._severity = osg::WARN;
+		record._time = osg::Timer::instance()->delta_s(_startTick, osg::Timer::instance()->tick());
+		record.SetMessage(lost.str().c_str());
+		for(unsigned int i=0; i<_sinks.size(); i++){
+			_sinks[i]->Write(record);
+		}
+		numWritten++;
+	}
+
+	if(numWritten > 0){
+		for(unsigned int i=0; i<_sinks.size(); i++){
+			_sinks[i]->Flush();
+		}
 	}
+	return numWritten;
+}
+
+//
+//Write records until the handler is destroyed
+//
+void HogBoxNotifyHandler::RunWriter()
+{
+	for(;;)
+	{
+		bool done = false;
+		bool flush = false;
+		{
+			OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_wakeMutex);
+			if(!_done && !_flushRequested){
+				_wakeCondition.wait(&_wakeMutex, s_writerIntervalMs);
+			}
+			done = _done;
+			flush = _flushRequested;
+		}
 
-	return "";
-}
\ No newline at end of file
+		this->WriteRecords();
+
+		if(flush){
+			OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_wakeMutex);
+			_flushRequested = false;
+			_flushedCondition.broadcast();
+		}
+		if(done){break;}
+	}
+}
@@ -93,12 +93,23 @@ bool HogBoxObject::GetVisible() const
 	}
 }
 
+//
+//Name lookup table for the objects graph, built on first use
+//
+NodeNameIndex& HogBoxObject::GetNodeNameIndex()
+{
+	if(!_nodeNameIndex.IsBuilt()){
+		_nodeNameIndex.Build(_root.get());
+	}
+	return _nodeNameIndex;
+}
+
 osg::Node* HogBoxObject::GetNodeByName(const std::string& name, const bool& subString)
 {
-	FindNodesByName findNodes(name,subString);
-	_root->accept(findNodes);
-	if(findNodes._count>0)
-	{return findNodes._foundList[0];}
+	std::vector<osg::Node*> found;
+	GetNodeNameIndex().FindNodes(name, subString, found);
+	if(found.size()>0)
+	{return found[0];}
 	return NULL;
 }
 
@@ -107,9 +118,9 @@ osg::Node* HogBoxObject::GetNodeByName(const std::string& name, const bool& subS
 //
 std::vector<osg::Node*> HogBoxObject::GetNodesByName(const std::string& name, const bool& subString)
 {
-	FindNodesByName findNodes(name,subString);
-	_root->accept(findNodes);
-	return findNodes._foundList;
+	std::vector<osg::Node*> found;
+	GetNodeNameIndex().FindNodes(name, subString, found);
+	return found;
 }
 
 //
@@ -253,6 +264,9 @@ bool HogBoxObject::AddNodeToObject(osg::ref_ptr<osg::Node> node)
 
 	_wrappedNodes.push_back(node);
 
+	//the graph has changed, rebuild the index on the next lookup
+	_nodeNameIndex.Clear();
+
 	//apply the default node masks to our geom
 	ApplyDefaultNodeMaskVisitor applyNodeMasks;
 	node->accept(applyNodeMasks);
@@ -264,10 +278,16 @@ bool HogBoxObject::AddNodeToObject(osg::ref_ptr<osg::Node> node)
 
 	//pass all the meshmappings over the the new node
 	//applying the material and other parameters to any geodes
-	//in the subgraph matching the mapto list
-	for(unsigned int i=0; i<_meshMappings.size(); i++)
+	//in the subgraph matching the mapto list, the subgraph is
+	//indexed once rather than traversed by each mapping
+	if(_meshMappings.size() > 0)
 	{
-		node->accept(*_meshMappings[i]->_visitor);
+		NodeNameIndex subgraphIndex;
+		subgraphIndex.Build(node.get());
+		for(unsigned int i=0; i<_meshMappings.size(); i++)
+		{
+			_meshMappings[i]->_visitor->ApplyToIndex(subgraphIndex);
+		}
 	}
 	
 	return true;
@@ -323,6 +343,20 @@ void HogBoxObject::SetWrappedNodes(const NodePtrVector& nodes)
 	}
 }
 
+//
+//detach every wrapped node from our local transform
+//
+void HogBoxObject::ClearWrappedNodes()
+{
+	for(unsigned int i=0; i<_wrappedNodes.size(); i++){
+		_localTransform->removeChild(_wrappedNodes[i].get());
+	}
+	_wrappedNodes.clear();
+
+	_totalBounds = _root->computeBound();
+	_nodeNameIndex.Clear();
+}
+
 //
 //add a mesh mapping to our list, the added mappings will be passed
 //across all existing wrapped nodes to apply the mapping
@@ -331,8 +365,8 @@ bool HogBoxObject::AddMeshMapping(MeshMapping* mapping)
 {
 	if(!mapping){return false;}
 
-	//pass to our wrapped nodes via the root
-	_root->accept(*mapping->_visitor);
+	//pass to our wrapped nodes via the roots index
+	mapping->_visitor->ApplyToIndex(GetNodeNameIndex());
 
 	//add to our list
 	_meshMappings.push_back(mapping);
@@ -356,5 +390,10 @@ void HogBoxObject::SetMeshMappings(const std::vector<MeshMappingPtr>& mappings)
 	}
 }
 
+void HogBoxObject::ClearMeshMappings()
+{
+	_meshMappings.clear();
+}
+
 
 
@@ -3,6 +3,8 @@
 #include <osgDB/ReadFile>
 #include <osgDB/FileNameUtils>
 
+#include <hogbox/WorkStealingPool.h>
+
 #ifdef WIN32
 #include <windows.h>
 #endif
@@ -424,47 +426,16 @@ std::string hogbox::ChangeFileFolder(std::string filePath, std::string newFolder
 //
 osg::Image*  hogbox::make3DNoiseImage(int texSize)
 {
-    osg::Image* image = new osg::Image;
-    image->setImage(texSize, texSize, texSize,
-            4, GL_RGBA, GL_UNSIGNED_BYTE,
-            new unsigned char[4 * texSize * texSize * texSize],
-            osg::Image::USE_NEW_DELETE);
-
-    const int startFrequency = 4;
-    const int numOctaves = 4;
-
-    int f, i, j, k, inc;
-    double ni[3];
-    double inci, incj, inck;
-    int frequency = startFrequency;
-    GLubyte *ptr;
-    double amp = 0.5;
-
     osg::notify(osg::INFO) << "creating 3D noise texture... ";
 
-    for (f = 0, inc = 0; f < numOctaves; ++f, frequency *= 2, ++inc, amp *= 0.5)
-    {
-       // SetNoiseFrequency(frequency);
-        ptr = image->data();
-        ni[0] = ni[1] = ni[2] = 0;
-
-        inci = 1.0 / (texSize / frequency);
-        for (i = 0; i < texSize; ++i, ni[0] += inci)
-        {
-            incj = 1.0 / (texSize / frequency);
-            for (j = 0; j < texSize; ++j, ni[1] += incj)
-            {
-                inck = 1.0 / (texSize / frequency);
-                for (k = 0; k < texSize; ++k, ni[2] += inck, ptr += 4)
-                {
-                   // *(ptr+inc) = (GLubyte) (((noise3(ni) + 1.0) * amp) * 128.0);
-                }
-            }
-        }
-    }
+    //four octaves of perlin noise, tiling to suit the repeat wrap of make3DNoiseTexture
+    NoiseGenerator noise(NoiseGenerator::PERLIN_NOISE);
+    osg::ref_ptr<osg::Image> image = CreateNoiseImage3D(texSize, texSize, texSize, GL_RGBA, noise,
+                                                        FractalSettings(4.0f, 4, 2.0f, 0.5f, 1.0f),
+                                                        WorkStealingPool::Inst());
 
     osg::notify(osg::INFO) << "DONE" << std::endl;
-    return image;
+    return image.release();
 }
 
 osg::Texture3D*  hogbox::make3DNoiseTexture(int texSize )
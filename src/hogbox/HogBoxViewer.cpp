@@ -1,4 +1,5 @@
 #include <hogbox/HogBoxViewer.h>
+#include <hogbox/Profiler.h>
 
 #include <iostream>
 
@@ -163,11 +164,23 @@ void HogBoxViewer::frame()
 {
 	if(_viewer.valid())
 	{
+		HOGBOX_PROFILE_FRAME();
+		HOGBOX_PROFILE_SCOPE("HogBoxViewer::frame");
+
 		if(_resizeCallback != NULL)
 		{
 			_winSize = _resizeCallback->GetWinSize();
 			_winCorner = _resizeCallback->GetWinCorner();
 		}
+
+		//latch the clocks with the reference time the viewer is about to advance to
+		if(!_presentationClocks.empty())
+		{
+			double frameTime = osg::Timer::instance()->delta_s(_viewer->getStartTick(), osg::Timer::instance()->tick());
+			for(unsigned int i=0; i<_presentationClocks.size(); i++){
+				_presentationClocks[i]->BeginFrame(frameTime);
+			}
+		}
 		_viewer->frame();
 	}
 }
@@ -184,6 +197,31 @@ bool HogBoxViewer::done()
 	return true;
 }
 
+//
+//Drive clock from our frame timing
+//
+void HogBoxViewer::AddPresentationClock(PresentationClock* clock)
+{
+	if(!clock){return;}
+	for(unsigned int i=0; i<_presentationClocks.size(); i++){
+		if(_presentationClocks[i].get() == clock){return;}
+	}
+	clock->SetTimeSource(PresentationClock::FRAME_TIME);
+	_presentationClocks.push_back(clock);
+}
+
+void HogBoxViewer::RemovePresentationClock(PresentationClock* clock)
+{
+	for(unsigned int i=0; i<_presentationClocks.size(); i++){
+		if(_presentationClocks[i].get() == clock){
+			//let it run free again
+			clock->SetTimeSource(PresentationClock::TIMER_TIME);
+			_presentationClocks.erase(_presentationClocks.begin()+i);
+			return;
+		}
+	}
+}
+
 void HogBoxViewer::addEventHandler(osgGA::GUIEventHandler* eventHandler)
 {
 	//add to our list of eventHandler
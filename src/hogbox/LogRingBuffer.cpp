@@ -0,0 +1,81 @@
+#include <hogbox/LogRingBuffer.h>
+
+#include <OpenThreads/Thread>
+
+using namespace hogbox;
+
+LogRingBuffer::LogRingBuffer(unsigned int size)
+	: _slots(NULL),
+	_mask(0),
+	_headroom(0),
+	_writeIndex(0),
+	_readIndex(0),
+	_numDropped(0)
+{
+	unsigned int numSlots = 16;
+	while(numSlots < size){numSlots <<= 1;}
+	_mask = numSlots-1;
+	_headroom = numSlots/8;
+
+	_slots = new Slot[numSlots];
+	for(unsigned int i=0; i<numSlots; i++){
+		_slots[i]._sequence.exchange(i);
+	}
+}
+
+LogRingBuffer::~LogRingBuffer(void)
+{
+	delete [] _slots;
+}
+
+//
+//Queue a message from any thread
+//
+bool LogRingBuffer::Push(osg::NotifySeverity severity, double time, int threadID, const char* message)
+{
+	//read before the write index, so the difference can't go negative
+	unsigned int readIndex = _readIndex;
+	unsigned int writeIndex = _writeIndex;
+	if(writeIndex - readIndex >= _mask+1 - _headroom){
+		++_numDropped;
+		return false;
+	}
+
+	//claim an index, its slot is free unless the headroom was used up by other
+	//producers between the check above and here
+	unsigned int index = (++_writeIndex) - 1;
+	Slot& slot = _slots[index & _mask];
+	while((unsigned int)slot._sequence != index){
+		OpenThreads::Thread::YieldCurrentThread();
+	}
+
+	slot._record._severity = severity;
+	slot._record._time = time;
+	slot._record._threadID = threadID;
+	slot._record.SetMessage(message);
+
+	//publish, XOR with the known value sets it with a full barrier so the record
+	//is written first (exchange is only an acquire barrier on some platforms)
+	slot._sequence.XOR(index ^ (index+1));
+	return true;
+}
+
+//
+//Copy the oldest record out
+//
+bool LogRingBuffer::Pop(LogRecord& record)
+{
+	unsigned int readIndex = _readIndex;
+	Slot& slot = _slots[readIndex & _mask];
+	if((unsigned int)slot._sequence != readIndex+1){
+		//empty, or the producer is still writing it
+		return false;
+	}
+
+	record = slot._record;
+
+	//free the slot for the record a lap later
+	slot._sequence.XOR((readIndex+1) ^ (readIndex+_mask+1));
+	++_readIndex;
+	return true;
+}
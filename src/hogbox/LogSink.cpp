@@ -0,0 +1,217 @@
+#include <hogbox/LogSink.h>
+
+#include <osgDB/FileNameUtils>
+
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <iomanip>
+
+using namespace hogbox;
+
+//
+//Copy message, dropping its trailing line ends
+//
+void LogRecord::SetMessage(const char* message)
+{
+	unsigned int length = 0;
+	if(message){
+		while(length < MAX_MESSAGE_LENGTH-1 && message[length] != '\0'){length++;}
+	}
+	while(length > 0 && (message[length-1] == '\n' || message[length-1] == '\r')){length--;}
+	if(length > 0){memcpy(_message, message, length);}
+	_message[length] = '\0';
+	_length = length;
+}
+
+//
+//Returns the name of a notify level
+//
+const char* hogbox::GetNotifySeverityName(osg::NotifySeverity severity)
+{
+	switch(severity)
+	{
+		case osg::ALWAYS: return "ALWAYS";
+		case osg::FATAL: return "FATAL";
+		case osg::WARN: return "WARN";
+		case osg::NOTICE: return "NOTICE";
+		case osg::INFO: return "INFO";
+		case osg::DEBUG_INFO: return "DEBUG_INFO";
+		case osg::DEBUG_FP: return "DEBUG_FP";
+		default: break;
+	}
+	return "UNKNOWN";
+}
+
+FileLogSink::FileLogSink(const std::string& fileName)
+	: LogSink()
+{
+	_file.open(fileName.c_str());
+}
+
+FileLogSink::~FileLogSink(void)
+{
+	if(_file.is_open()){_file.close();}
+}
+
+TextLogSink::TextLogSink(const std::string& fileName)
+	: FileLogSink(fileName)
+{
+}
+
+//
+//[   12.345] WARN   (1) message
+//
+void TextLogSink::Write(const LogRecord& record)
+{
+	char prefix[64];
+	sprintf(prefix, "[%9.3f] %-6s (%d) ", record._time, GetNotifySeverityName(record._severity), record._threadID);
+	_file << prefix;
+	_file.write(record._message, record._length);
+	_file << '\n';
+}
+
+JsonLogSink::JsonLogSink(const std::string& fileName)
+	: FileLogSink(fileName)
+{
+}
+
+//
+//{"time":12.345,"severity":"WARN","thread":1,"message":"..."}
+//
+void JsonLogSink::Write(const LogRecord& record)
+{
+	char prefix[96];
+	sprintf(prefix, "{\"time\":%.3f,\"severity\":\"%s\",\"thread\":%d,\"message\":\"", record._time, GetNotifySeverityName(record._severity), record._threadID);
+	_file << prefix;
+	for(unsigned int i=0; i<record._length; i++)
+	{
+		unsigned char c = (unsigned char)record._message[i];
+		switch(c)
+		{
+			case '"': _file << "\\\""; break;
+			case '\\': _file << "\\\\"; break;
+			case '\n': _file << "\\n"; break;
+			case '\r': _file << "\\r"; break;
+			case '\t': _file << "\\t"; break;
+			default:
+				if(c < 0x20){
+					char escaped[8];
+					sprintf(escaped, "\\u%04x", c);
+					_file << escaped;
+				}else{
+					_file.put((char)c);
+				}
+				break;
+		}
+	}
+	_file << "\"}\n";
+}
+
+HtmlLogSink::HtmlLogSink(const std::string& fileName)
+	: FileLogSink(fileName)
+{
+	if(!_file.is_open()){return;}
+
+	//create our html styles for each severity
+	_levelStyles[osg::FATAL] = CreateHtmlStyleString(osg::FATAL);
+	_levelStyles[osg::WARN] = CreateHtmlStyleString(osg::WARN);
+	_levelStyles[osg::NOTICE] = CreateHtmlStyleString(osg::NOTICE);
+	_levelStyles[osg::INFO] = CreateHtmlStyleString(osg::INFO);
+	_levelStyles[osg::DEBUG_INFO] = CreateHtmlStyleString(osg::DEBUG_INFO);
+	_levelStyles[osg::DEBUG_FP] = CreateHtmlStyleString(osg::DEBUG_FP);
+
+	//write our html header
+	_file << "<html>" << std::endl << "<body>";
+}
+
+HtmlLogSink::~HtmlLogSink(void)
+{
+	if(_file.is_open())
+	{
+		//write our html closing tags
+		_file << "</body>" << std::endl << "</html>" << std::endl;
+	}
+}
+
+//
+//Write the record as a html paragraph, escaping the markup characters
+//
+void HtmlLogSink::Write(const LogRecord& record)
+{
+	_file << "<PRE ";
+	if(record._severity >= osg::ALWAYS && record._severity <= osg::DEBUG_FP){
+		_file << _levelStyles[record._severity];
+	}
+	_file << ">";
+	for(unsigned int i=0; i<record._length; i++)
+	{
+		switch(record._message[i])
+		{
+			case '<': _file << "&lt;"; break;
+			case '>': _file << "&gt;"; break;
+			case '&': _file << "&amp;"; break;
+			default: _file.put(record._message[i]); break;
+		}
+	}
+	_file << "</PRE>\n";
+}
+
+//
+//returns a html style string based on severity to be inserted into <PRE> tag
+//
+const std::string HtmlLogSink::CreateHtmlStyleString(osg::NotifySeverity severity)
+{
+	HtmlStyle htmlStyle;
+	switch(severity)
+	{
+		case osg::FATAL: htmlStyle = HtmlStyle(osg::Vec3(0.9f,0.1f,0.1f)); break;
+		case osg::WARN: htmlStyle = HtmlStyle(osg::Vec3(0.1f,0.1f,0.9f)); break;
+		case osg::NOTICE: htmlStyle = HtmlStyle(osg::Vec3(0.1f,0.9f,0.1f)); break;
+		case osg::INFO: htmlStyle = HtmlStyle(osg::Vec3(0.0f,0.0f,0.0f)); break;
+		case osg::DEBUG_INFO: htmlStyle = HtmlStyle(osg::Vec3(0.3f,0.3f,0.3f)); break;
+		case osg::DEBUG_FP: htmlStyle = HtmlStyle(osg::Vec3(0.6f,0.6f,0.6f)); break;
+		default: return "";
+	}
+
+	//make our hex color string
+	std::ostringstream colorStr(std::ostringstream::out);
+	colorStr << "#" << std::setw( 2 ) << std::setfill( '0' ) << std::hex << std::uppercase << (int)(htmlStyle.fontColor.x()*255)
+					<< std::setw( 2 ) << std::setfill( '0' ) << std::hex << std::uppercase << (int)(htmlStyle.fontColor.y()*255)
+					<< std::setw( 2 ) << std::setfill( '0' ) << std::hex << std::uppercase << (int)(htmlStyle.fontColor.z()*255);
+	std::ostringstream styleStr(std::ostringstream::out);
+	styleStr << "style=\"font-family:" << htmlStyle.fontFamily << ";color:" << colorStr.str() << ";font-size:" << htmlStyle.fontSize << "px;\"";
+	return styleStr.str();
+}
+
+NotifyHandlerLogSink::NotifyHandlerLogSink(osg::NotifyHandler* handler)
+	: LogSink(),
+	_handler(handler)
+{
+}
+
+void NotifyHandlerLogSink::Write(const LogRecord& record)
+{
+	if(!_handler.valid()){return;}
+	_line.assign(record._message, record._length);
+	_line += '\n';
+	_handler->notify(record._severity, _line.c_str());
+}
+
+//
+//Allocate the sink for fileName by its extension
+//
+LogSink* hogbox::CreateFileLogSink(const std::string& fileName)
+{
+	std::string ext = osgDB::getLowerCaseFileExtension(fileName);
+	osg::ref_ptr<FileLogSink> sink;
+	if(ext == "html" || ext == "htm"){
+		sink = new HtmlLogSink(fileName);
+	}else if(ext == "json" || ext == "jsonl"){
+		sink = new JsonLogSink(fileName);
+	}else{
+		sink = new TextLogSink(fileName);
+	}
+	if(!sink->IsOpen()){return NULL;}
+	return sink.release();
+}
@@ -0,0 +1,616 @@
+#include <hogbox/MemoryTracker.h>
+
+#include <hogbox/SystemInfo.h>
+
+#include <osg/Geode>
+#include <osg/Geometry>
+#include <osg/NodeVisitor>
+#include <osg/TextureCubeMap>
+#include <osg/Notify>
+#include <OpenThreads/ScopedLock>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+using namespace hogbox;
+
+static osg::ref_ptr<MemoryTracker> s_hogboxMemoryTrackerInstance = NULL;
+
+MemoryTracker* MemoryTracker::Inst(bool erase)
+{
+	if(s_hogboxMemoryTrackerInstance==NULL)
+	{s_hogboxMemoryTrackerInstance = new MemoryTracker();}
+	if(erase)
+	{
+		s_hogboxMemoryTrackerInstance = 0;
+	}
+	return s_hogboxMemoryTrackerInstance.get();
+}
+
+MemoryTracker::MemoryTracker()
+	: osg::Referenced(),
+	_cpuBudget(0),
+	_gpuBudget(0)
+{
+}
+
+MemoryTracker::~MemoryTracker(void)
+{
+	_entries.clear();
+}
+
+namespace {
+
+//
+//Geometry arrays are raw pointers or ref_ptrs depending on the osg version
+//
+inline osg::BufferData* ToBufferData(osg::BufferData* data){return data;}
+template <class T>
+inline osg::BufferData* ToBufferData(const osg::ref_ptr<T>& data){return data.get();}
+
+//
+//Collects the buffers of every geometry and the textures of every stateset
+//below a node, tracked together afterwards under the trackers mutex
+//
+class TrackNodeVisitor : public osg::NodeVisitor
+{
+public:
+	struct Buffer
+	{
+		osg::BufferData* _data;
+		std::string _name;
+		bool _onGPU;
+	};
+
+	TrackNodeVisitor()
+		: osg::NodeVisitor(osg::NodeVisitor::TRAVERSE_ALL_CHILDREN)
+	{
+	}
+
+	virtual void apply(osg::Node& node)
+	{
+		AddStateSet(node.getStateSet());
+		traverse(node);
+	}
+
+	virtual void apply(osg::Geode& geode)
+	{
+		AddStateSet(geode.getStateSet());
+		for(unsigned int i=0; i<geode.getNumDrawables(); i++)
+		{
+			osg::Drawable* drawable = geode.getDrawable(i);
+			if(!drawable){continue;}
+			AddStateSet(drawable->getStateSet());
+			if(drawable->asGeometry()){AddGeometry(drawable->asGeometry());}
+		}
+		traverse(geode);
+	}
+
+	std::vector<Buffer> _buffers;
+	std::vector<osg::Texture*> _textures;
+
+protected:
+
+	void AddStateSet(osg::StateSet* stateSet)
+	{
+		if(!stateSet){return;}
+		for(unsigned int unit=0; unit<stateSet->getTextureAttributeList().size(); unit++)
+		{
+			osg::StateAttribute* attribute = stateSet->getTextureAttribute(unit, osg::StateAttribute::TEXTURE);
+			osg::Texture* texture = attribute ? attribute->asTexture() : NULL;
+			if(texture){_textures.push_back(texture);}
+		}
+	}
+
+	void AddGeometry(osg::Geometry* geometry)
+	{
+		std::string name = geometry->getName().empty() ? std::string(geometry->className()) : geometry->getName();
+		//the driver keeps its own copy of buffers in vbos or display lists
+		bool onGPU = geometry->getUseVertexBufferObjects() || geometry->getUseDisplayList();
+
+		osg::Geometry::ArrayList arrays;
+		geometry->getArrayList(arrays);
+		for(unsigned int i=0; i<arrays.size(); i++){
+			AddBuffer(ToBufferData(arrays[i]), name, onGPU);
+		}
+
+		osg::Geometry::DrawElementsList elements;
+		geometry->getDrawElementsList(elements);
+		for(unsigned int i=0; i<elements.size(); i++){
+			AddBuffer(ToBufferData(elements[i]), name, onGPU);
+		}
+	}
+
+	void AddBuffer(osg::BufferData* data, const std::string& geometryName, bool onGPU)
+	{
+		if(!data){return;}
+		Buffer buffer;
+		buffer._data = data;
+		buffer._name = geometryName + " " + data->className();
+		buffer._onGPU = onGPU;
+		_buffers.push_back(buffer);
+	}
+};
+
+//
+//Usage map entries, largest first
+//
+typedef std::pair<std::string, MemoryUsage> NamedUsage;
+
+bool LargerUsage(const NamedUsage& lhs, const NamedUsage& rhs)
+{
+	return lhs.second._cpuBytes + lhs.second._gpuBytes > rhs.second._cpuBytes + rhs.second._gpuBytes;
+}
+
+bool LargerRecord(const MemoryTracker::MemoryRecord& lhs, const MemoryTracker::MemoryRecord& rhs)
+{
+	return lhs._cpuBytes + lhs._gpuBytes > rhs._cpuBytes + rhs._gpuBytes;
+}
+
+void AddUsage(MemoryUsage& usage, const MemoryTracker::MemoryRecord& record)
+{
+	usage._numObjects++;
+	usage._cpuBytes += record._cpuBytes;
+	usage._gpuBytes += record._gpuBytes;
+}
+
+//
+//Bytes in the largest unit that keeps them above one
+//
+std::string FormatBytes(unsigned long long bytes)
+{
+	std::ostringstream out;
+	out << std::fixed << std::setprecision(1);
+	if(bytes >= 1024*1024*1024ULL){
+		out << (double)bytes/(1024.0*1024.0*1024.0) << " GB";
+	}else if(bytes >= 1024*1024ULL){
+		out << (double)bytes/(1024.0*1024.0) << " MB";
+	}else if(bytes >= 1024ULL){
+		out << (double)bytes/1024.0 << " KB";
+	}else{
+		out << bytes << " B";
+	}
+	return out.str();
+}
+
+void WriteUsageRow(std::ostream& out, const std::string& name, const MemoryUsage& usage)
+{
+	out << "    " << std::left << std::setw(40) << (name.empty() ? std::string("(none)") : name)
+		<< std::right << std::setw(8) << usage._numObjects
+		<< std::setw(12) << FormatBytes(usage._cpuBytes)
+		<< std::setw(12) << FormatBytes(usage._gpuBytes) << std::endl;
+}
+
+void WriteUsageMap(std::ostream& out, const std::string& title, const MemoryTracker::MemoryUsageMap& usageMap)
+{
+	std::vector<NamedUsage> sorted(usageMap.begin(), usageMap.end());
+	std::sort(sorted.begin(), sorted.end(), LargerUsage);
+
+	out << title << std::endl;
+	for(unsigned int i=0; i<sorted.size(); i++){
+		WriteUsageRow(out, sorted[i].first, sorted[i].second);
+	}
+	out << std::endl;
+}
+
+};
+
+//
+//Track object or update its record
+//
+void MemoryTracker::Track(osg::Object* object, Category category, unsigned long long cpuBytes, unsigned long long gpuBytes,
+						  const std::string& source, const std::string& owner)
+{
+	if(!object){return;}
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+	TrackLocked(object, category, cpuBytes, gpuBytes, source, owner);
+}
+
+void MemoryTracker::TrackImage(osg::Image* image, const std::string& source, const std::string& owner)
+{
+	if(!image){return;}
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+	TrackImageLocked(image, source, owner);
+}
+
+void MemoryTracker::TrackTexture(osg::Texture* texture, const std::string& source, const std::string& owner)
+{
+	if(!texture){return;}
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+	TrackTextureLocked(texture, source, owner);
+}
+
+//
+//Track the geometry buffers and textures below node
+//
+void MemoryTracker::TrackNode(osg::Node* node, const std::string& source, const std::string& owner)
+{
+	if(!node){return;}
+
+	TrackNodeVisitor visitor;
+	node->accept(visitor);
+
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+	for(unsigned int i=0; i<visitor._buffers.size(); i++)
+	{
+		const TrackNodeVisitor::Buffer& buffer = visitor._buffers[i];
+		unsigned long long bytes = buffer._data->getTotalDataSize();
+		MemoryRecord& record = TrackLocked(buffer._data, GEOMETRY, bytes, buffer._onGPU ? bytes : 0, source, owner);
+		//name buffers after their geometry rather than themselves
+		record._name = buffer._name;
+	}
+	for(unsigned int i=0; i<visitor._textures.size(); i++){
+		TrackTextureLocked(visitor._textures[i], source, owner);
+	}
+}
+
+//
+//Track by whichever type object is
+//
+void MemoryTracker::TrackObject(osg::Object* object, const std::string& source, const std::string& owner)
+{
+	if(osg::Image* image = dynamic_cast<osg::Image*>(object)){
+		TrackImage(image, source, owner);
+	}else if(osg::Texture* texture = dynamic_cast<osg::Texture*>(object)){
+		TrackTexture(texture, source, owner);
+	}else if(osg::Node* node = dynamic_cast<osg::Node*>(object)){
+		TrackNode(node, source, owner);
+	}
+}
+
+void MemoryTracker::Untrack(osg::Object* object)
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+	_entries.erase(object);
+}
+
+bool MemoryTracker::IsTracked(osg::Object* object)
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+	EntryMap::iterator itr = _entries.find(object);
+	return itr != _entries.end() && (*itr).second._object.valid();
+}
+
+//
+//Add or update the entry of object
+//
+MemoryTracker::MemoryRecord& MemoryTracker::TrackLocked(osg::Object* object, Category category, unsigned long long cpuBytes, unsigned long long gpuBytes,
+								const std::string& source, const std::string& owner)
+{
+	Entry& entry = _entries[object];
+
+	//a new entry, or a deleted objects memory reused by a new one
+	if(!entry._object.valid()){
+		entry._object = object;
+		entry._record = MemoryRecord();
+	}
+
+	MemoryRecord& record = entry._record;
+	record._name = object->getName().empty() ? std::string(object->className()) : object->getName();
+	record._category = category;
+	record._cpuBytes = cpuBytes;
+	record._gpuBytes = gpuBytes;
+	if(!source.empty()){record._source = source;}
+	if(!owner.empty()){record._owner = owner;}
+	return record;
+}
+
+//
+//Track an image, recorded against its file name until something gives a source
+//
+MemoryTracker::MemoryRecord& MemoryTracker::TrackImageLocked(osg::Image* image, const std::string& source, const std::string& owner)
+{
+	MemoryRecord& record = TrackLocked(image, IMAGE, EstimateImageBytes(image), 0, source, owner);
+	if(record._source.empty()){record._source = image->getFileName();}
+	return record;
+}
+
+//
+//Track a texture and its images, the gpu copy is the textures and the pixel
+//data the images. Without a source the texture takes its first images
+//
+MemoryTracker::MemoryRecord& MemoryTracker::TrackTextureLocked(osg::Texture* texture, const std::string& source, const std::string& owner)
+{
+	std::string imageSource;
+	for(unsigned int i=0; i<texture->getNumImages(); i++)
+	{
+		osg::Image* image = texture->getImage(i);
+		if(!image){continue;}
+		const MemoryRecord& imageRecord = TrackImageLocked(image, source, owner);
+		if(imageSource.empty()){imageSource = imageRecord._source;}
+	}
+	MemoryRecord& record = TrackLocked(texture, TEXTURE, 0, EstimateTextureBytes(texture), source, owner);
+	if(record._source.empty()){record._source = imageSource;}
+	return record;
+}
+
+//
+//Drop the entries of deleted objects
+//
+void MemoryTracker::Prune()
+{
+	for(EntryMap::iterator itr=_entries.begin(); itr!=_entries.end(); )
+	{
+		if(!(*itr).second._object.valid()){
+			_entries.erase(itr++);
+		}else{
+			itr++;
+		}
+	}
+}
+
+MemoryUsage MemoryTracker::GetTotal()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+	Prune();
+	MemoryUsage total;
+	for(EntryMap::iterator itr=_entries.begin(); itr!=_entries.end(); itr++){
+		AddUsage(total, (*itr).second._record);
+	}
+	return total;
+}
+
+MemoryUsage MemoryTracker::GetTotal(Category category)
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+	Prune();
+	MemoryUsage total;
+	for(EntryMap::iterator itr=_entries.begin(); itr!=_entries.end(); itr++){
+		if((*itr).second._record._category == category){AddUsage(total, (*itr).second._record);}
+	}
+	return total;
+}
+
+MemoryTracker::MemoryUsageMap MemoryTracker::GetUsageBySource()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+	Prune();
+	MemoryUsageMap usage;
+	for(EntryMap::iterator itr=_entries.begin(); itr!=_entries.end(); itr++){
+		AddUsage(usage[(*itr).second._record._source], (*itr).second._record);
+	}
+	return usage;
+}
+
+MemoryTracker::MemoryUsageMap MemoryTracker::GetUsageByOwner()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+	Prune();
+	MemoryUsageMap usage;
+	for(EntryMap::iterator itr=_entries.begin(); itr!=_entries.end(); itr++){
+		AddUsage(usage[(*itr).second._record._owner], (*itr).second._record);
+	}
+	return usage;
+}
+
+//
+//Every record, largest first
+//
+MemoryTracker::MemoryRecordVector MemoryTracker::GetRecords()
+{
+	MemoryRecordVector records;
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+		Prune();
+		records.reserve(_entries.size());
+		for(EntryMap::iterator itr=_entries.begin(); itr!=_entries.end(); itr++){
+			records.push_back((*itr).second._record);
+		}
+	}
+	std::sort(records.begin(), records.end(), LargerRecord);
+	return records;
+}
+
+void MemoryTracker::SetBudget(unsigned long long cpuBytes, unsigned long long gpuBytes)
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+	_cpuBudget = cpuBytes;
+	_gpuBudget = gpuBytes;
+}
+
+bool MemoryTracker::IsOverBudget()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+	Prune();
+	MemoryUsage total;
+	for(EntryMap::iterator itr=_entries.begin(); itr!=_entries.end(); itr++){
+		AddUsage(total, (*itr).second._record);
+	}
+	return (_cpuBudget > 0 && total._cpuBytes > _cpuBudget) ||
+			(_gpuBudget > 0 && total._gpuBytes > _gpuBudget);
+}
+
+//
+//Write the totals and largest objects as text
+//
+void MemoryTracker::WriteReport(std::ostream& out, unsigned int maxRecords)
+{
+	MemoryRecordVector records = GetRecords();
+
+	MemoryUsage total;
+	MemoryUsage categories[NUM_CATEGORIES];
+	MemoryUsageMap bySource;
+	MemoryUsageMap byOwner;
+	for(unsigned int i=0; i<records.size(); i++)
+	{
+		AddUsage(total, records[i]);
+		AddUsage(categories[records[i]._category], records[i]);
+		AddUsage(bySource[records[i]._source], records[i]);
+		AddUsage(byOwner[records[i]._owner], records[i]);
+	}
+
+	out << "MemoryTracker report (estimated)" << std::endl;
+	out << "    " << std::left << std::setw(40) << "" << std::right << std::setw(8) << "objects"
+		<< std::setw(12) << "cpu" << std::setw(12) << "gpu" << std::endl;
+	WriteUsageRow(out, "total", total);
+	out << std::endl;
+
+	if(_cpuBudget > 0 || _gpuBudget > 0)
+	{
+		out << "Budget" << std::endl;
+		if(_cpuBudget > 0){
+			out << "    cpu " << FormatBytes(total._cpuBytes) << " of " << FormatBytes(_cpuBudget)
+				<< (total._cpuBytes > _cpuBudget ? " OVER BUDGET" : "") << std::endl;
+		}
+		if(_gpuBudget > 0){
+			out << "    gpu " << FormatBytes(total._gpuBytes) << " of " << FormatBytes(_gpuBudget)
+				<< (total._gpuBytes > _gpuBudget ? " OVER BUDGET" : "") << std::endl;
+		}
+		out << std::endl;
+	}
+
+	//what the driver says, where it says anything
+	if(SystemInfo::Inst()->totalDedicatedGLMemory() > 0)
+	{
+		out << "Driver reported" << std::endl;
+		out << "    dedicated " << FormatBytes((unsigned long long)SystemInfo::Inst()->totalDedicatedGLMemory()*1024ULL)
+			<< ", available " << FormatBytes((unsigned long long)SystemInfo::Inst()->availableDedicatedGLMemory()*1024ULL) << std::endl;
+		out << std::endl;
+	}
+
+	out << "By category" << std::endl;
+	for(unsigned int i=0; i<NUM_CATEGORIES; i++){
+		WriteUsageRow(out, GetCategoryName((Category)i), categories[i]);
+	}
+	out << std::endl;
+
+	WriteUsageMap(out, "By source", bySource);
+	WriteUsageMap(out, "By owner", byOwner);
+
+	unsigned int numRecords = std::min(maxRecords, (unsigned int)records.size());
+	out << "Largest " << numRecords << " of " << records.size() << " objects" << std::endl;
+	for(unsigned int i=0; i<numRecords; i++)
+	{
+		const MemoryRecord& record = records[i];
+		out << "    " << std::left << std::setw(14) << GetCategoryName(record._category)
+			<< std::setw(40) << record._name
+			<< std::right << std::setw(12) << FormatBytes(record._cpuBytes)
+			<< std::setw(12) << FormatBytes(record._gpuBytes)
+			<< "  " << (record._source.empty() ? "(none)" : record._source)
+			<< ", " << (record._owner.empty() ? "(none)" : record._owner) << std::endl;
+	}
+}
+
+bool MemoryTracker::WriteReport(const std::string& fileName, unsigned int maxRecords)
+{
+	std::ofstream out(fileName.c_str());
+	if(!out.is_open()){
+		OSG_WARN << "MemoryTracker::WriteReport: ERROR: Failed to open report file '" << fileName << "'." << std::endl;
+		return false;
+	}
+	WriteReport(out, maxRecords);
+	return true;
+}
+
+const char* MemoryTracker::GetCategoryName(Category category)
+{
+	switch(category)
+	{
+		case IMAGE: return "image";
+		case TEXTURE: return "texture";
+		case GEOMETRY: return "geometry";
+		case RENDER_TARGET: return "render_target";
+		case FRAME_BUFFER: return "frame_buffer";
+		default: break;
+	}
+	return "unknown";
+}
+
+//
+//Gpu bytes per pixel of an uncompressed internal format
+//
+unsigned int MemoryTracker::EstimatePixelBytes(GLint internalFormat)
+{
+	switch(internalFormat)
+	{
+		case GL_ALPHA:
+		case GL_LUMINANCE:
+			return 1;
+		case GL_LUMINANCE_ALPHA:
+		case GL_ALPHA16F_ARB:
+		case GL_INTENSITY16F_ARB:
+		case GL_LUMINANCE16F_ARB:
+			return 2;
+		case GL_ALPHA32F_ARB:
+		case GL_INTENSITY32F_ARB:
+		case GL_LUMINANCE32F_ARB:
+		case GL_LUMINANCE_ALPHA16F_ARB:
+			return 4;
+		case GL_RGB16F_ARB:
+		case GL_RGBA16F_ARB:
+		case GL_LUMINANCE_ALPHA32F_ARB:
+			return 8;
+		case GL_RGB32F_ARB:
+		case GL_RGBA32F_ARB:
+			return 16;
+		default:
+			break;
+	}
+	return 4;
+}
+
+//
+//Pixel data held by image, including any mipmaps it carries
+//
+unsigned long long MemoryTracker::EstimateImageBytes(const osg::Image* image)
+{
+	if(!image || !image->data()){return 0;}
+	return image->getTotalSizeInBytesIncludingMipmaps();
+}
+
+//
+//Gpu bytes of texture from its size, or its images size if it has none yet,
+//and internal format, plus a third for mipmaps when its filter uses them
+//
+unsigned long long MemoryTracker::EstimateTextureBytes(const osg::Texture* texture)
+{
+	if(!texture){return 0;}
+
+	const osg::Image* image = texture->getNumImages() > 0 ? texture->getImage(0) : NULL;
+	int width = texture->getTextureWidth();
+	int height = texture->getTextureHeight();
+	int depth = texture->getTextureDepth();
+	if(width <= 0 && image){
+		width = image->s();
+		height = image->t();
+		depth = image->r();
+	}
+	if(width <= 0){return 0;}
+	if(height <= 0){height = 1;}
+	if(depth <= 0){depth = 1;}
+
+	//only ask the texture for a format the user set, computing one can need a context
+	GLint internalFormat = 0;
+	if(texture->getInternalFormatMode() == osg::Texture::USE_USER_DEFINED_FORMAT){
+		internalFormat = texture->getInternalFormat();
+	}else if(image){
+		internalFormat = image->getInternalTextureFormat();
+	}
+
+	unsigned long long bytes = 0;
+	if(osg::Texture::isCompressedInternalFormat(internalFormat)){
+		//compressed formats store 4x4 blocks
+		unsigned long long blockWidth = (width+3)/4*4;
+		unsigned long long blockHeight = (height+3)/4*4;
+		bytes = blockWidth * blockHeight * depth * osg::Image::computePixelSizeInBits(internalFormat, GL_UNSIGNED_BYTE) / 8;
+	}else{
+		bytes = (unsigned long long)width * (unsigned long long)height * depth * EstimatePixelBytes(internalFormat);
+	}
+
+	if(dynamic_cast<const osg::TextureCubeMap*>(texture)){bytes *= 6;}
+
+	switch(texture->getFilter(osg::Texture::MIN_FILTER))
+	{
+		case osg::Texture::LINEAR_MIPMAP_LINEAR:
+		case osg::Texture::LINEAR_MIPMAP_NEAREST:
+		case osg::Texture::NEAREST_MIPMAP_LINEAR:
+		case osg::Texture::NEAREST_MIPMAP_NEAREST:
+			bytes += bytes/3;
+			break;
+		default:
+			break;
+	}
+	return bytes;
+}
@@ -0,0 +1,159 @@
+#include <hogbox/NodeNameIndex.h>
+
+#include <algorithm>
+
+using namespace hogbox;
+
+//
+//Records each node (and each geodes drawables) with its traversal order
+//
+class NodeNameIndex::BuildVisitor : public osg::NodeVisitor
+{
+public:
+	BuildVisitor(NodeNameIndex& index)
+		: osg::NodeVisitor(osg::NodeVisitor::TRAVERSE_ALL_CHILDREN),
+		_index(index)
+	{
+		//index hidden nodes too so visibility changes don't stale the index
+		setNodeMaskOverride(0xffffffff);
+	}
+
+	virtual void apply(osg::Node& node)
+	{
+		unsigned int order = _index._numNodes++;
+		_index._nodeNames.insert(NameMap::value_type(node.getName(), IndexedNode(&node, order)));
+
+		osg::Geode* geode = node.asGeode();
+		if(geode){
+			for(unsigned int i=0; i<geode->getNumDrawables(); i++){
+				_index._drawableNames.insert(NameMap::value_type(geode->getDrawable(i)->getName(), IndexedNode(&node, order)));
+			}
+		}
+		traverse(node);
+	}
+
+protected:
+	NodeNameIndex& _index;
+};
+
+NodeNameIndex::NodeNameIndex()
+	: _built(false),
+	_numNodes(0)
+{
+}
+
+//
+//Index every node below and including root
+//
+void NodeNameIndex::Build(osg::Node* root)
+{
+	Clear();
+	_built = true;
+	AddSubgraph(root);
+}
+
+//
+//Add the nodes of another subgraph to the index
+//
+void NodeNameIndex::AddSubgraph(osg::Node* subgraph)
+{
+	if(!subgraph){return;}
+	_subStringCache.clear();
+	BuildVisitor visitor(*this);
+	subgraph->accept(visitor);
+}
+
+void NodeNameIndex::Clear()
+{
+	_built = false;
+	_numNodes = 0;
+	_nodeNames.clear();
+	_drawableNames.clear();
+	_subStringCache.clear();
+}
+
+//
+//Collect the entries of every unique name containing name
+//
+void NodeNameIndex::CollectSubString(const NameMap& names, const std::string& name, IndexedNodeVector& matches)
+{
+	NameMap::const_iterator itr = names.begin();
+	while(itr != names.end())
+	{
+		//test each unique name once then take or skip all its nodes
+		NameMap::const_iterator end = names.upper_bound((*itr).first);
+		bool match = (*itr).first.rfind(name) != std::string::npos;
+		for( ; itr!=end; itr++){
+			if(match){matches.push_back((*itr).second);}
+		}
+	}
+	//back into traversal order
+	std::sort(matches.begin(), matches.end());
+}
+
+//
+//Nodes whose name equals name, or contains name in subString mode
+//
+void NodeNameIndex::FindNodes(const std::string& name, const bool& subString, std::vector<osg::Node*>& found)
+{
+	if(!subString)
+	{
+		//equal keys keep their insertion (traversal) order
+		std::pair<NameMap::const_iterator, NameMap::const_iterator> range = _nodeNames.equal_range(name);
+		for(NameMap::const_iterator itr=range.first; itr!=range.second; itr++){
+			found.push_back((*itr).second._node);
+		}
+		return;
+	}
+
+	std::map<std::string, std::vector<osg::Node*> >::iterator cached = _subStringCache.find(name);
+	if(cached == _subStringCache.end())
+	{
+		IndexedNodeVector matches;
+		CollectSubString(_nodeNames, name, matches);
+
+		cached = _subStringCache.insert(std::pair<std::string, std::vector<osg::Node*> >(name, std::vector<osg::Node*>())).first;
+		std::vector<osg::Node*>& nodes = (*cached).second;
+		nodes.reserve(matches.size());
+		for(unsigned int i=0; i<matches.size(); i++){
+			nodes.push_back(matches[i]._node);
+		}
+	}
+	found.insert(found.end(), (*cached).second.begin(), (*cached).second.end());
+}
+
+//
+//Nodes whose name starts with prefix
+//
+void NodeNameIndex::FindNodesByPrefix(const std::string& prefix, std::vector<osg::Node*>& found)const
+{
+	IndexedNodeVector matches;
+	NameMap::const_iterator itr = _nodeNames.lower_bound(prefix);
+	for( ; itr!=_nodeNames.end(); itr++){
+		if((*itr).first.compare(0, prefix.size(), prefix) != 0){break;}
+		matches.push_back((*itr).second);
+	}
+	std::sort(matches.begin(), matches.end());
+	for(unsigned int i=0; i<matches.size(); i++){
+		found.push_back(matches[i]._node);
+	}
+}
+
+//
+//Geodes holding a drawable whose name equals name, or contains it in subString mode
+//
+void NodeNameIndex::FindGeodesByDrawableName(const std::string& name, const bool& subString, std::vector<osg::Geode*>& found)const
+{
+	IndexedNodeVector matches;
+	if(subString){
+		CollectSubString(_drawableNames, name, matches);
+	}else{
+		std::pair<NameMap::const_iterator, NameMap::const_iterator> range = _drawableNames.equal_range(name);
+		for(NameMap::const_iterator itr=range.first; itr!=range.second; itr++){
+			matches.push_back((*itr).second);
+		}
+	}
+	for(unsigned int i=0; i<matches.size(); i++){
+		found.push_back(static_cast<osg::Geode*>(matches[i]._node));
+	}
+}
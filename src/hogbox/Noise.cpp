@@ -1,12 +1,813 @@
 #include <hogbox/Noise.h>
+#include <hogbox/WorkStealingPool.h>
 #include <osg/Notify>
 #include <osg/ImageUtils>
 
 #include <math.h>
-#include <stdlib.h>
+#include <vector>
+
+//the row blends are done four points at a time with whichever of these the
+//build targets
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define HOGBOX_NOISE_SSE2
+	#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#define HOGBOX_NOISE_NEON
+	#include <arm_neon.h>
+#endif
 
 using namespace hogbox; 
 
+//
+//Gradient tables, the 8 directions to the edges and corners of a square for 2d
+//and the 12 directions to the edges of a cube for 3d (4 repeated to make 16)
+//
+static const float s_gradient2DX[8] = {1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 0.0f, 0.0f};
+static const float s_gradient2DY[8] = {1.0f, 1.0f, -1.0f, -1.0f, 0.0f, 0.0f, 1.0f, -1.0f};
+
+static const float s_gradient3DX[16] = {1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, -1.0f, 0.0f};
+static const float s_gradient3DY[16] = {1.0f, 1.0f, -1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f};
+static const float s_gradient3DZ[16] = {0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, -1.0f, -1.0f, 0.0f, 1.0f, 0.0f, -1.0f};
+
+//the most octaves FractalSettings can ask for
+static const unsigned int s_maxOctaves = 16;
+
+//points sampled per octave by the fractal rows
+static const unsigned int s_fractalRowChunk = 256;
+
+static inline int FastFloor(float x)
+{
+	int i = (int)x;
+	return x < (float)i ? i-1 : i;
+}
+
+//
+//Ken Perlins quintic fade curve, 6t^5 - 15t^4 + 10t^3
+//
+static inline float Fade(float t)
+{
+	return t*t*t*(t*(t*6.0f - 15.0f) + 10.0f);
+}
+
+static inline int WrapLattice(int i, int period)
+{
+	if(period == 256){return i & 255;}
+	int wrapped = i % period;
+	return wrapped < 0 ? wrapped + period : wrapped;
+}
+
+//
+//1d gradient of magnitude 1 to 8 from a hash
+//
+static inline float Gradient1D(int hash, float x)
+{
+	float gradient = 1.0f + (float)(hash & 7);
+	return (hash & 8) ? -gradient*x : gradient*x;
+}
+
+//
+//CellBlend
+//Noise within one lattice cell along a line parallel to x, once the y and z
+//blends are done, is P + fade(fx)*(Q-P) where P and Q are linear in the
+//distance fx across the cell. This holds the two lines so every point in the
+//cell costs a handful of multiply adds
+//
+struct CellBlend
+{
+	float _p0, _p1;
+	float _q0, _q1;
+
+	inline float Evaluate(float fx)const{
+		float u = Fade(fx);
+		float p = _p1*fx + _p0;
+		float q = _q1*fx + _q0;
+		return p + u*(q-p);
+	}
+};
+
+//
+//Evaluate a cell for points begin to end of a row, all of which lie in the
+//cell starting at cellX
+//
+static void EvaluateCellRun(const CellBlend& cell, float* values, unsigned int begin, unsigned int end, float x, float dx, float cellX)
+{
+	unsigned int i = begin;
+#if defined(HOGBOX_NOISE_SSE2)
+	if(end - begin >= 4)
+	{
+		const __m128 p0 = _mm_set1_ps(cell._p0);
+		const __m128 p1 = _mm_set1_ps(cell._p1);
+		const __m128 q0 = _mm_set1_ps(cell._q0);
+		const __m128 q1 = _mm_set1_ps(cell._q1);
+		const __m128 x0 = _mm_set1_ps(x);
+		const __m128 step = _mm_set1_ps(dx);
+		const __m128 origin = _mm_set1_ps(cellX);
+		const __m128 six = _mm_set1_ps(6.0f);
+		const __m128 fifteen = _mm_set1_ps(15.0f);
+		const __m128 ten = _mm_set1_ps(10.0f);
+		__m128 index = _mm_set_ps((float)(i+3), (float)(i+2), (float)(i+1), (float)i);
+		const __m128 four = _mm_set1_ps(4.0f);
+		for(; i+4 <= end; i+=4)
+		{
+			__m128 fx = _mm_sub_ps(_mm_add_ps(x0, _mm_mul_ps(index, step)), origin);
+			__m128 fx3 = _mm_mul_ps(_mm_mul_ps(fx, fx), fx);
+			__m128 u = _mm_mul_ps(fx3, _mm_add_ps(_mm_mul_ps(fx, _mm_sub_ps(_mm_mul_ps(fx, six), fifteen)), ten));
+			__m128 p = _mm_add_ps(_mm_mul_ps(p1, fx), p0);
+			__m128 q = _mm_add_ps(_mm_mul_ps(q1, fx), q0);
+			_mm_storeu_ps(values+i, _mm_add_ps(p, _mm_mul_ps(u, _mm_sub_ps(q, p))));
+			index = _mm_add_ps(index, four);
+		}
+	}
+#elif defined(HOGBOX_NOISE_NEON)
+	if(end - begin >= 4)
+	{
+		const float32x4_t p0 = vdupq_n_f32(cell._p0);
+		const float32x4_t p1 = vdupq_n_f32(cell._p1);
+		const float32x4_t q0 = vdupq_n_f32(cell._q0);
+		const float32x4_t q1 = vdupq_n_f32(cell._q1);
+		const float32x4_t x0 = vdupq_n_f32(x);
+		const float32x4_t step = vdupq_n_f32(dx);
+		const float32x4_t origin = vdupq_n_f32(cellX);
+		const float32x4_t six = vdupq_n_f32(6.0f);
+		const float32x4_t fifteen = vdupq_n_f32(15.0f);
+		const float32x4_t ten = vdupq_n_f32(10.0f);
+		const float laneIndex[4] = {(float)i, (float)(i+1), (float)(i+2), (float)(i+3)};
+		float32x4_t index = vld1q_f32(laneIndex);
+		const float32x4_t four = vdupq_n_f32(4.0f);
+		for(; i+4 <= end; i+=4)
+		{
+			float32x4_t fx = vsubq_f32(vaddq_f32(x0, vmulq_f32(index, step)), origin);
+			float32x4_t fx3 = vmulq_f32(vmulq_f32(fx, fx), fx);
+			float32x4_t u = vmulq_f32(fx3, vaddq_f32(vmulq_f32(fx, vsubq_f32(vmulq_f32(fx, six), fifteen)), ten));
+			float32x4_t p = vaddq_f32(vmulq_f32(p1, fx), p0);
+			float32x4_t q = vaddq_f32(vmulq_f32(q1, fx), q0);
+			vst1q_f32(values+i, vaddq_f32(p, vmulq_f32(u, vsubq_f32(q, p))));
+			index = vaddq_f32(index, four);
+		}
+	}
+#endif
+	for(; i<end; i++){
+		values[i] = cell.Evaluate((x + (float)i*dx) - cellX);
+	}
+}
+
+//
+//Index one past the last point of a row, from begin, in lattice cell cellX
+//
+static unsigned int FindCellEnd(unsigned int begin, unsigned int count, float x, float dx, int cellX)
+{
+	if(dx <= 0.0f){
+		return dx == 0.0f ? count : begin+1;
+	}
+
+	//estimate from the distance to the next cell then correct for rounding
+	double estimate = (double)begin + ((double)(cellX+1) - ((double)x + (double)begin*(double)dx))/(double)dx;
+	unsigned int end = estimate >= (double)count ? count : (estimate <= (double)(begin+1) ? begin+1 : (unsigned int)estimate);
+	while(end > begin+1 && FastFloor(x + (float)(end-1)*dx) > cellX){end--;}
+	while(end < count && FastFloor(x + (float)end*dx) <= cellX){end++;}
+	return end;
+}
+
+NoiseGenerator::NoiseGenerator(NoiseType type, unsigned int seed)
+	: _type(type),
+	_seed(seed)
+{
+	SetSeed(seed);
+}
+
+//
+//Shuffle the permutation table and pick the lattice values
+//
+void NoiseGenerator::SetSeed(unsigned int seed)
+{
+	_seed = seed;
+
+	Random random(seed);
+	for(unsigned int i=0; i<256; i++){
+		_perm[i] = (unsigned char)i;
+	}
+	for(unsigned int i=255; i>0; i--){
+		unsigned int j = (unsigned int)random.NextInt(0, (int)i);
+		unsigned char temp = _perm[i];
+		_perm[i] = _perm[j];
+		_perm[j] = temp;
+	}
+	for(unsigned int i=0; i<256; i++){
+		_perm[i+256] = _perm[i];
+	}
+	random.Fill(_values, 256, -1.0f, 1.0f);
+}
+
+float NoiseGenerator::Sample(float x)const
+{
+	return Sample1D(x, 256);
+}
+
+float NoiseGenerator::Sample(float x, float y)const
+{
+	return Sample2D(x, y, 256, 256);
+}
+
+float NoiseGenerator::Sample(float x, float y, float z)const
+{
+	return Sample3D(x, y, z, 256, 256, 256);
+}
+
+float NoiseGenerator::Fractal(float x, const FractalSettings& settings)const
+{
+	float frequencies[s_maxOctaves];
+	float weights[s_maxOctaves];
+	int periods[s_maxOctaves];
+	unsigned int octaves = GetOctaves(settings, frequencies, weights, periods);
+
+	float sum = 0.0f;
+	for(unsigned int i=0; i<octaves; i++){
+		sum += weights[i] * Sample1D(x*frequencies[i], periods[i]);
+	}
+	return sum;
+}
+
+float NoiseGenerator::Fractal(float x, float y, const FractalSettings& settings)const
+{
+	float frequencies[s_maxOctaves];
+	float weights[s_maxOctaves];
+	int periods[s_maxOctaves];
+	unsigned int octaves = GetOctaves(settings, frequencies, weights, periods);
+
+	float sum = 0.0f;
+	for(unsigned int i=0; i<octaves; i++){
+		sum += weights[i] * Sample2D(x*frequencies[i], y*frequencies[i], periods[i], periods[i]);
+	}
+	return sum;
+}
+
+float NoiseGenerator::Fractal(float x, float y, float z, const FractalSettings& settings)const
+{
+	float frequencies[s_maxOctaves];
+	float weights[s_maxOctaves];
+	int periods[s_maxOctaves];
+	unsigned int octaves = GetOctaves(settings, frequencies, weights, periods);
+
+	float sum = 0.0f;
+	for(unsigned int i=0; i<octaves; i++){
+		sum += weights[i] * Sample3D(x*frequencies[i], y*frequencies[i], z*frequencies[i], periods[i], periods[i], periods[i]);
+	}
+	return sum;
+}
+
+void NoiseGenerator::SampleRow(float* values, unsigned int count, float x, float dx, float y)const
+{
+	SampleRow2D(values, count, x, dx, y, 256, 256);
+}
+
+void NoiseGenerator::SampleRow(float* values, unsigned int count, float x, float dx, float y, float z)const
+{
+	SampleRow3D(values, count, x, dx, y, z, 256, 256, 256);
+}
+
+//
+//Sum the octaves a chunk of the row at a time
+//
+void NoiseGenerator::FractalRow(float* values, unsigned int count, float x, float dx, float y, const FractalSettings& settings)const
+{
+	float frequencies[s_maxOctaves];
+	float weights[s_maxOctaves];
+	int periods[s_maxOctaves];
+	unsigned int octaves = GetOctaves(settings, frequencies, weights, periods);
+
+	float octave[s_fractalRowChunk];
+	for(unsigned int start=0; start<count; start+=s_fractalRowChunk)
+	{
+		unsigned int length = count-start < s_fractalRowChunk ? count-start : s_fractalRowChunk;
+		float* chunk = values+start;
+		float chunkX = x + (float)start*dx;
+		for(unsigned int i=0; i<octaves; i++)
+		{
+			float f = frequencies[i];
+			SampleRow2D(octave, length, chunkX*f, dx*f, y*f, periods[i], periods[i]);
+			float w = weights[i];
+			if(i == 0){
+				for(unsigned int j=0; j<length; j++){chunk[j] = w*octave[j];}
+			}else{
+				for(unsigned int j=0; j<length; j++){chunk[j] += w*octave[j];}
+			}
+		}
+	}
+}
+
+void NoiseGenerator::FractalRow(float* values, unsigned int count, float x, float dx, float y, float z, const FractalSettings& settings)const
+{
+	float frequencies[s_maxOctaves];
+	float weights[s_maxOctaves];
+	int periods[s_maxOctaves];
+	unsigned int octaves = GetOctaves(settings, frequencies, weights, periods);
+
+	float octave[s_fractalRowChunk];
+	for(unsigned int start=0; start<count; start+=s_fractalRowChunk)
+	{
+		unsigned int length = count-start < s_fractalRowChunk ? count-start : s_fractalRowChunk;
+		float* chunk = values+start;
+		float chunkX = x + (float)start*dx;
+		for(unsigned int i=0; i<octaves; i++)
+		{
+			float f = frequencies[i];
+			SampleRow3D(octave, length, chunkX*f, dx*f, y*f, z*f, periods[i], periods[i], periods[i]);
+			float w = weights[i];
+			if(i == 0){
+				for(unsigned int j=0; j<length; j++){chunk[j] = w*octave[j];}
+			}else{
+				for(unsigned int j=0; j<length; j++){chunk[j] += w*octave[j];}
+			}
+		}
+	}
+}
+
+float NoiseGenerator::Sample1D(float x, int period)const
+{
+	if(_type == SIMPLEX_NOISE){return SimplexNoise1D(x);}
+
+	int cellX = FastFloor(x);
+	float fx = x - (float)cellX;
+	int x0 = WrapLattice(cellX, period);
+	int x1 = WrapLattice(cellX+1, period);
+	float u = Fade(fx);
+
+	if(_type == VALUE_NOISE){
+		float a = _values[_perm[x0]];
+		float b = _values[_perm[x1]];
+		return a + u*(b-a);
+	}
+
+	//gradients up to 8 give a range of about -4 to 4
+	float a = Gradient1D(_perm[x0], fx);
+	float b = Gradient1D(_perm[x1], fx-1.0f);
+	return 0.25f*(a + u*(b-a));
+}
+
+//
+//Blend the y edges of the cell at (x0,y0) into the lines along x
+//
+static inline void BlendCell2D(CellBlend& cell, bool value, const unsigned char* perm, const float* lattice, int x0, int x1, int y0, int y1, float fy, float v)
+{
+	int h00 = perm[perm[x0]+y0];
+	int h10 = perm[perm[x1]+y0];
+	int h01 = perm[perm[x0]+y1];
+	int h11 = perm[perm[x1]+y1];
+
+	if(value)
+	{
+		cell._p1 = cell._q1 = 0.0f;
+		cell._p0 = lattice[h00] + v*(lattice[h01]-lattice[h00]);
+		cell._q0 = lattice[h10] + v*(lattice[h11]-lattice[h10]);
+		return;
+	}
+
+	//each corner is g.x*(fx-cornerX) + g.y*(fy-cornerY)
+	float fy1 = fy-1.0f;
+	float iv = 1.0f-v;
+	h00 &= 7; h10 &= 7; h01 &= 7; h11 &= 7;
+	cell._p1 = iv*s_gradient2DX[h00] + v*s_gradient2DX[h01];
+	cell._p0 = iv*s_gradient2DY[h00]*fy + v*s_gradient2DY[h01]*fy1;
+	cell._q1 = iv*s_gradient2DX[h10] + v*s_gradient2DX[h11];
+	cell._q0 = iv*(s_gradient2DY[h10]*fy - s_gradient2DX[h10]) + v*(s_gradient2DY[h11]*fy1 - s_gradient2DX[h11]);
+}
+
+//
+//Blend the y and z edges of the cell at (x0,y0,z0) into the lines along x
+//
+static inline void BlendCell3D(CellBlend& cell, bool value, const unsigned char* perm, const float* lattice, int x0, int x1, int y0, int y1, int z0, int z1,
+								float fy, float fz, float v, float w)
+{
+	int hx0 = perm[x0];
+	int hx1 = perm[x1];
+	int h[2][4] = {
+		{perm[perm[hx0+y0]+z0], perm[perm[hx0+y1]+z0], perm[perm[hx0+y0]+z1], perm[perm[hx0+y1]+z1]},
+		{perm[perm[hx1+y0]+z0], perm[perm[hx1+y1]+z0], perm[perm[hx1+y0]+z1], perm[perm[hx1+y1]+z1]}
+	};
+	//weight of the (y0,z0), (y1,z0), (y0,z1) and (y1,z1) edges
+	float weights[4] = {(1.0f-v)*(1.0f-w), v*(1.0f-w), (1.0f-v)*w, v*w};
+
+	if(value)
+	{
+		cell._p1 = cell._q1 = 0.0f;
+		cell._p0 = cell._q0 = 0.0f;
+		for(unsigned int e=0; e<4; e++){
+			cell._p0 += weights[e]*lattice[h[0][e]];
+			cell._q0 += weights[e]*lattice[h[1][e]];
+		}
+		return;
+	}
+
+	float fys[4] = {fy, fy-1.0f, fy, fy-1.0f};
+	float fzs[4] = {fz, fz, fz-1.0f, fz-1.0f};
+	cell._p1 = cell._p0 = cell._q1 = cell._q0 = 0.0f;
+	for(unsigned int e=0; e<4; e++)
+	{
+		int g0 = h[0][e] & 15;
+		int g1 = h[1][e] & 15;
+		cell._p1 += weights[e]*s_gradient3DX[g0];
+		cell._p0 += weights[e]*(s_gradient3DY[g0]*fys[e] + s_gradient3DZ[g0]*fzs[e]);
+		cell._q1 += weights[e]*s_gradient3DX[g1];
+		cell._q0 += weights[e]*(s_gradient3DY[g1]*fys[e] + s_gradient3DZ[g1]*fzs[e] - s_gradient3DX[g1]);
+	}
+}
+
+float NoiseGenerator::Sample2D(float x, float y, int periodX, int periodY)const
+{
+	if(_type == SIMPLEX_NOISE){return SimplexNoise2D(x, y);}
+
+	int cellX = FastFloor(x);
+	int cellY = FastFloor(y);
+	float fy = y - (float)cellY;
+
+	CellBlend cell;
+	BlendCell2D(cell, _type == VALUE_NOISE, _perm, _values,
+				WrapLattice(cellX, periodX), WrapLattice(cellX+1, periodX),
+				WrapLattice(cellY, periodY), WrapLattice(cellY+1, periodY), fy, Fade(fy));
+	return cell.Evaluate(x - (float)cellX);
+}
+
+float NoiseGenerator::Sample3D(float x, float y, float z, int periodX, int periodY, int periodZ)const
+{
+	if(_type == SIMPLEX_NOISE){return SimplexNoise3D(x, y, z);}
+
+	int cellX = FastFloor(x);
+	int cellY = FastFloor(y);
+	int cellZ = FastFloor(z);
+	float fy = y - (float)cellY;
+	float fz = z - (float)cellZ;
+
+	CellBlend cell;
+	BlendCell3D(cell, _type == VALUE_NOISE, _perm, _values,
+				WrapLattice(cellX, periodX), WrapLattice(cellX+1, periodX),
+				WrapLattice(cellY, periodY), WrapLattice(cellY+1, periodY),
+				WrapLattice(cellZ, periodZ), WrapLattice(cellZ+1, periodZ),
+				fy, fz, Fade(fy), Fade(fz));
+	return cell.Evaluate(x - (float)cellX);
+}
+
+//
+//Walk the row a lattice cell at a time
+//
+void NoiseGenerator::SampleRow2D(float* values, unsigned int count, float x, float dx, float y, int periodX, int periodY)const
+{
+	if(_type == SIMPLEX_NOISE){
+		for(unsigned int i=0; i<count; i++){
+			values[i] = SimplexNoise2D(x + (float)i*dx, y);
+		}
+		return;
+	}
+
+	int cellY = FastFloor(y);
+	float fy = y - (float)cellY;
+	float v = Fade(fy);
+	int y0 = WrapLattice(cellY, periodY);
+	int y1 = WrapLattice(cellY+1, periodY);
+
+	unsigned int begin = 0;
+	while(begin < count)
+	{
+		int cellX = FastFloor(x + (float)begin*dx);
+		unsigned int end = FindCellEnd(begin, count, x, dx, cellX);
+
+		CellBlend cell;
+		BlendCell2D(cell, _type == VALUE_NOISE, _perm, _values,
+					WrapLattice(cellX, periodX), WrapLattice(cellX+1, periodX), y0, y1, fy, v);
+		EvaluateCellRun(cell, values, begin, end, x, dx, (float)cellX);
+		begin = end;
+	}
+}
+
+void NoiseGenerator::SampleRow3D(float* values, unsigned int count, float x, float dx, float y, float z, int periodX, int periodY, int periodZ)const
+{
+	if(_type == SIMPLEX_NOISE){
+		for(unsigned int i=0; i<count; i++){
+			values[i] = SimplexNoise3D(x + (float)i*dx, y, z);
+		}
+		return;
+	}
+
+	int cellY = FastFloor(y);
+	int cellZ = FastFloor(z);
+	float fy = y - (float)cellY;
+	float fz = z - (float)cellZ;
+	float v = Fade(fy);
+	float w = Fade(fz);
+	int y0 = WrapLattice(cellY, periodY);
+	int y1 = WrapLattice(cellY+1, periodY);
+	int z0 = WrapLattice(cellZ, periodZ);
+	int z1 = WrapLattice(cellZ+1, periodZ);
+
+	unsigned int begin = 0;
+	while(begin < count)
+	{
+		int cellX = FastFloor(x + (float)begin*dx);
+		unsigned int end = FindCellEnd(begin, count, x, dx, cellX);
+
+		CellBlend cell;
+		BlendCell3D(cell, _type == VALUE_NOISE, _perm, _values,
+					WrapLattice(cellX, periodX), WrapLattice(cellX+1, periodX), y0, y1, z0, z1, fy, fz, v, w);
+		EvaluateCellRun(cell, values, begin, end, x, dx, (float)cellX);
+		begin = end;
+	}
+}
+
+//
+//Frequency, normalised weight and lattice period of each octave
+//
+unsigned int NoiseGenerator::GetOctaves(const FractalSettings& settings, float* frequencies, float* weights, int* periods)const
+{
+	unsigned int octaves = settings._octaves;
+	if(octaves < 1){octaves = 1;}
+	if(octaves > s_maxOctaves){octaves = s_maxOctaves;}
+
+	bool tiled = settings._tileSize > 0.0f && _type != SIMPLEX_NOISE;
+
+	float frequency = settings._frequency;
+	float weight = 1.0f;
+	float totalWeight = 0.0f;
+	for(unsigned int i=0; i<octaves; i++)
+	{
+		frequencies[i] = frequency;
+		periods[i] = 256;
+		if(tiled)
+		{
+			//a whole number of cells per tile, the table repeats after 256
+			int cells = (int)floorf(settings._tileSize*frequency + 0.5f);
+			if(cells < 1){cells = 1;}
+			if(cells > 256){cells = 256;}
+			frequencies[i] = (float)cells/settings._tileSize;
+			periods[i] = cells;
+		}
+		weights[i] = weight;
+		totalWeight += weight;
+
+		frequency *= settings._lacunarity;
+		weight *= settings._gain;
+	}
+
+	if(totalWeight > 0.0f){
+		for(unsigned int i=0; i<octaves; i++){
+			weights[i] /= totalWeight;
+		}
+	}
+	return octaves;
+}
+
+//
+//Simplex noise after Stefan Gustavsons "Simplex noise demystified"
+//
+float NoiseGenerator::SimplexNoise1D(float x)const
+{
+	int cellX = FastFloor(x);
+	float x0 = x - (float)cellX;
+	float x1 = x0 - 1.0f;
+
+	float t0 = 1.0f - x0*x0;
+	t0 *= t0;
+	float n0 = t0*t0*Gradient1D(_perm[cellX & 255], x0);
+
+	float t1 = 1.0f - x1*x1;
+	t1 *= t1;
+	float n1 = t1*t1*Gradient1D(_perm[(cellX+1) & 255], x1);
+
+	return 0.395f*(n0 + n1);
+}
+
+float NoiseGenerator::SimplexNoise2D(float x, float y)const
+{
+	const float F2 = 0.366025403f; //(sqrt(3)-1)/2
+	const float G2 = 0.211324865f; //(3-sqrt(3))/6
+
+	//skew to find the simplex cell
+	float s = (x+y)*F2;
+	int i = FastFloor(x+s);
+	int j = FastFloor(y+s);
+	float t = (float)(i+j)*G2;
+	float x0 = x - ((float)i - t);
+	float y0 = y - ((float)j - t);
+
+	//which of the two triangles of the cell
+	int i1 = x0 > y0 ? 1 : 0;
+	int j1 = 1 - i1;
+
+	float x1 = x0 - (float)i1 + G2;
+	float y1 = y0 - (float)j1 + G2;
+	float x2 = x0 - 1.0f + 2.0f*G2;
+	float y2 = y0 - 1.0f + 2.0f*G2;
+
+	int ii = i & 255;
+	int jj = j & 255;
+	int g0 = _perm[ii + _perm[jj]] & 7;
+	int g1 = _perm[ii + i1 + _perm[jj + j1]] & 7;
+	int g2 = _perm[ii + 1 + _perm[jj + 1]] & 7;
+
+	float n = 0.0f;
+	float t0 = 0.5f - x0*x0 - y0*y0;
+	if(t0 > 0.0f){
+		t0 *= t0;
+		n += t0*t0*(s_gradient2DX[g0]*x0 + s_gradient2DY[g0]*y0);
+	}
+	float t1 = 0.5f - x1*x1 - y1*y1;
+	if(t1 > 0.0f){
+		t1 *= t1;
+		n += t1*t1*(s_gradient2DX[g1]*x1 + s_gradient2DY[g1]*y1);
+	}
+	float t2 = 0.5f - x2*x2 - y2*y2;
+	if(t2 > 0.0f){
+		t2 *= t2;
+		n += t2*t2*(s_gradient2DX[g2]*x2 + s_gradient2DY[g2]*y2);
+	}
+	return 70.0f*n;
+}
+
+float NoiseGenerator::SimplexNoise3D(float x, float y, float z)const
+{
+	const float F3 = 1.0f/3.0f;
+	const float G3 = 1.0f/6.0f;
+
+	float s = (x+y+z)*F3;
+	int i = FastFloor(x+s);
+	int j = FastFloor(y+s);
+	int k = FastFloor(z+s);
+	float t = (float)(i+j+k)*G3;
+	float x0 = x - ((float)i - t);
+	float y0 = y - ((float)j - t);
+	float z0 = z - ((float)k - t);
+
+	//which of the six tetrahedra of the cell
+	int i1, j1, k1, i2, j2, k2;
+	if(x0 >= y0){
+		if(y0 >= z0){i1=1; j1=0; k1=0; i2=1; j2=1; k2=0;}
+		else if(x0 >= z0){i1=1; j1=0; k1=0; i2=1; j2=0; k2=1;}
+		else{i1=0; j1=0; k1=1; i2=1; j2=0; k2=1;}
+	}else{
+		if(y0 < z0){i1=0; j1=0; k1=1; i2=0; j2=1; k2=1;}
+		else if(x0 < z0){i1=0; j1=1; k1=0; i2=0; j2=1; k2=1;}
+		else{i1=0; j1=1; k1=0; i2=1; j2=1; k2=0;}
+	}
+
+	float x1 = x0 - (float)i1 + G3;
+	float y1 = y0 - (float)j1 + G3;
+	float z1 = z0 - (float)k1 + G3;
+	float x2 = x0 - (float)i2 + 2.0f*G3;
+	float y2 = y0 - (float)j2 + 2.0f*G3;
+	float z2 = z0 - (float)k2 + 2.0f*G3;
+	float x3 = x0 - 1.0f + 3.0f*G3;
+	float y3 = y0 - 1.0f + 3.0f*G3;
+	float z3 = z0 - 1.0f + 3.0f*G3;
+
+	int ii = i & 255;
+	int jj = j & 255;
+	int kk = k & 255;
+	int g0 = _perm[ii + _perm[jj + _perm[kk]]] & 15;
+	int g1 = _perm[ii + i1 + _perm[jj + j1 + _perm[kk + k1]]] & 15;
+	int g2 = _perm[ii + i2 + _perm[jj + j2 + _perm[kk + k2]]] & 15;
+	int g3 = _perm[ii + 1 + _perm[jj + 1 + _perm[kk + 1]]] & 15;
+
+	float n = 0.0f;
+	float t0 = 0.6f - x0*x0 - y0*y0 - z0*z0;
+	if(t0 > 0.0f){
+		t0 *= t0;
+		n += t0*t0*(s_gradient3DX[g0]*x0 + s_gradient3DY[g0]*y0 + s_gradient3DZ[g0]*z0);
+	}
+	float t1 = 0.6f - x1*x1 - y1*y1 - z1*z1;
+	if(t1 > 0.0f){
+		t1 *= t1;
+		n += t1*t1*(s_gradient3DX[g1]*x1 + s_gradient3DY[g1]*y1 + s_gradient3DZ[g1]*z1);
+	}
+	float t2 = 0.6f - x2*x2 - y2*y2 - z2*z2;
+	if(t2 > 0.0f){
+		t2 *= t2;
+		n += t2*t2*(s_gradient3DX[g2]*x2 + s_gradient3DY[g2]*y2 + s_gradient3DZ[g2]*z2);
+	}
+	float t3 = 0.6f - x3*x3 - y3*y3 - z3*z3;
+	if(t3 > 0.0f){
+		t3 *= t3;
+		n += t3*t3*(s_gradient3DX[g3]*x3 + s_gradient3DY[g3]*y3 + s_gradient3DZ[g3]*z3);
+	}
+	return 32.0f*n;
+}
+
+//
+//Fill rows begin to end of an image, counting down the slices
+//
+static void FillNoiseImageRows(osg::Image* image, const NoiseGenerator& noise, const FractalSettings& settings, unsigned int begin, unsigned int end)
+{
+	unsigned int width = image->s();
+	unsigned int height = image->t();
+	unsigned int depth = image->r();
+	unsigned int components = osg::Image::computeNumComponents(image->getPixelFormat());
+	bool floats = image->getDataType() == GL_FLOAT;
+
+	std::vector<float> row(width);
+	float dx = 1.0f/(float)width;
+	for(unsigned int index=begin; index<end; index++)
+	{
+		unsigned int t = index % height;
+		unsigned int r = index / height;
+		float y = (float)t/(float)height;
+		if(depth > 1){
+			noise.FractalRow(&row[0], width, 0.0f, dx, y, (float)r/(float)depth, settings);
+		}else{
+			noise.FractalRow(&row[0], width, 0.0f, dx, y, settings);
+		}
+
+		if(floats)
+		{
+			float* pixel = (float*)image->data(0, t, r);
+			for(unsigned int s=0; s<width; s++){
+				float value = row[s]*0.5f + 0.5f;
+				for(unsigned int c=0; c<components; c++){*pixel++ = value;}
+			}
+		}else{
+			unsigned char* pixel = image->data(0, t, r);
+			for(unsigned int s=0; s<width; s++){
+				float value = row[s]*127.5f + 128.0f;
+				unsigned char byte = value <= 0.0f ? 0 : (value >= 255.0f ? 255 : (unsigned char)value);
+				for(unsigned int c=0; c<components; c++){*pixel++ = byte;}
+			}
+		}
+	}
+}
+
+//
+//Fills a batch of image rows on a pool thread
+//
+class NoiseImageTask : public PoolTask
+{
+public:
+	NoiseImageTask(osg::Image* image, const NoiseGenerator& noise, const FractalSettings& settings, unsigned int begin, unsigned int end)
+		: PoolTask(),
+		p_image(image),
+		_noise(noise),
+		_settings(settings),
+		_begin(begin),
+		_end(end)
+	{
+	}
+	virtual void Run(){
+		FillNoiseImageRows(p_image, _noise, _settings, _begin, _end);
+	}
+protected:
+	virtual ~NoiseImageTask(void){}
+protected:
+	osg::Image* p_image;
+	const NoiseGenerator& _noise;
+	FractalSettings _settings;
+	unsigned int _begin;
+	unsigned int _end;
+};
+
+bool hogbox::FillNoiseImage(osg::Image* image, const NoiseGenerator& noise, const FractalSettings& settings, WorkStealingPool* pool)
+{
+	if(!image || !image->data()){return false;}
+	if(image->getDataType() != GL_UNSIGNED_BYTE && image->getDataType() != GL_FLOAT){
+		OSG_WARN << "hogbox::FillNoiseImage: ERROR: Only GL_UNSIGNED_BYTE and GL_FLOAT images can be filled with noise." << std::endl;
+		return false;
+	}
+	if(settings._tileSize > 0.0f && noise.GetType() == NoiseGenerator::SIMPLEX_NOISE){
+		OSG_WARN << "hogbox::FillNoiseImage: WARN: Simplex noise can't tile, the image won't tile." << std::endl;
+	}
+
+	unsigned int numRows = image->t()*image->r();
+	if(pool)
+	{
+		//batches of around 16k pixels
+		unsigned int batchRows = 16384/image->s();
+		if(batchRows < 1){batchRows = 1;}
+		osg::ref_ptr<TaskGroup> group = new TaskGroup();
+		for(unsigned int begin=0; begin<numRows; begin+=batchRows){
+			unsigned int end = begin+batchRows < numRows ? begin+batchRows : numRows;
+			pool->Submit(new NoiseImageTask(image, noise, settings, begin, end), group.get());
+		}
+		pool->Wait(group.get());
+	}else{
+		FillNoiseImageRows(image, noise, settings, 0, numRows);
+	}
+
+	image->dirty();
+	return true;
+}
+
+osg::ref_ptr<osg::Image> hogbox::CreateNoiseImage2D(const int& width, const int& height, GLenum pixelFormat,
+													const NoiseGenerator& noise, const FractalSettings& settings,
+													WorkStealingPool* pool)
+{
+	return CreateNoiseImage3D(width, height, 1, pixelFormat, noise, settings, pool);
+}
+
+osg::ref_ptr<osg::Image> hogbox::CreateNoiseImage3D(const int& width, const int& height, const int& depth, GLenum pixelFormat,
+													const NoiseGenerator& noise, const FractalSettings& settings,
+													WorkStealingPool* pool)
+{
+	osg::ref_ptr<osg::Image> image = new osg::Image();
+	image->allocateImage(width, height, depth, pixelFormat, GL_UNSIGNED_BYTE, 1);
+
+	FillNoiseImage(image.get(), noise, settings, pool);
+	return image;
+}
+
 //operators for osg imageutils modify image func
 
 //
@@ -15,31 +816,34 @@ using namespace hogbox;
 //
 struct GenerateBinaryNoiseOperator
 {
-	GenerateBinaryNoiseOperator(const float& c1, const float& c2, const unsigned int& seed=-1)
+	GenerateBinaryNoiseOperator(const float& c1, const float& c2, const int& seed=-1)
 	{
-		hogbox::SetSeed(seed);
+		SeedRandom(seed);
 		_color1 = osg::Vec4(c1,c1,c1,c1);
 		_color2 = osg::Vec4(c2,c2,c2,c2);
 	}
-	GenerateBinaryNoiseOperator(const osg::Vec3& c1, const osg::Vec3& c2, const unsigned int& seed=-1)
+	GenerateBinaryNoiseOperator(const osg::Vec3& c1, const osg::Vec3& c2, const int& seed=-1)
 	{
-		hogbox::SetSeed(seed);
+		SeedRandom(seed);
 		_color1 = osg::Vec4(c1, 1.0f);
 		_color2 = osg::Vec4(c2, 1.0f);
 	}
-	GenerateBinaryNoiseOperator(const osg::Vec4& c1, const osg::Vec4& c2, const unsigned int& seed=-1)
+	GenerateBinaryNoiseOperator(const osg::Vec4& c1, const osg::Vec4& c2, const int& seed=-1)
 	{
-		hogbox::SetSeed(seed);
+		SeedRandom(seed);
 		_color1 = c1;
 		_color2 = c2;
 	}
 	
-	//generate the noise for this pixel, the noise value is then used
-	//as a threshold mask to use either color1 or color2,
-	inline osg::Vec4 genNoiseColor()const{
+	//a negative seed continues from the calling threads generator
+	void SeedRandom(const int& seed){
+		_random.Seed(seed >= 0 ? (unsigned int)seed : hogbox::GetThreadRandom().NextUInt());
+	}
 	
-		float noisy = hogbox::RandFloat(0.0f, 1.0f);
-		if(noisy >= 0.5f)
+	//generate the noise for this pixel, the top random bit picks
+	//either color1 or color2,
+	inline const osg::Vec4& genNoiseColor()const{
+		if(_random.NextUInt() & 0x80000000u)
 		{
 			return _color2;
 		}
@@ -49,26 +853,28 @@ struct GenerateBinaryNoiseOperator
 	inline void luminance(float& l) const {l = genNoiseColor().x(); } 
 	inline void alpha(float& a) const { a = genNoiseColor().a(); } 
 	inline void luminance_alpha(float& l,float& a) const {
-		osg::Vec4 noisy = genNoiseColor();
+		const osg::Vec4& noisy = genNoiseColor();
 		l = noisy.x(); a = noisy.a(); 
 	}
 	inline void rgb(float& r,float& g,float& b) const {
-		osg::Vec4 noisy = genNoiseColor();
+		const osg::Vec4& noisy = genNoiseColor();
 		r = noisy.r(); g = noisy.g(); b = noisy.b(); 
 	}
 	inline void rgba(float& r,float& g,float& b,float& a) const {
-		osg::Vec4 noisy = genNoiseColor();
+		const osg::Vec4& noisy = genNoiseColor();
 		r = noisy.r(); g = noisy.g(); b = noisy.b(); a = noisy.a(); 
 	}
 	
 	osg::Vec4 _color1;
 	osg::Vec4 _color2;
+	//the operators are passed by const reference
+	mutable hogbox::Random _random;
 };
 
 
 osg::ref_ptr<osg::Image> hogbox::CreateGreyScaleBinaryNoiseImage2D(const int& width, const int& height,
 																	const float& color1, const float& color2,
-																	const unsigned int& seed)
+																	const int& seed)
 {
 	osg::ref_ptr<osg::Image> image = new osg::Image();
 	
@@ -81,7 +887,7 @@ osg::ref_ptr<osg::Image> hogbox::CreateGreyScaleBinaryNoiseImage2D(const int& wi
 
 osg::ref_ptr<osg::Image> hogbox::CreateRGBBinaryNoiseImage2D(const int& width, const int& height,
 															 const osg::Vec3& color1, const osg::Vec3& color2,
-															 const unsigned int& seed)
+															 const int& seed)
 {
 	osg::ref_ptr<osg::Image> image = new osg::Image();
 	
@@ -95,7 +901,7 @@ osg::ref_ptr<osg::Image> hogbox::CreateRGBBinaryNoiseImage2D(const int& width, c
 
 osg::ref_ptr<osg::Image> hogbox::CreateRGBABinaryNoiseImage2D(const int& width, const int& height, 
 															 const osg::Vec4& color1, const osg::Vec4& color2,
-															 const unsigned int& seed)
+															 const int& seed)
 {
 	osg::ref_ptr<osg::Image> image = new osg::Image();
 	
@@ -109,7 +915,7 @@ osg::ref_ptr<osg::Image> hogbox::CreateRGBABinaryNoiseImage2D(const int& width,
 
 bool hogbox::FillGreyScaleBinaryNoiseImage2D(osg::Image* image,
 											const float& color1, const float& color2,
-											const unsigned int& seed)
+											const int& seed)
 {
 	if(!image){return false;}
 	if(image->getPixelFormat() != GL_LUMINANCE){return false;}
@@ -119,7 +925,7 @@ bool hogbox::FillGreyScaleBinaryNoiseImage2D(osg::Image* image,
 }
 bool hogbox::FillRGBBinaryNoiseImage2D(osg::Image* image, 
 									  const osg::Vec3& color1, const osg::Vec3& color2,
-									  const unsigned int& seed)
+									  const int& seed)
 {
 	if(!image){return false;}
 	if(image->getPixelFormat() != GL_RGB){return false;}
@@ -130,7 +936,7 @@ bool hogbox::FillRGBBinaryNoiseImage2D(osg::Image* image,
 
 bool hogbox::FillRGBABinaryNoiseImage2D(osg::Image* image, 
 									   const osg::Vec4& color1, const osg::Vec4& color2,
-									   const unsigned int& seed)
+									   const int& seed)
 {
 	if(!image){return false;}
 	if(image->getPixelFormat() != GL_RGBA){return false;}
@@ -0,0 +1,86 @@
+#include <hogbox/PresentationClock.h>
+
+using namespace hogbox;
+
+PresentationClock::PresentationClock()
+	: osg::Referenced(),
+	_source(TIMER_TIME),
+	_startTick(osg::Timer::instance()->tick()),
+	_frameTime(0.0),
+	_frameInterval(0.0),
+	_frameNumber(0),
+	_offset(0.0),
+	_paused(false),
+	_pausedTime(0.0)
+{
+}
+
+PresentationClock::~PresentationClock()
+{
+}
+
+//
+//Change where the time comes from, keeping the presentation time continuous
+//
+void PresentationClock::SetTimeSource(const TimeSource& source)
+{
+	if(source == _source){return;}
+	double time = GetTime();
+	_source = source;
+	SetTime(time);
+}
+
+//
+//Latch the frame time for FRAME_TIME
+//
+void PresentationClock::BeginFrame(double frameTime)
+{
+	if(_frameNumber > 0){
+		_frameInterval = frameTime - _frameTime;
+	}else if(_source == FRAME_TIME){
+		//first frame, start presenting from the current time
+		double time = GetTime();
+		_frameTime = frameTime;
+		SetTime(time);
+	}
+	_frameTime = frameTime;
+	_frameNumber++;
+}
+
+double PresentationClock::GetSourceTime()const
+{
+	if(_source == FRAME_TIME){return _frameTime;}
+	return osg::Timer::instance()->delta_s(_startTick, osg::Timer::instance()->tick());
+}
+
+//
+//Presentation time in seconds, stops while paused
+//
+double PresentationClock::GetTime()const
+{
+	if(_paused){return _pausedTime;}
+	return GetSourceTime() - _offset;
+}
+
+void PresentationClock::SetTime(double time)
+{
+	if(_paused){
+		_pausedTime = time;
+	}else{
+		_offset = GetSourceTime() - time;
+	}
+}
+
+void PresentationClock::Pause()
+{
+	if(_paused){return;}
+	_pausedTime = GetTime();
+	_paused = true;
+}
+
+void PresentationClock::Resume()
+{
+	if(!_paused){return;}
+	_paused = false;
+	SetTime(_pausedTime);
+}
@@ -0,0 +1,746 @@
+#include <hogbox/Profiler.h>
+
+#include <osg/Camera>
+#include <osg/Drawable>
+#include <osg/RenderInfo>
+#include <osg/Notify>
+#include <OpenThreads/Atomic>
+#include <OpenThreads/ScopedLock>
+
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#ifndef GL_QUERY_RESULT
+#define GL_QUERY_RESULT 0x8866
+#endif
+#ifndef GL_QUERY_RESULT_AVAILABLE
+#define GL_QUERY_RESULT_AVAILABLE 0x8867
+#endif
+#ifndef GL_TIMESTAMP
+#define GL_TIMESTAMP 0x8E28
+#endif
+
+using namespace hogbox;
+
+//frame starts kept for GetStats
+static const unsigned int s_maxFrameStarts = 300;
+
+//name of the scope BeginFrame records, compared by pointer
+static const char* s_frameScopeName = "Frame";
+
+namespace hogbox {
+
+//
+//A single threads events. Only the owning thread writes, it fills the slot then
+//bumps _written, readers copy what they can and then drop any slot the writer
+//may have reused while they were copying. The events are allocated by the
+//registry on the threads first event, so naming a thread costs nothing while
+//the profiler is off
+//
+class ProfileThreadBuffer
+{
+public:
+	ProfileThreadBuffer(unsigned int id)
+		: _id(id),
+		_mask(0),
+		_count(0),
+		_written(0)
+	{
+	}
+
+	inline bool IsAllocated()const{return !_events.empty();}
+
+	void Allocate(unsigned int size)
+	{
+		_events.resize(size);
+		_mask = size-1;
+	}
+
+	inline void Push(const ProfileEvent& event)
+	{
+		_events[_count & _mask] = event;
+		_count++;
+		//publishes the slot
+		++_written;
+	}
+
+	//
+	//Append the events that started at or after since, oldest first
+	void Copy(std::vector<ProfileEvent>& events, osg::Timer_t since)
+	{
+		if(!IsAllocated()){return;}
+		unsigned int size = (unsigned int)_events.size();
+		unsigned int end = _written;
+		unsigned int begin = end > size ? end-size : 0;
+
+		std::vector<ProfileEvent> copied;
+		copied.reserve(end-begin);
+		for(unsigned int i=begin; i<end; i++){
+			copied.push_back(_events[i & _mask]);
+		}
+
+		//the slot after the last published one may be half written too
+		unsigned int after = _written;
+		unsigned int firstValid = after+1 > size ? after+1-size : 0;
+		for(unsigned int i=0; i<copied.size(); i++){
+			if(begin+i < firstValid){continue;}
+			if(copied[i]._start < since){continue;}
+			events.push_back(copied[i]);
+		}
+	}
+
+	unsigned int _id;
+	std::string _name;
+
+protected:
+	std::vector<ProfileEvent> _events;
+	unsigned int _mask;
+	//writers own count of events pushed
+	unsigned int _count;
+	OpenThreads::Atomic _written;
+};
+
+//
+//Finds the calling threads buffer through a thread local slot, as the
+//generators are found in Random.cpp. Buffers are kept until the profiler is
+//deleted rather than when their thread exits so their events can still be
+//written out
+//
+class ProfileThreadRegistry
+{
+public:
+	ProfileThreadRegistry()
+	{
+#ifdef WIN32
+		_slot = TlsAlloc();
+#else
+		pthread_key_create(&_slot, NULL);
+#endif
+	}
+
+	~ProfileThreadRegistry()
+	{
+		for(unsigned int i=0; i<_buffers.size(); i++){
+			delete _buffers[i];
+		}
+		_buffers.clear();
+#ifdef WIN32
+		TlsFree(_slot);
+#else
+		pthread_key_delete(_slot);
+#endif
+	}
+
+	inline ProfileThreadBuffer* Find()
+	{
+#ifdef WIN32
+		return (ProfileThreadBuffer*)TlsGetValue(_slot);
+#else
+		return (ProfileThreadBuffer*)pthread_getspecific(_slot);
+#endif
+	}
+
+	//
+	//The calling threads buffer, created if it has none and given size events
+	//if it has none yet and size isn't 0
+	ProfileThreadBuffer* Get(unsigned int size)
+	{
+		ProfileThreadBuffer* buffer = Find();
+		if(buffer && (buffer->IsAllocated() || size == 0)){return buffer;}
+
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+		if(!buffer)
+		{
+			buffer = new ProfileThreadBuffer((unsigned int)_buffers.size());
+			std::ostringstream name;
+			name << "Thread " << buffer->_id;
+			buffer->_name = name.str();
+			_buffers.push_back(buffer);
+#ifdef WIN32
+			TlsSetValue(_slot, buffer);
+#else
+			pthread_setspecific(_slot, buffer);
+#endif
+		}
+		if(size != 0){buffer->Allocate(size);}
+		return buffer;
+	}
+
+	void SetName(const std::string& name)
+	{
+		ProfileThreadBuffer* buffer = Get(0);
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+		buffer->_name = name;
+	}
+
+	void Copy(ProfileThreadVector& threads, osg::Timer_t since)
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+		threads.resize(_buffers.size());
+		for(unsigned int i=0; i<_buffers.size(); i++){
+			threads[i]._id = _buffers[i]->_id;
+			threads[i]._name = _buffers[i]->_name;
+			threads[i]._events.clear();
+			_buffers[i]->Copy(threads[i]._events, since);
+		}
+	}
+
+protected:
+
+#ifdef WIN32
+	DWORD _slot;
+#else
+	pthread_key_t _slot;
+#endif
+
+	OpenThreads::Mutex _mutex;
+	std::vector<ProfileThreadBuffer*> _buffers;
+};
+
+}; //end hogbox namespace
+
+namespace {
+
+//
+//Times the draw of a camera between its pre and post draw callbacks. The gpu
+//time comes from a pair of timestamp queries, a few pairs are kept in flight
+//and each is read back once its result is available, a frame is skipped
+//rather than waiting if they're all still in flight. Assumes the camera is
+//drawn by one context at a time, the queries are remade if that changes
+//
+class GPUTimer : public osg::Referenced
+{
+public:
+	GPUTimer(const char* name)
+		: osg::Referenced(),
+		_name(name),
+		_contextID(0),
+		_initialised(false),
+		_supported(false),
+		_next(0),
+		_began(false),
+		_issued(false),
+		_cpuStart(0),
+		_calibrationTick(0),
+		_calibrationTime(0)
+	{
+		for(unsigned int i=0; i<NUM_QUERY_PAIRS; i++){
+			_pairs[i]._pending = false;
+		}
+	}
+
+	void Begin(osg::RenderInfo& renderInfo)
+	{
+		_began = Profiler::IsEnabled();
+		_issued = false;
+		if(!_began){return;}
+		_cpuStart = osg::Timer::instance()->tick();
+
+		osg::Drawable::Extensions* extensions = osg::Drawable::getExtensions(renderInfo.getContextID(), true);
+		if(!Init(extensions, renderInfo.getContextID())){return;}
+
+		Resolve(extensions);
+
+		QueryPair& pair = _pairs[_next];
+		if(pair._pending){return;}
+		extensions->glQueryCounter(pair._queries[0], GL_TIMESTAMP);
+		_issued = true;
+	}
+
+	void End(osg::RenderInfo& renderInfo)
+	{
+		if(!_began){return;}
+		_began = false;
+		Profiler::Inst()->AddScope(_name, _cpuStart, osg::Timer::instance()->tick());
+
+		if(!_issued){return;}
+		_issued = false;
+		osg::Drawable::Extensions* extensions = osg::Drawable::getExtensions(renderInfo.getContextID(), true);
+		QueryPair& pair = _pairs[_next];
+		extensions->glQueryCounter(pair._queries[1], GL_TIMESTAMP);
+		pair._pending = true;
+		_next = (_next+1) % NUM_QUERY_PAIRS;
+	}
+
+protected:
+
+	virtual ~GPUTimer(void){}
+
+	enum{NUM_QUERY_PAIRS = 4};
+
+	struct QueryPair
+	{
+		GLuint _queries[2];
+		bool _pending;
+	};
+
+	//
+	//Make the queries for contextID, false if timer queries aren't supported
+	bool Init(osg::Drawable::Extensions* extensions, unsigned int contextID)
+	{
+		if(_initialised && _contextID == contextID){return _supported;}
+
+		_initialised = true;
+		_contextID = contextID;
+		_supported = extensions->isARBTimerQuerySupported();
+		_calibrationTick = 0;
+		_next = 0;
+		for(unsigned int i=0; i<NUM_QUERY_PAIRS; i++){
+			_pairs[i]._pending = false;
+			if(_supported){extensions->glGenQueries(2, _pairs[i]._queries);}
+		}
+		if(!_supported){
+			OSG_INFO << "GPUTimer::Init: ARB_timer_query isn't supported, '" << _name << "' will only record cpu time." << std::endl;
+		}
+		return _supported;
+	}
+
+	//
+	//Record the pairs that have finished, oldest first
+	void Resolve(osg::Drawable::Extensions* extensions)
+	{
+		Calibrate(extensions);
+
+		for(unsigned int i=0; i<NUM_QUERY_PAIRS; i++)
+		{
+			QueryPair& pair = _pairs[(_next+i) % NUM_QUERY_PAIRS];
+			if(!pair._pending){continue;}
+
+			GLint available = 0;
+			extensions->glGetQueryObjectiv(pair._queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+			if(!available){break;}
+
+			GLuint64EXT start = 0;
+			GLuint64EXT end = 0;
+			extensions->glGetQueryObjectui64v(pair._queries[0], GL_QUERY_RESULT, &start);
+			extensions->glGetQueryObjectui64v(pair._queries[1], GL_QUERY_RESULT, &end);
+			pair._pending = false;
+
+			Profiler::Inst()->AddGPUScope(_name, ToTick(start), ToTick(end));
+		}
+	}
+
+	//
+	//Pair the gpu clock with the cpu one about once a second, as they drift
+	void Calibrate(osg::Drawable::Extensions* extensions)
+	{
+		osg::Timer_t now = osg::Timer::instance()->tick();
+		if(_calibrationTick != 0 && osg::Timer::instance()->delta_s(_calibrationTick, now) < 1.0){return;}
+
+		GLint64EXT gpuTime = 0;
+		extensions->glGetInteger64v(GL_TIMESTAMP, &gpuTime);
+		_calibrationTick = now;
+		_calibrationTime = (GLuint64EXT)gpuTime;
+	}
+
+	//
+	//Gpu nanoseconds to cpu ticks
+	osg::Timer_t ToTick(GLuint64EXT gpuTime)
+	{
+		double seconds = (double)(long long)(gpuTime - _calibrationTime) * 1e-9;
+		double ticks = seconds / osg::Timer::instance()->getSecondsPerTick();
+		return (osg::Timer_t)((long long)_calibrationTick + (long long)ticks);
+	}
+
+protected:
+
+	const char* _name;
+
+	unsigned int _contextID;
+	bool _initialised;
+	bool _supported;
+
+	QueryPair _pairs[NUM_QUERY_PAIRS];
+	unsigned int _next;
+
+	//state between Begin and End of the current draw
+	bool _began;
+	bool _issued;
+	osg::Timer_t _cpuStart;
+
+	osg::Timer_t _calibrationTick;
+	GLuint64EXT _calibrationTime;
+};
+
+class GPUTimerBeginCallback : public osg::Camera::DrawCallback
+{
+public:
+	GPUTimerBeginCallback(GPUTimer* timer, osg::Camera::DrawCallback* previous)
+		: osg::Camera::DrawCallback(),
+		_timer(timer),
+		_previous(previous)
+	{
+	}
+	virtual void operator () (osg::RenderInfo& renderInfo) const
+	{
+		if(_previous.valid()){(*_previous)(renderInfo);}
+		_timer->Begin(renderInfo);
+	}
+protected:
+	osg::ref_ptr<GPUTimer> _timer;
+	//the callback the camera had before, still called
+	osg::ref_ptr<osg::Camera::DrawCallback> _previous;
+};
+
+class GPUTimerEndCallback : public osg::Camera::DrawCallback
+{
+public:
+	GPUTimerEndCallback(GPUTimer* timer, osg::Camera::DrawCallback* previous)
+		: osg::Camera::DrawCallback(),
+		_timer(timer),
+		_previous(previous)
+	{
+	}
+	virtual void operator () (osg::RenderInfo& renderInfo) const
+	{
+		_timer->End(renderInfo);
+		if(_previous.valid()){(*_previous)(renderInfo);}
+	}
+protected:
+	osg::ref_ptr<GPUTimer> _timer;
+	//the callback the camera had before, still called
+	osg::ref_ptr<osg::Camera::DrawCallback> _previous;
+};
+
+//
+//Accumulates one scope name for GetStats
+//
+struct ScopeTotal
+{
+	ScopeTotal()
+		: _calls(0),
+		_totalMs(0.0),
+		_maxMs(0.0)
+	{
+	}
+	unsigned int _calls;
+	double _totalMs;
+	double _maxMs;
+};
+
+bool CompareScopeStats(const ProfileScopeStats& a, const ProfileScopeStats& b)
+{
+	return a._averageMs > b._averageMs;
+}
+
+//
+//Write str as a json string
+//
+void WriteJsonString(std::ostream& out, const std::string& str)
+{
+	out << '"';
+	for(unsigned int i=0; i<str.size(); i++)
+	{
+		char c = str[i];
+		if(c == '"' || c == '\\'){out << '\\' << c;}
+		else if(c == '\n'){out << "\\n";}
+		else if((unsigned char)c < 0x20){out << ' ';}
+		else{out << c;}
+	}
+	out << '"';
+}
+
+};
+
+static osg::ref_ptr<Profiler> s_hogboxProfilerInstance = NULL;
+
+bool Profiler::s_enabled = false;
+
+Profiler* Profiler::Inst(bool erase)
+{
+	if(s_hogboxProfilerInstance==NULL)
+	{s_hogboxProfilerInstance = new Profiler();}
+	if(erase)
+	{s_hogboxProfilerInstance = 0;}
+	return s_hogboxProfilerInstance.get();
+}
+
+Profiler::Profiler()
+	: osg::Referenced(),
+	p_registry(new ProfileThreadRegistry()),
+	_bufferSize(16384),
+	_frameNumber(0),
+	_clearTick(0)
+{
+	_startTick = osg::Timer::instance()->tick();
+}
+
+Profiler::~Profiler(void)
+{
+	delete p_registry;
+	p_registry = NULL;
+}
+
+//
+//Starting clears the old events so the recording begins now
+//
+void Profiler::SetEnabled(bool enabled)
+{
+	if(enabled && !s_enabled){Inst()->Clear();}
+	s_enabled = enabled;
+}
+
+void Profiler::SetBufferSize(unsigned int numEvents)
+{
+	unsigned int size = 1;
+	while(size < numEvents && size < 0x80000000u){size <<= 1;}
+	_bufferSize = size;
+}
+
+void Profiler::SetThreadName(const std::string& name)
+{
+	p_registry->SetName(name);
+}
+
+const char* Profiler::InternName(const std::string& name)
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+	return _names.insert(name).first->c_str();
+}
+
+ProfileThreadBuffer* Profiler::GetThreadBuffer()
+{
+	return p_registry->Get(_bufferSize);
+}
+
+void Profiler::Add(ProfileEvent::Type type, const char* name, osg::Timer_t start, osg::Timer_t end, double value)
+{
+	ProfileEvent event;
+	event._name = name;
+	event._type = type;
+	event._start = start;
+	event._end = end;
+	event._value = value;
+	GetThreadBuffer()->Push(event);
+}
+
+void Profiler::AddScope(const char* name, osg::Timer_t start, osg::Timer_t end)
+{
+	Add(ProfileEvent::CPU_SCOPE, name, start, end, 0.0);
+}
+
+void Profiler::AddGPUScope(const char* name, osg::Timer_t start, osg::Timer_t end)
+{
+	Add(ProfileEvent::GPU_SCOPE, name, start, end, 0.0);
+}
+
+void Profiler::AddCounter(const char* name, double value)
+{
+	osg::Timer_t now = osg::Timer::instance()->tick();
+	Add(ProfileEvent::COUNTER, name, now, now, value);
+}
+
+void Profiler::BeginFrame()
+{
+	osg::Timer_t now = osg::Timer::instance()->tick();
+
+	osg::Timer_t previous = 0;
+	bool hasPrevious = false;
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+		if(!_frameStarts.empty()){
+			previous = _frameStarts.back();
+			hasPrevious = true;
+		}
+		_frameStarts.push_back(now);
+		if(_frameStarts.size() > s_maxFrameStarts){_frameStarts.erase(_frameStarts.begin());}
+		_frameNumber++;
+	}
+	if(hasPrevious){AddScope(s_frameScopeName, previous, now);}
+}
+
+unsigned int Profiler::GetFrameNumber()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+	return _frameNumber;
+}
+
+void Profiler::Clear()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+	_clearTick = osg::Timer::instance()->tick();
+	_frameStarts.clear();
+}
+
+void Profiler::GetThreads(ProfileThreadVector& threads)
+{
+	osg::Timer_t since;
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+		since = _clearTick;
+	}
+	p_registry->Copy(threads, since);
+}
+
+ProfileStats Profiler::GetStats(unsigned int numFrames)
+{
+	ProfileStats stats;
+
+	std::vector<osg::Timer_t> frameStarts;
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+		frameStarts = _frameStarts;
+	}
+	if(frameStarts.size() < 2 || numFrames == 0){return stats;}
+
+	unsigned int count = std::min(numFrames, (unsigned int)frameStarts.size()-1);
+	unsigned int first = (unsigned int)frameStarts.size()-1-count;
+	osg::Timer_t windowStart = frameStarts[first];
+	osg::Timer_t windowEnd = frameStarts.back();
+
+	stats._numFrames = count;
+	for(unsigned int i=first; i+1<frameStarts.size(); i++){
+		double ms = osg::Timer::instance()->delta_m(frameStarts[i], frameStarts[i+1]);
+		stats._averageFrameMs += ms;
+		stats._maxFrameMs = std::max(stats._maxFrameMs, ms);
+	}
+	stats._averageFrameMs /= count;
+
+	ProfileThreadVector threads;
+	GetThreads(threads);
+
+	std::map<std::pair<std::string, bool>, ScopeTotal> totals;
+	std::map<std::string, std::pair<osg::Timer_t, double> > counters;
+	for(unsigned int t=0; t<threads.size(); t++)
+	{
+		const std::vector<ProfileEvent>& events = threads[t]._events;
+		for(unsigned int i=0; i<events.size(); i++)
+		{
+			const ProfileEvent& event = events[i];
+			if(event._type == ProfileEvent::COUNTER)
+			{
+				std::pair<osg::Timer_t, double>& latest = counters[event._name];
+				if(event._start >= latest.first){latest = std::make_pair(event._start, event._value);}
+				continue;
+			}
+			if(event._name == s_frameScopeName){continue;}
+			if(event._start < windowStart || event._start >= windowEnd){continue;}
+
+			ScopeTotal& total = totals[std::make_pair(std::string(event._name), event._type == ProfileEvent::GPU_SCOPE)];
+			double ms = event._end > event._start ? osg::Timer::instance()->delta_m(event._start, event._end) : 0.0;
+			total._calls++;
+			total._totalMs += ms;
+			total._maxMs = std::max(total._maxMs, ms);
+		}
+	}
+
+	for(std::map<std::pair<std::string, bool>, ScopeTotal>::iterator it=totals.begin(); it!=totals.end(); it++)
+	{
+		ProfileScopeStats scope;
+		scope._name = it->first.first;
+		scope._gpu = it->first.second;
+		scope._calls = (double)it->second._calls / count;
+		scope._averageMs = it->second._totalMs / count;
+		scope._maxMs = it->second._maxMs;
+		stats._scopes.push_back(scope);
+	}
+	std::sort(stats._scopes.begin(), stats._scopes.end(), CompareScopeStats);
+
+	for(std::map<std::string, std::pair<osg::Timer_t, double> >::iterator it=counters.begin(); it!=counters.end(); it++){
+		stats._counters.push_back(std::make_pair(it->first, it->second.second));
+	}
+	return stats;
+}
+
+void Profiler::WriteSummary(std::ostream& out, unsigned int numFrames)
+{
+	ProfileStats stats = GetStats(numFrames);
+	if(stats._numFrames == 0){
+		out << "No complete frames recorded" << std::endl;
+		return;
+	}
+
+	out << std::fixed << std::setprecision(2);
+	out << "Frame " << stats._averageFrameMs << "ms avg, " << stats._maxFrameMs << "ms max over " << stats._numFrames << " frames" << std::endl;
+	out << std::left << std::setw(36) << "Scope" << std::right << std::setw(9) << "avg ms" << std::setw(9) << "max ms" << std::setw(8) << "calls" << std::endl;
+	for(unsigned int i=0; i<stats._scopes.size(); i++)
+	{
+		const ProfileScopeStats& scope = stats._scopes[i];
+		std::string name = scope._gpu ? "GPU " + scope._name : scope._name;
+		if(name.size() > 35){name = name.substr(0, 35);}
+		out << std::left << std::setw(36) << name << std::right
+			<< std::setw(9) << scope._averageMs
+			<< std::setw(9) << scope._maxMs
+			<< std::setw(8) << std::setprecision(1) << scope._calls << std::setprecision(2) << std::endl;
+	}
+	for(unsigned int i=0; i<stats._counters.size(); i++){
+		out << std::left << std::setw(36) << stats._counters[i].first << std::right << std::setw(9) << stats._counters[i].second << std::endl;
+	}
+}
+
+void Profiler::WriteChromeTrace(std::ostream& out)
+{
+	ProfileThreadVector threads;
+	GetThreads(threads);
+
+	double microsecondsPerTick = osg::Timer::instance()->getSecondsPerTick() * 1e6;
+	out << std::fixed << std::setprecision(3);
+
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::endl;
+	out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"CPU\"}}," << std::endl;
+	out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":2,\"tid\":0,\"args\":{\"name\":\"GPU\"}}";
+
+	for(unsigned int t=0; t<threads.size(); t++)
+	{
+		const ProfileThread& thread = threads[t];
+		bool hasGPU = false;
+		for(unsigned int i=0; i<thread._events.size() && !hasGPU; i++){
+			hasGPU = thread._events[i]._type == ProfileEvent::GPU_SCOPE;
+		}
+		for(unsigned int pid=1; pid<=(hasGPU ? 2u : 1u); pid++){
+			out << "," << std::endl << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << thread._id << ",\"args\":{\"name\":";
+			WriteJsonString(out, thread._name);
+			out << "}}";
+		}
+
+		for(unsigned int i=0; i<thread._events.size(); i++)
+		{
+			const ProfileEvent& event = thread._events[i];
+			//gpu times converted from the gpu clock can fall just before time zero
+			double ts = (double)(long long)(event._start - _startTick) * microsecondsPerTick;
+
+			out << "," << std::endl << "{\"name\":";
+			WriteJsonString(out, event._name);
+			if(event._type == ProfileEvent::COUNTER)
+			{
+				out << ",\"ph\":\"C\",\"pid\":1,\"tid\":" << thread._id << ",\"ts\":" << ts
+					<< ",\"args\":{\"value\":" << event._value << "}}";
+			}else{
+				double dur = event._end > event._start ? (double)(event._end - event._start) * microsecondsPerTick : 0.0;
+				bool gpu = event._type == ProfileEvent::GPU_SCOPE;
+				out << ",\"cat\":\"" << (gpu ? "gpu" : "cpu") << "\",\"ph\":\"X\",\"pid\":" << (gpu ? 2 : 1)
+					<< ",\"tid\":" << thread._id << ",\"ts\":" << ts << ",\"dur\":" << dur << "}";
+			}
+		}
+	}
+	out << std::endl << "]}" << std::endl;
+}
+
+bool Profiler::WriteChromeTrace(const std::string& fileName)
+{
+	std::ofstream out(fileName.c_str());
+	if(!out.is_open()){
+		OSG_WARN << "Profiler::WriteChromeTrace: ERROR: Failed to open '" << fileName << "' for writing." << std::endl;
+		return false;
+	}
+	WriteChromeTrace(out);
+	return true;
+}
+
+void Profiler::AttachGPUTimer(osg::Camera* camera, const std::string& name)
+{
+	if(!camera){return;}
+	GPUTimer* timer = new GPUTimer(InternName(name));
+	//wrap any callbacks already set, the timer brackets them rather than replacing them
+	camera->setPreDrawCallback(new GPUTimerBeginCallback(timer, camera->getPreDrawCallback()));
+	camera->setPostDrawCallback(new GPUTimerEndCallback(timer, camera->getPostDrawCallback()));
+}
@@ -0,0 +1,330 @@
+#include <hogbox/Random.h>
+
+#include <OpenThreads/Mutex>
+#include <OpenThreads/ScopedLock>
+
+#include <math.h>
+#include <vector>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+using namespace hogbox;
+
+//
+//Scramble the bits of x, used to spread a seed over the state
+//
+static inline unsigned int MixBits(unsigned int x)
+{
+	x ^= x >> 16;
+	x *= 0x7feb352du;
+	x ^= x >> 15;
+	x *= 0x846ca68bu;
+	x ^= x >> 16;
+	return x;
+}
+
+Random::Random(unsigned int seed, unsigned int stream)
+	: _hasGaussian(false),
+	_gaussian(0.0)
+{
+	Seed(seed, stream);
+}
+
+//
+//Restart the sequence
+//
+void Random::Seed(unsigned int seed, unsigned int stream)
+{
+	unsigned int x = MixBits(seed) ^ MixBits(stream + 0x632be5abu);
+	for(unsigned int i=0; i<4; i++){
+		x += 0x9e3779b9u;
+		_state[i] = MixBits(x);
+	}
+	//an all zero state would only ever give zero
+	if((_state[0] | _state[1] | _state[2] | _state[3]) == 0){_state[0] = 1;}
+
+	_hasGaussian = false;
+}
+
+//
+//Double in [0,1) from 53 random bits
+//
+double Random::NextDouble()
+{
+	unsigned int high = NextUInt() >> 5;
+	unsigned int low = NextUInt() >> 6;
+	return (high * 67108864.0 + low) * (1.0/9007199254740992.0);
+}
+
+//
+//Int between min and max inclusive
+//
+int Random::NextInt(int min, int max)
+{
+	if(min > max){
+		int temp = min; min = max; max = temp;
+	}
+
+	unsigned int range = (unsigned int)(max-min) + 1;
+	//the full range of int
+	if(range == 0){return (int)NextUInt();}
+
+	//reject the top values that would make some results more likely
+	unsigned int threshold = (0u-range) % range;
+	unsigned int value = NextUInt();
+	while(value < threshold){value = NextUInt();}
+	return min + (int)(value % range);
+}
+
+//
+//Marsaglia polar method, keeps the second value for the next call
+//
+double Random::NextGaussian()
+{
+	if(_hasGaussian){
+		_hasGaussian = false;
+		return _gaussian;
+	}
+
+	double u, v, s;
+	do{
+		u = NextDouble()*2.0 - 1.0;
+		v = NextDouble()*2.0 - 1.0;
+		s = u*u + v*v;
+	}while(s >= 1.0 || s == 0.0);
+
+	double scale = sqrt(-2.0*log(s)/s);
+	_gaussian = v*scale;
+	_hasGaussian = true;
+	return u*scale;
+}
+
+osg::Vec2 Random::NextVec2(float min, float max)
+{
+	float x = NextFloat(min, max);
+	float y = NextFloat(min, max);
+	return osg::Vec2(x, y);
+}
+
+osg::Vec3 Random::NextVec3(float min, float max)
+{
+	float x = NextFloat(min, max);
+	float y = NextFloat(min, max);
+	float z = NextFloat(min, max);
+	return osg::Vec3(x, y, z);
+}
+
+osg::Vec4 Random::NextVec4(float min, float max)
+{
+	float x = NextFloat(min, max);
+	float y = NextFloat(min, max);
+	float z = NextFloat(min, max);
+	float w = NextFloat(min, max);
+	return osg::Vec4(x, y, z, w);
+}
+
+//
+//Pick a height on the sphere and an angle around it, which covers the sphere
+//evenly where normalising a random vector in a cube favours the corners
+//
+osg::Vec3 Random::NextUnitVec3()
+{
+	float z = NextFloat()*2.0f - 1.0f;
+	float angle = NextFloat()*(float)(2.0*3.14159265358979323846);
+	float radius = sqrtf(1.0f - z*z);
+	return osg::Vec3(radius*cosf(angle), radius*sinf(angle), z);
+}
+
+//
+//Fill an array of random bits
+//
+void Random::Fill(unsigned int* values, unsigned int count)
+{
+	unsigned int s0 = _state[0];
+	unsigned int s1 = _state[1];
+	unsigned int s2 = _state[2];
+	unsigned int s3 = _state[3];
+	for(unsigned int i=0; i<count; i++)
+	{
+		values[i] = Rotate(s1*5, 7)*9;
+		unsigned int t = s1 << 9;
+		s2 ^= s0;
+		s3 ^= s1;
+		s1 ^= s2;
+		s0 ^= s3;
+		s2 ^= t;
+		s3 = Rotate(s3, 11);
+	}
+	_state[0] = s0;
+	_state[1] = s1;
+	_state[2] = s2;
+	_state[3] = s3;
+}
+
+//
+//Fill an array of floats between min and max
+//
+void Random::Fill(float* values, unsigned int count, float min, float max)
+{
+	float scale = (max-min) * (1.0f/16777216.0f);
+	unsigned int s0 = _state[0];
+	unsigned int s1 = _state[1];
+	unsigned int s2 = _state[2];
+	unsigned int s3 = _state[3];
+	for(unsigned int i=0; i<count; i++)
+	{
+		values[i] = min + (float)(Rotate(s1*5, 7)*9 >> 8) * scale;
+		unsigned int t = s1 << 9;
+		s2 ^= s0;
+		s3 ^= s1;
+		s1 ^= s2;
+		s0 ^= s3;
+		s2 ^= t;
+		s3 = Rotate(s3, 11);
+	}
+	_state[0] = s0;
+	_state[1] = s1;
+	_state[2] = s2;
+	_state[3] = s3;
+}
+
+namespace {
+
+//
+//A threads generator and the seeding it was last given
+//
+struct ThreadRandom
+{
+	ThreadRandom(unsigned int index)
+		: _index(index),
+		_generation(0)
+	{
+	}
+
+	Random _random;
+	//order the thread first asked for its generator
+	unsigned int _index;
+	//the registrys seed generation when it was last seeded
+	unsigned int _generation;
+};
+
+//
+//Finds the calling threads generator through a thread local slot. Generators
+//are kept until the library unloads rather than when their thread exits, as
+//hogbox threads live as long as the app
+//
+class ThreadRandomRegistry
+{
+public:
+	ThreadRandomRegistry()
+		: _seed(0),
+		_generation(1),
+		_numThreads(0)
+	{
+#ifdef WIN32
+		_slot = TlsAlloc();
+#else
+		pthread_key_create(&_slot, NULL);
+#endif
+	}
+
+	~ThreadRandomRegistry()
+	{
+		for(unsigned int i=0; i<_generators.size(); i++){
+			delete _generators[i];
+		}
+		_generators.clear();
+#ifdef WIN32
+		TlsFree(_slot);
+#else
+		pthread_key_delete(_slot);
+#endif
+	}
+
+	Random& Get()
+	{
+		ThreadRandom* generator = GetGenerator();
+		if(generator->_generation != _generation)
+		{
+			//stream 0 is left for the thread that set the seed
+			OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+			generator->_random.Seed(_seed, generator->_index+1);
+			generator->_generation = _generation;
+		}
+		return generator->_random;
+	}
+
+	void SetSeed(unsigned int seed)
+	{
+		ThreadRandom* generator = GetGenerator();
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+		_seed = seed;
+		++_generation;
+		generator->_random.Seed(seed);
+		generator->_generation = _generation;
+	}
+
+protected:
+
+	//
+	//The calling threads generator, created on first use
+	ThreadRandom* GetGenerator()
+	{
+#ifdef WIN32
+		ThreadRandom* generator = (ThreadRandom*)TlsGetValue(_slot);
+#else
+		ThreadRandom* generator = (ThreadRandom*)pthread_getspecific(_slot);
+#endif
+		if(generator){return generator;}
+
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+		generator = new ThreadRandom(_numThreads++);
+		_generators.push_back(generator);
+#ifdef WIN32
+		TlsSetValue(_slot, generator);
+#else
+		pthread_setspecific(_slot, generator);
+#endif
+		return generator;
+	}
+
+protected:
+
+#ifdef WIN32
+	DWORD _slot;
+#else
+	pthread_key_t _slot;
+#endif
+
+	OpenThreads::Mutex _mutex;
+	unsigned int _seed;
+	//bumped under the mutex by SetSeed, read without it as a thread that misses
+	//a new seed for a moment just carries on with its old sequence
+	volatile unsigned int _generation;
+	unsigned int _numThreads;
+	std::vector<ThreadRandom*> _generators;
+};
+
+ThreadRandomRegistry s_threadRandomRegistry;
+
+};
+
+//
+//The calling threads own generator
+//
+Random& hogbox::GetThreadRandom()
+{
+	return s_threadRandomRegistry.Get();
+}
+
+//
+//Reseed every threads generator
+//
+void hogbox::SetThreadRandomSeed(unsigned int seed)
+{
+	s_threadRandomRegistry.SetSeed(seed);
+}
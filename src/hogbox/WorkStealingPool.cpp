@@ -0,0 +1,209 @@
+#include <hogbox/WorkStealingPool.h>
+#include <hogbox/Profiler.h>
+
+#include <OpenThreads/ScopedLock>
+
+#include <sstream>
+
+using namespace hogbox;
+
+static osg::ref_ptr<WorkStealingPool> s_hogboxWorkStealingPoolInstance = NULL;
+static OpenThreads::Mutex s_hogboxWorkStealingPoolInstanceMutex;
+
+//
+//The main thread and the tracker thread can both be first to ask for the pool
+//
+WorkStealingPool* WorkStealingPool::Inst(bool erase)
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(s_hogboxWorkStealingPoolInstanceMutex);
+	if(s_hogboxWorkStealingPoolInstance==NULL)
+	{s_hogboxWorkStealingPoolInstance = new WorkStealingPool();}
+	if(erase)
+	{
+		s_hogboxWorkStealingPoolInstance = 0;
+	}
+	return s_hogboxWorkStealingPoolInstance.get();
+}
+
+WorkStealingPool::WorkStealingPool(unsigned int numThreads)
+	: osg::Referenced(),
+	_nextQueue(0),
+	_numQueued(0),
+	_numPending(0),
+	_numSteals(0),
+	_done(false)
+{
+	if(numThreads == 0){
+		int processors = OpenThreads::GetNumberOfProcessors();
+		numThreads = processors > 1 ? (unsigned int)(processors-1) : 0;
+	}
+
+	for(unsigned int i=0; i<numThreads+1; i++){
+		_queues.push_back(new WorkQueue());
+	}
+	for(unsigned int i=0; i<numThreads; i++){
+		Worker* worker = new Worker(this, i);
+		_workers.push_back(worker);
+		worker->start();
+	}
+}
+
+WorkStealingPool::~WorkStealingPool(void)
+{
+	//finish anything outstanding before shutting the workers down
+	WaitForCount(_numPending);
+
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_wakeMutex);
+		_done = true;
+		_wakeCondition.broadcast();
+	}
+	for(unsigned int i=0; i<_workers.size(); i++){
+		_workers[i]->join();
+		delete _workers[i];
+	}
+	_workers.clear();
+
+	for(unsigned int i=0; i<_queues.size(); i++){
+		delete _queues[i];
+	}
+	_queues.clear();
+}
+
+//
+//Queue a task as part of group, tasks are distributed round robin across the worker queues
+//
+void WorkStealingPool::Submit(PoolTask* task, TaskGroup* group)
+{
+	if(!task || !group){return;}
+
+	task->_group = group;
+	++group->_numPending;
+	++_numPending;
+
+	unsigned int index = (++_nextQueue) % _queues.size();
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_queues[index]->_mutex);
+		_queues[index]->_tasks.push_back(task);
+	}
+	++_numQueued;
+
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_wakeMutex);
+	_wakeCondition.signal();
+}
+
+//
+//Block until every task submitted with group has completed, the calling thread
+//executes queued tasks while it waits
+//
+void WorkStealingPool::Wait(TaskGroup* group)
+{
+	if(!group){return;}
+	WaitForCount(group->_numPending);
+}
+
+//
+//Run or wait on tasks until pending reaches zero. The caller may run tasks
+//from other groups while it waits, which also lets a task wait on a group of
+//its own without counting itself
+//
+void WorkStealingPool::WaitForCount(OpenThreads::Atomic& pending)
+{
+	unsigned int callerQueue = _queues.size()-1;
+	while(pending > 0)
+	{
+		PoolTaskPtr task;
+		if(TakeTask(callerQueue, task)){
+			RunTask(task.get());
+		}else{
+			//everything left is running on the workers, sleep until a group
+			//finishes or more work is submitted
+			OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_wakeMutex);
+			if(pending > 0 && _numQueued == 0){
+				//timeout guards against a missed signal
+				_wakeCondition.wait(&_wakeMutex, 10);
+			}
+		}
+	}
+}
+
+//
+//Try to take a task, first from the queue at index then by stealing from the others
+//
+bool WorkStealingPool::TakeTask(unsigned int index, PoolTaskPtr& task)
+{
+	if(_numQueued == 0){return false;}
+
+	//own queue, newest first for cache locality
+	{
+		WorkQueue* own = _queues[index];
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(own->_mutex);
+		if(!own->_tasks.empty()){
+			task = own->_tasks.back();
+			own->_tasks.pop_back();
+			--_numQueued;
+			return true;
+		}
+	}
+
+	//steal the oldest task from someone else
+	for(unsigned int i=1; i<_queues.size(); i++)
+	{
+		WorkQueue* victim = _queues[(index+i) % _queues.size()];
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(victim->_mutex);
+		if(!victim->_tasks.empty()){
+			task = victim->_tasks.front();
+			victim->_tasks.pop_front();
+			--_numQueued;
+			++_numSteals;
+			return true;
+		}
+	}
+	return false;
+}
+
+//
+//Run a task and mark it complete
+//
+void WorkStealingPool::RunTask(PoolTask* task)
+{
+	HOGBOX_PROFILE_SCOPE("WorkStealingPool::RunTask");
+	task->Run();
+	bool groupDone = (--task->_group->_numPending) == 0;
+	bool allDone = (--_numPending) == 0;
+
+	//wake anyone waiting on the group (or the pool in the destructor)
+	if(groupDone || allDone){
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_wakeMutex);
+		_wakeCondition.broadcast();
+	}
+}
+
+//
+//Sleep a worker until new work is submitted or the pool shuts down
+//
+void WorkStealingPool::WaitForWork()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_wakeMutex);
+	if(_numQueued == 0 && !_done){
+		//timeout guards against a missed signal
+		_wakeCondition.wait(&_wakeMutex, 10);
+	}
+}
+
+void WorkStealingPool::Worker::run()
+{
+	std::ostringstream name;
+	name << "WorkStealingPool " << _index;
+	Profiler::Inst()->SetThreadName(name.str());
+
+	while(!p_pool->_done)
+	{
+		PoolTaskPtr task;
+		if(p_pool->TakeTask(_index, task)){
+			p_pool->RunTask(task.get());
+		}else{
+			p_pool->WaitForWork();
+		}
+	}
+}
@@ -3,6 +3,9 @@
 
 #include <hogbox/AssetManager.h>
 
+#include <fstream>
+#include <set>
+
 using namespace hogboxDB;
 
 //BUG@tom Since moving to CMake the Singleton class has been misbehaving. An app seems to
@@ -24,13 +27,16 @@ HogBoxManager* HogBoxManager::Inst(bool erase)
 
 HogBoxManager::HogBoxManager(void)
 	: osg::Referenced(),
-	_databaseNode(NULL)
+	_databaseNode(NULL),
+	_databaseIndex(NULL),
+	_uniqueIDIndexBuilt(false)
 {
 }
 
 HogBoxManager::~HogBoxManager(void)
 {
 	_databaseNode = NULL;
+	_databaseIndex = NULL;
 }
 
 //
@@ -45,6 +51,25 @@ bool HogBoxManager::ReadDataBaseFile(const std::string& fileName)
 	/*_databaseNode = hogboxDB::openXmlFileAndReturnNode(fileName, "HogBoxDatabase");
 	return _databaseNode.valid();;*/
 
+	//index files on disk, nodes are then only parsed as they're read
+	if(!hogbox::AssetManager::Inst()->HasArchive())
+	{
+		std::string foundFile = osgDB::findDataFile(fileName);
+		if(!foundFile.empty())
+		{
+			XmlDatabaseIndexPtr index = new XmlDatabaseIndex();
+			if(index->Open(foundFile, "HogBoxDatabase"))
+			{
+				_databaseIndex = index;
+				_databaseNode = NULL;
+				_uniqueIDIndex.clear();
+				_uniqueIDIndexBuilt = false;
+				return true;
+			}
+			OSG_WARN << "HogBoxManager::ReadDataBaseFile: WARN: Failed to index '" << fileName << "', reading it whole." << std::endl;
+		}
+	}
+
     //allocate the document node
     osg::ref_ptr<osgDB::XmlNode> doc = new osgDB::XmlNode;
     osgDB::XmlNode* root = 0;
@@ -83,10 +108,196 @@ bool HogBoxManager::ReadDataBaseFile(const std::string& fileName)
     }
     
     _databaseNode = root;
+    _databaseIndex = NULL;
+    //index the new database on the next lookup
+    _uniqueIDIndex.clear();
+    _uniqueIDIndexBuilt = false;
     return true;
 }
 
 
+namespace {
+
+//
+//FNV-1a of a string, continuing from hash
+//
+unsigned int HashString(const std::string& str, unsigned int hash)
+{
+	for(unsigned int i=0; i<str.size(); i++){
+		hash ^= (unsigned char)str[i];
+		hash *= 16777619u;
+	}
+	//separate consecutive strings
+	hash ^= 0xff;
+	hash *= 16777619u;
+	return hash;
+}
+
+//
+//Hash of xmlNodes name, properties, contents and children
+//
+unsigned int HashXmlNode(osgDB::XmlNode* xmlNode, unsigned int hash = 2166136261u)
+{
+	hash = HashString(xmlNode->name, hash);
+	for(osgDB::XmlNode::Properties::iterator itr = xmlNode->properties.begin(); itr != xmlNode->properties.end(); ++itr){
+		hash = HashString(itr->first, hash);
+		hash = HashString(itr->second, hash);
+	}
+	hash = HashString(xmlNode->contents, hash);
+	for(osgDB::XmlNode::Children::iterator itr = xmlNode->children.begin(); itr != xmlNode->children.end(); ++itr){
+		if(itr->valid()){hash = HashXmlNode(itr->get(), hash);}
+	}
+	//close the children, so a nodes siblings don't hash as its children
+	return HashString("/", hash);
+}
+
+//
+//Add the ids of the objects xmlNodes children refer to, by useID or by
+//defining them inline, to ids
+//
+void CollectReferencedIDs(osgDB::XmlNode* xmlNode, std::set<std::string>& ids)
+{
+	for(osgDB::XmlNode::Children::iterator itr = xmlNode->children.begin(); itr != xmlNode->children.end(); ++itr)
+	{
+		if(!itr->valid()){continue;}
+		osgDB::XmlNode::Properties& properties = (*itr)->properties;
+		osgDB::XmlNode::Properties::iterator id = properties.find("useID");
+		if(id != properties.end() && !id->second.empty()){ids.insert(id->second);}
+		id = properties.find("uniqueID");
+		if(id != properties.end() && !id->second.empty()){ids.insert(id->second);}
+		CollectReferencedIDs(itr->get(), ids);
+	}
+}
+
+//
+//Name or type property of xmlNode, as used to pick the wrapper
+//
+std::string GetClassTypeOfXmlNode(osgDB::XmlNode* xmlNode)
+{
+	std::string type;
+	if(getXmlPropertyValue(xmlNode, "type", type) && !type.empty() && type != "Base"){return type;}
+	return xmlNode->name;
+}
+
+};
+
+//
+//Read a changed version of a database file and update the loaded objects
+//
+bool HogBoxManager::ReloadDataBaseFile(const std::string& fileName)
+{
+	//the loaded objects and the nodes they were read from, before
+	//reading the file replaces the database
+	std::map<std::string, XmlClassManager*> loaded;
+	std::map<std::string, osgDB::XmlNodePtr> oldNodes;
+	HogBoxRegistry* registry = HogBoxRegistry::Inst();
+	for(unsigned int m=0; m<registry->GetNumXmlClassManagers(); m++)
+	{
+		XmlClassManager* manager = registry->GetXmlClassManager(m);
+		std::vector<std::string> ids;
+		manager->GetLoadedUniqueIDs(ids);
+		for(unsigned int i=0; i<ids.size(); i++){
+			loaded[ids[i]] = manager;
+			oldNodes[ids[i]] = manager->GetXmlNodeByID(ids[i]);
+		}
+	}
+
+	if(!this->ReadDataBaseFile(fileName)){return false;}
+
+	//find the changed nodes, unchanged objects just take their new node
+	std::vector<osgDB::XmlNodePtr> changed;
+	for(std::map<std::string, osgDB::XmlNodePtr>::iterator itr = oldNodes.begin(); itr != oldNodes.end(); ++itr)
+	{
+		osgDB::XmlNodePtr newNode = FindNodeByUniqueIDProperty(itr->first);
+		if(!newNode.valid()){
+			OSG_WARN << "HogBoxManager::ReloadDataBaseFile: WARN: Loaded node '" << itr->first << "' is no longer in '" << fileName << "', it will be left loaded." << std::endl;
+			continue;
+		}
+		if(itr->second.valid() && HashXmlNode(itr->second.get()) == HashXmlNode(newNode.get())){
+			loaded[itr->first]->ReloadNode(newNode, false);
+		}else{
+			changed.push_back(newNode);
+		}
+	}
+	oldNodes.clear();
+
+	//reload the changed nodes, noting any that end up a new instance
+	std::vector<std::string> replaced;
+	unsigned int failed = 0;
+	for(unsigned int i=0; i<changed.size(); i++)
+	{
+		std::string uniqueID;
+		getXmlPropertyValue(changed[i].get(), "uniqueID", uniqueID);
+		std::map<std::string, XmlClassManager*>::iterator loadedItr = loaded.find(uniqueID);
+		if(loadedItr == loaded.end()){
+			OSG_WARN << "HogBoxManager::ReloadDataBaseFile: WARN: Changed node '" << uniqueID << "' wasn't loaded, skipping it." << std::endl;
+			continue;
+		}
+		XmlClassManager* oldManager = loadedItr->second;
+		osg::ObjectPtr before = oldManager->GetNodeObjectByID(uniqueID);
+
+		//a new class type needs a new object, possibly from another manager
+		std::string classType = GetClassTypeOfXmlNode(changed[i].get());
+		XmlClassManager* newManager = registry->GetXmlClassManagerForClassType(changed[i]->name);
+		osgDB::XmlNode* oldNode = oldManager->GetXmlNodeByID(uniqueID);
+		if(newManager != oldManager || !oldNode || GetClassTypeOfXmlNode(oldNode) != classType)
+		{
+			oldManager->ReleaseNodeByID(uniqueID);
+			loaded.erase(uniqueID);
+			if(!this->ReadNode(changed[i].get()).valid()){failed++; continue;}
+			loaded[uniqueID] = newManager;
+		}
+		else if(!oldManager->ReloadNode(changed[i])){
+			failed++;
+		}
+		loadedItr = loaded.find(uniqueID);
+		if(loadedItr != loaded.end() && loadedItr->second->GetNodeObjectByID(uniqueID) != before){
+			replaced.push_back(uniqueID);
+		}
+	}
+
+	//reload the objects referencing new instances, each at most once so
+	//wrappers that always create a new instance can't loop
+	if(!replaced.empty())
+	{
+		std::map<std::string, std::vector<std::string> > dependents;
+		for(std::map<std::string, XmlClassManager*>::iterator itr = loaded.begin(); itr != loaded.end(); ++itr)
+		{
+			osgDB::XmlNode* xmlNode = itr->second->GetXmlNodeByID(itr->first);
+			if(!xmlNode){continue;}
+			std::set<std::string> ids;
+			CollectReferencedIDs(xmlNode, ids);
+			for(std::set<std::string>::iterator id = ids.begin(); id != ids.end(); ++id){
+				dependents[*id].push_back(itr->first);
+			}
+		}
+
+		std::set<std::string> patched;
+		while(!replaced.empty())
+		{
+			std::vector<std::string>& users = dependents[replaced.back()];
+			replaced.pop_back();
+			for(unsigned int i=0; i<users.size(); i++)
+			{
+				if(!patched.insert(users[i]).second){continue;}
+				std::map<std::string, XmlClassManager*>::iterator user = loaded.find(users[i]);
+				if(user == loaded.end()){
+					OSG_WARN << "HogBoxManager::ReloadDataBaseFile: WARN: Node '" << users[i] << "' references a replaced node but is no longer loaded, skipping it." << std::endl;
+					continue;
+				}
+				XmlClassManager* manager = user->second;
+				osg::ObjectPtr before = manager->GetNodeObjectByID(users[i]);
+				if(!manager->ReloadNode(manager->GetXmlNodeByID(users[i]))){failed++; continue;}
+				if(manager->GetNodeObjectByID(users[i]) != before){replaced.push_back(users[i]);}
+			}
+		}
+		OSG_NOTICE << "HogBoxManager::ReloadDataBaseFile: Reloaded '" << changed.size() << "' changed and '" << patched.size() << "' dependent nodes from '" << fileName << "'." << std::endl;
+	}else{
+		OSG_NOTICE << "HogBoxManager::ReloadDataBaseFile: Reloaded '" << changed.size() << "' changed nodes from '" << fileName << "'." << std::endl;
+	}
+	return failed == 0;
+}
+
 //
 //Reads an xml node into a hogbox::ObjectPtr object using
 //the xml nodes uniqueID property to find it in the database.
@@ -94,11 +305,19 @@ bool HogBoxManager::ReadDataBaseFile(const std::string& fileName)
 //XmlClassManager to handle construction of the object.
 osg::ObjectPtr HogBoxManager::ReadNodeByID(const std::string& uniqueID)
 {
+	//streamed nodes are parsed on each find, so check
+	//if the object is already loaded first
+	if(_databaseIndex.valid())
+	{
+		osg::Object* loaded = this->GetNodeByID(uniqueID);
+		if(loaded){return loaded;}
+	}
+
 	//see if we can find a node with the uniqueID requested
-	osgDB::XmlNode* uniqueIDNode = FindNodeByUniqueIDProperty(uniqueID);
+	osgDB::XmlNodePtr uniqueIDNode = FindNodeByUniqueIDProperty(uniqueID);
 	//if we find the node pass it to readnode and return the result
-	if(uniqueIDNode)
-	{return ReadNode(uniqueIDNode);}
+	if(uniqueIDNode.valid())
+	{return ReadNode(uniqueIDNode.get());}
 	return NULL;
 }
 
@@ -146,13 +365,9 @@ osg::ObjectPtr HogBoxManager::ReadNode(osgDB::XmlNode* inNode)
 //
 osg::Object* HogBoxManager::GetNodeByID(const std::string& uniqueID)
 {
-	//find an xml node with the unique id
-	//see if we can find a node with the uniqueID requested
-	osgDB::XmlNode* uniqueIDNode = FindNodeByUniqueIDProperty(uniqueID);
-	if(!uniqueIDNode){return NULL;}
-    
-	//the xml node name represents its classType
-	std::string requestedClass = uniqueIDNode->name;
+	//the xml node name of the unique id represents its classType
+	std::string requestedClass = FindClassTypeByUniqueID(uniqueID);
+	if(requestedClass.empty()){return NULL;}
     
 	//find the manager for handling that type of class
 	XmlClassManager* readManager = hogboxDB::HogBoxRegistry::Inst()->GetXmlClassManagerForClassType(requestedClass);
@@ -179,18 +394,61 @@ osgDB::XmlNodePtr HogBoxManager::WriteXmlNode(osg::ObjectPtr object)
     return NULL;
 }
 
+//
+//Write an object straight to out
+//
+bool HogBoxManager::WriteXmlStream(osg::ObjectPtr object, XmlStreamWriter& out)
+{
+    if(!object.valid()){return false;}
+    XmlClassManager* writeManager = hogboxDB::HogBoxRegistry::Inst()->GetXmlClassManagerForClassType(object->className());
+	if(writeManager)
+	{
+        return writeManager->WriteXmlStream(object, out);
+    }
+    OSG_WARN << "HogBoxManager::WriteXmlStream: ERROR: No XmlClassManager supports class type '" << object->className() << "'." << std::endl;
+    return false;
+}
+
+//
+//Write objects to a new HogBoxDatabase xml file
+//
+bool HogBoxManager::WriteDataBaseFile(const std::string& fileName, const std::vector<osg::ObjectPtr>& objects)
+{
+    std::ofstream file(fileName.c_str());
+    if(!file.is_open()){
+        OSG_WARN << "HogBoxManager::WriteDataBaseFile: ERROR: Failed to open '" << fileName << "' for writing." << std::endl;
+        return false;
+    }
+
+    unsigned int failed = 0;
+    {
+        XmlStreamWriter out(file);
+        out.writeInformation("xml version=\"1.0\" encoding=\"UTF-8\"");
+        out.beginNode("HogBoxDatabase", true);
+        for(unsigned int i=0; i<objects.size(); i++){
+            if(!this->WriteXmlStream(objects[i], out)){failed++;}
+        }
+        out.endNode();
+        if(!out.flush()){
+            OSG_WARN << "HogBoxManager::WriteDataBaseFile: ERROR: Failed writing '" << fileName << "'." << std::endl;
+            return false;
+        }
+    }
+
+    if(failed > 0){
+        OSG_WARN << "HogBoxManager::WriteDataBaseFile: WARN: " << failed << " of " << objects.size() << " objects failed to write to '" << fileName << "'." << std::endl;
+    }
+    return failed == 0;
+}
+
 //
 //Release a node from the database by name
 //
 bool HogBoxManager::ReleaseNodeByID(const std::string& uniqueID)
 {
-	//find an xml node with the unique id
-	//see if we can find a node with the uniqueID requested
-	osgDB::XmlNode* uniqueIDNode = FindNodeByUniqueIDProperty(uniqueID);
-	if(!uniqueIDNode){return false;}
-
-	//the xml node name represents its classType
-	std::string requestedClass = uniqueIDNode->name;
+	//the xml node name of the unique id represents its classType
+	std::string requestedClass = FindClassTypeByUniqueID(uniqueID);
+	if(requestedClass.empty()){return false;}
 
 	//find the manager for handling that type of class
 	XmlClassManager* readManager = hogboxDB::HogBoxRegistry::Inst()->GetXmlClassManagerForClassType(requestedClass);
@@ -202,18 +460,74 @@ bool HogBoxManager::ReleaseNodeByID(const std::string& uniqueID)
 	return false;
 }
 
+//
+//Reindex the database nodes by uniqueID
+//
+void HogBoxManager::RebuildUniqueIDIndex()
+{
+	_uniqueIDIndex.clear();
+	_uniqueIDIndexBuilt = _databaseNode.valid();
+	if(_databaseNode.valid()){IndexUniqueIDs(_databaseNode.get());}
+}
+
+void HogBoxManager::IndexUniqueIDs(osgDB::XmlNode* xmlNode)
+{
+	for(osgDB::XmlNode::Children::iterator itr = xmlNode->children.begin();
+		itr != xmlNode->children.end();
+		itr++)
+	{
+		osgDB::XmlNode* cur = itr->get();
+		if(!cur){continue;}
+		osgDB::XmlNode::Properties::iterator id = cur->properties.find("uniqueID");
+		if(id != cur->properties.end()){
+			//the first node in document order keeps the id
+			if(!_uniqueIDIndex.insert(UniqueIDNodeMap::value_type(id->second, cur)).second){
+				OSG_WARN << "HogBoxManager::IndexUniqueIDs: WARN: Duplicate uniqueID '" << id->second << "' on a <" << cur->name << "> node, only the first is used." << std::endl;
+			}
+		}
+		IndexUniqueIDs(cur);
+	}
+}
+
+//
+//Make sure a database is available
+//
+bool HogBoxManager::HasDataBase()
+{
+	if(!_databaseNode.valid() && !_databaseIndex.valid()){this->ReadDataBaseFile("Data/hogboxDB.xml");}
+	if(!_databaseNode.valid() && !_databaseIndex.valid()){
+		OSG_FATAL << "HogBoxManager::HasDataBase: ERROR: No database fileloaded." << std::endl;
+		return false;
+	}
+	return true;
+}
+
+//
+//Return the class type of the database node with uniqueID
+//
+std::string HogBoxManager::FindClassTypeByUniqueID(const std::string& uniqueID)
+{
+	if(!this->HasDataBase()){return "";}
+	if(_databaseIndex.valid())
+	{
+		const XmlDatabaseIndex::Entry* entry = _databaseIndex->Find(uniqueID);
+		return entry ? entry->_classType : "";
+	}
+	osgDB::XmlNodePtr uniqueIDNode = FindNodeByUniqueIDProperty(uniqueID);
+	return uniqueIDNode.valid() ? uniqueIDNode->name : "";
+}
+
 //
 //find a node in the database with the uniqueID property
 //
-osgDB::XmlNode* HogBoxManager::FindNodeByUniqueIDProperty(const std::string& uniqueID, osgDB::XmlNode* xmlNode)
+osgDB::XmlNodePtr HogBoxManager::FindNodeByUniqueIDProperty(const std::string& uniqueID, osgDB::XmlNode* xmlNode)
 {
 	if(xmlNode==NULL){
-		if(!_databaseNode.get()){this->ReadDataBaseFile("Data/hogboxDB.xml");}
-		xmlNode = _databaseNode;
-        if(xmlNode==NULL){
-            OSG_FATAL << "HogBoxManager::FindNodeByUniqueIDProperty: ERROR: No database fileloaded." << std::endl;
-            return NULL;
-        }
+		if(!this->HasDataBase()){return NULL;}
+		if(_databaseIndex.valid()){return _databaseIndex->ReadNode(uniqueID);}
+		if(!_uniqueIDIndexBuilt){RebuildUniqueIDIndex();}
+		UniqueIDNodeMap::iterator itr = _uniqueIDIndex.find(uniqueID);
+		return itr != _uniqueIDIndex.end() ? itr->second : NULL;
 	}
 
 	//iterate through children of the node
@@ -231,8 +545,8 @@ osgDB::XmlNode* HogBoxManager::FindNodeByUniqueIDProperty(const std::string& uni
 				if(id == uniqueID){return cur;}
 			}
 			//check children
-			osgDB::XmlNode* result = FindNodeByUniqueIDProperty(uniqueID, cur);
-			if(result)
+			osgDB::XmlNodePtr result = FindNodeByUniqueIDProperty(uniqueID, cur);
+			if(result.valid())
 			{
 				return result;
 			}
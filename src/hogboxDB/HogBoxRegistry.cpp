@@ -11,6 +11,8 @@
 #include <hogboxDB/XmlClassWrapper.h>
 #include <hogbox/Version.h>
 
+#include <algorithm>
+
 using namespace hogboxDB;
 
 
@@ -42,6 +44,10 @@ HogBoxRegistry::HogBoxRegistry(void)
 HogBoxRegistry::~HogBoxRegistry(void)
 {
     OSG_NOTICE << "Deallocating HogBoxRegistry:." << std::endl;
+	_classTypeManagers.clear();
+	_wildcardManagers.clear();
+	_managerOrder.clear();
+	_xmlNodeManagersByName.clear();
 	_xmlNodeManagers.clear();
 	_dlList.clear();
 }
@@ -55,7 +61,18 @@ void HogBoxRegistry::AddXmlNodeManagerToRegistry(XmlClassManagerWrapper* object)
 	XmlClassManager* existing = GetXmlClassManager(object->className());
 	if(existing){return;}
 
+	XmlClassManager* manager = object->GetPrototype();
+	if(!manager){return;}
+
 	_xmlNodeManagers.push_back(object);
+	_xmlNodeManagersByName[object->className()] = manager;
+	_managerOrder[manager] = _xmlNodeManagers.size()-1;
+
+	//index the types it already supports
+	const XmlClassManager::ClassTypeWrapperMap& types = manager->GetSupportedClassTypes();
+	for(XmlClassManager::ClassTypeWrapperMap::const_iterator itr = types.begin(); itr != types.end(); ++itr){
+		AddClassTypeManager(itr->first, manager);
+	}
 }
 
 //
@@ -63,28 +80,49 @@ void HogBoxRegistry::AddXmlNodeManagerToRegistry(XmlClassManagerWrapper* object)
 //
 XmlClassManager* HogBoxRegistry::GetXmlClassManager(const std::string& managerName)
 {
-	for(unsigned int i=0; i<_xmlNodeManagers.size(); i++)
-	{
-		if(_xmlNodeManagers[i]->className() == managerName)
-		{return _xmlNodeManagers[i]->GetPrototype();}
-	}
+	std::map<std::string, XmlClassManager*>::iterator itr = _xmlNodeManagersByName.find(managerName);
+	if(itr != _xmlNodeManagersByName.end()){return itr->second;}
 	return NULL;
 }
 
+//
+//Index classType to manager, if the manager is registered
+//
+void HogBoxRegistry::AddClassTypeManager(const std::string& classType, XmlClassManager* manager)
+{
+	if(!manager){return;}
+	std::map<std::string, XmlClassManager*>::iterator itr = _xmlNodeManagersByName.find(manager->className());
+	if(itr == _xmlNodeManagersByName.end() || itr->second != manager){return;}
+
+	unsigned int order = _managerOrder[manager];
+	if(classType == "*"){
+		if(std::find(_wildcardManagers.begin(), _wildcardManagers.end(), manager) != _wildcardManagers.end()){return;}
+		//kept in registration order
+		std::vector<XmlClassManager*>::iterator pos = _wildcardManagers.begin();
+		while(pos != _wildcardManagers.end() && _managerOrder[*pos] < order){pos++;}
+		_wildcardManagers.insert(pos, manager);
+		return;
+	}
+	//the first registered manager to claim a type keeps it, whenever it claims it
+	ClassTypeManagerMap::iterator itr = _classTypeManagers.find(classType);
+	if(itr == _classTypeManagers.end()){
+		_classTypeManagers.insert(ClassTypeManagerMap::value_type(classType, manager));
+	}else if(order < _managerOrder[itr->second]){
+		itr->second = manager;
+	}
+}
+
 XmlClassManager* HogBoxRegistry::GetXmlClassManagerForClassType(const std::string& classType)
 {
 	//check already loaded managers
-	for(unsigned int i=0; i<_xmlNodeManagers.size(); i++)
-	{
-		//check the wrapper contains a valid manager prototype
-		if(_xmlNodeManagers[i].valid()){
-			if(_xmlNodeManagers[i]->GetPrototype()){
-				//does the classmanager accept the class type 
-				if(_xmlNodeManagers[i]->GetPrototype()->AcceptsClassType(classType))
-				{return _xmlNodeManagers[i]->GetPrototype();}
-			}
-		}
-	}
+	//as when each manager was asked in turn, the first registered manager that
+	//accepts the type wins whether it lists the type or accepts any ("*")
+	ClassTypeManagerMap::iterator itr = _classTypeManagers.find(classType);
+	XmlClassManager* exact = itr != _classTypeManagers.end() ? itr->second : NULL;
+	XmlClassManager* wildcard = !_wildcardManagers.empty() ? _wildcardManagers[0] : NULL;
+	if(exact && wildcard){return _managerOrder[exact] < _managerOrder[wildcard] ? exact : wildcard;}
+	if(exact){return exact;}
+	if(wildcard){return wildcard;}
 
 	//if none of the loaded xml class manager can read the classType
 	//try and load a library that can.
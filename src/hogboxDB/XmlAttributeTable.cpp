@@ -0,0 +1,108 @@
+#include <hogboxDB/XmlAttributeTable.h>
+
+using namespace hogboxDB;
+
+static OpenThreads::ReentrantMutex s_hogboxXmlAttributeTableBuildMutex;
+
+//
+//Held while a wrapper checks and builds its static table
+//
+OpenThreads::ReentrantMutex* XmlAttributeTable::getBuildMutex()
+{
+	return &s_hogboxXmlAttributeTableBuildMutex;
+}
+
+XmlAttributeTable::XmlAttributeTable(const XmlAttributeTable* base)
+	: osg::Referenced(),
+	_seed(0)
+{
+	if(base){
+		_bindings = base->_bindings;
+		this->buildIndex();
+	}
+}
+
+XmlAttributeTable::~XmlAttributeTable(void)
+{
+	_bindings.clear();
+	_slots.clear();
+}
+
+//
+//Add a binding, fails if an attribute of the same name exists
+//
+bool XmlAttributeTable::addBinding(XmlAttributeBinding* binding)
+{
+	if(!binding){return false;}
+	//keep a ref in case we reject it
+	XmlAttributeBindingPtr bindingPtr = binding;
+	if(this->find(binding->getName())){
+		OSG_WARN << "XmlAttributeTable::addBinding: ERROR: An attribute named '" << binding->getName() << "' has already been added." << std::endl;
+		return false;
+	}
+	_bindings.push_back(bindingPtr);
+	this->buildIndex();
+	return true;
+}
+
+//
+//Return the binding for attribute name, or NULL
+//
+const XmlAttributeBinding* XmlAttributeTable::find(const std::string& name)const
+{
+	if(_slots.empty()){return NULL;}
+	int index = _slots[hashName(name.c_str(), name.size(), _seed) & (_slots.size()-1)];
+	if(index < 0){return NULL;}
+	const XmlAttributeBinding* binding = _bindings[index].get();
+	return binding->getName() == name ? binding : NULL;
+}
+
+//
+//Find a seed for hashName that puts every binding in its own slot. Tables
+//are built once per class type, so the search cost doesn't matter
+//
+void XmlAttributeTable::buildIndex()
+{
+	//at least twice as many slots as names, as a power of two
+	unsigned int numSlots = 1;
+	while(numSlots < _bindings.size()*2){numSlots <<= 1;}
+
+	for(;;)
+	{
+		for(unsigned int seed=0; seed<1024; seed++)
+		{
+			_slots.assign(numSlots, -1);
+			bool collided = false;
+			for(unsigned int i=0; i<_bindings.size() && !collided; i++)
+			{
+				const std::string& name = _bindings[i]->getName();
+				int& slot = _slots[hashName(name.c_str(), name.size(), seed) & (numSlots-1)];
+				if(slot >= 0){
+					collided = true;
+				}else{
+					slot = (int)i;
+				}
+			}
+			if(!collided){
+				_seed = seed;
+				return;
+			}
+		}
+		//too crowded, spread them out
+		numSlots <<= 1;
+	}
+}
+
+//
+//FNV-1a of name, seeded
+//
+unsigned int XmlAttributeTable::hashName(const char* name, unsigned int length, unsigned int seed)
+{
+	unsigned int hash = 2166136261u ^ (seed * 16777619u);
+	for(unsigned int i=0; i<length; i++){
+		hash ^= (unsigned char)name[i];
+		hash *= 16777619u;
+	}
+	//fold the high bits down as only the low ones pick the slot
+	return hash ^ (hash >> 16);
+}
@@ -1,6 +1,9 @@
 #include <hogboxDB/XmlClassManager.h>
 
 #include <hogboxDB/XmlClassWrapper.h>
+#include <hogboxDB/HogBoxRegistry.h>
+
+#include <hogbox/MemoryTracker.h>
 
 using namespace hogboxDB;
 
@@ -29,6 +32,7 @@ XmlClassManager::~XmlClassManager(void)
 		(*itr).second = NULL;
 		//osg::notify(osg::WARN)<<(*itr).second.get()->referenceCount()<<std::endl;
 	}
+	_objectsByID.clear();
 	_objectList.clear();
 }
 
@@ -74,7 +78,12 @@ osg::ObjectPtr XmlClassManager::GetOrLoadNode(osg::ref_ptr<osgDB::XmlNode> xmlNo
 	//check we can load this class of node
 	if(!this->AcceptsClassType(xmlNode.get())){return NULL;}
 	
-	//try to find the node in our list of already loaded nodes
+	//try to find the node in our list of already loaded nodes, first
+	//by the node itself then by its uniqueID
+	XmlNodeToObjectMap::iterator loaded = _objectList.find(xmlNode);
+	if(loaded != _objectList.end())
+	{return (*loaded).second->getWrappedObject();}
+
 	std::string uniqueIDStr;
 	getXmlPropertyValue(xmlNode, "uniqueID", uniqueIDStr);
 	
@@ -93,7 +102,12 @@ osg::ObjectPtr XmlClassManager::GetOrLoadNode(osg::ref_ptr<osgDB::XmlNode> xmlNo
         OSG_INFO << "XmlClassManager::GetOrLoadNode: INFO: Adding Node Object with uniqueID '" << uniqueIDStr << "' to database." << std::endl;
 		//add to our list of loaded nodes
 		XmlNodeToObjectPair newObjectEntry(xmlNode, newObject);
-		_objectList.insert(newObjectEntry);
+		XmlNodeToObjectMap::iterator entry = _objectList.insert(newObjectEntry).first;
+		if(!uniqueIDStr.empty()){
+			_objectsByID.insert(UniqueIDToObjectMap::value_type(uniqueIDStr, entry));
+		}
+		//count any images, textures or geometry it holds against its uniqueID
+		hogbox::MemoryTracker::Inst()->TrackObject(newObject->getWrappedObject(), "", uniqueIDStr);
 		return newObject->getWrappedObject();
 	}
 
@@ -105,14 +119,21 @@ osg::ObjectPtr XmlClassManager::GetOrLoadNode(osg::ref_ptr<osgDB::XmlNode> xmlNo
 //
 osg::ObjectPtr XmlClassManager::GetNodeObjectByID(const std::string& uniqueID)
 {
-	for(XmlNodeToObjectMap::iterator itr=_objectList.begin();
-		itr != _objectList.end();
-		itr++)
-	{
-		std::string loadedObjectsUniqueID = (*itr).first->properties["uniqueID"];
-		if(loadedObjectsUniqueID == uniqueID)
-		{return (*itr).second->getWrappedObject();}
-	}
+	if(uniqueID.empty()){return NULL;}
+	UniqueIDToObjectMap::iterator itr = _objectsByID.find(uniqueID);
+	if(itr != _objectsByID.end())
+	{return (*itr).second->second->getWrappedObject();}
+	return NULL;//not found
+}
+
+//
+//Find the object loaded from xmlNode
+//
+osg::ObjectPtr XmlClassManager::GetNodeObject(osgDB::XmlNode* xmlNode)
+{
+	XmlNodeToObjectMap::iterator itr = _objectList.find(xmlNode);
+	if(itr != _objectList.end())
+	{return (*itr).second->getWrappedObject();}
 	return NULL;//not found
 }
 
@@ -127,28 +148,80 @@ osgDB::XmlNodePtr XmlClassManager::WriteXmlNode(osg::ObjectPtr object)
     return this->writeObjectToXmlNode(object);
 }
 
+//
+//Write an object straight to out using one of the xmlclasswrappers
+//
+bool XmlClassManager::WriteXmlStream(osg::ObjectPtr object, XmlStreamWriter& out)
+{
+    //check we can write this class of node
+	if(!object.valid() || !this->AcceptsClassType(object->className())){return false;}
+    
+    return this->writeObjectToXmlStream(object, out);
+}
+
 //
 //Release the node object if it has already been loaded
 bool XmlClassManager::ReleaseNodeByID(const std::string& uniqueID)
 {
-	for(XmlNodeToObjectMap::iterator itr=_objectList.begin();
-		itr != _objectList.end();
-		itr++)
-	{
-		std::string loadedObjectsUniqueID = (*itr).first->properties["uniqueID"];
-		if(loadedObjectsUniqueID == uniqueID)
-		{
-			_objectList.erase(itr);
-			return true;
-		}
+	UniqueIDToObjectMap::iterator itr = _objectsByID.find(uniqueID);
+	if(itr == _objectsByID.end()){return false;}
+
+	_objectList.erase((*itr).second);
+	_objectsByID.erase(itr);
+	return true;
+}
+
+
+//
+//Append the uniqueIDs of the loaded objects to ids
+//
+void XmlClassManager::GetLoadedUniqueIDs(std::vector<std::string>& ids)const
+{
+	for(UniqueIDToObjectMap::const_iterator itr = _objectsByID.begin(); itr != _objectsByID.end(); ++itr){
+		ids.push_back(itr->first);
 	}
-	return false;
 }
 
+//
+//The xml node the object with uniqueID was loaded from
+//
+osgDB::XmlNode* XmlClassManager::GetXmlNodeByID(const std::string& uniqueID)
+{
+	UniqueIDToObjectMap::iterator itr = _objectsByID.find(uniqueID);
+	if(itr == _objectsByID.end()){return NULL;}
+	return itr->second->first.get();
+}
+
+//
+//Read a changed xmlNode into the loaded object with the same uniqueID
+//
+bool XmlClassManager::ReloadNode(osg::ref_ptr<osgDB::XmlNode> xmlNode, bool deserialize)
+{
+	if(!xmlNode.valid()){return false;}
+	std::string uniqueIDStr;
+	getXmlPropertyValue(xmlNode.get(), "uniqueID", uniqueIDStr);
+	UniqueIDToObjectMap::iterator itr = _objectsByID.find(uniqueIDStr);
+	if(itr == _objectsByID.end()){return false;}
+
+	//index the object by the new node, releasing the old one
+	XmlClassWrapperPtr wrapper = itr->second->second;
+	_objectList.erase(itr->second);
+	itr->second = _objectList.insert(XmlNodeToObjectPair(xmlNode, wrapper)).first;
+	if(!deserialize){return true;}
+
+	if(!wrapper->reload(xmlNode.get()))
+	{
+		OSG_WARN << "XmlClassManager::ReloadNode: ERROR: Failed to reload node with uniqueID '" << uniqueIDStr << "', it may be partially updated." << std::endl;
+		return false;
+	}
+	hogbox::MemoryTracker::Inst()->TrackObject(wrapper->getWrappedObject(), "", uniqueIDStr);
+	return true;
+}
 
 void XmlClassManager::SupportsClassType(const std::string& className,  XmlClassWrapperPtr wrapper)
 {
 	_supportedClassTypes[className] = wrapper;
+	HogBoxRegistry::Inst()->AddClassTypeManager(className, this);
 }
 
 //
@@ -162,7 +235,10 @@ XmlClassWrapper* XmlClassManager::allocateXmlClassWrapperForType(const std::stri
         OSG_FATAL << "XmlClassManager::allocateXmlClassWrapperForType: ERROR: Manager does not support class type '" << className << "'." << std::endl;
         return NULL;
     }
-    return _supportedClassTypes[className]->cloneType();
+    //exact match, else the wildcard wrapper
+    ClassTypeWrapperMap::iterator itr = _supportedClassTypes.find(className);
+    if(itr == _supportedClassTypes.end()){itr = _supportedClassTypes.find("*");}
+    return itr->second->cloneType();
 }
 
 //
@@ -246,4 +322,24 @@ osgDB::XmlNodePtr XmlClassManager::writeObjectToXmlNode(XmlClassWrapperPtr xmlWr
     return writeNode;
 }
 
+//
+//will allocate the relevant xmlclasswrapper for the object
+//then use it to write the object to out
+//
+bool XmlClassManager::writeObjectToXmlStream(osg::ObjectPtr object, XmlStreamWriter& out)
+{
+    if(!object.get()){
+        OSG_FATAL << "XmlClassManager::writeObjectToXmlStream: ERROR: Invalid Object." << std::endl;
+        return false;
+    }
+    hogboxDB::XmlClassWrapperPtr xmlWrapper = this->allocateXmlClassWrapperForType(object->className());
+    if(!xmlWrapper.get()){
+        OSG_FATAL << "XmlClassManager::writeObjectToXmlStream: ERROR: Failed to allocate XmlWrapper for node '" << object->className() << "'" << std::endl;
+        return false;
+    }
+    xmlWrapper->setWrappedObject(object.get());
+    
+    return xmlWrapper->serialize(out);
+}
+
 
@@ -20,6 +20,13 @@ XmlClassWrapper::~XmlClassWrapper(void)
 	{	
 		(*itr).second->releaseAttribute();
 	}
+	if(_attributeTable.valid() && p_wrappedObject.valid())
+	{
+		for(unsigned int i=0; i<_attributeTable->getNumBindings(); i++){
+			_attributeTable->getBinding(i)->releaseAttribute(p_wrappedObject.get());
+		}
+	}
+	_attributeTable = NULL;
 	p_wrappedObject=NULL;
 }
 
@@ -56,6 +63,15 @@ void XmlClassWrapper::setWrappedObject(osg::Object* object)
     p_wrappedObject = object;
     //clear any existing attributes
     _xmlAttributes.clear();
+    this->bindAttributes();
+}
+
+//
+//Pick up the attribute table and bind any per object attributes
+//
+void XmlClassWrapper::bindAttributes()
+{
+    _attributeTable = this->getXmlAttributeTable();
     this->bindXmlAttributes();
 }
 
@@ -90,10 +106,13 @@ bool XmlClassWrapper::deserialize(osgDB::XmlNode* in)
 	if(!p_wrappedObject.get()){
         p_wrappedObject = this->allocateClassType();
         if(p_wrappedObject.get()){
-            this->bindXmlAttributes();
+            this->bindAttributes();
         }else{
             return false;
         }
+    }else if(!_attributeTable.valid()){
+        //object was allocated by the wrappers constructor
+        _attributeTable = this->getXmlAttributeTable();
     }
 	if(!in){return false;}
 
@@ -129,12 +148,14 @@ bool XmlClassWrapper::deserialize(osgDB::XmlNode* in)
 		//check current is valid
 		if(attNode)
 		{
-			//get any attribute matching the nodes name
-			XmlAttribute* xmlAttribute = this->get(attNode->name);
-			if(xmlAttribute)
+			//get any attribute matching the nodes name, from the class table first
+			const XmlAttributeBinding* binding = _attributeTable.valid() ? _attributeTable->find(attNode->name) : NULL;
+			XmlAttribute* xmlAttribute = binding ? NULL : this->get(attNode->name);
+			if(binding || xmlAttribute)
 			{
 				//if we get a matching attribute, pass the node for deserialising
-				if(!xmlAttribute->deserialize(attNode))
+				bool read = binding ? binding->deserialize(this, p_wrappedObject.get(), attNode) : xmlAttribute->deserialize(attNode);
+				if(!read)
 				{
 					//returned an error while deserializing the attribute, inform the user
 					//but carry on trying the other attributes as they are in seperate xmlnodes
@@ -181,6 +202,16 @@ osgDB::XmlNodePtr XmlClassWrapper::serialize()
     //set the unique id property
     hogboxDB::setXmlPropertyValue(xmlNode.get(), "uniqueID", p_wrappedObject->getName());
     
+    //serialize the class tables attributes
+    if(_attributeTable.valid()){
+        for(unsigned int i=0; i<_attributeTable->getNumBindings(); i++){
+            osgDB::XmlNodePtr attNode = _attributeTable->getBinding(i)->serialize(this, p_wrappedObject.get());
+            if(attNode.valid()){
+                xmlNode->children.push_back(attNode.get());
+            }
+        }
+    }
+    
     //iterate the xmlattributes and serialize each to an xmlnode attached as a child of this xmlnode
     XmlAttributeMap::iterator attItr = _xmlAttributes.begin();
     for( ; attItr!=_xmlAttributes.end(); attItr++){
@@ -195,6 +226,37 @@ osgDB::XmlNodePtr XmlClassWrapper::serialize()
     return xmlNode;
 }
 
+//
+//Write the wrapped object straight to out
+//
+bool XmlClassWrapper::serialize(XmlStreamWriter& out)
+{
+    //check we have a wrapped object to write
+    if(!p_wrappedObject.get()){
+        return false;
+    }
+    
+    out.beginNode(p_wrappedObject->className(), true);
+    out.addProperty("uniqueID", p_wrappedObject->getName());
+    
+    if(_attributeTable.valid()){
+        for(unsigned int i=0; i<_attributeTable->getNumBindings(); i++){
+            _attributeTable->getBinding(i)->serialize(this, p_wrappedObject.get(), out);
+        }
+    }
+    
+    XmlAttributeMap::iterator attItr = _xmlAttributes.begin();
+    for( ; attItr!=_xmlAttributes.end(); attItr++){
+        osgDB::XmlNodePtr attNode = (*attItr).second->serialize();
+        if(attNode.valid()){
+            out.writeNode(attNode.get());
+        }
+    }
+    
+    out.endNode();
+    return true;
+}
+
 //
 //Return the class name from an xml node, default is the nodes name,
 //but if a type property exists that is used instead
@@ -230,6 +292,11 @@ void XmlClassWrapper::printXmlInterface()
 								 << "                            <" << p_wrappedObject->className() << " uniqueID=''>" << std::endl;
 
 		//write out all the attributes
+		if(_attributeTable.valid()){
+			for(unsigned int i=0; i<_attributeTable->getNumBindings(); i++){
+				OSG_NOTICE << "                                    <" << _attributeTable->getBinding(i)->getName() << ">" << std::endl;
+			}
+		}
 		XmlAttributeMap::iterator _i = _xmlAttributes.begin();
 		for (;_i != _xmlAttributes.end(); ++_i) 
 		{
@@ -0,0 +1,319 @@
+#include <hogboxDB/XmlDatabaseIndex.h>
+
+#include <osg/Notify>
+#include <OpenThreads/ScopedLock>
+
+#include <cctype>
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+using namespace hogboxDB;
+
+namespace {
+
+//
+//Buffered reads of a stream, tracking the offset of the next char
+//
+class XmlScanner
+{
+public:
+	XmlScanner(std::istream& in)
+		: _in(in),
+		_buffer(64*1024),
+		_pos(0),
+		_size(0),
+		_offset(0)
+	{
+	}
+
+	//next char, or -1 at the end of the stream
+	int get(){
+		if(_pos == _size && !fill()){return -1;}
+		_offset++;
+		return (unsigned char)_buffer[_pos++];
+	}
+	int peek(){
+		if(_pos == _size && !fill()){return -1;}
+		return (unsigned char)_buffer[_pos];
+	}
+	//offset of the next char from the start of the stream
+	std::streamoff offset()const{return _offset;}
+
+	//
+	//Skip up to and including terminator (no more than 3 chars), false
+	//if the stream ends first
+	bool skipPast(const char* terminator){
+		unsigned int length = strlen(terminator);
+		char window[3] = {0,0,0};
+		for(;;){
+			int c = get();
+			if(c < 0){return false;}
+			window[0] = window[1]; window[1] = window[2]; window[2] = (char)c;
+			if(strncmp(window+3-length, terminator, length) == 0){return true;}
+		}
+	}
+
+	//
+	//Append chars to name until whitespace, '/', '>', '=' or the end
+	void readName(std::string& name){
+		for(int c = peek(); c >= 0 && !isspace(c) && c != '/' && c != '>' && c != '='; c = peek()){
+			name += (char)get();
+		}
+	}
+
+	void skipSpace(){
+		while(peek() >= 0 && isspace(peek())){get();}
+	}
+
+protected:
+
+	bool fill(){
+		_in.read(&_buffer[0], _buffer.size());
+		_size = (unsigned int)_in.gcount();
+		_pos = 0;
+		return _size > 0;
+	}
+
+	std::istream& _in;
+	std::vector<char> _buffer;
+	unsigned int _pos;
+	unsigned int _size;
+	std::streamoff _offset;
+};
+
+//
+//An element that hasn't closed yet, and its uniqueID if we index it
+//
+struct OpenElement
+{
+	std::string _name;
+	std::string _uniqueID;
+};
+
+//
+//Replace the escapes osgDB::XmlNode::Input decodes in property values
+//
+std::string DecodeEntities(const std::string& value)
+{
+	if(value.find('&') == std::string::npos){return value;}
+	static const char* s_entities[5][2] = {
+		{"&amp;", "&"}, {"&lt;", "<"}, {"&gt;", ">"}, {"&quot;", "\""}, {"&apos;", "'"}
+	};
+	std::string decoded;
+	for(unsigned int i=0; i<value.size(); i++){
+		bool replaced = false;
+		for(unsigned int e=0; e<5 && !replaced && value[i] == '&'; e++){
+			if(value.compare(i, strlen(s_entities[e][0]), s_entities[e][0]) == 0){
+				decoded += s_entities[e][1];
+				i += strlen(s_entities[e][0])-1;
+				replaced = true;
+			}
+		}
+		if(!replaced){decoded += value[i];}
+	}
+	return decoded;
+}
+
+};
+
+XmlDatabaseIndex::XmlDatabaseIndex(void)
+	: osg::Referenced()
+{
+}
+
+XmlDatabaseIndex::~XmlDatabaseIndex(void)
+{
+	this->Close();
+}
+
+//
+//Scan fileName and index the elements inside its root node by uniqueID
+//
+bool XmlDatabaseIndex::Open(const std::string& fileName, const std::string& rootName)
+{
+	this->Close();
+
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_fileMutex);
+	_file.open(fileName.c_str(), std::ios::in | std::ios::binary);
+	if(!_file.is_open()){
+		OSG_WARN << "XmlDatabaseIndex::Open: ERROR: Failed to open '" << fileName << "'." << std::endl;
+		return false;
+	}
+	_fileName = fileName;
+
+	if(!this->IndexElements(rootName)){
+		_file.close();
+		_file.clear();
+		_fileName.clear();
+		_entries.clear();
+		return false;
+	}
+	return true;
+}
+
+//
+//Close the file and clear the index
+//
+void XmlDatabaseIndex::Close()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_fileMutex);
+	if(_file.is_open()){_file.close();}
+	_file.clear();
+	_fileName.clear();
+	_entries.clear();
+}
+
+//
+//Return the entry for uniqueID, or NULL
+//
+const XmlDatabaseIndex::Entry* XmlDatabaseIndex::Find(const std::string& uniqueID)const
+{
+	UniqueIDEntryMap::const_iterator itr = _entries.find(uniqueID);
+	return itr != _entries.end() ? &itr->second : NULL;
+}
+
+//
+//Parse the element with uniqueID from the file
+//
+osgDB::XmlNodePtr XmlDatabaseIndex::ReadNode(const std::string& uniqueID)
+{
+	const Entry* entry = this->Find(uniqueID);
+	if(!entry){return NULL;}
+
+	std::string buffer((size_t)(entry->_end - entry->_begin), '\0');
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_fileMutex);
+		_file.clear();
+		_file.seekg(entry->_begin);
+		_file.read(&buffer[0], buffer.size());
+		if(_file.gcount() != (std::streamsize)buffer.size()){
+			OSG_WARN << "XmlDatabaseIndex::ReadNode: ERROR: Failed to read node '" << uniqueID << "' from '" << _fileName << "'." << std::endl;
+			return NULL;
+		}
+	}
+
+	//parse just the element, in the same way as the whole file would be
+	std::istringstream stream(buffer);
+	osgDB::XmlNode::Input input;
+	input.attach(stream);
+	input.readAllDataIntoBuffer();
+
+	osg::ref_ptr<osgDB::XmlNode> doc = new osgDB::XmlNode;
+	doc->read(input);
+	for(osgDB::XmlNode::Children::iterator itr = doc->children.begin();
+		itr != doc->children.end();
+		++itr)
+	{
+		if((*itr)->name == entry->_classType){return (*itr);}
+	}
+
+	OSG_WARN << "XmlDatabaseIndex::ReadNode: ERROR: Failed to parse node '" << uniqueID << "' from '" << _fileName << "'." << std::endl;
+	return NULL;
+}
+
+//
+//Scan the elements of _file, recording where those with a uniqueID are. Stops
+//once the root node closes
+//
+bool XmlDatabaseIndex::IndexElements(const std::string& rootName)
+{
+	//elements that haven't closed yet
+	std::vector<OpenElement> open;
+	bool inRoot = false;
+
+	XmlScanner scanner(_file);
+	for(int c = scanner.get(); c >= 0; c = scanner.get())
+	{
+		//skip contents
+		if(c != '<'){continue;}
+		std::streamoff begin = scanner.offset()-1;
+
+		//declarations, comments and cdata
+		c = scanner.peek();
+		if(c == '?'){
+			if(!scanner.skipPast("?>")){break;}
+			continue;
+		}
+		if(c == '!'){
+			scanner.get();
+			const char* terminator = ">";
+			if(scanner.peek() == '-'){
+				scanner.get(); scanner.get();
+				terminator = "-->";
+			}else if(scanner.peek() == '['){
+				terminator = "]]>";
+			}
+			if(!scanner.skipPast(terminator)){break;}
+			continue;
+		}
+
+		//closing tag
+		if(c == '/'){
+			scanner.get();
+			std::string name;
+			scanner.readName(name);
+			if(!scanner.skipPast(">")){break;}
+			if(open.empty() || open.back()._name != name){
+				OSG_WARN << "XmlDatabaseIndex::Open: ERROR: Unexpected closing tag '" << name << "' in '" << _fileName << "'." << std::endl;
+				return false;
+			}
+			if(!open.back()._uniqueID.empty()){
+				_entries[open.back()._uniqueID]._end = scanner.offset();
+			}
+			open.pop_back();
+			if(inRoot && open.empty()){return true;}
+			continue;
+		}
+
+		//opening tag, find its uniqueID property and if it closes itself
+		std::string name;
+		scanner.readName(name);
+		std::string uniqueID;
+		bool selfClosing = false;
+		bool closed = false;
+		for(c = scanner.get(); c >= 0; c = scanner.get())
+		{
+			if(c == '>'){closed = true; break;}
+			if(isspace(c)){continue;}
+			selfClosing = c == '/';
+			if(selfClosing){continue;}
+
+			std::string property(1, (char)c);
+			scanner.readName(property);
+			scanner.skipSpace();
+			if(scanner.peek() != '='){continue;}
+			scanner.get();
+			scanner.skipSpace();
+			int quote = scanner.get();
+			if(quote != '"' && quote != '\''){break;}
+			std::string value;
+			for(c = scanner.get(); c >= 0 && c != quote; c = scanner.get()){value += (char)c;}
+			if(property == "uniqueID"){uniqueID = DecodeEntities(value);}
+		}
+		if(!closed){break;}
+
+		OpenElement element;
+		element._name = name;
+		if(!inRoot && open.empty() && name == rootName){
+			inRoot = true;
+			if(selfClosing){return true;}
+		}else if(inRoot && !uniqueID.empty() && _entries.find(uniqueID) != _entries.end()){
+			OSG_WARN << "XmlDatabaseIndex::Open: WARN: Duplicate uniqueID '" << uniqueID << "' on a <" << name << "> node in '" << _fileName << "', only the first is used." << std::endl;
+		}else if(inRoot && !uniqueID.empty()){
+			Entry& entry = _entries[uniqueID];
+			entry._classType = name;
+			entry._begin = begin;
+			entry._end = scanner.offset();
+			element._uniqueID = uniqueID;
+		}
+		if(!selfClosing){open.push_back(element);}
+	}
+
+	if(inRoot){
+		OSG_WARN << "XmlDatabaseIndex::Open: ERROR: '" << _fileName << "' ended before its <" << rootName << "> node closed." << std::endl;
+	}else{
+		OSG_WARN << "XmlDatabaseIndex::Open: ERROR: '" << _fileName << "' contains no <" << rootName << "> node." << std::endl;
+	}
+	return false;
+}
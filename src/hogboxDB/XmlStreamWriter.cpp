@@ -0,0 +1,359 @@
+#include <hogboxDB/XmlStreamWriter.h>
+
+#include <osg/Notify>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+using namespace hogboxDB;
+
+XmlStreamWriter::XmlStreamWriter(std::ostream& out)
+	: _out(out),
+	_buffer(64*1024),
+	_size(0),
+	_depth(0),
+	_tagOpen(false)
+{
+}
+
+XmlStreamWriter::~XmlStreamWriter(void)
+{
+	this->closeTag();
+	this->flush();
+}
+
+//
+//Open a node inside the current group node
+//
+void XmlStreamWriter::beginNode(const std::string& name, bool group)
+{
+	this->closeTag();
+	if(_depth > 0 && !_open[_depth-1]._group){
+		OSG_WARN << "XmlStreamWriter::beginNode: ERROR: Node '" << name << "' is inside node '" << _open[_depth-1]._name << "' which isn't a group." << std::endl;
+	}
+
+	this->writeIndent(_depth);
+	this->write('<');
+	this->write(name);
+
+	if(_depth == _open.size()){_open.push_back(OpenNode());}
+	_open[_depth]._name = name;
+	_open[_depth]._group = group;
+	_depth++;
+	_tagOpen = true;
+}
+
+//
+//Add a property to the node just opened
+//
+void XmlStreamWriter::addProperty(const std::string& name, const std::string& value)
+{
+	if(!_tagOpen){
+		OSG_WARN << "XmlStreamWriter::addProperty: ERROR: Property '" << name << "' must be added before the nodes contents or children." << std::endl;
+		return;
+	}
+	this->write(' ');
+	this->write(name);
+	this->write("=\"", 2);
+	this->writeEscaped(value.data(), value.size());
+	this->write('"');
+}
+
+void XmlStreamWriter::addProperty(const std::string& name, unsigned int value)
+{
+	if(!_tagOpen){
+		OSG_WARN << "XmlStreamWriter::addProperty: ERROR: Property '" << name << "' must be added before the nodes contents or children." << std::endl;
+		return;
+	}
+	this->write(' ');
+	this->write(name);
+	this->write("=\"", 2);
+	this->writeValue(value);
+	this->write('"');
+}
+
+//
+//Append to the contents of the current node
+//
+void XmlStreamWriter::addContents(const std::string& value)
+{
+	this->closeTag();
+	this->writeEscaped(value.data(), value.size());
+}
+
+void XmlStreamWriter::addContents(const char* value)
+{
+	this->closeTag();
+	this->writeEscaped(value, strlen(value));
+}
+
+void XmlStreamWriter::addContents(bool value)
+{
+	this->closeTag();
+	this->write(value ? '1' : '0');
+}
+
+void XmlStreamWriter::addContents(int value)
+{
+	this->closeTag();
+	this->writeValue(value);
+}
+
+void XmlStreamWriter::addContents(unsigned int value)
+{
+	this->closeTag();
+	this->writeValue(value);
+}
+
+void XmlStreamWriter::addContents(float value)
+{
+	this->closeTag();
+	this->writeValue((double)value);
+}
+
+void XmlStreamWriter::addContents(double value)
+{
+	this->closeTag();
+	this->writeValue(value);
+}
+
+void XmlStreamWriter::addContents(const osg::Vec2& value)
+{
+	this->closeTag();
+	this->writeValue((double)value.x()); this->write(' ');
+	this->writeValue((double)value.y());
+}
+
+void XmlStreamWriter::addContents(const osg::Vec3& value)
+{
+	this->closeTag();
+	this->writeValue((double)value.x()); this->write(' ');
+	this->writeValue((double)value.y()); this->write(' ');
+	this->writeValue((double)value.z());
+}
+
+void XmlStreamWriter::addContents(const osg::Vec4& value)
+{
+	this->closeTag();
+	this->writeValue((double)value.x()); this->write(' ');
+	this->writeValue((double)value.y()); this->write(' ');
+	this->writeValue((double)value.z()); this->write(' ');
+	this->writeValue((double)value.w());
+}
+
+void XmlStreamWriter::addContents(const osg::Quat& value)
+{
+	this->closeTag();
+	this->writeValue((double)value.x()); this->write(' ');
+	this->writeValue((double)value.y()); this->write(' ');
+	this->writeValue((double)value.z()); this->write(' ');
+	this->writeValue((double)value.w());
+}
+
+void XmlStreamWriter::addContents(const osg::Matrix& value)
+{
+	this->closeTag();
+	for(unsigned int row=0; row<4; row++){
+		for(unsigned int col=0; col<4; col++){
+			if(row+col > 0){this->write(' ');}
+			this->writeValue((double)value(row,col));
+		}
+	}
+}
+
+//
+//Close the current node
+//
+void XmlStreamWriter::endNode()
+{
+	if(_depth == 0){
+		OSG_WARN << "XmlStreamWriter::endNode: ERROR: There is no node open to end." << std::endl;
+		return;
+	}
+	this->closeTag();
+	_depth--;
+	const OpenNode& node = _open[_depth];
+	if(node._group){this->writeIndent(_depth);}
+	this->write("</", 2);
+	this->write(node._name);
+	this->write(">\n", 2);
+}
+
+//
+//Write an existing node and its children, as osgDB::XmlNode::write
+//
+bool XmlStreamWriter::writeNode(const osgDB::XmlNode* xmlNode)
+{
+	if(!xmlNode){return false;}
+
+	osgDB::XmlNode::Properties::const_iterator propItr;
+	switch(xmlNode->type)
+	{
+		case osgDB::XmlNode::ATOM:
+			this->closeTag();
+			this->writeIndent(_depth);
+			this->write('<');
+			this->write(xmlNode->name);
+			for(propItr = xmlNode->properties.begin(); propItr != xmlNode->properties.end(); propItr++){
+				this->write(' ');
+				this->write(propItr->first);
+				this->write("=\"", 2);
+				this->writeEscaped(propItr->second.data(), propItr->second.size());
+				this->write('"');
+			}
+			this->write(" />\n", 4);
+			return true;
+		case osgDB::XmlNode::ROOT:
+			for(unsigned int i=0; i<xmlNode->children.size(); i++){
+				if(!this->writeNode(xmlNode->children[i].get())){return false;}
+			}
+			return true;
+		case osgDB::XmlNode::NODE:
+		case osgDB::XmlNode::GROUP:
+		{
+			bool group = xmlNode->type == osgDB::XmlNode::GROUP;
+			this->beginNode(xmlNode->name, group);
+			for(propItr = xmlNode->properties.begin(); propItr != xmlNode->properties.end(); propItr++){
+				this->addProperty(propItr->first, propItr->second);
+			}
+			if(group){
+				for(unsigned int i=0; i<xmlNode->children.size(); i++){
+					if(!this->writeNode(xmlNode->children[i].get())){return false;}
+				}
+			}else{
+				this->addContents(xmlNode->contents);
+			}
+			this->endNode();
+			return true;
+		}
+		case osgDB::XmlNode::COMMENT:
+			this->closeTag();
+			this->writeIndent(_depth);
+			this->write("<!--", 4);
+			this->write(xmlNode->contents);
+			this->write("-->\n", 4);
+			return true;
+		case osgDB::XmlNode::INFORMATION:
+			this->writeInformation(xmlNode->contents);
+			return true;
+		default:
+			break;
+	}
+	return false;
+}
+
+//
+//Write an information node
+//
+void XmlStreamWriter::writeInformation(const std::string& contents)
+{
+	this->closeTag();
+	this->writeIndent(_depth);
+	this->write("<?", 2);
+	this->write(contents);
+	this->write("?>\n", 3);
+}
+
+//
+//Write the buffer to the stream
+//
+bool XmlStreamWriter::flush()
+{
+	if(_size > 0){
+		_out.write(&_buffer[0], _size);
+		_size = 0;
+	}
+	return _out.good();
+}
+
+//
+//Finish the opening tag of the current node, groups put their children on
+//the following lines
+//
+void XmlStreamWriter::closeTag()
+{
+	if(!_tagOpen){return;}
+	_tagOpen = false;
+	if(_open[_depth-1]._group){
+		this->write(">\n", 2);
+	}else{
+		this->write('>');
+	}
+}
+
+void XmlStreamWriter::writeIndent(unsigned int depth)
+{
+	for(unsigned int i=0; i<depth; i++){
+		this->write("  ", 2);
+	}
+}
+
+void XmlStreamWriter::write(const char* str, unsigned int length)
+{
+	while(length > 0)
+	{
+		if(_size == _buffer.size()){this->flush();}
+		unsigned int count = std::min(length, (unsigned int)_buffer.size()-_size);
+		memcpy(&_buffer[_size], str, count);
+		_size += count;
+		str += count;
+		length -= count;
+	}
+}
+
+//
+//Write str with the escapes osgDB::XmlNode::write uses
+//
+void XmlStreamWriter::writeEscaped(const char* str, unsigned int length)
+{
+	for(unsigned int i=0; i<length; i++)
+	{
+		switch(str[i])
+		{
+			case '&': this->write("&amp;", 5); break;
+			case '<': this->write("&lt;", 4); break;
+			case '>': this->write("&gt;", 4); break;
+			case '"': this->write("&quot;", 6); break;
+			case '\'': this->write("&apos;", 6); break;
+			default: this->write(str[i]); break;
+		}
+	}
+}
+
+void XmlStreamWriter::writeValue(unsigned int value)
+{
+	//digits backwards from the end of a buffer
+	char digits[16];
+	char* start = digits + sizeof(digits);
+	do{
+		*--start = (char)('0' + value % 10);
+		value /= 10;
+	}while(value > 0);
+	this->write(start, (unsigned int)(digits + sizeof(digits) - start));
+}
+
+void XmlStreamWriter::writeValue(int value)
+{
+	if(value < 0){
+		this->write('-');
+		//negate as unsigned so the most negative int doesn't overflow
+		this->writeValue(0u - (unsigned int)value);
+	}else{
+		this->writeValue((unsigned int)value);
+	}
+}
+
+void XmlStreamWriter::writeValue(double value)
+{
+	//whole numbers print as integers under %g below a million, so skip sprintf
+	//for them. Negative zero is left to print as -0
+	if(value > -1000000.0 && value < 1000000.0 && value == (double)(int)value && (value != 0.0 || 1.0/value > 0.0)){
+		this->writeValue((int)value);
+		return;
+	}
+	//%g with the default precision of 6, as std::stringstream formats
+	char digits[32];
+	int length = sprintf(digits, "%g", value);
+	if(length > 0){this->write(digits, (unsigned int)length);}
+}
@@ -1,6 +1,7 @@
 #include <hogboxHUD/HudInputHandler.h>
 
 #include <hogboxHUD/Hud.h>
+#include <hogbox/Profiler.h>
 
 using namespace hogboxHUD;
 
@@ -137,6 +138,8 @@ bool HudInputHandler::handle(const osgGA::GUIEventAdapter& ea,osgGA::GUIActionAd
 //
 void HudInputHandler::pick(const osgGA::GUIEventAdapter& ea, bool hudPick) //mode 0 = push, 1=release, 2 = double click
 {
+	HOGBOX_PROFILE_SCOPE("HudInputHandler::pick");
+
 	//select the sub graph to pick from based on hudPick
 	osg::Node* scene = NULL;
 	if(true){//hudPick){
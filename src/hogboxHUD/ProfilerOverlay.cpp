@@ -0,0 +1,109 @@
+#include <hogboxHUD/ProfilerOverlay.h>
+
+#include <hogbox/Profiler.h>
+
+#include <sstream>
+
+using namespace hogboxHUD;
+
+//
+//Refreshes the overlay once its interval has passed
+//
+class ProfilerOverlay::RefreshCallback : public osg::NodeCallback
+{
+public:
+    RefreshCallback(ProfilerOverlay* overlay)
+        : osg::NodeCallback(),
+        p_overlay(overlay)
+    {
+    }
+    
+    virtual void operator()(osg::Node* node, osg::NodeVisitor* nv)
+    {
+        osg::Timer_t now = osg::Timer::instance()->tick();
+        if(osg::Timer::instance()->delta_s(p_overlay->_lastRefresh, now) >= p_overlay->_refreshInterval){
+            p_overlay->Refresh();
+        }
+        osg::NodeCallback::traverse(node,nv);
+    }
+    
+protected:
+    
+    virtual ~RefreshCallback(void){}
+    
+protected:
+    //the overlay owns the node we're attached to
+    ProfilerOverlay* p_overlay;
+};
+
+ProfilerOverlay::ProfilerOverlay(TextRegionStyle* style)
+    : TextRegion(style),
+    _numFrames(60),
+    _refreshInterval(0.5f),
+    _lastRefresh(0)
+{
+}
+
+/** Copy constructor using CopyOp to manage deep vs shallow copy.*/
+ProfilerOverlay::ProfilerOverlay(const ProfilerOverlay& region,const osg::CopyOp& copyop)
+    : TextRegion(region, copyop),
+    _numFrames(region._numFrames),
+    _refreshInterval(region._refreshInterval),
+    _lastRefresh(0)
+{
+}
+
+ProfilerOverlay::~ProfilerOverlay(void)
+{
+}
+
+//
+//Create left aligned text and start refreshing
+//
+bool ProfilerOverlay::Create(osg::Vec2 corner, osg::Vec2 size, RegionStyle* style)
+{
+    if(!TextRegion::Create(corner, size, style)){return false;}
+    
+    this->SetAlignment(LEFT_ALIGN);
+    this->SetFontHeight(12.0f);
+    this->AddUpdateCallback(new RefreshCallback(this));
+    this->Refresh();
+    return true;
+}
+
+void ProfilerOverlay::SetNumFrames(const unsigned int& numFrames)
+{
+    _numFrames = numFrames;
+}
+
+const unsigned int& ProfilerOverlay::GetNumFrames()const
+{
+    return _numFrames;
+}
+
+void ProfilerOverlay::SetRefreshInterval(const float& seconds)
+{
+    _refreshInterval = seconds;
+}
+
+const float& ProfilerOverlay::GetRefreshInterval()const
+{
+    return _refreshInterval;
+}
+
+//
+//Rebuild the text from the profilers summary
+//
+void ProfilerOverlay::Refresh()
+{
+    _lastRefresh = osg::Timer::instance()->tick();
+    
+    if(!hogbox::Profiler::IsEnabled()){
+        this->SetText("Profiler disabled");
+        return;
+    }
+    
+    std::ostringstream summary;
+    hogbox::Profiler::Inst()->WriteSummary(summary, _numFrames);
+    this->SetText(summary.str());
+}
@@ -0,0 +1,130 @@
+#include <hogboxStage/BroadPhase.h>
+
+#include <algorithm>
+#include <float.h>
+
+using namespace hogboxStage;
+
+BroadPhase::BroadPhase()
+	: osg::Referenced(),
+	_lastNumMoved(0)
+{
+}
+
+BroadPhase::~BroadPhase(void)
+{
+}
+
+//
+//Flag a proxy to be requeried by the next UpdatePairs
+//
+void BroadPhase::BufferMove(int proxyID)
+{
+	if(proxyID < 0){return;}
+	if(proxyID >= (int)_movedFlags.size()){
+		_movedFlags.resize(proxyID+1, 0);
+	}
+	if(_movedFlags[proxyID]){return;}
+	_movedFlags[proxyID] = 1;
+	_moveBuffer.push_back(proxyID);
+}
+
+//
+//Returns true if the pair contains a proxy flagged as moved
+//
+struct PairHasMovedProxy
+{
+	PairHasMovedProxy(const std::vector<unsigned char>& flags)
+		: _flags(flags)
+	{
+	}
+	bool operator()(const ProxyPair& pair)const{
+		return _flags[pair._a] || _flags[pair._b];
+	}
+	const std::vector<unsigned char>& _flags;
+};
+
+//
+//Bring the overlapping pair list up to date and return it
+//
+const ProxyPairVector& BroadPhase::UpdatePairs()
+{
+	_lastNumMoved = _moveBuffer.size();
+	if(_moveBuffer.empty()){return _pairs;}
+
+	//drop every pair involving a moved proxy, they are all requeried below
+	_pairs.erase(std::remove_if(_pairs.begin(), _pairs.end(), PairHasMovedProxy(_movedFlags)), _pairs.end());
+
+	for(unsigned int i=0; i<_moveBuffer.size(); i++)
+	{
+		int proxyID = _moveBuffer[i];
+		//destroyed since it was buffered
+		if(!IsValidProxy(proxyID)){continue;}
+
+		_queryResults.clear();
+		QueryBox(GetProxyBox(proxyID), _queryResults);
+		for(unsigned int r=0; r<_queryResults.size(); r++)
+		{
+			int otherID = _queryResults[r];
+			if(otherID == proxyID){continue;}
+			//both moved, only add the pair once
+			if(_movedFlags[otherID] && otherID < proxyID){continue;}
+			_pairs.push_back(ProxyPair(proxyID, otherID));
+		}
+	}
+
+	for(unsigned int i=0; i<_moveBuffer.size(); i++){
+		_movedFlags[_moveBuffer[i]] = 0;
+	}
+	_moveBuffer.clear();
+
+	std::sort(_pairs.begin(), _pairs.end());
+	return _pairs;
+}
+
+//
+//Append the ids of all proxies whose box overlaps the sphere
+//
+void BroadPhase::QuerySphere(const osg::Vec3& center, const float& radius, std::vector<int>& results)
+{
+	osg::Vec3 extent(radius, radius, radius);
+	_queryResults.clear();
+	QueryBox(osg::BoundingBox(center-extent, center+extent), _queryResults);
+
+	float radius2 = radius*radius;
+	for(unsigned int i=0; i<_queryResults.size(); i++)
+	{
+		//distance from the center to the closest point on the box
+		const osg::BoundingBox& box = GetProxyBox(_queryResults[i]);
+		float dist2 = 0.0f;
+		for(unsigned int axis=0; axis<3; axis++){
+			float v = center[axis];
+			if(v < box._min[axis]){dist2 += (box._min[axis]-v)*(box._min[axis]-v);}
+			else if(v > box._max[axis]){dist2 += (v-box._max[axis])*(v-box._max[axis]);}
+		}
+		if(dist2 <= radius2){
+			results.push_back(_queryResults[i]);
+		}
+	}
+}
+
+//
+//Slab test of a ray against a box
+//
+bool BroadPhase::RayIntersectsBox(const osg::Vec3& origin, const osg::Vec3& invDirection,
+								const osg::BoundingBox& box, const float& maxDistance, float& distance)
+{
+	float tmin = 0.0f;
+	float tmax = maxDistance;
+	for(unsigned int axis=0; axis<3; axis++)
+	{
+		float t1 = (box._min[axis]-origin[axis])*invDirection[axis];
+		float t2 = (box._max[axis]-origin[axis])*invDirection[axis];
+		if(t1 > t2){float tmp = t1; t1 = t2; t2 = tmp;}
+		if(t1 > tmin){tmin = t1;}
+		if(t2 < tmax){tmax = t2;}
+		if(tmin > tmax){return false;}
+	}
+	distance = tmin;
+	return true;
+}
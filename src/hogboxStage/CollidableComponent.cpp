@@ -0,0 +1,99 @@
+#include <hogboxStage/CollidableComponent.h>
+#include <hogboxStage/CollisionSystem.h>
+
+using namespace hogboxStage;
+
+CollidableComponent::CollidableComponent()
+	: Component(),
+	p_collisionSystem(NULL),
+	_proxyID(-1),
+	_movedQueued(false)
+{
+	//posted each step we overlap other collidables
+	AddCallbackEventType("OnCollide", new CollideEvent());
+
+	//this depends on WorldTransformComponent to position our bounds
+	AddComponentDependency("WorldTransformComponent");
+}
+
+CollidableComponent::CollidableComponent(const CollidableComponent& ent,const osg::CopyOp& copyop)
+	: Component(ent, copyop),
+	_localBounds(ent._localBounds),
+	_transform(ent._transform),
+	p_collisionSystem(NULL),
+	_proxyID(-1),
+	_movedQueued(false)
+{
+	AddCallbackEventType("OnCollide", new CollideEvent());
+	AddComponentDependency("WorldTransformComponent");
+}
+
+CollidableComponent::~CollidableComponent(void)
+{
+}
+
+//
+//Register for OnMoved from the entities WorldTransformComponent
+//
+bool CollidableComponent::HandleComponentDependency(Component* component)
+{
+	WorldTransformComponent* transComp = dynamic_cast<WorldTransformComponent*>(component);
+	if(transComp){
+		transComp->RegisterCallbackForEvent(new ComponentEventObjectCallback<CollidableComponent>(this,this,
+																&CollidableComponent::OnEntityMovedCallback),
+																WorldTransformComponent::OnMovedEventID());
+		SetTransform(transComp->GetTransform());
+		return true;
+	}
+	return false;
+}
+
+void CollidableComponent::SetLocalBounds(const osg::BoundingBox& bounds)
+{
+	_localBounds = bounds;
+	MarkMoved();
+}
+
+void CollidableComponent::SetTransform(const osg::Matrix& trans)
+{
+	_transform = trans;
+	MarkMoved();
+}
+
+//
+//The local bounds transformed into world space
+//
+osg::BoundingBox CollidableComponent::ComputeWorldBounds()const
+{
+	osg::BoundingBox worldBounds;
+	if(!_localBounds.valid()){return worldBounds;}
+	for(unsigned int i=0; i<8; i++){
+		worldBounds.expandBy(_localBounds.corner(i) * _transform);
+	}
+	return worldBounds;
+}
+
+//
+//Callback triggered when an entities WorldTransformComponent is changed/moved
+//
+void CollidableComponent::OnEntityMovedCallback(Component* sender, ComponentEventPtr moveEvent)
+{
+	MovedEvent* movedEvent = dynamic_cast<MovedEvent*>(moveEvent.get());
+	if(movedEvent){
+		SetTransform(movedEvent->_transform);
+	}
+}
+
+void CollidableComponent::MarkMoved()
+{
+	if(p_collisionSystem){
+		p_collisionSystem->MarkMoved(this);
+	}
+}
+
+void CollidableComponent::PostCollide()
+{
+	ComponentEventData data;
+	data._values[0] = (double)_contacts.size();
+	this->PostEvent(OnCollideEventID(), data);
+}
@@ -0,0 +1,166 @@
+#include <hogboxStage/CollisionSystem.h>
+#include <hogboxStage/DynamicAABBTree.h>
+
+#include <algorithm>
+#include <OpenThreads/ScopedLock>
+
+using namespace hogboxStage;
+
+CollisionSystem::CollisionSystem(BroadPhase* broadPhase)
+	: ComponentSystem("CollisionSystem", "CollidableComponent"),
+	_broadPhase(broadPhase)
+{
+	if(!_broadPhase.valid()){
+		_broadPhase = new DynamicAABBTree();
+	}
+	//bounds come from the transform
+	AddReadType("WorldTransformComponent");
+}
+
+CollisionSystem::~CollisionSystem(void)
+{
+	for(unsigned int i=0; i<_components.size(); i++){
+		CollidableComponent* collidable = static_cast<CollidableComponent*>(_components[i].get());
+		collidable->p_collisionSystem = NULL;
+		collidable->_proxyID = -1;
+		collidable->_contacts.clear();
+	}
+}
+
+//
+//Add a component and create its broad phase proxy
+//
+bool CollisionSystem::AddComponent(Component* component)
+{
+	CollidableComponent* collidable = dynamic_cast<CollidableComponent*>(component);
+	if(!collidable || collidable->p_collisionSystem){return false;}
+	if(!ComponentSystem::AddComponent(component)){return false;}
+
+	collidable->p_collisionSystem = this;
+	collidable->_movedQueued = false;
+	collidable->_proxyID = _broadPhase->CreateProxy(collidable->ComputeWorldBounds(), collidable);
+	return true;
+}
+
+//
+//Destroy the components proxy and remove it
+//
+bool CollisionSystem::RemoveComponent(Component* component)
+{
+	CollidableComponent* collidable = dynamic_cast<CollidableComponent*>(component);
+	if(!collidable || collidable->p_collisionSystem != this){return false;}
+
+	//keep it alive until we're done with it
+	CollidableComponentPtr keep = collidable;
+	if(!ComponentSystem::RemoveComponent(component)){return false;}
+
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_movedMutex);
+		if(collidable->_movedQueued){
+			_moved.erase(std::remove(_moved.begin(), _moved.end(), collidable), _moved.end());
+		}
+	}
+
+	//nothing should be left pointing at it
+	for(unsigned int i=0; i<collidable->_contacts.size(); i++){
+		CollidableComponentVector& others = collidable->_contacts[i]->_contacts;
+		others.erase(std::remove(others.begin(), others.end(), collidable), others.end());
+	}
+	_touching.erase(std::remove(_touching.begin(), _touching.end(), collidable), _touching.end());
+
+	_broadPhase->DestroyProxy(collidable->_proxyID);
+	collidable->_proxyID = -1;
+	collidable->_movedQueued = false;
+	collidable->_contacts.clear();
+	collidable->p_collisionSystem = NULL;
+	return true;
+}
+
+//
+//Flag a component to have its proxy updated next step
+//
+void CollisionSystem::MarkMoved(CollidableComponent* component)
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_movedMutex);
+	if(component->_movedQueued){return;}
+	component->_movedQueued = true;
+	_moved.push_back(component);
+}
+
+//
+//Update moved proxies, rebuild contacts and post OnCollide
+//
+void CollisionSystem::Update(ComponentUpdate* update)
+{
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_movedMutex);
+		_moving.swap(_moved);
+		for(unsigned int i=0; i<_moving.size(); i++){
+			_moving[i]->_movedQueued = false;
+		}
+	}
+
+	for(unsigned int i=0; i<_moving.size(); i++){
+		_broadPhase->MoveProxy(_moving[i]->_proxyID, _moving[i]->ComputeWorldBounds());
+	}
+	_moving.clear();
+
+	const ProxyPairVector& pairs = _broadPhase->UpdatePairs();
+
+	//pairs only change when something moved, otherwise the contacts are still valid
+	if(_broadPhase->GetLastNumMoved() > 0)
+	{
+		for(unsigned int i=0; i<_touching.size(); i++){
+			_touching[i]->_contacts.clear();
+		}
+		_touching.clear();
+
+		for(unsigned int i=0; i<pairs.size(); i++)
+		{
+			CollidableComponent* a = static_cast<CollidableComponent*>(_broadPhase->GetProxyUserData(pairs[i]._a));
+			CollidableComponent* b = static_cast<CollidableComponent*>(_broadPhase->GetProxyUserData(pairs[i]._b));
+			if(a->_contacts.empty()){_touching.push_back(a);}
+			a->_contacts.push_back(b);
+			if(b->_contacts.empty()){_touching.push_back(b);}
+			b->_contacts.push_back(a);
+		}
+	}
+
+	for(unsigned int i=0; i<_touching.size(); i++){
+		_touching[i]->PostCollide();
+	}
+}
+
+//
+//Spatial queries
+//
+void CollisionSystem::QueryRay(const osg::Vec3& origin, const osg::Vec3& direction, const float& maxDistance, CollidableHitVector& hits)
+{
+	_rayHits.clear();
+	_broadPhase->QueryRay(origin, direction, maxDistance, _rayHits);
+	for(unsigned int i=0; i<_rayHits.size(); i++){
+		CollidableComponent* collidable = static_cast<CollidableComponent*>(_broadPhase->GetProxyUserData(_rayHits[i]._proxyID));
+		hits.push_back(CollidableHit(collidable, _rayHits[i]._distance));
+	}
+}
+
+void CollisionSystem::QuerySphere(const osg::Vec3& center, const float& radius, CollidableComponentVector& results)
+{
+	_proxyResults.clear();
+	_broadPhase->QuerySphere(center, radius, _proxyResults);
+	AppendComponents(_proxyResults, results);
+}
+
+void CollisionSystem::QueryBox(const osg::BoundingBox& box, CollidableComponentVector& results)
+{
+	_proxyResults.clear();
+	_broadPhase->QueryBox(box, _proxyResults);
+	AppendComponents(_proxyResults, results);
+}
+
+void CollisionSystem::AppendComponents(const std::vector<int>& proxyIDs, CollidableComponentVector& results)
+{
+	for(unsigned int i=0; i<proxyIDs.size(); i++){
+		results.push_back(static_cast<CollidableComponent*>(_broadPhase->GetProxyUserData(proxyIDs[i])));
+	}
+}
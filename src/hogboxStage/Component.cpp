@@ -1,10 +1,12 @@
 #include <hogboxStage/Component.h>
+#include <hogboxStage/ComponentEventQueue.h>
 
 using namespace hogboxStage;
 
 Component::Component()
 	: osg::Object(),
 	p_entity(NULL),
+	p_eventQueue(NULL),
 	_dependsResolved(false)
 {
 	//add the on desturct message
@@ -14,7 +16,8 @@ Component::Component()
 
 /** Copy constructor using CopyOp to manage deep vs shallow copy.*/
 Component::Component(const Component& ent,const osg::CopyOp& copyop)
-	: osg::Object(ent, copyop)
+	: osg::Object(ent, copyop),
+	p_eventQueue(NULL)
 {
 	//add the on desturct message
 	AddCallbackEventType("OnDestruct");
@@ -25,6 +28,33 @@ Component::~Component(void)
 {
 	//inform callback receivers of destuct (TEST)
 	TriggerEventCallback("OnDestruct", NULL);
+
+	//make sure nothing we posted is delivered after we're gone
+	for(unsigned int i=0; i<_callbackEvents.size(); i++){
+		if(_callbackEvents[i]->GetQueuedIndex() != -1){
+			GetEventQueue()->Cancel(_callbackEvents[i].get());
+		}
+	}
+}
+
+//
+//Set the queue PostEvent posts to, cancelling anything queued on the old one
+//
+void Component::SetEventQueue(ComponentEventQueue* queue)
+{
+	ComponentEventQueue* previous = GetEventQueue();
+	p_eventQueue = queue;
+	if(GetEventQueue() == previous){return;}
+	for(unsigned int i=0; i<_callbackEvents.size(); i++){
+		if(_callbackEvents[i]->GetQueuedIndex() != -1){
+			previous->Cancel(_callbackEvents[i].get());
+		}
+	}
+}
+
+ComponentEventQueue* Component::GetEventQueue()
+{
+	return p_eventQueue ? p_eventQueue : ComponentEventQueue::Inst();
 }
 
 //
@@ -42,6 +72,15 @@ bool Component::RegisterCallbackForEvent(ComponentEventCallback* callback, const
 	return true;
 }
 
+bool Component::RegisterCallbackForEvent(ComponentEventCallback* callback, const ComponentEventID& eventID)
+{
+	if(!callback){return false;}
+	int eventIndex = GetCallbackEventIndex(eventID);
+	if(eventIndex == -1){return false;}
+
+	return _callbackEvents[eventIndex]->AddCallbackReceiver(callback);
+}
+
 //
 //returns the index of the callback if it exists else -1
 //
@@ -55,6 +94,16 @@ int Component::GetCallbackEventIndex(const std::string& eventName)
 	return -1;
 }
 
+int Component::GetCallbackEventIndex(const ComponentEventID& eventID)
+{
+	for(unsigned int i=0; i<_callbackEvents.size(); i++){
+		if(_callbackEvents[i]->GetEventID() == eventID){
+			return (int)i;
+		}
+	}
+	return -1;
+}
+
 //
 //Returns true if this component depends on the passed type
 //
@@ -71,11 +120,11 @@ bool Component::DependsOnType(const std::string& typeName)
 //Adds a new ComponentCallbackEvent to our list ensuring the name is unique, this should be used
 //during a types constuctor to register any new event types, returns false if name already used
 //
-bool Component::AddCallbackEventType(const std::string& eventName)
+bool Component::AddCallbackEventType(const std::string& eventName, ComponentEvent* prototype)
 {
 	int existingIndex = GetCallbackEventIndex(eventName);
-	if(existingIndex == -1){return false;}
-	_callbackEvents.push_back(new ComponentCallbackEvent(this, eventName));
+	if(existingIndex != -1){return false;}
+	_callbackEvents.push_back(new ComponentCallbackEvent(this, eventName, prototype));
 	return true;
 }
 
@@ -90,13 +139,42 @@ bool Component::TriggerEventCallback(const std::string& eventName, ComponentEven
 	return true;
 }
 
+bool Component::TriggerEventCallback(const ComponentEventID& eventID, ComponentEventPtr entityEvent)
+{
+	int eventIndex = GetCallbackEventIndex(eventID);
+	if(eventIndex == -1){return false;}
+	_callbackEvents[eventIndex]->TriggerCallback(entityEvent);
+	return true;
+}
+
+//
+//Post an event payload to our ComponentEventQueue
+//
+bool Component::PostEvent(const ComponentEventID& eventID, const ComponentEventData& eventData)
+{
+	int eventIndex = GetCallbackEventIndex(eventID);
+	if(eventIndex == -1){return false;}
+	//no one listening, don't bother queuing
+	if(!_callbackEvents[eventIndex]->HasCallbackReceivers()){return true;}
+	return GetEventQueue()->Post(_callbackEvents[eventIndex].get(), eventData);
+}
+
 //
 //add a dependency on a component type
 //
-void Component::AddComponentDependency(const std::string& typeName)
+void Component::AddComponentDependency(const std::string& typeName, bool readOnly)
 {
-	//check if its already listed
+	//check if its already listed, a write dependency stays a write
 	ComponentDependencyMap::iterator itr = _dependComponents.find(typeName);
-	if(itr != _dependComponents.end()){return;}
+	if(itr != _dependComponents.end()){
+		if(!readOnly){_readOnlyDependComponents.erase(typeName);}
+		return;
+	}
 	_dependComponents.insert(ComponentDependencyPair(typeName, false));
+	if(readOnly){_readOnlyDependComponents.insert(typeName);}
+}
+
+bool Component::IsReadOnlyDependency(const std::string& typeName)const
+{
+	return _readOnlyDependComponents.find(typeName) != _readOnlyDependComponents.end();
 }
\ No newline at end of file
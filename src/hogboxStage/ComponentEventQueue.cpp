@@ -0,0 +1,223 @@
+#include <hogboxStage/ComponentEventQueue.h>
+
+#include <OpenThreads/ScopedLock>
+
+using namespace hogboxStage;
+
+//
+//Event name interning
+//
+typedef std::map<std::string, ComponentEventID> EventNameToIDMap;
+
+static OpenThreads::Mutex& GetEventNameMutex()
+{
+	static OpenThreads::Mutex s_eventNameMutex;
+	return s_eventNameMutex;
+}
+
+static EventNameToIDMap& GetEventNameToIDMap()
+{
+	static EventNameToIDMap s_eventNameToID;
+	return s_eventNameToID;
+}
+
+static std::vector<std::string>& GetEventNames()
+{
+	static std::vector<std::string> s_eventNames;
+	return s_eventNames;
+}
+
+ComponentEventID hogboxStage::GetComponentEventID(const std::string& eventName)
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(GetEventNameMutex());
+	EventNameToIDMap& ids = GetEventNameToIDMap();
+	EventNameToIDMap::iterator itr = ids.find(eventName);
+	if(itr != ids.end()){return (*itr).second;}
+
+	ComponentEventID id = GetEventNames().size();
+	GetEventNames().push_back(eventName);
+	ids.insert(std::pair<std::string, ComponentEventID>(eventName, id));
+	return id;
+}
+
+const std::string& hogboxStage::GetComponentEventName(const ComponentEventID& eventID)
+{
+	static const std::string s_unknown = "";
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(GetEventNameMutex());
+	if(eventID >= GetEventNames().size()){return s_unknown;}
+	return GetEventNames()[eventID];
+}
+
+//
+//Delivers a batch of a dispatch list on the pool
+//
+class ComponentEventQueue::DispatchTask : public hogbox::PoolTask
+{
+public:
+	DispatchTask(QueuedEventVector& events, unsigned int start, unsigned int end)
+		: hogbox::PoolTask(),
+		_events(events),
+		_start(start),
+		_end(end)
+	{
+	}
+	virtual void Run(){
+		ComponentEventQueue::DispatchRange(_events, _start, _end);
+	}
+protected:
+	virtual ~DispatchTask(void){}
+protected:
+	QueuedEventVector& _events;
+	unsigned int _start;
+	unsigned int _end;
+};
+
+static osg::ref_ptr<ComponentEventQueue> s_componentEventQueueInstance = NULL;
+
+ComponentEventQueue* ComponentEventQueue::Inst(bool erase)
+{
+	if(s_componentEventQueueInstance==NULL)
+	{s_componentEventQueueInstance = new ComponentEventQueue();}
+	if(erase)
+	{
+		s_componentEventQueueInstance = 0;
+	}
+	return s_componentEventQueueInstance.get();
+}
+
+ComponentEventQueue::ComponentEventQueue()
+	: osg::Referenced(),
+	_deferred(false),
+	_parallelDispatch(false),
+	_numPosted(0),
+	_numCoalesced(0),
+	_numDispatched(0)
+{
+}
+
+ComponentEventQueue::~ComponentEventQueue(void)
+{
+	//anything still queued is dropped
+	for(unsigned int i=0; i<_queued.size(); i++){
+		if(_queued[i]._event.get()){_queued[i]._event->SetQueuedIndex(-1);}
+	}
+}
+
+//
+//Post an event payload
+//
+bool ComponentEventQueue::Post(ComponentCallbackEvent* event, const ComponentEventData& data)
+{
+	if(!event){return false;}
+
+	if(!_deferred){
+		_numPosted++;
+		_numDispatched++;
+		event->TriggerCallback(data);
+		return true;
+	}
+
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+	_numPosted++;
+
+	//already queued this frame, just replace the payload
+	int index = event->GetQueuedIndex();
+	if(index >= 0 && index < (int)_queued.size() && _queued[index]._event.get() == event){
+		_queued[index]._data = data;
+		_numCoalesced++;
+		return true;
+	}
+
+	event->SetQueuedIndex(_queued.size());
+	_queued.push_back(QueuedEvent());
+	_queued.back()._event = event;
+	_queued.back()._data = data;
+	return true;
+}
+
+//
+//Remove a queued event without delivering it
+//
+void ComponentEventQueue::Cancel(ComponentCallbackEvent* event)
+{
+	if(!event){return;}
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+	int index = event->GetQueuedIndex();
+	if(index >= 0 && index < (int)_queued.size() && _queued[index]._event.get() == event){
+		_queued[index]._event = NULL;
+	}
+	event->SetQueuedIndex(-1);
+}
+
+//
+//Deliver all queued events
+//
+void ComponentEventQueue::Dispatch(hogbox::WorkStealingPool* pool)
+{
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+		_dispatching.swap(_queued);
+		//anything posted from here on goes in the next frame
+		for(unsigned int i=0; i<_dispatching.size(); i++){
+			if(_dispatching[i]._event.get()){_dispatching[i]._event->SetQueuedIndex(-1);}
+		}
+	}
+
+	unsigned int count = _dispatching.size();
+	if(count == 0){return;}
+
+	//each ComponentCallbackEvent appears at most once so batches never share a prototype event
+	const unsigned int batchSize = 256;
+	if(pool && _parallelDispatch && count > batchSize){
+		osg::ref_ptr<hogbox::TaskGroup> group = new hogbox::TaskGroup();
+		for(unsigned int start=0; start<count; start+=batchSize){
+			unsigned int end = start+batchSize < count ? start+batchSize : count;
+			pool->Submit(new DispatchTask(_dispatching, start, end), group.get());
+		}
+		pool->Wait(group.get());
+	}else{
+		DispatchRange(_dispatching, 0, count);
+	}
+
+	_numDispatched += count;
+	//release the refs but keep the capacity
+	_dispatching.clear();
+}
+
+//
+//Trigger a range of a dispatch list
+//
+void ComponentEventQueue::DispatchRange(QueuedEventVector& events, unsigned int start, unsigned int end)
+{
+	for(unsigned int i=start; i<end; i++){
+		if(events[i]._event.get()){
+			events[i]._event->TriggerCallback(events[i]._data);
+		}
+	}
+}
+
+//
+//Queue posted events until Dispatch
+//
+void ComponentEventQueue::SetDeferred(const bool& defer)
+{
+	if(_deferred == defer){return;}
+	//deliver anything already queued before switching to immediate mode
+	if(!defer){
+		Dispatch();
+	}
+	_deferred = defer;
+}
+
+unsigned int ComponentEventQueue::GetNumQueued()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+	return _queued.size();
+}
+
+void ComponentEventQueue::ResetStats()
+{
+	_numPosted = 0;
+	_numCoalesced = 0;
+	_numDispatched = 0;
+}
@@ -0,0 +1,107 @@
+#include <hogboxStage/ComponentSystem.h>
+
+#include <algorithm>
+
+using namespace hogboxStage;
+
+ComponentSystem::ComponentSystem(const std::string& name, const std::string& componentType)
+	: osg::Referenced(),
+	_name(name),
+	_componentType(componentType),
+	_modifiedCount(0)
+{
+	//we always write the type we update
+	_writeTypes.insert(componentType);
+}
+
+ComponentSystem::~ComponentSystem(void)
+{
+}
+
+//
+//Declare additional types this system reads or writes during Update
+//
+void ComponentSystem::AddReadType(const std::string& typeName)
+{
+	if(_readTypes.insert(typeName).second){
+		_modifiedCount++;
+	}
+}
+
+void ComponentSystem::AddWriteType(const std::string& typeName)
+{
+	if(_writeTypes.insert(typeName).second){
+		_modifiedCount++;
+	}
+}
+
+//
+//Returns true if the set a contains any of the names in b
+//
+static bool TypeSetsIntersect(const ComponentSystem::ComponentTypeSet& a, const ComponentSystem::ComponentTypeSet& b)
+{
+	ComponentSystem::ComponentTypeSet::const_iterator itr = a.begin();
+	for( ; itr!=a.end(); itr++){
+		if(b.find(*itr) != b.end()){return true;}
+	}
+	return false;
+}
+
+//
+//Returns true if the two systems can not safely run at the same time
+//
+bool ComponentSystem::ConflictsWith(const ComponentSystem* system)const
+{
+	if(!system){return false;}
+	if(system == this){return true;}
+	if(TypeSetsIntersect(_writeTypes, system->_writeTypes)){return true;}
+	if(TypeSetsIntersect(_writeTypes, system->_readTypes)){return true;}
+	if(TypeSetsIntersect(_readTypes, system->_writeTypes)){return true;}
+	return false;
+}
+
+//
+//Add a component to be updated, returns false if it isn't of our component type
+//
+bool ComponentSystem::AddComponent(Component* component)
+{
+	if(!component){return false;}
+	if(component->GetTypeName() != _componentType){return false;}
+	if(std::find(_components.begin(), _components.end(), component) != _components.end()){return false;}
+
+	_components.push_back(component);
+
+	//anything the component depends on is something we write, unless it says otherwise
+	const Component::ComponentDependencyMap& depends = component->GetComponentDependencies();
+	Component::ComponentDependencyMap::const_iterator itr = depends.begin();
+	for( ; itr!=depends.end(); itr++){
+		if(component->IsReadOnlyDependency((*itr).first)){
+			AddReadType((*itr).first);
+		}else{
+			AddWriteType((*itr).first);
+		}
+	}
+	return true;
+}
+
+//
+//Remove a component, returns false if it wasn't registered
+//
+bool ComponentSystem::RemoveComponent(Component* component)
+{
+	ComponentPtrVector::iterator itr = std::find(_components.begin(), _components.end(), component);
+	if(itr == _components.end()){return false;}
+	_components.erase(itr);
+	return true;
+}
+
+//
+//Run one step over all components
+//
+void ComponentSystem::Update(ComponentUpdate* update)
+{
+	ComponentEventPtr updateEvent = update;
+	for(unsigned int i=0; i<_components.size(); i++){
+		_components[i]->OnUpdate(updateEvent);
+	}
+}
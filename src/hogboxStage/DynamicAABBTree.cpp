@@ -0,0 +1,486 @@
+#include <hogboxStage/DynamicAABBTree.h>
+
+#include <algorithm>
+#include <float.h>
+
+using namespace hogboxStage;
+
+DynamicAABBTree::DynamicAABBTree(const float& margin)
+	: BroadPhase(),
+	_root(-1),
+	_freeList(-1),
+	_numProxies(0),
+	_margin(margin)
+{
+}
+
+DynamicAABBTree::~DynamicAABBTree(void)
+{
+}
+
+//
+//Create a proxy, returns its id
+//
+int DynamicAABBTree::CreateProxy(const osg::BoundingBox& box, void* userData)
+{
+	int proxyID = AllocateNode();
+
+	osg::Vec3 margin(_margin, _margin, _margin);
+	_nodes[proxyID]._box = box;
+	_nodes[proxyID]._fatBox = osg::BoundingBox(box._min-margin, box._max+margin);
+	_nodes[proxyID]._userData = userData;
+	_nodes[proxyID]._height = 0;
+
+	InsertLeaf(proxyID);
+	_numProxies++;
+
+	BufferMove(proxyID);
+	return proxyID;
+}
+
+//
+//Destroy a proxy
+//
+void DynamicAABBTree::DestroyProxy(int proxyID)
+{
+	if(!IsValidProxy(proxyID)){return;}
+	RemoveLeaf(proxyID);
+	FreeNode(proxyID);
+	_numProxies--;
+
+	//so any pairs it was part of are dropped
+	BufferMove(proxyID);
+}
+
+//
+//Set a proxies box, it is only reinserted if it has left its fat box
+//
+void DynamicAABBTree::MoveProxy(int proxyID, const osg::BoundingBox& box)
+{
+	if(!IsValidProxy(proxyID)){return;}
+
+	_nodes[proxyID]._box = box;
+
+	if(!Contains(_nodes[proxyID]._fatBox, box))
+	{
+		RemoveLeaf(proxyID);
+		osg::Vec3 margin(_margin, _margin, _margin);
+		_nodes[proxyID]._fatBox = osg::BoundingBox(box._min-margin, box._max+margin);
+		InsertLeaf(proxyID);
+	}
+
+	BufferMove(proxyID);
+}
+
+bool DynamicAABBTree::IsValidProxy(int proxyID)const
+{
+	if(proxyID < 0 || proxyID >= (int)_nodes.size()){return false;}
+	return _nodes[proxyID]._height == 0 && _nodes[proxyID].IsLeaf();
+}
+
+//
+//Append the ids of all proxies whose box overlaps box
+//
+void DynamicAABBTree::QueryBox(const osg::BoundingBox& box, std::vector<int>& results)
+{
+	if(_root == -1){return;}
+
+	_stack.clear();
+	_stack.push_back(_root);
+	while(!_stack.empty())
+	{
+		int nodeID = _stack.back();
+		_stack.pop_back();
+
+		const TreeNode& node = _nodes[nodeID];
+		if(!BoxesOverlap(node._fatBox, box)){continue;}
+
+		if(node.IsLeaf()){
+			if(BoxesOverlap(node._box, box)){
+				results.push_back(nodeID);
+			}
+		}else{
+			_stack.push_back(node._child1);
+			_stack.push_back(node._child2);
+		}
+	}
+}
+
+//
+//Append all proxies hit by the ray, nearest first
+//
+void DynamicAABBTree::QueryRay(const osg::Vec3& origin, const osg::Vec3& direction, const float& maxDistance, RayHitVector& hits)
+{
+	if(_root == -1){return;}
+
+	osg::Vec3 invDirection(1.0f/direction.x(), 1.0f/direction.y(), 1.0f/direction.z());
+	unsigned int firstHit = hits.size();
+
+	_stack.clear();
+	_stack.push_back(_root);
+	while(!_stack.empty())
+	{
+		int nodeID = _stack.back();
+		_stack.pop_back();
+
+		const TreeNode& node = _nodes[nodeID];
+		float distance;
+		if(!RayIntersectsBox(origin, invDirection, node._fatBox, maxDistance, distance)){continue;}
+
+		if(node.IsLeaf()){
+			if(RayIntersectsBox(origin, invDirection, node._box, maxDistance, distance)){
+				hits.push_back(RayHit(nodeID, distance));
+			}
+		}else{
+			_stack.push_back(node._child1);
+			_stack.push_back(node._child2);
+		}
+	}
+
+	std::sort(hits.begin()+firstHit, hits.end());
+}
+
+//
+//Orders leaves by the center of their box along one axis
+//
+struct DynamicAABBTree::LeafCenterLess
+{
+	LeafCenterLess(const std::vector<DynamicAABBTree::TreeNode>& nodes, unsigned int axis)
+		: _nodes(nodes),
+		_axis(axis)
+	{
+	}
+	bool operator()(int a, int b)const{
+		return _nodes[a]._fatBox._min[_axis]+_nodes[a]._fatBox._max[_axis] <
+				_nodes[b]._fatBox._min[_axis]+_nodes[b]._fatBox._max[_axis];
+	}
+	const std::vector<DynamicAABBTree::TreeNode>& _nodes;
+	unsigned int _axis;
+};
+
+//
+//Rebuild the tree top down by median splits
+//
+void DynamicAABBTree::Rebuild()
+{
+	if(_root == -1){return;}
+
+	//gather the leaves and free every internal node
+	std::vector<int> leaves;
+	leaves.reserve(_numProxies);
+	for(unsigned int i=0; i<_nodes.size(); i++)
+	{
+		if(_nodes[i]._height < 0){continue;}
+		if(_nodes[i].IsLeaf()){
+			leaves.push_back(i);
+		}else{
+			FreeNode(i);
+		}
+	}
+
+	_root = BuildSubtree(leaves, 0, leaves.size());
+	_nodes[_root]._parent = -1;
+}
+
+int DynamicAABBTree::BuildSubtree(std::vector<int>& leaves, unsigned int start, unsigned int end)
+{
+	if(end-start == 1){return leaves[start];}
+
+	//split on the longest axis of the leaf centers
+	osg::Vec3 centerMin(FLT_MAX, FLT_MAX, FLT_MAX);
+	osg::Vec3 centerMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	for(unsigned int i=start; i<end; i++){
+		osg::Vec3 center = (_nodes[leaves[i]]._fatBox._min + _nodes[leaves[i]]._fatBox._max)*0.5f;
+		for(unsigned int axis=0; axis<3; axis++){
+			if(center[axis] < centerMin[axis]){centerMin[axis] = center[axis];}
+			if(center[axis] > centerMax[axis]){centerMax[axis] = center[axis];}
+		}
+	}
+	osg::Vec3 extent = centerMax-centerMin;
+	unsigned int axis = 0;
+	if(extent.y() > extent[axis]){axis = 1;}
+	if(extent.z() > extent[axis]){axis = 2;}
+
+	unsigned int mid = start+(end-start)/2;
+	std::nth_element(leaves.begin()+start, leaves.begin()+mid, leaves.begin()+end, LeafCenterLess(_nodes, axis));
+
+	int child1 = BuildSubtree(leaves, start, mid);
+	int child2 = BuildSubtree(leaves, mid, end);
+
+	int parent = AllocateNode();
+	TreeNode& node = _nodes[parent];
+	node._child1 = child1;
+	node._child2 = child2;
+	node._fatBox = Combine(_nodes[child1]._fatBox, _nodes[child2]._fatBox);
+	node._height = 1 + std::max(_nodes[child1]._height, _nodes[child2]._height);
+	_nodes[child1]._parent = parent;
+	_nodes[child2]._parent = parent;
+	return parent;
+}
+
+int DynamicAABBTree::GetHeight()const
+{
+	if(_root == -1){return -1;}
+	return _nodes[_root]._height;
+}
+
+int DynamicAABBTree::AllocateNode()
+{
+	int nodeID;
+	if(_freeList == -1){
+		_nodes.push_back(TreeNode());
+		nodeID = _nodes.size()-1;
+	}else{
+		nodeID = _freeList;
+		_freeList = _nodes[nodeID]._parent;
+	}
+
+	TreeNode& node = _nodes[nodeID];
+	node._userData = NULL;
+	node._parent = -1;
+	node._child1 = -1;
+	node._child2 = -1;
+	node._height = 0;
+	return nodeID;
+}
+
+void DynamicAABBTree::FreeNode(int nodeID)
+{
+	_nodes[nodeID]._parent = _freeList;
+	_nodes[nodeID]._height = -1;
+	_nodes[nodeID]._userData = NULL;
+	_freeList = nodeID;
+}
+
+//
+//Insert a leaf, finding the cheapest sibling by surface area heuristic
+//
+void DynamicAABBTree::InsertLeaf(int leaf)
+{
+	if(_root == -1){
+		_root = leaf;
+		_nodes[_root]._parent = -1;
+		return;
+	}
+
+	osg::BoundingBox leafBox = _nodes[leaf]._fatBox;
+	int index = _root;
+	while(!_nodes[index].IsLeaf())
+	{
+		int child1 = _nodes[index]._child1;
+		int child2 = _nodes[index]._child2;
+
+		float area = SurfaceArea(_nodes[index]._fatBox);
+		float combinedArea = SurfaceArea(Combine(_nodes[index]._fatBox, leafBox));
+
+		//cost of creating a new parent for this node and the new leaf
+		float cost = 2.0f*combinedArea;
+		//minimum cost of pushing the leaf further down the tree
+		float inheritanceCost = 2.0f*(combinedArea-area);
+
+		float cost1 = SurfaceArea(Combine(leafBox, _nodes[child1]._fatBox)) + inheritanceCost;
+		if(!_nodes[child1].IsLeaf()){
+			cost1 -= SurfaceArea(_nodes[child1]._fatBox);
+		}
+		float cost2 = SurfaceArea(Combine(leafBox, _nodes[child2]._fatBox)) + inheritanceCost;
+		if(!_nodes[child2].IsLeaf()){
+			cost2 -= SurfaceArea(_nodes[child2]._fatBox);
+		}
+
+		if(cost < cost1 && cost < cost2){break;}
+		index = cost1 < cost2 ? child1 : child2;
+	}
+
+	int sibling = index;
+	int oldParent = _nodes[sibling]._parent;
+	int newParent = AllocateNode();
+	_nodes[newParent]._parent = oldParent;
+	_nodes[newParent]._fatBox = Combine(leafBox, _nodes[sibling]._fatBox);
+	_nodes[newParent]._height = _nodes[sibling]._height+1;
+	_nodes[newParent]._child1 = sibling;
+	_nodes[newParent]._child2 = leaf;
+	_nodes[sibling]._parent = newParent;
+	_nodes[leaf]._parent = newParent;
+
+	if(oldParent != -1){
+		if(_nodes[oldParent]._child1 == sibling){
+			_nodes[oldParent]._child1 = newParent;
+		}else{
+			_nodes[oldParent]._child2 = newParent;
+		}
+	}else{
+		_root = newParent;
+	}
+
+	//walk back up fixing heights and boxes
+	index = _nodes[leaf]._parent;
+	while(index != -1)
+	{
+		index = Balance(index);
+		int child1 = _nodes[index]._child1;
+		int child2 = _nodes[index]._child2;
+		_nodes[index]._height = 1 + std::max(_nodes[child1]._height, _nodes[child2]._height);
+		_nodes[index]._fatBox = Combine(_nodes[child1]._fatBox, _nodes[child2]._fatBox);
+		index = _nodes[index]._parent;
+	}
+}
+
+void DynamicAABBTree::RemoveLeaf(int leaf)
+{
+	if(leaf == _root){
+		_root = -1;
+		return;
+	}
+
+	int parent = _nodes[leaf]._parent;
+	int grandParent = _nodes[parent]._parent;
+	int sibling = _nodes[parent]._child1 == leaf ? _nodes[parent]._child2 : _nodes[parent]._child1;
+
+	if(grandParent != -1)
+	{
+		//replace the parent with the sibling
+		if(_nodes[grandParent]._child1 == parent){
+			_nodes[grandParent]._child1 = sibling;
+		}else{
+			_nodes[grandParent]._child2 = sibling;
+		}
+		_nodes[sibling]._parent = grandParent;
+		FreeNode(parent);
+
+		int index = grandParent;
+		while(index != -1)
+		{
+			index = Balance(index);
+			int child1 = _nodes[index]._child1;
+			int child2 = _nodes[index]._child2;
+			_nodes[index]._fatBox = Combine(_nodes[child1]._fatBox, _nodes[child2]._fatBox);
+			_nodes[index]._height = 1 + std::max(_nodes[child1]._height, _nodes[child2]._height);
+			index = _nodes[index]._parent;
+		}
+	}else{
+		_root = sibling;
+		_nodes[sibling]._parent = -1;
+		FreeNode(parent);
+	}
+	_nodes[leaf]._parent = -1;
+}
+
+//
+//Perform a left or right rotation if node A is imbalanced
+//
+int DynamicAABBTree::Balance(int iA)
+{
+	TreeNode& A = _nodes[iA];
+	if(A.IsLeaf() || A._height < 2){return iA;}
+
+	int iB = A._child1;
+	int iC = A._child2;
+	TreeNode& B = _nodes[iB];
+	TreeNode& C = _nodes[iC];
+
+	int balance = C._height - B._height;
+
+	//rotate C up
+	if(balance > 1)
+	{
+		int iF = C._child1;
+		int iG = C._child2;
+		TreeNode& F = _nodes[iF];
+		TreeNode& G = _nodes[iG];
+
+		C._child1 = iA;
+		C._parent = A._parent;
+		A._parent = iC;
+
+		if(C._parent != -1){
+			if(_nodes[C._parent]._child1 == iA){
+				_nodes[C._parent]._child1 = iC;
+			}else{
+				_nodes[C._parent]._child2 = iC;
+			}
+		}else{
+			_root = iC;
+		}
+
+		if(F._height > G._height){
+			C._child2 = iF;
+			A._child2 = iG;
+			G._parent = iA;
+			A._fatBox = Combine(B._fatBox, G._fatBox);
+			C._fatBox = Combine(A._fatBox, F._fatBox);
+			A._height = 1 + std::max(B._height, G._height);
+			C._height = 1 + std::max(A._height, F._height);
+		}else{
+			C._child2 = iG;
+			A._child2 = iF;
+			F._parent = iA;
+			A._fatBox = Combine(B._fatBox, F._fatBox);
+			C._fatBox = Combine(A._fatBox, G._fatBox);
+			A._height = 1 + std::max(B._height, F._height);
+			C._height = 1 + std::max(A._height, G._height);
+		}
+		return iC;
+	}
+
+	//rotate B up
+	if(balance < -1)
+	{
+		int iD = B._child1;
+		int iE = B._child2;
+		TreeNode& D = _nodes[iD];
+		TreeNode& E = _nodes[iE];
+
+		B._child1 = iA;
+		B._parent = A._parent;
+		A._parent = iB;
+
+		if(B._parent != -1){
+			if(_nodes[B._parent]._child1 == iA){
+				_nodes[B._parent]._child1 = iB;
+			}else{
+				_nodes[B._parent]._child2 = iB;
+			}
+		}else{
+			_root = iB;
+		}
+
+		if(D._height > E._height){
+			B._child2 = iD;
+			A._child1 = iE;
+			E._parent = iA;
+			A._fatBox = Combine(C._fatBox, E._fatBox);
+			B._fatBox = Combine(A._fatBox, D._fatBox);
+			A._height = 1 + std::max(C._height, E._height);
+			B._height = 1 + std::max(A._height, D._height);
+		}else{
+			B._child2 = iE;
+			A._child1 = iD;
+			D._parent = iA;
+			A._fatBox = Combine(C._fatBox, D._fatBox);
+			B._fatBox = Combine(A._fatBox, E._fatBox);
+			A._height = 1 + std::max(C._height, D._height);
+			B._height = 1 + std::max(A._height, E._height);
+		}
+		return iB;
+	}
+
+	return iA;
+}
+
+float DynamicAABBTree::SurfaceArea(const osg::BoundingBox& box)
+{
+	osg::Vec3 d = box._max - box._min;
+	return 2.0f*(d.x()*d.y() + d.y()*d.z() + d.z()*d.x());
+}
+
+osg::BoundingBox DynamicAABBTree::Combine(const osg::BoundingBox& a, const osg::BoundingBox& b)
+{
+	return osg::BoundingBox(std::min(a.xMin(), b.xMin()), std::min(a.yMin(), b.yMin()), std::min(a.zMin(), b.zMin()),
+							std::max(a.xMax(), b.xMax()), std::max(a.yMax(), b.yMax()), std::max(a.zMax(), b.zMax()));
+}
+
+bool DynamicAABBTree::Contains(const osg::BoundingBox& outer, const osg::BoundingBox& inner)
+{
+	return outer.xMin() <= inner.xMin() && outer.yMin() <= inner.yMin() && outer.zMin() <= inner.zMin() &&
+			inner.xMax() <= outer.xMax() && inner.yMax() <= outer.yMax() && inner.zMax() <= outer.zMax();
+}
@@ -0,0 +1,77 @@
+#include <hogboxStage/PhysicsComponent.h>
+#include <hogboxStage/PhysicsSystem.h>
+
+using namespace hogboxStage;
+
+//
+//Integrate this body on its own when it isn't part of a PhysicsSystem
+//
+bool PhysicsComponent::OnUpdate(ComponentEventPtr eventData)
+{
+	//the system steps all its bodies in one batch
+	if(p_physicsSystem){return true;}
+
+	//integrate physics
+	//linear, using the step passed by the scheduler if we have one
+	float timeStep = 0.033f;
+	ComponentUpdate* update = dynamic_cast<ComponentUpdate*>(eventData.get());
+	if(update && update->GetTimeStep() > 0.0){
+		timeStep = (float)update->GetTimeStep();
+	}
+	if(_mass > 0.0f){
+		osg::Vec3 acceleration = _forces / _mass;
+		_velocity += acceleration * timeStep;
+	}
+	_position += _velocity * timeStep;
+	_forces = osg::Vec3(0.0f,0.0f,0.0f); //clear forces
+
+	if(p_worldTrans.valid()){
+		p_worldTrans->SetPosition(_position);
+	}
+	return true;
+}
+
+osg::Vec3 PhysicsComponent::GetPosition()const
+{
+	if(p_physicsSystem){return p_physicsSystem->GetBodies().GetPosition(_bodyIndex);}
+	return _position;
+}
+
+void PhysicsComponent::SetPosition(const osg::Vec3& pos)
+{
+	_position = pos;
+	if(p_physicsSystem){p_physicsSystem->GetBodies().SetPosition(_bodyIndex, pos);}
+}
+
+float PhysicsComponent::GetMass()const
+{
+	if(p_physicsSystem){return p_physicsSystem->GetBodies().GetMass(_bodyIndex);}
+	return _mass;
+}
+
+void PhysicsComponent::SetMass(const float& mass)
+{
+	_mass = mass;
+	if(p_physicsSystem){p_physicsSystem->GetBodies().SetMass(_bodyIndex, mass);}
+}
+
+osg::Vec3 PhysicsComponent::GetVelocity()const
+{
+	if(p_physicsSystem){return p_physicsSystem->GetBodies().GetVelocity(_bodyIndex);}
+	return _velocity;
+}
+
+void PhysicsComponent::SetVelocity(const osg::Vec3& velocity)
+{
+	_velocity = velocity;
+	if(p_physicsSystem){p_physicsSystem->GetBodies().SetVelocity(_bodyIndex, velocity);}
+}
+
+void PhysicsComponent::AddForce(const osg::Vec3& force)
+{
+	if(p_physicsSystem){
+		p_physicsSystem->GetBodies().AddForce(_bodyIndex, force);
+	}else{
+		_forces += force;
+	}
+}
@@ -0,0 +1,377 @@
+#include <hogboxStage/PhysicsIntegrator.h>
+
+#include <algorithm>
+
+//pick up whichever vector extensions the compiler can target. SSE is used when
+//the build targets it, AVX functions are compiled for that target individually
+//and only called when cpuid reports it
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#define HOGBOX_PHYSICS_SSE
+	#include <xmmintrin.h>
+#endif
+#if defined(HOGBOX_PHYSICS_SSE) && ((defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))) || defined(__clang__) || (defined(_MSC_VER) && _MSC_VER >= 1600))
+	#define HOGBOX_PHYSICS_AVX
+	#include <immintrin.h>
+	#if defined(__GNUC__) || defined(__clang__)
+		#define HOGBOX_TARGET_AVX __attribute__((target("avx")))
+	#else
+		#include <intrin.h>
+		#define HOGBOX_TARGET_AVX
+	#endif
+#endif
+
+using namespace hogboxStage;
+
+#ifdef HOGBOX_PHYSICS_AVX
+//
+//Does the cpu (and os) support AVX
+//
+static bool CpuHasAVX()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	int info[4];
+	__cpuid(info, 1);
+	//osxsave and avx, then the os must save the ymm registers
+	if((info[2] & (1<<27)) == 0 || (info[2] & (1<<28)) == 0){return false;}
+	return (_xgetbv(0) & 6) == 6;
+#else
+	//also checks the os saves the ymm registers
+	return __builtin_cpu_supports("avx") != 0;
+#endif
+}
+#endif
+
+//
+//PhysicsBodyArrays
+//
+
+PhysicsBodyArrays::PhysicsBodyArrays()
+	: _lastTimeStep(1.0f/60.0f)
+{
+}
+
+unsigned int PhysicsBodyArrays::AddBody(const osg::Vec3& position, const osg::Vec3& velocity, const float& mass)
+{
+	_posX.push_back(position.x()); _posY.push_back(position.y()); _posZ.push_back(position.z());
+	//previous position implied by the velocity, so Verlet starts moving at the right speed
+	osg::Vec3 prev = position - velocity*_lastTimeStep;
+	_prevX.push_back(prev.x()); _prevY.push_back(prev.y()); _prevZ.push_back(prev.z());
+	_velX.push_back(velocity.x()); _velY.push_back(velocity.y()); _velZ.push_back(velocity.z());
+	_forceX.push_back(0.0f); _forceY.push_back(0.0f); _forceZ.push_back(0.0f);
+	_invMass.push_back(mass > 0.0f ? 1.0f/mass : 0.0f);
+	return _invMass.size()-1;
+}
+
+static void SwapRemove(std::vector<float>& values, unsigned int index)
+{
+	values[index] = values.back();
+	values.pop_back();
+}
+
+int PhysicsBodyArrays::RemoveBody(unsigned int index)
+{
+	if(index >= GetNumBodies()){return -1;}
+	int moved = GetNumBodies()-1;
+
+	SwapRemove(_posX, index); SwapRemove(_posY, index); SwapRemove(_posZ, index);
+	SwapRemove(_prevX, index); SwapRemove(_prevY, index); SwapRemove(_prevZ, index);
+	SwapRemove(_velX, index); SwapRemove(_velY, index); SwapRemove(_velZ, index);
+	SwapRemove(_forceX, index); SwapRemove(_forceY, index); SwapRemove(_forceZ, index);
+	SwapRemove(_invMass, index);
+
+	return moved == (int)index ? -1 : moved;
+}
+
+void PhysicsBodyArrays::Clear()
+{
+	_posX.clear(); _posY.clear(); _posZ.clear();
+	_prevX.clear(); _prevY.clear(); _prevZ.clear();
+	_velX.clear(); _velY.clear(); _velZ.clear();
+	_forceX.clear(); _forceY.clear(); _forceZ.clear();
+	_invMass.clear();
+}
+
+void PhysicsBodyArrays::Reserve(unsigned int numBodies)
+{
+	_posX.reserve(numBodies); _posY.reserve(numBodies); _posZ.reserve(numBodies);
+	_prevX.reserve(numBodies); _prevY.reserve(numBodies); _prevZ.reserve(numBodies);
+	_velX.reserve(numBodies); _velY.reserve(numBodies); _velZ.reserve(numBodies);
+	_forceX.reserve(numBodies); _forceY.reserve(numBodies); _forceZ.reserve(numBodies);
+	_invMass.reserve(numBodies);
+}
+
+void PhysicsBodyArrays::SetPosition(unsigned int index, const osg::Vec3& position)
+{
+	//move the previous position by the same amount so Verlet keeps the velocity
+	_prevX[index] += position.x()-_posX[index];
+	_prevY[index] += position.y()-_posY[index];
+	_prevZ[index] += position.z()-_posZ[index];
+	_posX[index] = position.x();
+	_posY[index] = position.y();
+	_posZ[index] = position.z();
+}
+
+void PhysicsBodyArrays::SetVelocity(unsigned int index, const osg::Vec3& velocity)
+{
+	_velX[index] = velocity.x();
+	_velY[index] = velocity.y();
+	_velZ[index] = velocity.z();
+	_prevX[index] = _posX[index]-velocity.x()*_lastTimeStep;
+	_prevY[index] = _posY[index]-velocity.y()*_lastTimeStep;
+	_prevZ[index] = _posZ[index]-velocity.z()*_lastTimeStep;
+}
+
+void PhysicsBodyArrays::ClearForces()
+{
+	std::fill(_forceX.begin(), _forceX.end(), 0.0f);
+	std::fill(_forceY.begin(), _forceY.end(), 0.0f);
+	std::fill(_forceZ.begin(), _forceZ.end(), 0.0f);
+}
+
+void PhysicsBodyArrays::CopyPositions(osg::Vec3* dest)const
+{
+	unsigned int count = GetNumBodies();
+	for(unsigned int i=0; i<count; i++){
+		dest[i].set(_posX[i], _posY[i], _posZ[i]);
+	}
+}
+
+//
+//Integration kernels, the axes are independent so each kernel steps one axis
+//of every body. Each returns the number of bodies it handled, the scalar loop
+//finishes whatever is left
+//
+
+struct AxisArrays
+{
+	float* _pos;
+	float* _prev;
+	float* _vel;
+	float* _force;
+	const float* _invMass;
+	float _gravity;
+};
+
+static void EulerScalar(AxisArrays& axis, unsigned int start, unsigned int count, const float& dt)
+{
+	for(unsigned int i=start; i<count; i++)
+	{
+		float gravity = axis._invMass[i] > 0.0f ? axis._gravity : 0.0f;
+		float acceleration = axis._force[i]*axis._invMass[i] + gravity;
+		axis._prev[i] = axis._pos[i];
+		axis._vel[i] += acceleration*dt;
+		axis._pos[i] += axis._vel[i]*dt;
+		axis._force[i] = 0.0f;
+	}
+}
+
+static void VerletScalar(AxisArrays& axis, unsigned int start, unsigned int count,
+						const float& dt, const float& ratio)
+{
+	float dt2 = dt*dt;
+	float invDt = 1.0f/dt;
+	for(unsigned int i=start; i<count; i++)
+	{
+		float gravity = axis._invMass[i] > 0.0f ? axis._gravity : 0.0f;
+		float acceleration = axis._force[i]*axis._invMass[i] + gravity;
+		float pos = axis._pos[i];
+		float next = pos + (pos-axis._prev[i])*ratio + acceleration*dt2;
+		axis._vel[i] = (next-pos)*invDt;
+		axis._prev[i] = pos;
+		axis._pos[i] = next;
+		axis._force[i] = 0.0f;
+	}
+}
+
+#ifdef HOGBOX_PHYSICS_SSE
+
+static unsigned int EulerSSE(AxisArrays& axis, unsigned int count, const float& dt)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 vdt = _mm_set1_ps(dt);
+	const __m128 gravity = _mm_set1_ps(axis._gravity);
+	unsigned int i = 0;
+	for( ; i+4<=count; i+=4)
+	{
+		__m128 invMass = _mm_loadu_ps(axis._invMass+i);
+		__m128 g = _mm_and_ps(gravity, _mm_cmpgt_ps(invMass, zero));
+		__m128 acceleration = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(axis._force+i), invMass), g);
+		__m128 pos = _mm_loadu_ps(axis._pos+i);
+		__m128 vel = _mm_add_ps(_mm_loadu_ps(axis._vel+i), _mm_mul_ps(acceleration, vdt));
+		_mm_storeu_ps(axis._prev+i, pos);
+		_mm_storeu_ps(axis._vel+i, vel);
+		_mm_storeu_ps(axis._pos+i, _mm_add_ps(pos, _mm_mul_ps(vel, vdt)));
+		_mm_storeu_ps(axis._force+i, zero);
+	}
+	return i;
+}
+
+static unsigned int VerletSSE(AxisArrays& axis, unsigned int count, const float& dt, const float& ratio)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 vdt2 = _mm_set1_ps(dt*dt);
+	const __m128 vinvDt = _mm_set1_ps(1.0f/dt);
+	const __m128 vratio = _mm_set1_ps(ratio);
+	const __m128 gravity = _mm_set1_ps(axis._gravity);
+	unsigned int i = 0;
+	for( ; i+4<=count; i+=4)
+	{
+		__m128 invMass = _mm_loadu_ps(axis._invMass+i);
+		__m128 g = _mm_and_ps(gravity, _mm_cmpgt_ps(invMass, zero));
+		__m128 acceleration = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(axis._force+i), invMass), g);
+		__m128 pos = _mm_loadu_ps(axis._pos+i);
+		__m128 displacement = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(pos, _mm_loadu_ps(axis._prev+i)), vratio),
+										_mm_mul_ps(acceleration, vdt2));
+		_mm_storeu_ps(axis._vel+i, _mm_mul_ps(displacement, vinvDt));
+		_mm_storeu_ps(axis._prev+i, pos);
+		_mm_storeu_ps(axis._pos+i, _mm_add_ps(pos, displacement));
+		_mm_storeu_ps(axis._force+i, zero);
+	}
+	return i;
+}
+
+#endif //HOGBOX_PHYSICS_SSE
+
+#ifdef HOGBOX_PHYSICS_AVX
+
+HOGBOX_TARGET_AVX static unsigned int EulerAVX(AxisArrays& axis, unsigned int count, const float& dt)
+{
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 vdt = _mm256_set1_ps(dt);
+	const __m256 gravity = _mm256_set1_ps(axis._gravity);
+	unsigned int i = 0;
+	for( ; i+8<=count; i+=8)
+	{
+		__m256 invMass = _mm256_loadu_ps(axis._invMass+i);
+		__m256 g = _mm256_and_ps(gravity, _mm256_cmp_ps(invMass, zero, _CMP_GT_OQ));
+		__m256 acceleration = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(axis._force+i), invMass), g);
+		__m256 pos = _mm256_loadu_ps(axis._pos+i);
+		__m256 vel = _mm256_add_ps(_mm256_loadu_ps(axis._vel+i), _mm256_mul_ps(acceleration, vdt));
+		_mm256_storeu_ps(axis._prev+i, pos);
+		_mm256_storeu_ps(axis._vel+i, vel);
+		_mm256_storeu_ps(axis._pos+i, _mm256_add_ps(pos, _mm256_mul_ps(vel, vdt)));
+		_mm256_storeu_ps(axis._force+i, zero);
+	}
+	return i;
+}
+
+HOGBOX_TARGET_AVX static unsigned int VerletAVX(AxisArrays& axis, unsigned int count, const float& dt, const float& ratio)
+{
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 vdt2 = _mm256_set1_ps(dt*dt);
+	const __m256 vinvDt = _mm256_set1_ps(1.0f/dt);
+	const __m256 vratio = _mm256_set1_ps(ratio);
+	const __m256 gravity = _mm256_set1_ps(axis._gravity);
+	unsigned int i = 0;
+	for( ; i+8<=count; i+=8)
+	{
+		__m256 invMass = _mm256_loadu_ps(axis._invMass+i);
+		__m256 g = _mm256_and_ps(gravity, _mm256_cmp_ps(invMass, zero, _CMP_GT_OQ));
+		__m256 acceleration = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(axis._force+i), invMass), g);
+		__m256 pos = _mm256_loadu_ps(axis._pos+i);
+		__m256 displacement = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(pos, _mm256_loadu_ps(axis._prev+i)), vratio),
+											_mm256_mul_ps(acceleration, vdt2));
+		_mm256_storeu_ps(axis._vel+i, _mm256_mul_ps(displacement, vinvDt));
+		_mm256_storeu_ps(axis._prev+i, pos);
+		_mm256_storeu_ps(axis._pos+i, _mm256_add_ps(pos, displacement));
+		_mm256_storeu_ps(axis._force+i, zero);
+	}
+	return i;
+}
+
+#endif //HOGBOX_PHYSICS_AVX
+
+//
+//PhysicsIntegrator
+//
+
+PhysicsIntegrator::PhysicsIntegrator(Method method)
+	: osg::Referenced(),
+	_method(method),
+	_gravity(0.0f, 0.0f, 0.0f),
+	_instructionSet(GetBestInstructionSet())
+{
+}
+
+PhysicsIntegrator::~PhysicsIntegrator(void)
+{
+}
+
+//
+//Step all bodies by timeStep seconds and clear their forces
+//
+void PhysicsIntegrator::Integrate(PhysicsBodyArrays& bodies, const float& timeStep)
+{
+	unsigned int count = bodies.GetNumBodies();
+	if(count == 0 || timeStep <= 0.0f){return;}
+
+	//scale the previous displacement when the step changes (time corrected verlet)
+	float ratio = bodies.GetLastTimeStep() > 0.0f ? timeStep/bodies.GetLastTimeStep() : 1.0f;
+
+	AxisArrays axes[3];
+	float* pos[3] = {&bodies._posX[0], &bodies._posY[0], &bodies._posZ[0]};
+	float* prev[3] = {&bodies._prevX[0], &bodies._prevY[0], &bodies._prevZ[0]};
+	float* vel[3] = {&bodies._velX[0], &bodies._velY[0], &bodies._velZ[0]};
+	float* force[3] = {&bodies._forceX[0], &bodies._forceY[0], &bodies._forceZ[0]};
+	for(unsigned int a=0; a<3; a++){
+		axes[a]._pos = pos[a];
+		axes[a]._prev = prev[a];
+		axes[a]._vel = vel[a];
+		axes[a]._force = force[a];
+		axes[a]._invMass = &bodies._invMass[0];
+		axes[a]._gravity = _gravity[a];
+	}
+
+	for(unsigned int a=0; a<3; a++)
+	{
+		unsigned int done = 0;
+		if(_method == VERLET)
+		{
+#ifdef HOGBOX_PHYSICS_AVX
+			if(_instructionSet == AVX){done = VerletAVX(axes[a], count, timeStep, ratio);}
+#endif
+#ifdef HOGBOX_PHYSICS_SSE
+			if(_instructionSet == SSE){done = VerletSSE(axes[a], count, timeStep, ratio);}
+#endif
+			VerletScalar(axes[a], done, count, timeStep, ratio);
+		}else{
+#ifdef HOGBOX_PHYSICS_AVX
+			if(_instructionSet == AVX){done = EulerAVX(axes[a], count, timeStep);}
+#endif
+#ifdef HOGBOX_PHYSICS_SSE
+			if(_instructionSet == SSE){done = EulerSSE(axes[a], count, timeStep);}
+#endif
+			EulerScalar(axes[a], done, count, timeStep);
+		}
+	}
+
+	bodies.SetLastTimeStep(timeStep);
+}
+
+void PhysicsIntegrator::SetInstructionSet(const InstructionSet& set)
+{
+	_instructionSet = set > GetBestInstructionSet() ? GetBestInstructionSet() : set;
+}
+
+PhysicsIntegrator::InstructionSet PhysicsIntegrator::GetBestInstructionSet()
+{
+#if defined(HOGBOX_PHYSICS_AVX)
+	static const bool hasAVX = CpuHasAVX();
+	if(hasAVX){return AVX;}
+#endif
+#if defined(HOGBOX_PHYSICS_SSE)
+	return SSE;
+#else
+	return SCALAR;
+#endif
+}
+
+const char* PhysicsIntegrator::GetInstructionSetName(const InstructionSet& set)
+{
+	switch(set){
+		case AVX: return "avx";
+		case SSE: return "sse";
+		default: break;
+	}
+	return "scalar";
+}
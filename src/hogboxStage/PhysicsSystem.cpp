@@ -0,0 +1,115 @@
+#include <hogboxStage/PhysicsSystem.h>
+
+using namespace hogboxStage;
+
+PhysicsSystem::PhysicsSystem(PhysicsIntegrator* integrator)
+	: ComponentSystem("PhysicsSystem", "PhysicsComponent"),
+	_integrator(integrator),
+	_lastReferenceTime(-1.0)
+{
+	if(!_integrator.valid()){
+		_integrator = new PhysicsIntegrator();
+	}
+	//we set the positions of the transforms
+	AddWriteType("WorldTransformComponent");
+}
+
+PhysicsSystem::~PhysicsSystem(void)
+{
+	//hand the bodies back to the components
+	for(unsigned int i=0; i<_bodyComponents.size(); i++){
+		PhysicsComponent* physics = _bodyComponents[i];
+		physics->_position = _bodies.GetPosition(i);
+		physics->_velocity = _bodies.GetVelocity(i);
+		physics->_mass = _bodies.GetMass(i);
+		physics->p_physicsSystem = NULL;
+		physics->_bodyIndex = -1;
+	}
+}
+
+//
+//Move the components body into our arrays
+//
+bool PhysicsSystem::AddComponent(Component* component)
+{
+	PhysicsComponent* physics = dynamic_cast<PhysicsComponent*>(component);
+	if(!physics || physics->p_physicsSystem){return false;}
+	if(!ComponentSystem::AddComponent(component)){return false;}
+
+	physics->_bodyIndex = _bodies.AddBody(physics->_position, physics->_velocity, physics->_mass);
+	_bodies.AddForce(physics->_bodyIndex, physics->_forces);
+	physics->_forces = osg::Vec3(0.0f,0.0f,0.0f);
+	physics->p_physicsSystem = this;
+	_bodyComponents.push_back(physics);
+	return true;
+}
+
+//
+//Copy the body back to the component and remove it from the arrays
+//
+bool PhysicsSystem::RemoveComponent(Component* component)
+{
+	PhysicsComponent* physics = dynamic_cast<PhysicsComponent*>(component);
+	if(!physics || physics->p_physicsSystem != this){return false;}
+
+	//keep it alive until we're done with it
+	PhysicsComponentPtr keep = physics;
+	if(!ComponentSystem::RemoveComponent(component)){return false;}
+
+	unsigned int index = physics->_bodyIndex;
+	physics->_position = _bodies.GetPosition(index);
+	physics->_velocity = _bodies.GetVelocity(index);
+	physics->_mass = _bodies.GetMass(index);
+	physics->p_physicsSystem = NULL;
+	physics->_bodyIndex = -1;
+
+	//the last body is moved into the freed slot
+	int moved = _bodies.RemoveBody(index);
+	if(moved != -1){
+		_bodyComponents[index] = _bodyComponents[moved];
+		_bodyComponents[index]->_bodyIndex = index;
+	}
+	_bodyComponents.pop_back();
+	return true;
+}
+
+//
+//Step by the fixed step, or the time since the last frame
+//
+void PhysicsSystem::Update(ComponentUpdate* update)
+{
+	if(!update){return;}
+
+	double timeStep = update->GetTimeStep();
+	if(timeStep <= 0.0)
+	{
+		double referenceTime = update->GetFrameStamp().getReferenceTime();
+		if(_lastReferenceTime >= 0.0){
+			timeStep = referenceTime-_lastReferenceTime;
+		}
+		_lastReferenceTime = referenceTime;
+	}
+
+	Step((float)timeStep);
+}
+
+//
+//Step every body and write back the transforms
+//
+void PhysicsSystem::Step(const float& timeStep)
+{
+	if(timeStep <= 0.0f){return;}
+	_integrator->Integrate(_bodies, timeStep);
+	WriteTransforms();
+}
+
+void PhysicsSystem::WriteTransforms()
+{
+	for(unsigned int i=0; i<_bodyComponents.size(); i++)
+	{
+		WorldTransformComponent* transform = _bodyComponents[i]->p_worldTrans.get();
+		if(transform){
+			transform->SetPosition(_bodies.GetPosition(i));
+		}
+	}
+}
@@ -42,7 +42,7 @@ bool RenderableComponent::HandleComponentDependency(Component* component)
 	if(transComp){
 		transComp->RegisterCallbackForEvent(new ComponentEventObjectCallback<RenderableComponent>(this,this,
 																&RenderableComponent::OnEntityMovedCallback),
-																"OnMoved");
+																WorldTransformComponent::OnMovedEventID());
 		return true;
 	}
 	
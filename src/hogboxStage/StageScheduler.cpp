@@ -0,0 +1,333 @@
+#include <hogboxStage/StageScheduler.h>
+
+#include <osg/Timer>
+#include <math.h>
+
+using namespace hogboxStage;
+
+//
+//Runs one system of an execution stage on the pool
+//
+class StageScheduler::SystemTask : public hogbox::PoolTask
+{
+public:
+	SystemTask(ComponentSystem* system, ComponentUpdate* update)
+		: hogbox::PoolTask(),
+		p_system(system),
+		p_update(update)
+	{
+	}
+	virtual void Run(){
+		StageScheduler::RunSystem(p_system, p_update);
+	}
+protected:
+	virtual ~SystemTask(void){}
+protected:
+	ComponentSystem* p_system;
+	ComponentUpdate* p_update;
+};
+
+StageScheduler::StageScheduler(double fixedTimeStep, hogbox::WorkStealingPool* pool)
+	: osg::Referenced(),
+	_stagesModifiedCount(-1),
+	_pool(pool),
+	_useParallel(true),
+	_eventQueueWasDeferred(false),
+	_fixedTimeStep(fixedTimeStep > 0.0 ? fixedTimeStep : 1.0/60.0),
+	_maxStepsPerFrame(5),
+	_accumulator(0.0),
+	_simulationTime(0.0),
+	_lastReferenceTime(-1.0),
+	_lastStepMs(0.0),
+	_lastDispatchMs(0.0)
+{
+	if(!_pool.get()){
+		_pool = hogbox::WorkStealingPool::Inst();
+	}
+	SetEventQueue(ComponentEventQueue::Inst());
+}
+
+StageScheduler::~StageScheduler(void)
+{
+	//hand the queue back as we found it, and the components back to the shared queue
+	SetEventQueue(NULL);
+}
+
+//
+//Add a system, returns false if one of the same name exists
+//
+bool StageScheduler::AddSystem(ComponentSystem* system)
+{
+	if(!system){return false;}
+	if(GetSystem(system->GetName())){return false;}
+	_systems.push_back(system);
+	_stagesModifiedCount = -1;
+
+	//pick up the components of entities added before the system
+	EntityComponentMap::iterator itr = _entityComponents.begin();
+	for( ; itr!=_entityComponents.end(); itr++){
+		const ComponentPtrVector& components = (*itr).second;
+		for(unsigned int c=0; c<components.size(); c++){
+			system->AddComponent(components[c].get());
+		}
+	}
+	return true;
+}
+
+bool StageScheduler::RemoveSystem(ComponentSystem* system)
+{
+	ComponentSystemPtrVector::iterator itr = _systems.begin();
+	for( ; itr!=_systems.end(); itr++){
+		if((*itr).get() == system){
+			_systems.erase(itr);
+			_stagesModifiedCount = -1;
+			return true;
+		}
+	}
+	return false;
+}
+
+ComponentSystem* StageScheduler::GetSystem(const std::string& name)
+{
+	for(unsigned int i=0; i<_systems.size(); i++){
+		if(_systems[i]->GetName() == name){return _systems[i].get();}
+	}
+	return NULL;
+}
+
+//
+//Register every component of the entity with the systems that update its type
+//
+void StageScheduler::AddEntity(Entity* entity)
+{
+	if(!entity){return;}
+	if(_entityComponents.find(entity) != _entityComponents.end()){return;}
+	ComponentPtrVector components = entity->GetComponentsList();
+	_entityComponents[entity] = components;
+	for(unsigned int c=0; c<components.size(); c++){
+		components[c]->SetEventQueue(_eventQueue.get());
+		for(unsigned int s=0; s<_systems.size(); s++){
+			_systems[s]->AddComponent(components[c].get());
+		}
+	}
+}
+
+void StageScheduler::RemoveEntity(Entity* entity)
+{
+	if(!entity){return;}
+	EntityComponentMap::iterator itr = _entityComponents.find(entity);
+	if(itr == _entityComponents.end()){return;}
+	ComponentPtrVector components = (*itr).second;
+	_entityComponents.erase(itr);
+	for(unsigned int c=0; c<components.size(); c++){
+		components[c]->SetEventQueue(NULL);
+		for(unsigned int s=0; s<_systems.size(); s++){
+			_systems[s]->RemoveComponent(components[c].get());
+		}
+	}
+}
+
+//
+//Advance using the viewers frame stamp
+//
+unsigned int StageScheduler::Frame(const osg::FrameStamp* frameStamp)
+{
+	if(!frameStamp){return 0;}
+	double referenceTime = frameStamp->getReferenceTime();
+	double elapsed = _lastReferenceTime < 0.0 ? 0.0 : referenceTime - _lastReferenceTime;
+	_lastReferenceTime = referenceTime;
+	return Advance(elapsed, frameStamp);
+}
+
+//
+//Advance by elapsed seconds, running as many fixed steps as have accumulated
+//
+unsigned int StageScheduler::Advance(const double& elapsed, const osg::FrameStamp* frameStamp)
+{
+	if(elapsed > 0.0){
+		_accumulator += elapsed;
+	}
+
+	unsigned int steps = 0;
+	while(_accumulator >= _fixedTimeStep && steps < _maxStepsPerFrame)
+	{
+		Step(frameStamp);
+		_accumulator -= _fixedTimeStep;
+		steps++;
+	}
+
+	//hit the cap, drop the backlog rather than trying to catch up next frame
+	if(_accumulator >= _fixedTimeStep){
+		_accumulator = fmod(_accumulator, _fixedTimeStep);
+	}
+	return steps;
+}
+
+//
+//Run a single fixed step of all systems
+//
+void StageScheduler::Step(const osg::FrameStamp* frameStamp)
+{
+	osg::Timer_t startTick = osg::Timer::instance()->tick();
+
+	ComponentUpdatePtr update = new ComponentUpdate(frameStamp ? *frameStamp : osg::FrameStamp(),
+													_fixedTimeStep, _simulationTime);
+
+	const ExecutionStageList& stages = GetExecutionStages();
+	for(unsigned int i=0; i<stages.size(); i++)
+	{
+		const ExecutionStage& stage = stages[i];
+		if(!_useParallel || stage.size() == 1){
+			for(unsigned int s=0; s<stage.size(); s++){
+				RunSystem(stage[s], update.get());
+			}
+			continue;
+		}
+
+		//systems in a stage don't conflict so can all run at once,
+		//stages themselves are a barrier
+		osg::ref_ptr<hogbox::TaskGroup> group = new hogbox::TaskGroup();
+		for(unsigned int s=0; s<stage.size(); s++){
+			_pool->Submit(new SystemTask(stage[s], update.get()), group.get());
+		}
+		_pool->Wait(group.get());
+	}
+
+	//deliver everything posted during the step in one batch
+	if(_eventQueue.get()){
+		osg::Timer_t dispatchTick = osg::Timer::instance()->tick();
+		_eventQueue->Dispatch(_useParallel ? _pool.get() : NULL);
+		_lastDispatchMs = osg::Timer::instance()->delta_m(dispatchTick, osg::Timer::instance()->tick());
+	}
+
+	_simulationTime += _fixedTimeStep;
+	_lastStepMs = osg::Timer::instance()->delta_m(startTick, osg::Timer::instance()->tick());
+}
+
+//
+//Fraction (0-1) of a step left in the accumulator
+//
+double StageScheduler::GetInterpolationAlpha()const
+{
+	double alpha = _accumulator/_fixedTimeStep;
+	return alpha > 1.0 ? 1.0 : alpha;
+}
+
+void StageScheduler::SetFixedTimeStep(const double& timeStep)
+{
+	if(timeStep <= 0.0){return;}
+	_fixedTimeStep = timeStep;
+}
+
+//
+//The queue events are deferred to during a step
+//
+void StageScheduler::SetEventQueue(ComponentEventQueue* queue)
+{
+	if(queue == _eventQueue.get()){return;}
+
+	//deliver what's waiting then put the old queue back as it was
+	if(_eventQueue.get()){
+		_eventQueue->Dispatch();
+		_eventQueue->SetDeferred(_eventQueueWasDeferred);
+	}
+
+	_eventQueue = queue;
+	if(_eventQueue.get()){
+		_eventQueueWasDeferred = _eventQueue->IsDeferred();
+		_eventQueue->SetDeferred(true);
+	}
+
+	//every component of our entities posts to the new queue, including those
+	//no system took
+	EntityComponentMap::iterator itr = _entityComponents.begin();
+	for( ; itr!=_entityComponents.end(); itr++){
+		const ComponentPtrVector& components = (*itr).second;
+		for(unsigned int c=0; c<components.size(); c++){
+			components[c]->SetEventQueue(_eventQueue.get());
+		}
+	}
+}
+
+//
+//The current system grouping, rebuilt lazily when systems change
+//
+const StageScheduler::ExecutionStageList& StageScheduler::GetExecutionStages()
+{
+	if(ExecutionStagesDirty()){
+		BuildExecutionStages();
+	}
+	return _stages;
+}
+
+bool StageScheduler::ExecutionStagesDirty()
+{
+	if(_stagesModifiedCount < 0){return true;}
+	int modified = 0;
+	for(unsigned int i=0; i<_systems.size(); i++){
+		modified += (int)_systems[i]->GetModifiedCount();
+	}
+	return modified != _stagesModifiedCount;
+}
+
+//
+//Group systems into stages of non conflicting systems. Each system goes in the
+//stage after the last one holding an earlier system it conflicts with, so
+//registration order is kept between conflicting systems
+//
+void StageScheduler::BuildExecutionStages()
+{
+	_stages.clear();
+	int modified = 0;
+
+	for(unsigned int i=0; i<_systems.size(); i++)
+	{
+		ComponentSystem* system = _systems[i].get();
+		modified += (int)system->GetModifiedCount();
+
+		unsigned int stageIndex = 0;
+		for(unsigned int s=0; s<_stages.size(); s++){
+			for(unsigned int j=0; j<_stages[s].size(); j++){
+				if(system->ConflictsWith(_stages[s][j])){
+					stageIndex = s+1;
+					break;
+				}
+			}
+		}
+		if(stageIndex == _stages.size()){
+			_stages.push_back(ExecutionStage());
+		}
+		_stages[stageIndex].push_back(system);
+	}
+	_stagesModifiedCount = modified;
+}
+
+//
+//Run a system and record its timing
+//
+void StageScheduler::RunSystem(ComponentSystem* system, ComponentUpdate* update)
+{
+	osg::Timer_t startTick = osg::Timer::instance()->tick();
+	system->Update(update);
+	system->RecordTiming(osg::Timer::instance()->delta_m(startTick, osg::Timer::instance()->tick()));
+}
+
+//
+//Print per system timings
+//
+void StageScheduler::ReportTimings(std::ostream& out)
+{
+	const ExecutionStageList& stages = GetExecutionStages();
+	out << "StageScheduler: step " << _lastStepMs << "ms, event dispatch " << _lastDispatchMs << "ms, "
+		<< stages.size() << " stages" << std::endl;
+	for(unsigned int i=0; i<stages.size(); i++){
+		for(unsigned int s=0; s<stages[i].size(); s++){
+			const SystemTiming& timing = stages[i][s]->GetTiming();
+			out << "    [" << i << "] " << stages[i][s]->GetName()
+				<< " components: " << stages[i][s]->GetNumComponents()
+				<< " last: " << timing._lastMs << "ms"
+				<< " avg: " << timing._averageMs << "ms"
+				<< " max: " << timing._maxMs << "ms" << std::endl;
+		}
+	}
+}
@@ -0,0 +1,302 @@
+#include <hogboxStage/UniformGridBroadPhase.h>
+
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+
+using namespace hogboxStage;
+
+UniformGridBroadPhase::UniformGridBroadPhase(const float& cellSize, unsigned int numBuckets)
+	: BroadPhase(),
+	_cellSize(cellSize > 0.0f ? cellSize : 1.0f),
+	_numProxies(0),
+	_stamp(0)
+{
+	_invCellSize = 1.0f/_cellSize;
+
+	//round up to a power of two so the hash can mask
+	unsigned int size = 1;
+	while(size < numBuckets){size <<= 1;}
+	_buckets.resize(size);
+}
+
+UniformGridBroadPhase::~UniformGridBroadPhase(void)
+{
+}
+
+//
+//Create a proxy, returns its id
+//
+int UniformGridBroadPhase::CreateProxy(const osg::BoundingBox& box, void* userData)
+{
+	int proxyID;
+	if(_freeProxies.empty()){
+		_proxies.push_back(GridProxy());
+		proxyID = _proxies.size()-1;
+	}else{
+		proxyID = _freeProxies.back();
+		_freeProxies.pop_back();
+	}
+
+	GridProxy& proxy = _proxies[proxyID];
+	proxy._box = box;
+	proxy._userData = userData;
+	proxy._cells = ComputeCellRange(box);
+	proxy._stamp = 0;
+	proxy._alive = true;
+
+	InsertIntoCells(proxyID);
+	_bounds.expandBy(box);
+	_numProxies++;
+
+	BufferMove(proxyID);
+	return proxyID;
+}
+
+//
+//Destroy a proxy
+//
+void UniformGridBroadPhase::DestroyProxy(int proxyID)
+{
+	if(!IsValidProxy(proxyID)){return;}
+	RemoveFromCells(proxyID);
+	_proxies[proxyID]._alive = false;
+	_proxies[proxyID]._userData = NULL;
+	_freeProxies.push_back(proxyID);
+	_numProxies--;
+
+	//so any pairs it was part of are dropped
+	BufferMove(proxyID);
+}
+
+//
+//Set a proxies box, the buckets are only touched if its cell range changes
+//
+void UniformGridBroadPhase::MoveProxy(int proxyID, const osg::BoundingBox& box)
+{
+	if(!IsValidProxy(proxyID)){return;}
+
+	GridProxy& proxy = _proxies[proxyID];
+	proxy._box = box;
+	_bounds.expandBy(box);
+
+	CellRange cells = ComputeCellRange(box);
+	if(!(cells == proxy._cells))
+	{
+		RemoveFromCells(proxyID);
+		_proxies[proxyID]._cells = cells;
+		InsertIntoCells(proxyID);
+	}
+
+	BufferMove(proxyID);
+}
+
+bool UniformGridBroadPhase::IsValidProxy(int proxyID)const
+{
+	if(proxyID < 0 || proxyID >= (int)_proxies.size()){return false;}
+	return _proxies[proxyID]._alive;
+}
+
+//
+//Append the ids of all proxies whose box overlaps box
+//
+void UniformGridBroadPhase::QueryBox(const osg::BoundingBox& box, std::vector<int>& results)
+{
+	if(_numProxies == 0){return;}
+
+	CellRange cells = ComputeCellRange(box);
+	double numCells = (double)(cells._max[0]-cells._min[0]+1) *
+					(double)(cells._max[1]-cells._min[1]+1) *
+					(double)(cells._max[2]-cells._min[2]+1);
+
+	//covers more cells than there are proxies, cheaper to just test them all
+	if(numCells > (double)_numProxies)
+	{
+		for(unsigned int i=0; i<_proxies.size(); i++){
+			if(_proxies[i]._alive && BoxesOverlap(_proxies[i]._box, box)){
+				results.push_back(i);
+			}
+		}
+		return;
+	}
+
+	NextStamp();
+	for(int z=cells._min[2]; z<=cells._max[2]; z++){
+		for(int y=cells._min[1]; y<=cells._max[1]; y++){
+			for(int x=cells._min[0]; x<=cells._max[0]; x++){
+				QueryCell(x, y, z, box, results);
+			}
+		}
+	}
+}
+
+//
+//Clip a ray to a box, returning the entry and exit distances
+//
+static bool ClipRayToBox(const osg::Vec3& origin, const osg::Vec3& invDirection, const osg::BoundingBox& box,
+						const float& maxDistance, float& tEnter, float& tExit)
+{
+	tEnter = 0.0f;
+	tExit = maxDistance;
+	for(unsigned int axis=0; axis<3; axis++)
+	{
+		float t1 = (box._min[axis]-origin[axis])*invDirection[axis];
+		float t2 = (box._max[axis]-origin[axis])*invDirection[axis];
+		if(t1 > t2){float tmp = t1; t1 = t2; t2 = tmp;}
+		if(t1 > tEnter){tEnter = t1;}
+		if(t2 < tExit){tExit = t2;}
+		if(tEnter > tExit){return false;}
+	}
+	return true;
+}
+
+//
+//Append all proxies hit by the ray, walks the cells along the ray with a 3d dda
+//
+void UniformGridBroadPhase::QueryRay(const osg::Vec3& origin, const osg::Vec3& direction, const float& maxDistance, RayHitVector& hits)
+{
+	if(_numProxies == 0){return;}
+
+	osg::Vec3 invDirection(1.0f/direction.x(), 1.0f/direction.y(), 1.0f/direction.z());
+
+	//only walk the part of the ray inside the populated space
+	float tEnter, tExit;
+	if(!ClipRayToBox(origin, invDirection, _bounds, maxDistance, tEnter, tExit)){return;}
+
+	osg::Vec3 start = origin + direction*tEnter;
+	int cell[3];
+	int step[3];
+	float tMax[3];
+	float tDelta[3];
+	for(unsigned int axis=0; axis<3; axis++)
+	{
+		cell[axis] = ComputeCell(start[axis]);
+		if(direction[axis] > 0.0f){
+			step[axis] = 1;
+			tMax[axis] = tEnter + ((cell[axis]+1)*_cellSize - start[axis])*invDirection[axis];
+			tDelta[axis] = _cellSize*invDirection[axis];
+		}else if(direction[axis] < 0.0f){
+			step[axis] = -1;
+			tMax[axis] = tEnter + (cell[axis]*_cellSize - start[axis])*invDirection[axis];
+			tDelta[axis] = -_cellSize*invDirection[axis];
+		}else{
+			step[axis] = 0;
+			tMax[axis] = FLT_MAX;
+			tDelta[axis] = FLT_MAX;
+		}
+	}
+
+	unsigned int stamp = NextStamp();
+	unsigned int firstHit = hits.size();
+
+	float t = tEnter;
+	while(t <= tExit)
+	{
+		const std::vector<int>& bucket = _buckets[HashCell(cell[0], cell[1], cell[2])];
+		for(unsigned int i=0; i<bucket.size(); i++)
+		{
+			GridProxy& proxy = _proxies[bucket[i]];
+			if(proxy._stamp == stamp){continue;}
+			proxy._stamp = stamp;
+
+			float distance;
+			if(RayIntersectsBox(origin, invDirection, proxy._box, maxDistance, distance)){
+				hits.push_back(RayHit(bucket[i], distance));
+			}
+		}
+
+		//step into the next cell along the axis with the nearest boundary
+		unsigned int axis = 0;
+		if(tMax[1] < tMax[axis]){axis = 1;}
+		if(tMax[2] < tMax[axis]){axis = 2;}
+		if(step[axis] == 0){break;}
+		t = tMax[axis];
+		cell[axis] += step[axis];
+		tMax[axis] += tDelta[axis];
+	}
+
+	std::sort(hits.begin()+firstHit, hits.end());
+}
+
+UniformGridBroadPhase::CellRange UniformGridBroadPhase::ComputeCellRange(const osg::BoundingBox& box)const
+{
+	CellRange range;
+	for(unsigned int axis=0; axis<3; axis++){
+		range._min[axis] = ComputeCell(box._min[axis]);
+		range._max[axis] = ComputeCell(box._max[axis]);
+	}
+	return range;
+}
+
+int UniformGridBroadPhase::ComputeCell(const float& value)const
+{
+	return (int)floorf(value*_invCellSize);
+}
+
+unsigned int UniformGridBroadPhase::HashCell(int x, int y, int z)const
+{
+	unsigned int hash = ((unsigned int)x*73856093u) ^ ((unsigned int)y*19349663u) ^ ((unsigned int)z*83492791u);
+	return hash & (_buckets.size()-1);
+}
+
+void UniformGridBroadPhase::InsertIntoCells(int proxyID)
+{
+	const CellRange& cells = _proxies[proxyID]._cells;
+	for(int z=cells._min[2]; z<=cells._max[2]; z++){
+		for(int y=cells._min[1]; y<=cells._max[1]; y++){
+			for(int x=cells._min[0]; x<=cells._max[0]; x++){
+				_buckets[HashCell(x, y, z)].push_back(proxyID);
+			}
+		}
+	}
+}
+
+void UniformGridBroadPhase::RemoveFromCells(int proxyID)
+{
+	const CellRange& cells = _proxies[proxyID]._cells;
+	for(int z=cells._min[2]; z<=cells._max[2]; z++){
+		for(int y=cells._min[1]; y<=cells._max[1]; y++){
+			for(int x=cells._min[0]; x<=cells._max[0]; x++)
+			{
+				//order within a bucket doesn't matter so swap and pop
+				std::vector<int>& bucket = _buckets[HashCell(x, y, z)];
+				std::vector<int>::iterator itr = std::find(bucket.begin(), bucket.end(), proxyID);
+				if(itr != bucket.end()){
+					*itr = bucket.back();
+					bucket.pop_back();
+				}
+			}
+		}
+	}
+}
+
+//
+//Test every proxy in a cell against the box
+//
+void UniformGridBroadPhase::QueryCell(int x, int y, int z, const osg::BoundingBox& box, std::vector<int>& results)
+{
+	const std::vector<int>& bucket = _buckets[HashCell(x, y, z)];
+	for(unsigned int i=0; i<bucket.size(); i++)
+	{
+		GridProxy& proxy = _proxies[bucket[i]];
+		if(proxy._stamp == _stamp){continue;}
+		proxy._stamp = _stamp;
+		if(BoxesOverlap(proxy._box, box)){
+			results.push_back(bucket[i]);
+		}
+	}
+}
+
+//
+//Start a new query
+//
+unsigned int UniformGridBroadPhase::NextStamp()
+{
+	_stamp++;
+	//wrapped, clear the old stamps so none match by accident
+	if(_stamp == 0){
+		for(unsigned int i=0; i<_proxies.size(); i++){_proxies[i]._stamp = 0;}
+		_stamp = 1;
+	}
+	return _stamp;
+}
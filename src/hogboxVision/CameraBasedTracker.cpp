@@ -1,22 +1,115 @@
 #include <hogboxVision/CameraBasedTracker.h>
+#include <hogboxVision/VideoStream.h>
+
+#include <hogbox/Profiler.h>
+
+#include <osg/Image>
+#include <osg/Timer>
+#include <OpenThreads/Thread>
+#include <OpenThreads/ScopedLock>
+
+#include <string.h>
 
 using namespace hogboxVision;
 
+//
+//Runs the trackers UpdateTracking on the latest frame handed to it
+//
+class CameraBasedTracker::TrackerThread : public osg::Referenced, public OpenThreads::Thread
+{
+public:
+	TrackerThread(CameraBasedTracker* tracker)
+		: osg::Referenced(),
+		OpenThreads::Thread(),
+		p_tracker(tracker),
+		_done(false)
+	{
+	}
+
+	virtual void run()
+	{
+		hogbox::Profiler::Inst()->SetThreadName("CameraBasedTracker");
+
+		while(true)
+		{
+			double frameTime;
+			{
+				OpenThreads::ScopedLock<OpenThreads::Mutex> lock(p_tracker->_frameMutex);
+				while(!p_tracker->_hasPendingFrame && !_done){
+					p_tracker->_frameCondition.wait(&p_tracker->_frameMutex);
+				}
+				if(_done){return;}
+
+				//take the latest frame, the old working image is reused for the next one
+				osg::ref_ptr<osg::Image> working = p_tracker->_pendingImage;
+				p_tracker->_pendingImage = p_tracker->_workingImage;
+				p_tracker->_workingImage = working;
+				frameTime = p_tracker->_pendingFrameTime;
+				p_tracker->_hasPendingFrame = false;
+			}
+			p_tracker->TrackFrame(p_tracker->_workingImage.get(), frameTime);
+		}
+	}
+
+	//
+	//Stop and wait for the current frame to finish
+	void Quit()
+	{
+		{
+			OpenThreads::ScopedLock<OpenThreads::Mutex> lock(p_tracker->_frameMutex);
+			_done = true;
+			p_tracker->_frameCondition.broadcast();
+		}
+		join();
+	}
+
+protected:
+	virtual ~TrackerThread(){}
+
+	CameraBasedTracker* p_tracker;
+	bool _done;
+};
+
+//
+//Copy the pixels of src into dst, reallocating dst if the layout differs
+//
+static void CopyTrackerImage(const osg::Image* src, osg::Image* dst)
+{
+	if(dst->s() != src->s() || dst->t() != src->t() || dst->r() != src->r() ||
+		dst->getPixelFormat() != src->getPixelFormat() || dst->getDataType() != src->getDataType() ||
+		dst->getPacking() != src->getPacking())
+	{
+		dst->allocateImage(src->s(), src->t(), src->r(), src->getPixelFormat(), src->getDataType(), src->getPacking());
+		dst->setInternalTextureFormat(src->getInternalTextureFormat());
+	}
+	memcpy(dst->data(), src->data(), src->getTotalSizeInBytes());
+	dst->setOrigin(src->getOrigin());
+	dst->dirty();
+}
+
 CameraBasedTracker::CameraBasedTracker(void) 
 	: HogTracker(),
-	_modifiedCount(-1)
+	_modifiedCount(-1),
+	_hasPendingFrame(false),
+	_pendingFrameTime(0.0),
+	_lastDetectionEnd(-1.0)
 {
 }
 
 CameraBasedTracker::~CameraBasedTracker(void)
 {
+	SetThreaded(false);
 	_cc = NULL;
 	p_image = NULL;
 }
 
 /** Copy constructor using CopyOp to manage deep vs shallow copy.*/
 CameraBasedTracker::CameraBasedTracker(const CameraBasedTracker& tracker,const osg::CopyOp& copyop)
-	: HogTracker(tracker, copyop)
+	: HogTracker(tracker, copyop),
+	_modifiedCount(-1),
+	_hasPendingFrame(false),
+	_pendingFrameTime(0.0),
+	_lastDetectionEnd(-1.0)
 {
 }
 
@@ -34,20 +127,115 @@ bool CameraBasedTracker::InitTracker(int width, int height, const std::string& c
 	return true;
 }
 
+//
+//When image was captured, from the video stream if it records one,
+//otherwise now
+//
+static double GetImageCaptureTime(osg::Image* image)
+{
+	VideoStream* stream = dynamic_cast<VideoStream*>(image);
+	double captureTime = stream ? stream->GetFrameCaptureTime() : -1.0;
+	return captureTime >= 0.0 ? captureTime : osg::Timer::instance()->time_s();
+}
+
 //
 //update the tracker then call base update which calls update tracker
 //
 void CameraBasedTracker::Update(osg::ImagePtr image)
 {
+	HOGBOX_PROFILE_SCOPE("CameraBasedTracker::Update");
+
+	if(!image.valid()){return;}
+
+	if(_thread.valid())
+	{
+		if(_modifiedCount == (int)image->getModifiedCount()){return;}
+		_modifiedCount = image->getModifiedCount();
+
+		//replace any frame the thread hasn't started on
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_frameMutex);
+		if(_hasPendingFrame){
+			_stats._skippedFrames++;
+			HOGBOX_PROFILE_COUNTER("CameraBasedTracker skipped frames", (double)_stats._skippedFrames);
+		}
+		if(!_pendingImage.valid()){_pendingImage = new osg::Image();}
+		CopyTrackerImage(image.get(), _pendingImage.get());
+		_pendingFrameTime = GetImageCaptureTime(image.get());
+		_hasPendingFrame = true;
+		_frameCondition.signal();
+		return;
+	}
+
+	if(_modifiedCount != (int)image->getModifiedCount())
+	{
+		//call base to trigger detection and tracking of new image
+		TrackFrame(image.get(), GetImageCaptureTime(image.get()));
+		_modifiedCount = image->getModifiedCount();
+	}
+}
+
+//
+//Track image captured at frameTime and record the stats
+//
+void CameraBasedTracker::TrackFrame(osg::Image* image, double frameTime)
+{
+	HOGBOX_PROFILE_SCOPE("CameraBasedTracker::TrackFrame");
+
 	//clear our old image pointer
 	p_image = NULL;
 	//set new
 	p_image = image;
+	_frameTime = frameTime;
 
-	if(_modifiedCount != p_image->getModifiedCount())
-	{
-		//call base to trigger detection and tracking of new image
-		HogTracker::Update();
-		_modifiedCount = p_image->getModifiedCount();
+	osg::Timer_t start = osg::Timer::instance()->tick();
+	HogTracker::Update();
+	osg::Timer_t end = osg::Timer::instance()->tick();
+
+	double endTime = osg::Timer::instance()->time_s();
+
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_frameMutex);
+	_stats._detectionMs = osg::Timer::instance()->delta_m(start, end);
+	_stats._latencyMs = (endTime - frameTime) * 1000.0;
+	//smooth over roughly the last 16 frames
+	_stats._averageLatencyMs = _stats._processedFrames == 0 ? _stats._latencyMs :
+								_stats._averageLatencyMs + (_stats._latencyMs - _stats._averageLatencyMs) * (1.0/16.0);
+	if(_lastDetectionEnd >= 0.0 && endTime > _lastDetectionEnd){
+		double rate = 1.0 / (endTime - _lastDetectionEnd);
+		_stats._detectionRate = _stats._detectionRate == 0.0 ? rate : _stats._detectionRate + (rate - _stats._detectionRate) * (1.0/16.0);
 	}
+	_lastDetectionEnd = endTime;
+	_stats._processedFrames++;
+	HOGBOX_PROFILE_COUNTER("CameraBasedTracker latency ms", _stats._latencyMs);
+}
+
+//
+//Start or stop the tracker thread
+//
+void CameraBasedTracker::SetThreaded(bool threaded)
+{
+	if(threaded == _thread.valid()){return;}
+
+	if(threaded){
+		_hasPendingFrame = false;
+		_thread = new TrackerThread(this);
+		_thread->start();
+	}else{
+		_thread->Quit();
+		_thread = NULL;
+		//track the next image passed to Update straight away
+		_modifiedCount = -1;
+	}
+}
+
+TrackerStats CameraBasedTracker::GetTrackerStats()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_frameMutex);
+	return _stats;
+}
+
+void CameraBasedTracker::ResetTrackerStats()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_frameMutex);
+	_stats = TrackerStats();
+	_lastDetectionEnd = -1.0;
 }
@@ -1,13 +1,63 @@
 #include <hogboxVision/CameraCalibration.h>
+#include <hogboxVision/RTTPass.h>
+
+#include <osg/Notify>
+#include <osgDB/FileUtils>
+#include <osgDB/XmlParser>
+#include <OpenThreads/ScopedLock>
+
+#include <math.h>
+#include <stdlib.h>
 
 using namespace hogboxVision;
 
+#ifndef WIN32
+#define SHADER_COMPAT \
+"#ifndef GL_ES\n" \
+"#if (__VERSION__ <= 110)\n" \
+"#define lowp\n" \
+"#define mediump\n" \
+"#define highp\n" \
+"#endif\n" \
+"#endif\n"
+#else
+#define SHADER_COMPAT ""
+#endif
+
+static const char* undistortVertSource = {
+	SHADER_COMPAT
+	"attribute vec4 osg_Vertex;\n"
+	"attribute vec4 osg_MultiTexCoord0;\n"
+	"uniform mat4 osg_ModelViewProjectionMatrix;\n"
+	"varying highp vec2 texCoord0;\n"
+	"void main(void) {\n"
+	"  gl_Position = osg_ModelViewProjectionMatrix * osg_Vertex;\n"
+	"  texCoord0 = osg_MultiTexCoord0.xy;\n"
+	"}\n"
+};
+
+//the map holds the source coordinate as two 16 bit values, high byte first
+static const char* undistortFragSource = {
+	SHADER_COMPAT
+	"uniform sampler2D inputTexture;\n"
+	"uniform sampler2D undistortMap;\n"
+	"varying highp vec2 texCoord0;\n"
+	"void main(void) {\n"
+	"  highp vec4 map = texture2D(undistortMap, texCoord0);\n"
+	"  highp vec2 coord = (map.xz * 65280.0 + map.yw * 255.0) / 65535.0;\n"
+	"  gl_FragColor = texture2D(inputTexture, coord);\n"
+	"}\n"
+};
+
 CameraCalibration::CameraCalibration(void) 
 		: osg::Object(),
 		_cameraWidth(0),
 		_cameraHeight(0),
-		_focalLength(0.0f)
+		_focalLength(0.0f),
+		_focalLengthX(0.0),
+		_focalLengthY(0.0)
 {
+	for(unsigned int i=0; i<5; i++){_distortion[i] = 0.0;}
 }
 
 CameraCalibration::~CameraCalibration(void)
@@ -16,14 +66,269 @@ CameraCalibration::~CameraCalibration(void)
 
 /** Copy constructor using CopyOp to manage deep vs shallow copy.*/
 CameraCalibration::CameraCalibration(const CameraCalibration& calib,const osg::CopyOp& copyop)
-		: osg::Object(calib, copyop)
+		: osg::Object(calib, copyop),
+		_cameraWidth(calib._cameraWidth),
+		_cameraHeight(calib._cameraHeight),
+		_focalLength(calib._focalLength),
+		_focalLengthX(calib._focalLengthX),
+		_focalLengthY(calib._focalLengthY),
+		_principalPoint(calib._principalPoint)
 {
-
+	for(unsigned int i=0; i<5; i++){_distortion[i] = calib._distortion[i];}
 }
 
 
 void CameraCalibration::ChangeSize(int width, int height)
 {
+	if(_focalLengthX > 0.0 && _cameraWidth > 0 && _cameraHeight > 0)
+	{
+		double scaleX = (double)width / (double)_cameraWidth;
+		double scaleY = (double)height / (double)_cameraHeight;
+		SetIntrinsics(_focalLengthX * scaleX, _focalLengthY * scaleY, _principalPoint.x() * scaleX, _principalPoint.y() * scaleY);
+	}else{
+		//60 degree horizontal fov
+		double focalLength = (double)width * 0.5 / tan(osg::DegreesToRadians(30.0));
+		SetIntrinsics(focalLength, focalLength, (double)width * 0.5, (double)height * 0.5);
+	}
+	_cameraWidth = width;
+	_cameraHeight = height;
+}
+
+void CameraCalibration::SetIntrinsics(double focalLengthX, double focalLengthY, double principalX, double principalY)
+{
+	_focalLengthX = focalLengthX;
+	_focalLengthY = focalLengthY;
+	_focalLength = focalLengthX;
+	_principalPoint = osg::Vec2d(principalX, principalY);
+	ClearUndistortTables();
+}
+
+void CameraCalibration::SetDistortion(double k1, double k2, double p1, double p2, double k3)
+{
+	_distortion[0] = k1;
+	_distortion[1] = k2;
+	_distortion[2] = p1;
+	_distortion[3] = p2;
+	_distortion[4] = k3;
+	ClearUndistortTables();
+}
+
+bool CameraCalibration::HasDistortion()const
+{
+	for(unsigned int i=0; i<5; i++){
+		if(_distortion[i] != 0.0){return true;}
+	}
+	return false;
+}
+
+//
+//Apply the distortion to a normalised point
+//
+static osg::Vec2d DistortNormalised(const double* d, const osg::Vec2d& point)
+{
+	double x = point.x();
+	double y = point.y();
+	double r2 = x*x + y*y;
+	double radial = 1.0 + r2 * (d[0] + r2 * (d[1] + r2 * d[4]));
+	return osg::Vec2d(x * radial + 2.0 * d[2] * x * y + d[3] * (r2 + 2.0 * x * x),
+					y * radial + d[2] * (r2 + 2.0 * y * y) + 2.0 * d[3] * x * y);
+}
+
+osg::Vec2d CameraCalibration::DistortPoint(const osg::Vec2d& pixel)const
+{
+	return DistortPoint(pixel, _cameraWidth, _cameraHeight);
+}
+
+osg::Vec2d CameraCalibration::DistortPoint(const osg::Vec2d& pixel, int width, int height)const
+{
+	if(_focalLengthX <= 0.0 || _cameraWidth <= 0 || _cameraHeight <= 0){return pixel;}
+	double scaleX = (double)width / (double)_cameraWidth;
+	double scaleY = (double)height / (double)_cameraHeight;
+	double fx = _focalLengthX * scaleX;
+	double fy = _focalLengthY * scaleY;
+	double cx = _principalPoint.x() * scaleX;
+	double cy = _principalPoint.y() * scaleY;
+	osg::Vec2d distorted = DistortNormalised(_distortion, osg::Vec2d((pixel.x() - cx) / fx, (pixel.y() - cy) / fy));
+	return osg::Vec2d(distorted.x() * fx + cx, distorted.y() * fy + cy);
+}
+
+osg::Vec2d CameraCalibration::UndistortPoint(const osg::Vec2d& pixel)const
+{
+	if(_focalLengthX <= 0.0 || !HasDistortion()){return pixel;}
+	osg::Vec2d distorted((pixel.x() - _principalPoint.x()) / _focalLengthX, (pixel.y() - _principalPoint.y()) / _focalLengthY);
+
+	//fixed point iteration, removing the tangential part and dividing out the
+	//radial part at the current estimate, as OpenCV's undistortPoints
+	const double* d = _distortion;
+	osg::Vec2d point = distorted;
+	for(unsigned int i=0; i<20; i++)
+	{
+		double x = point.x();
+		double y = point.y();
+		double r2 = x*x + y*y;
+		double radial = 1.0 + r2 * (d[0] + r2 * (d[1] + r2 * d[4]));
+		if(radial <= 0.0){break;}
+		osg::Vec2d next((distorted.x() - 2.0 * d[2] * x * y - d[3] * (r2 + 2.0 * x * x)) / radial,
+						(distorted.y() - d[2] * (r2 + 2.0 * y * y) - 2.0 * d[3] * x * y) / radial);
+		bool converged = (next - point).length2() < 1e-18;
+		point = next;
+		if(converged){break;}
+	}
+	return osg::Vec2d(point.x() * _focalLengthX + _principalPoint.x(), point.y() * _focalLengthY + _principalPoint.y());
+}
+
+RemapTablePtr CameraCalibration::GetUndistortTable(int width, int height, bool bottomUp)
+{
+	if(width < 2 || height < 2){
+		osg::notify(osg::WARN) << "CameraCalibration::GetUndistortTable: ERROR: Can't build a table for a " << width << "x" << height << " image." << std::endl;
+		return NULL;
+	}
+	if(_focalLengthX <= 0.0 || _cameraWidth <= 0 || _cameraHeight <= 0){ChangeSize(width, height);}
+
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_tableMutex);
+	TableKey key(std::pair<int, int>(width, height), bottomUp);
+	std::map<TableKey, RemapTablePtr>::iterator itr = _undistortTables.find(key);
+	if(itr != _undistortTables.end()){return (*itr).second;}
+
+	RemapTablePtr table = new RemapTable();
+	if(!table->Allocate(width, height, width, height)){return NULL;}
+	for(int row=0; row<height; row++)
+	{
+		//rows count up the picture when it's stored bottom up
+		double y = bottomUp ? (double)(height - 1 - row) : (double)row;
+		for(int x=0; x<width; x++)
+		{
+			osg::Vec2d source = DistortPoint(osg::Vec2d(x, y), width, height);
+			table->Set(x, row, source.x(), bottomUp ? (double)(height - 1) - source.y() : source.y());
+		}
+	}
+	_undistortTables[key] = table;
+	return table;
+}
+
+bool CameraCalibration::UndistortImage(const osg::Image* src, osg::Image* dst)
+{
+	if(!src || !dst){return false;}
+	RemapTablePtr table = GetUndistortTable(src->s(), src->t(), src->getOrigin() == osg::Image::BOTTOM_LEFT);
+	if(!table.valid()){return false;}
+	return ImageKernels::Remap(src, *table, dst);
+}
+
+osg::Texture2D* CameraCalibration::CreateUndistortTexture(int width, int height, bool bottomUp)
+{
+	if(width < 1 || height < 1){
+		osg::notify(osg::WARN) << "CameraCalibration::CreateUndistortTexture: ERROR: Can't build a map for a " << width << "x" << height << " image." << std::endl;
+		return NULL;
+	}
+	if(_focalLengthX <= 0.0 || _cameraWidth <= 0 || _cameraHeight <= 0){ChangeSize(width, height);}
+
+	//texture rows are image rows, so bottomUp flips as in GetUndistortTable
+	osg::ref_ptr<osg::Image> map = new osg::Image();
+	map->allocateImage(width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE);
+	for(int row=0; row<height; row++)
+	{
+		unsigned char* texel = map->data(0, row);
+		double y = bottomUp ? (double)(height - 1 - row) : (double)row;
+		for(int x=0; x<width; x++, texel+=4)
+		{
+			osg::Vec2d source = DistortPoint(osg::Vec2d(x, y), width, height);
+			double s = (source.x() + 0.5) / (double)width;
+			double t = (bottomUp ? (double)(height - 1) - source.y() + 0.5 : source.y() + 0.5) / (double)height;
+			unsigned int fixedS = (unsigned int)(osg::clampBetween(s, 0.0, 1.0) * 65535.0 + 0.5);
+			unsigned int fixedT = (unsigned int)(osg::clampBetween(t, 0.0, 1.0) * 65535.0 + 0.5);
+			texel[0] = (unsigned char)(fixedS >> 8);
+			texel[1] = (unsigned char)(fixedS & 0xff);
+			texel[2] = (unsigned char)(fixedT >> 8);
+			texel[3] = (unsigned char)(fixedT & 0xff);
+		}
+	}
+
+	osg::Texture2D* texture = new osg::Texture2D(map.get());
+	texture->setInternalFormat(GL_RGBA);
+	texture->setResizeNonPowerOfTwoHint(false);
+	texture->setFilter(osg::Texture::MIN_FILTER, osg::Texture::NEAREST);
+	texture->setFilter(osg::Texture::MAG_FILTER, osg::Texture::NEAREST);
+	texture->setWrap(osg::Texture::WRAP_S, osg::Texture::CLAMP_TO_EDGE);
+	texture->setWrap(osg::Texture::WRAP_T, osg::Texture::CLAMP_TO_EDGE);
+	return texture;
+}
+
+RTTPass* CameraCalibration::CreateUndistortPass(osg::Texture2D* inputTexture, int width, int height, bool bottomUp)
+{
+	if(!inputTexture){return NULL;}
+	osg::ref_ptr<osg::Texture2D> map = CreateUndistortTexture(width, height, bottomUp);
+	if(!map.valid()){return NULL;}
+
+	RTTPass::RTTArgs args;
+	args.outWidth = width;
+	args.outHeight = height;
+	args.requiredInCount = 2;
+	args.inputTextures["inputTexture"] = inputTexture;
+	args.inputTextures["undistortMap"] = map;
+	args.vertexShaderFile = undistortVertSource;
+	args.fragmentShaderFile = undistortFragSource;
+	args.shaderFileIsSource = true;
+
+	osg::ref_ptr<RTTPass> pass = new RTTPass();
+	if(!pass->Init(args)){
+		osg::notify(osg::WARN) << "CameraCalibration::CreateUndistortPass: ERROR: Failed to init the undistort pass." << std::endl;
+		return NULL;
+	}
+	return pass.release();
+}
+
+void CameraCalibration::ClearUndistortTables()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_tableMutex);
+	_undistortTables.clear();
+}
+
+static double GetXmlDouble(osgDB::XmlNode* node, const std::string& name, double defaultValue)
+{
+	osgDB::XmlNode::Properties::iterator itr = node->properties.find(name);
+	if(itr == node->properties.end()){return defaultValue;}
+	return atof((*itr).second.c_str());
+}
+
+//
+//Read the intrinsics from a <CameraCalibration> node
+//
+bool CameraCalibration::LoadCalibrationFromFile(const std::string& fileName)
+{
+	std::string path = osgDB::findDataFile(fileName);
+	if(path.empty()){
+		osg::notify(osg::WARN) << "CameraCalibration::LoadCalibrationFromFile: ERROR: Could not find file '" << fileName << "'." << std::endl;
+		return false;
+	}
+
+	osg::ref_ptr<osgDB::XmlNode> doc = new osgDB::XmlNode;
+	osgDB::XmlNode::Input input;
+	input.open(path);
+	input.readAllDataIntoBuffer();
+	doc->read(input);
+
+	osgDB::XmlNode* calibNode = doc->name == "CameraCalibration" ? doc.get() : NULL;
+	for(osgDB::XmlNode::Children::iterator itr = doc->children.begin(); itr != doc->children.end() && !calibNode; ++itr){
+		if((*itr)->name == "CameraCalibration"){calibNode = itr->get();}
+	}
+	if(!calibNode){
+		osg::notify(osg::WARN) << "CameraCalibration::LoadCalibrationFromFile: ERROR: File '" << path << "' must contain a <CameraCalibration> node." << std::endl;
+		return false;
+	}
+
+	int width = (int)GetXmlDouble(calibNode, "width", 0.0);
+	int height = (int)GetXmlDouble(calibNode, "height", 0.0);
+	double fx = GetXmlDouble(calibNode, "fx", 0.0);
+	if(width <= 0 || height <= 0 || fx <= 0.0){
+		osg::notify(osg::WARN) << "CameraCalibration::LoadCalibrationFromFile: ERROR: File '" << path << "' needs a width, height and fx." << std::endl;
+		return false;
+	}
+
 	_cameraWidth = width;
 	_cameraHeight = height;
+	SetIntrinsics(fx, GetXmlDouble(calibNode, "fy", fx),
+				GetXmlDouble(calibNode, "cx", (double)width * 0.5), GetXmlDouble(calibNode, "cy", (double)height * 0.5));
+	SetDistortion(GetXmlDouble(calibNode, "k1", 0.0), GetXmlDouble(calibNode, "k2", 0.0),
+				GetXmlDouble(calibNode, "p1", 0.0), GetXmlDouble(calibNode, "p2", 0.0), GetXmlDouble(calibNode, "k3", 0.0));
+	return true;
 }
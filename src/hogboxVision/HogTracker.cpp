@@ -1,4 +1,8 @@
 #include <hogboxVision/HogTracker.h>
+#include <hogboxVision/PoseFilter.h>
+
+#include <osg/Timer>
+#include <OpenThreads/ScopedLock>
 
 #include <stdio.h>
 #include <stdarg.h>
@@ -6,18 +10,21 @@
 using namespace hogboxVision;
 
 HogTracker::HogTracker(void)
-	: osg::Object()
+	: osg::Object(),
+	_frameTime(-1.0)
 {
 }
 
 HogTracker::~HogTracker(void)
 {
 	_trackedObjects.clear();
+	_poseFilter = NULL;
 }
 
 /** Copy constructor using CopyOp to manage deep vs shallow copy.*/
 HogTracker::HogTracker(const HogTracker& tracker,const osg::CopyOp& copyop)
-	: osg::Object(tracker, copyop)
+	: osg::Object(tracker, copyop),
+	_frameTime(-1.0)
 {
 }
 
@@ -33,10 +40,22 @@ bool HogTracker::InitTracker()
 //
 void HogTracker::Update()
 {
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_trackedObjectsMutex);
+
+	//stamp the poses the objects publish with the frame time
+	double time = _frameTime >= 0.0 ? _frameTime : osg::Timer::instance()->time_s();
+	for(unsigned int i=0; i<_trackedObjects.size(); i++){
+		_trackedObjects[i]->BeginTrackerUpdate(time);
+	}
 
 	//update the tracking
 	this->UpdateTracking();
 
+	//filter and publish every objects pose in one pass, objects
+	//the tracker didn't report count as missed
+	for(unsigned int i=0; i<_trackedObjects.size(); i++){
+		_trackedObjects[i]->EndTrackerUpdate();
+	}
 }
 
 //
@@ -45,5 +64,29 @@ void HogTracker::Update()
 void HogTracker::AddTrackedObject(TrackedObjectPtr object)
 {
 	if(!object.get()){return;}
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_trackedObjectsMutex);
+	if(_poseFilter.valid()){
+		object->SetPoseFilter(dynamic_cast<PoseFilter*>(_poseFilter->clone(osg::CopyOp::DEEP_COPY_ALL)));
+	}
 	_trackedObjects.push_back(object);
 }
+
+//
+//Give each tracked object, current and future, its own copy of filter
+//
+void HogTracker::SetPoseFilter(PoseFilter* filter)
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_trackedObjectsMutex);
+	_poseFilter = filter;
+	for(unsigned int i=0; i<_trackedObjects.size(); i++){
+		_trackedObjects[i]->SetPoseFilter(filter ? dynamic_cast<PoseFilter*>(filter->clone(osg::CopyOp::DEEP_COPY_ALL)) : NULL);
+	}
+}
+
+bool HogTracker::SetPoseFilterFromXmlFile(const std::string& fileName)
+{
+	osg::ref_ptr<PoseFilter> filter = ReadPoseFilterFromXmlFile(fileName);
+	if(!filter.valid()){return false;}
+	SetPoseFilter(filter.get());
+	return true;
+}
@@ -0,0 +1,1819 @@
+#include <hogboxVision/ImageKernels.h>
+
+#include <osg/Notify>
+
+#include <string.h>
+#include <vector>
+
+//pick up whichever vector extensions the compiler can target. SSE2 and NEON are
+//used when the build targets them, AVX2 functions are compiled for that target
+//individually and only called when cpuid reports it
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define HOGBOX_KERNELS_SSE2
+	#include <emmintrin.h>
+#endif
+#if defined(HOGBOX_KERNELS_SSE2) && ((defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))) || defined(__clang__) || (defined(_MSC_VER) && _MSC_VER >= 1700))
+	#define HOGBOX_KERNELS_AVX2
+	#include <immintrin.h>
+	#if defined(__GNUC__) || defined(__clang__)
+		#define HOGBOX_TARGET_AVX2 __attribute__((target("avx2")))
+	#else
+		#include <intrin.h>
+		#define HOGBOX_TARGET_AVX2
+	#endif
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#define HOGBOX_KERNELS_NEON
+	#include <arm_neon.h>
+#endif
+
+using namespace hogboxVision;
+
+//the set forced by SetInstructionSet, -1 to use the best
+static int s_instructionSet = -1;
+
+#ifdef HOGBOX_KERNELS_AVX2
+//
+//Does the cpu (and os) support AVX2
+//
+static bool CpuHasAVX2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	int info[4];
+	__cpuid(info, 0);
+	if(info[0] < 7){return false;}
+	__cpuid(info, 1);
+	//osxsave and avx, then the os must save the ymm registers
+	if((info[2] & (1<<27)) == 0 || (info[2] & (1<<28)) == 0){return false;}
+	if((_xgetbv(0) & 6) != 6){return false;}
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1<<5)) != 0;
+#else
+	//also checks the os saves the ymm registers
+	return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+#endif
+
+//
+//Scalar helpers
+//
+
+static inline unsigned char Clamp255(int value){
+	return (unsigned char)(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+//
+//BT.601 video range YUV to RGB in 8 bit fixed point, the vector paths compute
+//exactly the same sums
+//
+static inline void YUVToRGBPixel(int y, int u, int v, unsigned char* dst, unsigned int dstPixelBytes)
+{
+	int c = (y-16)*298 + 128;
+	int d = u-128;
+	int e = v-128;
+	dst[0] = Clamp255((c + 409*e) >> 8);
+	dst[1] = Clamp255((c - 100*d - 208*e) >> 8);
+	dst[2] = Clamp255((c + 516*d) >> 8);
+	if(dstPixelBytes == 4){dst[3] = 255;}
+}
+
+static void SwapRowsScalar(unsigned char* a, unsigned char* b, unsigned int count)
+{
+	unsigned char temp[256];
+	while(count > 0){
+		unsigned int chunk = count < sizeof(temp) ? count : sizeof(temp);
+		memcpy(temp, a, chunk);
+		memcpy(a, b, chunk);
+		memcpy(b, temp, chunk);
+		a += chunk; b += chunk; count -= chunk;
+	}
+}
+
+//
+//Swap pixels inwards from done pixels in from each end
+//
+static void FlipRowScalar(unsigned char* row, unsigned int width, unsigned int pixelBytes, unsigned int done)
+{
+	if(width < 2){return;}
+	unsigned char* left = row + done*pixelBytes;
+	unsigned char* right = row + (width-1-done)*pixelBytes;
+	while(left < right){
+		for(unsigned int c=0; c<pixelBytes; c++){
+			unsigned char temp = left[c];
+			left[c] = right[c];
+			right[c] = temp;
+		}
+		left += pixelBytes;
+		right -= pixelBytes;
+	}
+}
+
+//(a+b+1)/2, the rounding of pavgb/vrhadd
+static void AverageRowsScalar(unsigned char* dst, const unsigned char* a, const unsigned char* b, unsigned int start, unsigned int count)
+{
+	for(unsigned int i=start; i<count; i++){
+		dst[i] = (unsigned char)((a[i] + b[i] + 1) >> 1);
+	}
+}
+
+static void SwapRedBlueRowScalar(unsigned char* row, unsigned int start, unsigned int width, unsigned int pixelBytes)
+{
+	for(unsigned int x=start; x<width; x++){
+		unsigned char* pixel = row + x*pixelBytes;
+		unsigned char temp = pixel[0];
+		pixel[0] = pixel[2];
+		pixel[2] = temp;
+	}
+}
+
+//
+//Convert one row from pixel start, chroma indexing assumes start is even
+//
+static void ConvertYUVRowScalar(ImageKernels::YUVFormat format, const unsigned char* yRow, const unsigned char* uRow, const unsigned char* vRow,
+								unsigned char* dst, unsigned int start, unsigned int width, unsigned int dstPixelBytes)
+{
+	for(unsigned int x=start; x<width; x++)
+	{
+		unsigned int pair = x >> 1;
+		int y, u, v;
+		switch(format)
+		{
+			case ImageKernels::YUY2:
+				y = yRow[x*2]; u = yRow[pair*4+1]; v = yRow[pair*4+3];
+				break;
+			case ImageKernels::UYVY:
+				y = yRow[x*2+1]; u = yRow[pair*4]; v = yRow[pair*4+2];
+				break;
+			case ImageKernels::NV12:
+				y = yRow[x]; u = uRow[pair*2]; v = uRow[pair*2+1];
+				break;
+			default:
+				y = yRow[x]; u = uRow[pair]; v = vRow[pair];
+				break;
+		}
+		YUVToRGBPixel(y, u, v, dst + x*dstPixelBytes, dstPixelBytes);
+	}
+}
+
+//
+//2x2 box filter from output pixel start
+//
+static void DownscaleRowScalar(const unsigned char* row0, const unsigned char* row1, unsigned char* dst,
+								unsigned int start, unsigned int dstWidth, unsigned int pixelBytes)
+{
+	for(unsigned int x=start; x<dstWidth; x++){
+		const unsigned char* a = row0 + x*2*pixelBytes;
+		const unsigned char* b = row1 + x*2*pixelBytes;
+		for(unsigned int c=0; c<pixelBytes; c++){
+			dst[x*pixelBytes+c] = (unsigned char)((a[c] + a[c+pixelBytes] + b[c] + b[c+pixelBytes] + 2) >> 2);
+		}
+	}
+}
+
+//
+//(77R + 150G + 29B + 128) >> 8 from pixel start
+//
+static void LuminanceRowScalar(const unsigned char* src, unsigned char* dst, unsigned int start, unsigned int width,
+								unsigned int pixelBytes, bool bgr)
+{
+	unsigned int r = bgr ? 2 : 0;
+	unsigned int b = bgr ? 0 : 2;
+	for(unsigned int x=start; x<width; x++){
+		const unsigned char* pixel = src + x*pixelBytes;
+		dst[x] = (unsigned char)((77*pixel[r] + 150*pixel[1] + 29*pixel[b] + 128) >> 8);
+	}
+}
+
+//
+//Add a row to (or subtract it from) the column sums of a threshold window
+//
+static void AccumulateRowScalar(unsigned int* sums, const unsigned char* row, unsigned int start, unsigned int width, bool subtract)
+{
+	if(subtract){
+		for(unsigned int x=start; x<width; x++){sums[x] -= row[x];}
+	}else{
+		for(unsigned int x=start; x<width; x++){sums[x] += row[x];}
+	}
+}
+
+//255 where src + offset < mean, the vector paths saturate the add which gives the same result
+static void ThresholdRowScalar(const unsigned char* src, const unsigned char* mean, unsigned char* dst,
+								unsigned int start, unsigned int width, unsigned char offset)
+{
+	for(unsigned int x=start; x<width; x++){
+		dst[x] = (src[x] + offset < mean[x]) ? 255 : 0;
+	}
+}
+
+//
+//Bilinear remap from output pixel start. Blends along x then y, the sum is exact
+//so the vector paths get the same result
+//
+static void RemapRowScalar(const unsigned char* src, unsigned int srcStride, unsigned int pixelBytes, const unsigned short* coords,
+							const unsigned char* fractions, unsigned char* dst, unsigned int start, unsigned int width)
+{
+	for(unsigned int x=start; x<width; x++)
+	{
+		const unsigned char* p = src + coords[x*2+1]*srcStride + coords[x*2]*pixelBytes;
+		const unsigned char* q = p + srcStride;
+		int fx = fractions[x*2];
+		int fy = fractions[x*2+1];
+		for(unsigned int c=0; c<pixelBytes; c++){
+			int top = p[c]*(128-fx) + p[c+pixelBytes]*fx;
+			int bottom = q[c]*(128-fx) + q[c+pixelBytes]*fx;
+			dst[x*pixelBytes+c] = (unsigned char)((top*(128-fy) + bottom*fy + 8192) >> 14);
+		}
+	}
+}
+
+
+#ifdef HOGBOX_KERNELS_SSE2
+//
+//SSE2 kernels, each returns how much it processed so the scalar code can finish
+//
+
+static unsigned int SwapRowsSSE2(unsigned char* a, unsigned char* b, unsigned int count)
+{
+	unsigned int i = 0;
+	for( ; i+16<=count; i+=16){
+		__m128i va = _mm_loadu_si128((const __m128i*)(a+i));
+		__m128i vb = _mm_loadu_si128((const __m128i*)(b+i));
+		_mm_storeu_si128((__m128i*)(a+i), vb);
+		_mm_storeu_si128((__m128i*)(b+i), va);
+	}
+	return i;
+}
+
+static inline __m128i ReversePixelsSSE2(__m128i v, unsigned int pixelBytes)
+{
+	if(pixelBytes == 1){
+		//swap bytes within words then reverse the words
+		v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+	}
+	if(pixelBytes <= 2){
+		v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0,1,2,3));
+		v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0,1,2,3));
+		return _mm_shuffle_epi32(v, _MM_SHUFFLE(1,0,3,2));
+	}
+	return _mm_shuffle_epi32(v, _MM_SHUFFLE(0,1,2,3));
+}
+
+//
+//Reverse 16 byte blocks from each end of the row, returns pixels done from each end
+//
+static unsigned int FlipRowSSE2(unsigned char* row, unsigned int width, unsigned int pixelBytes)
+{
+	if(pixelBytes == 3){return 0;}
+	unsigned int block = 16/pixelBytes;
+	unsigned int left = 0;
+	unsigned int right = width;
+	while(right-left >= block*2)
+	{
+		unsigned char* l = row + left*pixelBytes;
+		unsigned char* r = row + (right-block)*pixelBytes;
+		__m128i a = _mm_loadu_si128((const __m128i*)l);
+		__m128i b = _mm_loadu_si128((const __m128i*)r);
+		_mm_storeu_si128((__m128i*)l, ReversePixelsSSE2(b, pixelBytes));
+		_mm_storeu_si128((__m128i*)r, ReversePixelsSSE2(a, pixelBytes));
+		left += block;
+		right -= block;
+	}
+	return left;
+}
+
+static unsigned int AverageRowsSSE2(unsigned char* dst, const unsigned char* a, const unsigned char* b, unsigned int count)
+{
+	unsigned int i = 0;
+	for( ; i+16<=count; i+=16){
+		__m128i va = _mm_loadu_si128((const __m128i*)(a+i));
+		__m128i vb = _mm_loadu_si128((const __m128i*)(b+i));
+		_mm_storeu_si128((__m128i*)(dst+i), _mm_avg_epu8(va, vb));
+	}
+	return i;
+}
+
+static unsigned int SwapRedBlueRowSSE2(unsigned char* row, unsigned int width, unsigned int pixelBytes)
+{
+	if(pixelBytes != 4){return 0;}
+	const __m128i keep = _mm_set1_epi32((int)0xFF00FF00);
+	unsigned int x = 0;
+	for( ; x+4<=width; x+=4){
+		__m128i v = _mm_loadu_si128((const __m128i*)(row+x*4));
+		__m128i rb = _mm_andnot_si128(keep, v);
+		rb = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+		_mm_storeu_si128((__m128i*)(row+x*4), _mm_or_si128(rb, _mm_and_si128(v, keep)));
+	}
+	return x;
+}
+
+//
+//Spread (u0,v0,u1,v1...) words into per pixel (u0,u0,u1,u1...) and (v0,v0,v1,v1...)
+//
+static inline void SplitChromaSSE2(__m128i uv, __m128i& u, __m128i& v)
+{
+	__m128i u32 = _mm_and_si128(uv, _mm_set1_epi32(0xFFFF));
+	__m128i v32 = _mm_srli_epi32(uv, 16);
+	u = _mm_or_si128(u32, _mm_slli_epi32(u32, 16));
+	v = _mm_or_si128(v32, _mm_slli_epi32(v32, 16));
+}
+
+//
+//Convert 8 pixels of 16 bit y, u, v to two registers of RGBA
+//
+static inline void YUVToRGBASSE2(__m128i y, __m128i u, __m128i v, __m128i& rgbaLo, __m128i& rgbaHi)
+{
+	const __m128i kY = _mm_setr_epi16(298,128, 298,128, 298,128, 298,128);
+	const __m128i kR = _mm_setr_epi16(0,409, 0,409, 0,409, 0,409);
+	const __m128i kG = _mm_setr_epi16(-100,-208, -100,-208, -100,-208, -100,-208);
+	const __m128i kB = _mm_setr_epi16(516,0, 516,0, 516,0, 516,0);
+
+	__m128i c = _mm_sub_epi16(y, _mm_set1_epi16(16));
+	__m128i d = _mm_sub_epi16(u, _mm_set1_epi16(128));
+	__m128i e = _mm_sub_epi16(v, _mm_set1_epi16(128));
+
+	//298*c+128 and the chroma terms as 32 bit pair sums
+	__m128i one = _mm_set1_epi16(1);
+	__m128i yLo = _mm_madd_epi16(_mm_unpacklo_epi16(c, one), kY);
+	__m128i yHi = _mm_madd_epi16(_mm_unpackhi_epi16(c, one), kY);
+	__m128i deLo = _mm_unpacklo_epi16(d, e);
+	__m128i deHi = _mm_unpackhi_epi16(d, e);
+
+	__m128i r = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(yLo, _mm_madd_epi16(deLo, kR)), 8),
+								_mm_srai_epi32(_mm_add_epi32(yHi, _mm_madd_epi16(deHi, kR)), 8));
+	__m128i g = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(yLo, _mm_madd_epi16(deLo, kG)), 8),
+								_mm_srai_epi32(_mm_add_epi32(yHi, _mm_madd_epi16(deHi, kG)), 8));
+	__m128i b = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(yLo, _mm_madd_epi16(deLo, kB)), 8),
+								_mm_srai_epi32(_mm_add_epi32(yHi, _mm_madd_epi16(deHi, kB)), 8));
+
+	//clamp to bytes and interleave
+	__m128i rg = _mm_unpacklo_epi8(_mm_packus_epi16(r, r), _mm_packus_epi16(g, g));
+	__m128i ba = _mm_unpacklo_epi8(_mm_packus_epi16(b, b), _mm_set1_epi8((char)0xFF));
+	rgbaLo = _mm_unpacklo_epi16(rg, ba);
+	rgbaHi = _mm_unpackhi_epi16(rg, ba);
+}
+
+static unsigned int ConvertYUVRowSSE2(ImageKernels::YUVFormat format, const unsigned char* yRow, const unsigned char* uRow, const unsigned char* vRow,
+									unsigned char* dst, unsigned int width, unsigned int dstPixelBytes)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i lowBytes = _mm_set1_epi16(0xFF);
+	unsigned int x = 0;
+	for( ; x+8<=width; x+=8)
+	{
+		__m128i y, u, v;
+		switch(format)
+		{
+			case ImageKernels::YUY2:
+			case ImageKernels::UYVY:
+			{
+				__m128i packed = _mm_loadu_si128((const __m128i*)(yRow+x*2));
+				bool yFirst = format == ImageKernels::YUY2;
+				y = yFirst ? _mm_and_si128(packed, lowBytes) : _mm_srli_epi16(packed, 8);
+				SplitChromaSSE2(yFirst ? _mm_srli_epi16(packed, 8) : _mm_and_si128(packed, lowBytes), u, v);
+				break;
+			}
+			case ImageKernels::NV12:
+			{
+				y = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(yRow+x)), zero);
+				SplitChromaSSE2(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(uRow+x)), zero), u, v);
+				break;
+			}
+			default:
+			{
+				int u4, v4;
+				memcpy(&u4, uRow+x/2, 4);
+				memcpy(&v4, vRow+x/2, 4);
+				y = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(yRow+x)), zero);
+				u = _mm_unpacklo_epi8(_mm_cvtsi32_si128(u4), zero);
+				v = _mm_unpacklo_epi8(_mm_cvtsi32_si128(v4), zero);
+				u = _mm_unpacklo_epi16(u, u);
+				v = _mm_unpacklo_epi16(v, v);
+				break;
+			}
+		}
+
+		__m128i lo, hi;
+		YUVToRGBASSE2(y, u, v, lo, hi);
+		if(dstPixelBytes == 4){
+			_mm_storeu_si128((__m128i*)(dst+x*4), lo);
+			_mm_storeu_si128((__m128i*)(dst+x*4+16), hi);
+		}else{
+			//no byte shuffle in SSE2, drop the alpha on the way out
+			unsigned char rgba[32];
+			_mm_storeu_si128((__m128i*)rgba, lo);
+			_mm_storeu_si128((__m128i*)(rgba+16), hi);
+			unsigned char* out = dst+x*3;
+			for(unsigned int p=0; p<8; p++){
+				out[p*3] = rgba[p*4];
+				out[p*3+1] = rgba[p*4+1];
+				out[p*3+2] = rgba[p*4+2];
+			}
+		}
+	}
+	return x;
+}
+
+//
+//Returns output pixels done
+//
+static unsigned int DownscaleRowSSE2(const unsigned char* row0, const unsigned char* row1, unsigned char* dst,
+									unsigned int dstWidth, unsigned int pixelBytes)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i two = _mm_set1_epi16(2);
+	unsigned int x = 0;
+	if(pixelBytes == 4)
+	{
+		//4 pixels in, 2 out
+		for( ; x+2<=dstWidth; x+=2){
+			__m128i a = _mm_loadu_si128((const __m128i*)(row0+x*8));
+			__m128i b = _mm_loadu_si128((const __m128i*)(row1+x*8));
+			__m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+			__m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+			__m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+			sum = _mm_srli_epi16(_mm_add_epi16(sum, two), 2);
+			_mm_storel_epi64((__m128i*)(dst+x*4), _mm_packus_epi16(sum, sum));
+		}
+	}
+	else if(pixelBytes == 1)
+	{
+		//16 pixels in, 8 out
+		const __m128i one = _mm_set1_epi16(1);
+		for( ; x+8<=dstWidth; x+=8){
+			__m128i a = _mm_loadu_si128((const __m128i*)(row0+x*2));
+			__m128i b = _mm_loadu_si128((const __m128i*)(row1+x*2));
+			__m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+			__m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+			__m128i sum = _mm_packs_epi32(_mm_madd_epi16(lo, one), _mm_madd_epi16(hi, one));
+			sum = _mm_srli_epi16(_mm_add_epi16(sum, two), 2);
+			_mm_storel_epi64((__m128i*)(dst+x), _mm_packus_epi16(sum, sum));
+		}
+	}
+	return x;
+}
+
+//
+//4 byte pixels only, 4 at a time. Also used for the AVX2 set
+//
+static unsigned int LuminanceRowSSE2(const unsigned char* src, unsigned char* dst, unsigned int width, unsigned int pixelBytes, bool bgr)
+{
+	if(pixelBytes != 4){return 0;}
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i weights = bgr ? _mm_setr_epi16(29,150,77,0,29,150,77,0) : _mm_setr_epi16(77,150,29,0,77,150,29,0);
+	const __m128i round = _mm_set1_epi32(128);
+	unsigned int x = 0;
+	for( ; x+4<=width; x+=4){
+		__m128i v = _mm_loadu_si128((const __m128i*)(src+x*4));
+		__m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(v, zero), weights);
+		__m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(v, zero), weights);
+		//add the two partial sums of each pixel, leaving them in the even lanes
+		lo = _mm_add_epi32(lo, _mm_srli_epi64(lo, 32));
+		hi = _mm_add_epi32(hi, _mm_srli_epi64(hi, 32));
+		__m128i sum = _mm_unpacklo_epi64(_mm_shuffle_epi32(lo, _MM_SHUFFLE(3,1,2,0)), _mm_shuffle_epi32(hi, _MM_SHUFFLE(3,1,2,0)));
+		sum = _mm_srli_epi32(_mm_add_epi32(sum, round), 8);
+		sum = _mm_packs_epi32(sum, sum);
+		int out = _mm_cvtsi128_si32(_mm_packus_epi16(sum, sum));
+		memcpy(dst+x, &out, 4);
+	}
+	return x;
+}
+
+static unsigned int AccumulateRowSSE2(unsigned int* sums, const unsigned char* row, unsigned int width, bool subtract)
+{
+	const __m128i zero = _mm_setzero_si128();
+	unsigned int x = 0;
+	for( ; x+16<=width; x+=16){
+		__m128i v = _mm_loadu_si128((const __m128i*)(row+x));
+		__m128i lo = _mm_unpacklo_epi8(v, zero);
+		__m128i hi = _mm_unpackhi_epi8(v, zero);
+		__m128i parts[4];
+		parts[0] = _mm_unpacklo_epi16(lo, zero);
+		parts[1] = _mm_unpackhi_epi16(lo, zero);
+		parts[2] = _mm_unpacklo_epi16(hi, zero);
+		parts[3] = _mm_unpackhi_epi16(hi, zero);
+		for(unsigned int i=0; i<4; i++){
+			__m128i* sum = (__m128i*)(sums+x+i*4);
+			__m128i s = _mm_loadu_si128(sum);
+			s = subtract ? _mm_sub_epi32(s, parts[i]) : _mm_add_epi32(s, parts[i]);
+			_mm_storeu_si128(sum, s);
+		}
+	}
+	return x;
+}
+
+static unsigned int ThresholdRowSSE2(const unsigned char* src, const unsigned char* mean, unsigned char* dst,
+									unsigned int width, unsigned char offset)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i ones = _mm_set1_epi8((char)-1);
+	const __m128i off = _mm_set1_epi8((char)offset);
+	unsigned int x = 0;
+	for( ; x+16<=width; x+=16){
+		__m128i s = _mm_loadu_si128((const __m128i*)(src+x));
+		__m128i m = _mm_loadu_si128((const __m128i*)(mean+x));
+		//mean - (src + offset) saturates to 0 unless the mean is greater
+		__m128i d = _mm_subs_epu8(m, _mm_adds_epu8(s, off));
+		_mm_storeu_si128((__m128i*)(dst+x), _mm_xor_si128(_mm_cmpeq_epi8(d, zero), ones));
+	}
+	return x;
+}
+
+//
+//The row blends are both under 2^15 so they pack into 16 bit pairs for the
+//second madd. 1 byte pixels 8 at a time, 4 byte pixels one at a time. Also used
+//for 4 byte pixels in the AVX2 set
+//
+static unsigned int RemapRowSSE2(const unsigned char* src, unsigned int srcStride, unsigned int pixelBytes, const unsigned short* coords,
+								const unsigned char* fractions, unsigned char* dst, unsigned int width)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i low = _mm_set1_epi32(0xFFFF);
+	const __m128i full = _mm_set1_epi32(128);
+	const __m128i round = _mm_set1_epi32(8192);
+	unsigned int x = 0;
+	if(pixelBytes == 1)
+	{
+		unsigned short top[8];
+		unsigned short bottom[8];
+		for( ; x+8<=width; x+=8)
+		{
+			for(unsigned int i=0; i<8; i++){
+				const unsigned char* p = src + coords[(x+i)*2+1]*srcStride + coords[(x+i)*2];
+				memcpy(&top[i], p, 2);
+				memcpy(&bottom[i], p+srcStride, 2);
+			}
+			__m128i t = _mm_loadu_si128((const __m128i*)top);
+			__m128i b = _mm_loadu_si128((const __m128i*)bottom);
+			__m128i f = _mm_loadu_si128((const __m128i*)(fractions+x*2));
+			__m128i sums[2];
+			for(unsigned int h=0; h<2; h++)
+			{
+				//pixel pairs and (fx, fy) as 16 bit pairs, 4 pixels
+				__m128i tt = h ? _mm_unpackhi_epi8(t, zero) : _mm_unpacklo_epi8(t, zero);
+				__m128i bb = h ? _mm_unpackhi_epi8(b, zero) : _mm_unpacklo_epi8(b, zero);
+				__m128i ff = h ? _mm_unpackhi_epi8(f, zero) : _mm_unpacklo_epi8(f, zero);
+				__m128i fx = _mm_and_si128(ff, low);
+				__m128i fy = _mm_srli_epi32(ff, 16);
+				__m128i wx = _mm_or_si128(_mm_sub_epi32(full, fx), _mm_slli_epi32(fx, 16));
+				__m128i wy = _mm_or_si128(_mm_sub_epi32(full, fy), _mm_slli_epi32(fy, 16));
+				__m128i rows = _mm_or_si128(_mm_madd_epi16(tt, wx), _mm_slli_epi32(_mm_madd_epi16(bb, wx), 16));
+				sums[h] = _mm_srli_epi32(_mm_add_epi32(_mm_madd_epi16(rows, wy), round), 14);
+			}
+			__m128i packed = _mm_packs_epi32(sums[0], sums[1]);
+			_mm_storel_epi64((__m128i*)(dst+x), _mm_packus_epi16(packed, packed));
+		}
+	}
+	else if(pixelBytes == 4)
+	{
+		for( ; x<width; x++)
+		{
+			const unsigned char* p = src + coords[x*2+1]*srcStride + coords[x*2]*4;
+			//the two pixels of each row interleaved by channel, (r0 r1 g0 g1...)
+			__m128i t = _mm_loadl_epi64((const __m128i*)p);
+			__m128i b = _mm_loadl_epi64((const __m128i*)(p+srcStride));
+			t = _mm_unpacklo_epi8(_mm_unpacklo_epi8(t, _mm_srli_si128(t, 4)), zero);
+			b = _mm_unpacklo_epi8(_mm_unpacklo_epi8(b, _mm_srli_si128(b, 4)), zero);
+			int fx = fractions[x*2];
+			int fy = fractions[x*2+1];
+			__m128i wx = _mm_set1_epi32((128-fx) | (fx << 16));
+			__m128i wy = _mm_set1_epi32((128-fy) | (fy << 16));
+			__m128i rows = _mm_or_si128(_mm_madd_epi16(t, wx), _mm_slli_epi32(_mm_madd_epi16(b, wx), 16));
+			__m128i sum = _mm_srli_epi32(_mm_add_epi32(_mm_madd_epi16(rows, wy), round), 14);
+			sum = _mm_packs_epi32(sum, sum);
+			int out = _mm_cvtsi128_si32(_mm_packus_epi16(sum, sum));
+			memcpy(dst+x*4, &out, 4);
+		}
+	}
+	return x;
+}
+#endif //HOGBOX_KERNELS_SSE2
+
+
+#ifdef HOGBOX_KERNELS_AVX2
+//
+//AVX2 kernels, also use the SSSE3 byte shuffle for the 3 byte pixel cases
+//
+
+HOGBOX_TARGET_AVX2 static unsigned int SwapRowsAVX2(unsigned char* a, unsigned char* b, unsigned int count)
+{
+	unsigned int i = 0;
+	for( ; i+32<=count; i+=32){
+		__m256i va = _mm256_loadu_si256((const __m256i*)(a+i));
+		__m256i vb = _mm256_loadu_si256((const __m256i*)(b+i));
+		_mm256_storeu_si256((__m256i*)(a+i), vb);
+		_mm256_storeu_si256((__m256i*)(b+i), va);
+	}
+	return i;
+}
+
+HOGBOX_TARGET_AVX2 static inline __m256i ReversePixelsAVX2(__m256i v, unsigned int pixelBytes)
+{
+	if(pixelBytes == 4){
+		return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7,6,5,4,3,2,1,0));
+	}
+	//reverse within each lane then swap the lanes
+	__m256i mask = pixelBytes == 1 ?
+		_mm256_setr_epi8(15,14,13,12,11,10,9,8,7,6,5,4,3,2,1,0, 15,14,13,12,11,10,9,8,7,6,5,4,3,2,1,0) :
+		_mm256_setr_epi8(14,15,12,13,10,11,8,9,6,7,4,5,2,3,0,1, 14,15,12,13,10,11,8,9,6,7,4,5,2,3,0,1);
+	return _mm256_permute4x64_epi64(_mm256_shuffle_epi8(v, mask), _MM_SHUFFLE(1,0,3,2));
+}
+
+HOGBOX_TARGET_AVX2 static unsigned int FlipRowAVX2(unsigned char* row, unsigned int width, unsigned int pixelBytes)
+{
+	unsigned int left = 0;
+	unsigned int right = width;
+	if(pixelBytes == 3)
+	{
+		//5 pixels per 16 byte load, the spare byte (after the left block, before the
+		//right block) is written back unchanged. Needs a pixel gap between blocks
+		const __m128i leftMask = _mm_setr_epi8(13,14,15, 10,11,12, 7,8,9, 4,5,6, 1,2,3, (char)0x80);
+		const __m128i rightMask = _mm_setr_epi8((char)0x80, 12,13,14, 9,10,11, 6,7,8, 3,4,5, 0,1,2);
+		const __m128i keepLast = _mm_setr_epi8(0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,(char)0xFF);
+		const __m128i keepFirst = _mm_setr_epi8((char)0xFF,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0);
+		while(right-left >= 11)
+		{
+			unsigned char* l = row + left*3;
+			unsigned char* r = row + (right-5)*3 - 1;
+			__m128i a = _mm_loadu_si128((const __m128i*)l);
+			__m128i b = _mm_loadu_si128((const __m128i*)r);
+			_mm_storeu_si128((__m128i*)l, _mm_or_si128(_mm_shuffle_epi8(b, leftMask), _mm_and_si128(a, keepLast)));
+			_mm_storeu_si128((__m128i*)r, _mm_or_si128(_mm_shuffle_epi8(a, rightMask), _mm_and_si128(b, keepFirst)));
+			left += 5;
+			right -= 5;
+		}
+		return left;
+	}
+
+	unsigned int block = 32/pixelBytes;
+	while(right-left >= block*2)
+	{
+		unsigned char* l = row + left*pixelBytes;
+		unsigned char* r = row + (right-block)*pixelBytes;
+		__m256i a = _mm256_loadu_si256((const __m256i*)l);
+		__m256i b = _mm256_loadu_si256((const __m256i*)r);
+		_mm256_storeu_si256((__m256i*)l, ReversePixelsAVX2(b, pixelBytes));
+		_mm256_storeu_si256((__m256i*)r, ReversePixelsAVX2(a, pixelBytes));
+		left += block;
+		right -= block;
+	}
+	return left;
+}
+
+HOGBOX_TARGET_AVX2 static unsigned int AverageRowsAVX2(unsigned char* dst, const unsigned char* a, const unsigned char* b, unsigned int count)
+{
+	unsigned int i = 0;
+	for( ; i+32<=count; i+=32){
+		__m256i va = _mm256_loadu_si256((const __m256i*)(a+i));
+		__m256i vb = _mm256_loadu_si256((const __m256i*)(b+i));
+		_mm256_storeu_si256((__m256i*)(dst+i), _mm256_avg_epu8(va, vb));
+	}
+	return i;
+}
+
+HOGBOX_TARGET_AVX2 static unsigned int SwapRedBlueRowAVX2(unsigned char* row, unsigned int width, unsigned int pixelBytes)
+{
+	unsigned int x = 0;
+	if(pixelBytes == 4)
+	{
+		const __m256i mask = _mm256_setr_epi8(2,1,0,3, 6,5,4,7, 10,9,8,11, 14,13,12,15, 2,1,0,3, 6,5,4,7, 10,9,8,11, 14,13,12,15);
+		for( ; x+8<=width; x+=8){
+			__m256i v = _mm256_loadu_si256((const __m256i*)(row+x*4));
+			_mm256_storeu_si256((__m256i*)(row+x*4), _mm256_shuffle_epi8(v, mask));
+		}
+	}
+	else if(pixelBytes == 3)
+	{
+		//5 pixels per 16 bytes, the last byte belongs to the next pixel and is kept
+		const __m128i mask = _mm_setr_epi8(2,1,0, 5,4,3, 8,7,6, 11,10,9, 14,13,12, 15);
+		for( ; x+6<=width; x+=5){
+			__m128i v = _mm_loadu_si128((const __m128i*)(row+x*3));
+			_mm_storeu_si128((__m128i*)(row+x*3), _mm_shuffle_epi8(v, mask));
+		}
+	}
+	return x;
+}
+
+HOGBOX_TARGET_AVX2 static inline void SplitChromaAVX2(__m256i uv, __m256i& u, __m256i& v)
+{
+	__m256i u32 = _mm256_and_si256(uv, _mm256_set1_epi32(0xFFFF));
+	__m256i v32 = _mm256_srli_epi32(uv, 16);
+	u = _mm256_or_si256(u32, _mm256_slli_epi32(u32, 16));
+	v = _mm256_or_si256(v32, _mm256_slli_epi32(v32, 16));
+}
+
+//
+//Convert 16 pixels of 16 bit y, u, v to two registers of RGBA (pixels 0-7, 8-15)
+//
+HOGBOX_TARGET_AVX2 static inline void YUVToRGBAAVX2(__m256i y, __m256i u, __m256i v, __m256i& rgbaLo, __m256i& rgbaHi)
+{
+	const __m256i kY = _mm256_set1_epi32((128<<16) | 298);
+	const __m256i kR = _mm256_set1_epi32(409<<16);
+	const __m256i kG = _mm256_set1_epi32((int)(((unsigned int)(-208)<<16) | ((unsigned int)(-100) & 0xFFFF)));
+	const __m256i kB = _mm256_set1_epi32(516);
+
+	__m256i c = _mm256_sub_epi16(y, _mm256_set1_epi16(16));
+	__m256i d = _mm256_sub_epi16(u, _mm256_set1_epi16(128));
+	__m256i e = _mm256_sub_epi16(v, _mm256_set1_epi16(128));
+
+	//the unpacks and packs both work within lanes so pixel order is kept
+	__m256i one = _mm256_set1_epi16(1);
+	__m256i yLo = _mm256_madd_epi16(_mm256_unpacklo_epi16(c, one), kY);
+	__m256i yHi = _mm256_madd_epi16(_mm256_unpackhi_epi16(c, one), kY);
+	__m256i deLo = _mm256_unpacklo_epi16(d, e);
+	__m256i deHi = _mm256_unpackhi_epi16(d, e);
+
+	__m256i r = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_add_epi32(yLo, _mm256_madd_epi16(deLo, kR)), 8),
+									_mm256_srai_epi32(_mm256_add_epi32(yHi, _mm256_madd_epi16(deHi, kR)), 8));
+	__m256i g = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_add_epi32(yLo, _mm256_madd_epi16(deLo, kG)), 8),
+									_mm256_srai_epi32(_mm256_add_epi32(yHi, _mm256_madd_epi16(deHi, kG)), 8));
+	__m256i b = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_add_epi32(yLo, _mm256_madd_epi16(deLo, kB)), 8),
+									_mm256_srai_epi32(_mm256_add_epi32(yHi, _mm256_madd_epi16(deHi, kB)), 8));
+
+	__m256i rg = _mm256_unpacklo_epi8(_mm256_packus_epi16(r, r), _mm256_packus_epi16(g, g));
+	__m256i ba = _mm256_unpacklo_epi8(_mm256_packus_epi16(b, b), _mm256_set1_epi8((char)0xFF));
+	__m256i lo = _mm256_unpacklo_epi16(rg, ba);
+	__m256i hi = _mm256_unpackhi_epi16(rg, ba);
+	rgbaLo = _mm256_permute2x128_si256(lo, hi, 0x20);
+	rgbaHi = _mm256_permute2x128_si256(lo, hi, 0x31);
+}
+
+HOGBOX_TARGET_AVX2 static unsigned int ConvertYUVRowAVX2(ImageKernels::YUVFormat format, const unsigned char* yRow, const unsigned char* uRow, const unsigned char* vRow,
+														unsigned char* dst, unsigned int width, unsigned int dstPixelBytes)
+{
+	const __m256i lowBytes = _mm256_set1_epi16(0xFF);
+	const __m256i dropAlpha = _mm256_setr_epi8(0,1,2, 4,5,6, 8,9,10, 12,13,14, -1,-1,-1,-1, 0,1,2, 4,5,6, 8,9,10, 12,13,14, -1,-1,-1,-1);
+	//rgb stores write 4 spare bytes past each 12, stop while there is room for them
+	unsigned int end = dstPixelBytes == 4 ? width : (width >= 2 ? width-2 : 0);
+	unsigned int x = 0;
+	for( ; x+16<=end; x+=16)
+	{
+		__m256i y, u, v;
+		switch(format)
+		{
+			case ImageKernels::YUY2:
+			case ImageKernels::UYVY:
+			{
+				__m256i packed = _mm256_loadu_si256((const __m256i*)(yRow+x*2));
+				bool yFirst = format == ImageKernels::YUY2;
+				y = yFirst ? _mm256_and_si256(packed, lowBytes) : _mm256_srli_epi16(packed, 8);
+				SplitChromaAVX2(yFirst ? _mm256_srli_epi16(packed, 8) : _mm256_and_si256(packed, lowBytes), u, v);
+				break;
+			}
+			case ImageKernels::NV12:
+			{
+				y = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(yRow+x)));
+				SplitChromaAVX2(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(uRow+x))), u, v);
+				break;
+			}
+			default:
+			{
+				y = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(yRow+x)));
+				__m256i u32 = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(uRow+x/2)));
+				__m256i v32 = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(vRow+x/2)));
+				u = _mm256_or_si256(u32, _mm256_slli_epi32(u32, 16));
+				v = _mm256_or_si256(v32, _mm256_slli_epi32(v32, 16));
+				break;
+			}
+		}
+
+		__m256i lo, hi;
+		YUVToRGBAAVX2(y, u, v, lo, hi);
+		if(dstPixelBytes == 4){
+			_mm256_storeu_si256((__m256i*)(dst+x*4), lo);
+			_mm256_storeu_si256((__m256i*)(dst+x*4+32), hi);
+		}else{
+			lo = _mm256_shuffle_epi8(lo, dropAlpha);
+			hi = _mm256_shuffle_epi8(hi, dropAlpha);
+			unsigned char* out = dst+x*3;
+			_mm_storeu_si128((__m128i*)out, _mm256_castsi256_si128(lo));
+			_mm_storeu_si128((__m128i*)(out+12), _mm256_extracti128_si256(lo, 1));
+			_mm_storeu_si128((__m128i*)(out+24), _mm256_castsi256_si128(hi));
+			_mm_storeu_si128((__m128i*)(out+36), _mm256_extracti128_si256(hi, 1));
+		}
+	}
+	return x;
+}
+
+HOGBOX_TARGET_AVX2 static unsigned int DownscaleRowAVX2(const unsigned char* row0, const unsigned char* row1, unsigned char* dst,
+														unsigned int dstWidth, unsigned int pixelBytes)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i two = _mm256_set1_epi16(2);
+	unsigned int x = 0;
+	if(pixelBytes == 4)
+	{
+		//8 pixels in, 4 out
+		for( ; x+4<=dstWidth; x+=4){
+			__m256i a = _mm256_loadu_si256((const __m256i*)(row0+x*8));
+			__m256i b = _mm256_loadu_si256((const __m256i*)(row1+x*8));
+			__m256i lo = _mm256_add_epi16(_mm256_unpacklo_epi8(a, zero), _mm256_unpacklo_epi8(b, zero));
+			__m256i hi = _mm256_add_epi16(_mm256_unpackhi_epi8(a, zero), _mm256_unpackhi_epi8(b, zero));
+			__m256i sum = _mm256_add_epi16(_mm256_unpacklo_epi64(lo, hi), _mm256_unpackhi_epi64(lo, hi));
+			sum = _mm256_srli_epi16(_mm256_add_epi16(sum, two), 2);
+			sum = _mm256_permute4x64_epi64(_mm256_packus_epi16(sum, sum), _MM_SHUFFLE(3,1,2,0));
+			_mm_storeu_si128((__m128i*)(dst+x*4), _mm256_castsi256_si128(sum));
+		}
+	}
+	else if(pixelBytes == 1)
+	{
+		//32 pixels in, 16 out
+		const __m256i one = _mm256_set1_epi16(1);
+		for( ; x+16<=dstWidth; x+=16){
+			__m256i a = _mm256_loadu_si256((const __m256i*)(row0+x*2));
+			__m256i b = _mm256_loadu_si256((const __m256i*)(row1+x*2));
+			__m256i lo = _mm256_add_epi16(_mm256_unpacklo_epi8(a, zero), _mm256_unpacklo_epi8(b, zero));
+			__m256i hi = _mm256_add_epi16(_mm256_unpackhi_epi8(a, zero), _mm256_unpackhi_epi8(b, zero));
+			__m256i sum = _mm256_packs_epi32(_mm256_madd_epi16(lo, one), _mm256_madd_epi16(hi, one));
+			sum = _mm256_srli_epi16(_mm256_add_epi16(sum, two), 2);
+			sum = _mm256_permute4x64_epi64(_mm256_packus_epi16(sum, sum), _MM_SHUFFLE(3,1,2,0));
+			_mm_storeu_si128((__m128i*)(dst+x), _mm256_castsi256_si128(sum));
+		}
+	}
+	return x;
+}
+
+HOGBOX_TARGET_AVX2 static unsigned int AccumulateRowAVX2(unsigned int* sums, const unsigned char* row, unsigned int width, bool subtract)
+{
+	unsigned int x = 0;
+	for( ; x+8<=width; x+=8){
+		__m256i v = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(row+x)));
+		__m256i* sum = (__m256i*)(sums+x);
+		__m256i s = _mm256_loadu_si256(sum);
+		s = subtract ? _mm256_sub_epi32(s, v) : _mm256_add_epi32(s, v);
+		_mm256_storeu_si256(sum, s);
+	}
+	return x;
+}
+
+HOGBOX_TARGET_AVX2 static unsigned int ThresholdRowAVX2(const unsigned char* src, const unsigned char* mean, unsigned char* dst,
+														unsigned int width, unsigned char offset)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i ones = _mm256_set1_epi8((char)-1);
+	const __m256i off = _mm256_set1_epi8((char)offset);
+	unsigned int x = 0;
+	for( ; x+32<=width; x+=32){
+		__m256i s = _mm256_loadu_si256((const __m256i*)(src+x));
+		__m256i m = _mm256_loadu_si256((const __m256i*)(mean+x));
+		__m256i d = _mm256_subs_epu8(m, _mm256_adds_epu8(s, off));
+		_mm256_storeu_si256((__m256i*)(dst+x), _mm256_xor_si256(_mm256_cmpeq_epi8(d, zero), ones));
+	}
+	return x;
+}
+
+//
+//1 byte pixels, gathering each pixel pair as a 32 bit load. The bottom pair is
+//loaded ending at the pair so the gather can't read past the end of the image
+//
+HOGBOX_TARGET_AVX2 static unsigned int RemapRowAVX2(const unsigned char* src, unsigned int srcStride, const unsigned short* coords,
+													const unsigned char* fractions, unsigned char* dst, unsigned int width)
+{
+	const __m256i low = _mm256_set1_epi32(0xFFFF);
+	const __m256i lowByte = _mm256_set1_epi32(0xFF);
+	const __m256i secondByte = _mm256_set1_epi32(0xFF00);
+	const __m256i stride = _mm256_set1_epi32((int)srcStride);
+	const __m256i full = _mm256_set1_epi32(128);
+	const __m256i round = _mm256_set1_epi32(8192);
+	unsigned int x = 0;
+	for( ; x+8<=width; x+=8)
+	{
+		__m256i c = _mm256_loadu_si256((const __m256i*)(coords+x*2));
+		__m256i offset = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_srli_epi32(c, 16), stride), _mm256_and_si256(c, low));
+		__m256i t = _mm256_i32gather_epi32((const int*)src, offset, 1);
+		__m256i b = _mm256_srli_epi32(_mm256_i32gather_epi32((const int*)(src+srcStride-2), offset, 1), 16);
+		//(p0 | p1<<8) to 16 bit pairs
+		t = _mm256_or_si256(_mm256_and_si256(t, lowByte), _mm256_slli_epi32(_mm256_and_si256(t, secondByte), 8));
+		b = _mm256_or_si256(_mm256_and_si256(b, lowByte), _mm256_slli_epi32(_mm256_and_si256(b, secondByte), 8));
+
+		__m256i f = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(fractions+x*2)));
+		__m256i fx = _mm256_and_si256(f, low);
+		__m256i fy = _mm256_srli_epi32(f, 16);
+		__m256i wx = _mm256_or_si256(_mm256_sub_epi32(full, fx), _mm256_slli_epi32(fx, 16));
+		__m256i wy = _mm256_or_si256(_mm256_sub_epi32(full, fy), _mm256_slli_epi32(fy, 16));
+		__m256i rows = _mm256_or_si256(_mm256_madd_epi16(t, wx), _mm256_slli_epi32(_mm256_madd_epi16(b, wx), 16));
+		__m256i sum = _mm256_srli_epi32(_mm256_add_epi32(_mm256_madd_epi16(rows, wy), round), 14);
+
+		//packs work within each 128 bit lane, leaving pixels 0-3 and 4-7 at the bottom of each
+		sum = _mm256_packs_epi32(sum, sum);
+		sum = _mm256_packus_epi16(sum, sum);
+		int lo = _mm_cvtsi128_si32(_mm256_castsi256_si128(sum));
+		int hi = _mm_cvtsi128_si32(_mm256_extracti128_si256(sum, 1));
+		memcpy(dst+x, &lo, 4);
+		memcpy(dst+x+4, &hi, 4);
+	}
+	return x;
+}
+#endif //HOGBOX_KERNELS_AVX2
+
+
+#ifdef HOGBOX_KERNELS_NEON
+//
+//NEON kernels, the structured loads/stores do the (de)interleaving
+//
+
+static unsigned int SwapRowsNEON(unsigned char* a, unsigned char* b, unsigned int count)
+{
+	unsigned int i = 0;
+	for( ; i+16<=count; i+=16){
+		uint8x16_t va = vld1q_u8(a+i);
+		uint8x16_t vb = vld1q_u8(b+i);
+		vst1q_u8(a+i, vb);
+		vst1q_u8(b+i, va);
+	}
+	return i;
+}
+
+static inline uint8x16_t ReversePixelsNEON(uint8x16_t v, unsigned int pixelBytes)
+{
+	if(pixelBytes == 1){
+		v = vrev64q_u8(v);
+	}else if(pixelBytes == 2){
+		v = vreinterpretq_u8_u16(vrev64q_u16(vreinterpretq_u16_u8(v)));
+	}else{
+		v = vreinterpretq_u8_u32(vrev64q_u32(vreinterpretq_u32_u8(v)));
+	}
+	return vcombine_u8(vget_high_u8(v), vget_low_u8(v));
+}
+
+static unsigned int FlipRowNEON(unsigned char* row, unsigned int width, unsigned int pixelBytes)
+{
+	unsigned int left = 0;
+	unsigned int right = width;
+	if(pixelBytes == 3)
+	{
+		//8 pixels split into channels
+		while(right-left >= 16)
+		{
+			unsigned char* l = row + left*3;
+			unsigned char* r = row + (right-8)*3;
+			uint8x8x3_t a = vld3_u8(l);
+			uint8x8x3_t b = vld3_u8(r);
+			for(unsigned int c=0; c<3; c++){
+				uint8x8_t temp = vrev64_u8(a.val[c]);
+				a.val[c] = vrev64_u8(b.val[c]);
+				b.val[c] = temp;
+			}
+			vst3_u8(l, a);
+			vst3_u8(r, b);
+			left += 8;
+			right -= 8;
+		}
+		return left;
+	}
+
+	unsigned int block = 16/pixelBytes;
+	while(right-left >= block*2)
+	{
+		unsigned char* l = row + left*pixelBytes;
+		unsigned char* r = row + (right-block)*pixelBytes;
+		uint8x16_t a = vld1q_u8(l);
+		uint8x16_t b = vld1q_u8(r);
+		vst1q_u8(l, ReversePixelsNEON(b, pixelBytes));
+		vst1q_u8(r, ReversePixelsNEON(a, pixelBytes));
+		left += block;
+		right -= block;
+	}
+	return left;
+}
+
+static unsigned int AverageRowsNEON(unsigned char* dst, const unsigned char* a, const unsigned char* b, unsigned int count)
+{
+	unsigned int i = 0;
+	for( ; i+16<=count; i+=16){
+		vst1q_u8(dst+i, vrhaddq_u8(vld1q_u8(a+i), vld1q_u8(b+i)));
+	}
+	return i;
+}
+
+static unsigned int SwapRedBlueRowNEON(unsigned char* row, unsigned int width, unsigned int pixelBytes)
+{
+	unsigned int x = 0;
+	if(pixelBytes == 4){
+		for( ; x+16<=width; x+=16){
+			uint8x16x4_t v = vld4q_u8(row+x*4);
+			uint8x16_t temp = v.val[0]; v.val[0] = v.val[2]; v.val[2] = temp;
+			vst4q_u8(row+x*4, v);
+		}
+	}else if(pixelBytes == 3){
+		for( ; x+16<=width; x+=16){
+			uint8x16x3_t v = vld3q_u8(row+x*3);
+			uint8x16_t temp = v.val[0]; v.val[0] = v.val[2]; v.val[2] = temp;
+			vst3q_u8(row+x*3, v);
+		}
+	}
+	return x;
+}
+
+//
+//Convert 8 pixels sharing the chroma values d, e (already minus 128)
+//
+static inline void YUVToRGBNEON(uint8x8_t y, int16x8_t d, int16x8_t e, uint8x8_t& r, uint8x8_t& g, uint8x8_t& b)
+{
+	int16x8_t c = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(y)), vdupq_n_s16(16));
+	int32x4_t yLo = vaddq_s32(vmull_n_s16(vget_low_s16(c), 298), vdupq_n_s32(128));
+	int32x4_t yHi = vaddq_s32(vmull_n_s16(vget_high_s16(c), 298), vdupq_n_s32(128));
+
+	int32x4_t rLo = vmlal_n_s16(yLo, vget_low_s16(e), 409);
+	int32x4_t rHi = vmlal_n_s16(yHi, vget_high_s16(e), 409);
+	int32x4_t gLo = vmlsl_n_s16(vmlsl_n_s16(yLo, vget_low_s16(d), 100), vget_low_s16(e), 208);
+	int32x4_t gHi = vmlsl_n_s16(vmlsl_n_s16(yHi, vget_high_s16(d), 100), vget_high_s16(e), 208);
+	int32x4_t bLo = vmlal_n_s16(yLo, vget_low_s16(d), 516);
+	int32x4_t bHi = vmlal_n_s16(yHi, vget_high_s16(d), 516);
+
+	r = vqmovun_s16(vcombine_s16(vqmovn_s32(vshrq_n_s32(rLo, 8)), vqmovn_s32(vshrq_n_s32(rHi, 8))));
+	g = vqmovun_s16(vcombine_s16(vqmovn_s32(vshrq_n_s32(gLo, 8)), vqmovn_s32(vshrq_n_s32(gHi, 8))));
+	b = vqmovun_s16(vcombine_s16(vqmovn_s32(vshrq_n_s32(bLo, 8)), vqmovn_s32(vshrq_n_s32(bHi, 8))));
+}
+
+static unsigned int ConvertYUVRowNEON(ImageKernels::YUVFormat format, const unsigned char* yRow, const unsigned char* uRow, const unsigned char* vRow,
+									unsigned char* dst, unsigned int width, unsigned int dstPixelBytes)
+{
+	const int16x8_t bias = vdupq_n_s16(128);
+	unsigned int x = 0;
+	for( ; x+16<=width; x+=16)
+	{
+		//even and odd pixels share each chroma sample
+		uint8x8_t yEven, yOdd, u, v;
+		switch(format)
+		{
+			case ImageKernels::YUY2:{
+				uint8x8x4_t packed = vld4_u8(yRow+x*2);
+				yEven = packed.val[0]; u = packed.val[1]; yOdd = packed.val[2]; v = packed.val[3];
+				break;
+			}
+			case ImageKernels::UYVY:{
+				uint8x8x4_t packed = vld4_u8(yRow+x*2);
+				u = packed.val[0]; yEven = packed.val[1]; v = packed.val[2]; yOdd = packed.val[3];
+				break;
+			}
+			case ImageKernels::NV12:{
+				uint8x8x2_t luma = vld2_u8(yRow+x);
+				uint8x8x2_t chroma = vld2_u8(uRow+x);
+				yEven = luma.val[0]; yOdd = luma.val[1]; u = chroma.val[0]; v = chroma.val[1];
+				break;
+			}
+			default:{
+				uint8x8x2_t luma = vld2_u8(yRow+x);
+				yEven = luma.val[0]; yOdd = luma.val[1]; u = vld1_u8(uRow+x/2); v = vld1_u8(vRow+x/2);
+				break;
+			}
+		}
+		int16x8_t d = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(u)), bias);
+		int16x8_t e = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(v)), bias);
+
+		uint8x8_t rEven, gEven, bEven, rOdd, gOdd, bOdd;
+		YUVToRGBNEON(yEven, d, e, rEven, gEven, bEven);
+		YUVToRGBNEON(yOdd, d, e, rOdd, gOdd, bOdd);
+		uint8x8x2_t r = vzip_u8(rEven, rOdd);
+		uint8x8x2_t g = vzip_u8(gEven, gOdd);
+		uint8x8x2_t b = vzip_u8(bEven, bOdd);
+
+		if(dstPixelBytes == 4){
+			uint8x16x4_t out;
+			out.val[0] = vcombine_u8(r.val[0], r.val[1]);
+			out.val[1] = vcombine_u8(g.val[0], g.val[1]);
+			out.val[2] = vcombine_u8(b.val[0], b.val[1]);
+			out.val[3] = vdupq_n_u8(255);
+			vst4q_u8(dst+x*4, out);
+		}else{
+			uint8x16x3_t out;
+			out.val[0] = vcombine_u8(r.val[0], r.val[1]);
+			out.val[1] = vcombine_u8(g.val[0], g.val[1]);
+			out.val[2] = vcombine_u8(b.val[0], b.val[1]);
+			vst3q_u8(dst+x*3, out);
+		}
+	}
+	return x;
+}
+
+static unsigned int DownscaleRowNEON(const unsigned char* row0, const unsigned char* row1, unsigned char* dst,
+									unsigned int dstWidth, unsigned int pixelBytes)
+{
+	//16 pixels in, 8 out, pairwise adds with a rounding narrow
+	unsigned int x = 0;
+	for( ; x+8<=dstWidth; x+=8)
+	{
+		const unsigned char* a = row0 + x*2*pixelBytes;
+		const unsigned char* b = row1 + x*2*pixelBytes;
+		unsigned char* out = dst + x*pixelBytes;
+		if(pixelBytes == 1){
+			vst1_u8(out, vrshrn_n_u16(vpadalq_u8(vpaddlq_u8(vld1q_u8(a)), vld1q_u8(b)), 2));
+		}else if(pixelBytes == 3){
+			uint8x16x3_t va = vld3q_u8(a);
+			uint8x16x3_t vb = vld3q_u8(b);
+			uint8x8x3_t result;
+			for(unsigned int c=0; c<3; c++){
+				result.val[c] = vrshrn_n_u16(vpadalq_u8(vpaddlq_u8(va.val[c]), vb.val[c]), 2);
+			}
+			vst3_u8(out, result);
+		}else if(pixelBytes == 4){
+			uint8x16x4_t va = vld4q_u8(a);
+			uint8x16x4_t vb = vld4q_u8(b);
+			uint8x8x4_t result;
+			for(unsigned int c=0; c<4; c++){
+				result.val[c] = vrshrn_n_u16(vpadalq_u8(vpaddlq_u8(va.val[c]), vb.val[c]), 2);
+			}
+			vst4_u8(out, result);
+		}else{
+			break;
+		}
+	}
+	return x;
+}
+
+static unsigned int LuminanceRowNEON(const unsigned char* src, unsigned char* dst, unsigned int width, unsigned int pixelBytes, bool bgr)
+{
+	//the rounding narrow adds the 128
+	unsigned int x = 0;
+	for( ; x+8<=width; x+=8)
+	{
+		uint8x8_t r, g, b;
+		if(pixelBytes == 3){
+			uint8x8x3_t v = vld3_u8(src+x*3);
+			r = v.val[bgr ? 2 : 0]; g = v.val[1]; b = v.val[bgr ? 0 : 2];
+		}else if(pixelBytes == 4){
+			uint8x8x4_t v = vld4_u8(src+x*4);
+			r = v.val[bgr ? 2 : 0]; g = v.val[1]; b = v.val[bgr ? 0 : 2];
+		}else{
+			break;
+		}
+		uint16x8_t sum = vmull_u8(r, vdup_n_u8(77));
+		sum = vmlal_u8(sum, g, vdup_n_u8(150));
+		sum = vmlal_u8(sum, b, vdup_n_u8(29));
+		vst1_u8(dst+x, vrshrn_n_u16(sum, 8));
+	}
+	return x;
+}
+
+static unsigned int AccumulateRowNEON(unsigned int* sums, const unsigned char* row, unsigned int width, bool subtract)
+{
+	unsigned int x = 0;
+	for( ; x+8<=width; x+=8){
+		uint16x8_t v = vmovl_u8(vld1_u8(row+x));
+		uint32x4_t lo = vmovl_u16(vget_low_u16(v));
+		uint32x4_t hi = vmovl_u16(vget_high_u16(v));
+		if(subtract){
+			vst1q_u32(sums+x, vsubq_u32(vld1q_u32(sums+x), lo));
+			vst1q_u32(sums+x+4, vsubq_u32(vld1q_u32(sums+x+4), hi));
+		}else{
+			vst1q_u32(sums+x, vaddq_u32(vld1q_u32(sums+x), lo));
+			vst1q_u32(sums+x+4, vaddq_u32(vld1q_u32(sums+x+4), hi));
+		}
+	}
+	return x;
+}
+
+static unsigned int ThresholdRowNEON(const unsigned char* src, const unsigned char* mean, unsigned char* dst,
+									unsigned int width, unsigned char offset)
+{
+	const uint8x16_t off = vdupq_n_u8(offset);
+	unsigned int x = 0;
+	for( ; x+16<=width; x+=16){
+		vst1q_u8(dst+x, vcgtq_u8(vld1q_u8(mean+x), vqaddq_u8(vld1q_u8(src+x), off)));
+	}
+	return x;
+}
+
+//
+//1 byte pixels 8 at a time, 4 byte pixels one at a time. The rounding narrow adds the 8192
+//
+static unsigned int RemapRowNEON(const unsigned char* src, unsigned int srcStride, unsigned int pixelBytes, const unsigned short* coords,
+								const unsigned char* fractions, unsigned char* dst, unsigned int width)
+{
+	const uint8x8_t full = vdup_n_u8(128);
+	unsigned int x = 0;
+	if(pixelBytes == 1)
+	{
+		unsigned char top[16];
+		unsigned char bottom[16];
+		for( ; x+8<=width; x+=8)
+		{
+			for(unsigned int i=0; i<8; i++){
+				const unsigned char* p = src + coords[(x+i)*2+1]*srcStride + coords[(x+i)*2];
+				memcpy(top+i*2, p, 2);
+				memcpy(bottom+i*2, p+srcStride, 2);
+			}
+			uint8x8x2_t t = vld2_u8(top);
+			uint8x8x2_t b = vld2_u8(bottom);
+			uint8x8x2_t f = vld2_u8(fractions+x*2);
+			uint8x8_t fx = f.val[0];
+			uint8x8_t ifx = vsub_u8(full, fx);
+			uint16x8_t rowTop = vmlal_u8(vmull_u8(t.val[0], ifx), t.val[1], fx);
+			uint16x8_t rowBottom = vmlal_u8(vmull_u8(b.val[0], ifx), b.val[1], fx);
+			uint16x8_t fy = vmovl_u8(f.val[1]);
+			uint16x8_t ify = vmovl_u8(vsub_u8(full, f.val[1]));
+			uint32x4_t lo = vmlal_u16(vmull_u16(vget_low_u16(rowTop), vget_low_u16(ify)), vget_low_u16(rowBottom), vget_low_u16(fy));
+			uint32x4_t hi = vmlal_u16(vmull_u16(vget_high_u16(rowTop), vget_high_u16(ify)), vget_high_u16(rowBottom), vget_high_u16(fy));
+			vst1_u8(dst+x, vmovn_u16(vcombine_u16(vrshrn_n_u32(lo, 14), vrshrn_n_u32(hi, 14))));
+		}
+	}
+	else if(pixelBytes == 4)
+	{
+		for( ; x<width; x++)
+		{
+			const unsigned char* p = src + coords[x*2+1]*srcStride + coords[x*2]*4;
+			uint8x8_t t = vld1_u8(p);
+			uint8x8_t b = vld1_u8(p+srcStride);
+			uint8x8_t fx = vdup_n_u8(fractions[x*2]);
+			uint8x8_t ifx = vsub_u8(full, fx);
+			//the second pixel of each row moved down over the first
+			uint16x8_t rowTop = vmlal_u8(vmull_u8(t, ifx), vext_u8(t, t, 4), fx);
+			uint16x8_t rowBottom = vmlal_u8(vmull_u8(b, ifx), vext_u8(b, b, 4), fx);
+			uint32x4_t sum = vmlal_u16(vmull_u16(vget_low_u16(rowTop), vdup_n_u16(128-fractions[x*2+1])),
+										vget_low_u16(rowBottom), vdup_n_u16(fractions[x*2+1]));
+			uint16x4_t narrow = vrshrn_n_u32(sum, 14);
+			uint32_t out = vget_lane_u32(vreinterpret_u32_u8(vmovn_u16(vcombine_u16(narrow, narrow))), 0);
+			memcpy(dst+x*4, &out, 4);
+		}
+	}
+	return x;
+}
+#endif //HOGBOX_KERNELS_NEON
+
+
+//
+//RemapTable
+//
+
+RemapTable::RemapTable()
+	: osg::Referenced(),
+	_width(0),
+	_height(0),
+	_srcWidth(0),
+	_srcHeight(0)
+{
+}
+
+bool RemapTable::Allocate(unsigned int width, unsigned int height, unsigned int srcWidth, unsigned int srcHeight)
+{
+	if(srcWidth < 2 || srcHeight < 2 || srcWidth > 65536 || srcHeight > 65536){
+		osg::notify(osg::WARN) << "RemapTable::Allocate: ERROR: Source size " << srcWidth << "x" << srcHeight << " must be 2 to 65536 on a side." << std::endl;
+		return false;
+	}
+	_width = width;
+	_height = height;
+	_srcWidth = srcWidth;
+	_srcHeight = srcHeight;
+	_coords.assign(width*height*2, 0);
+	_fractions.assign(width*height*2, 0);
+	return true;
+}
+
+//
+//Split a clamped source position into the top left of its 2x2 block and the fraction across it
+//
+static void SplitRemapPosition(double position, unsigned int size, unsigned short& coord, unsigned char& fraction)
+{
+	if(position < 0.0){position = 0.0;}
+	if(position > size-1){position = size-1;}
+	unsigned int fixed = (unsigned int)(position * 128.0 + 0.5);
+	unsigned int whole = fixed >> 7;
+	unsigned int part = fixed & 127;
+	//the last pixel is the right of the last block
+	if(whole > size-2){
+		whole = size-2;
+		part = 128;
+	}
+	coord = (unsigned short)whole;
+	fraction = (unsigned char)part;
+}
+
+void RemapTable::Set(unsigned int x, unsigned int y, double srcX, double srcY)
+{
+	unsigned int index = (y*_width+x)*2;
+	SplitRemapPosition(srcX, _srcWidth, _coords[index], _fractions[index]);
+	SplitRemapPosition(srcY, _srcHeight, _coords[index+1], _fractions[index+1]);
+}
+
+
+//
+//ImageKernels
+//
+
+ImageKernels::InstructionSet ImageKernels::GetBestInstructionSet()
+{
+#if defined(HOGBOX_KERNELS_NEON)
+	return NEON;
+#else
+	#if defined(HOGBOX_KERNELS_AVX2)
+	static const bool hasAVX2 = CpuHasAVX2();
+	if(hasAVX2){return AVX2;}
+	#endif
+	#if defined(HOGBOX_KERNELS_SSE2)
+	return SSE2;
+	#else
+	return SCALAR;
+	#endif
+#endif
+}
+
+void ImageKernels::SetInstructionSet(const InstructionSet& set)
+{
+	InstructionSet best = GetBestInstructionSet();
+	//NEON and the x86 sets don't mix
+	if(set == SCALAR){
+		s_instructionSet = SCALAR;
+	}else if(best == NEON || set == NEON){
+		s_instructionSet = best;
+	}else{
+		s_instructionSet = set > best ? best : set;
+	}
+}
+
+ImageKernels::InstructionSet ImageKernels::GetInstructionSet()
+{
+	if(s_instructionSet < 0){return GetBestInstructionSet();}
+	return (InstructionSet)s_instructionSet;
+}
+
+const char* ImageKernels::GetInstructionSetName(const InstructionSet& set)
+{
+	switch(set){
+		case SSE2: return "sse2";
+		case AVX2: return "avx2";
+		case NEON: return "neon";
+		default: break;
+	}
+	return "scalar";
+}
+
+//
+//Mirror the rows top to bottom
+//
+void ImageKernels::FlipVertical(unsigned char* data, unsigned int rowBytes, unsigned int height, unsigned int stride)
+{
+	InstructionSet set = GetInstructionSet();
+	for(unsigned int r=0; r<height/2; r++)
+	{
+		unsigned char* top = data + r*stride;
+		unsigned char* bottom = data + (height-1-r)*stride;
+		unsigned int done = 0;
+#ifdef HOGBOX_KERNELS_AVX2
+		if(set == AVX2){done = SwapRowsAVX2(top, bottom, rowBytes);}
+#endif
+#ifdef HOGBOX_KERNELS_SSE2
+		if(set == SSE2){done = SwapRowsSSE2(top, bottom, rowBytes);}
+#endif
+#ifdef HOGBOX_KERNELS_NEON
+		if(set == NEON){done = SwapRowsNEON(top, bottom, rowBytes);}
+#endif
+		SwapRowsScalar(top+done, bottom+done, rowBytes-done);
+	}
+}
+
+//
+//Mirror each row left to right
+//
+void ImageKernels::FlipHorizontal(unsigned char* data, unsigned int width, unsigned int height, unsigned int pixelBytes, unsigned int stride)
+{
+	if(pixelBytes == 0 || pixelBytes > 4){return;}
+	InstructionSet set = GetInstructionSet();
+	for(unsigned int r=0; r<height; r++)
+	{
+		unsigned char* row = data + r*stride;
+		unsigned int done = 0;
+#ifdef HOGBOX_KERNELS_AVX2
+		if(set == AVX2){done = FlipRowAVX2(row, width, pixelBytes);}
+#endif
+#ifdef HOGBOX_KERNELS_SSE2
+		if(set == SSE2){done = FlipRowSSE2(row, width, pixelBytes);}
+#endif
+#ifdef HOGBOX_KERNELS_NEON
+		if(set == NEON){done = FlipRowNEON(row, width, pixelBytes);}
+#endif
+		FlipRowScalar(row, width, pixelBytes, done);
+	}
+}
+
+//
+//dst = (a+b+1)/2 for count bytes
+//
+static void AverageRows(ImageKernels::InstructionSet set, unsigned char* dst, const unsigned char* a, const unsigned char* b, unsigned int count)
+{
+	unsigned int done = 0;
+#ifdef HOGBOX_KERNELS_AVX2
+	if(set == ImageKernels::AVX2){done = AverageRowsAVX2(dst, a, b, count);}
+#endif
+#ifdef HOGBOX_KERNELS_SSE2
+	if(set == ImageKernels::SSE2){done = AverageRowsSSE2(dst, a, b, count);}
+#endif
+#ifdef HOGBOX_KERNELS_NEON
+	if(set == ImageKernels::NEON){done = AverageRowsNEON(dst, a, b, count);}
+#endif
+	AverageRowsScalar(dst, a, b, done, count);
+}
+
+//
+//Remove combing from an interlaced frame in place
+//
+void ImageKernels::Deinterlace(unsigned char* data, unsigned int rowBytes, unsigned int height, unsigned int stride,
+								const DeinterlaceMode& mode, unsigned int field)
+{
+	if(height < 2){return;}
+	InstructionSet set = GetInstructionSet();
+	if(mode == BLEND)
+	{
+		//each line only reads the unmodified line below it
+		for(unsigned int r=0; r+1<height; r++){
+			unsigned char* row = data + r*stride;
+			AverageRows(set, row, row, row+stride, rowBytes);
+		}
+		return;
+	}
+
+	//rebuild the other field from the lines either side of it, which are both in the kept field
+	for(unsigned int r=(field & 1) ? 0 : 1; r<height; r+=2)
+	{
+		unsigned char* row = data + r*stride;
+		if(r == 0){
+			memcpy(row, row+stride, rowBytes);
+		}else if(r+1 >= height){
+			memcpy(row, row-stride, rowBytes);
+		}else{
+			AverageRows(set, row, row-stride, row+stride, rowBytes);
+		}
+	}
+}
+
+//
+//Copy one field to dst at half height
+//
+void ImageKernels::ExtractField(const unsigned char* src, unsigned int rowBytes, unsigned int height, unsigned int srcStride,
+								unsigned int field, unsigned char* dst, unsigned int dstStride)
+{
+	unsigned int r = field & 1;
+	for(unsigned int out=0; r<height; r+=2, out++){
+		const unsigned char* row = src + r*srcStride;
+		unsigned char* dstRow = dst + out*dstStride;
+		if(row != dstRow){memmove(dstRow, row, rowBytes);}
+	}
+}
+
+//
+//Swap the first and third channels of 3 or 4 byte pixels
+//
+void ImageKernels::SwapRedBlue(unsigned char* data, unsigned int width, unsigned int height, unsigned int pixelBytes, unsigned int stride)
+{
+	if(pixelBytes != 3 && pixelBytes != 4){return;}
+	InstructionSet set = GetInstructionSet();
+	for(unsigned int r=0; r<height; r++)
+	{
+		unsigned char* row = data + r*stride;
+		unsigned int done = 0;
+#ifdef HOGBOX_KERNELS_AVX2
+		if(set == AVX2){done = SwapRedBlueRowAVX2(row, width, pixelBytes);}
+#endif
+#ifdef HOGBOX_KERNELS_SSE2
+		if(set == SSE2){done = SwapRedBlueRowSSE2(row, width, pixelBytes);}
+#endif
+#ifdef HOGBOX_KERNELS_NEON
+		if(set == NEON){done = SwapRedBlueRowNEON(row, width, pixelBytes);}
+#endif
+		SwapRedBlueRowScalar(row, done, width, pixelBytes);
+	}
+}
+
+//
+//Convert a BT.601 YUV frame to RGB or RGBA
+//
+void ImageKernels::ConvertYUVToRGB(const YUVFormat& format, const unsigned char* src, unsigned int width, unsigned int height, unsigned int srcStride,
+									unsigned char* dst, unsigned int dstPixelBytes, unsigned int dstStride)
+{
+	if(dstPixelBytes != 3 && dstPixelBytes != 4){return;}
+	InstructionSet set = GetInstructionSet();
+
+	const unsigned char* chroma = src + height*srcStride;
+	unsigned int chromaStride = format == I420 ? srcStride/2 : srcStride;
+	const unsigned char* vPlane = chroma + ((height+1)/2)*chromaStride;
+
+	for(unsigned int r=0; r<height; r++)
+	{
+		const unsigned char* yRow = src + r*srcStride;
+		const unsigned char* uRow = NULL;
+		const unsigned char* vRow = NULL;
+		if(format == NV12 || format == I420){
+			uRow = chroma + (r/2)*chromaStride;
+			vRow = vPlane + (r/2)*chromaStride;
+		}
+		unsigned char* out = dst + r*dstStride;
+
+		unsigned int done = 0;
+#ifdef HOGBOX_KERNELS_AVX2
+		if(set == AVX2){done = ConvertYUVRowAVX2(format, yRow, uRow, vRow, out, width, dstPixelBytes);}
+#endif
+#ifdef HOGBOX_KERNELS_SSE2
+		if(set == SSE2){done = ConvertYUVRowSSE2(format, yRow, uRow, vRow, out, width, dstPixelBytes);}
+#endif
+#ifdef HOGBOX_KERNELS_NEON
+		if(set == NEON){done = ConvertYUVRowNEON(format, yRow, uRow, vRow, out, width, dstPixelBytes);}
+#endif
+		ConvertYUVRowScalar(format, yRow, uRow, vRow, out, done, width, dstPixelBytes);
+	}
+}
+
+//
+//Halve the width and height with a 2x2 box filter
+//
+void ImageKernels::Downscale2x(const unsigned char* src, unsigned int width, unsigned int height, unsigned int srcStride, unsigned int pixelBytes,
+								unsigned char* dst, unsigned int dstStride)
+{
+	InstructionSet set = GetInstructionSet();
+	unsigned int dstWidth = width/2;
+	unsigned int dstHeight = height/2;
+	for(unsigned int r=0; r<dstHeight; r++)
+	{
+		const unsigned char* row0 = src + (r*2)*srcStride;
+		const unsigned char* row1 = row0 + srcStride;
+		unsigned char* out = dst + r*dstStride;
+
+		unsigned int done = 0;
+#ifdef HOGBOX_KERNELS_AVX2
+		if(set == AVX2){done = DownscaleRowAVX2(row0, row1, out, dstWidth, pixelBytes);}
+#endif
+#ifdef HOGBOX_KERNELS_SSE2
+		if(set == SSE2){done = DownscaleRowSSE2(row0, row1, out, dstWidth, pixelBytes);}
+#endif
+#ifdef HOGBOX_KERNELS_NEON
+		if(set == NEON){done = DownscaleRowNEON(row0, row1, out, dstWidth, pixelBytes);}
+#endif
+		DownscaleRowScalar(row0, row1, out, done, dstWidth, pixelBytes);
+	}
+}
+
+//
+//Weighted sum of the colour channels
+//
+void ImageKernels::ConvertToLuminance(const unsigned char* src, unsigned int width, unsigned int height, unsigned int srcStride,
+										unsigned int pixelBytes, bool bgr, unsigned char* dst, unsigned int dstStride)
+{
+	InstructionSet set = GetInstructionSet();
+	for(unsigned int r=0; r<height; r++)
+	{
+		const unsigned char* in = src + r*srcStride;
+		unsigned char* out = dst + r*dstStride;
+		if(pixelBytes == 1){
+			memcpy(out, in, width);
+			continue;
+		}
+
+		unsigned int done = 0;
+#ifdef HOGBOX_KERNELS_SSE2
+		if(set == SSE2 || set == AVX2){done = LuminanceRowSSE2(in, out, width, pixelBytes, bgr);}
+#endif
+#ifdef HOGBOX_KERNELS_NEON
+		if(set == NEON){done = LuminanceRowNEON(in, out, width, pixelBytes, bgr);}
+#endif
+		LuminanceRowScalar(in, out, done, width, pixelBytes, bgr);
+	}
+}
+
+static void AccumulateRow(ImageKernels::InstructionSet set, unsigned int* sums, const unsigned char* row, unsigned int width, bool subtract)
+{
+	unsigned int done = 0;
+#ifdef HOGBOX_KERNELS_AVX2
+	if(set == ImageKernels::AVX2){done = AccumulateRowAVX2(sums, row, width, subtract);}
+#endif
+#ifdef HOGBOX_KERNELS_SSE2
+	if(set == ImageKernels::SSE2){done = AccumulateRowSSE2(sums, row, width, subtract);}
+#endif
+#ifdef HOGBOX_KERNELS_NEON
+	if(set == ImageKernels::NEON){done = AccumulateRowNEON(sums, row, width, subtract);}
+#endif
+	AccumulateRowScalar(sums, row, done, width, subtract);
+}
+
+//
+//Box mean threshold, column sums of the window rows are kept as the window moves
+//down so each row costs a row add, a row subtract and a running sum along it
+//
+void ImageKernels::AdaptiveThreshold(const unsigned char* src, unsigned int width, unsigned int height, unsigned int srcStride,
+									unsigned int radius, unsigned char offset, unsigned char* dst, unsigned int dstStride)
+{
+	if(width == 0 || height == 0){return;}
+	InstructionSet set = GetInstructionSet();
+
+	std::vector<unsigned int> sums(width, 0);
+	std::vector<unsigned char> mean(width);
+
+	//rows top to bottom are in the sums
+	int top = 0;
+	int bottom = -1;
+	for(unsigned int y=0; y<height; y++)
+	{
+		int wantTop = (int)y - (int)radius;
+		int wantBottom = (int)(y + radius);
+		if(wantTop < 0){wantTop = 0;}
+		if(wantBottom > (int)height-1){wantBottom = (int)height-1;}
+		while(bottom < wantBottom){
+			bottom++;
+			AccumulateRow(set, &sums[0], src + bottom*srcStride, width, false);
+		}
+		while(top < wantTop){
+			AccumulateRow(set, &sums[0], src + top*srcStride, width, true);
+			top++;
+		}
+		unsigned int rows = bottom - top + 1;
+
+		//slide the window along the row the same way
+		unsigned int sum = 0;
+		int left = 0;
+		int right = -1;
+		for(unsigned int x=0; x<width; x++)
+		{
+			int wantLeft = (int)x - (int)radius;
+			int wantRight = (int)(x + radius);
+			if(wantLeft < 0){wantLeft = 0;}
+			if(wantRight > (int)width-1){wantRight = (int)width-1;}
+			while(right < wantRight){sum += sums[++right];}
+			while(left < wantLeft){sum -= sums[left++];}
+			mean[x] = (unsigned char)(sum / ((right - left + 1) * rows));
+		}
+
+		const unsigned char* in = src + y*srcStride;
+		unsigned char* out = dst + y*dstStride;
+		unsigned int done = 0;
+#ifdef HOGBOX_KERNELS_AVX2
+		if(set == AVX2){done = ThresholdRowAVX2(in, &mean[0], out, width, offset);}
+#endif
+#ifdef HOGBOX_KERNELS_SSE2
+		if(set == SSE2){done = ThresholdRowSSE2(in, &mean[0], out, width, offset);}
+#endif
+#ifdef HOGBOX_KERNELS_NEON
+		if(set == NEON){done = ThresholdRowNEON(in, &mean[0], out, width, offset);}
+#endif
+		ThresholdRowScalar(in, &mean[0], out, done, width, offset);
+	}
+}
+
+//
+//Bilinear lookup through a RemapTable
+//
+void ImageKernels::Remap(const unsigned char* src, unsigned int srcStride, unsigned int pixelBytes,
+						const RemapTable& table, unsigned char* dst, unsigned int dstStride)
+{
+	if(table._width == 0 || table._height == 0){return;}
+	InstructionSet set = GetInstructionSet();
+	for(unsigned int y=0; y<table._height; y++)
+	{
+		const unsigned short* coords = &table._coords[y*table._width*2];
+		const unsigned char* fractions = &table._fractions[y*table._width*2];
+		unsigned char* out = dst + y*dstStride;
+		unsigned int done = 0;
+#ifdef HOGBOX_KERNELS_AVX2
+		if(set == AVX2 && pixelBytes == 1){done = RemapRowAVX2(src, srcStride, coords, fractions, out, table._width);}
+#endif
+#ifdef HOGBOX_KERNELS_SSE2
+		if(set == SSE2 || (set == AVX2 && pixelBytes != 1)){done = RemapRowSSE2(src, srcStride, pixelBytes, coords, fractions, out, table._width);}
+#endif
+#ifdef HOGBOX_KERNELS_NEON
+		if(set == NEON){done = RemapRowNEON(src, srcStride, pixelBytes, coords, fractions, out, table._width);}
+#endif
+		RemapRowScalar(src, srcStride, pixelBytes, coords, fractions, out, done, table._width);
+	}
+}
+
+//
+//osg::Image overloads
+//
+
+unsigned int ImageKernels::GetRowStride(const osg::Image* image)
+{
+	return image->getRowSizeInBytes();
+}
+
+//true if the image holds byte data we can treat as plain pixels
+static bool IsByteImage(const osg::Image* image)
+{
+	if(!image || !image->data()){return false;}
+	if(image->getDataType() != GL_UNSIGNED_BYTE){
+		OSG_NOTICE << "ImageKernels: Image '" << image->getFileName() << "' is not GL_UNSIGNED_BYTE data, skipping." << std::endl;
+		return false;
+	}
+	return true;
+}
+
+void ImageKernels::FlipVertical(osg::Image* image)
+{
+	if(!IsByteImage(image)){return;}
+	for(int slice=0; slice<image->r(); slice++){
+		FlipVertical(image->data(0,0,slice), image->getRowSizeInBytes(), image->t(), GetRowStride(image));
+	}
+	image->dirty();
+}
+
+void ImageKernels::FlipHorizontal(osg::Image* image)
+{
+	if(!IsByteImage(image)){return;}
+	for(int slice=0; slice<image->r(); slice++){
+		FlipHorizontal(image->data(0,0,slice), image->s(), image->t(), image->getPixelSizeInBits()/8, GetRowStride(image));
+	}
+	image->dirty();
+}
+
+void ImageKernels::Deinterlace(osg::Image* image, const DeinterlaceMode& mode, unsigned int field)
+{
+	if(!IsByteImage(image)){return;}
+	unsigned int rowBytes = image->s()*(image->getPixelSizeInBits()/8);
+	for(int slice=0; slice<image->r(); slice++){
+		Deinterlace(image->data(0,0,slice), rowBytes, image->t(), GetRowStride(image), mode, field);
+	}
+	image->dirty();
+}
+
+void ImageKernels::SwapRedBlue(osg::Image* image)
+{
+	if(!IsByteImage(image)){return;}
+
+	GLenum swapped = image->getPixelFormat();
+	switch(image->getPixelFormat()){
+		case GL_RGB: swapped = GL_BGR; break;
+		case GL_BGR: swapped = GL_RGB; break;
+		case GL_RGBA: swapped = GL_BGRA; break;
+		case GL_BGRA: swapped = GL_RGBA; break;
+		default:
+			OSG_NOTICE << "ImageKernels::SwapRedBlue: Image '" << image->getFileName() << "' is not an RGB(A) or BGR(A) image, skipping." << std::endl;
+			return;
+	}
+
+	for(int slice=0; slice<image->r(); slice++){
+		SwapRedBlue(image->data(0,0,slice), image->s(), image->t(), image->getPixelSizeInBits()/8, GetRowStride(image));
+	}
+	image->setPixelFormat(swapped);
+	image->dirty();
+}
+
+void ImageKernels::ConvertYUVToRGB(const YUVFormat& format, const unsigned char* src, unsigned int width, unsigned int height, unsigned int srcStride,
+									osg::Image* image, bool alpha)
+{
+	if(!image || !src){return;}
+	GLenum pixelFormat = alpha ? GL_RGBA : GL_RGB;
+	if(!image->data() || image->s() != (int)width || image->t() != (int)height ||
+		image->getPixelFormat() != pixelFormat || image->getDataType() != GL_UNSIGNED_BYTE)
+	{
+		image->allocateImage(width, height, 1, pixelFormat, GL_UNSIGNED_BYTE, 1);
+		image->setInternalTextureFormat(pixelFormat);
+	}
+	ConvertYUVToRGB(format, src, width, height, srcStride, image->data(), alpha ? 4 : 3, GetRowStride(image));
+	image->dirty();
+}
+
+osg::Image* ImageKernels::Downscale2x(const osg::Image* image)
+{
+	if(!IsByteImage(image)){return NULL;}
+	osg::Image* scaled = new osg::Image();
+	scaled->allocateImage(image->s()/2, image->t()/2, 1, image->getPixelFormat(), image->getDataType(), image->getPacking());
+	scaled->setInternalTextureFormat(image->getInternalTextureFormat());
+	scaled->setOrigin(image->getOrigin());
+	Downscale2x(image->data(), image->s(), image->t(), GetRowStride(image), image->getPixelSizeInBits()/8,
+				scaled->data(), GetRowStride(scaled));
+	return scaled;
+}
+
+osg::Image* ImageKernels::ConvertToLuminance(const osg::Image* image)
+{
+	if(!IsByteImage(image)){return NULL;}
+
+	bool bgr = false;
+	switch(image->getPixelFormat()){
+		case GL_LUMINANCE:
+		case GL_RGB:
+		case GL_RGBA:
+			break;
+		case GL_BGR:
+		case GL_BGRA:
+			bgr = true;
+			break;
+		default:
+			OSG_NOTICE << "ImageKernels::ConvertToLuminance: Image '" << image->getFileName() << "' is not an RGB(A), BGR(A) or luminance image, skipping." << std::endl;
+			return NULL;
+	}
+
+	osg::Image* luminance = new osg::Image();
+	luminance->allocateImage(image->s(), image->t(), 1, GL_LUMINANCE, GL_UNSIGNED_BYTE, 1);
+	luminance->setInternalTextureFormat(GL_LUMINANCE);
+	luminance->setOrigin(image->getOrigin());
+	ConvertToLuminance(image->data(), image->s(), image->t(), GetRowStride(image), image->getPixelSizeInBits()/8, bgr,
+						luminance->data(), GetRowStride(luminance));
+	return luminance;
+}
+
+bool ImageKernels::Remap(const osg::Image* src, const RemapTable& table, osg::Image* dst)
+{
+	if(!IsByteImage(src) || !dst){return false;}
+	if(src->s() != (int)table._srcWidth || src->t() != (int)table._srcHeight){
+		OSG_NOTICE << "ImageKernels::Remap: Image '" << src->getFileName() << "' is " << src->s() << "x" << src->t() << ", the table expects "
+					<< table._srcWidth << "x" << table._srcHeight << ", skipping." << std::endl;
+		return false;
+	}
+	if(!dst->data() || dst->s() != (int)table._width || dst->t() != (int)table._height ||
+		dst->getPixelFormat() != src->getPixelFormat() || dst->getDataType() != src->getDataType())
+	{
+		dst->allocateImage(table._width, table._height, 1, src->getPixelFormat(), src->getDataType(), src->getPacking());
+		dst->setInternalTextureFormat(src->getInternalTextureFormat());
+	}
+	dst->setOrigin(src->getOrigin());
+	Remap(src->data(), GetRowStride(src), src->getPixelSizeInBits()/8, table, dst->data(), GetRowStride(dst));
+	dst->dirty();
+	return true;
+}
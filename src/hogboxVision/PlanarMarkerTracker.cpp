@@ -0,0 +1,874 @@
+#include <hogboxVision/PlanarMarkerTracker.h>
+#include <hogboxVision/ImageKernels.h>
+
+#include <osg/Notify>
+#include <osg/Image>
+#include <OpenThreads/ScopedLock>
+
+#include <math.h>
+#include <string.h>
+#include <sstream>
+
+using namespace hogboxVision;
+
+//
+//Reads and refines one candidate on the pool
+//
+class PlanarMarkerTracker::CandidateTask : public hogbox::PoolTask
+{
+public:
+	CandidateTask(PlanarMarkerTracker* tracker, PlanarMarkerCandidate* candidate)
+		: hogbox::PoolTask(),
+		p_tracker(tracker),
+		p_candidate(candidate)
+	{
+	}
+	virtual void Run(){
+		p_tracker->DecodeCandidate(*p_candidate);
+	}
+protected:
+	virtual ~CandidateTask(void){}
+protected:
+	PlanarMarkerTracker* p_tracker;
+	PlanarMarkerCandidate* p_candidate;
+};
+
+//
+//Poses and updates one tracked object on the pool
+//
+class PlanarMarkerTracker::ObjectTask : public hogbox::PoolTask
+{
+public:
+	ObjectTask(PlanarMarkerTracker* tracker, PlanarTrackedObject* object, int id)
+		: hogbox::PoolTask(),
+		p_tracker(tracker),
+		p_object(object),
+		_id(id)
+	{
+	}
+	virtual void Run(){
+		p_tracker->UpdateObject(p_object, _id);
+	}
+protected:
+	virtual ~ObjectTask(void){}
+protected:
+	PlanarMarkerTracker* p_tracker;
+	PlanarTrackedObject* p_object;
+	int _id;
+};
+
+//
+//Geometry helpers
+//
+
+//8 neighbours clockwise on screen (y down) starting east
+static const int s_neighbourX[8] = {1, 1, 0, -1, -1, -1, 0, 1};
+static const int s_neighbourY[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+
+static unsigned int CountBits(unsigned int value)
+{
+	unsigned int count = 0;
+	for( ; value; value &= value-1){count++;}
+	return count;
+}
+
+//
+//Bilinear sample of a single channel image at pixel centre coords, clamped at the edges
+//
+static double SamplePixels(const std::vector<unsigned char>& pixels, unsigned int width, unsigned int height, double x, double y)
+{
+	if(x < 0.0){x = 0.0;}
+	if(y < 0.0){y = 0.0;}
+	if(x > width-1){x = width-1;}
+	if(y > height-1){y = height-1;}
+	unsigned int x0 = (unsigned int)x;
+	unsigned int y0 = (unsigned int)y;
+	unsigned int x1 = x0+1 < width ? x0+1 : x0;
+	unsigned int y1 = y0+1 < height ? y0+1 : y0;
+	double fx = x - x0;
+	double fy = y - y0;
+	double top = pixels[y0*width+x0] * (1.0-fx) + pixels[y0*width+x1] * fx;
+	double bottom = pixels[y1*width+x0] * (1.0-fx) + pixels[y1*width+x1] * fx;
+	return top * (1.0-fy) + bottom * fy;
+}
+
+//
+//Homography taking the unit square (0,0) (1,0) (1,1) (0,1) to the corners (Heckbert),
+//row major with h[8] = 1
+//
+static void SquareToQuad(const osg::Vec2d* corners, double* h)
+{
+	double x0 = corners[0].x(), y0 = corners[0].y();
+	double x1 = corners[1].x(), y1 = corners[1].y();
+	double x2 = corners[2].x(), y2 = corners[2].y();
+	double x3 = corners[3].x(), y3 = corners[3].y();
+	double sx = x0 - x1 + x2 - x3;
+	double sy = y0 - y1 + y2 - y3;
+	double g = 0.0;
+	double k = 0.0;
+	if(fabs(sx) > 1e-9 || fabs(sy) > 1e-9)
+	{
+		double dx1 = x1 - x2, dx2 = x3 - x2;
+		double dy1 = y1 - y2, dy2 = y3 - y2;
+		double det = dx1 * dy2 - dx2 * dy1;
+		if(fabs(det) > 1e-12){
+			g = (sx * dy2 - dx2 * sy) / det;
+			k = (dx1 * sy - sx * dy1) / det;
+		}
+	}
+	h[0] = x1 - x0 + g * x1; h[1] = x3 - x0 + k * x3; h[2] = x0;
+	h[3] = y1 - y0 + g * y1; h[4] = y3 - y0 + k * y3; h[5] = y0;
+	h[6] = g; h[7] = k; h[8] = 1.0;
+}
+
+static osg::Vec2d ApplyHomography(const double* h, double u, double v)
+{
+	double w = h[6] * u + h[7] * v + h[8];
+	return osg::Vec2d((h[0] * u + h[1] * v + h[2]) / w, (h[3] * u + h[4] * v + h[5]) / w);
+}
+
+//
+//Line through points by total least squares, as a point and unit direction
+//
+static bool FitLine(const std::vector<osg::Vec2d>& points, osg::Vec2d& centre, osg::Vec2d& direction)
+{
+	if(points.size() < 3){return false;}
+	centre = osg::Vec2d();
+	for(unsigned int i=0; i<points.size(); i++){centre += points[i];}
+	centre /= (double)points.size();
+
+	double xx = 0.0, xy = 0.0, yy = 0.0;
+	for(unsigned int i=0; i<points.size(); i++){
+		osg::Vec2d d = points[i] - centre;
+		xx += d.x() * d.x();
+		xy += d.x() * d.y();
+		yy += d.y() * d.y();
+	}
+	//principal axis of the scatter
+	double angle = 0.5 * atan2(2.0 * xy, xx - yy);
+	direction = osg::Vec2d(cos(angle), sin(angle));
+	return true;
+}
+
+static bool IntersectLines(const osg::Vec2d& p0, const osg::Vec2d& d0, const osg::Vec2d& p1, const osg::Vec2d& d1, osg::Vec2d& result)
+{
+	double det = d0.x() * d1.y() - d0.y() * d1.x();
+	if(fabs(det) < 1e-9){return false;}
+	osg::Vec2d diff = p1 - p0;
+	double t = (diff.x() * d1.y() - diff.y() * d1.x()) / det;
+	result = p0 + d0 * t;
+	return true;
+}
+
+//
+//Distance of p from the line through a and b
+//
+static double DistanceToLine(const osg::Vec2d& p, const osg::Vec2d& a, const osg::Vec2d& b)
+{
+	osg::Vec2d ab = b - a;
+	double length = ab.length();
+	if(length < 1e-9){return (p - a).length();}
+	return fabs(ab.x() * (p.y() - a.y()) - ab.y() * (p.x() - a.x())) / length;
+}
+
+//
+//Furthest contour point from the line a-b walking from index start to end (wrapping)
+//
+static unsigned int FurthestFromLine(const std::vector<osg::Vec2d>& contour, unsigned int start, unsigned int end,
+									const osg::Vec2d& a, const osg::Vec2d& b, double& distance)
+{
+	unsigned int n = contour.size();
+	unsigned int best = start;
+	distance = 0.0;
+	for(unsigned int i=start; i!=end; i=(i+1)%n){
+		double d = DistanceToLine(contour[i], a, b);
+		if(d > distance){distance = d; best = i;}
+	}
+	return best;
+}
+
+
+PlanarMarkerTracker::PlanarMarkerTracker(hogbox::WorkStealingPool* pool)
+	: CameraBasedTracker(),
+	_pool(pool),
+	_useParallel(true),
+	_maxDetectionWidth(640),
+	_thresholdRadius(7),
+	_thresholdOffset(7),
+	_minMarkerSize(12),
+	_minContrast(0.15f),
+	_maxBitErrors(0),
+	_detectionLevel(0)
+{
+	if(!_pool.get()){
+		_pool = hogbox::WorkStealingPool::Inst();
+	}
+}
+
+/** Copy constructor using CopyOp to manage deep vs shallow copy.*/
+PlanarMarkerTracker::PlanarMarkerTracker(const PlanarMarkerTracker& tracker,const osg::CopyOp& copyop)
+	: CameraBasedTracker(tracker, copyop),
+	_pool(tracker._pool),
+	_useParallel(tracker._useParallel),
+	_maxDetectionWidth(tracker._maxDetectionWidth),
+	_thresholdRadius(tracker._thresholdRadius),
+	_thresholdOffset(tracker._thresholdOffset),
+	_minMarkerSize(tracker._minMarkerSize),
+	_minContrast(tracker._minContrast),
+	_maxBitErrors(tracker._maxBitErrors),
+	_detectionLevel(0)
+{
+}
+
+PlanarMarkerTracker::~PlanarMarkerTracker(void)
+{
+	//the thread calls our UpdateTracking
+	SetThreaded(false);
+	_markerIds.clear();
+	_pool = NULL;
+}
+
+PlanarTrackedObject* PlanarMarkerTracker::AddMarker(unsigned int id, float width)
+{
+	osg::ref_ptr<PlanarTrackedObject> object = new PlanarTrackedObject();
+	object->SetWidth(width);
+	std::ostringstream name;
+	name << "PlanarMarker" << id;
+	object->setName(name.str());
+	if(!AddMarker(object.get(), id)){return NULL;}
+	return object.get();
+}
+
+//
+//Track object as marker id if it can be told apart from the markers we have
+//
+bool PlanarMarkerTracker::AddMarker(PlanarTrackedObject* object, unsigned int id)
+{
+	if(!object){return false;}
+	if(id == 0 || id > 0xFFFF){
+		osg::notify(osg::WARN) << "PlanarMarkerTracker::AddMarker: ERROR: Marker id " << id << " is out of range, ids are 1 to 65535." << std::endl;
+		return false;
+	}
+
+	unsigned int rotated = id;
+	for(unsigned int k=1; k<4; k++)
+	{
+		rotated = RotateCode(rotated);
+		if(rotated == id){
+			osg::notify(osg::WARN) << "PlanarMarkerTracker::AddMarker: ERROR: Marker id " << id << " looks the same rotated, its orientation can't be found." << std::endl;
+			return false;
+		}
+	}
+
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_trackedObjectsMutex);
+		for(std::map<const TrackedObject*, unsigned int>::iterator itr=_markerIds.begin(); itr!=_markerIds.end(); itr++)
+		{
+			unsigned int code = id;
+			for(unsigned int k=0; k<4; k++, code = RotateCode(code)){
+				if(code == (*itr).second){
+					osg::notify(osg::WARN) << "PlanarMarkerTracker::AddMarker: ERROR: Marker id " << id << " matches marker " << (*itr).second << " already being tracked." << std::endl;
+					return false;
+				}
+			}
+		}
+		_markerIds[object] = id;
+	}
+
+	AddTrackedObject(object);
+	return true;
+}
+
+unsigned int PlanarMarkerTracker::RotateCode(unsigned int code)
+{
+	//the new top row is the old left column read bottom to top
+	unsigned int rotated = 0;
+	for(unsigned int r=0; r<MARKER_BITS; r++){
+		for(unsigned int c=0; c<MARKER_BITS; c++){
+			unsigned int bit = (code >> (MARKER_BITS*MARKER_BITS-1 - ((MARKER_BITS-1-c)*MARKER_BITS + r))) & 1;
+			rotated |= bit << (MARKER_BITS*MARKER_BITS-1 - (r*MARKER_BITS + c));
+		}
+	}
+	return rotated;
+}
+
+osg::Image* PlanarMarkerTracker::CreateMarkerImage(unsigned int id, unsigned int cellPixels, unsigned int marginCells)
+{
+	unsigned int cells = MARKER_CELLS + marginCells*2;
+	unsigned int size = cells * cellPixels;
+	osg::Image* image = new osg::Image();
+	image->allocateImage(size, size, 1, GL_LUMINANCE, GL_UNSIGNED_BYTE, 1);
+	image->setInternalTextureFormat(GL_LUMINANCE);
+	image->setOrigin(osg::Image::TOP_LEFT);
+
+	for(unsigned int y=0; y<size; y++)
+	{
+		unsigned char* row = image->data(0, y);
+		int cellRow = (int)(y / cellPixels) - (int)marginCells;
+		for(unsigned int x=0; x<size; x++)
+		{
+			int cellCol = (int)(x / cellPixels) - (int)marginCells;
+			unsigned char value = 255;
+			if(cellRow >= 0 && cellCol >= 0 && cellRow < MARKER_CELLS && cellCol < MARKER_CELLS)
+			{
+				value = 0;
+				if(cellRow > 0 && cellCol > 0 && cellRow < MARKER_CELLS-1 && cellCol < MARKER_CELLS-1){
+					unsigned int bit = (cellRow-1)*MARKER_BITS + (cellCol-1);
+					if((id >> (MARKER_BITS*MARKER_BITS-1 - bit)) & 1){value = 255;}
+				}
+			}
+			row[x] = value;
+		}
+	}
+	image->dirty();
+	return image;
+}
+
+bool PlanarMarkerTracker::LoadCalibrationFromFile(const std::string& fileName)
+{
+	_cc = new CameraCalibration();
+	if(fileName.empty()){
+		_cc->ChangeSize(_videoWidth, _videoHeight);
+		return true;
+	}
+	if(!_cc->LoadCalibrationFromFile(fileName)){
+		return false;
+	}
+	//scale to the video we'll be tracking
+	if(_videoWidth > 0 && _videoHeight > 0){
+		_cc->ChangeSize(_videoWidth, _videoHeight);
+	}
+	return true;
+}
+
+//
+//Luminance pyramid of image down to the detection level
+//
+bool PlanarMarkerTracker::BuildPyramid(osg::Image* image)
+{
+	if(!image || !image->data() || image->s() < 2 || image->t() < 2){return false;}
+	if(image->getDataType() != GL_UNSIGNED_BYTE){
+		osg::notify(osg::WARN) << "PlanarMarkerTracker::BuildPyramid: ERROR: Image '" << image->getFileName() << "' is not GL_UNSIGNED_BYTE data." << std::endl;
+		return false;
+	}
+
+	bool bgr = false;
+	switch(image->getPixelFormat()){
+		case GL_LUMINANCE:
+		case GL_RGB:
+		case GL_RGBA:
+			break;
+		case GL_BGR:
+		case GL_BGRA:
+			bgr = true;
+			break;
+		default:
+			osg::notify(osg::WARN) << "PlanarMarkerTracker::BuildPyramid: ERROR: Image '" << image->getFileName() << "' is not an RGB(A), BGR(A) or luminance image." << std::endl;
+			return false;
+	}
+
+	unsigned int width = image->s();
+	unsigned int height = image->t();
+	_detectionLevel = 0;
+	while((width >> _detectionLevel) > _maxDetectionWidth && (width >> (_detectionLevel+1)) >= MARKER_CELLS*2 && (height >> (_detectionLevel+1)) >= MARKER_CELLS*2){
+		_detectionLevel++;
+	}
+	_levels.resize(_detectionLevel+1);
+
+	Level& full = _levels[0];
+	full._width = width;
+	full._height = height;
+	full._pixels.resize(width*height);
+	ImageKernels::ConvertToLuminance(image->data(), width, height, ImageKernels::GetRowStride(image), image->getPixelSizeInBits()/8, bgr,
+									&full._pixels[0], width);
+	//we work top row first
+	if(image->getOrigin() == osg::Image::BOTTOM_LEFT){
+		ImageKernels::FlipVertical(&full._pixels[0], width, height, width);
+	}
+
+	for(unsigned int l=1; l<=_detectionLevel; l++)
+	{
+		const Level& above = _levels[l-1];
+		Level& level = _levels[l];
+		level._width = above._width/2;
+		level._height = above._height/2;
+		level._pixels.resize(level._width*level._height);
+		ImageKernels::Downscale2x(&above._pixels[0], above._width, above._height, above._width, 1, &level._pixels[0], level._width);
+	}
+	return true;
+}
+
+//
+//Threshold the detection level, trace the outer contour of each dark blob and
+//keep those that fit a quad
+//
+void PlanarMarkerTracker::FindQuads(std::vector<PlanarMarkerCandidate>& candidates)
+{
+	const Level& level = _levels[_detectionLevel];
+	const int width = (int)level._width;
+	const int height = (int)level._height;
+	const double scale = (double)(1 << _detectionLevel);
+
+	_binary.resize(width*height);
+	ImageKernels::AdaptiveThreshold(&level._pixels[0], width, height, width, _thresholdRadius, _thresholdOffset, &_binary[0], width);
+	_labels.assign(width*height, 0);
+
+	std::vector<int> stack;
+	std::vector<osg::Vec2d> contour;
+	int label = 0;
+	for(int y=0; y<height; y++)
+	{
+		for(int x=0; x<width; x++)
+		{
+			int index = y*width+x;
+			if(!_binary[index] || _labels[index]){continue;}
+
+			//8 connected flood fill of the blob, (x,y) is its first pixel in raster order
+			label++;
+			int minX = x, maxX = x, minY = y, maxY = y;
+			bool touchesEdge = false;
+			_labels[index] = label;
+			stack.clear();
+			stack.push_back(index);
+			while(!stack.empty())
+			{
+				int current = stack.back();
+				stack.pop_back();
+				int cx = current % width;
+				int cy = current / width;
+				if(cx < minX){minX = cx;}
+				if(cx > maxX){maxX = cx;}
+				if(cy < minY){minY = cy;}
+				if(cy > maxY){maxY = cy;}
+				if(cx == 0 || cy == 0 || cx == width-1 || cy == height-1){touchesEdge = true;}
+				for(unsigned int d=0; d<8; d++){
+					int nx = cx + s_neighbourX[d];
+					int ny = cy + s_neighbourY[d];
+					if(nx < 0 || ny < 0 || nx >= width || ny >= height){continue;}
+					int neighbour = ny*width+nx;
+					if(_binary[neighbour] && !_labels[neighbour]){
+						_labels[neighbour] = label;
+						stack.push_back(neighbour);
+					}
+				}
+			}
+
+			//the quiet zone round a marker can't be outside the image
+			if(touchesEdge){continue;}
+			if(maxX - minX + 1 < (int)_minMarkerSize || maxY - minY + 1 < (int)_minMarkerSize){continue;}
+
+			//moore neighbour trace of the outer boundary, clockwise on screen from
+			//the first pixel, whose west neighbour is background
+			contour.clear();
+			int cx = x, cy = y;
+			int backtrack = 4;
+			int firstMove = -1;
+			unsigned int maxSteps = 4*(maxX-minX+maxY-minY+2) + 8;
+			contour.push_back(osg::Vec2d(cx, cy));
+			for(unsigned int step=0; step<maxSteps; step++)
+			{
+				int move = -1;
+				for(unsigned int i=1; i<=8; i++){
+					int d = (backtrack + i) % 8;
+					int nx = cx + s_neighbourX[d];
+					int ny = cy + s_neighbourY[d];
+					if(nx >= 0 && ny >= 0 && nx < width && ny < height && _labels[ny*width+nx] == label){move = d; break;}
+				}
+				if(move < 0){break;}
+				//back where we started heading the same way, done
+				if(firstMove < 0){
+					firstMove = move;
+				}else if(cx == x && cy == y && move == firstMove){
+					break;
+				}
+				//the background pixel checked before the move becomes the backtrack
+				int qx = cx + s_neighbourX[(move+7)%8];
+				int qy = cy + s_neighbourY[(move+7)%8];
+				cx += s_neighbourX[move];
+				cy += s_neighbourY[move];
+				for(unsigned int d=0; d<8; d++){
+					if(cx + s_neighbourX[d] == qx && cy + s_neighbourY[d] == qy){backtrack = d; break;}
+				}
+				contour.push_back(osg::Vec2d(cx, cy));
+			}
+			if(contour.size() > 1 && contour.back() == contour.front()){contour.pop_back();}
+			if(contour.size() < 4*_minMarkerSize/2){continue;}
+
+			//corners, the point furthest from the centre, the point furthest from
+			//that, then the points furthest either side of the line between them
+			unsigned int n = contour.size();
+			osg::Vec2d centre;
+			for(unsigned int i=0; i<n; i++){centre += contour[i];}
+			centre /= (double)n;
+			unsigned int i0 = 0, i2 = 0;
+			double furthest = 0.0;
+			for(unsigned int i=0; i<n; i++){
+				double d = (contour[i] - centre).length2();
+				if(d > furthest){furthest = d; i0 = i;}
+			}
+			furthest = 0.0;
+			for(unsigned int i=0; i<n; i++){
+				double d = (contour[i] - contour[i0]).length2();
+				if(d > furthest){furthest = d; i2 = i;}
+			}
+			double d1, d3;
+			unsigned int i1 = FurthestFromLine(contour, i0, i2, contour[i0], contour[i2], d1);
+			unsigned int i3 = FurthestFromLine(contour, i2, i0, contour[i0], contour[i2], d3);
+			double minSpan = _minMarkerSize * 0.3;
+			if(d1 < minSpan || d3 < minSpan){continue;}
+
+			//each side has to be straight
+			unsigned int corners[4] = {i0, i1, i2, i3};
+			bool isQuad = true;
+			for(unsigned int s=0; s<4 && isQuad; s++){
+				const osg::Vec2d& a = contour[corners[s]];
+				const osg::Vec2d& b = contour[corners[(s+1)%4]];
+				double deviation;
+				FurthestFromLine(contour, corners[s], corners[(s+1)%4], a, b, deviation);
+				double tolerance = 0.06 * (b - a).length();
+				if(tolerance < 1.5){tolerance = 1.5;}
+				if(deviation > tolerance){isQuad = false;}
+			}
+			if(!isQuad){continue;}
+
+			PlanarMarkerCandidate candidate;
+			for(unsigned int c=0; c<4; c++){
+				//pixel centres at the detection level to full resolution
+				candidate._corners[c] = contour[corners[c]] * scale + osg::Vec2d((scale-1.0)*0.5, (scale-1.0)*0.5);
+			}
+			double area = 0.0;
+			for(unsigned int c=0; c<4; c++){
+				const osg::Vec2d& a = candidate._corners[c];
+				const osg::Vec2d& b = candidate._corners[(c+1)%4];
+				area += a.x() * b.y() - b.x() * a.y();
+			}
+			candidate._area = area * 0.5;
+			//the trace runs clockwise on screen, so this shouldn't happen
+			if(candidate._area < 0.0){
+				std::swap(candidate._corners[1], candidate._corners[3]);
+				candidate._area = -candidate._area;
+			}
+			candidates.push_back(candidate);
+		}
+	}
+}
+
+//
+//Move the corners onto the edges of the full resolution image then read the code
+//
+void PlanarMarkerTracker::DecodeCandidate(PlanarMarkerCandidate& candidate)
+{
+	const Level& full = _levels[0];
+	const double range = (double)(1 << _detectionLevel) + 2.0;
+
+	//fit a line to the strongest dark to light edge found along the outward
+	//normal at points along each side
+	osg::Vec2d lineCentres[4];
+	osg::Vec2d lineDirections[4];
+	bool refined = true;
+	std::vector<osg::Vec2d> edgePoints;
+	for(unsigned int s=0; s<4 && refined; s++)
+	{
+		const osg::Vec2d& a = candidate._corners[s];
+		const osg::Vec2d& b = candidate._corners[(s+1)%4];
+		double length = (b - a).length();
+		if(length < 4.0){refined = false; break;}
+		osg::Vec2d direction = (b - a) / length;
+		osg::Vec2d normal(direction.y(), -direction.x());
+
+		unsigned int numSamples = (unsigned int)(length / 4.0);
+		if(numSamples < 6){numSamples = 6;}
+		if(numSamples > 32){numSamples = 32;}
+		edgePoints.clear();
+		for(unsigned int k=0; k<numSamples; k++)
+		{
+			//stay clear of the corners
+			double t = 0.1 + 0.8 * ((double)k + 0.5) / (double)numSamples;
+			osg::Vec2d p = a + (b - a) * t;
+			double bestGradient = 0.0;
+			double bestOffset = 0.0;
+			double previous = SamplePixels(full._pixels, full._width, full._height, p.x() - normal.x()*range, p.y() - normal.y()*range);
+			for(double offset=-range+0.5; offset<=range; offset+=0.5)
+			{
+				osg::Vec2d q = p + normal * offset;
+				double value = SamplePixels(full._pixels, full._width, full._height, q.x(), q.y());
+				double gradient = value - previous;
+				if(gradient > bestGradient){bestGradient = gradient; bestOffset = offset - 0.25;}
+				previous = value;
+			}
+			if(bestGradient >= 8.0){edgePoints.push_back(p + normal * bestOffset);}
+		}
+		if(!FitLine(edgePoints, lineCentres[s], lineDirections[s])){refined = false;}
+	}
+
+	if(refined)
+	{
+		osg::Vec2d corners[4];
+		for(unsigned int c=0; c<4 && refined; c++){
+			//corner c starts side c and ends the one before
+			unsigned int before = (c+3)%4;
+			if(!IntersectLines(lineCentres[before], lineDirections[before], lineCentres[c], lineDirections[c], corners[c]) ||
+				(corners[c] - candidate._corners[c]).length() > range*2.0){
+				refined = false;
+			}
+		}
+		if(refined){
+			for(unsigned int c=0; c<4; c++){candidate._corners[c] = corners[c];}
+		}
+	}
+
+	//sample the cells, 0-1 covering the border
+	double h[9];
+	SquareToQuad(candidate._corners, h);
+	const double cell = 1.0 / (double)MARKER_CELLS;
+	double cells[MARKER_CELLS][MARKER_CELLS];
+	for(unsigned int r=0; r<MARKER_CELLS; r++){
+		for(unsigned int c=0; c<MARKER_CELLS; c++){
+			//the centre and four points round it, for some resistance to blur
+			double sum = 0.0;
+			static const double offsets[5][2] = {{0.0, 0.0}, {-0.2, -0.2}, {0.2, -0.2}, {0.2, 0.2}, {-0.2, 0.2}};
+			for(unsigned int i=0; i<5; i++){
+				osg::Vec2d p = ApplyHomography(h, (c + 0.5 + offsets[i][0]) * cell, (r + 0.5 + offsets[i][1]) * cell);
+				sum += SamplePixels(full._pixels, full._width, full._height, p.x(), p.y());
+			}
+			cells[r][c] = sum / 5.0;
+		}
+	}
+
+	//border against the quiet zone half a cell outside it
+	double border = 0.0;
+	double quiet = 0.0;
+	for(unsigned int i=0; i<MARKER_CELLS; i++)
+	{
+		border += cells[0][i] + cells[MARKER_CELLS-1][i];
+		if(i > 0 && i < MARKER_CELLS-1){border += cells[i][0] + cells[i][MARKER_CELLS-1];}
+		double along = (i + 0.5) * cell;
+		osg::Vec2d q[4] = {ApplyHomography(h, along, -0.5*cell), ApplyHomography(h, along, 1.0+0.5*cell),
+							ApplyHomography(h, -0.5*cell, along), ApplyHomography(h, 1.0+0.5*cell, along)};
+		for(unsigned int j=0; j<4; j++){quiet += SamplePixels(full._pixels, full._width, full._height, q[j].x(), q[j].y());}
+	}
+	border /= (double)(MARKER_CELLS*4 - 4);
+	quiet /= (double)(MARKER_CELLS*4);
+
+	for(unsigned int k=0; k<4; k++){candidate._codes[k] = -1;}
+	candidate._contrast = (float)((quiet - border) / 255.0);
+	if(candidate._contrast < _minContrast){return;}
+
+	double threshold = (quiet + border) * 0.5;
+	for(unsigned int i=0; i<MARKER_CELLS; i++){
+		if(cells[0][i] > threshold || cells[MARKER_CELLS-1][i] > threshold ||
+			cells[i][0] > threshold || cells[i][MARKER_CELLS-1] > threshold){return;}
+	}
+
+	//code with corner 0 as the top left, then each other corner in turn
+	int bits[MARKER_BITS][MARKER_BITS];
+	for(unsigned int r=0; r<MARKER_BITS; r++){
+		for(unsigned int c=0; c<MARKER_BITS; c++){
+			bits[r][c] = cells[r+1][c+1] > threshold ? 1 : 0;
+		}
+	}
+	for(unsigned int k=0; k<4; k++)
+	{
+		int code = 0;
+		for(unsigned int r=0; r<MARKER_BITS; r++){
+			for(unsigned int c=0; c<MARKER_BITS; c++){
+				code = (code << 1) | bits[r][c];
+			}
+		}
+		//an all black centre is a plain dark square
+		candidate._codes[k] = code == 0 ? -1 : code;
+
+		//next corner round as the top left
+		int rotated[MARKER_BITS][MARKER_BITS];
+		for(unsigned int r=0; r<MARKER_BITS; r++){
+			for(unsigned int c=0; c<MARKER_BITS; c++){
+				rotated[r][c] = bits[c][MARKER_BITS-1-r];
+			}
+		}
+		memcpy(bits, rotated, sizeof(bits));
+	}
+}
+
+//
+//Match a candidate to the tracked ids
+//
+void PlanarMarkerTracker::MatchCandidate(PlanarMarkerCandidate& candidate)
+{
+	candidate._id = -1;
+	unsigned int bestErrors = _maxBitErrors+1;
+	for(std::map<const TrackedObject*, unsigned int>::iterator itr=_markerIds.begin(); itr!=_markerIds.end(); itr++)
+	{
+		for(unsigned int k=0; k<4; k++)
+		{
+			if(candidate._codes[k] < 0){continue;}
+			unsigned int errors = CountBits((unsigned int)candidate._codes[k] ^ (*itr).second);
+			if(errors < bestErrors){
+				bestErrors = errors;
+				candidate._id = (*itr).second;
+				candidate._rotation = k;
+			}
+		}
+	}
+	if(candidate._id < 0){return;}
+
+	candidate._bitErrors = bestErrors;
+	osg::Vec2d corners[4];
+	for(unsigned int c=0; c<4; c++){corners[c] = candidate._corners[(c + candidate._rotation) % 4];}
+	for(unsigned int c=0; c<4; c++){candidate._corners[c] = corners[c];}
+}
+
+//
+//Find and decode the markers in image
+//
+bool PlanarMarkerTracker::Detect(osg::Image* image, std::vector<PlanarMarkerCandidate>& candidates, bool includeUnmatched)
+{
+	candidates.clear();
+	if(!BuildPyramid(image)){return false;}
+
+	FindQuads(candidates);
+
+	if(_useParallel && _pool.valid() && candidates.size() > 1)
+	{
+		osg::ref_ptr<hogbox::TaskGroup> group = new hogbox::TaskGroup();
+		for(unsigned int i=0; i<candidates.size(); i++){
+			_pool->Submit(new CandidateTask(this, &candidates[i]), group.get());
+		}
+		_pool->Wait(group.get());
+	}else{
+		for(unsigned int i=0; i<candidates.size(); i++){
+			DecodeCandidate(candidates[i]);
+		}
+	}
+
+	std::vector<PlanarMarkerCandidate> matched;
+	for(unsigned int i=0; i<candidates.size(); i++){
+		MatchCandidate(candidates[i]);
+		if(includeUnmatched || candidates[i]._id >= 0){matched.push_back(candidates[i]);}
+	}
+	candidates.swap(matched);
+	return true;
+}
+
+//
+//Detect in p_image and update the tracked objects
+//
+void PlanarMarkerTracker::UpdateTracking()
+{
+	if(!p_image.valid()){return;}
+	if(!Detect(p_image.get(), _candidates)){return;}
+
+	//intrinsics for the frame size
+	if(!_cc.valid()){_cc = new CameraCalibration();}
+	if(_cc->GetWidth() != (int)_levels[0]._width || _cc->GetHeight() != (int)_levels[0]._height){
+		_cc->ChangeSize(_levels[0]._width, _levels[0]._height);
+	}
+
+	std::vector<std::pair<PlanarTrackedObject*, int> > objects;
+	for(unsigned int i=0; i<_trackedObjects.size(); i++)
+	{
+		PlanarTrackedObject* object = dynamic_cast<PlanarTrackedObject*>(_trackedObjects[i].get());
+		if(!object || !object->GetEnabled()){continue;}
+		std::map<const TrackedObject*, unsigned int>::iterator itr = _markerIds.find(object);
+		if(itr == _markerIds.end()){continue;}
+		objects.push_back(std::pair<PlanarTrackedObject*, int>(object, (*itr).second));
+	}
+
+	if(_useParallel && _pool.valid() && objects.size() > 1)
+	{
+		osg::ref_ptr<hogbox::TaskGroup> group = new hogbox::TaskGroup();
+		for(unsigned int i=0; i<objects.size(); i++){
+			_pool->Submit(new ObjectTask(this, objects[i].first, objects[i].second), group.get());
+		}
+		_pool->Wait(group.get());
+	}else{
+		for(unsigned int i=0; i<objects.size(); i++){
+			UpdateObject(objects[i].first, objects[i].second);
+		}
+	}
+}
+
+//
+//Update object from the largest candidate with its id
+//
+void PlanarMarkerTracker::UpdateObject(PlanarTrackedObject* object, int id)
+{
+	const PlanarMarkerCandidate* best = NULL;
+	for(unsigned int i=0; i<_candidates.size(); i++){
+		if(_candidates[i]._id == id && (!best || _candidates[i]._area > best->_area)){best = &_candidates[i];}
+	}
+	if(!best){
+		object->UpdateMarker(false, object->_poseMatrix);
+		return;
+	}
+
+	object->_corners.resize(4);
+	for(unsigned int c=0; c<4; c++){
+		object->_corners[c] = osg::Vec2(best->_corners[c].x(), best->_corners[c].y());
+	}
+	object->_direction = best->_rotation;
+	float confidence = best->_contrast * (1.0f - (float)best->_bitErrors / (float)(MARKER_BITS*MARKER_BITS));
+	object->_confidence = confidence > 1.0f ? 1.0f : confidence;
+	object->UpdateMarker(true, ComputePose(*best, object->GetWidth()));
+}
+
+//
+//Pose from the homography between the marker plane and the image
+//
+osg::Matrix PlanarMarkerTracker::ComputePose(const PlanarMarkerCandidate& candidate, float width)
+{
+	double fx = _cc->GetFocalLengthX();
+	double fy = _cc->GetFocalLengthY();
+	osg::Vec2d principal = _cc->GetPrincipalPoint();
+
+	//the calibration is kept at the frame size, so the corners can be undistorted
+	//straight onto the pinhole image
+	osg::Vec2d corners[4];
+	for(unsigned int i=0; i<4; i++){
+		corners[i] = _cc->HasDistortion() ? _cc->UndistortPoint(candidate._corners[i]) : candidate._corners[i];
+	}
+
+	//marker plane (x right, y up, centred) to the unit square, then to the image
+	double square[9];
+	SquareToQuad(corners, square);
+	double w = width > 0.0f ? width : 1.0;
+	double plane[9] = {1.0/w, 0.0, 0.5,
+						0.0, -1.0/w, 0.5,
+						0.0, 0.0, 1.0};
+	double h[9];
+	for(unsigned int r=0; r<3; r++){
+		for(unsigned int c=0; c<3; c++){
+			h[r*3+c] = square[r*3] * plane[c] + square[r*3+1] * plane[3+c] + square[r*3+2] * plane[6+c];
+		}
+	}
+
+	//remove the intrinsics, leaving the first two rotation columns and translation up to scale
+	osg::Vec3d columns[3];
+	for(unsigned int c=0; c<3; c++){
+		columns[c] = osg::Vec3d((h[c] - principal.x() * h[6+c]) / fx, (h[3+c] - principal.y() * h[6+c]) / fy, h[6+c]);
+	}
+	double lambda = 2.0 / (columns[0].length() + columns[1].length());
+	//the marker is in front of the camera
+	if(columns[2].z() * lambda < 0.0){lambda = -lambda;}
+	osg::Vec3d r1 = columns[0] * lambda;
+	osg::Vec3d r2 = columns[1] * lambda;
+	osg::Vec3d t = columns[2] * lambda;
+
+	//closest orthonormal pair, symmetric about the bisector of r1 and r2
+	osg::Vec3d r3 = r1 ^ r2;
+	r3.normalize();
+	osg::Vec3d a = r1 + r2;
+	a.normalize();
+	osg::Vec3d b = r3 ^ a;
+	b.normalize();
+	r1 = a - b;
+	r1.normalize();
+	r2 = a + b;
+	r2.normalize();
+	r3 = r1 ^ r2;
+
+	//camera frame (x right, y down, z forward) to osg's (y up, z back)
+	return osg::Matrix(r1.x(), -r1.y(), -r1.z(), 0.0,
+						r2.x(), -r2.y(), -r2.z(), 0.0,
+						r3.x(), -r3.y(), -r3.z(), 0.0,
+						t.x(), -t.y(), -t.z(), 1.0);
+}
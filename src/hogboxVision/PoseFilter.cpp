@@ -0,0 +1,472 @@
+#include <hogboxVision/PoseFilter.h>
+
+#include <osg/Notify>
+#include <osgDB/FileUtils>
+#include <osgDB/XmlParser>
+
+#include <math.h>
+#include <stdlib.h>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+using namespace hogboxVision;
+
+//
+//Angle in radians of the rotation between two quats
+//
+static double AngleBetween(const osg::Quat& from, const osg::Quat& to)
+{
+	osg::Quat delta = from.inverse() * to;
+	double w = fabs(delta.w());
+	if(w > 1.0){w = 1.0;}
+	return 2.0 * acos(w);
+}
+
+//
+//Smoothing factor of a first order low pass with cutoff in hz over dt seconds
+//
+static double LowPassAlpha(double cutoff, double dt)
+{
+	double tau = 1.0 / (2.0 * osg::PI * cutoff);
+	return 1.0 / (1.0 + tau / dt);
+}
+
+
+PoseFilter::PoseFilter()
+	: osg::Object()
+{
+}
+
+/** Copy constructor using CopyOp to manage deep vs shallow copy.*/
+PoseFilter::PoseFilter(const PoseFilter& filter,const osg::CopyOp& copyop)
+	: osg::Object(filter, copyop)
+{
+}
+
+PoseFilter::~PoseFilter(void)
+{
+}
+
+
+PoseFilterChain::PoseFilterChain()
+	: PoseFilter()
+{
+}
+
+//
+//Filters keep per object state so the copy always gets its own
+//
+PoseFilterChain::PoseFilterChain(const PoseFilterChain& chain,const osg::CopyOp& copyop)
+	: PoseFilter(chain, copyop)
+{
+	for(unsigned int i=0; i<chain._filters.size(); i++){
+		_filters.push_back(dynamic_cast<PoseFilter*>(chain._filters[i]->clone(osg::CopyOp::DEEP_COPY_ALL)));
+	}
+}
+
+PoseFilterChain::~PoseFilterChain(void)
+{
+	_filters.clear();
+}
+
+void PoseFilterChain::Apply(TrackedPoseSample& sample)
+{
+	for(unsigned int i=0; i<_filters.size(); i++){
+		_filters[i]->Apply(sample);
+	}
+}
+
+void PoseFilterChain::Reset()
+{
+	for(unsigned int i=0; i<_filters.size(); i++){
+		_filters[i]->Reset();
+	}
+}
+
+void PoseFilterChain::AddFilter(PoseFilter* filter)
+{
+	if(!filter){return;}
+	_filters.push_back(filter);
+}
+
+
+OutlierRejectionPoseFilter::OutlierRejectionPoseFilter(double maxDistance, double maxAngle, unsigned int maxRejections)
+	: PoseFilter(),
+	_maxDistance(maxDistance),
+	_maxAngle(maxAngle),
+	_maxRejections(maxRejections),
+	_hasLast(false),
+	_rejectionsInARow(0),
+	_numRejected(0)
+{
+}
+
+/** Copy constructor using CopyOp to manage deep vs shallow copy.*/
+OutlierRejectionPoseFilter::OutlierRejectionPoseFilter(const OutlierRejectionPoseFilter& filter,const osg::CopyOp& copyop)
+	: PoseFilter(filter, copyop),
+	_maxDistance(filter._maxDistance),
+	_maxAngle(filter._maxAngle),
+	_maxRejections(filter._maxRejections),
+	_hasLast(false),
+	_rejectionsInARow(0),
+	_numRejected(0)
+{
+}
+
+void OutlierRejectionPoseFilter::Apply(TrackedPoseSample& sample)
+{
+	if(!sample._isDetected){return;}
+
+	if(_hasLast && _rejectionsInARow < _maxRejections)
+	{
+		double distance = (sample._position - _lastPosition).length();
+		double angle = osg::RadiansToDegrees(AngleBetween(_lastRotation, sample._rotation));
+		if(distance > _maxDistance || angle > _maxAngle)
+		{
+			sample._isDetected = false;
+			sample._confidence = 0.0f;
+			_rejectionsInARow++;
+			_numRejected++;
+			return;
+		}
+	}
+
+	_hasLast = true;
+	_lastPosition = sample._position;
+	_lastRotation = sample._rotation;
+	_rejectionsInARow = 0;
+}
+
+void OutlierRejectionPoseFilter::Reset()
+{
+	_hasLast = false;
+	_rejectionsInARow = 0;
+}
+
+
+HoldPoseFilter::HoldPoseFilter(double maxHoldTime, double halfLife, double riseTime, double minConfidence)
+	: PoseFilter(),
+	_maxHoldTime(maxHoldTime),
+	_halfLife(halfLife),
+	_riseTime(riseTime),
+	_minConfidence(minConfidence),
+	_hasLast(false),
+	_lastDetectedTime(0.0),
+	_confidence(0.0)
+{
+}
+
+/** Copy constructor using CopyOp to manage deep vs shallow copy.*/
+HoldPoseFilter::HoldPoseFilter(const HoldPoseFilter& filter,const osg::CopyOp& copyop)
+	: PoseFilter(filter, copyop),
+	_maxHoldTime(filter._maxHoldTime),
+	_halfLife(filter._halfLife),
+	_riseTime(filter._riseTime),
+	_minConfidence(filter._minConfidence),
+	_hasLast(false),
+	_lastDetectedTime(0.0),
+	_confidence(0.0)
+{
+}
+
+void HoldPoseFilter::Apply(TrackedPoseSample& sample)
+{
+	double dt = _hasLast ? sample._time - _last._time : 0.0;
+	if(dt < 0.0){dt = 0.0;}
+
+	if(sample._isDetected)
+	{
+		//rise towards the measured confidence, straight there when first seen
+		double target = sample._confidence;
+		if(!_hasLast || _riseTime <= 0.0){
+			_confidence = target;
+		}else{
+			_confidence += (target - _confidence) * (1.0 - exp(-dt / _riseTime));
+		}
+		sample._confidence = (float)_confidence;
+
+		_hasLast = true;
+		_last = sample;
+		_lastDetectedTime = sample._time;
+		return;
+	}
+
+	if(!_hasLast){return;}
+
+	//decay and hold the last pose while we're still fairly sure it's there
+	_confidence *= _halfLife > 0.0 ? pow(0.5, dt / _halfLife) : 0.0;
+	_last._time = sample._time;
+
+	if(_confidence >= _minConfidence && sample._time - _lastDetectedTime <= _maxHoldTime)
+	{
+		sample._isDetected = true;
+		sample._confidence = (float)_confidence;
+		sample._pose = _last._pose;
+		sample._position = _last._position;
+		sample._rotation = _last._rotation;
+	}else{
+		sample._confidence = 0.0f;
+		Reset();
+	}
+}
+
+void HoldPoseFilter::Reset()
+{
+	_hasLast = false;
+	_confidence = 0.0;
+}
+
+
+ExponentialPoseFilter::ExponentialPoseFilter(double positionTimeConstant, double rotationTimeConstant)
+	: PoseFilter(),
+	_positionTimeConstant(positionTimeConstant),
+	_rotationTimeConstant(rotationTimeConstant),
+	_hasLast(false)
+{
+}
+
+/** Copy constructor using CopyOp to manage deep vs shallow copy.*/
+ExponentialPoseFilter::ExponentialPoseFilter(const ExponentialPoseFilter& filter,const osg::CopyOp& copyop)
+	: PoseFilter(filter, copyop),
+	_positionTimeConstant(filter._positionTimeConstant),
+	_rotationTimeConstant(filter._rotationTimeConstant),
+	_hasLast(false)
+{
+}
+
+void ExponentialPoseFilter::Apply(TrackedPoseSample& sample)
+{
+	if(!sample._isDetected){
+		Reset();
+		return;
+	}
+
+	if(_hasLast)
+	{
+		double dt = sample._time - _last._time;
+		if(dt < 0.0){dt = 0.0;}
+
+		if(_positionTimeConstant > 0.0){
+			double alpha = 1.0 - exp(-dt / _positionTimeConstant);
+			sample._position = _last._position + (sample._position - _last._position) * alpha;
+		}
+		if(_rotationTimeConstant > 0.0){
+			double alpha = 1.0 - exp(-dt / _rotationTimeConstant);
+			osg::Quat rotation;
+			rotation.slerp(alpha, _last._rotation, sample._rotation);
+			sample._rotation = rotation;
+		}
+	}
+
+	_hasLast = true;
+	_last = sample;
+}
+
+void ExponentialPoseFilter::Reset()
+{
+	_hasLast = false;
+}
+
+
+OneEuroPoseFilter::OneEuroPoseFilter(double minCutoff, double beta, double derivativeCutoff)
+	: PoseFilter(),
+	_minCutoff(minCutoff),
+	_beta(beta),
+	_derivativeCutoff(derivativeCutoff),
+	_angularScale(100.0),
+	_hasLast(false),
+	_angularSpeed(0.0)
+{
+}
+
+/** Copy constructor using CopyOp to manage deep vs shallow copy.*/
+OneEuroPoseFilter::OneEuroPoseFilter(const OneEuroPoseFilter& filter,const osg::CopyOp& copyop)
+	: PoseFilter(filter, copyop),
+	_minCutoff(filter._minCutoff),
+	_beta(filter._beta),
+	_derivativeCutoff(filter._derivativeCutoff),
+	_angularScale(filter._angularScale),
+	_hasLast(false),
+	_angularSpeed(0.0)
+{
+}
+
+void OneEuroPoseFilter::Apply(TrackedPoseSample& sample)
+{
+	if(!sample._isDetected){
+		Reset();
+		return;
+	}
+
+	double dt = _hasLast ? sample._time - _last._time : 0.0;
+	if(!_hasLast || dt <= 0.0)
+	{
+		//nothing to filter against (or a repeated time), start from here
+		if(!_hasLast){
+			_positionSpeed = osg::Vec3d();
+			_angularSpeed = 0.0;
+		}
+		_hasLast = true;
+		_last = sample;
+		return;
+	}
+
+	double derivativeAlpha = LowPassAlpha(_derivativeCutoff, dt);
+
+	//each position axis, cutoff rises with the filtered speed
+	for(unsigned int i=0; i<3; i++)
+	{
+		double speed = (sample._position[i] - _last._position[i]) / dt;
+		_positionSpeed[i] = _positionSpeed[i] + (speed - _positionSpeed[i]) * derivativeAlpha;
+		double cutoff = _minCutoff + _beta * fabs(_positionSpeed[i]);
+		double alpha = LowPassAlpha(cutoff, dt);
+		sample._position[i] = _last._position[i] + (sample._position[i] - _last._position[i]) * alpha;
+	}
+
+	//rotation through its angular speed
+	double speed = AngleBetween(_last._rotation, sample._rotation) / dt;
+	_angularSpeed = _angularSpeed + (speed - _angularSpeed) * derivativeAlpha;
+	double cutoff = _minCutoff + _beta * _angularSpeed * _angularScale;
+	osg::Quat rotation;
+	rotation.slerp(LowPassAlpha(cutoff, dt), _last._rotation, sample._rotation);
+	sample._rotation = rotation;
+
+	_last = sample;
+}
+
+void OneEuroPoseFilter::Reset()
+{
+	_hasLast = false;
+}
+
+
+//
+//Xml helpers
+//
+
+static double GetXmlDouble(osgDB::XmlNode* node, const std::string& name, double defaultValue)
+{
+	osgDB::XmlNode::Properties::iterator itr = node->properties.find(name);
+	if(itr == node->properties.end()){return defaultValue;}
+	return atof((*itr).second.c_str());
+}
+
+//
+//Build a PoseFilterChain from a <PoseFilter> node
+//
+PoseFilter* hogboxVision::ReadPoseFilterFromXml(osgDB::XmlNode* filterNode)
+{
+	if(!filterNode){return NULL;}
+
+	osg::ref_ptr<PoseFilterChain> chain = new PoseFilterChain();
+	for(osgDB::XmlNode::Children::iterator itr = filterNode->children.begin(); itr != filterNode->children.end(); ++itr)
+	{
+		osgDB::XmlNode* node = itr->get();
+		if(!node || node->name.empty()){continue;}
+
+		//each stage starts from its defaults, the node overrides any it lists
+		if(node->name == "OutlierRejection"){
+			OutlierRejectionPoseFilter* filter = new OutlierRejectionPoseFilter();
+			filter->_maxDistance = GetXmlDouble(node, "maxDistance", filter->_maxDistance);
+			filter->_maxAngle = GetXmlDouble(node, "maxAngle", filter->_maxAngle);
+			filter->_maxRejections = (unsigned int)GetXmlDouble(node, "maxRejections", filter->_maxRejections);
+			chain->AddFilter(filter);
+		}else if(node->name == "HoldPose"){
+			HoldPoseFilter* filter = new HoldPoseFilter();
+			filter->_maxHoldTime = GetXmlDouble(node, "maxHoldTime", filter->_maxHoldTime);
+			filter->_halfLife = GetXmlDouble(node, "halfLife", filter->_halfLife);
+			filter->_riseTime = GetXmlDouble(node, "riseTime", filter->_riseTime);
+			filter->_minConfidence = GetXmlDouble(node, "minConfidence", filter->_minConfidence);
+			chain->AddFilter(filter);
+		}else if(node->name == "OneEuro"){
+			OneEuroPoseFilter* filter = new OneEuroPoseFilter();
+			filter->_minCutoff = GetXmlDouble(node, "minCutoff", filter->_minCutoff);
+			filter->_beta = GetXmlDouble(node, "beta", filter->_beta);
+			filter->_derivativeCutoff = GetXmlDouble(node, "derivativeCutoff", filter->_derivativeCutoff);
+			filter->_angularScale = GetXmlDouble(node, "angularScale", filter->_angularScale);
+			chain->AddFilter(filter);
+		}else if(node->name == "Exponential"){
+			ExponentialPoseFilter* filter = new ExponentialPoseFilter();
+			filter->_positionTimeConstant = GetXmlDouble(node, "positionTimeConstant", filter->_positionTimeConstant);
+			filter->_rotationTimeConstant = GetXmlDouble(node, "rotationTimeConstant", filter->_rotationTimeConstant);
+			chain->AddFilter(filter);
+		}else if(node->name == "Slerp"){
+			chain->AddFilter(new ExponentialPoseFilter(0.0, GetXmlDouble(node, "timeConstant", 0.05)));
+		}else{
+			osg::notify(osg::WARN) << "ReadPoseFilterFromXml: WARN: Unknown pose filter '" << node->name << "', ignoring." << std::endl;
+		}
+	}
+	return chain.release();
+}
+
+PoseFilter* hogboxVision::ReadPoseFilterFromXmlFile(const std::string& fileName)
+{
+	std::string path = osgDB::findDataFile(fileName);
+	if(path.empty()){
+		osg::notify(osg::WARN) << "ReadPoseFilterFromXmlFile: ERROR: Could not find file '" << fileName << "'." << std::endl;
+		return NULL;
+	}
+
+	osg::ref_ptr<osgDB::XmlNode> doc = new osgDB::XmlNode;
+	osgDB::XmlNode::Input input;
+	input.open(path);
+	input.readAllDataIntoBuffer();
+	doc->read(input);
+
+	//find the filter node, the document itself may be it
+	osgDB::XmlNode* filterNode = doc->name == "PoseFilter" ? doc.get() : NULL;
+	for(osgDB::XmlNode::Children::iterator itr = doc->children.begin(); itr != doc->children.end() && !filterNode; ++itr){
+		if((*itr)->name == "PoseFilter"){filterNode = itr->get();}
+	}
+	if(!filterNode){
+		osg::notify(osg::WARN) << "ReadPoseFilterFromXmlFile: ERROR: File '" << path << "' must contain a <PoseFilter> node." << std::endl;
+		return NULL;
+	}
+	return ReadPoseFilterFromXml(filterNode);
+}
+
+//
+//Pose recordings
+//
+
+void hogboxVision::WritePoseSample(std::ostream& out, const TrackedPoseSample& sample)
+{
+	osg::Vec3d position = sample._pose.getTrans();
+	osg::Quat rotation = sample._pose.getRotate();
+	out << std::setprecision(9) << sample._time << " " << (sample._isDetected ? 1 : 0) << " " << sample._confidence << " "
+		<< position.x() << " " << position.y() << " " << position.z() << " "
+		<< rotation.x() << " " << rotation.y() << " " << rotation.z() << " " << rotation.w() << "\n";
+}
+
+bool hogboxVision::ReadPoseRecording(const std::string& fileName, std::vector<TrackedPoseSample>& samples)
+{
+	std::ifstream in(fileName.c_str());
+	if(!in.is_open()){
+		osg::notify(osg::WARN) << "ReadPoseRecording: ERROR: Failed to open pose recording '" << fileName << "'." << std::endl;
+		return false;
+	}
+
+	std::string line;
+	unsigned int lineNumber = 0;
+	while(std::getline(in, line))
+	{
+		lineNumber++;
+		if(line.empty() || line[0] == '#' || line[0] == '\r'){continue;}
+
+		std::istringstream values(line);
+		TrackedPoseSample sample;
+		int detected = 0;
+		double x, y, z, qx, qy, qz, qw;
+		if(!(values >> sample._time >> detected >> sample._confidence >> x >> y >> z >> qx >> qy >> qz >> qw)){
+			osg::notify(osg::WARN) << "ReadPoseRecording: ERROR: Bad sample on line " << lineNumber << " of '" << fileName << "'." << std::endl;
+			return false;
+		}
+		sample._isDetected = detected != 0;
+		sample._position = osg::Vec3d(x, y, z);
+		sample._rotation = osg::Quat(qx, qy, qz, qw);
+		sample._pose = osg::Matrix::rotate(sample._rotation) * osg::Matrix::translate(sample._position);
+		samples.push_back(sample);
+	}
+	return true;
+}
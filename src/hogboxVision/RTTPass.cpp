@@ -1,8 +1,13 @@
 #include <hogboxVision/RTTPass.h>
+#include <hogboxVision/RenderTargetPool.h>
+
+#include <hogbox/MemoryTracker.h>
+#include <hogbox/Profiler.h>
 
 #include <osgDB/FileUtils>
 #include <osgDB/ReadFile>
 #include <osg/Material>
+#include <osg/Depth>
 #include <osg/PolygonMode>
 
 #include <iostream>
@@ -50,6 +55,8 @@ RTTPass::RTTPass()
     _depthRender(false),
 	_outputWidth(0),
 	_outputHeight(0),
+	_outputInternalFormat(GL_RGBA),
+	_samples(0),
 	_requiredInputTextures(0),
 	_outputTextureCount(0),
 	_channelIndex(0)
@@ -87,6 +94,8 @@ bool RTTPass::Init(RTTArgs args)
     _depthRender = args.depthRender;
 	_outputWidth = args.outWidth;
 	_outputHeight = args.outHeight;
+	_outputInternalFormat = args.outputInternalFormat;
+	_samples = args.samples;
 	_requiredInputTextures = args.requiredInCount;
 	_outputTextureCount = args.requiredOutCount;
 	_channelIndex = args.startChannel;
@@ -94,24 +103,41 @@ bool RTTPass::Init(RTTArgs args)
     _rootGroup = new osg::Group;
    
 	//create output textures ready to be bound
-	//to the camera
-    createOutputTextures();
+	//to the camera, or use the ones provided
+	if(args.outputTextures.size() >= _outputTextureCount && _outputTextureCount > 0){
+		_outTextures.assign(args.outputTextures.begin(), args.outputTextures.begin()+_outputTextureCount);
+	}else{
+		createOutputTextures();
+	}
 
 	//default camera setup for screen algined rtt
     _camera = new osg::Camera;
 	_camera->setName("RttPass Camera");
     setupCamera();
 
+	//time the passes draw, on the cpu and the gpu where supported
+	HOGBOX_PROFILE_GPU_TIMER(_camera.get(), "RTTPass " + (this->getName().empty() ? std::string("(unnamed)") : this->getName()));
+
 	//if we have input textures create our screen alighned quad to render them full viewport
 	if(_requiredInputTextures > 0)
 	{
-		_videoQuad = new Ortho2DLayer(_outputWidth, _outputHeight, Ortho2DLayer::ORTHO_NESTED);
+		//all passes draw the pools unit quad, so project it over the whole viewport
+		_videoQuad = new osg::Geode();
+		_videoQuad->addDrawable(RenderTargetPool::Inst()->GetFullScreenQuad());
+		_camera->setProjectionMatrix(osg::Matrix::ortho2D(0, 1, 0, 1));
 		_camera->addChild(_videoQuad.get());
 		//ensure camera only creates a color buffer for fullscreen rtt and doesn't perform any clears
 		_camera->setImplicitBufferAttachmentMask(osg::DisplaySettings::IMPLICIT_COLOR_BUFFER_ATTACHMENT);
 		_camera->setClearMask(0);
 		_stateSet = _videoQuad->getOrCreateStateSet();
 
+		// diable depth read and write for fastest render
+		_stateSet->setMode(GL_CULL_FACE, osg::StateAttribute::ON);
+		_stateSet->setMode(GL_DEPTH_TEST,osg::StateAttribute::OFF);
+		osg::Depth* depth = new osg::Depth();
+		depth->setWriteMask(false);
+		_stateSet->setAttributeAndModes(depth);
+
 		//apply all the textures to the fsquads render stateset
 		for(SamplerToTextureMap::iterator it=args.inputTextures.begin(); it != args.inputTextures.end(); it++)
 		{
@@ -137,6 +163,10 @@ bool RTTPass::Init(RTTArgs args)
             program->addShader(new osg::Shader(osg::Shader::FRAGMENT, depthPassFragSource)); 
             _camera->getOrCreateStateSet()->setAttributeAndModes(program, osg::StateAttribute::ON);// | osg::StateAttribute::OVERRIDE);
         }
+
+		//rendering a scene the fbo also gets a 24 bit depth renderbuffer, multisampled with the color
+		unsigned long long depthBytes = (unsigned long long)_outputWidth * _outputHeight * 4 * (_samples > 0 ? _samples : 1);
+		hogbox::MemoryTracker::Inst()->Track(_camera.get(), hogbox::MemoryTracker::FRAME_BUFFER, 0, depthBytes, "", this->getName());
 	}
 
 	//attach the camera to the root
@@ -184,45 +214,30 @@ void RTTPass::setupCamera()
     for (unsigned int i=0; i<_outTextures.size(); i++) {
         //for now if we are using depthRender attach it to output 0
         if(_depthRender && i==0){
-            _camera->attach(osg::Camera::BufferComponent(osg::Camera::COLOR_BUFFER0), _outTextures[i].get());
+            _camera->attach(osg::Camera::BufferComponent(osg::Camera::COLOR_BUFFER0), _outTextures[i].get(), 0, 0, false, _samples);
         }else{
-            _camera->attach(osg::Camera::BufferComponent(osg::Camera::COLOR_BUFFER0+i), _outTextures[i].get());
+            _camera->attach(osg::Camera::BufferComponent(osg::Camera::COLOR_BUFFER0+i), _outTextures[i].get(), 0, 0, false, _samples);
         }
     }
 }
 
 //
 //createOutputTextures
-//Create a texture of the required output dimensions
-//for as many output Textures as we require and add to
-// the list _outTextures[]
+//Take a texture of the required output dimensions from
+//the RenderTargetPool for as many output Textures as we
+//require and add to the list _outTextures[]. They go back
+//to the pool once the pass releases them
 //
 void RTTPass::createOutputTextures()
 {
     for (unsigned int i=0; i<_outputTextureCount; i++) 
 	{	
-		TextureRef newTex = new TextureType();
+		TextureRef newTex = RenderTargetPool::Inst()->Acquire(_outputWidth, _outputHeight, _outputInternalFormat, _samples, this->getName());
 		_outTextures.push_back(newTex);
 
 		std::ostringstream samplerName;
 		samplerName << "rttTexture" << i;
 		_outTextures[i]->setName(samplerName.str());
-		
-		_outTextures[i]->setTextureSize(_outputWidth, _outputHeight);
-        //for now if we are using depthRender attach it to output 0
-        if(_depthRender && i==0){
-            //_outTextures[i]->setInternalFormat(GL_LUMINANCE);
-            _outTextures[i]->setInternalFormat(GL_RGBA);
-            //_outTextures[i]->setInternalFormat(GL_RGBA32F_ARB);
-            //_outTextures[i]->setSourceFormat(GL_RGBA);
-        }else{
-            _outTextures[i]->setInternalFormat(GL_RGBA);
-            //_outTextures[i]->setInternalFormat(GL_RGBA32F_ARB);
-            _outTextures[i]->setSourceFormat(GL_RGBA);            
-        }
-		_outTextures[i]->setFilter(osg::Texture2D::MIN_FILTER,osg::Texture2D::NEAREST);
-		_outTextures[i]->setFilter(osg::Texture2D::MAG_FILTER,osg::Texture2D::NEAREST);
-		_outTextures[i]->setResizeNonPowerOfTwoHint(false);
     }
 }
 
@@ -0,0 +1,754 @@
+#include <hogboxVision/RTTPassGraph.h>
+#include <hogboxVision/RenderTargetPool.h>
+
+#include <osg/GL>
+#include <osg/NodeCallback>
+#include <osg/Timer>
+#include <osg/Notify>
+#include <osgDB/FileUtils>
+#include <osgDB/XmlParser>
+#include <OpenThreads/ScopedLock>
+
+#include <limits.h>
+#include <stdlib.h>
+#include <sstream>
+
+using namespace hogboxVision;
+
+//
+//Calls Update on the graph once per frame from the update traversal
+//
+class RTTPassGraphUpdateCallback : public osg::NodeCallback
+{
+public:
+	RTTPassGraphUpdateCallback(RTTPassGraph* graph)
+		: osg::NodeCallback(),
+		_graph(graph)
+	{
+	}
+
+	virtual void operator()(osg::Node* node, osg::NodeVisitor* nv)
+	{
+		osg::ref_ptr<RTTPassGraph> graph = _graph.lock();
+		if(graph.valid()){graph->Update();}
+		traverse(node, nv);
+	}
+
+protected:
+	osg::observer_ptr<RTTPassGraph> _graph;
+};
+
+//
+//Start time of a pass, shared by its initial and final draw callbacks
+//
+class PassTimer : public osg::Referenced
+{
+public:
+	PassTimer() : osg::Referenced(), _startTick(0) {}
+	osg::Timer_t _startTick;
+};
+
+//
+//Times a pass camera on the draw thread
+//
+class RTTPassGraph::PassTimingCallback : public osg::Camera::DrawCallback
+{
+public:
+	PassTimingCallback(RTTPassGraph* graph, unsigned int pass, PassTimer* timer, bool start, bool finish)
+		: osg::Camera::DrawCallback(),
+		_graph(graph),
+		_pass(pass),
+		_timer(timer),
+		_start(start),
+		_finish(finish)
+	{
+	}
+
+	virtual void operator () (osg::RenderInfo& renderInfo) const
+	{
+		//wait for everything before (or in) the pass to complete
+		if(_finish){glFinish();}
+
+		if(_start){
+			_timer->_startTick = osg::Timer::instance()->tick();
+			return;
+		}
+
+		osg::ref_ptr<RTTPassGraph> graph = _graph.lock();
+		if(graph.valid()){
+			graph->RecordPassTime(_pass, osg::Timer::instance()->delta_m(_timer->_startTick, osg::Timer::instance()->tick()));
+		}
+	}
+
+protected:
+	osg::observer_ptr<RTTPassGraph> _graph;
+	unsigned int _pass;
+	osg::ref_ptr<PassTimer> _timer;
+	bool _start;
+	bool _finish;
+};
+
+
+RTTPassGraph::RTTPassGraph()
+	: osg::Object(),
+	_aliasTextures(true),
+	_skipUnchanged(true),
+	_compiled(false),
+	_root(new osg::Group()),
+	_timingMode(NO_TIMING)
+{
+	_root->setName("RTTPassGraph Root");
+	_root->setUpdateCallback(new RTTPassGraphUpdateCallback(this));
+}
+
+/** Copy constructor using CopyOp to manage deep vs shallow copy.*/
+RTTPassGraph::RTTPassGraph(const RTTPassGraph& graph,const osg::CopyOp& copyop)
+	: osg::Object(graph, copyop),
+	_passDescs(graph._passDescs),
+	_externalInputs(graph._externalInputs),
+	_graphOutputs(graph._graphOutputs),
+	_aliasTextures(graph._aliasTextures),
+	_skipUnchanged(graph._skipUnchanged),
+	_compiled(false),
+	_root(new osg::Group()),
+	_timingMode(graph._timingMode)
+{
+	_root->setName("RTTPassGraph Root");
+	_root->setUpdateCallback(new RTTPassGraphUpdateCallback(this));
+}
+
+RTTPassGraph::~RTTPassGraph()
+{
+	_root->setUpdateCallback(NULL);
+	_root->removeChildren(0, _root->getNumChildren());
+	_passes.clear();
+}
+
+//
+//Declare a pass
+//
+bool RTTPassGraph::AddPass(const PassDesc& pass)
+{
+	if(pass._name.empty() || FindPass(pass._name) != -1){
+		osg::notify(osg::WARN) << "RTTPassGraph::AddPass: ERROR: Passes need a unique name, '" << pass._name << "' is empty or already used." << std::endl;
+		return false;
+	}
+	_passDescs.push_back(pass);
+	_compiled = false;
+	return true;
+}
+
+bool RTTPassGraph::AddGraphOutput(const std::string& name, const std::string& pass, int output)
+{
+	int index = FindPass(pass);
+	if(index == -1 || output < 0 || output >= _passDescs[index]._outputCount){
+		osg::notify(osg::WARN) << "RTTPassGraph::AddGraphOutput: ERROR: Pass '" << pass << "' has no output " << output << "." << std::endl;
+		return false;
+	}
+	_graphOutputs[name] = std::pair<int, int>(index, output);
+	_compiled = false;
+	return true;
+}
+
+//
+//Set the texture read by inputs with source name
+//
+void RTTPassGraph::SetExternalInput(const std::string& name, RTTPass::TextureType* texture)
+{
+	_externalInputs[name] = texture;
+	_externalImageCounts.erase(name);
+	if(!_compiled){return;}
+
+	//rebind on the passes reading it, channels follow the sampler order used by RTTPass::Init
+	for(unsigned int p=0; p<_passDescs.size(); p++)
+	{
+		std::map<std::string, std::string> samplerSources;
+		for(unsigned int i=0; i<_passDescs[p]._inputs.size(); i++){
+			samplerSources[_passDescs[p]._inputs[i]._sampler] = _passDescs[p]._inputs[i]._source;
+		}
+		int channel = 0;
+		for(std::map<std::string, std::string>::iterator itr=samplerSources.begin(); itr!=samplerSources.end(); itr++, channel++){
+			if((*itr).second == name){
+				_passes[p]->setInputTexture(channel, texture, (*itr).first);
+				_dirty[p] = true;
+			}
+		}
+	}
+}
+
+int RTTPassGraph::FindPass(const std::string& name)const
+{
+	for(unsigned int i=0; i<_passDescs.size(); i++){
+		if(_passDescs[i]._name == name){return (int)i;}
+	}
+	return -1;
+}
+
+void RTTPassGraph::MarkPassDirty(const std::string& pass)
+{
+	int index = FindPass(pass);
+	if(index != -1 && index < (int)_dirty.size()){_dirty[index] = true;}
+}
+
+//
+//Kahn sort, among the passes ready to run the first declared goes first so
+//independent passes keep their declaration order
+//
+bool RTTPassGraph::SortPasses()
+{
+	unsigned int numPasses = _passDescs.size();
+	std::vector<unsigned int> waitingOn(numPasses, 0);
+	std::vector<std::vector<unsigned int> > consumers(numPasses);
+
+	for(unsigned int p=0; p<numPasses; p++)
+	{
+		for(unsigned int i=0; i<_passDescs[p]._inputs.size(); i++)
+		{
+			int source = FindPass(_passDescs[p]._inputs[i]._source);
+			if(source == -1){continue;}
+			waitingOn[p]++;
+			consumers[source].push_back(p);
+		}
+	}
+
+	_orderIndices.clear();
+	_executionOrder.clear();
+	std::vector<bool> done(numPasses, false);
+	while(_orderIndices.size() < numPasses)
+	{
+		int next = -1;
+		for(unsigned int p=0; p<numPasses && next==-1; p++){
+			if(!done[p] && waitingOn[p] == 0){next = (int)p;}
+		}
+		if(next == -1)
+		{
+			osg::notify(osg::WARN) << "RTTPassGraph::SortPasses: ERROR: The passes contain a cycle, passes involved:";
+			for(unsigned int p=0; p<numPasses; p++){
+				if(!done[p]){osg::notify(osg::WARN) << " '" << _passDescs[p]._name << "'";}
+			}
+			osg::notify(osg::WARN) << std::endl;
+			return false;
+		}
+
+		done[next] = true;
+		_orderIndices.push_back(next);
+		_executionOrder.push_back(_passDescs[next]._name);
+		for(unsigned int c=0; c<consumers[next].size(); c++){
+			waitingOn[consumers[next][c]]--;
+		}
+	}
+	return true;
+}
+
+//
+//Take a texture from the pool, as RTTPass does
+//
+static RTTPass::TextureRef CreatePassTexture(int width, int height, unsigned int index, const std::string& owner)
+{
+	RTTPass::TextureRef texture = RenderTargetPool::Inst()->Acquire(width, height, GL_RGBA, 0, owner);
+	std::ostringstream name;
+	name << "rttGraphTexture" << index;
+	texture->setName(name.str());
+	return texture;
+}
+
+//
+//A texture in use and the last execution position it's read at
+//
+struct LiveTexture
+{
+	RTTPass::TextureRef _texture;
+	int _lastUse;
+};
+
+//
+//Assign a texture to every pass output. An output lives from the pass writing it
+//to the last pass reading it (graph outputs to the end of the frame), once its
+//lifetime ends the texture can be written by a later pass of the same size
+//
+void RTTPassGraph::AllocateTextures()
+{
+	unsigned int numPasses = _passDescs.size();
+	_passOutputs.assign(numPasses, std::vector<RTTPass::TextureRef>());
+	_allocatedTextures.clear();
+
+	//position of each pass in the execution order
+	std::vector<int> position(numPasses, 0);
+	for(unsigned int i=0; i<_orderIndices.size(); i++){
+		position[_orderIndices[i]] = (int)i;
+	}
+
+	//last position each output is read at
+	std::vector<std::vector<int> > lastUse(numPasses);
+	for(unsigned int p=0; p<numPasses; p++){
+		lastUse[p].assign(_passDescs[p]._outputCount, position[p]);
+	}
+	for(unsigned int p=0; p<numPasses; p++)
+	{
+		for(unsigned int i=0; i<_passDescs[p]._inputs.size(); i++){
+			const PassInput& input = _passDescs[p]._inputs[i];
+			int source = FindPass(input._source);
+			if(source != -1 && position[p] > lastUse[source][input._output]){
+				lastUse[source][input._output] = position[p];
+			}
+		}
+	}
+	for(std::map<std::string, std::pair<int, int> >::iterator itr=_graphOutputs.begin(); itr!=_graphOutputs.end(); itr++){
+		lastUse[(*itr).second.first][(*itr).second.second] = INT_MAX;
+	}
+
+	std::vector<LiveTexture> live;
+	std::vector<RTTPass::TextureRef> freeTextures;
+
+	for(unsigned int pos=0; pos<_orderIndices.size(); pos++)
+	{
+		unsigned int p = _orderIndices[pos];
+		const PassDesc& desc = _passDescs[p];
+
+		//textures whose last read came before this pass can be written again
+		for(unsigned int l=0; l<live.size(); ){
+			if(live[l]._lastUse < (int)pos){
+				freeTextures.push_back(live[l]._texture);
+				live.erase(live.begin()+l);
+			}else{
+				l++;
+			}
+		}
+
+		for(int o=0; o<desc._outputCount; o++)
+		{
+			RTTPass::TextureRef texture;
+			if(_aliasTextures)
+			{
+				for(unsigned int f=0; f<freeTextures.size(); f++){
+					if(freeTextures[f]->getTextureWidth() == desc._width && freeTextures[f]->getTextureHeight() == desc._height){
+						texture = freeTextures[f];
+						freeTextures.erase(freeTextures.begin()+f);
+						break;
+					}
+				}
+			}
+			if(!texture.valid()){
+				texture = CreatePassTexture(desc._width, desc._height, _allocatedTextures.size(), this->getName());
+				_allocatedTextures.push_back(texture);
+			}
+
+			_passOutputs[p].push_back(texture);
+			LiveTexture entry;
+			entry._texture = texture;
+			entry._lastUse = lastUse[p][o];
+			live.push_back(entry);
+		}
+	}
+}
+
+//
+//Order the passes, allocate the textures and build the scene graph
+//
+bool RTTPassGraph::Compile()
+{
+	//hand the old textures back to the pool before allocating
+	ClearCompiled();
+
+	//check every input can be resolved
+	for(unsigned int p=0; p<_passDescs.size(); p++)
+	{
+		const PassDesc& desc = _passDescs[p];
+		if(desc._inputs.empty()){
+			osg::notify(osg::WARN) << "RTTPassGraph::Compile: ERROR: Pass '" << desc._name << "' has no inputs." << std::endl;
+			ClearCompiled();
+			return false;
+		}
+		if(desc._outputCount < 1 || desc._width < 1 || desc._height < 1){
+			osg::notify(osg::WARN) << "RTTPassGraph::Compile: ERROR: Pass '" << desc._name << "' needs at least one output with a valid size." << std::endl;
+			ClearCompiled();
+			return false;
+		}
+		for(unsigned int i=0; i<desc._inputs.size(); i++)
+		{
+			const PassInput& input = desc._inputs[i];
+			int source = FindPass(input._source);
+			if(source != -1){
+				if(input._output < 0 || input._output >= _passDescs[source]._outputCount){
+					osg::notify(osg::WARN) << "RTTPassGraph::Compile: ERROR: Pass '" << desc._name << "' reads output " << input._output << " of '" << input._source << "' which doesn't exist." << std::endl;
+					ClearCompiled();
+			return false;
+				}
+			}else if(_externalInputs.find(input._source) == _externalInputs.end()){
+				osg::notify(osg::WARN) << "RTTPassGraph::Compile: ERROR: Pass '" << desc._name << "' reads '" << input._source << "' which is neither a pass nor an external input." << std::endl;
+				ClearCompiled();
+			return false;
+			}
+		}
+	}
+
+	if(!SortPasses()){
+		ClearCompiled();
+		return false;
+	}
+	AllocateTextures();
+
+	unsigned int numPasses = _passDescs.size();
+	_passes.assign(numPasses, RTTPassPtr());
+	for(unsigned int pos=0; pos<_orderIndices.size(); pos++)
+	{
+		unsigned int p = _orderIndices[pos];
+		const PassDesc& desc = _passDescs[p];
+
+		RTTPass::RTTArgs args;
+		args.clearColor = desc._clearColor;
+		args.outWidth = desc._width;
+		args.outHeight = desc._height;
+		args.requiredOutCount = desc._outputCount;
+		args.requiredInCount = desc._inputs.size();
+		args.fragmentShaderFile = desc._fragmentShader;
+		args.vertexShaderFile = desc._vertexShader;
+		args.shaderFileIsSource = desc._shaderFileIsSource;
+		args.outputTextures = _passOutputs[p];
+		for(unsigned int i=0; i<desc._inputs.size(); i++)
+		{
+			const PassInput& input = desc._inputs[i];
+			int source = FindPass(input._source);
+			RTTPass::TextureRef texture = source != -1 ? _passOutputs[source][input._output] : _externalInputs[input._source];
+			args.inputTextures[input._sampler] = texture;
+		}
+
+		RTTPassPtr pass = new RTTPass();
+		pass->setName(desc._name);
+		if(!pass->Init(args)){
+			osg::notify(osg::WARN) << "RTTPassGraph::Compile: ERROR: Failed to init pass '" << desc._name << "'." << std::endl;
+			ClearCompiled();
+			return false;
+		}
+		for(unsigned int u=0; u<desc._uniforms.size(); u++){
+			pass->addInputUniform(desc._uniforms[u].get(), 0, 1);
+		}
+
+		//render in execution order
+		pass->getRTTCamera()->setRenderOrder(osg::Camera::PRE_RENDER, pos);
+		_root->addChild(pass->getRoot().get());
+		_passes[p] = pass;
+	}
+
+	//everything renders on the first frame
+	_dirty.assign(numPasses, true);
+	_renderedThisFrame.assign(numPasses, false);
+	_uniformCounts.assign(numPasses, std::vector<unsigned int>());
+	for(unsigned int p=0; p<numPasses; p++){
+		for(unsigned int u=0; u<_passDescs[p]._uniforms.size(); u++){
+			_uniformCounts[p].push_back(_passDescs[p]._uniforms[u]->getModifiedCount());
+		}
+	}
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_statsMutex);
+		_stats.assign(numPasses, RTTPassStats());
+	}
+
+	_compiled = true;
+	SetTimingMode(_timingMode);
+
+	osg::notify(osg::INFO) << "RTTPassGraph::Compile: INFO: " << numPasses << " passes, " << GetNumPassOutputs()
+							<< " outputs sharing " << _allocatedTextures.size() << " textures." << std::endl;
+	return true;
+}
+
+//
+//Remove everything Compile built
+//
+void RTTPassGraph::ClearCompiled()
+{
+	_compiled = false;
+	_root->removeChildren(0, _root->getNumChildren());
+	_passes.clear();
+	_executionOrder.clear();
+	_orderIndices.clear();
+	_passOutputs.clear();
+	_allocatedTextures.clear();
+	_lastWriter.clear();
+	_externalImageCounts.clear();
+	_dirty.clear();
+	_renderedThisFrame.clear();
+	_uniformCounts.clear();
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_statsMutex);
+	_stats.clear();
+}
+
+RTTPass* RTTPassGraph::GetPass(const std::string& name)
+{
+	int index = FindPass(name);
+	if(index == -1 || index >= (int)_passes.size()){return NULL;}
+	return _passes[index].get();
+}
+
+RTTPass::TextureType* RTTPassGraph::GetOutputTexture(const std::string& name)
+{
+	std::map<std::string, std::pair<int, int> >::iterator itr = _graphOutputs.find(name);
+	if(itr == _graphOutputs.end() || !_compiled){return NULL;}
+	return _passOutputs[(*itr).second.first][(*itr).second.second].get();
+}
+
+unsigned int RTTPassGraph::GetNumPassOutputs()const
+{
+	unsigned int count = 0;
+	for(unsigned int p=0; p<_passOutputs.size(); p++){
+		count += _passOutputs[p].size();
+	}
+	return count;
+}
+
+//
+//Attach or remove the timing draw callbacks
+//
+void RTTPassGraph::SetTimingMode(const TimingMode& mode)
+{
+	_timingMode = mode;
+	if(!_compiled){return;}
+
+	for(unsigned int p=0; p<_passes.size(); p++)
+	{
+		osg::Camera* camera = _passes[p]->getRTTCamera();
+		if(_timingMode == NO_TIMING){
+			camera->setInitialDrawCallback(NULL);
+			camera->setFinalDrawCallback(NULL);
+		}else{
+			bool finish = _timingMode == GPU_FINISH_TIMING;
+			osg::ref_ptr<PassTimer> timer = new PassTimer();
+			camera->setInitialDrawCallback(new PassTimingCallback(this, p, timer.get(), true, finish));
+			camera->setFinalDrawCallback(new PassTimingCallback(this, p, timer.get(), false, finish));
+		}
+	}
+}
+
+void RTTPassGraph::RecordPassTime(unsigned int pass, double ms)
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_statsMutex);
+	if(pass >= _stats.size()){return;}
+	RTTPassStats& stats = _stats[pass];
+	//smooth over roughly the last 16 frames
+	stats._averageMs = stats._lastMs == 0.0 && stats._averageMs == 0.0 ? ms : stats._averageMs + (ms - stats._averageMs) * (1.0/16.0);
+	stats._lastMs = ms;
+}
+
+RTTPassStats RTTPassGraph::GetPassStats(const std::string& pass)
+{
+	int index = FindPass(pass);
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_statsMutex);
+	if(index == -1 || index >= (int)_stats.size()){return RTTPassStats();}
+	return _stats[index];
+}
+
+//
+//Decide which passes render this frame. A pass renders if it's been marked
+//dirty, reads a pass that renders this frame, reads an external texture whose
+//image has changed, has a modified uniform, or another pass has written one
+//of its (aliased) output textures since it last rendered
+//
+void RTTPassGraph::Update()
+{
+	if(!_compiled){return;}
+
+	//which external inputs have new images
+	std::map<std::string, bool> externalChanged;
+	for(std::map<std::string, RTTPass::TextureRef>::iterator itr=_externalInputs.begin(); itr!=_externalInputs.end(); itr++)
+	{
+		osg::Image* image = (*itr).second.valid() ? (*itr).second->getImage() : NULL;
+		if(!image){
+			//written on the gpu by something else, assume it changes every frame
+			externalChanged[(*itr).first] = true;
+			continue;
+		}
+		std::map<std::string, unsigned int>::iterator count = _externalImageCounts.find((*itr).first);
+		externalChanged[(*itr).first] = count == _externalImageCounts.end() || (*count).second != image->getModifiedCount();
+		_externalImageCounts[(*itr).first] = image->getModifiedCount();
+	}
+
+	_renderedThisFrame.assign(_passDescs.size(), false);
+	unsigned int rendered = 0;
+
+	for(unsigned int pos=0; pos<_orderIndices.size(); pos++)
+	{
+		unsigned int p = _orderIndices[pos];
+		const PassDesc& desc = _passDescs[p];
+
+		bool render = _dirty[p] || !_skipUnchanged || desc._alwaysRender;
+
+		for(unsigned int i=0; i<desc._inputs.size() && !render; i++){
+			int source = FindPass(desc._inputs[i]._source);
+			render = source != -1 ? _renderedThisFrame[source] : externalChanged[desc._inputs[i]._source];
+		}
+		for(unsigned int u=0; u<desc._uniforms.size(); u++){
+			unsigned int count = desc._uniforms[u]->getModifiedCount();
+			if(count != _uniformCounts[p][u]){
+				render = true;
+				_uniformCounts[p][u] = count;
+			}
+		}
+		for(unsigned int o=0; o<_passOutputs[p].size() && !render; o++){
+			std::map<RTTPass::TextureType*, int>::iterator writer = _lastWriter.find(_passOutputs[p][o].get());
+			render = writer == _lastWriter.end() || (*writer).second != (int)p;
+		}
+
+		_passes[p]->getRoot()->setNodeMask(render ? 0xffffffff : 0x0);
+		_dirty[p] = false;
+		_renderedThisFrame[p] = render;
+		if(render)
+		{
+			rendered++;
+			for(unsigned int o=0; o<_passOutputs[p].size(); o++){
+				_lastWriter[_passOutputs[p][o].get()] = (int)p;
+			}
+		}
+	}
+
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_statsMutex);
+	for(unsigned int p=0; p<_stats.size(); p++){
+		if(_renderedThisFrame[p]){_stats[p]._renderedFrames++;}
+		else{_stats[p]._skippedFrames++;}
+	}
+}
+
+//
+//Xml helpers
+//
+
+static bool GetXmlProperty(osgDB::XmlNode* node, const std::string& name, std::string& value)
+{
+	osgDB::XmlNode::Properties::iterator itr = node->properties.find(name);
+	if(itr == node->properties.end()){return false;}
+	value = (*itr).second;
+	return true;
+}
+
+static int GetXmlIntProperty(osgDB::XmlNode* node, const std::string& name, int defaultValue)
+{
+	std::string value;
+	if(!GetXmlProperty(node, name, value)){return defaultValue;}
+	return atoi(value.c_str());
+}
+
+//
+//<Uniform name="gain" type="float">1.5</Uniform>, types are float, int, bool, vec2, vec3 and vec4
+//
+static osg::Uniform* ReadXmlUniform(osgDB::XmlNode* node)
+{
+	std::string name, type;
+	if(!GetXmlProperty(node, "name", name)){return NULL;}
+	if(!GetXmlProperty(node, "type", type)){type = "float";}
+
+	std::istringstream values(node->contents);
+	float v[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+	for(unsigned int i=0; i<4; i++){values >> v[i];}
+
+	if(type == "float"){return new osg::Uniform(name.c_str(), v[0]);}
+	if(type == "int"){return new osg::Uniform(name.c_str(), (int)v[0]);}
+	if(type == "bool"){return new osg::Uniform(name.c_str(), v[0] != 0.0f);}
+	if(type == "vec2"){return new osg::Uniform(name.c_str(), osg::Vec2(v[0], v[1]));}
+	if(type == "vec3"){return new osg::Uniform(name.c_str(), osg::Vec3(v[0], v[1], v[2]));}
+	if(type == "vec4"){return new osg::Uniform(name.c_str(), osg::Vec4(v[0], v[1], v[2], v[3]));}
+
+	osg::notify(osg::WARN) << "RTTPassGraph: WARN: Unknown uniform type '" << type << "' for uniform '" << name << "'." << std::endl;
+	return NULL;
+}
+
+//
+//Read the passes, outputs and settings from an <RTTPassGraph> node
+//
+bool RTTPassGraph::ReadFromXml(osgDB::XmlNode* graphNode)
+{
+	if(!graphNode){return false;}
+
+	std::string name;
+	if(GetXmlProperty(graphNode, "name", name)){setName(name);}
+	_aliasTextures = GetXmlIntProperty(graphNode, "aliasTextures", _aliasTextures ? 1 : 0) != 0;
+	_skipUnchanged = GetXmlIntProperty(graphNode, "skipUnchanged", _skipUnchanged ? 1 : 0) != 0;
+
+	//outputs are added after the passes so they can name any pass
+	std::vector<osgDB::XmlNode*> outputNodes;
+
+	for(osgDB::XmlNode::Children::iterator itr = graphNode->children.begin(); itr != graphNode->children.end(); ++itr)
+	{
+		osgDB::XmlNode* child = itr->get();
+		if(!child){continue;}
+
+		if(child->name == "Output"){
+			outputNodes.push_back(child);
+			continue;
+		}
+		if(child->name != "Pass"){continue;}
+
+		PassDesc pass;
+		GetXmlProperty(child, "name", pass._name);
+		pass._width = GetXmlIntProperty(child, "width", pass._width);
+		pass._height = GetXmlIntProperty(child, "height", pass._height);
+		pass._outputCount = GetXmlIntProperty(child, "outputs", pass._outputCount);
+		pass._alwaysRender = GetXmlIntProperty(child, "alwaysRender", 0) != 0;
+
+		for(osgDB::XmlNode::Children::iterator pitr = child->children.begin(); pitr != child->children.end(); ++pitr)
+		{
+			osgDB::XmlNode* passChild = pitr->get();
+			if(!passChild){continue;}
+
+			if(passChild->name == "FragmentShader"){
+				pass._fragmentShader = passChild->contents;
+				pass._shaderFileIsSource = GetXmlIntProperty(passChild, "isSource", 0) != 0;
+			}else if(passChild->name == "VertexShader"){
+				pass._vertexShader = passChild->contents;
+				pass._shaderFileIsSource = GetXmlIntProperty(passChild, "isSource", 0) != 0;
+			}else if(passChild->name == "ClearColor"){
+				std::istringstream values(passChild->contents);
+				values >> pass._clearColor.x() >> pass._clearColor.y() >> pass._clearColor.z() >> pass._clearColor.w();
+			}else if(passChild->name == "Input"){
+				PassInput input;
+				GetXmlProperty(passChild, "sampler", input._sampler);
+				GetXmlProperty(passChild, "source", input._source);
+				input._output = GetXmlIntProperty(passChild, "output", 0);
+				if(input._sampler.empty() || input._source.empty()){
+					osg::notify(osg::WARN) << "RTTPassGraph::ReadFromXml: ERROR: Input of pass '" << pass._name << "' needs 'sampler' and 'source' properties." << std::endl;
+					return false;
+				}
+				pass._inputs.push_back(input);
+			}else if(passChild->name == "Uniform"){
+				osg::Uniform* uniform = ReadXmlUniform(passChild);
+				if(uniform){pass._uniforms.push_back(uniform);}
+			}
+		}
+
+		if(!AddPass(pass)){return false;}
+	}
+
+	for(unsigned int i=0; i<outputNodes.size(); i++)
+	{
+		std::string outputName, source;
+		GetXmlProperty(outputNodes[i], "name", outputName);
+		GetXmlProperty(outputNodes[i], "source", source);
+		if(outputName.empty()){outputName = source;}
+		if(!AddGraphOutput(outputName, source, GetXmlIntProperty(outputNodes[i], "output", 0))){return false;}
+	}
+	return true;
+}
+
+bool RTTPassGraph::ReadFromXmlFile(const std::string& fileName)
+{
+	std::string path = osgDB::findDataFile(fileName);
+	if(path.empty()){
+		osg::notify(osg::WARN) << "RTTPassGraph::ReadFromXmlFile: ERROR: Could not find file '" << fileName << "'." << std::endl;
+		return false;
+	}
+
+	osg::ref_ptr<osgDB::XmlNode> doc = new osgDB::XmlNode;
+	osgDB::XmlNode::Input input;
+	input.open(path);
+	input.readAllDataIntoBuffer();
+	doc->read(input);
+
+	//find the graph node, the document itself may be it
+	osgDB::XmlNode* graphNode = doc->name == "RTTPassGraph" ? doc.get() : NULL;
+	for(osgDB::XmlNode::Children::iterator itr = doc->children.begin(); itr != doc->children.end() && !graphNode; ++itr){
+		if((*itr)->name == "RTTPassGraph"){graphNode = itr->get();}
+	}
+	if(!graphNode){
+		osg::notify(osg::WARN) << "RTTPassGraph::ReadFromXmlFile: ERROR: File '" << path << "' must contain an <RTTPassGraph> node." << std::endl;
+		return false;
+	}
+	return ReadFromXml(graphNode);
+}
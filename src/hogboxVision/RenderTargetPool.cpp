@@ -0,0 +1,194 @@
+#include <hogboxVision/RenderTargetPool.h>
+
+#include <hogbox/MemoryTracker.h>
+
+#include <osg/Notify>
+#include <OpenThreads/ScopedLock>
+
+using namespace hogboxVision;
+
+static osg::ref_ptr<RenderTargetPool> s_hogboxRenderTargetPoolInstance = NULL;
+
+RenderTargetPool* RenderTargetPool::Inst(bool erase)
+{
+	if(s_hogboxRenderTargetPoolInstance==NULL)
+	{s_hogboxRenderTargetPoolInstance = new RenderTargetPool();}
+	if(erase)
+	{
+		s_hogboxRenderTargetPoolInstance = 0;
+	}
+	return s_hogboxRenderTargetPoolInstance.get();
+}
+
+RenderTargetPool::RenderTargetPool()
+	: osg::Referenced()
+{
+}
+
+RenderTargetPool::~RenderTargetPool(void)
+{
+	OSG_NOTICE << "    Deallocating RenderTargetPool: " << _stats._numTargets << " targets, high water mark " << _stats._highWaterMark << "." << std::endl;
+	_targets.clear();
+	_quad = NULL;
+}
+
+//
+//Get a free target matching the key or create one
+//
+RenderTargetPool::TextureRef RenderTargetPool::Acquire(int width, int height, GLint internalFormat, unsigned int samples,
+														const std::string& owner)
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+
+	Key key(width, height, internalFormat, samples);
+	std::vector<TextureRef>& targets = _targets[key];
+
+	//a target only the pool references is free
+	TextureRef texture;
+	for(unsigned int i=0; i<targets.size(); i++)
+	{
+		if(targets[i]->referenceCount() == 1){
+			texture = targets[i];
+			_stats._numReused++;
+			break;
+		}
+	}
+
+	if(!texture.valid())
+	{
+		texture = new TextureType();
+		texture->setTextureSize(width, height);
+		texture->setInternalFormat(internalFormat);
+		texture->setSourceFormat(GL_RGBA);
+		texture->setResizeNonPowerOfTwoHint(false);
+		targets.push_back(texture);
+		_stats._numCreated++;
+	}
+
+	//back to the defaults RTTPass has always used
+	texture->setFilter(osg::Texture2D::MIN_FILTER,osg::Texture2D::NEAREST);
+	texture->setFilter(osg::Texture2D::MAG_FILTER,osg::Texture2D::NEAREST);
+
+	hogbox::MemoryTracker::Inst()->Track(texture.get(), hogbox::MemoryTracker::RENDER_TARGET, 0, GetTargetBytes(key),
+										"", owner.empty() ? std::string("RenderTargetPool") : owner);
+
+	//texture holds a ref for the caller, so it's counted as in use
+	UpdateUsage();
+	return texture;
+}
+
+//
+//Delete free targets, keeping up to maxFreePerKey of each key
+//
+unsigned int RenderTargetPool::TrimFree(unsigned int maxFreePerKey)
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+
+	unsigned int deleted = 0;
+	for(TargetMap::iterator itr=_targets.begin(); itr!=_targets.end(); )
+	{
+		std::vector<TextureRef>& targets = (*itr).second;
+		unsigned int kept = 0;
+		for(unsigned int i=0; i<targets.size(); )
+		{
+			if(targets[i]->referenceCount() == 1 && kept++ >= maxFreePerKey){
+				targets.erase(targets.begin()+i);
+				deleted++;
+			}else{
+				i++;
+			}
+		}
+		if(targets.empty()){
+			_targets.erase(itr++);
+		}else{
+			itr++;
+		}
+	}
+	UpdateUsage();
+	return deleted;
+}
+
+RenderTargetPoolStats RenderTargetPool::GetStats()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+	UpdateUsage();
+	return _stats;
+}
+
+void RenderTargetPool::ResetHighWaterMarks()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+	UpdateUsage();
+	_stats._highWaterMark = _stats._numInUse;
+	_stats._bytesHighWaterMark = _stats._bytesAllocated;
+}
+
+//
+//Count the targets in use and update the high water marks
+//
+void RenderTargetPool::UpdateUsage()
+{
+	_stats._numTargets = 0;
+	_stats._numInUse = 0;
+	_stats._bytesAllocated = 0;
+	for(TargetMap::iterator itr=_targets.begin(); itr!=_targets.end(); itr++)
+	{
+		const std::vector<TextureRef>& targets = (*itr).second;
+		for(unsigned int i=0; i<targets.size(); i++){
+			if(targets[i]->referenceCount() > 1){_stats._numInUse++;}
+		}
+		_stats._numTargets += targets.size();
+		_stats._bytesAllocated += GetTargetBytes((*itr).first) * targets.size();
+	}
+	if(_stats._numInUse > _stats._highWaterMark){_stats._highWaterMark = _stats._numInUse;}
+	if(_stats._bytesAllocated > _stats._bytesHighWaterMark){_stats._bytesHighWaterMark = _stats._bytesAllocated;}
+}
+
+//
+//Estimated bytes of a target, the texture plus the multisample renderbuffer it's resolved from
+//
+unsigned long long RenderTargetPool::GetTargetBytes(const Key& key)
+{
+	unsigned long long bytesPerPixel = hogbox::MemoryTracker::EstimatePixelBytes(key._internalFormat);
+	unsigned long long pixels = (unsigned long long)key._width * (unsigned long long)key._height;
+	return pixels * bytesPerPixel * (1 + key._samples);
+}
+
+//
+//Unit quad shared by full screen passes
+//
+osg::Geometry* RenderTargetPool::GetFullScreenQuad()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+	if(_quad.valid()){return _quad.get();}
+
+	_quad = new osg::Geometry();
+	_quad->setName("RenderTargetPool FullScreenQuad");
+
+	osg::Vec3Array* coords = new osg::Vec3Array();
+	coords->push_back(osg::Vec3(0.0f, 0.0f, 0.0f));
+	coords->push_back(osg::Vec3(1.0f, 0.0f, 0.0f));
+	coords->push_back(osg::Vec3(1.0f, 1.0f, 0.0f));
+	coords->push_back(osg::Vec3(0.0f, 1.0f, 0.0f));
+	_quad->setVertexArray(coords);
+
+	osg::Vec2Array* tcoords = new osg::Vec2Array();
+	tcoords->push_back(osg::Vec2(0.0f, 0.0f));
+	tcoords->push_back(osg::Vec2(1.0f, 0.0f));
+	tcoords->push_back(osg::Vec2(1.0f, 1.0f));
+	tcoords->push_back(osg::Vec2(0.0f, 1.0f));
+	_quad->setTexCoordArray(0, tcoords);
+
+	osg::ref_ptr<osg::Vec4Array> quadColors = new osg::Vec4Array;
+	quadColors->push_back(osg::Vec4(1.0f,1.0f,1.0f,1.0f));
+	_quad->setColorArray(quadColors.get());
+	_quad->setColorBinding(osg::Geometry::BIND_OVERALL);
+
+	_quad->addPrimitiveSet(new osg::DrawArrays(osg::PrimitiveSet::QUADS, 0, 4));
+	_quad->setUseDisplayList(false);
+	_quad->setUseVertexBufferObjects(true);
+	//shared between threads drawing different passes, never changes
+	_quad->setDataVariance(osg::Object::STATIC);
+
+	return _quad.get();
+}
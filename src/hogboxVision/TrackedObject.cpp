@@ -1,4 +1,12 @@
 #include <hogboxVision/TrackedObject.h>
+#include <hogboxVision/PoseFilter.h>
+
+#include <osg/Timer>
+#include <osg/Notify>
+#include <OpenThreads/ScopedLock>
+
+#include <math.h>
+#include <fstream>
 
 using namespace hogboxVision;
 
@@ -7,17 +15,48 @@ TrackedObject::TrackedObject(TrackedDimensions dimensions)
     _poseMatrix(),
     _isDetected(false),
     _isEnabled(true),
-    _confidence(0.0f)
+    _confidence(0.0f),
+	_sampleTime(-1.0),
+	_inTrackerUpdate(false),
+	_hasMeasurement(false),
+	p_recordStream(NULL),
+	_frontSample(0),
+	_predictionModel(CONSTANT_VELOCITY),
+	_predictionLead(0.0),
+	_maxPredictionTime(0.1),
+	_kalmanValid(false),
+	_kalmanReset(false),
+	_processNoise(1000.0),
+	_measurementNoise(1.0)
 {
 }
 
 TrackedObject::~TrackedObject(void)
 {
+	StopRecording();
+	_poseFilter = NULL;
 }
 
 /** Copy constructor using CopyOp to manage deep vs shallow copy.*/
 TrackedObject::TrackedObject(const TrackedObject& object,const osg::CopyOp& copyop)
-	: osg::Object(object, copyop)
+	: osg::Object(object, copyop),
+	_trackingDimensions(object._trackingDimensions),
+	_isEnabled(object._isEnabled),
+	_isDetected(false),
+	_confidence(0.0f),
+	_sampleTime(-1.0),
+	_inTrackerUpdate(false),
+	_hasMeasurement(false),
+	_poseFilter(object._poseFilter.valid() ? dynamic_cast<PoseFilter*>(object._poseFilter->clone(osg::CopyOp::DEEP_COPY_ALL)) : NULL),
+	p_recordStream(NULL),
+	_frontSample(0),
+	_predictionModel(object._predictionModel),
+	_predictionLead(object._predictionLead),
+	_maxPredictionTime(object._maxPredictionTime),
+	_kalmanValid(false),
+	_kalmanReset(false),
+	_processNoise(object._processNoise),
+	_measurementNoise(object._measurementNoise)
 {
 }
 
@@ -49,5 +88,300 @@ bool TrackedObject::UpdateMarker(bool isDetected, osg::Matrix pose)
 {
 	_isDetected = isDetected;
 	_poseMatrix = pose;
+
+	TrackedPoseSample sample;
+	sample._pose = pose;
+	sample._isDetected = isDetected;
+	//trackers that don't measure confidence are sure of what they detect
+	sample._confidence = isDetected ? (_confidence > 0.0f ? _confidence : 1.0f) : 0.0f;
+	sample._time = _sampleTime >= 0.0 ? _sampleTime : osg::Timer::instance()->time_s();
+
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_recordMutex);
+		if(p_recordStream){WritePoseSample(*p_recordStream, sample);}
+	}
+
+	//the tracker filters all its objects together once it's done
+	if(_inTrackerUpdate){
+		_measurement = sample;
+		_hasMeasurement = true;
+		return true;
+	}
+
+	ProcessSample(sample);
+	return true;
+}
+
+void TrackedObject::BeginTrackerUpdate(double time)
+{
+	_sampleTime = time;
+	_inTrackerUpdate = true;
+	_hasMeasurement = false;
+}
+
+void TrackedObject::EndTrackerUpdate()
+{
+	_inTrackerUpdate = false;
+
+	//not reported this frame, so a missed detection
+	if(!_hasMeasurement)
+	{
+		_measurement = TrackedPoseSample();
+		_measurement._pose = _poseMatrix;
+		_measurement._time = _sampleTime >= 0.0 ? _sampleTime : osg::Timer::instance()->time_s();
+	}
+	_hasMeasurement = false;
+	ProcessSample(_measurement);
+}
+
+//
+//Split the pose, filter it and put it back together
+//
+void TrackedObject::ProcessSample(TrackedPoseSample& sample)
+{
+	osg::ref_ptr<PoseFilter> filter;
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_poseMutex);
+		filter = _poseFilter;
+	}
+
+	if(filter.valid())
+	{
+		if(sample._isDetected){
+			sample._position = sample._pose.getTrans();
+			sample._rotation = sample._pose.getRotate();
+		}
+		filter->Apply(sample);
+		if(sample._isDetected){
+			sample._pose = osg::Matrix::rotate(sample._rotation) * osg::Matrix::translate(sample._position);
+		}
+	}
+	PublishSample(sample);
+}
+
+//
+//Estimate the motion of sample from the last detected one and swap it to the front
+//
+void TrackedObject::PublishSample(TrackedPoseSample& sample)
+{
+	PredictionModel model;
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_poseMutex);
+		model = _predictionModel;
+		if(_kalmanReset){
+			_kalmanValid = false;
+			_kalmanReset = false;
+		}
+	}
+
+	if(sample._isDetected)
+	{
+		sample._position = sample._pose.getTrans();
+		sample._rotation = sample._pose.getRotate();
+
+		double dt = sample._time - _lastDetected._time;
+		if(_lastDetected._isDetected && dt > 0.0)
+		{
+			sample._velocity = (sample._position - _lastDetected._position) / dt;
+
+			//rotation taking the last pose to this one, the short way round
+			osg::Quat delta = _lastDetected._rotation.inverse() * sample._rotation;
+			if(delta.w() < 0.0){delta = -delta;}
+			double angle;
+			delta.getRotate(angle, sample._angularAxis);
+			sample._angularRate = angle / dt;
+			sample._hasMotion = true;
+		}
+
+		if(model == KALMAN){
+			FilterSample(sample);
+		}else{
+			_kalmanValid = false;
+		}
+		_lastDetected = sample;
+	}else{
+		//lost, the next detection starts the motion estimate again
+		_lastDetected = TrackedPoseSample();
+		_kalmanValid = false;
+	}
+
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_poseMutex);
+	_poseSamples[1-_frontSample] = sample;
+	_frontSample = 1-_frontSample;
+}
+
+//
+//Constant velocity kalman filter on each position axis, the state is
+//position and velocity driven by white noise acceleration
+//
+void TrackedObject::FilterSample(TrackedPoseSample& sample)
+{
+	if(!_kalmanValid)
+	{
+		for(unsigned int i=0; i<3; i++){
+			_kalmanState[i][0] = sample._position[i];
+			_kalmanState[i][1] = sample._hasMotion ? sample._velocity[i] : 0.0;
+			_kalmanCovariance[i][0] = _measurementNoise;
+			_kalmanCovariance[i][1] = 0.0;
+			_kalmanCovariance[i][2] = sample._hasMotion ? _measurementNoise : _processNoise;
+		}
+		_kalmanValid = true;
+		return;
+	}
+
+	double dt = sample._time - _lastDetected._time;
+	if(dt <= 0.0){return;}
+
+	double q = _processNoise;
+	for(unsigned int i=0; i<3; i++)
+	{
+		double& p = _kalmanState[i][0];
+		double& v = _kalmanState[i][1];
+		double& p00 = _kalmanCovariance[i][0];
+		double& p01 = _kalmanCovariance[i][1];
+		double& p11 = _kalmanCovariance[i][2];
+
+		//predict
+		p += v * dt;
+		p00 += dt * (2.0 * p01 + dt * p11) + q * dt * dt * dt / 3.0;
+		p01 += dt * p11 + q * dt * dt / 2.0;
+		p11 += q * dt;
+
+		//correct with the measured position
+		double innovation = sample._position[i] - p;
+		double s = p00 + _measurementNoise;
+		double k0 = p00 / s;
+		double k1 = p01 / s;
+		p += k0 * innovation;
+		v += k1 * innovation;
+		p11 -= k1 * p01;
+		p01 -= k0 * p01;
+		p00 -= k0 * p00;
+
+		sample._position[i] = p;
+		sample._velocity[i] = v;
+	}
+	sample._hasMotion = true;
+	sample._pose = osg::Matrix::rotate(sample._rotation) * osg::Matrix::translate(sample._position);
+}
+
+TrackedPoseSample TrackedObject::GetPoseSample()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_poseMutex);
+	return _poseSamples[_frontSample];
+}
+
+osg::Matrix TrackedObject::GetTransform()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_poseMutex);
+	return _poseSamples[_frontSample]._pose;
+}
+
+bool TrackedObject::IsObjectDetected()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_poseMutex);
+	return _poseSamples[_frontSample]._isDetected;
+}
+
+float TrackedObject::GetConfidence()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_poseMutex);
+	return _poseSamples[_frontSample]._confidence;
+}
+
+//
+//Extrapolate the last pose to displayTime
+//
+osg::Matrix TrackedObject::GetPredictedTransform(double displayTime)
+{
+	TrackedPoseSample sample;
+	PredictionModel model;
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_poseMutex);
+		sample = _poseSamples[_frontSample];
+		model = _predictionModel;
+	}
+
+	if(model == NO_PREDICTION || !sample._isDetected || !sample._hasMotion){return sample._pose;}
+
+	double dt = displayTime - sample._time;
+	if(dt <= 0.0){return sample._pose;}
+	if(dt > _maxPredictionTime){dt = _maxPredictionTime;}
+
+	osg::Vec3d position = sample._position + sample._velocity * dt;
+	osg::Quat rotation = sample._rotation;
+	if(sample._angularRate > 0.0){
+		rotation = rotation * osg::Quat(sample._angularRate * dt, sample._angularAxis);
+	}
+	if(_trackingDimensions == TRACKING_POSITION){rotation = sample._rotation;}
+	if(_trackingDimensions == TRACKING_ROTATION){position = sample._position;}
+
+	return osg::Matrix::rotate(rotation) * osg::Matrix::translate(position);
+}
+
+osg::Matrix TrackedObject::GetPredictedTransform()
+{
+	return GetPredictedTransform(osg::Timer::instance()->time_s() + _predictionLead);
+}
+
+void TrackedObject::SetPredictionModel(const PredictionModel& model)
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_poseMutex);
+	_predictionModel = model;
+	_kalmanReset = true;
+}
+
+void TrackedObject::SetKalmanNoise(const double& processNoise, const double& measurementNoise)
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_poseMutex);
+	_processNoise = processNoise;
+	_measurementNoise = measurementNoise;
+	_kalmanReset = true;
+}
+
+void TrackedObject::SetPoseFilter(PoseFilter* filter)
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_poseMutex);
+	_poseFilter = filter;
+}
+
+PoseFilter* TrackedObject::GetPoseFilter()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_poseMutex);
+	return _poseFilter.get();
+}
+
+bool TrackedObject::StartRecording(const std::string& fileName)
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_recordMutex);
+	if(p_recordStream){
+		p_recordStream->close();
+		delete p_recordStream;
+		p_recordStream = NULL;
+	}
+
+	std::ofstream* stream = new std::ofstream(fileName.c_str());
+	if(!stream->is_open()){
+		osg::notify(osg::WARN) << "TrackedObject::StartRecording: ERROR: Failed to open '" << fileName << "' for writing." << std::endl;
+		delete stream;
+		return false;
+	}
+	*stream << "# " << this->getName() << "\n# time detected confidence tx ty tz qx qy qz qw\n";
+	p_recordStream = stream;
 	return true;
 }
+
+void TrackedObject::StopRecording()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_recordMutex);
+	if(!p_recordStream){return;}
+	p_recordStream->close();
+	delete p_recordStream;
+	p_recordStream = NULL;
+}
+
+bool TrackedObject::IsRecording()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_recordMutex);
+	return p_recordStream != NULL;
+}
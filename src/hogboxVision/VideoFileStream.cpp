@@ -0,0 +1,79 @@
+#include <hogboxVision/VideoFileStream.h>
+
+#include <math.h>
+#include <algorithm>
+
+using namespace hogboxVision;
+
+VideoFileSyncClock::VideoFileSyncClock()
+	: hogbox::PresentationClock()
+{
+}
+
+VideoFileSyncClock::~VideoFileSyncClock()
+{
+}
+
+void VideoFileSyncClock::AttachStream(VideoFileStream* stream)
+{
+	if(std::find(_streams.begin(), _streams.end(), stream) == _streams.end()){
+		_streams.push_back(stream);
+	}
+}
+
+void VideoFileSyncClock::DetachStream(VideoFileStream* stream)
+{
+	std::vector<VideoFileStream*>::iterator itr = std::find(_streams.begin(), _streams.end(), stream);
+	if(itr != _streams.end()){
+		_streams.erase(itr);
+	}
+}
+
+//
+//Largest difference in drift between the attached streams
+//
+double VideoFileSyncClock::GetMaxStreamSpread()const
+{
+	bool found = false;
+	double minDrift = 0.0;
+	double maxDrift = 0.0;
+	for(unsigned int i=0; i<_streams.size(); i++)
+	{
+		const VideoSyncStats& stats = _streams[i]->GetSyncStats();
+		if(stats._samples == 0){continue;}
+		if(!found || stats._drift < minDrift){minDrift = stats._drift;}
+		if(!found || stats._drift > maxDrift){maxDrift = stats._drift;}
+		found = true;
+	}
+	return maxDrift - minDrift;
+}
+
+//
+//Update the sync stats with the frame due and the frame presented
+//
+void VideoFileStream::RecordSyncFrame(const unsigned int& dueFrame, const unsigned int& presentedFrame)
+{
+	double period = _frameRate > 0.0 ? 1.0/_frameRate : 0.0;
+
+	if(_syncStats._samples > 0)
+	{
+		if(presentedFrame != _lastPresentedFrame){
+			_syncStats._presentedFrames++;
+			//frames jumped over on the way to this one
+			if(presentedFrame > _lastPresentedFrame+1){
+				_syncStats._droppedFrames += presentedFrame - _lastPresentedFrame - 1;
+			}
+		}else if(dueFrame > _lastDueFrame && dueFrame > presentedFrame){
+			_syncStats._repeatedFrames++;
+		}
+	}
+
+	_syncStats._drift = ((double)presentedFrame - (double)dueFrame) * period;
+	double absDrift = fabs(_syncStats._drift);
+	_syncStats._samples++;
+	_syncStats._meanAbsDrift += (absDrift - _syncStats._meanAbsDrift) / _syncStats._samples;
+	if(absDrift > _syncStats._maxAbsDrift){_syncStats._maxAbsDrift = absDrift;}
+
+	_lastDueFrame = dueFrame;
+	_lastPresentedFrame = presentedFrame;
+}
@@ -1,5 +1,7 @@
 #include <hogboxVision/videostream.h>
 
+#include <OpenThreads/ScopedLock>
+
 using namespace hogboxVision;
 
 VideoStream::VideoStream() 
@@ -8,7 +10,9 @@ VideoStream::VideoStream()
 		_isValid(false),
 		_hFlip(false),
 		_vFlip(false),
-		_isInter(false)
+		_isInter(false),
+		_deinterMode(ImageKernels::BOB),
+		_frameCaptureTime(-1.0)
 {
 
 }
@@ -29,7 +33,9 @@ VideoStream::VideoStream(const VideoStream& image,const osg::CopyOp& copyop)
 		_isValid(image._isValid),
 		_isInter(image._isInter),
 		_hFlip(image._hFlip),
-		_vFlip(image._vFlip)
+		_vFlip(image._vFlip),
+		_deinterMode(image._deinterMode),
+		_frameCaptureTime(-1.0)
 {
 }
 
@@ -54,5 +60,35 @@ bool VideoStream::CreateStream(const std::string& config, bool hflip, bool vflip
 	return true;
 }
 
+//
+//When the frame currently in the image was captured, negative if unknown
+//
+double VideoStream::GetFrameCaptureTime()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_frameCaptureTimeMutex);
+	return _frameCaptureTime;
+}
+
+void VideoStream::SetFrameCaptureTime(double time)
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_frameCaptureTimeMutex);
+	_frameCaptureTime = time;
+}
+
+//
+//Apply the horizontal flip and deinterlacing requested for the stream to the
+//current frame in place
+//
+void VideoStream::ApplyFrameModes()
+{
+	if(!data()){return;}
+	if(_isInter){
+		ImageKernels::Deinterlace(this, _deinterMode);
+	}
+	if(_hFlip){
+		ImageKernels::FlipHorizontal(this);
+	}
+}
+
 
 
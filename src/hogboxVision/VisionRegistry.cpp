@@ -12,6 +12,11 @@
 #include <hogbox/Version.h>
 #include <osgDB/FileUtils>
 #include <osgDB/FileNameUtils>
+#include <osgDB/XmlParser>
+#include <OpenThreads/ScopedLock>
+
+#include <algorithm>
+#include <ctype.h>
 
 using namespace hogboxVision;
 
@@ -32,10 +37,25 @@ VisionRegistry* VisionRegistry::Instance(bool erase)
     return s_hogboxVisRegistryInstance.get();
 }*/
 
+//
+//Lower case copy of name, plugin names and aliases are case insensitive
+//
+static std::string ToLowerCase(const std::string& name)
+{
+	std::string lower;
+	for(std::string::const_iterator itr=name.begin(); itr!=name.end(); ++itr){
+		lower.push_back(tolower(*itr));
+	}
+	return lower;
+}
+
 //
 //private constructor for singleton
 //
-VisionRegistry::VisionRegistry(void) : osg::Referenced()
+VisionRegistry::VisionRegistry(void) 
+	: osg::Referenced(),
+	_manifestLoaded(false),
+	_pluginsFolderScanned(false)
 {
 	//add the aliases for the standard osg and hogbox 
 	//types to the multi purpose hogbox xml plugin which 
@@ -47,7 +67,9 @@ VisionRegistry::VisionRegistry(void) : osg::Referenced()
 VisionRegistry::~VisionRegistry(void)
 {
 	_videoFileStreamTypes.clear();
+	_videoFileStreamTypeMap.clear();
 	_webcamStreamTypes.clear();
+	_webcamStreamTypeMap.clear();
 	_cameraBaseTrackerTypes.clear();
 	_dlList.clear();
 }
@@ -57,11 +79,13 @@ VisionRegistry::~VisionRegistry(void)
 //
 void VisionRegistry::AddVideoStreamTypeToRegistry(VideoFileStreamWrapper* protoWrapper)
 {
-	//already exist by manager class name
-	//VideoFileStream* existing = GetXmlClassManager(object->className());
-	//if(existing){return;}
+	OpenThreads::ScopedWriteLock lock(_typesMutex);
+	std::string name = ToLowerCase(protoWrapper->GetPluginName());
+	//already exist by plugin name
+	if(_videoFileStreamTypeMap.find(name) != _videoFileStreamTypeMap.end()){return;}
 
 	_videoFileStreamTypes.push_back(protoWrapper);
+	_videoFileStreamTypeMap[name] = protoWrapper;
 }
 
 
@@ -101,7 +125,8 @@ VideoFileStreamPtr VisionRegistry::AllocateVideoFileStream(const std::string& pl
 VideoFileStreamPtr VisionRegistry::CreateVideoFileStream(const std::string& fileName, const std::string& plugin,
 														 bool hflip, bool vflip, bool deinter)
 {
-	//clone the type then try calling create, if it works return it
+	//clone the type then try calling create, if it works return it.
+	//No registry locks are held while the stream is created
 	VideoFileStreamPtr type = AllocateVideoFileStream(plugin);
 	if(type.get())
 	{
@@ -120,12 +145,14 @@ VideoFileStreamPtr VisionRegistry::CreateVideoFileStream(const std::string& file
 //
 void VisionRegistry::AddWebCamStreamTypeToRegistry(WebCamStreamWrapper* protoWrapper)
 {
-	//already exist by manager class name
-	//VideoFileStream* existing = GetXmlClassManager(object->className());
-	//if(existing){return;}
-	OSG_FATAL << "ADD WEBCAM TYPE TO LIST" << std::endl;
+	OpenThreads::ScopedWriteLock lock(_typesMutex);
+	std::string name = ToLowerCase(protoWrapper->GetPluginName());
+	//already exist by plugin name
+	if(_webcamStreamTypeMap.find(name) != _webcamStreamTypeMap.end()){return;}
+
 	_webcamStreamTypes.push_back(protoWrapper);
-	OSG_FATAL << "NEW TYPES LIST COUNT '" << _webcamStreamTypes.size() << "'" << std::endl;
+	_webcamStreamTypeMap[name] = protoWrapper;
+	OSG_INFO << "HogBoxVision WebCam Plugin INFO: Registered '" << protoWrapper->GetPluginName() << "', " << _webcamStreamTypes.size() << " types available." << std::endl;
 }
 
 //
@@ -182,31 +209,150 @@ WebCamStreamPtr VisionRegistry::CreateWebCamStream(const std::string& fileName,
 //Add an alias for a classtype to the library that will load it
 void VisionRegistry::AddClassTypeAlias(const std::string mapClassType, const std::string toLibraryName)
 {
-    _classTypeAliasMap[mapClassType] = toLibraryName;
+	OpenThreads::ScopedWriteLock lock(_typesMutex);
+    //only the key is case insensitive, the library keeps its case for the file name
+    _classTypeAliasMap[ToLowerCase(mapClassType)] = toLibraryName;
+}
+
+//
+//Follow the aliases from a plugin name to its library base name
+//
+std::string VisionRegistry::ResolvePluginName(const std::string& plugin)
+{
+	LoadDefaultManifest();
+	OpenThreads::ScopedReadLock lock(_typesMutex);
+	return ResolvePluginNameLocked(plugin);
+}
+
+std::string VisionRegistry::ResolvePluginNameLocked(const std::string& plugin)
+{
+	std::string name = plugin;
+	//bounded in case the aliases loop
+	for(unsigned int i=0; i<_classTypeAliasMap.size(); i++)
+	{
+		std::string key = ToLowerCase(name);
+		ClassTypeAliasMap::const_iterator itr = _classTypeAliasMap.find(key);
+		if(itr == _classTypeAliasMap.end() || ToLowerCase(itr->second) == key){break;}
+		name = itr->second;
+	}
+	return name;
+}
+
+void VisionRegistry::SetDefaultVideoFileStreamPlugin(const std::string& plugin)
+{
+	OpenThreads::ScopedWriteLock lock(_typesMutex);
+	_defaultVideoFileStreamPlugin = plugin;
+}
+
+void VisionRegistry::SetDefaultWebCamStreamPlugin(const std::string& plugin)
+{
+	OpenThreads::ScopedWriteLock lock(_typesMutex);
+	_defaultWebCamStreamPlugin = plugin;
+}
+
+//
+//Read the <VisionPlugins> aliases and defaults
+//
+bool VisionRegistry::LoadPluginManifest(const std::string& fileName)
+{
+	std::string path = osgDB::findDataFile(fileName);
+	if(path.empty()){
+		osg::notify(osg::WARN) << "VisionRegistry::LoadPluginManifest: ERROR: Could not find file '" << fileName << "'." << std::endl;
+		return false;
+	}
+
+	osg::ref_ptr<osgDB::XmlNode> doc = new osgDB::XmlNode;
+	osgDB::XmlNode::Input input;
+	input.open(path);
+	input.readAllDataIntoBuffer();
+	doc->read(input);
+
+	osgDB::XmlNode* manifestNode = doc->name == "VisionPlugins" ? doc.get() : NULL;
+	for(osgDB::XmlNode::Children::iterator itr = doc->children.begin(); itr != doc->children.end() && !manifestNode; ++itr){
+		if((*itr)->name == "VisionPlugins"){manifestNode = itr->get();}
+	}
+	if(!manifestNode){
+		osg::notify(osg::WARN) << "VisionRegistry::LoadPluginManifest: ERROR: File '" << path << "' must contain a <VisionPlugins> node." << std::endl;
+		return false;
+	}
+
+	for(osgDB::XmlNode::Children::iterator itr = manifestNode->children.begin(); itr != manifestNode->children.end(); ++itr)
+	{
+		osgDB::XmlNode* node = itr->get();
+		osgDB::XmlNode::Properties::iterator name = node->properties.find("name");
+		if(name == node->properties.end()){continue;}
+
+		if(node->name == "Alias"){
+			osgDB::XmlNode::Properties::iterator library = node->properties.find("library");
+			if(library != node->properties.end()){AddClassTypeAlias(name->second, library->second);}
+		}else if(node->name == "DefaultVideoFileStream"){
+			SetDefaultVideoFileStreamPlugin(name->second);
+		}else if(node->name == "DefaultWebCamStream"){
+			SetDefaultWebCamStreamPlugin(name->second);
+		}
+	}
+	return true;
 }
 
 //
-//Load all available plugins in the hogboxVisionPlugins folder matching the
-//VideoFileStreamPluginPrepend. Returns the number of plugins loaded
+//Read visionplugins.xml from the plugins folder once, if it's there
+//
+void VisionRegistry::LoadDefaultManifest()
+{
+	{
+		OpenThreads::ScopedReadLock lock(_typesMutex);
+		if(_manifestLoaded){return;}
+	}
+	//only one thread loads it, the others wait here until the aliases exist
+	OpenThreads::ScopedLock<OpenThreads::ReentrantMutex> lock(_pluginMutex);
+	{
+		OpenThreads::ScopedReadLock typesLock(_typesMutex);
+		if(_manifestLoaded){return;}
+	}
+
+	std::string manifest = osgDB::getFilePath(GetVideoFileStreamPluginPrepend()) + "/visionplugins.xml";
+	if(!osgDB::findDataFile(manifest).empty()){LoadPluginManifest(manifest);}
+
+	OpenThreads::ScopedWriteLock typesLock(_typesMutex);
+	_manifestLoaded = true;
+}
+
+//
+//Loads a specific video plugin on demand, unless no plugin name is given,
+//in which case the default or first plugin found is loaded.
+//Returns true if the plugin's prototype can now be looked up
 //
 int VisionRegistry::LoadVideoFileStreamPlugin(const std::string plugin)
 {
-   //open the hogboxVisionPlugins folder and find all files matching the prepend
-	std::string visPluginsFolder = std::string("./hogboxVisPlugins-"+std::string(hogboxGetVersion()));
-	osgDB::DirectoryContents pluginsFolder = osgDB::getDirectoryContents(visPluginsFolder);
+	LoadDefaultManifest();
+	OpenThreads::ScopedLock<OpenThreads::ReentrantMutex> lock(_pluginMutex);
 
-	std::string ext = GetPluginExtension();
-	std::string prepend = GetVideoFileStreamPluginPrepend();
-	int loadCount = 0;
+	std::string requested = plugin;
+	if(requested.empty()){
+		OpenThreads::ScopedReadLock typesLock(_typesMutex);
+		requested = _defaultVideoFileStreamPlugin;
+	}
+	if(requested.empty()){ScanPluginsFolder();}
+	if(!LoadStreamPlugin(requested, GetVideoFileStreamPluginPrepend(), _videoFileLibraries, "Video")){
+		return false;
+	}
+	return GetVideoFileStreamPluginProto(plugin).valid();
+}
 
+//
+//Shared by the video and webcam loaders
+//
+bool VisionRegistry::LoadStreamPlugin(const std::string& plugin, const std::string& prepend,
+									  const std::vector<std::string>& folderLibraries, const char* typeName)
+{
+	std::string ext = GetPluginExtension();
 	std::string libraryName = "";
 
 	//if we have a plugin name try to load it
 	if(!plugin.empty()){
-		std::string requestedPluginLibrary = prepend + "_" + plugin + ext;
-		libraryName = requestedPluginLibrary;
-	}else{
-		libraryName = FindVideoFileLibraryName(0);
+		libraryName = prepend + "_" + ResolvePluginName(plugin) + ext;
+	}else if(folderLibraries.size() > 0){
+		libraryName = folderLibraries[0];
 	}
 
 	//it matches the prepend definition, load it.
@@ -215,63 +361,68 @@ int VisionRegistry::LoadVideoFileStreamPlugin(const std::string plugin)
 		osgDB::Registry::LoadStatus result = this->LoadLibrary(libraryName);
 		if(result == osgDB::Registry::LOADED)
 		{
-			osg::notify(osg::INFO) << "HogBoxVision Video Plugin INFO: Plugin '" << libraryName << "', was loaded successfully." << std::endl;
-			loadCount++;
+			osg::notify(osg::INFO) << "HogBoxVision " << typeName << " Plugin INFO: Plugin '" << libraryName << "', was loaded successfully." << std::endl;
 			return true;
 		}else if(result == osgDB::Registry::PREVIOUSLY_LOADED) {
 
-			osg::notify(osg::WARN) << "HogBoxVision Video Plugin WARN: Plugin '" << libraryName << "' has already been loaded." << std::endl; 
+			//another thread may have loaded it while we waited
+			osg::notify(osg::INFO) << "HogBoxVision " << typeName << " Plugin INFO: Plugin '" << libraryName << "' has already been loaded." << std::endl; 
+			return true;
 		}else{
 			//failed to load the libray
-			osg::notify(osg::WARN) << "HogBoxVision Video Plugin WARN: Failed to load Plugin '" << libraryName << "'." << std::endl; 
+			osg::notify(osg::WARN) << "HogBoxVision " << typeName << " Plugin WARN: Failed to load Plugin '" << libraryName << "'." << std::endl; 
 		}
 	}
 	return false;
 }
 
 //
-//return the path of the index file in the visPlugins folder
-//that matches the video plugin library naming convention
+//Scan the plugins folder for each type of plugin library
 //
-const std::string VisionRegistry::FindVideoFileLibraryName(int index)
+void VisionRegistry::ScanPluginsFolder()
 {
-   //open the hogboxVisionPlugins folder and find all files matching the prepend
-	std::string visPluginsFolder = std::string("./hogboxVisPlugins-"+std::string(hogboxGetVersion()));
+	OpenThreads::ScopedLock<OpenThreads::ReentrantMutex> lock(_pluginMutex);
+	if(_pluginsFolderScanned){return;}
+	_pluginsFolderScanned = true;
+
+   //open the hogboxVisionPlugins folder and find all files matching the prepends
+	std::string visPluginsFolder = osgDB::getFilePath(GetVideoFileStreamPluginPrepend());
 	osgDB::DirectoryContents pluginsFolder = osgDB::getDirectoryContents(visPluginsFolder);
 
 	std::string ext = GetPluginExtension();
-	std::string prepend = GetVideoFileStreamPluginPrepend();
-	int foundCount = 0;
+	std::string videoPrepend = osgDB::getSimpleFileName(GetVideoFileStreamPluginPrepend()) + "_";
+	std::string webcamPrepend = osgDB::getSimpleFileName(GetWebCamStreamPluginPrepend()) + "_";
 
 	//loop over contents looking for any files with the corrent extension
 	for(unsigned int i=0; i<pluginsFolder.size(); i++)
 	{
-		if(osgDB::getFileExtensionIncludingDot(pluginsFolder[i]) == ext)
-		{
-			//check if the begining matches the videofilestream prepend
-			//stream upto the last _
-			size_t found;
-			found = pluginsFolder[i].find_last_of("_");
-			if(found != std::string::npos)
-			{
-				std::string strippedName = pluginsFolder[i].substr(0,found);
-				std::string prependName = visPluginsFolder+strippedName;
-				std::string libraryName = visPluginsFolder+"/"+pluginsFolder[i];
-				//compare to prepend
-				if(prepend.compare(prependName) == 0)
-				{
-					//it matches the prepend definition, load it.
-					if(!libraryName.empty())
-					{		
-						//we have a valid plugin name increase the fund count
-						foundCount++;
-						if(foundCount == index){return libraryName;}
-					}
-				}
-			}
+		const std::string& file = pluginsFolder[i];
+		if(osgDB::getFileExtensionIncludingDot(file) != ext){continue;}
+
+		//check if the begining matches a plugin prepend
+		std::string libraryName = visPluginsFolder+"/"+file;
+		if(file.compare(0, videoPrepend.size(), videoPrepend) == 0){
+			_videoFileLibraries.push_back(libraryName);
+		}else if(file.compare(0, webcamPrepend.size(), webcamPrepend) == 0){
+			_webcamLibraries.push_back(libraryName);
 		}
 	}
-	return "";
+
+	//directory order isn't defined, keep the first plugin the same between runs
+	std::sort(_videoFileLibraries.begin(), _videoFileLibraries.end());
+	std::sort(_webcamLibraries.begin(), _webcamLibraries.end());
+}
+
+//
+//return the path of the index file in the visPlugins folder
+//that matches the video plugin library naming convention
+//
+const std::string VisionRegistry::FindVideoFileLibraryName(int index)
+{
+	OpenThreads::ScopedLock<OpenThreads::ReentrantMutex> lock(_pluginMutex);
+	ScanPluginsFolder();
+	if(index < 0 || index >= (int)_videoFileLibraries.size()){return "";}
+	return _videoFileLibraries[index];
 }
 
 //
@@ -280,67 +431,43 @@ const std::string VisionRegistry::FindVideoFileLibraryName(int index)
 //
 VideoFileStreamWrapperPtr VisionRegistry::GetVideoFileStreamPluginProto(const std::string& plugin)
 {
+	LoadDefaultManifest();
+
+	OpenThreads::ScopedReadLock lock(_typesMutex);
+	std::string requested = plugin.empty() ? _defaultVideoFileStreamPlugin : plugin;
+	std::string name = requested.empty() ? "" : ToLowerCase(ResolvePluginNameLocked(requested));
 	//if no plugin name return the first
-	if(plugin.empty())
+	if(name.empty())
 	{
 		if(_videoFileStreamTypes.size() > 0){return _videoFileStreamTypes[0];}
 		return NULL;
 	}
 	//try to find requested
-	for(unsigned int i=0; i<_videoFileStreamTypes.size(); i++)
-	{
-		//compare to plugin base name
-		if(_videoFileStreamTypes[i]->GetPluginName() == plugin)
-		{
-			return _videoFileStreamTypes[i];
-		}
-	}
+	VideoFileStreamWrapperMap::iterator itr = _videoFileStreamTypeMap.find(name);
+	if(itr != _videoFileStreamTypeMap.end()){return itr->second;}
 	return NULL;
 }
 
 //
 //Loads a specific webcam plugin, unless no plugin name is given,
-//in which case the first plugin found is loaded
-//return 0 on success -1 on fail
+//in which case the default or first plugin found is loaded.
+//Returns true if the plugin's prototype can now be looked up
 //
 int VisionRegistry::LoadWebCamStreamPlugin(const std::string plugin)
 {
-   //open the hogboxVisionPlugins folder and find all files matching the prepend
-	std::string visPluginsFolder = std::string("./hogboxVisPlugins-"+std::string(hogboxGetVersion()));
-	osgDB::DirectoryContents pluginsFolder = osgDB::getDirectoryContents(visPluginsFolder);
+	LoadDefaultManifest();
+	OpenThreads::ScopedLock<OpenThreads::ReentrantMutex> lock(_pluginMutex);
 
-	std::string ext = GetPluginExtension();
-	std::string prepend = GetWebCamStreamPluginPrepend();
-	int loadCount = 0;
-
-	std::string libraryName = "";
-
-	//if we have a plugin name try to load it
-	if(!plugin.empty()){
-		std::string requestedPluginLibrary = prepend + "_" + plugin + ext;
-		libraryName = requestedPluginLibrary;
-	}else{
-		libraryName = FindWebCamLibraryName(0);
+	std::string requested = plugin;
+	if(requested.empty()){
+		OpenThreads::ScopedReadLock typesLock(_typesMutex);
+		requested = _defaultWebCamStreamPlugin;
 	}
-
-	//it matches the prepend definition, load it.
-	if(!libraryName.empty())
-	{		
-		osgDB::Registry::LoadStatus result = this->LoadLibrary(libraryName);
-		if(result == osgDB::Registry::LOADED)
-		{
-			osg::notify(osg::INFO) << "HogBoxVision WebCam Plugin INFO: Plugin '" << libraryName << "', was loaded successfully." << std::endl;
-			loadCount++;
-			return true;
-		}else if(result == osgDB::Registry::PREVIOUSLY_LOADED) {
-
-			osg::notify(osg::WARN) << "HogBoxVision WebCam Plugin WARN: Plugin '" << libraryName << "' has already been loaded." << std::endl; 
-		}else{
-			//failed to load the libray
-			osg::notify(osg::WARN) << "HogBoxVision WebCam Plugin WARN: Failed to load Plugin '" << libraryName << "'." << std::endl; 
-		}
+	if(requested.empty()){ScanPluginsFolder();}
+	if(!LoadStreamPlugin(requested, GetWebCamStreamPluginPrepend(), _webcamLibraries, "WebCam")){
+		return false;
 	}
-	return false;
+	return GetWebCamStreamPluginProto(plugin).valid();
 }
 
 //
@@ -349,43 +476,10 @@ int VisionRegistry::LoadWebCamStreamPlugin(const std::string plugin)
 //
 const std::string VisionRegistry::FindWebCamLibraryName(int index)
 {
-   //open the hogboxVisionPlugins folder and find all files matching the prepend
-	std::string visPluginsFolder = std::string("./hogboxVisPlugins-"+std::string(hogboxGetVersion()));
-	osgDB::DirectoryContents pluginsFolder = osgDB::getDirectoryContents(visPluginsFolder);
-
-	std::string ext = GetPluginExtension();
-	std::string prepend = GetWebCamStreamPluginPrepend();
-	int foundCount = 0;
-
-	//loop over contents looking for any files with the corrent extension
-	for(unsigned int i=0; i<pluginsFolder.size(); i++)
-	{
-		if(osgDB::getFileExtensionIncludingDot(pluginsFolder[i]) == ext)
-		{
-			//check if the begining matches the videofilestream prepend
-			//stream upto the last _
-			size_t found;
-			found = pluginsFolder[i].find_last_of("_");
-			if(found != std::string::npos)
-			{
-				std::string strippedName = pluginsFolder[i].substr(0,found);
-				std::string prependName = visPluginsFolder+strippedName;
-				std::string libraryName = visPluginsFolder+"/"+pluginsFolder[i];
-				//compare to prepend
-				if(prepend.compare(prependName) == 0)
-				{
-					//it matches the prepend definition, load it.
-					if(!libraryName.empty())
-					{		
-						//we have a valid plugin name increase the fund count
-						foundCount++;
-						if(foundCount == index){return libraryName;}
-					}
-				}
-			}
-		}
-	}
-	return "";
+	OpenThreads::ScopedLock<OpenThreads::ReentrantMutex> lock(_pluginMutex);
+	ScanPluginsFolder();
+	if(index < 0 || index >= (int)_webcamLibraries.size()){return "";}
+	return _webcamLibraries[index];
 }
 
 //
@@ -394,23 +488,20 @@ const std::string VisionRegistry::FindWebCamLibraryName(int index)
 //
 WebCamStreamWrapperPtr VisionRegistry::GetWebCamStreamPluginProto(const std::string& plugin)
 {
-	OSG_FATAL << "WEBCAM PLUGIN NAME '" << plugin << "'" << std::endl;
-	OSG_FATAL << "WEBCAM PLUGIN COUNT '" << _webcamStreamTypes.size() << "'" << std::endl;
+	LoadDefaultManifest();
+
+	OpenThreads::ScopedReadLock lock(_typesMutex);
+	std::string requested = plugin.empty() ? _defaultWebCamStreamPlugin : plugin;
+	std::string name = requested.empty() ? "" : ToLowerCase(ResolvePluginNameLocked(requested));
 	//if no plugin name return the first
-	if(plugin.empty())
+	if(name.empty())
 	{
 		if(_webcamStreamTypes.size() > 0){return _webcamStreamTypes[0];}
 		return NULL;
 	}
 	//try to find requested
-	for(unsigned int i=0; i<_webcamStreamTypes.size(); i++)
-	{
-		//compare to plugin base name
-		if(_webcamStreamTypes[i]->GetPluginName() == plugin)
-		{
-			return _webcamStreamTypes[i];
-		}
-	}
+	WebCamStreamWrapperMap::iterator itr = _webcamStreamTypeMap.find(name);
+	if(itr != _webcamStreamTypeMap.end()){return itr->second;}
 	return NULL;
 }
 
@@ -495,10 +586,11 @@ VisionRegistry::DynamicLibraryList::iterator VisionRegistry::GetLibraryItr(const
 //
 osgDB::Registry::LoadStatus VisionRegistry::LoadLibrary(const std::string& fileName)
 {
-   // OpenThreads::ScopedLock<OpenThreads::ReentrantMutex> lock(_pluginMutex);
+    OpenThreads::ScopedLock<OpenThreads::ReentrantMutex> lock(_pluginMutex);
 
     DynamicLibraryList::iterator ditr = GetLibraryItr(fileName);
 	if (ditr!=_dlList.end()) return osgDB::Registry::PREVIOUSLY_LOADED;
+	if (_failedLibraries.count(fileName) > 0) return osgDB::Registry::NOT_LOADED;
 
     //_openingLibrary=true;
 
@@ -511,5 +603,6 @@ osgDB::Registry::LoadStatus VisionRegistry::LoadLibrary(const std::string& fileN
         _dlList.push_back(dl);
         return osgDB::Registry::LOADED;
     }
+    _failedLibraries.insert(fileName);
     return osgDB::Registry::NOT_LOADED;
 }
\ No newline at end of file
@@ -1,5 +1,10 @@
 #include "dsosgimagerender.h"
 
+#include <hogboxVision/ImageKernels.h>
+#include <hogboxVision/VideoStream.h>
+
+#include <osg/Timer>
+
 #define REGISTER_FILTERGRAPH
 
 //-----------------------------------------------------------------------------
@@ -151,151 +156,46 @@ HRESULT DSOsgImageRender::DoRenderSample( IMediaSample * pSample )
     HRESULT hr = S_OK;
     BYTE * pBuffer = NULL;
 
+	//when the sample was captured, its start time is on the graph clock relative
+	//to m_tStart so measure how long ago that was. Without a clock or timestamp
+	//fall back to when the sample reached us
+	double captureTime = osg::Timer::instance()->time_s();
+	REFERENCE_TIME sampleStart, sampleEnd, clockNow;
+	if(m_pClock && SUCCEEDED(pSample->GetTime(&sampleStart, &sampleEnd)) && SUCCEEDED(m_pClock->GetTime(&clockNow)))
+	{
+		REFERENCE_TIME age = clockNow - ((REFERENCE_TIME)m_tStart + sampleStart);
+		if(age > 0){captureTime -= (double)age / 10000000.0;}
+	}
+
     try
     {
 		// Get the video bitmap buffer
 		hr = pSample->GetPointer( &pBuffer );
-		int length = (int)pSample->GetActualDataLength();
-		if(m_deInter) //DEINTERLACED
+		//flip and deinterlace a copy in our transfer buffer using the shared kernels,
+		//deinterlacing keeps just the first field at half height
+		int rowBytes = Width*3;
+		int rows = m_deInter ? Height/2 : Height;
+		BYTE* frame = pBuffer;
+		if(m_deInter || m_vFlip || m_hFlip)
 		{
-			if(m_vFlip && !m_hFlip) //deinter and flipv
-			{
-				//every other row
-				BYTE *sourceTemp=pBuffer;
-				//destination, start from top to flip
-				BYTE *destTemp=m_transBuffer;
-				destTemp += (Width*3)*((Height/2)-1);
-
-				for(int r=0; r<Height/2; r++)
-				{
-					memcpy(destTemp,sourceTemp,(Width*3));
-					destTemp-=(Width*3); //move one line in the dest
-					sourceTemp+=(Width*3)*2; //skip a line of the source for inter
-				}
-			
-				m_renderSurface->setImage(Width, Height/2,1, GL_RGB, GL_BGR, 
-									GL_UNSIGNED_BYTE, m_transBuffer, osg::Image::NO_DELETE, 1);
-			
-			}else if(m_vFlip && m_hFlip){ //deinter with both flips
-			
-				//pointer to begining of source
-				BYTE *sourceTemp=pBuffer;
-				//destination, end of last line
-				BYTE *destTemp=m_transBuffer;
-				destTemp += ((Width*3)*Height/2)-3;
-
-				//loop lines
-				for(int r=0; r<Height/2; r++) //half height to deinter
-				{
-					//copyline of pixels 
-					for(int p=0; p<Width; p++)
-					{
-						memcpy(destTemp,sourceTemp,3);
-						destTemp-=(3); //move back one pixel
-						sourceTemp+=(3); //move to the next pixel
-					}
-					//skip the next line
-					sourceTemp+=(Width*3);
-
-				}
-				m_renderSurface->setImage(Width, Height/2,1, GL_RGB, GL_BGR, 
-					GL_UNSIGNED_BYTE, m_transBuffer, osg::Image::NO_DELETE, 1);
-
-			
-			}else{ //just deinter
-				
-				//very other row
-				BYTE *sourceTemp=pBuffer;
-				//destination, start from top to flip
-				BYTE *destTemp=m_transBuffer;
-				//destTemp += (Width*4)*((Height/2)-1);
-
-				for(int r=0; r<Height/2; r++)
-				{
-					memcpy(destTemp,sourceTemp,(Width*3));
-					destTemp+=(Width*3); //move one line in the dest
-					sourceTemp+=(Width*3)*2; //skip a line of the source for inter
-				}
-			
-				m_renderSurface->setImage(Width, Height/2,1, GL_RGB, GL_BGR, 
-									GL_UNSIGNED_BYTE, m_transBuffer, osg::Image::NO_DELETE, 1);
-				
+			if(m_deInter){
+				hogboxVision::ImageKernels::ExtractField(pBuffer, rowBytes, rows*2, rowBytes, 0, m_transBuffer, rowBytes);
+			}else{
+				memcpy(m_transBuffer, pBuffer, rowBytes*Height);
 			}
-		
-		}else if(m_vFlip && !m_hFlip)//NO DEINTERLACED
-		{
-			//very other row
-			BYTE *sourceTemp=pBuffer;
-			//destination, start from top to flip
-			BYTE *destTemp=m_transBuffer;
-			destTemp += (Width*3)*((Height)-1);
-
-			for(int r=0; r<Height; r++)
-			{
-				memcpy(destTemp,sourceTemp,(Width*3));
-				destTemp-=(Width*3); //move one line in the dest
-				sourceTemp+=(Width*3); //skip a line of the source for inter
+			if(m_vFlip){
+				hogboxVision::ImageKernels::FlipVertical(m_transBuffer, rowBytes, rows, rowBytes);
 			}
-
-			m_renderSurface->setImage(Width, Height,1, GL_RGB, GL_BGR, 
-								GL_UNSIGNED_BYTE, m_transBuffer, osg::Image::NO_DELETE, 1);
-			//m_p_image->l
-			//m_p_image->flipHorizontal(); 
-
-
-		}else if(m_hFlip && !m_vFlip) { //just horiflip
-
-				//pointer to begining of source
-				BYTE *sourceTemp=pBuffer;
-				//destination, end of first line
-				BYTE *destTemp=m_transBuffer;
-				destTemp += (Width*3)-3;
-
-				//loop lines
-				for(int r=0; r<Height; r++)
-				{
-					//copyline of pixels 
-					for(int p=0; p<Width; p++)
-					{
-						memcpy(destTemp,sourceTemp,3);
-						destTemp-=(3); //move back one pixel
-						sourceTemp+=(3); //move to the next pixel
-					}
-					//move the destination to the end of the next line (should be move two lines
-					destTemp+= ((Width*3)*2);
-				}
-				m_renderSurface->setImage(Width, Height,1, GL_RGB, GL_BGR, 
-					GL_UNSIGNED_BYTE, m_transBuffer, osg::Image::NO_DELETE, 1);//
-				
-		}else if(m_hFlip && m_vFlip) { // both
-
-				//pointer to begining of source
-				BYTE *sourceTemp=pBuffer;
-				//destination, end of last line
-				BYTE *destTemp=m_transBuffer;
-				destTemp += ((Width*3)*Height)-3;
-
-				//loop lines
-				for(int r=0; r<Height; r++)
-				{
-					//copyline of pixels 
-					for(int p=0; p<Width; p++)
-					{
-						memcpy(destTemp,sourceTemp,3);
-						destTemp-=(3); //move back one pixel
-						sourceTemp+=(3); //move to the next pixel
-					}
-					//move the destination to the end of the next line (should be move two lines
-					//destTemp -= 4;//(Width*4)+4;
-				}
-				m_renderSurface->setImage(Width, Height,1, GL_RGB, GL_BGR, 
-					GL_UNSIGNED_BYTE, m_transBuffer, osg::Image::NO_DELETE, 1);
-		}else{
-			m_renderSurface->setImage(Width, Height,1, GL_RGB, GL_BGR, 
-								GL_UNSIGNED_BYTE, pBuffer, osg::Image::NO_DELETE, 1);
-			
+			if(m_hFlip){
+				hogboxVision::ImageKernels::FlipHorizontal(m_transBuffer, Width, rows, 3, rowBytes);
+			}
+			frame = m_transBuffer;
 		}
+		m_renderSurface->setImage(Width, rows, 1, GL_RGB, GL_BGR, 
+								GL_UNSIGNED_BYTE, frame, osg::Image::NO_DELETE, 1);
 
+		hogboxVision::VideoStream* stream = dynamic_cast<hogboxVision::VideoStream*>(m_renderSurface);
+		if(stream){stream->SetFrameCaptureTime(captureTime);}
 
 //////////////////
 
@@ -0,0 +1,311 @@
+#include "FileVideoStream.h"
+
+#include <math.h>
+#include <osg/Timer>
+
+#include <hogboxVision/VisionRegistry.h>
+
+REGISTER_VISION_VIDEO_PLUGIN(file, FileVideoStream)
+
+//frames decoded ahead of playback
+#define FILE_VIDEO_QUEUE_SIZE 4
+//longest CreateStream waits for the first frame to decode
+#define FILE_VIDEO_FIRST_FRAME_TIMEOUT_MS 5000
+
+//
+//
+//
+FileVideoStream::FileVideoStream()
+	: hogboxVision::VideoFileStream(),
+	_playing(false),
+	_playClockStart(0.0),
+	_playMediaStart(0.0),
+	_pausedMediaTime(0.0),
+	_seekFrame(0),
+	_decoderHFlip(false),
+	_decoderDeinter(false),
+	_decoderDeinterMode(hogboxVision::ImageKernels::BOB)
+{
+	osg::notify(osg::DEBUG_INFO) << "FileVideoStream" << std::endl;
+}
+
+FileVideoStream::~FileVideoStream(void)
+{
+	osg::notify(osg::DEBUG_INFO) << "~FileVideoStream" << std::endl;
+	//the base destructor can't reach our QuitImplementation
+	QuitImplementation();
+}
+
+FileVideoStream::FileVideoStream(const FileVideoStream& image,const osg::CopyOp& copyop)
+	: hogboxVision::VideoFileStream(image,copyop),
+	_playing(false),
+	_playClockStart(0.0),
+	_playMediaStart(0.0),
+	_pausedMediaTime(0.0),
+	_seekFrame(0),
+	_decoderHFlip(false),
+	_decoderDeinter(false),
+	_decoderDeinterMode(hogboxVision::ImageKernels::BOB)
+{
+}
+
+//
+//Open the video file config and decode its first frame into the image
+//
+bool FileVideoStream::CreateStream(const std::string& config, bool hflip, bool vflip, bool deInter)
+{
+	hogboxVision::VideoFileStream::CreateStream(config, hflip, vflip, deInter);
+
+	QuitImplementation();
+	_isValid = false;
+
+	_reader = FrameReader::Create(config);
+	if(!_reader.valid()){
+		osg::notify(osg::WARN) << "FileVideoStream::CreateStream: ERROR: Failed to open video file '" << config << "'." << std::endl;
+		_isValid = false;
+		return false;
+	}
+	_frameRate = _reader->GetFrameRate();
+
+	_decoder = new FrameDecodeThread(_reader.get(), FILE_VIDEO_QUEUE_SIZE);
+	_decoderHFlip = _hFlip;
+	_decoderDeinter = _isInter;
+	_decoderDeinterMode = _deinterMode;
+	_decoder->SetFrameModes(_decoderHFlip, _decoderDeinter, _decoderDeinterMode);
+	_decoder->SetLooping(getLoopingMode() == LOOPING);
+
+	GetSyncClock();
+
+	//decode the first frame now so the image is valid straight away, blocking on
+	//the decoder rather than polling update
+	_seekFrame = 0;
+	_pausedMediaTime = 0.0;
+	_decoder->start();
+	VideoFramePtr first = _decoder->WaitAndTakeFrame(0, FILE_VIDEO_FIRST_FRAME_TIMEOUT_MS);
+	if(first.valid()){
+		ShowFrame(first.get());
+	}else{
+		if(_decoder->HasReachedEnd()){
+			osg::notify(osg::WARN) << "FileVideoStream::CreateStream: ERROR: Failed to decode the first frame of '" << config << "'." << std::endl;
+		}else{
+			osg::notify(osg::WARN) << "FileVideoStream::CreateStream: ERROR: Timed out waiting " << FILE_VIDEO_FIRST_FRAME_TIMEOUT_MS << "ms for the first frame of '" << config << "'." << std::endl;
+		}
+		QuitImplementation();
+		_isValid = false;
+		return false;
+	}
+
+	SetVerticalFlip(_vFlip);
+
+	_status = PAUSED;
+	_isValid = true;
+	return true;
+}
+
+//
+//Frames are decoded top down or bottom up depending on the reader so flip by
+//choosing the origin
+//
+void FileVideoStream::SetVerticalFlip(bool flip)
+{
+	_vFlip = flip;
+	bool topDown = _reader.valid() ? _reader->IsTopDown() : false;
+	setOrigin(topDown != _vFlip ? osg::Image::TOP_LEFT : osg::Image::BOTTOM_LEFT);
+}
+
+bool FileVideoStream::HasVideoEnded()
+{
+	if(!_reader.valid() || getLoopingMode() == LOOPING){return false;}
+	return GetMediaTime() >= getLength();
+}
+
+double FileVideoStream::getLength() const
+{
+	if(!_reader.valid() || _frameRate <= 0.0){return 0.0;}
+	return _reader->GetNumFrames() / _frameRate;
+}
+
+double FileVideoStream::getFrameRate() const
+{
+	return _frameRate;
+}
+
+unsigned int FileVideoStream::GetNumFrames()const
+{
+	return _reader.valid() ? _reader->GetNumFrames() : 0;
+}
+
+//
+//Seek to the frame shown at time
+//
+void FileVideoStream::setReferenceTime(double time)
+{
+	if(!_reader.valid()){return;}
+	double frame = floor(time * _frameRate + 1e-6);
+	if(frame < 0.0){frame = 0.0;}
+	SeekToFrame((unsigned int)frame);
+}
+
+double FileVideoStream::getReferenceTime() const
+{
+	double time = GetMediaTime();
+	double length = getLength();
+	if(length <= 0.0){return 0.0;}
+	if(getLoopingMode() == LOOPING){return fmod(time, length);}
+	return time < length ? time : length;
+}
+
+//
+//Restart decoding at frame and set the media time to its start
+//
+void FileVideoStream::SeekToFrame(unsigned int frame)
+{
+	if(!_decoder.valid()){return;}
+	if(frame >= _reader->GetNumFrames()){frame = _reader->GetNumFrames()-1;}
+
+	//stale frames shown until the seek frame is decoded aren't drift
+	ResetSyncStats();
+
+	_decoder->Seek(frame);
+	_seekFrame = frame;
+
+	double time = frame / _frameRate;
+	_pausedMediaTime = time;
+	_playMediaStart = time;
+	_playClockStart = _clock->GetTime();
+}
+
+//
+//Media time in seconds since the start of the file
+//
+double FileVideoStream::GetMediaTime()const
+{
+	if(_playing && _clock.valid()){
+		double time = _playMediaStart + (_clock->GetTime() - _playClockStart);
+		if(getLoopingMode() != LOOPING){
+			double length = getLength();
+			if(time > length){time = length;}
+		}
+		return time;
+	}
+	return _pausedMediaTime;
+}
+
+//
+//Take the frame due now from the decoder, never waits on it
+//
+void FileVideoStream::update(osg::NodeVisitor* nv)
+{
+	if(!_decoder.valid()){return;}
+
+	//hand back frames a busy decoder couldn't take last time
+	while(!_recycleFrames.empty() && _decoder->RecycleFrame(_recycleFrames.back().get())){
+		_recycleFrames.pop_back();
+	}
+
+	if(_decoderHFlip != _hFlip || _decoderDeinter != _isInter || _decoderDeinterMode != _deinterMode){
+		_decoderHFlip = _hFlip;
+		_decoderDeinter = _isInter;
+		_decoderDeinterMode = _deinterMode;
+		_decoder->SetFrameModes(_decoderHFlip, _decoderDeinter, _decoderDeinterMode);
+	}
+
+	//frames since the seek frame the clock is at
+	double frames = floor(GetMediaTime() * _frameRate + 1e-6) - _seekFrame;
+	unsigned int target = frames > 0.0 ? (unsigned int)frames : 0;
+
+	VideoFramePtr frame = _decoder->TakeFrame(target);
+	if(frame.valid()){
+		ShowFrame(frame.get());
+	}
+
+	//the first frame is decoded in CreateStream before the stream is valid
+	if(_isValid && _currentFrame.valid()){
+		RecordSyncFrame(_seekFrame + target, _seekFrame + _currentFrame->_sequence);
+	}
+}
+
+//
+//Point the image at frames pixels, the previous frame is kept a frame longer
+//in case a draw thread is still uploading it
+//
+void FileVideoStream::ShowFrame(VideoFrame* frame)
+{
+	if(_previousFrame.valid()){
+		_recycleFrames.push_back(_previousFrame);
+	}
+	_previousFrame = _currentFrame;
+	_currentFrame = frame;
+
+	GLenum format = _reader->GetPixelFormat();
+	setImage(_reader->GetWidth(), _reader->GetHeight(), 1, format, format, GL_UNSIGNED_BYTE,
+			&_currentFrame->_data[0], osg::Image::NO_DELETE, 1);
+	//a file has no capture time, the nearest is when the frame is shown
+	SetFrameCaptureTime(osg::Timer::instance()->time_s());
+}
+
+void FileVideoStream::PlayImplementation()
+{
+	if(!_decoder.valid()){return;}
+	//start again from the beginning once the end has been reached
+	if(HasVideoEnded()){SeekToFrame(0);}
+	_playClockStart = _clock->GetTime();
+	_playMediaStart = _pausedMediaTime;
+	_playing = true;
+}
+
+void FileVideoStream::PauseImplementation()
+{
+	_pausedMediaTime = GetMediaTime();
+	_playing = false;
+}
+
+void FileVideoStream::RewindImplementation()
+{
+	SeekToFrame(0);
+}
+
+void FileVideoStream::QuitImplementation()
+{
+	if(_playing){pause();}
+	if(_decoder.valid()){
+		_decoder->Quit();
+		_decoder = NULL;
+	}
+	//the image keeps pointing at the current frame which we keep hold of
+	_recycleFrames.clear();
+}
+
+void FileVideoStream::applyLoopingMode()
+{
+	if(_decoder.valid()){_decoder->SetLooping(getLoopingMode() == LOOPING);}
+}
+
+//
+//Our own clock becomes the sync clock
+//
+void FileVideoStream::CreateSyncClockImplementation()
+{
+	if(!_clock.valid()){_clock = new hogboxVision::VideoFileSyncClock();}
+	_syncClock = _clock.get();
+}
+
+//
+//Switch to a shared clock, the media time carries on from where it was
+//
+void FileVideoStream::SetSyncClockImplementation(hogboxVision::VideoFileSyncClock* clock)
+{
+	double mediaTime = GetMediaTime();
+
+	//go back to a clock of our own if the shared one is removed
+	if(!clock){
+		_clock = NULL;
+		GetSyncClock();
+	}else{
+		_clock = clock;
+	}
+	_playClockStart = _clock->GetTime();
+	_playMediaStart = mediaTime;
+	_pausedMediaTime = mediaTime;
+	_isSynced = clock != NULL;
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <hogboxVision/VideoFileStream.h>
+
+#include "FrameReader.h"
+#include "FrameDecodeThread.h"
+
+//
+//FileVideoStream
+//Portable VideoFileStream reading raw rgb/yuv, YUV4MPEG2 (.y4m) and motion jpeg
+//(.mjpg) files without any platform media framework. Frames are decoded ahead on a
+//FrameDecodeThread, the stream picks the frame for its sync clocks time in its
+//update call (osg calls it for textures using the stream) without ever waiting on
+//the decoder, dropping frames if the decoder falls behind. Every frame is indexed
+//on open so seeking is frame accurate
+//
+class FileVideoStream : public hogboxVision::VideoFileStream
+{
+public:
+	FileVideoStream();
+
+    /** Copy constructor using CopyOp to manage deep vs shallow copy. */
+	FileVideoStream(const FileVideoStream& image,const osg::CopyOp& copyop=osg::CopyOp::SHALLOW_COPY);
+
+	META_Stream(hogboxVision, FileVideoStream);
+
+	//
+	//Open the video file config and decode its first frame into the image
+	virtual bool CreateStream(const std::string& config, bool hflip = false, bool vflip = false, bool deInter = false);
+
+	//
+	//Frame flips and deinterlacing are applied by the decode thread
+	virtual void SetVerticalFlip(bool flip);
+
+	//
+	//Has a non looping stream played past its last frame
+	virtual bool HasVideoEnded();
+
+	//
+	//osg::ImageStream overrides
+	virtual double getLength() const;
+	virtual double getFrameRate() const;
+
+	virtual void setReferenceTime(double time);
+	virtual double getReferenceTime() const;
+
+	//
+	//Show frame index of the file, the stream keeps its play state
+	void SeekToFrame(unsigned int frame);
+	unsigned int GetNumFrames()const;
+
+	//
+	//Display the frame due at the current clock time
+	virtual bool requiresUpdateCall() const { return true; }
+	virtual void update(osg::NodeVisitor* nv);
+
+protected:
+
+	virtual ~FileVideoStream(void);
+
+	virtual void PlayImplementation();
+	virtual void PauseImplementation();
+	virtual void RewindImplementation();
+	virtual void QuitImplementation();
+
+	virtual void applyLoopingMode();
+
+	virtual void CreateSyncClockImplementation();
+	virtual void SetSyncClockImplementation(hogboxVision::VideoFileSyncClock* clock);
+
+	//
+	//Media time in seconds since the start of the file, keeps counting when looping
+	double GetMediaTime()const;
+
+	//
+	//Point the image at frames pixels
+	void ShowFrame(VideoFrame* frame);
+
+protected:
+
+	FrameReaderPtr _reader;
+	FrameDecodeThreadPtr _decoder;
+
+	//the clock media time is taken from, kept while _syncClock is being changed
+	osg::ref_ptr<hogboxVision::VideoFileSyncClock> _clock;
+
+	//media time runs from _playMediaStart at clock time _playClockStart while playing
+	bool _playing;
+	double _playClockStart;
+	double _playMediaStart;
+	double _pausedMediaTime;
+
+	//file frame the decoder sequence counts from
+	unsigned int _seekFrame;
+
+	//the displayed frame and the one before it, which a draw thread may still be reading
+	VideoFramePtr _currentFrame;
+	VideoFramePtr _previousFrame;
+	//frames waiting to go back to a busy decoder
+	std::vector<VideoFramePtr> _recycleFrames;
+
+	//frame modes last passed to the decoder
+	bool _decoderHFlip;
+	bool _decoderDeinter;
+	hogboxVision::ImageKernels::DeinterlaceMode _decoderDeinterMode;
+};
@@ -0,0 +1,243 @@
+#include "FrameDecodeThread.h"
+
+#include <osg/Notify>
+#include <osg/Timer>
+
+FrameDecodeThread::FrameDecodeThread(FrameReader* reader, unsigned int queueSize)
+	: osg::Referenced(),
+	OpenThreads::Thread(),
+	_reader(reader),
+	_numFrames(0),
+	_queueSize(queueSize > 0 ? queueSize : 1),
+	_startFrame(0),
+	_nextSequence(0),
+	_requestedSequence(0),
+	_generation(0),
+	_looping(false),
+	_reachedEnd(false),
+	_done(false),
+	_hFlip(false),
+	_deinterlace(false),
+	_deinterMode(hogboxVision::ImageKernels::BOB)
+{
+	//the queue, the stream's current and previous frames and the one being decoded
+	_maxFrames = _queueSize + 3;
+}
+
+FrameDecodeThread::~FrameDecodeThread()
+{
+	Quit();
+}
+
+//
+//Restart decoding at frame, flushing any decoded frames
+//
+void FrameDecodeThread::Seek(unsigned int frame)
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+	while(!_ready.empty()){
+		_free.push_back(_ready.front());
+		_ready.pop_front();
+	}
+	_startFrame = frame < _reader->GetNumFrames() ? frame : _reader->GetNumFrames()-1;
+	_nextSequence = 0;
+	_requestedSequence = 0;
+	_generation++;
+	_reachedEnd = false;
+	_wake.signal();
+}
+
+void FrameDecodeThread::SetLooping(bool loop)
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+	_looping = loop;
+	if(_looping){_reachedEnd = false;}
+	_wake.signal();
+}
+
+void FrameDecodeThread::SetFrameModes(bool hflip, bool deinter, const hogboxVision::ImageKernels::DeinterlaceMode& mode)
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+	_hFlip = hflip;
+	_deinterlace = deinter;
+	_deinterMode = mode;
+}
+
+//
+//Take the newest decoded frame at or before targetSequence without blocking
+//
+VideoFrame* FrameDecodeThread::TakeFrame(unsigned int targetSequence)
+{
+	if(_mutex.trylock() != 0){return NULL;}
+	VideoFrame* frame = TakeFrameLocked(targetSequence);
+	_mutex.unlock();
+	return frame;
+}
+
+VideoFrame* FrameDecodeThread::TakeFrameLocked(unsigned int targetSequence)
+{
+	if(targetSequence > _requestedSequence){_requestedSequence = targetSequence;}
+
+	VideoFramePtr best;
+	while(!_ready.empty() && _ready.front()->_sequence <= targetSequence)
+	{
+		if(best.valid()){_free.push_back(best);}
+		best = _ready.front();
+		_ready.pop_front();
+	}
+	if(best.valid()){_wake.signal();}
+	return best.release();
+}
+
+//
+//Return a frame taken with TakeFrame
+//
+bool FrameDecodeThread::RecycleFrame(VideoFrame* frame)
+{
+	if(!frame){return true;}
+	if(_mutex.trylock() != 0){return false;}
+	_free.push_back(frame);
+	_wake.signal();
+	_mutex.unlock();
+	return true;
+}
+
+//
+//Wait for a frame at or before targetSequence to be queued and take it
+//
+VideoFrame* FrameDecodeThread::WaitAndTakeFrame(unsigned int targetSequence, unsigned long timeoutMs)
+{
+	osg::Timer_t start = osg::Timer::instance()->tick();
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+	while(true)
+	{
+		if(!_ready.empty() && _ready.front()->_sequence <= targetSequence){return TakeFrameLocked(targetSequence);}
+		if(_reachedEnd || _done){return NULL;}
+
+		double waited = osg::Timer::instance()->delta_m(start, osg::Timer::instance()->tick());
+		if(waited >= (double)timeoutMs){return NULL;}
+		_frameReady.wait(&_mutex, (unsigned long)((double)timeoutMs - waited) + 1);
+	}
+}
+
+bool FrameDecodeThread::HasReachedEnd()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+	return _reachedEnd && _ready.empty();
+}
+
+void FrameDecodeThread::Quit()
+{
+	if(!isRunning()){return;}
+	{
+		OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_mutex);
+		_done = true;
+		_wake.broadcast();
+		_frameReady.broadcast();
+	}
+	join();
+}
+
+VideoFrame* FrameDecodeThread::AcquireFrame()
+{
+	if(!_free.empty()){
+		//keep a reference for the caller once the free list lets go
+		VideoFrame* frame = _free.back().get();
+		frame->ref();
+		_free.pop_back();
+		return frame;
+	}
+	if(_numFrames < _maxFrames){
+		_numFrames++;
+		VideoFrame* frame = new VideoFrame();
+		frame->ref();
+		return frame;
+	}
+	return NULL;
+}
+
+//
+//Decode ahead until the queue is full, sleeping until a frame is taken or the
+//position changes. The reader is only used outside the lock
+//
+void FrameDecodeThread::run()
+{
+	unsigned int numFileFrames = _reader->GetNumFrames();
+
+	while(true)
+	{
+		VideoFrame* frame = NULL;
+		unsigned int sequence = 0;
+		unsigned int generation = 0;
+		unsigned int index = 0;
+		bool hflip = false;
+		bool deinter = false;
+		hogboxVision::ImageKernels::DeinterlaceMode deinterMode = hogboxVision::ImageKernels::BOB;
+
+		_mutex.lock();
+		while(!_done)
+		{
+			if(!_reachedEnd && _ready.size() < _queueSize)
+			{
+				//skip frames the stream has already passed
+				if(_nextSequence < _requestedSequence){_nextSequence = _requestedSequence;}
+
+				unsigned int absolute = _startFrame + _nextSequence;
+				if(!_looping && absolute >= numFileFrames){
+					_reachedEnd = true;
+					_frameReady.broadcast();
+					continue;
+				}
+
+				frame = AcquireFrame();
+				if(frame){
+					sequence = _nextSequence++;
+					generation = _generation;
+					index = absolute % numFileFrames;
+					hflip = _hFlip;
+					deinter = _deinterlace;
+					deinterMode = _deinterMode;
+					break;
+				}
+			}
+			_wake.wait(&_mutex);
+		}
+		bool done = _done;
+		_mutex.unlock();
+		if(done){
+			if(frame){frame->unref();}
+			break;
+		}
+
+		//decode without holding the lock
+		bool decoded = _reader->ReadFrame(index, frame);
+		if(decoded)
+		{
+			frame->_sequence = sequence;
+			unsigned int width = _reader->GetWidth();
+			unsigned int height = _reader->GetHeight();
+			unsigned int rowBytes = _reader->GetFrameSize()/height;
+			if(deinter){
+				hogboxVision::ImageKernels::Deinterlace(&frame->_data[0], rowBytes, height, rowBytes, deinterMode);
+			}
+			if(hflip){
+				hogboxVision::ImageKernels::FlipHorizontal(&frame->_data[0], width, height, rowBytes/width, rowBytes);
+			}
+		}else{
+			osg::notify(osg::WARN) << "FrameDecodeThread::run: WARN: Failed to decode frame " << index << ", stopping." << std::endl;
+		}
+
+		_mutex.lock();
+		if(decoded && generation == _generation){
+			_ready.push_back(frame);
+		}else{
+			_free.push_back(frame);
+			//a failed read ends the stream rather than retrying it forever
+			if(!decoded && generation == _generation){_reachedEnd = true;}
+		}
+		_frameReady.broadcast();
+		//drop the reference from AcquireFrame, the queues hold their own
+		frame->unref();
+		_mutex.unlock();
+	}
+}
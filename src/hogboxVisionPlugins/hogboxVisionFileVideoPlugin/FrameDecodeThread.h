@@ -0,0 +1,110 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include <OpenThreads/Thread>
+#include <OpenThreads/Mutex>
+#include <OpenThreads/Condition>
+#include <OpenThreads/ScopedLock>
+
+#include "FrameReader.h"
+
+//
+//FrameDecodeThread
+//Decodes frames from a FrameReader ahead of playback into a bounded queue.
+//Frames are numbered with a sequence counting from the last seek position (it
+//keeps counting across loops), the stream asks for the newest frame at or
+//before the sequence its clock is at. The stream side only ever trylocks so
+//a slow decode can delay a frame appearing but never stalls the caller, if the
+//decoder falls behind it skips straight to the frame being asked for.
+//
+class FrameDecodeThread : public osg::Referenced, public OpenThreads::Thread
+{
+public:
+	FrameDecodeThread(FrameReader* reader, unsigned int queueSize=4);
+
+	//
+	//Restart decoding at frame, flushing any decoded frames. Sequence 0 is frame
+	void Seek(unsigned int frame);
+
+	//
+	//Continue from the first frame after the last, or stop at the end
+	void SetLooping(bool loop);
+
+	//
+	//Flip and deinterlace applied to frames decoded after the call
+	void SetFrameModes(bool hflip, bool deinter, const hogboxVision::ImageKernels::DeinterlaceMode& mode);
+
+	//
+	//Take the newest decoded frame with a sequence at or before targetSequence,
+	//older decoded frames are dropped. Returns NULL if no such frame is ready or
+	//the queue is busy. Taken frames must be handed back with RecycleFrame
+	VideoFrame* TakeFrame(unsigned int targetSequence);
+
+	//
+	//TakeFrame that blocks for up to timeoutMs until a frame at or before
+	//targetSequence is decoded. Returns NULL on timeout or if the stream ended
+	//(or failed) first. Only for setup, playback should never wait on the decoder
+	VideoFrame* WaitAndTakeFrame(unsigned int targetSequence, unsigned long timeoutMs);
+
+	//
+	//Return a frame taken with TakeFrame, false if the queue was busy and the
+	//caller should try again later
+	bool RecycleFrame(VideoFrame* frame);
+
+	//
+	//True once a non looping stream has decoded its last frame (or failed)
+	bool HasReachedEnd();
+
+	//
+	//Stop and join the thread
+	void Quit();
+
+	virtual void run();
+
+protected:
+
+	virtual ~FrameDecodeThread();
+
+	//get a frame to decode into, NULL if all are in use. Called with _mutex held
+	VideoFrame* AcquireFrame();
+
+	//the body of TakeFrame, called with _mutex held
+	VideoFrame* TakeFrameLocked(unsigned int targetSequence);
+
+protected:
+
+	osg::ref_ptr<FrameReader> _reader;
+
+	OpenThreads::Mutex _mutex;
+	OpenThreads::Condition _wake;
+	//signalled when a frame is queued or the end is reached
+	OpenThreads::Condition _frameReady;
+
+	//decoded frames in sequence order
+	std::deque<VideoFramePtr> _ready;
+	//frames free to decode into
+	std::vector<VideoFramePtr> _free;
+	//frames allocated and the most allowed, the ready queue plus those held by the stream
+	unsigned int _numFrames;
+	unsigned int _maxFrames;
+	unsigned int _queueSize;
+
+	//file frame of sequence 0
+	unsigned int _startFrame;
+	unsigned int _nextSequence;
+	//latest sequence the stream has asked for, late frames aren't decoded
+	unsigned int _requestedSequence;
+	//bumped on every seek so frames decoded for an old position are dropped
+	unsigned int _generation;
+
+	bool _looping;
+	bool _reachedEnd;
+	bool _done;
+
+	bool _hFlip;
+	bool _deinterlace;
+	hogboxVision::ImageKernels::DeinterlaceMode _deinterMode;
+};
+typedef osg::ref_ptr<FrameDecodeThread> FrameDecodeThreadPtr;
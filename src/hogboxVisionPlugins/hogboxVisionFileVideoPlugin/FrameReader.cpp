@@ -0,0 +1,556 @@
+#include "FrameReader.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sstream>
+
+#include <osg/Notify>
+#include <osgDB/FileNameUtils>
+#include <osgDB/Registry>
+#include <osgDB/ReaderWriter>
+
+FrameReader::FrameReader()
+	: osg::Referenced(),
+	_file(NULL),
+	_width(0),
+	_height(0),
+	_numFrames(0),
+	_frameRate(25.0),
+	_pixelFormat(GL_RGB),
+	_topDown(true)
+{
+}
+
+FrameReader::~FrameReader()
+{
+	CloseFile();
+}
+
+unsigned int FrameReader::GetFrameSize()const
+{
+	unsigned int pixelBytes = 3;
+	if(_pixelFormat == GL_RGBA){pixelBytes = 4;}
+	if(_pixelFormat == GL_LUMINANCE){pixelBytes = 1;}
+	return _width*_height*pixelBytes;
+}
+
+//
+//Create a reader for the file based on its extension
+//
+FrameReader* FrameReader::Create(const std::string& fileName)
+{
+	std::string ext = osgDB::getLowerCaseFileExtension(fileName);
+
+	osg::ref_ptr<FrameReader> reader;
+	if(ext == "y4m"){
+		reader = new Y4MFrameReader();
+	}else if(ext == "mjpg" || ext == "mjpeg"){
+		reader = new MJPEGFrameReader();
+	}else if(RawFrameReader::IsRawExtension(ext)){
+		reader = new RawFrameReader(ext);
+	}else{
+		osg::notify(osg::WARN) << "FrameReader::Create: ERROR: Unsupported video file type '" << ext << "' for file '" << fileName << "'." << std::endl;
+		return NULL;
+	}
+
+	if(!reader->Open(fileName)){
+		return NULL;
+	}
+	return reader.release();
+}
+
+bool FrameReader::OpenFile(const std::string& fileName)
+{
+	CloseFile();
+	_file = fopen(fileName.c_str(), "rb");
+	if(!_file){
+		osg::notify(osg::WARN) << "FrameReader::OpenFile: ERROR: Failed to open video file '" << fileName << "'." << std::endl;
+		return false;
+	}
+	return true;
+}
+
+void FrameReader::CloseFile()
+{
+	if(_file){
+		fclose(_file);
+		_file = NULL;
+	}
+}
+
+bool FrameReader::Seek(long long offset)
+{
+#if defined(_MSC_VER)
+	return _fseeki64(_file, offset, SEEK_SET) == 0;
+#else
+	return fseeko(_file, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+long long FrameReader::Tell()
+{
+#if defined(_MSC_VER)
+	return _ftelli64(_file);
+#else
+	return (long long)ftello(_file);
+#endif
+}
+
+long long FrameReader::GetFileSize()
+{
+	long long pos = Tell();
+#if defined(_MSC_VER)
+	_fseeki64(_file, 0, SEEK_END);
+#else
+	fseeko(_file, 0, SEEK_END);
+#endif
+	long long size = Tell();
+	Seek(pos);
+	return size;
+}
+
+bool FrameReader::Read(void* buffer, size_t bytes)
+{
+	return fread(buffer, 1, bytes, _file) == bytes;
+}
+
+//
+//Parse WxH and an optional @fps from a file name, i.e. clip_640x480@29.97.nv12
+//
+bool FrameReader::ParseSizeFromName(const std::string& fileName, unsigned int& width, unsigned int& height, double& frameRate)
+{
+	std::string name = osgDB::getSimpleFileName(osgDB::getNameLessExtension(fileName));
+
+	size_t at = name.rfind('@');
+	if(at != std::string::npos){
+		double rate = atof(name.c_str()+at+1);
+		if(rate > 0.0){frameRate = rate;}
+	}
+
+	//search backwards for digits x digits
+	for(int x=(int)name.size()-2; x>0; x--)
+	{
+		if(name[x] != 'x' && name[x] != 'X'){continue;}
+		if(!isdigit((unsigned char)name[x-1]) || !isdigit((unsigned char)name[x+1])){continue;}
+
+		int start = x-1;
+		while(start > 0 && isdigit((unsigned char)name[start-1])){start--;}
+
+		width = (unsigned int)atoi(name.c_str()+start);
+		height = (unsigned int)atoi(name.c_str()+x+1);
+		return width > 0 && height > 0;
+	}
+	return false;
+}
+
+
+//
+//RawFrameReader
+//
+
+RawFrameReader::RawFrameReader(const std::string& extension)
+	: FrameReader(),
+	_extension(extension),
+	_isYUV(false),
+	_yuvFormat(hogboxVision::ImageKernels::I420),
+	_sourceFrameSize(0)
+{
+}
+
+bool RawFrameReader::IsRawExtension(const std::string& ext)
+{
+	return ext == "rgb" || ext == "rgba" || ext == "yuy2" || ext == "yuyv" ||
+		ext == "uyvy" || ext == "nv12" || ext == "i420" || ext == "yuv";
+}
+
+bool RawFrameReader::Open(const std::string& fileName)
+{
+	if(!ParseSizeFromName(fileName, _width, _height, _frameRate)){
+		osg::notify(osg::WARN) << "RawFrameReader::Open: ERROR: Raw video file '" << fileName << "' needs its size in the name, i.e. 'clip_640x480@30." << _extension << "'." << std::endl;
+		return false;
+	}
+
+	unsigned int pixels = _width*_height;
+	if(_extension == "rgb"){
+		_pixelFormat = GL_RGB;
+		_sourceFrameSize = pixels*3;
+	}else if(_extension == "rgba"){
+		_pixelFormat = GL_RGBA;
+		_sourceFrameSize = pixels*4;
+	}else{
+		//yuv is converted to rgb and needs even sizes for the chroma
+		if((_width & 1) || (_height & 1)){
+			osg::notify(osg::WARN) << "RawFrameReader::Open: ERROR: YUV video file '" << fileName << "' must have an even width and height." << std::endl;
+			return false;
+		}
+		_isYUV = true;
+		_pixelFormat = GL_RGB;
+		if(_extension == "yuy2" || _extension == "yuyv"){
+			_yuvFormat = hogboxVision::ImageKernels::YUY2;
+			_sourceFrameSize = pixels*2;
+		}else if(_extension == "uyvy"){
+			_yuvFormat = hogboxVision::ImageKernels::UYVY;
+			_sourceFrameSize = pixels*2;
+		}else if(_extension == "nv12"){
+			_yuvFormat = hogboxVision::ImageKernels::NV12;
+			_sourceFrameSize = pixels + pixels/2;
+		}else{
+			_yuvFormat = hogboxVision::ImageKernels::I420;
+			_sourceFrameSize = pixels + pixels/2;
+		}
+	}
+
+	if(!OpenFile(fileName)){return false;}
+
+	_numFrames = (unsigned int)(GetFileSize() / _sourceFrameSize);
+	if(_numFrames == 0){
+		osg::notify(osg::WARN) << "RawFrameReader::Open: ERROR: Video file '" << fileName << "' is smaller than one " << _width << "x" << _height << " frame." << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool RawFrameReader::ReadFrame(unsigned int index, VideoFrame* frame)
+{
+	if(!_file || index >= _numFrames){return false;}
+	if(!Seek((long long)index * _sourceFrameSize)){return false;}
+
+	frame->_data.resize(GetFrameSize());
+	frame->_index = index;
+
+	//rgb(a) reads straight into the frame
+	if(!_isYUV){
+		return Read(&frame->_data[0], _sourceFrameSize);
+	}
+
+	_sourceBuffer.resize(_sourceFrameSize);
+	if(!Read(&_sourceBuffer[0], _sourceFrameSize)){return false;}
+
+	unsigned int srcStride = (_yuvFormat == hogboxVision::ImageKernels::YUY2 || _yuvFormat == hogboxVision::ImageKernels::UYVY) ? _width*2 : _width;
+	hogboxVision::ImageKernels::ConvertYUVToRGB(_yuvFormat, &_sourceBuffer[0], _width, _height, srcStride, &frame->_data[0], 3, _width*3);
+	return true;
+}
+
+
+//
+//Y4MFrameReader
+//
+
+Y4MFrameReader::Y4MFrameReader()
+	: FrameReader(),
+	_mono(false),
+	_sourceFrameSize(0)
+{
+}
+
+//
+//Parse the stream header tokens, W H F and C are used, the rest are ignored
+//
+bool Y4MFrameReader::ParseHeader(const std::string& header)
+{
+	std::istringstream tokens(header);
+	std::string token;
+	tokens >> token;
+	if(token != "YUV4MPEG2"){return false;}
+
+	std::string colorSpace = "420";
+	while(tokens >> token)
+	{
+		switch(token[0])
+		{
+			case 'W': _width = (unsigned int)atoi(token.c_str()+1); break;
+			case 'H': _height = (unsigned int)atoi(token.c_str()+1); break;
+			case 'F':
+			{
+				int num = 0, den = 0;
+				if(sscanf(token.c_str()+1, "%d:%d", &num, &den) == 2 && num > 0 && den > 0){
+					_frameRate = (double)num/(double)den;
+				}
+				break;
+			}
+			case 'C': colorSpace = token.substr(1); break;
+			default: break;
+		}
+	}
+
+	if(_width == 0 || _height == 0){return false;}
+
+	if(colorSpace.compare(0, 4, "mono") == 0){
+		_mono = true;
+		_pixelFormat = GL_LUMINANCE;
+		_sourceFrameSize = _width*_height;
+	}else if(colorSpace.compare(0, 3, "420") == 0){
+		if((_width & 1) || (_height & 1)){return false;}
+		_pixelFormat = GL_RGB;
+		_sourceFrameSize = _width*_height + (_width*_height)/2;
+	}else{
+		osg::notify(osg::WARN) << "Y4MFrameReader::ParseHeader: ERROR: Unsupported colour space 'C" << colorSpace << "', only 4:2:0 and mono are supported." << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool Y4MFrameReader::Open(const std::string& fileName)
+{
+	if(!OpenFile(fileName)){return false;}
+
+	//read one header line, returns false at eof
+	std::string line;
+	line.reserve(128);
+	int c;
+	while((c = fgetc(_file)) != EOF && c != '\n'){line += (char)c;}
+
+	if(!ParseHeader(line)){
+		osg::notify(osg::WARN) << "Y4MFrameReader::Open: ERROR: '" << fileName << "' is not a supported YUV4MPEG2 file." << std::endl;
+		return false;
+	}
+
+	//index the frames, each is a FRAME line (with optional params) then the planes
+	long long fileSize = GetFileSize();
+	long long pos = Tell();
+	_frameOffsets.clear();
+	while(pos < fileSize)
+	{
+		char tag[5];
+		if(!Read(tag, 5) || memcmp(tag, "FRAME", 5) != 0){break;}
+		while((c = fgetc(_file)) != EOF && c != '\n'){}
+		if(c == EOF){break;}
+
+		long long dataStart = Tell();
+		if(dataStart + _sourceFrameSize > fileSize){break;}
+		_frameOffsets.push_back(dataStart);
+
+		pos = dataStart + _sourceFrameSize;
+		if(!Seek(pos)){break;}
+	}
+
+	_numFrames = (unsigned int)_frameOffsets.size();
+	if(_numFrames == 0){
+		osg::notify(osg::WARN) << "Y4MFrameReader::Open: ERROR: '" << fileName << "' contains no complete frames." << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool Y4MFrameReader::ReadFrame(unsigned int index, VideoFrame* frame)
+{
+	if(!_file || index >= _numFrames){return false;}
+	if(!Seek(_frameOffsets[index])){return false;}
+
+	frame->_data.resize(GetFrameSize());
+	frame->_index = index;
+
+	//mono is only the luma plane
+	if(_mono){
+		return Read(&frame->_data[0], _sourceFrameSize);
+	}
+
+	_sourceBuffer.resize(_sourceFrameSize);
+	if(!Read(&_sourceBuffer[0], _sourceFrameSize)){return false;}
+	hogboxVision::ImageKernels::ConvertYUVToRGB(hogboxVision::ImageKernels::I420, &_sourceBuffer[0], _width, _height, _width, &frame->_data[0], 3, _width*3);
+	return true;
+}
+
+
+//
+//MJPEGFrameReader
+//
+
+//
+//Buffered byte reader used to walk the jpeg markers
+//
+class MarkerScanner
+{
+public:
+	MarkerScanner(FILE* file)
+		: _file(file),
+		_bufferPos(0),
+		_bufferSize(0),
+		_bufferStart(0)
+	{
+	}
+
+	//next byte or -1 at the end of the file
+	inline int Get()
+	{
+		if(_bufferPos == _bufferSize)
+		{
+			_bufferStart += _bufferSize;
+			_bufferSize = (unsigned int)fread(_buffer, 1, sizeof(_buffer), _file);
+			_bufferPos = 0;
+			if(_bufferSize == 0){return -1;}
+		}
+		return _buffer[_bufferPos++];
+	}
+
+	//skip count bytes, false if that passes the end of the file
+	bool Skip(unsigned int count)
+	{
+		for(unsigned int i=0; i<count; i++){
+			if(Get() < 0){return false;}
+		}
+		return true;
+	}
+
+	//file position of the next byte
+	long long Position()const{return _bufferStart + _bufferPos;}
+
+protected:
+	FILE* _file;
+	unsigned char _buffer[65536];
+	unsigned int _bufferPos;
+	unsigned int _bufferSize;
+	long long _bufferStart;
+};
+
+MJPEGFrameReader::MJPEGFrameReader()
+	: FrameReader()
+{
+	//jpeg rows are bottom up once loaded by osgDB
+	_topDown = false;
+}
+
+//
+//Record each SOI..EOI range, segments are skipped by their length and the
+//entropy coded data after SOS is scanned for the next marker
+//
+bool MJPEGFrameReader::IndexFrames()
+{
+	_frames.clear();
+	Seek(0);
+	MarkerScanner scanner(_file);
+
+	int c = scanner.Get();
+	while(c >= 0)
+	{
+		//find the next SOI
+		if(c != 0xFF){c = scanner.Get(); continue;}
+		c = scanner.Get();
+		if(c != 0xD8){continue;}
+
+		FrameRange range;
+		range._start = scanner.Position()-2;
+
+		bool complete = false;
+		int marker = -1;
+		while(true)
+		{
+			//read a marker, skipping fill bytes
+			if(marker < 0){
+				c = scanner.Get();
+				if(c != 0xFF){break;}
+				do{ c = scanner.Get(); }while(c == 0xFF);
+				if(c < 0){break;}
+				marker = c;
+			}
+
+			if(marker == 0xD9){
+				complete = true;
+				break;
+			}
+
+			int current = marker;
+			marker = -1;
+
+			//standalone markers have no length
+			if(current == 0x01 || (current >= 0xD0 && current <= 0xD7)){continue;}
+
+			int hi = scanner.Get();
+			int lo = scanner.Get();
+			if(lo < 0){break;}
+			unsigned int length = (unsigned int)((hi << 8) | lo);
+			if(length < 2 || !scanner.Skip(length-2)){break;}
+
+			if(current == 0xDA)
+			{
+				//entropy coded data runs to the next marker that isn't a stuffed
+				//zero or a restart
+				while((c = scanner.Get()) >= 0)
+				{
+					if(c != 0xFF){continue;}
+					do{ c = scanner.Get(); }while(c == 0xFF);
+					if(c < 0 || c == 0x00 || (c >= 0xD0 && c <= 0xD7)){continue;}
+					marker = c;
+					break;
+				}
+				if(marker < 0){break;}
+			}
+		}
+
+		if(!complete){break;}
+		range._size = scanner.Position() - range._start;
+		_frames.push_back(range);
+		c = scanner.Get();
+	}
+
+	_numFrames = (unsigned int)_frames.size();
+	return _numFrames > 0;
+}
+
+bool MJPEGFrameReader::Open(const std::string& fileName)
+{
+	if(!osgDB::Registry::instance()->getReaderWriterForExtension("jpg")){
+		osg::notify(osg::WARN) << "MJPEGFrameReader::Open: ERROR: No osgDB jpeg plugin available to decode '" << fileName << "'." << std::endl;
+		return false;
+	}
+
+	//no frame rate is stored in the stream, use @fps in the name if given
+	unsigned int width = 0, height = 0;
+	ParseSizeFromName(fileName, width, height, _frameRate);
+
+	if(!OpenFile(fileName)){return false;}
+	if(!IndexFrames()){
+		osg::notify(osg::WARN) << "MJPEGFrameReader::Open: ERROR: '" << fileName << "' contains no complete jpeg frames." << std::endl;
+		return false;
+	}
+
+	//decode the first frame to get the size and format of the stream
+	_width = 0;
+	osg::ref_ptr<VideoFrame> first = new VideoFrame();
+	if(!ReadFrame(0, first.get())){
+		osg::notify(osg::WARN) << "MJPEGFrameReader::Open: ERROR: Failed to decode the first frame of '" << fileName << "'." << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool MJPEGFrameReader::ReadFrame(unsigned int index, VideoFrame* frame)
+{
+	if(!_file || index >= _numFrames){return false;}
+
+	const FrameRange& range = _frames[index];
+	_sourceBuffer.resize((size_t)range._size);
+	if(!Seek(range._start) || !Read(&_sourceBuffer[0], _sourceBuffer.size())){return false;}
+
+	osgDB::ReaderWriter* rw = osgDB::Registry::instance()->getReaderWriterForExtension("jpg");
+	if(!rw){return false;}
+
+	std::istringstream stream(std::string((const char*)&_sourceBuffer[0], _sourceBuffer.size()));
+	osgDB::ReaderWriter::ReadResult result = rw->readImage(stream);
+	osg::ref_ptr<osg::Image> image = result.getImage();
+	if(!image.valid() || !image->data()){return false;}
+
+	GLenum format = image->getPixelFormat();
+	if(format != GL_RGB && format != GL_RGBA && format != GL_LUMINANCE){return false;}
+
+	//the first frame decoded sets the stream format, later frames must match
+	if(_width == 0){
+		_width = image->s();
+		_height = image->t();
+		_pixelFormat = format;
+	}else if((unsigned int)image->s() != _width || (unsigned int)image->t() != _height || format != _pixelFormat){
+		osg::notify(osg::WARN) << "MJPEGFrameReader::ReadFrame: WARN: Frame " << index << " differs in size or format from the first frame." << std::endl;
+		return false;
+	}
+
+	//repack without row padding
+	unsigned int rowBytes = GetFrameSize()/_height;
+	unsigned int stride = image->getRowSizeInBytes();
+	frame->_data.resize(GetFrameSize());
+	frame->_index = index;
+	for(unsigned int row=0; row<_height; row++){
+		memcpy(&frame->_data[row*rowBytes], image->data()+row*stride, rowBytes);
+	}
+	return true;
+}
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include <osg/Referenced>
+#include <osg/ref_ptr>
+#include <osg/Image>
+
+#include <hogboxVision/ImageKernels.h>
+
+//
+//VideoFrame
+//One decoded frame, the frames are recycled between the decode thread and the stream
+//
+class VideoFrame : public osg::Referenced
+{
+public:
+	VideoFrame()
+		: osg::Referenced(),
+		_sequence(0),
+		_index(0)
+	{
+	}
+
+	//pixels in the readers output format
+	std::vector<unsigned char> _data;
+
+	//frames decoded since the last seek position, keeps counting across loops
+	unsigned int _sequence;
+	//frame index within the file
+	unsigned int _index;
+
+protected:
+	virtual ~VideoFrame(){}
+};
+typedef osg::ref_ptr<VideoFrame> VideoFramePtr;
+
+//
+//FrameReader
+//Random access reader for the frames of an uncompressed or intra only video file.
+//Open indexes every frame so any frame can be decoded directly, which gives frame
+//accurate seeking without decoding from a key frame. ReadFrame outputs pixels ready
+//for an osg::Image in GetPixelFormat, rows top to bottom if IsTopDown
+//
+class FrameReader : public osg::Referenced
+{
+public:
+	FrameReader();
+
+	//
+	//Open and index the file, returns false if it isn't usable by this reader
+	virtual bool Open(const std::string& fileName)=0;
+
+	//
+	//Decode frame index into frame, returns false on a read error
+	virtual bool ReadFrame(unsigned int index, VideoFrame* frame)=0;
+
+	const unsigned int& GetWidth()const{return _width;}
+	const unsigned int& GetHeight()const{return _height;}
+	const unsigned int& GetNumFrames()const{return _numFrames;}
+	const double& GetFrameRate()const{return _frameRate;}
+
+	//
+	//GL_RGB, GL_RGBA or GL_LUMINANCE
+	const GLenum& GetPixelFormat()const{return _pixelFormat;}
+	const bool& IsTopDown()const{return _topDown;}
+
+	//
+	//Bytes in one output frame
+	unsigned int GetFrameSize()const;
+
+	//
+	//Create a reader for the file based on its extension, NULL if unsupported. Raw files
+	//need their size in the name, i.e. clip_1280x720@30.nv12
+	static FrameReader* Create(const std::string& fileName);
+
+protected:
+
+	virtual ~FrameReader();
+
+	bool OpenFile(const std::string& fileName);
+	void CloseFile();
+
+	//64 bit file positioning
+	bool Seek(long long offset);
+	long long Tell();
+	long long GetFileSize();
+	bool Read(void* buffer, size_t bytes);
+
+	//
+	//Parse WxH and @fps from a file name, the frame rate is set even if there is no size
+	static bool ParseSizeFromName(const std::string& fileName, unsigned int& width, unsigned int& height, double& frameRate);
+
+protected:
+
+	FILE* _file;
+
+	unsigned int _width;
+	unsigned int _height;
+	unsigned int _numFrames;
+	double _frameRate;
+
+	GLenum _pixelFormat;
+	bool _topDown;
+};
+typedef osg::ref_ptr<FrameReader> FrameReaderPtr;
+
+//
+//RawFrameReader
+//Headerless frames of RGB, RGBA or YUV (.rgb .rgba .yuy2 .uyvy .nv12 .i420/.yuv),
+//YUV frames are converted to RGB
+//
+class RawFrameReader : public FrameReader
+{
+public:
+	RawFrameReader(const std::string& extension);
+
+	virtual bool Open(const std::string& fileName);
+	virtual bool ReadFrame(unsigned int index, VideoFrame* frame);
+
+	static bool IsRawExtension(const std::string& extension);
+
+protected:
+	virtual ~RawFrameReader(){}
+
+	std::string _extension;
+	//true if the file holds yuv
+	bool _isYUV;
+	hogboxVision::ImageKernels::YUVFormat _yuvFormat;
+	//bytes of one frame in the file
+	unsigned int _sourceFrameSize;
+	//yuv source data
+	std::vector<unsigned char> _sourceBuffer;
+};
+
+//
+//Y4MFrameReader
+//YUV4MPEG2 streams with 4:2:0 or mono frames, the per frame headers are indexed on open
+//
+class Y4MFrameReader : public FrameReader
+{
+public:
+	Y4MFrameReader();
+
+	virtual bool Open(const std::string& fileName);
+	virtual bool ReadFrame(unsigned int index, VideoFrame* frame);
+
+protected:
+	virtual ~Y4MFrameReader(){}
+
+	bool ParseHeader(const std::string& header);
+
+	bool _mono;
+	unsigned int _sourceFrameSize;
+	std::vector<long long> _frameOffsets;
+	std::vector<unsigned char> _sourceBuffer;
+};
+
+//
+//MJPEGFrameReader
+//Concatenated JPEG images, the frame boundaries are found by walking the JPEG
+//markers on open, frames are decoded with the osgDB jpeg plugin
+//
+class MJPEGFrameReader : public FrameReader
+{
+public:
+	MJPEGFrameReader();
+
+	virtual bool Open(const std::string& fileName);
+	virtual bool ReadFrame(unsigned int index, VideoFrame* frame);
+
+protected:
+	virtual ~MJPEGFrameReader(){}
+
+	//find the start and end of every image in the file
+	bool IndexFrames();
+
+	struct FrameRange
+	{
+		long long _start;
+		long long _size;
+	};
+	std::vector<FrameRange> _frames;
+	std::vector<unsigned char> _sourceBuffer;
+};
@@ -1,6 +1,7 @@
 #import "IPhoneCameraController.h"
 
 #include <osg/ImageUtils>
+#include <osg/Timer>
 #include "IPhoneWebCamStream.h"
 
 @implementation IPhoneCameraController
@@ -177,6 +178,16 @@ didOutputSampleBuffer:(CMSampleBufferRef)sampleBuffer
 	//connection.videoMirrored = YES;
 	NSAutoreleasePool * pool = [[NSAutoreleasePool alloc] init];
 	
+	//capture timestamps are on the host clock, measure how long ago this one
+	//was taken. If it has none fall back to when the buffer reached us
+	double captureTime = osg::Timer::instance()->time_s();
+	CMTime presentationTime = CMSampleBufferGetPresentationTimeStamp(sampleBuffer);
+	if(CMTIME_IS_NUMERIC(presentationTime))
+	{
+		double age = CMTimeGetSeconds(CMClockGetTime(CMClockGetHostTimeClock())) - CMTimeGetSeconds(presentationTime);
+		if(age > 0.0){captureTime -= age;}
+	}
+	
 	//get the image buffer then lock it so we can safely copy it
     CVImageBufferRef imageBuffer = CMSampleBufferGetImageBuffer(sampleBuffer); 
     CVPixelBufferLockBaseAddress(imageBuffer,0); 
@@ -250,6 +261,9 @@ didOutputSampleBuffer:(CMSampleBufferRef)sampleBuffer
 	p_image->setImage(width, height,1, _format, GL_BGRA, 
 					 GL_UNSIGNED_BYTE, _imageBuffer, osg::Image::NO_DELETE, 1);
 
+	hogboxVision::VideoStream* stream = dynamic_cast<hogboxVision::VideoStream*>(p_image.get());
+	if(stream){stream->SetFrameCaptureTime(captureTime);}
+
 	//unlock the buffer
 	CVPixelBufferUnlockBaseAddress(imageBuffer,0);
 	
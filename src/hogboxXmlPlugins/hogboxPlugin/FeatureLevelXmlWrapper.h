@@ -56,23 +56,22 @@ protected:
 	virtual ~FeatureLevelXmlWrapper(void){}
 
     //
-    //Bind the xml attributes for the wrapped object
-    virtual void bindXmlAttributes(){
-        hogbox::SystemFeatureLevel* featureLevel = dynamic_cast<hogbox::SystemFeatureLevel*>(p_wrappedObject.get());
-        
-		_xmlAttributes["GLVersion"] = new hogboxDB::TypedXmlAttribute<float>("GLVersion", &featureLevel->glVersion);
-        
-		_xmlAttributes["GLSLVersion"] = new hogboxDB::TypedXmlAttribute<float>("GLSLVersion", &featureLevel->glslVersion);
-        
-		_xmlAttributes["TextureUnits"] = new hogboxDB::TypedXmlAttribute<int>("TextureUnits", &featureLevel->textureUnits);
-        
-		_xmlAttributes["TextureCoordUnits"] = new hogboxDB::TypedXmlAttribute<int>("TextureCoordUnits", &featureLevel->textureCoordUnits);
-        
-		_xmlAttributes["VertexAndFragmentShader"] = new hogboxDB::TypedXmlAttribute<bool>("VertexAndFragmentShader", &featureLevel->vertexAndFragmentShaders);
-        
-		_xmlAttributes["GeometryShader"] = new hogboxDB::TypedXmlAttribute<bool>("GeometryShader", &featureLevel->geometryShaders);
-        
-		_xmlAttributes["ScreenResolution"] = new hogboxDB::TypedXmlAttribute<osg::Vec2>("ScreenResolution", &featureLevel->screenRes);
+    //The xml attributes of SystemFeatureLevel
+    virtual const hogboxDB::XmlAttributeTable* getXmlAttributeTable(){
+        static hogboxDB::XmlAttributeTablePtr s_table;
+        OpenThreads::ScopedLock<OpenThreads::ReentrantMutex> lock(*hogboxDB::XmlAttributeTable::getBuildMutex());
+        if(!s_table.valid()){
+            s_table = new hogboxDB::XmlAttributeTable();
+            
+            s_table->addMember("GLVersion", &hogbox::SystemFeatureLevel::glVersion);
+            s_table->addMember("GLSLVersion", &hogbox::SystemFeatureLevel::glslVersion);
+            s_table->addMember("TextureUnits", &hogbox::SystemFeatureLevel::textureUnits);
+            s_table->addMember("TextureCoordUnits", &hogbox::SystemFeatureLevel::textureCoordUnits);
+            s_table->addMember("VertexAndFragmentShader", &hogbox::SystemFeatureLevel::vertexAndFragmentShaders);
+            s_table->addMember("GeometryShader", &hogbox::SystemFeatureLevel::geometryShaders);
+            s_table->addMember("ScreenResolution", &hogbox::SystemFeatureLevel::screenRes);
+        }
+        return s_table.get();
     }
 };
 
@@ -61,30 +61,30 @@ protected:
 	virtual ~HogBoxLightXmlWrapper(void){}
     
     //
-    //Bind the xml attributes for the wrapped object
-    virtual void bindXmlAttributes(){
- 
-        hogbox::HogBoxLight* hogboxLight = dynamic_cast<hogbox::HogBoxLight*>(p_wrappedObject.get());
-        
-		//Position attribute Vec3
-		_xmlAttributes["Position"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxLight,osg::Vec4>
-                                    ("Position", hogboxLight,
-                                    &hogbox::HogBoxLight::GetPosition,
-                                    &hogbox::HogBoxLight::SetPosition);
-        
-		//Colors
-		_xmlAttributes["Diffuse"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxLight,osg::Vec4>
-                                    ("Diffuse", hogboxLight,
-                                    &hogbox::HogBoxLight::GetDiffuse,
-                                    &hogbox::HogBoxLight::SetDiffuse);
-		_xmlAttributes["Ambient"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxLight,osg::Vec4>
-                                    ("Ambient", hogboxLight,
-                                    &hogbox::HogBoxLight::GetAmbient,
-                                    &hogbox::HogBoxLight::SetAmbient);
-		_xmlAttributes["Specular"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxLight,osg::Vec4>
-                                    ("Specular", hogboxLight,
-                                    &hogbox::HogBoxLight::GetSpecular,
-                                    &hogbox::HogBoxLight::SetSpecular);
+    //The xml attributes of HogBoxLight
+    virtual const hogboxDB::XmlAttributeTable* getXmlAttributeTable(){
+        static hogboxDB::XmlAttributeTablePtr s_table;
+        OpenThreads::ScopedLock<OpenThreads::ReentrantMutex> lock(*hogboxDB::XmlAttributeTable::getBuildMutex());
+        if(!s_table.valid()){
+            s_table = new hogboxDB::XmlAttributeTable();
+            
+            //Position attribute Vec3
+            s_table->addProperty<hogbox::HogBoxLight,osg::Vec4>("Position",
+                                                                &hogbox::HogBoxLight::GetPosition,
+                                                                &hogbox::HogBoxLight::SetPosition);
+            
+            //Colors
+            s_table->addProperty<hogbox::HogBoxLight,osg::Vec4>("Diffuse",
+                                                                &hogbox::HogBoxLight::GetDiffuse,
+                                                                &hogbox::HogBoxLight::SetDiffuse);
+            s_table->addProperty<hogbox::HogBoxLight,osg::Vec4>("Ambient",
+                                                                &hogbox::HogBoxLight::GetAmbient,
+                                                                &hogbox::HogBoxLight::SetAmbient);
+            s_table->addProperty<hogbox::HogBoxLight,osg::Vec4>("Specular",
+                                                                &hogbox::HogBoxLight::GetSpecular,
+                                                                &hogbox::HogBoxLight::SetSpecular);
+        }
+        return s_table.get();
     }
 
 };
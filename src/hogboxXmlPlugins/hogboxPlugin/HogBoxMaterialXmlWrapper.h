@@ -49,6 +49,25 @@ public:
 
 		material->setName(name);
 	}
+
+	//the shader and uniform lists are added to the material as they're set,
+	//so remove the current ones before reading the changed node
+	virtual bool reload(osgDB::XmlNode* in)
+	{
+		hogbox::HogBoxMaterial* material = dynamic_cast<hogbox::HogBoxMaterial*>(p_wrappedObject.get());
+		if(material)
+		{
+			osg::ShaderPtrVector shaders = material->GetShaderList();
+			for(unsigned int i=0; i<shaders.size(); i++){
+				material->RemoveShader(shaders[i].get());
+			}
+			osg::UniformPtrVector uniforms = material->GetUniformList();
+			for(unsigned int i=0; i<uniforms.size(); i++){
+				material->RemoveUniform(uniforms[i].get());
+			}
+		}
+		return this->deserialize(in);
+	}
     
     
 
@@ -57,98 +76,79 @@ protected:
 	virtual ~HogBoxMaterialXmlWrapper(void){}
     
     //
-    //Bind the xml attributes for the wrapped object
-    virtual void bindXmlAttributes(){
-        
-        hogbox::HogBoxMaterial* material = dynamic_cast<hogbox::HogBoxMaterial*>(p_wrappedObject.get());
-		_xmlAttributes["AmbientColor"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxMaterial,osg::Vec3>
-                                        ("AmbientColor", material,
-                                        &hogbox::HogBoxMaterial::GetAmbient,
-                                        &hogbox::HogBoxMaterial::SetAmbient);
-        
-		_xmlAttributes["DiffuseColor"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxMaterial,osg::Vec3>
-                                        ("DiffuseColor", material,
-                                         &hogbox::HogBoxMaterial::GetDiffuse,
-                                         &hogbox::HogBoxMaterial::SetDiffuse);
-        
-		_xmlAttributes["SpecularColor"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxMaterial,osg::Vec3>
-                                            ("SpecularColor", material,
-                                            &hogbox::HogBoxMaterial::GetSpecular,
-                                            &hogbox::HogBoxMaterial::SetSpecular);
-        
-		_xmlAttributes["Shine"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxMaterial,double>
-                                ("Shine", material,
-                                &hogbox::HogBoxMaterial::GetShine,
-                                &hogbox::HogBoxMaterial::SetShine);
-        
-		_xmlAttributes["Opacity"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxMaterial,double>
-                                    ("Opacity", material,
-                                    &hogbox::HogBoxMaterial::GetAlphaValue,
-                                    &hogbox::HogBoxMaterial::SetAlphaValue);
-        
-		_xmlAttributes["EnableAlpha"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxMaterial,bool>
-                                        ("EnableAlpha", material,
-                                        &hogbox::HogBoxMaterial::GetAlphaEnabled,
-                                        &hogbox::HogBoxMaterial::SetAlphaEnabled);
-        
-		_xmlAttributes["TwoSided"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxMaterial,bool>
-                                        ("TwoSided", material,
-                                        &hogbox::HogBoxMaterial::GetTwoSidedLightingEnabled,
-                                        &hogbox::HogBoxMaterial::SetTwoSidedLightingEnabled);
-		
-		_xmlAttributes["BinNumber"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxMaterial,int>
-                                    ("BinNumber", material,
-                                    &hogbox::HogBoxMaterial::GetBinNumber,
-                                    &hogbox::HogBoxMaterial::SetBinNumber);
-        
-		_xmlAttributes["BinHint"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxMaterial,int>
-                                    ("BinHint", material,
-                                    &hogbox::HogBoxMaterial::GetBinHint,
-                                    &hogbox::HogBoxMaterial::SetBinHint);
-        
-		//wrap textures
-		_xmlAttributes["TextureChannels"] = new hogboxDB::CallbackXmlClassPointerMap<hogbox::HogBoxMaterial,int,osg::Texture>
-                                            ("TextureChannels", material,
-                                            &hogbox::HogBoxMaterial::GetTexture,
-                                            &hogbox::HogBoxMaterial::SetTexture);
-        
-		//wrap uniforms
-		_xmlAttributes["Uniforms"] = new hogboxDB::CallbackXmlClassPointerList<hogbox::HogBoxMaterial,osg::UniformPtrVector, osg::Uniform>
-                                    ("Uniforms", material,
-                                    &hogbox::HogBoxMaterial::GetUniformList,
-                                    &hogbox::HogBoxMaterial::SetUniformList);
-		//wrap shaders
-		_xmlAttributes["Shaders"] = new hogboxDB::CallbackXmlClassPointerList<hogbox::HogBoxMaterial,osg::ShaderPtrVector, osg::Shader>
-                                    ("Shaders", material,
-                                    &hogbox::HogBoxMaterial::GetShaderList,
-                                    &hogbox::HogBoxMaterial::SetShaderList);
-        
-		//flag that tangent space vectors are required
-		_xmlAttributes["UseTangentSpace"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxMaterial,bool>
-                                            ("UseTangentSpace", material,
-                                            &hogbox::HogBoxMaterial::IsUsingTangetSpace,
-                                            &hogbox::HogBoxMaterial::UseTangentSpace);
-        
-		//Flag use of skinning
-		_xmlAttributes["UseSkinning"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxMaterial,bool>
-                                        ("UseSkinning", material,
-                                        &hogbox::HogBoxMaterial::IsUsingSkinning,
-                                        &hogbox::HogBoxMaterial::UseSkinning);
-        
-		//fallback infomation
-        
-		//feature level pointer
-		_xmlAttributes["RequiredFeatureLevel"] = new hogboxDB::CallbackXmlClassPointer<hogbox::HogBoxMaterial, hogbox::SystemFeatureLevel>
-                                                ("RequiredFeatureLevel", material,
-                                                &hogbox::HogBoxMaterial::GetFeatureLevel,
-                                                &hogbox::HogBoxMaterial::SetFeatureLevel);
-        
-		//pointer to the fallback material type
-		_xmlAttributes["FallbackMaterial"] = new hogboxDB::CallbackXmlClassPointer<hogbox::HogBoxMaterial, hogbox::HogBoxMaterial>
-                                            ("FallbackMaterial", material,
-                                            &hogbox::HogBoxMaterial::GetFallbackMaterial,
-                                            &hogbox::HogBoxMaterial::SetFallbackMaterial);
-
+    //The xml attributes of HogBoxMaterial
+    virtual const hogboxDB::XmlAttributeTable* getXmlAttributeTable(){
+        static hogboxDB::XmlAttributeTablePtr s_table;
+        OpenThreads::ScopedLock<OpenThreads::ReentrantMutex> lock(*hogboxDB::XmlAttributeTable::getBuildMutex());
+        if(!s_table.valid()){
+            s_table = new hogboxDB::XmlAttributeTable();
+            
+            s_table->addProperty<hogbox::HogBoxMaterial,osg::Vec3>("AmbientColor",
+                                                                   &hogbox::HogBoxMaterial::GetAmbient,
+                                                                   &hogbox::HogBoxMaterial::SetAmbient);
+            s_table->addProperty<hogbox::HogBoxMaterial,osg::Vec3>("DiffuseColor",
+                                                                   &hogbox::HogBoxMaterial::GetDiffuse,
+                                                                   &hogbox::HogBoxMaterial::SetDiffuse);
+            s_table->addProperty<hogbox::HogBoxMaterial,osg::Vec3>("SpecularColor",
+                                                                   &hogbox::HogBoxMaterial::GetSpecular,
+                                                                   &hogbox::HogBoxMaterial::SetSpecular);
+            s_table->addProperty<hogbox::HogBoxMaterial,double>("Shine",
+                                                                &hogbox::HogBoxMaterial::GetShine,
+                                                                &hogbox::HogBoxMaterial::SetShine);
+            s_table->addProperty<hogbox::HogBoxMaterial,double>("Opacity",
+                                                                &hogbox::HogBoxMaterial::GetAlphaValue,
+                                                                &hogbox::HogBoxMaterial::SetAlphaValue);
+            s_table->addProperty<hogbox::HogBoxMaterial,bool>("EnableAlpha",
+                                                              &hogbox::HogBoxMaterial::GetAlphaEnabled,
+                                                              &hogbox::HogBoxMaterial::SetAlphaEnabled);
+            s_table->addProperty<hogbox::HogBoxMaterial,bool>("TwoSided",
+                                                              &hogbox::HogBoxMaterial::GetTwoSidedLightingEnabled,
+                                                              &hogbox::HogBoxMaterial::SetTwoSidedLightingEnabled);
+            
+            s_table->addProperty<hogbox::HogBoxMaterial,int>("BinNumber",
+                                                             &hogbox::HogBoxMaterial::GetBinNumber,
+                                                             &hogbox::HogBoxMaterial::SetBinNumber);
+            s_table->addProperty<hogbox::HogBoxMaterial,int>("BinHint",
+                                                             &hogbox::HogBoxMaterial::GetBinHint,
+                                                             &hogbox::HogBoxMaterial::SetBinHint);
+            
+            //wrap textures
+            s_table->addPointerMap<hogbox::HogBoxMaterial,int,osg::Texture>("TextureChannels",
+                                                                            &hogbox::HogBoxMaterial::GetTexture,
+                                                                            &hogbox::HogBoxMaterial::SetTexture);
+            
+            //wrap uniforms
+            s_table->addPointerList<hogbox::HogBoxMaterial,osg::UniformPtrVector,osg::Uniform>("Uniforms",
+                                                                                               &hogbox::HogBoxMaterial::GetUniformList,
+                                                                                               &hogbox::HogBoxMaterial::SetUniformList);
+            //wrap shaders
+            s_table->addPointerList<hogbox::HogBoxMaterial,osg::ShaderPtrVector,osg::Shader>("Shaders",
+                                                                                             &hogbox::HogBoxMaterial::GetShaderList,
+                                                                                             &hogbox::HogBoxMaterial::SetShaderList);
+            
+            //flag that tangent space vectors are required
+            s_table->addProperty<hogbox::HogBoxMaterial,bool>("UseTangentSpace",
+                                                              &hogbox::HogBoxMaterial::IsUsingTangetSpace,
+                                                              &hogbox::HogBoxMaterial::UseTangentSpace);
+            
+            //Flag use of skinning
+            s_table->addProperty<hogbox::HogBoxMaterial,bool>("UseSkinning",
+                                                              &hogbox::HogBoxMaterial::IsUsingSkinning,
+                                                              &hogbox::HogBoxMaterial::UseSkinning);
+            
+            //fallback infomation
+            
+            //feature level pointer
+            s_table->addPointer<hogbox::HogBoxMaterial,hogbox::SystemFeatureLevel>("RequiredFeatureLevel",
+                                                                                   &hogbox::HogBoxMaterial::GetFeatureLevel,
+                                                                                   &hogbox::HogBoxMaterial::SetFeatureLevel);
+            
+            //pointer to the fallback material type
+            s_table->addPointer<hogbox::HogBoxMaterial,hogbox::HogBoxMaterial>("FallbackMaterial",
+                                                                               &hogbox::HogBoxMaterial::GetFallbackMaterial,
+                                                                               &hogbox::HogBoxMaterial::SetFallbackMaterial);
+        }
+        return s_table.get();
     }
 
 };
@@ -44,52 +44,57 @@ public:
     //
     virtual XmlClassWrapper* cloneType(){return new HogBoxObjectXmlWrapper();} 
 
+	//the node and mapping lists are added to the object as they're set, so
+	//detach the current ones before reading the changed node
+	virtual bool reload(osgDB::XmlNode* in)
+	{
+		hogbox::HogBoxObject* object = dynamic_cast<hogbox::HogBoxObject*>(p_wrappedObject.get());
+		if(object){
+			object->ClearWrappedNodes();
+			object->ClearMeshMappings();
+		}
+		return this->deserialize(in);
+	}
+
 protected:
 
 	virtual ~HogBoxObjectXmlWrapper(void){}
     
     //
-    //Bind the xml attributes for the wrapped object
-    virtual void bindXmlAttributes(){
-        
-        hogbox::HogBoxObject* hogboxObject = dynamic_cast<hogbox::HogBoxObject*>(p_wrappedObject.get());
-        
-		//Position attribute Vec3
-		_xmlAttributes["Position"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxObject,osg::Vec3>
-                                    ("Position", hogboxObject,
-                                    &hogbox::HogBoxObject::GetLocalTranslation,
-                                    &hogbox::HogBoxObject::SetLocalTranslation);
-		//RotationRadians attribute Vec3 in radians
-		//_xmlAttributes["RotationRadians"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxObject,osg::Vec3>(hogboxObject,
-		//															&hogbox::HogBoxObject::GetRotationRadians,
-		//															&hogbox::HogBoxObject::SetRotationRadians);
-		//RotationDegrees attribute Vec3 in degrees
-		_xmlAttributes["Rotation"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxObject,osg::Vec3>
-                                    ("Rotation", hogboxObject,
-                                    &hogbox::HogBoxObject::GetLocalRotation,
-                                     &hogbox::HogBoxObject::SetLocalRotation);
-		//scale Vec3
-		_xmlAttributes["Scale"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxObject,osg::Vec3>
-                                ("Scale",hogboxObject,
-                                &hogbox::HogBoxObject::GetLocalScale,
-                                &hogbox::HogBoxObject::SetLocalScale);
-        
-		//hogbox objects wrap a set of osg nodes which need to be added to the object
-		//via AddNodeToObject. The xml reader will read the list of nodes, directly
-		//into _wrappededNodes. Once reading is complete the list is passed trough 
-		//AddNodeToObject so that child nodes etc can be wrapped
-		_xmlAttributes["ModelNodes"] = new hogboxDB::CallbackXmlClassPointerList<hogbox::HogBoxObject,osg::NodePtrVector, osg::Node>
-                                        ("ModelNodes", hogboxObject,
-                                         &hogbox::HogBoxObject::GetWrappedNodes,
-                                         &hogbox::HogBoxObject::SetWrappedNodes);
-        
-		//the list of meshmappings
-		_xmlAttributes["MeshMappings"] = new hogboxDB::CallbackXmlClassPointerList<hogbox::HogBoxObject,
-                                                                                    hogbox::MeshMappingPtrVector, 
-                                                                                    hogbox::MeshMapping>
-                                        ("MeshMappings", hogboxObject,
-                                        &hogbox::HogBoxObject::GetMeshMappings,
-                                        &hogbox::HogBoxObject::SetMeshMappings);
+    //The xml attributes of HogBoxObject
+    virtual const hogboxDB::XmlAttributeTable* getXmlAttributeTable(){
+        static hogboxDB::XmlAttributeTablePtr s_table;
+        OpenThreads::ScopedLock<OpenThreads::ReentrantMutex> lock(*hogboxDB::XmlAttributeTable::getBuildMutex());
+        if(!s_table.valid()){
+            s_table = new hogboxDB::XmlAttributeTable();
+            
+            //Position attribute Vec3
+            s_table->addProperty<hogbox::HogBoxObject,osg::Vec3>("Position",
+                                                                 &hogbox::HogBoxObject::GetLocalTranslation,
+                                                                 &hogbox::HogBoxObject::SetLocalTranslation);
+            //RotationDegrees attribute Vec3 in degrees
+            s_table->addProperty<hogbox::HogBoxObject,osg::Vec3>("Rotation",
+                                                                 &hogbox::HogBoxObject::GetLocalRotation,
+                                                                 &hogbox::HogBoxObject::SetLocalRotation);
+            //scale Vec3
+            s_table->addProperty<hogbox::HogBoxObject,osg::Vec3>("Scale",
+                                                                 &hogbox::HogBoxObject::GetLocalScale,
+                                                                 &hogbox::HogBoxObject::SetLocalScale);
+            
+            //hogbox objects wrap a set of osg nodes which need to be added to the object
+            //via AddNodeToObject. The xml reader will read the list of nodes, directly
+            //into _wrappededNodes. Once reading is complete the list is passed trough 
+            //AddNodeToObject so that child nodes etc can be wrapped
+            s_table->addPointerList<hogbox::HogBoxObject,osg::NodePtrVector,osg::Node>("ModelNodes",
+                                                                                       &hogbox::HogBoxObject::GetWrappedNodes,
+                                                                                       &hogbox::HogBoxObject::SetWrappedNodes);
+            
+            //the list of meshmappings
+            s_table->addPointerList<hogbox::HogBoxObject,hogbox::MeshMappingPtrVector,hogbox::MeshMapping>("MeshMappings",
+                                                                                                           &hogbox::HogBoxObject::GetMeshMappings,
+                                                                                                           &hogbox::HogBoxObject::SetMeshMappings);
+        }
+        return s_table.get();
     }
 
 };
@@ -48,6 +48,17 @@ public:
 		return false;
 	}
 
+	//the window is already open, so just apply the changed settings to the
+	//viewer. Settings only used to create a window apply when it's next created
+	virtual bool reload(osgDB::XmlNode* in)
+	{
+		if(!XmlClassWrapper::deserialize(in)){return false;}
+		hogbox::HogBoxViewer* viewer = dynamic_cast<hogbox::HogBoxViewer*>(p_wrappedObject.get());
+		if(!viewer){return false;}
+		viewer->SetDeviceOrientationFlags(GetFlagsFromStringList(_orientationStrings));
+		return true;
+	}
+
     //
     virtual osg::Object* allocateClassType(){return new hogbox::HogBoxViewer();}
     
@@ -59,110 +70,88 @@ protected:
 	virtual ~HogBoxViewerXmlWrapper(void){}
     
     //
-    //Bind the xml attributes for the wrapped object
-    virtual void bindXmlAttributes(){
-        hogbox::HogBoxViewer* hogboxViewer = dynamic_cast<hogbox::HogBoxViewer*>(p_wrappedObject.get());
-        
-		//Position attribute Vec3
-		_xmlAttributes["ScreenID"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxViewer,unsigned int>
-                                    ("ScreenID", hogboxViewer,
-                                   &hogbox::HogBoxViewer::GetScreenID,
-                                   &hogbox::HogBoxViewer::SetScreenID);
-        
-		//screen name
-		_xmlAttributes["Title"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxViewer,std::string>
-                                ("Title", hogboxViewer,
-                               &hogbox::HogBoxViewer::GetWindowName,
-                               &hogbox::HogBoxViewer::SetWindowName);
-        
-		//window stuff
-		_xmlAttributes["Size"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxViewer,osg::Vec2>
-                                ("Size", hogboxViewer,
-                                &hogbox::HogBoxViewer::GetWindowSize,
-                                &hogbox::HogBoxViewer::SetWindowSize);
-        
-		_xmlAttributes["Corner"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxViewer,osg::Vec2>
-                                ("Corner", hogboxViewer,
-                                &hogbox::HogBoxViewer::GetWindowCorner,
-                                &hogbox::HogBoxViewer::SetWindowCorner);
-        
-		_xmlAttributes["DoubleBuffer"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxViewer,bool>
-                                        ("DoubleBuffer", hogboxViewer,
-                                        &hogbox::HogBoxViewer::GetDoubleBuffered,
-                                        &hogbox::HogBoxViewer::SetDoubleBuffered);
-        
-		_xmlAttributes["VerticalSync"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxViewer,bool>
-                                        ("VerticalSync", hogboxViewer,
-                                        &hogbox::HogBoxViewer::GetVSync,
-                                        &hogbox::HogBoxViewer::SetVSync);
-        
-		_xmlAttributes["ColorBits"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxViewer,unsigned int>
-                                    ("ColorBits", hogboxViewer,
-                                    &hogbox::HogBoxViewer::GetColorBits,
-                                    &hogbox::HogBoxViewer::SetColorBits);
-		_xmlAttributes["DepthBits"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxViewer,unsigned int>
-                                    ("DepthBits", hogboxViewer,
-                                    &hogbox::HogBoxViewer::GetDepthBits,
-                                    &hogbox::HogBoxViewer::SetDepthBits);
-		_xmlAttributes["AlphaBits"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxViewer,unsigned int>
-                                    ("AlphaBits", hogboxViewer,
-                                    &hogbox::HogBoxViewer::GetAlphaBits,
-                                    &hogbox::HogBoxViewer::SetAlphaBits);
-		_xmlAttributes["StencilBits"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxViewer,unsigned int>
-                                    ("StencilBits", hogboxViewer,
-                                    &hogbox::HogBoxViewer::GetStencilBits,
-                                    &hogbox::HogBoxViewer::SetStencilBits);
-        
-		_xmlAttributes["FullScreen"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxViewer,bool>
-                                        ("FullScreen", hogboxViewer,
-                                        &hogbox::HogBoxViewer::isFullScreen,
-                                        &hogbox::HogBoxViewer::SetFullScreen);
-		_xmlAttributes["Boarder"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxViewer,bool>
-                                        ("Boarder", hogboxViewer,
-                                        &hogbox::HogBoxViewer::GetWindowDecoration,
-                                        &hogbox::HogBoxViewer::SetWindowDecoration);
-		_xmlAttributes["ShowCursor"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxViewer,bool>
-                                        ("ShowCursor", hogboxViewer,
-                                        &hogbox::HogBoxViewer::isCursorVisible,
-                                        &hogbox::HogBoxViewer::SetCursorVisible);
-        
-		//
-		_xmlAttributes["ClearColor"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxViewer,osg::Vec4>
-                                        ("ClearColor", hogboxViewer,
-                                        &hogbox::HogBoxViewer::GetClearColor,
-                                        &hogbox::HogBoxViewer::SetClearColor);
-		_xmlAttributes["AASamples"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxViewer,int>
-                                        ("AASamples", hogboxViewer,
-                                        &hogbox::HogBoxViewer::GetAASamples,
-                                        &hogbox::HogBoxViewer::SetAASamples);
-        
-		//stereo stuff
-		_xmlAttributes["UseStereo"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxViewer,bool>
-                                        ("UseStereo", hogboxViewer,
-                                        &hogbox::HogBoxViewer::isUsingStereo,
-                                        &hogbox::HogBoxViewer::SetUseStereo);
-        
-		_xmlAttributes["ConvergenceDistance"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxViewer,float>
-                                                ("ConvergenceDistance", hogboxViewer,
-                                                &hogbox::HogBoxViewer::GetStereoConvDistance,
-                                                &hogbox::HogBoxViewer::SetStereoConvDistance);
-		_xmlAttributes["EyeSeperation"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxViewer,float>
-                                            ("EyeSeperation", hogboxViewer,
-                                            &hogbox::HogBoxViewer::GetStereoEyeSeperation,
-                                            &hogbox::HogBoxViewer::SetStereoEyeSeperation);
-		_xmlAttributes["SwapEyes"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxViewer,bool>
-                                        ("SwapEyes", hogboxViewer,
-                                        &hogbox::HogBoxViewer::GetSwapEyes,
-                                        &hogbox::HogBoxViewer::SetSwapEyes);
-		_xmlAttributes["StereoMode"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxViewer,int>
-                                        ("StereoMode", hogboxViewer,
-                                        &hogbox::HogBoxViewer::GetStereoMode,
-                                        &hogbox::HogBoxViewer::SetStereoMode);
-		
-		//_xmlAttributes["AutoRotateView"] = new hogboxDB::CallbackXmlAttribute<hogbox::HogBoxViewer,bool>(hogboxViewer,
-		//															&hogbox::HogBoxViewer::GetAutoRotateView,
-		//															&hogbox::HogBoxViewer::SetAutoRotateView);
-        _xmlAttributes["DeviceOrientations"] = new hogboxDB::TypedXmlAttributeList<std::vector<std::string>, std::string>("DeviceOrientations", &_orientationStrings);
+    //The xml attributes of HogBoxViewer
+    virtual const hogboxDB::XmlAttributeTable* getXmlAttributeTable(){
+        static hogboxDB::XmlAttributeTablePtr s_table;
+        OpenThreads::ScopedLock<OpenThreads::ReentrantMutex> lock(*hogboxDB::XmlAttributeTable::getBuildMutex());
+        if(!s_table.valid()){
+            s_table = new hogboxDB::XmlAttributeTable();
+            
+            //Position attribute Vec3
+            s_table->addProperty<hogbox::HogBoxViewer,unsigned int>("ScreenID",
+                                                                    &hogbox::HogBoxViewer::GetScreenID,
+                                                                    &hogbox::HogBoxViewer::SetScreenID);
+            
+            //screen name
+            s_table->addProperty<hogbox::HogBoxViewer,std::string>("Title",
+                                                                   &hogbox::HogBoxViewer::GetWindowName,
+                                                                   &hogbox::HogBoxViewer::SetWindowName);
+            
+            //window stuff
+            s_table->addProperty<hogbox::HogBoxViewer,osg::Vec2>("Size",
+                                                                 &hogbox::HogBoxViewer::GetWindowSize,
+                                                                 &hogbox::HogBoxViewer::SetWindowSize);
+            s_table->addProperty<hogbox::HogBoxViewer,osg::Vec2>("Corner",
+                                                                 &hogbox::HogBoxViewer::GetWindowCorner,
+                                                                 &hogbox::HogBoxViewer::SetWindowCorner);
+            s_table->addProperty<hogbox::HogBoxViewer,bool>("DoubleBuffer",
+                                                            &hogbox::HogBoxViewer::GetDoubleBuffered,
+                                                            &hogbox::HogBoxViewer::SetDoubleBuffered);
+            s_table->addProperty<hogbox::HogBoxViewer,bool>("VerticalSync",
+                                                            &hogbox::HogBoxViewer::GetVSync,
+                                                            &hogbox::HogBoxViewer::SetVSync);
+            s_table->addProperty<hogbox::HogBoxViewer,unsigned int>("ColorBits",
+                                                                    &hogbox::HogBoxViewer::GetColorBits,
+                                                                    &hogbox::HogBoxViewer::SetColorBits);
+            s_table->addProperty<hogbox::HogBoxViewer,unsigned int>("DepthBits",
+                                                                    &hogbox::HogBoxViewer::GetDepthBits,
+                                                                    &hogbox::HogBoxViewer::SetDepthBits);
+            s_table->addProperty<hogbox::HogBoxViewer,unsigned int>("AlphaBits",
+                                                                    &hogbox::HogBoxViewer::GetAlphaBits,
+                                                                    &hogbox::HogBoxViewer::SetAlphaBits);
+            s_table->addProperty<hogbox::HogBoxViewer,unsigned int>("StencilBits",
+                                                                    &hogbox::HogBoxViewer::GetStencilBits,
+                                                                    &hogbox::HogBoxViewer::SetStencilBits);
+            s_table->addProperty<hogbox::HogBoxViewer,bool>("FullScreen",
+                                                            &hogbox::HogBoxViewer::isFullScreen,
+                                                            &hogbox::HogBoxViewer::SetFullScreen);
+            s_table->addProperty<hogbox::HogBoxViewer,bool>("Boarder",
+                                                            &hogbox::HogBoxViewer::GetWindowDecoration,
+                                                            &hogbox::HogBoxViewer::SetWindowDecoration);
+            s_table->addProperty<hogbox::HogBoxViewer,bool>("ShowCursor",
+                                                            &hogbox::HogBoxViewer::isCursorVisible,
+                                                            &hogbox::HogBoxViewer::SetCursorVisible);
+            
+            //
+            s_table->addProperty<hogbox::HogBoxViewer,osg::Vec4>("ClearColor",
+                                                                 &hogbox::HogBoxViewer::GetClearColor,
+                                                                 &hogbox::HogBoxViewer::SetClearColor);
+            s_table->addProperty<hogbox::HogBoxViewer,int>("AASamples",
+                                                           &hogbox::HogBoxViewer::GetAASamples,
+                                                           &hogbox::HogBoxViewer::SetAASamples);
+            
+            //stereo stuff
+            s_table->addProperty<hogbox::HogBoxViewer,bool>("UseStereo",
+                                                            &hogbox::HogBoxViewer::isUsingStereo,
+                                                            &hogbox::HogBoxViewer::SetUseStereo);
+            s_table->addProperty<hogbox::HogBoxViewer,float>("ConvergenceDistance",
+                                                             &hogbox::HogBoxViewer::GetStereoConvDistance,
+                                                             &hogbox::HogBoxViewer::SetStereoConvDistance);
+            s_table->addProperty<hogbox::HogBoxViewer,float>("EyeSeperation",
+                                                             &hogbox::HogBoxViewer::GetStereoEyeSeperation,
+                                                             &hogbox::HogBoxViewer::SetStereoEyeSeperation);
+            s_table->addProperty<hogbox::HogBoxViewer,bool>("SwapEyes",
+                                                            &hogbox::HogBoxViewer::GetSwapEyes,
+                                                            &hogbox::HogBoxViewer::SetSwapEyes);
+            s_table->addProperty<hogbox::HogBoxViewer,int>("StereoMode",
+                                                           &hogbox::HogBoxViewer::GetStereoMode,
+                                                           &hogbox::HogBoxViewer::SetStereoMode);
+            
+            //the orientations are read into the wrapper and applied in deserialize
+            s_table->addWrapperList<HogBoxViewerXmlWrapper,std::vector<std::string>,std::string>("DeviceOrientations",
+                                                                                                 &HogBoxViewerXmlWrapper::_orientationStrings);
+        }
+        return s_table.get();
     }
     
     hogbox::HogBoxViewer::DeviceOrientationFlags GetFlagsFromStringList(std::vector<std::string> list)
@@ -87,13 +87,18 @@ protected:
 	virtual ~OsgImageXmlWrapper(void){}
     
     //
-    //Bind the xml attributes for the wrapped object
-    virtual void bindXmlAttributes(){
-        osg::Image* image = dynamic_cast<osg::Image*>(p_wrappedObject.get());
-		_xmlAttributes["File"] = new hogboxDB::CallbackXmlAttribute<osg::Image,std::string>
-                                ("File", image,
-                                &osg::Image::getFileName,
-                                &osg::Image::setFileName);
+    //The xml attributes of osg::Image
+    virtual const hogboxDB::XmlAttributeTable* getXmlAttributeTable(){
+        static hogboxDB::XmlAttributeTablePtr s_table;
+        OpenThreads::ScopedLock<OpenThreads::ReentrantMutex> lock(*hogboxDB::XmlAttributeTable::getBuildMutex());
+        if(!s_table.valid()){
+            s_table = new hogboxDB::XmlAttributeTable();
+            
+            s_table->addProperty<osg::Image,std::string>("File",
+                                                         &osg::Image::getFileName,
+                                                         &osg::Image::setFileName);
+        }
+        return s_table.get();
     }
 
 };
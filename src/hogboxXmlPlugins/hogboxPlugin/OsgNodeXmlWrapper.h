@@ -49,9 +49,6 @@ public:
 		osg::Group* group = new osg::Group();
 		group->setName("OsgNodeRoot");
 
-		//add the temporary wrapper attributes
-		_xmlAttributes["File"] = new hogboxDB::TypedXmlAttribute<std::string>("File", &_fileName);
-
 		p_wrappedObject = group;
 	}
     
@@ -96,6 +93,15 @@ public:
 		return true;
 	}
 
+	//remove the previously loaded file before reading the changed node
+	virtual bool reload(osgDB::XmlNode* in)
+	{
+		osg::Group* group = dynamic_cast<osg::Group*>(p_wrappedObject.get());
+		if(group){group->removeChildren(0, group->getNumChildren());}
+		_fileName.clear();
+		return this->deserialize(in);
+	}
+
 
 public:
 
@@ -108,10 +114,17 @@ protected:
 	virtual ~OsgNodeXmlWrapper(void){}
     
     //
-    //Bind the xml attributes for the wrapped object
-    virtual void bindXmlAttributes(){
-        //osg::Group* node = dynamic_cast<osg::Group*>(p_wrappedObject.get());
-        _xmlAttributes["File"] = new hogboxDB::TypedXmlAttribute<std::string>("File", &_fileName);
+    //The xml attributes of osg::Node, read into the wrapper
+    virtual const hogboxDB::XmlAttributeTable* getXmlAttributeTable(){
+        static hogboxDB::XmlAttributeTablePtr s_table;
+        OpenThreads::ScopedLock<OpenThreads::ReentrantMutex> lock(*hogboxDB::XmlAttributeTable::getBuildMutex());
+        if(!s_table.valid()){
+            s_table = new hogboxDB::XmlAttributeTable();
+            
+            //temporary wrapper attribute, loaded in deserialize
+            s_table->addWrapperMember("File", &OsgNodeXmlWrapper::_fileName);
+        }
+        return s_table.get();
     }
 
 };
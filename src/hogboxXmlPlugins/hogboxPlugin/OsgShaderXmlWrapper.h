@@ -117,14 +117,19 @@ protected:
 	virtual ~OsgShaderXmlWrapper(void){}
     
     //
-    //Bind the xml attributes for the wrapped object
-    virtual void bindXmlAttributes(){
-        osg::Shader* shader = dynamic_cast<osg::Shader*>(p_wrappedObject.get());
-		//File name for the source code of the shader. Gets read into the shaders fileName variable
-		_xmlAttributes["File"] = new hogboxDB::CallbackXmlAttribute<osg::Shader,std::string>
-                                ("File", shader,
-                                &osg::Shader::getFileName,
-                                &osg::Shader::setFileName);
+    //The xml attributes of osg::Shader
+    virtual const hogboxDB::XmlAttributeTable* getXmlAttributeTable(){
+        static hogboxDB::XmlAttributeTablePtr s_table;
+        OpenThreads::ScopedLock<OpenThreads::ReentrantMutex> lock(*hogboxDB::XmlAttributeTable::getBuildMutex());
+        if(!s_table.valid()){
+            s_table = new hogboxDB::XmlAttributeTable();
+            
+            //File name for the source code of the shader. Gets read into the shaders fileName variable
+            s_table->addProperty<osg::Shader,std::string>("File",
+                                                          &osg::Shader::getFileName,
+                                                          &osg::Shader::setFileName);
+        }
+        return s_table.get();
     }
 
 };
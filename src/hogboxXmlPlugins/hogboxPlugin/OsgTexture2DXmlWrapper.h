@@ -55,18 +55,19 @@ protected:
 	}
 
     //
-    //Bind the xml attributes for the wrapped object
-    virtual void bindXmlAttributes(){
-        
-        OsgTextureXmlWrapper::bindXmlAttributes();
-        
-        osg::Texture2D* texture = dynamic_cast<osg::Texture2D*>(p_wrappedObject.get());
-        
-        //The image used by the texture2D
-        _xmlAttributes["TextureImage"] = new hogboxDB::CallbackXmlClassPointer<osg::Texture2D,osg::Image>
-                                        ("TextureImage", texture,
-                                        &osg::Texture2D::getImage,
-                                        &osg::Texture2D::setImage);
+    //The xml attributes of osg::Texture2D
+    virtual const hogboxDB::XmlAttributeTable* getXmlAttributeTable(){
+        static hogboxDB::XmlAttributeTablePtr s_table;
+        OpenThreads::ScopedLock<OpenThreads::ReentrantMutex> lock(*hogboxDB::XmlAttributeTable::getBuildMutex());
+        if(!s_table.valid()){
+            s_table = new hogboxDB::XmlAttributeTable(OsgTextureXmlWrapper::getXmlAttributeTable());
+            
+            //The image used by the texture
+            s_table->addPointer<osg::Texture2D,osg::Image>("TextureImage",
+                                                           &osg::Texture2D::getImage,
+                                                           &osg::Texture2D::setImage);
+        }
+        return s_table.get();
     }
 };
 
@@ -55,18 +55,19 @@ protected:
 	}
 
     //
-    //Bind the xml attributes for the wrapped object
-    virtual void bindXmlAttributes(){
-        
-        OsgTextureXmlWrapper::bindXmlAttributes();
-        
-        osg::TextureRectangle* texture = dynamic_cast<osg::TextureRectangle*>(p_wrappedObject.get());
-        
-        //The image used by the texture2D
-        _xmlAttributes["TextureImage"] = new hogboxDB::CallbackXmlClassPointer<osg::TextureRectangle,osg::Image>
-                                        ("TextureImage", texture,
-                                        &osg::TextureRectangle::getImage,
-                                        &osg::TextureRectangle::setImage);
+    //The xml attributes of osg::TextureRectangle
+    virtual const hogboxDB::XmlAttributeTable* getXmlAttributeTable(){
+        static hogboxDB::XmlAttributeTablePtr s_table;
+        OpenThreads::ScopedLock<OpenThreads::ReentrantMutex> lock(*hogboxDB::XmlAttributeTable::getBuildMutex());
+        if(!s_table.valid()){
+            s_table = new hogboxDB::XmlAttributeTable(OsgTextureXmlWrapper::getXmlAttributeTable());
+            
+            //The image used by the texture
+            s_table->addPointer<osg::TextureRectangle,osg::Image>("TextureImage",
+                                                                  &osg::TextureRectangle::getImage,
+                                                                  &osg::TextureRectangle::setImage);
+        }
+        return s_table.get();
     }
 };
 
@@ -135,21 +135,27 @@ protected:
 	}
     
     //
-    //Bind the xml attributes for the wrapped object
-    virtual void bindXmlAttributes(){
-        //osg::Texture* texture = dynamic_cast<osg::Texture*>(p_wrappedObject.get());
-		//use helper variables to load the texture wrap modes
-		_xmlAttributes["WrapU"] = new hogboxDB::TypedXmlAttribute<std::string>("WrapU", &_wrapU);
-		_xmlAttributes["WrapV"] = new hogboxDB::TypedXmlAttribute<std::string>("WrapV", &_wrapV);
-		_xmlAttributes["WrapW"] = new hogboxDB::TypedXmlAttribute<std::string>("WrapW", &_wrapW);
-        
-		_xmlAttributes["MinFilter"] = new hogboxDB::TypedXmlAttribute<std::string>("MinFilter", &_minFilter);
-		_xmlAttributes["MagFilter"] = new hogboxDB::TypedXmlAttribute<std::string>("MagFilter", &_magFilter);
-        
-		_xmlAttributes["GenMipMaps"] = new hogboxDB::TypedXmlAttribute<bool>("GenMipMaps", &_autoGenMipMaps);
-		_xmlAttributes["ResizeNPOT"] = new hogboxDB::TypedXmlAttribute<bool>("ResizeNPOT", &_resizeNPOT);
-        
-		_xmlAttributes["MaxAnisotropy"] = new hogboxDB::TypedXmlAttribute<float>("MaxAnisotropy", &_maxAnisotropic);
+    //The xml attributes shared by all texture types, read into the wrapper
+    virtual const hogboxDB::XmlAttributeTable* getXmlAttributeTable(){
+        static hogboxDB::XmlAttributeTablePtr s_table;
+        OpenThreads::ScopedLock<OpenThreads::ReentrantMutex> lock(*hogboxDB::XmlAttributeTable::getBuildMutex());
+        if(!s_table.valid()){
+            s_table = new hogboxDB::XmlAttributeTable();
+            
+            //use helper variables to load the texture wrap modes
+            s_table->addWrapperMember("WrapU", &OsgTextureXmlWrapper::_wrapU);
+            s_table->addWrapperMember("WrapV", &OsgTextureXmlWrapper::_wrapV);
+            s_table->addWrapperMember("WrapW", &OsgTextureXmlWrapper::_wrapW);
+            
+            s_table->addWrapperMember("MinFilter", &OsgTextureXmlWrapper::_minFilter);
+            s_table->addWrapperMember("MagFilter", &OsgTextureXmlWrapper::_magFilter);
+            
+            s_table->addWrapperMember("GenMipMaps", &OsgTextureXmlWrapper::_autoGenMipMaps);
+            s_table->addWrapperMember("ResizeNPOT", &OsgTextureXmlWrapper::_resizeNPOT);
+            
+            s_table->addWrapperMember("MaxAnisotropy", &OsgTextureXmlWrapper::_maxAnisotropic);
+        }
+        return s_table.get();
     }
 
 };